@@ -0,0 +1,108 @@
+/**
+ * @file bench_condition.cc
+ * @brief Condition-number benchmarks ported from
+ * microbench/condition_number_distribution and microbench/high_condition:
+ * cost of arma::cond on random matrices, and pseudo-inverse cost at a
+ * controlled condition number (accuracy proof goes to stderr)
+ */
+#include <gflags/gflags.h>
+#include <mkl.h>
+#define ARMA_DONT_PRINT_ERRORS
+#include <armadillo>
+
+#include <algorithm>
+
+#include "bench_registry.h"
+
+DECLARE_uint64(n_rows);
+DECLARE_uint64(n_cols);
+DECLARE_double(condition);
+
+// Generate a matrix with condition number approximately equal to cond_num
+static arma::cx_fmat GenMatrixWithCondition(double cond_num) {
+  if ((cond_num < 1.0) || (std::min(FLAGS_n_rows, FLAGS_n_cols) <= 1)) {
+    throw std::runtime_error("Invalid input for GenMatrixWithCondition()");
+  }
+
+  auto mat = arma::randn<arma::cx_fmat>(FLAGS_n_rows, FLAGS_n_cols);
+  arma::cx_fmat u;  // n_rows x n_rows
+  arma::cx_fmat v;  // n_cols x n_cols
+  arma::fvec s;     // min(n_rows, n_cols)
+  arma::svd(u, s, v, mat);
+
+  // Set the singular values to evenly spaced between {cond_num, ..., 1.0}
+  for (size_t i = 0; i < s.size(); i++) {
+    s[i] = cond_num - i * ((cond_num - 1) / (s.size() - 1));
+  }
+
+  // Turn the singular values into a n_rows x n_cols diagonal matrix
+  auto s_mat = arma::cx_fmat(FLAGS_n_rows, FLAGS_n_cols, arma::fill::zeros);
+  for (size_t i = 0; i < std::min(FLAGS_n_rows, FLAGS_n_cols); i++) {
+    s_mat(i, i) = s[i];
+  }
+
+  // Without normalization, the return's condition number is very close to
+  // cond_num
+  return arma::normalise(u * s_mat * v.t());
+}
+
+static void BenchCondRandom(microbench::BenchContext& ctx) {
+  std::vector<arma::cx_fmat> test_matrices;
+  test_matrices.reserve(ctx.NumIters());
+  for (size_t i = 0; i < ctx.NumIters(); i++) {
+    test_matrices.push_back(
+        arma::randn<arma::cx_fmat>(FLAGS_n_rows, FLAGS_n_cols));
+  }
+  const size_t mat_bytes =
+      FLAGS_n_rows * FLAGS_n_cols * sizeof(arma::cx_float);
+
+  std::vector<double> cond_vec;
+  cond_vec.reserve(ctx.NumIters());
+  for (size_t iter = 0; iter < ctx.NumIters(); iter++) {
+    ctx.FlushCacheLines(test_matrices[iter].memptr(), mat_bytes);
+    ctx.StartTimer();
+    cond_vec.push_back(arma::cond(test_matrices[iter]));
+    ctx.StopTimer();
+  }
+
+  // Report the condition-number distribution alongside the timing
+  std::sort(cond_vec.begin(), cond_vec.end());
+  double sum = 0.0;
+  for (const double c : cond_vec) {
+    sum += c;
+  }
+  std::fprintf(stderr,
+               "Condition numbers for %llux%llu: mean %.1f, median %.1f, "
+               "max %.1f\n",
+               static_cast<unsigned long long>(FLAGS_n_rows),
+               static_cast<unsigned long long>(FLAGS_n_cols),
+               sum / cond_vec.size(), cond_vec[cond_vec.size() * 0.50],
+               cond_vec.back());
+}
+REGISTER_BENCH("condition/cond_random", BenchCondRandom);
+
+static void BenchHighConditionPinv(microbench::BenchContext& ctx) {
+  const arma::cx_fmat a = GenMatrixWithCondition(FLAGS_condition);
+  const size_t mat_bytes =
+      FLAGS_n_rows * FLAGS_n_cols * sizeof(arma::cx_float);
+
+  auto id_mat = arma::cx_fmat(FLAGS_n_cols, FLAGS_n_cols, arma::fill::zeros);
+  for (size_t i = 0; i < FLAGS_n_cols; i++) {
+    id_mat(i, i) = arma::cx_float(1, 0);
+  }
+
+  arma::cx_fmat a_lpinv;  // Left pseudo-inverse of a
+  for (size_t iter = 0; iter < ctx.NumIters(); iter++) {
+    ctx.FlushCacheLines(a.memptr(), mat_bytes);
+    ctx.StartTimer();
+    a_lpinv = arma::inv_sympd(a.t() * a) * a.t();
+    ctx.StopTimer();
+  }
+
+  std::fprintf(stderr,
+               "Input condition number = %.3f, formula accuracy "
+               "sum|A_lpinv * A - I| = %.6f, SVD accuracy = %.6f\n",
+               arma::cond(a), arma::accu(arma::abs(a_lpinv * a - id_mat)),
+               arma::accu(arma::abs(arma::pinv(a) * a - id_mat)));
+}
+REGISTER_BENCH("condition/high_cond_pinv", BenchHighConditionPinv);
@@ -0,0 +1,134 @@
+/**
+ * @file bench_datatype_conversion.cc
+ * @brief Benchmarks for the SIMD sample-format converters in
+ * datatype_conversion.h (the per-packet cost on the RX/TX critical path),
+ * at the per-iteration element count given by --n_sc
+ */
+#include <gflags/gflags.h>
+
+#include <cstdlib>
+
+#include "bench_registry.h"
+#include "datatype_conversion.h"
+#include "memory_manage.h"
+
+DECLARE_uint64(n_sc);
+
+/// Aligned scratch buffers sized for the widest converter in the set
+struct ConversionBuffers {
+  explicit ConversionBuffers(size_t n_elems) : n_elems_(n_elems) {
+    short_buf_ = static_cast<short*>(Agora_memory::PaddedAlignedAlloc(
+        Agora_memory::Alignment_t::kAlign64, n_elems * sizeof(short)));
+    float_buf_ = static_cast<float*>(Agora_memory::PaddedAlignedAlloc(
+        Agora_memory::Alignment_t::kAlign64, n_elems * sizeof(float)));
+    float_out_buf_ = static_cast<float*>(Agora_memory::PaddedAlignedAlloc(
+        Agora_memory::Alignment_t::kAlign64, n_elems * sizeof(float)));
+    byte_buf_ = static_cast<uint8_t*>(Agora_memory::PaddedAlignedAlloc(
+        Agora_memory::Alignment_t::kAlign64, 2 * n_elems * sizeof(uint8_t)));
+    for (size_t i = 0; i < n_elems; i++) {
+      short_buf_[i] = static_cast<short>((rand() % 65536) - 32768);
+      float_buf_[i] = ((static_cast<float>(rand()) / RAND_MAX) * 2.0f) - 1.0f;
+    }
+  }
+  ~ConversionBuffers() {
+    std::free(short_buf_);
+    std::free(float_buf_);
+    std::free(float_out_buf_);
+    std::free(byte_buf_);
+  }
+
+  const size_t n_elems_;
+  short* short_buf_;
+  float* float_buf_;
+  float* float_out_buf_;
+  uint8_t* byte_buf_;
+};
+
+static void BenchShortToFloat(microbench::BenchContext& ctx) {
+  ConversionBuffers buffers(FLAGS_n_sc);
+  for (size_t iter = 0; iter < ctx.NumIters(); iter++) {
+    ctx.FlushCacheLines(buffers.short_buf_,
+                        buffers.n_elems_ * sizeof(short));
+    ctx.StartTimer();
+    SimdConvertShortToFloat(buffers.short_buf_, buffers.float_out_buf_,
+                            buffers.n_elems_);
+    ctx.StopTimer();
+  }
+}
+REGISTER_BENCH("convert/short_to_float", BenchShortToFloat);
+
+static void BenchFloatToShort(microbench::BenchContext& ctx) {
+  ConversionBuffers buffers(FLAGS_n_sc);
+  for (size_t iter = 0; iter < ctx.NumIters(); iter++) {
+    ctx.FlushCacheLines(buffers.float_buf_,
+                        buffers.n_elems_ * sizeof(float));
+    ctx.StartTimer();
+    SimdConvertFloatToShort(buffers.float_buf_, buffers.short_buf_,
+                            buffers.n_elems_, 0 /* cp_len */,
+                            1 /* scale_down_factor */);
+    ctx.StopTimer();
+  }
+}
+REGISTER_BENCH("convert/float_to_short", BenchFloatToShort);
+
+static void BenchFloat32ToFloat16(microbench::BenchContext& ctx) {
+  ConversionBuffers buffers(FLAGS_n_sc);
+  for (size_t iter = 0; iter < ctx.NumIters(); iter++) {
+    ctx.FlushCacheLines(buffers.float_buf_,
+                        buffers.n_elems_ * sizeof(float));
+    ctx.StartTimer();
+    SimdConvertFloat32ToFloat16(buffers.float_out_buf_, buffers.float_buf_,
+                                buffers.n_elems_);
+    ctx.StopTimer();
+  }
+}
+REGISTER_BENCH("convert/float32_to_float16", BenchFloat32ToFloat16);
+
+static void BenchFloat16ToFloat32(microbench::BenchContext& ctx) {
+  ConversionBuffers buffers(FLAGS_n_sc);
+  // Produce valid float16 input first
+  SimdConvertFloat32ToFloat16(buffers.float_out_buf_, buffers.float_buf_,
+                              buffers.n_elems_);
+  for (size_t iter = 0; iter < ctx.NumIters(); iter++) {
+    ctx.FlushCacheLines(buffers.float_out_buf_,
+                        (buffers.n_elems_ / 2) * sizeof(float));
+    ctx.StartTimer();
+    SimdConvertFloat16ToFloat32(buffers.float_buf_, buffers.float_out_buf_,
+                                buffers.n_elems_);
+    ctx.StopTimer();
+  }
+}
+REGISTER_BENCH("convert/float16_to_float32", BenchFloat16ToFloat32);
+
+static void BenchFloatTo12bitIq(microbench::BenchContext& ctx) {
+  ConversionBuffers buffers(FLAGS_n_sc);
+  for (size_t iter = 0; iter < ctx.NumIters(); iter++) {
+    ctx.FlushCacheLines(buffers.float_buf_,
+                        buffers.n_elems_ * sizeof(float));
+    ctx.StartTimer();
+    ConvertFloatTo12bitIq(buffers.float_buf_, buffers.byte_buf_,
+                          buffers.n_elems_);
+    ctx.StopTimer();
+  }
+}
+REGISTER_BENCH("convert/float_to_12bit_iq", BenchFloatTo12bitIq);
+
+static void Bench12bitIqToFloat(microbench::BenchContext& ctx) {
+  ConversionBuffers buffers(FLAGS_n_sc);
+  // Produce valid 12-bit IQ input first
+  ConvertFloatTo12bitIq(buffers.float_buf_, buffers.byte_buf_,
+                        buffers.n_elems_);
+  auto* in_16bits_buf = static_cast<uint16_t*>(Agora_memory::PaddedAlignedAlloc(
+      Agora_memory::Alignment_t::kAlign64,
+      buffers.n_elems_ * sizeof(uint16_t)));
+  for (size_t iter = 0; iter < ctx.NumIters(); iter++) {
+    ctx.FlushCacheLines(buffers.byte_buf_,
+                        (buffers.n_elems_ / 2) * 3 * sizeof(uint8_t));
+    ctx.StartTimer();
+    SimdConvert12bitIqToFloat(buffers.byte_buf_, buffers.float_out_buf_,
+                              in_16bits_buf, buffers.n_elems_);
+    ctx.StopTimer();
+  }
+  std::free(in_16bits_buf);
+}
+REGISTER_BENCH("convert/12bit_iq_to_float", Bench12bitIqToFloat);
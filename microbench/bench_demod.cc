@@ -0,0 +1,115 @@
+/**
+ * @file bench_demod.cc
+ * @brief Benchmarks for the soft demodulation kernels in modulation.cc,
+ * comparing the scalar, SSE, AVX2 (and AVX-512 where built) paths at the
+ * per-iteration element count given by --n_sc
+ */
+#include <gflags/gflags.h>
+
+#include <cstdlib>
+
+#include "bench_registry.h"
+#include "memory_manage.h"
+#include "modulation.h"
+
+DECLARE_uint64(n_sc);
+
+/// Aligned input/output buffers shared by one benchmark invocation. The
+/// inputs are random equalized-symbol components spanning the constellation
+struct DemodBuffers {
+  explicit DemodBuffers(size_t n_elems) : n_elems_(n_elems) {
+    vec_in_ = static_cast<float*>(Agora_memory::PaddedAlignedAlloc(
+        Agora_memory::Alignment_t::kAlign64, 2 * n_elems * sizeof(float)));
+    llr_out_ = static_cast<int8_t*>(Agora_memory::PaddedAlignedAlloc(
+        Agora_memory::Alignment_t::kAlign64, 16 * n_elems * sizeof(int8_t)));
+    for (size_t i = 0; i < 2 * n_elems; i++) {
+      vec_in_[i] = ((static_cast<float>(rand()) / RAND_MAX) * 3.0f) - 1.5f;
+    }
+  }
+  ~DemodBuffers() {
+    std::free(vec_in_);
+    std::free(llr_out_);
+  }
+
+  const size_t n_elems_;
+  float* vec_in_;
+  int8_t* llr_out_;
+};
+
+// One benchmark body serves every kernel; the registered functions below
+// bind the kernel pointer
+template <typename DemodIn>
+static void RunDemodKernel(microbench::BenchContext& ctx,
+                           void (*kernel)(DemodIn*, int8_t*, int)) {
+  DemodBuffers buffers(FLAGS_n_sc);
+  for (size_t iter = 0; iter < ctx.NumIters(); iter++) {
+    ctx.FlushCacheLines(buffers.vec_in_,
+                        2 * buffers.n_elems_ * sizeof(float));
+    ctx.StartTimer();
+    kernel(buffers.vec_in_, buffers.llr_out_,
+           static_cast<int>(buffers.n_elems_));
+    ctx.StopTimer();
+  }
+}
+
+static void Bench16qamSoftLoop(microbench::BenchContext& ctx) {
+  RunDemodKernel<const float>(ctx, Demod16qamSoftLoop);
+}
+REGISTER_BENCH("demod/16qam_soft_loop", Bench16qamSoftLoop);
+
+static void Bench16qamSoftSse(microbench::BenchContext& ctx) {
+  RunDemodKernel<float>(ctx, Demod16qamSoftSse);
+}
+REGISTER_BENCH("demod/16qam_soft_sse", Bench16qamSoftSse);
+
+static void Bench16qamSoftAvx2(microbench::BenchContext& ctx) {
+  RunDemodKernel<float>(ctx, Demod16qamSoftAvx2);
+}
+REGISTER_BENCH("demod/16qam_soft_avx2", Bench16qamSoftAvx2);
+
+static void Bench64qamSoftLoop(microbench::BenchContext& ctx) {
+  RunDemodKernel<const float>(ctx, Demod64qamSoftLoop);
+}
+REGISTER_BENCH("demod/64qam_soft_loop", Bench64qamSoftLoop);
+
+static void Bench64qamSoftSse(microbench::BenchContext& ctx) {
+  RunDemodKernel<float>(ctx, Demod64qamSoftSse);
+}
+REGISTER_BENCH("demod/64qam_soft_sse", Bench64qamSoftSse);
+
+static void Bench64qamSoftAvx2(microbench::BenchContext& ctx) {
+  RunDemodKernel<float>(ctx, Demod64qamSoftAvx2);
+}
+REGISTER_BENCH("demod/64qam_soft_avx2", Bench64qamSoftAvx2);
+
+static void Bench256qamSoftLoop(microbench::BenchContext& ctx) {
+  RunDemodKernel<const float>(ctx, Demod256qamSoftLoop);
+}
+REGISTER_BENCH("demod/256qam_soft_loop", Bench256qamSoftLoop);
+
+static void Bench256qamSoftSse(microbench::BenchContext& ctx) {
+  RunDemodKernel<const float>(ctx, Demod256qamSoftSse);
+}
+REGISTER_BENCH("demod/256qam_soft_sse", Bench256qamSoftSse);
+
+static void Bench256qamSoftAvx2(microbench::BenchContext& ctx) {
+  RunDemodKernel<const float>(ctx, Demod256qamSoftAvx2);
+}
+REGISTER_BENCH("demod/256qam_soft_avx2", Bench256qamSoftAvx2);
+
+#ifdef __AVX512F__
+static void Bench16qamSoftAvx512(microbench::BenchContext& ctx) {
+  RunDemodKernel<float>(ctx, Demod16qamSoftAvx512);
+}
+REGISTER_BENCH("demod/16qam_soft_avx512", Bench16qamSoftAvx512);
+
+static void Bench64qamSoftAvx512(microbench::BenchContext& ctx) {
+  RunDemodKernel<float>(ctx, Demod64qamSoftAvx512);
+}
+REGISTER_BENCH("demod/64qam_soft_avx512", Bench64qamSoftAvx512);
+
+static void Bench256qamSoftAvx512(microbench::BenchContext& ctx) {
+  RunDemodKernel<const float>(ctx, Demod256qamSoftAvx512);
+}
+REGISTER_BENCH("demod/256qam_soft_avx512", Bench256qamSoftAvx512);
+#endif  // __AVX512F__
@@ -0,0 +1,69 @@
+/**
+ * @file bench_inverse.cc
+ * @brief Pseudo-inverse benchmarks ported from microbench/inverse_perf:
+ * the Gram-matrix formula against SVD-based pinv
+ */
+#include <gflags/gflags.h>
+#include <mkl.h>
+#define ARMA_DONT_PRINT_ERRORS
+#include <armadillo>
+
+#include "bench_registry.h"
+
+DECLARE_uint64(n_rows);
+DECLARE_uint64(n_cols);
+
+static std::vector<arma::cx_fmat> GenTestMatrices(size_t count) {
+  std::vector<arma::cx_fmat> test_matrices;
+  test_matrices.reserve(count);
+  for (size_t i = 0; i < count; i++) {
+    test_matrices.push_back(
+        arma::randn<arma::cx_fmat>(FLAGS_n_rows, FLAGS_n_cols));
+  }
+  return test_matrices;
+}
+
+static void BenchPinvFormula(microbench::BenchContext& ctx) {
+  const std::vector<arma::cx_fmat> test_matrices =
+      GenTestMatrices(ctx.NumIters());
+  const size_t mat_bytes =
+      FLAGS_n_rows * FLAGS_n_cols * sizeof(arma::cx_float);
+
+  float proof = 0.0f;
+  for (size_t iter = 0; iter < ctx.NumIters(); iter++) {
+    const arma::cx_fmat& input = test_matrices[iter];
+    arma::cx_fmat output;
+    ctx.FlushCacheLines(input.memptr(), mat_bytes);
+
+    ctx.StartTimer();
+    try {
+      output = arma::inv_sympd(input.t() * input) * input.t();
+    } catch (std::runtime_error&) {
+      output = arma::pinv(input);
+    }
+    ctx.StopTimer();
+    proof += output[0].real();
+  }
+  std::fprintf(stderr, "Computation proof = %.2f\n", proof);
+}
+REGISTER_BENCH("inverse/pinv_formula", BenchPinvFormula);
+
+static void BenchPinvSvd(microbench::BenchContext& ctx) {
+  const std::vector<arma::cx_fmat> test_matrices =
+      GenTestMatrices(ctx.NumIters());
+  const size_t mat_bytes =
+      FLAGS_n_rows * FLAGS_n_cols * sizeof(arma::cx_float);
+
+  float proof = 0.0f;
+  for (size_t iter = 0; iter < ctx.NumIters(); iter++) {
+    const arma::cx_fmat& input = test_matrices[iter];
+    ctx.FlushCacheLines(input.memptr(), mat_bytes);
+
+    ctx.StartTimer();
+    const arma::cx_fmat output = arma::pinv(input);
+    ctx.StopTimer();
+    proof += output[0].real();
+  }
+  std::fprintf(stderr, "Computation proof = %.2f\n", proof);
+}
+REGISTER_BENCH("inverse/pinv_svd", BenchPinvSvd);
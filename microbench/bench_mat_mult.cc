@@ -0,0 +1,87 @@
+/**
+ * @file bench_mat_mult.cc
+ * @brief Matrix-vector multiply benchmarks ported from
+ * microbench/mat_mult_perf: Armadillo dispatch against an MKL JIT cgemm
+ * kernel (the precode/demul-shaped small multiply)
+ */
+#include <gflags/gflags.h>
+#include <mkl.h>
+#define ARMA_DONT_PRINT_ERRORS
+#include <armadillo>
+
+#include "bench_registry.h"
+
+DECLARE_uint64(n_rows);
+DECLARE_uint64(n_cols);
+
+static void GenTestOperands(size_t count,
+                            std::vector<arma::cx_fmat>& test_matrices,
+                            std::vector<arma::cx_fmat>& test_col_vectors) {
+  test_matrices.reserve(count);
+  test_col_vectors.reserve(count);
+  for (size_t i = 0; i < count; i++) {
+    test_matrices.push_back(
+        arma::randn<arma::cx_fmat>(FLAGS_n_rows, FLAGS_n_cols));
+    test_col_vectors.push_back(arma::randn<arma::cx_fmat>(FLAGS_n_cols, 1));
+  }
+}
+
+static void FlushOperands(const microbench::BenchContext& ctx,
+                          const arma::cx_fmat& mat, const arma::cx_fmat& vec) {
+  ctx.FlushCacheLines(mat.memptr(),
+                      FLAGS_n_rows * FLAGS_n_cols * sizeof(arma::cx_float));
+  ctx.FlushCacheLines(vec.memptr(), FLAGS_n_cols * sizeof(arma::cx_float));
+}
+
+static void BenchMatMultArma(microbench::BenchContext& ctx) {
+  std::vector<arma::cx_fmat> test_matrices;
+  std::vector<arma::cx_fmat> test_col_vectors;
+  GenTestOperands(ctx.NumIters(), test_matrices, test_col_vectors);
+
+  arma::cx_fmat out(FLAGS_n_rows, 1);
+  float proof = 0.0f;
+  for (size_t iter = 0; iter < ctx.NumIters(); iter++) {
+    FlushOperands(ctx, test_matrices[iter], test_col_vectors[iter]);
+    ctx.StartTimer();
+    out = test_matrices[iter] * test_col_vectors[iter];
+    ctx.StopTimer();
+    proof += out[0].real();
+  }
+  std::fprintf(stderr, "Computation proof = %.2f\n", proof);
+}
+REGISTER_BENCH("mat_mult/arma", BenchMatMultArma);
+
+static void BenchMatMultMklJit(microbench::BenchContext& ctx) {
+  std::vector<arma::cx_fmat> test_matrices;
+  std::vector<arma::cx_fmat> test_col_vectors;
+  GenTestOperands(ctx.NumIters(), test_matrices, test_col_vectors);
+
+  void* mkl_jitter;
+  MKL_Complex8 alpha = {1, 0};
+  MKL_Complex8 beta = {0, 0};
+  mkl_jit_status_t status = mkl_jit_create_cgemm(
+      &mkl_jitter, MKL_COL_MAJOR, MKL_NOTRANS, MKL_NOTRANS, FLAGS_n_rows, 1,
+      FLAGS_n_cols, &alpha, FLAGS_n_rows, FLAGS_n_cols, &beta, FLAGS_n_rows);
+  if (status == MKL_JIT_ERROR) {
+    std::fprintf(stderr, "Error: Failed to init MKL JIT\n");
+    std::exit(-1);
+  }
+  cgemm_jit_kernel_t mkl_jit_cgemm = mkl_jit_get_cgemm_ptr(mkl_jitter);
+
+  arma::cx_fmat out(FLAGS_n_rows, 1);
+  float proof = 0.0f;
+  for (size_t iter = 0; iter < ctx.NumIters(); iter++) {
+    FlushOperands(ctx, test_matrices[iter], test_col_vectors[iter]);
+    ctx.StartTimer();
+    mkl_jit_cgemm(
+        mkl_jitter,
+        reinterpret_cast<MKL_Complex8*>(test_matrices[iter].memptr()),
+        reinterpret_cast<MKL_Complex8*>(test_col_vectors[iter].memptr()),
+        reinterpret_cast<MKL_Complex8*>(out.memptr()));
+    ctx.StopTimer();
+    proof += out[0].real();
+  }
+  mkl_jit_destroy(mkl_jitter);
+  std::fprintf(stderr, "Computation proof = %.2f\n", proof);
+}
+REGISTER_BENCH("mat_mult/mkl_jit", BenchMatMultMklJit);
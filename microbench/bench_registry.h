@@ -0,0 +1,123 @@
+/**
+ * @file bench_registry.h
+ * @brief Registered-benchmark harness for the microbench target
+ */
+#ifndef BENCH_REGISTRY_H_
+#define BENCH_REGISTRY_H_
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "gettime.h"
+
+namespace microbench {
+
+/// Per-run state handed to each registered benchmark: the iteration budget,
+/// the measured RDTSC frequency, and a cycle-accurate per-iteration timer.
+/// In cold mode the benchmark should call FlushCacheLines on its working
+/// set before every measured iteration; in warm mode the call is a no-op,
+/// so one benchmark body serves both variants.
+class BenchContext {
+ public:
+  BenchContext(size_t n_iters, size_t n_warmup, double freq_ghz, bool cold)
+      : n_iters_(n_iters),
+        n_warmup_(n_warmup),
+        freq_ghz_(freq_ghz),
+        cold_(cold) {
+    iter_cycles_.reserve(n_iters);
+  }
+
+  /// Total iterations the benchmark body should run; the first n_warmup_
+  /// of them are timed but discarded from the reported statistics
+  size_t NumIters() const { return n_iters_ + n_warmup_; }
+  double FreqGhz() const { return freq_ghz_; }
+  bool Cold() const { return cold_; }
+
+  inline void StartTimer() { start_tsc_ = GetTime::Rdtsc(); }
+  inline void StopTimer() {
+    const size_t cycles = GetTime::Rdtsc() - start_tsc_;
+    if (cur_iter_ >= n_warmup_) {
+      iter_cycles_.push_back(cycles);
+    }
+    cur_iter_++;
+  }
+
+  /// Evict a buffer from all cache levels. No-op in warm mode, so
+  /// benchmarks call this unconditionally before every measured iteration
+  inline void FlushCacheLines(const void* base, size_t n_bytes) const {
+    if (cold_ == false) {
+      return;
+    }
+    auto* ptr = static_cast<char*>(const_cast<void*>(base));
+    for (size_t i = 0; i < n_bytes; i += 64) {
+      asm volatile(".byte 0x66; clflush %0"
+                   : "+m"(*(volatile char*)(ptr + i)));
+    }
+    asm volatile("mfence" ::: "memory");
+  }
+
+  double AvgUsec() const {
+    if (iter_cycles_.empty()) {
+      return 0.0;
+    }
+    double sum = 0.0;
+    for (const size_t cycles : iter_cycles_) {
+      sum += GetTime::CyclesToUs(cycles, freq_ghz_);
+    }
+    return sum / iter_cycles_.size();
+  }
+
+  double StddevUsec() const {
+    if (iter_cycles_.empty()) {
+      return 0.0;
+    }
+    const double avg = AvgUsec();
+    double sq_sum = 0.0;
+    for (const size_t cycles : iter_cycles_) {
+      const double us = GetTime::CyclesToUs(cycles, freq_ghz_);
+      sq_sum += (us - avg) * (us - avg);
+    }
+    return std::sqrt(sq_sum / iter_cycles_.size());
+  }
+
+  size_t NumMeasured() const { return iter_cycles_.size(); }
+
+ private:
+  const size_t n_iters_;
+  const size_t n_warmup_;
+  const double freq_ghz_;
+  const bool cold_;
+  size_t cur_iter_ = 0;
+  size_t start_tsc_ = 0;
+  std::vector<size_t> iter_cycles_;
+};
+
+using BenchFn = void (*)(BenchContext&);
+
+/// Global name -> function map. Benchmarks self-register at static-init
+/// time through REGISTER_BENCH, so adding one is a single translation unit
+/// with no runner changes
+class BenchRegistry {
+ public:
+  static std::map<std::string, BenchFn>& Map() {
+    static std::map<std::string, BenchFn> benchmarks;
+    return benchmarks;
+  }
+
+  static bool Register(const std::string& name, BenchFn fn) {
+    Map()[name] = fn;
+    return true;
+  }
+};
+
+}  // namespace microbench
+
+#define REGISTER_BENCH(name, fn) \
+  static const bool kBenchRegistered_##fn = \
+      microbench::BenchRegistry::Register(name, fn)
+
+#endif  // BENCH_REGISTRY_H_
@@ -0,0 +1,79 @@
+/**
+ * @file microbench_main.cc
+ * @brief Runner for the registered micro-benchmarks. Each benchmark runs a
+ * warm-cache and a cold-cache (working set flushed every iteration) variant
+ * unless disabled; select benchmarks by substring with --filter
+ */
+#include <gflags/gflags.h>
+#include <mkl.h>
+#define ARMA_DONT_PRINT_ERRORS
+#include <armadillo>
+
+#include "bench_registry.h"
+
+DEFINE_string(filter, "",
+              "Only run benchmarks whose name contains this substring");
+DEFINE_uint64(n_iters, 10000, "Measured iterations per benchmark");
+DEFINE_double(warmup_fraction, 0.2,
+              "Extra warmup iterations as a fraction of n_iters, "
+              "discarded from the reported statistics");
+DEFINE_bool(warm, true, "Run the warm-cache variant of each benchmark");
+DEFINE_bool(cold, true,
+            "Run the cold-cache variant (benchmark working set flushed "
+            "before every measured iteration)");
+
+// Workload dimensions shared by the benchmark translation units
+DEFINE_uint64(n_rows, 64, "Number of matrix rows (BS antennas)");
+DEFINE_uint64(n_cols, 16, "Number of matrix columns (UE antennas)");
+DEFINE_double(condition, 10,
+              "Condition number of the input matrix for the "
+              "high-condition benchmarks");  // 20 dB
+DEFINE_uint64(n_sc, 4096,
+              "Elements demodulated or converted per iteration for the "
+              "kernel benchmarks");
+
+static void RunVariant(const std::string& name, microbench::BenchFn fn,
+                       bool cold, double freq_ghz) {
+  const auto n_warmup =
+      static_cast<size_t>(FLAGS_n_iters * FLAGS_warmup_fraction);
+  microbench::BenchContext ctx(FLAGS_n_iters, n_warmup, freq_ghz, cold);
+  fn(ctx);
+  std::printf("%-36s %s %8zu %12.3f %12.3f\n", name.c_str(),
+              cold ? "cold" : "warm", ctx.NumMeasured(), ctx.AvgUsec(),
+              ctx.StddevUsec());
+}
+
+int main(int argc, char** argv) {
+  mkl_set_num_threads(1);
+  arma::arma_rng::set_seed_random();
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+
+  const double freq_ghz = GetTime::MeasureRdtscFreq();
+  GetTime::NanoSleep(100 * 1000 * 1000, freq_ghz);  // Trigger turbo for 100 ms
+  std::printf("RDTSC frequency = %.2f GHz\n", freq_ghz);
+
+  // Print the header
+  std::printf("%-36s %s %8s %12s %12s\n", "benchmark", "mode", "iters",
+              "avg_us", "stddev_us");
+
+  size_t n_run = 0;
+  for (const auto& bench : microbench::BenchRegistry::Map()) {
+    if ((FLAGS_filter.empty() == false) &&
+        (bench.first.find(FLAGS_filter) == std::string::npos)) {
+      continue;
+    }
+    if (FLAGS_warm) {
+      RunVariant(bench.first, bench.second, false, freq_ghz);
+    }
+    if (FLAGS_cold) {
+      RunVariant(bench.first, bench.second, true, freq_ghz);
+    }
+    n_run++;
+  }
+
+  if (n_run == 0) {
+    std::printf("No benchmarks match filter \"%s\"\n", FLAGS_filter.c_str());
+    return -1;
+  }
+  return 0;
+}
@@ -0,0 +1,66 @@
+#!/usr/bin/env python3
+"""Generate a compile-time build-profile header from a tddconfig JSON.
+
+Usage: gen_build_profile.py <tddconfig.json> <output_header>
+
+Invoked by cmake when the BUILD_PROFILE cache variable names a config
+file. Mirrors the dimension derivation in src/common/config.cc for the
+values a build profile freezes (antenna counts, OFDM sizes, modulation
+order); everything else in the config stays a runtime value.
+"""
+import json
+import re
+import sys
+
+MOD_ORDER_BITS = {"QPSK": 2, "16QAM": 4, "64QAM": 6}
+MAX_CHANNELS = 2  # kMaxChannels in symbols.h
+
+
+def strip_comments(text):
+    """The tddconfig files carry C-style comments that json.loads rejects."""
+    text = re.sub(r"/\*.*?\*/", "", text, flags=re.S)
+    text = re.sub(r"//[^\n]*", "", text)
+    return text
+
+
+def main():
+    if len(sys.argv) != 3:
+        sys.stderr.write(__doc__)
+        return 1
+    conf_path, out_path = sys.argv[1], sys.argv[2]
+    with open(conf_path) as f:
+        conf = json.loads(strip_comments(f.read()))
+
+    channel = conf.get("channel", "A")
+    ue_channel = conf.get("ue_channel", channel)
+    bs_ant_num = conf.get("bs_radio_num", 8) * min(len(channel), MAX_CHANNELS)
+    if "ue_radio_id" in conf:
+        ue_num = len(conf["ue_radio_id"])
+    else:
+        ue_num = conf.get("ue_radio_num", 8)
+    ue_ant_num = ue_num * min(len(ue_channel), MAX_CHANNELS)
+    ofdm_ca_num = conf.get("fft_size", 2048)
+    ofdm_data_num = conf.get("ofdm_data_num", 1200)
+    modulation = conf.get("modulation", "16QAM")
+    mod_order_bits = MOD_ORDER_BITS.get(modulation, 4)
+
+    with open(out_path, "w") as f:
+        f.write(
+            "// Generated by scripts/gen_build_profile.py from %s\n"
+            "// Do not edit: regenerate by re-running cmake with "
+            "BUILD_PROFILE set\n"
+            "#ifndef BUILD_PROFILE_GENERATED_H_\n"
+            "#define BUILD_PROFILE_GENERATED_H_\n"
+            "#define BUILD_PROFILE_BS_ANT_NUM %d\n"
+            "#define BUILD_PROFILE_UE_ANT_NUM %d\n"
+            "#define BUILD_PROFILE_OFDM_CA_NUM %d\n"
+            "#define BUILD_PROFILE_OFDM_DATA_NUM %d\n"
+            "#define BUILD_PROFILE_MOD_ORDER_BITS %d\n"
+            "#endif  // BUILD_PROFILE_GENERATED_H_\n"
+            % (conf_path, bs_ant_num, ue_ant_num, ofdm_ca_num, ofdm_data_num,
+               mod_order_bits))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
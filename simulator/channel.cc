@@ -4,16 +4,25 @@
  */
 #include "channel.h"
 
+#include <random>
 #include <utility>
 
 static constexpr bool kPrintChannelOutput = false;
 static constexpr bool kPrintSNRCheck = false;
 
+// Maximum Doppler shift of the Jakes model. 100 Hz is roughly 30 km/h at
+// 3.6 GHz carrier
+static constexpr float kJakesMaxDopplerHz = 100.0f;
+
+// Fixed noise-stream seed so channel simulator runs are reproducible
+static constexpr uint64_t kAwgnNoiseSeed = 0x41574E6E6F697365ULL;
+
 Channel::Channel(const Config* const config, std::string& in_channel_type,
                  double in_channel_snr)
     : cfg_(config),
       sim_chan_model_(std::move(in_channel_type)),
-      channel_snr_db_(in_channel_snr) {
+      channel_snr_db_(in_channel_snr),
+      noise_gen_(kAwgnNoiseSeed) {
   bs_ant_ = cfg_->BsAntNum();
   ue_ant_ = cfg_->UeAntNum();
   n_samps_ = cfg_->SampsPerSymbol();
@@ -26,6 +35,9 @@ Channel::Channel(const Config* const config, std::string& in_channel_type,
     chan_model_ = kRan3Gpp;
     printf("3GPP Model in progress, setting to RAYLEIGH channel \n");
     chan_model_ = kRayleigh;
+  } else if (sim_chan_model_ == "JAKES") {
+    chan_model_ = kJakes;
+    InitJakes();
   } else {
     chan_model_ = kAwgn;
   }
@@ -60,6 +72,10 @@ void Channel::ApplyChan(const arma::cx_fmat& fmat_src, arma::cx_fmat& fmat_dst,
       case kRan3Gpp:
         Lte3gpp(fmat_src, fmat_dst);
         break;
+
+      case kJakes:
+        UpdateJakes();
+        break;
     }
   }
   if (is_downlink) {
@@ -89,13 +105,10 @@ void Channel::Awgn(const arma::cx_fmat& src, arma::cx_fmat& dst) const {
     arma::frowvec n0 = pwr_vec / snr_lin;
     arma::frowvec n = sqrt(n0 / 2);
 
-    // Generate noise
-    arma::cx_fmat noise(arma::randn<arma::fmat>(n_row, n_col),
-                        arma::randn<arma::fmat>(n_row, n_col));
-    // Supposed to be faster
-    // arma::fmat x(n_row, n_col, arma::fill::arma::randn);
-    // arma::fmat y(n_row, n_col, arma::fill::arma::randn);
-    // arma::cx_fmat noise = arma::cx_fmat(x, y);
+    // Generate noise with the vectorized Box-Muller stream, directly into
+    // the matrix storage (N(0, 1) per component, as randn produced)
+    arma::cx_fmat noise(n_row, n_col);
+    noise_gen_.Fill(noise.memptr(), noise.n_elem);
 
     arma::fmat n_mat = repmat(n, n_row, 1);
     // Element-wise multiplication
@@ -115,6 +128,53 @@ void Channel::Awgn(const arma::cx_fmat& src, arma::cx_fmat& dst) const {
   }
 }
 
+void Channel::InitJakes() {
+  const double frame_dur_s =
+      (cfg_->Frame().NumTotalSyms() * cfg_->SampsPerSymbol()) / cfg_->Rate();
+  const size_t num_links = ue_ant_ * bs_ant_;
+
+  jakes_phasors_.resize(num_links * kJakesNumSinusoids);
+  jakes_steps_.resize(num_links * kJakesNumSinusoids);
+
+  // Independent random arrival angles and phases per link give mutually
+  // uncorrelated links with a near-Jakes Doppler spectrum. The only trig
+  // in the model runs here: each sinusoid's per-frame evolution reduces to
+  // multiplication with its precomputed rotation step
+  std::mt19937 gen(rand());
+  std::uniform_real_distribution<float> uniform_2pi(0.0f, 2.0f * M_PI);
+  for (size_t i = 0; i < (num_links * kJakesNumSinusoids); i++) {
+    const float arrival_angle = uniform_2pi(gen);
+    const float doppler_rad_per_frame = 2.0f * M_PI * kJakesMaxDopplerHz *
+                                        std::cos(arrival_angle) * frame_dur_s;
+    jakes_phasors_.at(i) = std::polar(1.0f, uniform_2pi(gen));
+    jakes_steps_.at(i) = std::polar(1.0f, doppler_rad_per_frame);
+  }
+
+  // Populate h_ so the channel is valid before the first frame boundary
+  UpdateJakes();
+}
+
+void Channel::UpdateJakes() {
+  const float scale = 1.0f / std::sqrt(kJakesNumSinusoids);
+  h_.set_size(ue_ant_, bs_ant_);
+  size_t i = 0;
+  for (size_t bs = 0; bs < bs_ant_; bs++) {
+    for (size_t ue = 0; ue < ue_ant_; ue++) {
+      std::complex<float> sum(0.0f, 0.0f);
+      for (size_t s = 0; s < kJakesNumSinusoids; s++) {
+        std::complex<float>& phasor = jakes_phasors_[i + s];
+        phasor *= jakes_steps_[i + s];
+        // One Newton step keeps |phasor| at 1; rounding drift would
+        // otherwise compound over the run
+        phasor *= (1.5f - 0.5f * std::norm(phasor));
+        sum += phasor;
+      }
+      h_(ue, bs) = sum * scale;
+      i += kJakesNumSinusoids;
+    }
+  }
+}
+
 void Channel::Lte3gpp(const arma::cx_fmat& fmat_src, arma::cx_fmat& fmat_dst) {
   // TODO - In progress (Use Rayleigh for now...)
   arma::cx_fmat h(arma::randn<arma::fmat>(cfg_->UeAntNum(), cfg_->BsAntNum()),
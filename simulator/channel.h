@@ -9,12 +9,15 @@
 #include <armadillo>
 #include <cassert>
 #include <cmath>
+#include <complex>
 #include <ctime>
 #include <iomanip>
 #include <numeric>
+#include <vector>
 
 #include "buffer.h"
 #include "config.h"
+#include "gaussian_noise.h"
 #include "gettime.h"
 #include "memory_manage.h"
 #include "signal_handler.h"
@@ -27,7 +30,10 @@ class Channel {
           double channel_snr);
   ~Channel();
 
-  // Dimensions of fmat_src: ( bscfg->sampsPerSymbol, uecfg->UE_ANT_NUM )
+  // Dimensions of fmat_src: ( bscfg->sampsPerSymbol, uecfg->UE_ANT_NUM ).
+  // Callers may stack multiple same-frame symbols as additional
+  // sampsPerSymbol row blocks; the frame's H is applied to all rows in one
+  // matrix product
   void ApplyChan(const arma::cx_fmat& fmat_src, arma::cx_fmat& mat_dst,
                  const bool is_downlink, const bool is_newChan);
 
@@ -49,6 +55,17 @@ class Channel {
   void Lte3gpp(const arma::cx_fmat& fmat_src, arma::cx_fmat& fmat_dst);
 
  private:
+  // Number of sinusoids summed per link for the Jakes model. More gives a
+  // smoother Doppler spectrum at linearly higher per-frame update cost
+  static constexpr size_t kJakesNumSinusoids = 16;
+
+  // Build the per-link sinusoid phasor tables for the Jakes model. All
+  // trig happens here; the per-frame evolution is phasor rotations only
+  void InitJakes();
+
+  // Advance every Jakes phasor by one frame and rebuild h_
+  void UpdateJakes();
+
   const Config* const cfg_;
 
   Channel* channel_;
@@ -58,9 +75,19 @@ class Channel {
 
   std::string sim_chan_model_;
   double channel_snr_db_;
-  enum ChanModel { kAwgn, kRayleigh, kRan3Gpp } chan_model_;
+  enum ChanModel { kAwgn, kRayleigh, kRan3Gpp, kJakes } chan_model_;
 
   arma::cx_fmat h_;
+
+  // Vectorized Box-Muller noise source for Awgn(). Fixed-seeded in the
+  // constructor so simulator runs are reproducible; mutable because noise
+  // generation advances the stream inside the const Awgn() path
+  mutable GaussianNoiseGenerator noise_gen_;
+
+  // Jakes state, kJakesNumSinusoids entries per (ue, bs) link: the current
+  // phasor of each sinusoid and its constant per-frame rotation step
+  std::vector<std::complex<float>> jakes_phasors_;
+  std::vector<std::complex<float>> jakes_steps_;
 };
 
 #endif  // CHANNEL_H_
@@ -50,7 +50,9 @@ struct SocketRxBuffer {
 ChannelSim::ChannelSim(const Config* const config, size_t bs_thread_num,
                        size_t user_thread_num, size_t worker_thread_num,
                        size_t in_core_offset, std::string in_chan_type,
-                       double in_chan_snr)
+                       double in_chan_snr, double loss_rate,
+                       double reorder_rate, size_t reorder_window,
+                       double jitter_max_us, size_t impairment_seed)
     : cfg_(config),
       bs_thread_num_(bs_thread_num),
       user_thread_num_(user_thread_num),
@@ -59,7 +61,29 @@ ChannelSim::ChannelSim(const Config* const config, size_t bs_thread_num,
       worker_thread_num_(worker_thread_num),
       core_offset_(in_core_offset),
       channel_type_(std::move(in_chan_type)),
-      channel_snr_(in_chan_snr) {
+      channel_snr_(in_chan_snr),
+      loss_rate_(loss_rate),
+      reorder_rate_(reorder_rate),
+      reorder_window_(reorder_window),
+      jitter_max_us_(jitter_max_us),
+      impairment_seed_(impairment_seed),
+      impairments_enabled_((loss_rate > 0.0) ||
+                           ((reorder_rate > 0.0) && (reorder_window > 0)) ||
+                           (jitter_max_us > 0.0)),
+      freq_ghz_(GetTime::MeasureRdtscFreq()) {
+  RtAssert((loss_rate_ >= 0.0) && (loss_rate_ < 1.0),
+           "loss_rate must be in [0, 1)");
+  RtAssert((reorder_rate_ >= 0.0) && (reorder_rate_ <= 1.0),
+           "reorder_rate must be in [0, 1]");
+  RtAssert(jitter_max_us_ >= 0.0, "jitter_max_us must be non-negative");
+  if (impairments_enabled_ == true) {
+    std::printf(
+        "ChannelSim: impairments enabled: loss %.3f%%, reorder %.3f%% "
+        "(window %zu packets), jitter <= %.1f us, seed %zu\n",
+        loss_rate_ * 100.0, reorder_rate_ * 100.0, reorder_window_,
+        jitter_max_us_, impairment_seed_);
+  }
+
   // initialize parameters from config
   srand(time(nullptr));
   dl_data_plus_beacon_symbols_ =
@@ -106,6 +130,25 @@ ChannelSim::ChannelSim(const Config* const config, size_t bs_thread_num,
   bs_tx_counter_.fill(0);
   user_tx_counter_.fill(0);
 
+  // Per-antenna TX destinations. BS antennas are split across the cells:
+  // packets carry (cell, in-cell antenna) ids and go to the owning cell's
+  // endpoint from bs_server_addr_list (all the same host by default)
+  const size_t ant_per_cell = cfg_->BsAntNum() / cfg_->NumCells();
+  bs_dest_.resize(cfg_->BsAntNum());
+  for (size_t ant = 0; ant < cfg_->BsAntNum(); ant++) {
+    bs_dest_.at(ant).addr_ = cfg_->BsServerAddrList().at(ant / ant_per_cell);
+    bs_dest_.at(ant).port_ = cfg_->BsServerPort() + ant;
+    bs_dest_.at(ant).cell_id_ = ant / ant_per_cell;
+    bs_dest_.at(ant).ant_id_ = ant % ant_per_cell;
+  }
+  ue_dest_.resize(cfg_->UeAntNum());
+  for (size_t ant = 0; ant < cfg_->UeAntNum(); ant++) {
+    ue_dest_.at(ant).addr_ = cfg_->UeServerAddr();
+    ue_dest_.at(ant).port_ = cfg_->UeServerPort() + ant;
+    ue_dest_.at(ant).cell_id_ = 0;
+    ue_dest_.at(ant).ant_id_ = ant;
+  }
+
   // Initialize channel
   channel_ = std::make_unique<Channel>(cfg_, channel_type_, channel_snr_);
 
@@ -297,70 +340,106 @@ void* ChannelSim::TaskThread(size_t tid) {
   moodycamel::ConsumerToken bs_consumer_token(task_queue_bs_);
   moodycamel::ConsumerToken ue_consumer_token(task_queue_user_);
 
-  size_t tx_buffer_ue_size =
-      dl_data_plus_beacon_symbols_ * cfg_->UeAntNum() * payload_length_;
-  AlignedByteVector tx_buffer_ue(tx_buffer_ue_size);
-
-  size_t tx_buffer_bs_size =
-      ul_data_plus_pilot_symbols_ * cfg_->BsAntNum() * payload_length_;
-  AlignedByteVector tx_buffer_bs(tx_buffer_bs_size);
-
-  void* bs_input_float_storage = PaddedAlignedAlloc(
-      Agora_memory::Alignment_t::kAlign64,
-      (cfg_->SampsPerSymbol() * cfg_->BsAntNum() * sizeof(arma::cx_float)));
-  void* bs_output_float_storage = PaddedAlignedAlloc(
-      Agora_memory::Alignment_t::kAlign64,
-      (cfg_->SampsPerSymbol() * cfg_->UeAntNum() * sizeof(arma::cx_float)));
-  void* ue_input_float_storage = PaddedAlignedAlloc(
-      Agora_memory::Alignment_t::kAlign64,
-      (cfg_->SampsPerSymbol() * cfg_->UeAntNum() * sizeof(arma::cx_float)));
-  void* ue_output_float_storage = PaddedAlignedAlloc(
-      Agora_memory::Alignment_t::kAlign64,
-      (cfg_->SampsPerSymbol() * cfg_->BsAntNum() * sizeof(arma::cx_float)));
-
-  arma::cx_fmat bs_input_matrix(
-      reinterpret_cast<arma::cx_float*>(bs_input_float_storage),
-      cfg_->SampsPerSymbol(), cfg_->BsAntNum(), false, true);
-  bs_input_matrix.zeros(cfg_->SampsPerSymbol(), cfg_->BsAntNum());
-
-  arma::cx_fmat bs_output_matrix(
-      reinterpret_cast<arma::cx_float*>(bs_output_float_storage),
-      cfg_->SampsPerSymbol(), cfg_->UeAntNum(), false, true);
-  bs_output_matrix.zeros(cfg_->SampsPerSymbol(), cfg_->UeAntNum());
-
-  arma::cx_fmat ue_input_matrix(
-      reinterpret_cast<arma::cx_float*>(ue_input_float_storage),
-      cfg_->SampsPerSymbol(), cfg_->UeAntNum(), false, true);
-  ue_input_matrix.zeros(cfg_->SampsPerSymbol(), cfg_->UeAntNum());
-
-  arma::cx_fmat ue_output_matrix(
-      reinterpret_cast<arma::cx_float*>(ue_output_float_storage),
-      cfg_->SampsPerSymbol(), cfg_->BsAntNum(), false, true);
-  ue_output_matrix.zeros(cfg_->SampsPerSymbol(), cfg_->BsAntNum());
+  // Scratch sized for kTxBatchSize stacked symbols, so same-frame symbols
+  // dequeued together go through the channel as one gemm
+  const size_t batch_samps = kTxBatchSize * cfg_->SampsPerSymbol();
+  void* bs_input_float_storage =
+      PaddedAlignedAlloc(Agora_memory::Alignment_t::kAlign64,
+                         (batch_samps * cfg_->BsAntNum() * sizeof(arma::cx_float)));
+  void* bs_output_float_storage =
+      PaddedAlignedAlloc(Agora_memory::Alignment_t::kAlign64,
+                         (batch_samps * cfg_->UeAntNum() * sizeof(arma::cx_float)));
+  void* ue_input_float_storage =
+      PaddedAlignedAlloc(Agora_memory::Alignment_t::kAlign64,
+                         (batch_samps * cfg_->UeAntNum() * sizeof(arma::cx_float)));
+  void* ue_output_float_storage =
+      PaddedAlignedAlloc(Agora_memory::Alignment_t::kAlign64,
+                         (batch_samps * cfg_->BsAntNum() * sizeof(arma::cx_float)));
+  std::memset(bs_input_float_storage, 0,
+              batch_samps * cfg_->BsAntNum() * sizeof(arma::cx_float));
+  std::memset(bs_output_float_storage, 0,
+              batch_samps * cfg_->UeAntNum() * sizeof(arma::cx_float));
+  std::memset(ue_input_float_storage, 0,
+              batch_samps * cfg_->UeAntNum() * sizeof(arma::cx_float));
+  std::memset(ue_output_float_storage, 0,
+              batch_samps * cfg_->BsAntNum() * sizeof(arma::cx_float));
 
   AlignedByteVector udp_tx_buffer(cfg_->PacketLength());
 
+  ImpairmentState impairment_state;
+  impairment_state.rng_.seed(impairment_seed_ + tid);
+
   WorkerThreadStorage thread_store;
   thread_store.tid_ = tid;
-  thread_store.ue_tx_buffer_ = &tx_buffer_ue;
-  thread_store.bs_tx_buffer_ = &tx_buffer_bs;
-
-  thread_store.bs_input_matrix_ = &bs_input_matrix;
-  thread_store.bs_output_matrix_ = &bs_output_matrix;
-  thread_store.ue_input_matrix_ = &ue_input_matrix;
-  thread_store.ue_output_matrix_ = &ue_output_matrix;
+  thread_store.impairment_ =
+      (impairments_enabled_ == true) ? &impairment_state : nullptr;
+
+  thread_store.bs_input_storage_ =
+      reinterpret_cast<arma::cx_float*>(bs_input_float_storage);
+  thread_store.bs_output_storage_ =
+      reinterpret_cast<arma::cx_float*>(bs_output_float_storage);
+  thread_store.ue_input_storage_ =
+      reinterpret_cast<arma::cx_float*>(ue_input_float_storage);
+  thread_store.ue_output_storage_ =
+      reinterpret_cast<arma::cx_float*>(ue_output_float_storage);
 
   thread_store.udp_tx_buffer_ = &udp_tx_buffer;
 
-  EventData event;
+  EventData events[kTxBatchSize];
+  size_t tags[kTxBatchSize];
   while (running) {
-    if (task_queue_bs_.try_dequeue(bs_consumer_token, event)) {
-      DoTxBs(thread_store, event.tags_[0]);
-    } else if (task_queue_user_.try_dequeue(ue_consumer_token, event)) {
-      DoTxUser(thread_store, event.tags_[0]);
+    size_t num_events =
+        task_queue_bs_.try_dequeue_bulk(bs_consumer_token, events, kTxBatchSize);
+    if (num_events > 0) {
+      // Batch runs of same-frame symbols; symbols of different frames use
+      // different channel matrices and are processed separately
+      size_t processed = 0;
+      while (processed < num_events) {
+        tags[0] = events[processed].tags_[0];
+        const size_t batch_frame = gen_tag_t(tags[0]).frame_id_;
+        size_t batch_size = 1;
+        while (((processed + batch_size) < num_events) &&
+               (gen_tag_t(events[processed + batch_size].tags_[0]).frame_id_ ==
+                batch_frame)) {
+          tags[batch_size] = events[processed + batch_size].tags_[0];
+          batch_size++;
+        }
+        DoTxBs(thread_store, tags, batch_size);
+        processed += batch_size;
+      }
+    } else {
+      num_events = task_queue_user_.try_dequeue_bulk(ue_consumer_token, events,
+                                                     kTxBatchSize);
+      size_t processed = 0;
+      while (processed < num_events) {
+        tags[0] = events[processed].tags_[0];
+        const size_t batch_frame = gen_tag_t(tags[0]).frame_id_;
+        size_t batch_size = 1;
+        while (((processed + batch_size) < num_events) &&
+               (gen_tag_t(events[processed + batch_size].tags_[0]).frame_id_ ==
+                batch_frame)) {
+          tags[batch_size] = events[processed + batch_size].tags_[0];
+          batch_size++;
+        }
+        DoTxUser(thread_store, tags, batch_size);
+        processed += batch_size;
+      }
+      // Idle: only jitter deadlines can expire without new traffic
+      if ((num_events == 0) && (impairments_enabled_ == true)) {
+        FlushImpairedPackets(thread_store, false);
+      }
     }
   }
 
+  if (impairments_enabled_ == true) {
+    FlushImpairedPackets(thread_store, true);
+    std::printf(
+        "ChannelSim worker %zu impairment summary: dropped %zu, reordered "
+        "%zu, jittered %zu packets\n",
+        tid, impairment_state.dropped_, impairment_state.reordered_,
+        impairment_state.jittered_);
+  }
+
   std::free(bs_input_float_storage);
   std::free(bs_output_float_storage);
   std::free(ue_input_float_storage);
@@ -383,6 +462,12 @@ void* ChannelSim::BsRxLoop(size_t tid) {
     server_bs_.at(socket_id) =
         std::make_unique<UDPServer>(local_port_id, kSockBufSize);
     client_bs_.at(socket_id) = std::make_unique<UDPClient>();
+    // One socket per antenna, one fixed destination per socket: connect
+    // once so the per-packet sends skip address lookup and kernel route
+    // validation
+    client_bs_.at(socket_id)
+        ->Connect(bs_dest_.at(socket_id).addr_,
+                  static_cast<uint16_t>(bs_dest_.at(socket_id).port_));
     std::printf(
         "ChannelSim::BsRxLoop[%zu]: set up UDP socket server listening to port "
         "%zu with remote address %s:%zu\n",
@@ -500,6 +585,10 @@ void* ChannelSim::UeRxLoop(size_t tid) {
     server_ue_.at(socket_id) =
         std::make_unique<UDPServer>(local_port_id, kSockBufSize);
     client_ue_.at(socket_id) = std::make_unique<UDPClient>();
+    // Connected like the BS-facing clients: one fixed destination each
+    client_ue_.at(socket_id)
+        ->Connect(ue_dest_.at(socket_id).addr_,
+                  static_cast<uint16_t>(ue_dest_.at(socket_id).port_));
 
     std::printf(
         "ChannelSim::UeRxLoop[%zu]: set up UDP socket server listening to port "
@@ -613,111 +702,167 @@ void* ChannelSim::UeRxLoop(size_t tid) {
 
 /// Warning: Threads are sharing these sender sockets.
 void ChannelSim::DoTx(size_t frame_id, size_t symbol_id, size_t max_ant,
-                      uint8_t* tx_buffer, const arma::cx_float* source_data,
-                      AlignedByteVector* udp_pkt_buf,
+                      const arma::cx_fmat& source_data, size_t row_offset,
+                      WorkerThreadStorage& local,
                       std::vector<std::unique_ptr<UDPClient>>& udp_clients,
-                      const std::string& dest_address, size_t dest_port) {
+                      const std::vector<TxDestination>& dests) {
   // The 2 is from complex float -> float
-  const size_t convert_length = (2 * cfg_->SampsPerSymbol() * max_ant);
-  auto* dst_ptr = reinterpret_cast<short*>(tx_buffer);
-
-#if defined(CHSIM_DEBUG_MEMORY)
-  RtAssert(((convert_length % 16) == 0) &&
-               ((reinterpret_cast<size_t>(dst_ptr) % 64) == 0) &&
-               ((reinterpret_cast<size_t>(source_data) % 64) == 0),
-           "Data Alignment not correct before calling into AVX optimizations");
-#endif
-
-  ConvertFloatToShort(reinterpret_cast<const float*>(source_data), dst_ptr,
-                      convert_length);
-  // SimdConvertFloatToShort(reinterpret_cast<const float*>(source_data),
-  // dst_ptr, convert_length, 0, 1);
+  const size_t convert_per_ant = (2 * cfg_->SampsPerSymbol());
+  AlignedByteVector* udp_pkt_buf = local.udp_tx_buffer_;
 
+  // One column per antenna; this symbol's samples start at [row_offset] of
+  // the (possibly stacked) channel output. Convert straight into the UDP
+  // packet payload, no intermediate staging buffer
   auto* pkt = reinterpret_cast<Packet*>(&udp_pkt_buf->at(0));
   for (size_t ant_id = 0u; ant_id < max_ant; ant_id++) {
+    const TxDestination& dest = dests.at(ant_id);
     pkt->frame_id_ = frame_id;
     pkt->symbol_id_ = symbol_id;
-    pkt->ant_id_ = ant_id;
-    pkt->cell_id_ = 0;
-    // Can remove this with some changes
-    std::memcpy(pkt->data_, &tx_buffer[ant_id * payload_length_],
-                payload_length_);
-    udp_clients.at(ant_id)->Send(dest_address, dest_port + ant_id,
-                                 udp_pkt_buf->data(), udp_pkt_buf->size());
-    // Assumes blocking
+    pkt->ant_id_ = dest.ant_id_;
+    pkt->cell_id_ = dest.cell_id_;
+    ConvertFloatToShort(
+        reinterpret_cast<const float*>(source_data.colptr(ant_id) + row_offset),
+        reinterpret_cast<short*>(pkt->data_), convert_per_ant);
+
+    bool send_now = true;
+    if (impairments_enabled_ == true) {
+      FlushImpairedPackets(local, false);
+      send_now = ImpairPacket(local, ant_id, udp_clients);
+    }
+    if (send_now == true) {
+      // Connected at socket setup, so this is a bare send()
+      udp_clients.at(ant_id)->Send(udp_pkt_buf->data(), udp_pkt_buf->size());
+      // Assumes blocking
+    }
   }
 }
 
-void ChannelSim::DoTxBs(WorkerThreadStorage& local, size_t tag) {
-  const size_t frame_id = gen_tag_t(tag).frame_id_;
-  const size_t symbol_id = gen_tag_t(tag).symbol_id_;
-  // Modify this to check the symbol type
-  const size_t pilot_symbol_id = cfg_->Frame().GetPilotSymbolIdx(symbol_id);
-  const size_t ul_symbol_id = cfg_->Frame().GetULSymbolIdx(symbol_id);
-  size_t total_symbol_id = pilot_symbol_id;
-  if (pilot_symbol_id == SIZE_MAX) {
-    total_symbol_id = ul_symbol_id + cfg_->Frame().NumPilotSyms();
+bool ChannelSim::ImpairPacket(
+    WorkerThreadStorage& local, size_t socket_id,
+    std::vector<std::unique_ptr<UDPClient>>& udp_clients) {
+  ImpairmentState& state = *local.impairment_;
+
+  // Every forwarded packet moves the reorder countdowns ahead one step
+  for (auto& held : state.held_) {
+    if (held.send_countdown_ > 0) {
+      held.send_countdown_--;
+    }
   }
 
-  if (kPrintDebugTxBs) {
-    std::printf(
-        "Channel Sim[%zu]: DoTxBs processing frame %zu, symbol %zu, ul "
-        "symbol %zu, at %f ms\n",
-        local.tid_, frame_id, symbol_id, total_symbol_id,
-        GetTime::GetTimeUs() / 1000);
+  std::uniform_real_distribution<double> uniform(0.0, 1.0);
+  if (uniform(state.rng_) < loss_rate_) {
+    state.dropped_++;
+    return false;
   }
 
-  const size_t symbol_offset =
-      (frame_id % kFrameWnd) * ul_data_plus_pilot_symbols_ + total_symbol_id;
-  const size_t total_offset_ue =
-      symbol_offset * payload_length_ * cfg_->UeAntNum();
-  const size_t total_offset_bs =
-      total_symbol_id * payload_length_ * cfg_->BsAntNum();
+  size_t countdown = 0;
+  uint64_t release_tsc = 0;
+  if ((reorder_window_ > 0) && (uniform(state.rng_) < reorder_rate_)) {
+    // Hold the packet behind 1..reorder_window later packets
+    countdown = 1 + (state.rng_() % reorder_window_);
+    state.reordered_++;
+  }
+  if (jitter_max_us_ > 0.0) {
+    release_tsc =
+        GetTime::Rdtsc() +
+        GetTime::UsToCycles(uniform(state.rng_) * jitter_max_us_, freq_ghz_);
+    state.jittered_++;
+  }
+  if ((countdown == 0) && (release_tsc == 0)) {
+    return true;
+  }
 
-  const auto* src_ptr =
-      reinterpret_cast<const short*>(&rx_buffer_ue_.at(total_offset_ue));
+  ImpairedPacket held;
+  held.release_tsc_ = release_tsc;
+  held.send_countdown_ = countdown;
+  held.socket_id_ = socket_id;
+  held.clients_ = &udp_clients;
+  held.payload_ = *local.udp_tx_buffer_;
+  state.held_.push_back(std::move(held));
+  return false;
+}
 
-  arma::cx_fmat& fmat_src = *local.ue_input_matrix_;
-  // fmat_src.zeros(fmat_src.n_rows, fmat_src.n_cols);
-  // 2 for complex type
-  const size_t convert_length = (2 * fmat_src.n_rows * fmat_src.n_cols);
+void ChannelSim::FlushImpairedPackets(WorkerThreadStorage& local,
+                                      bool drain_all) {
+  ImpairmentState& state = *local.impairment_;
+  if (state.held_.empty()) {
+    return;
+  }
+  const uint64_t now = GetTime::Rdtsc();
+  for (auto it = state.held_.begin(); it != state.held_.end();) {
+    if ((drain_all == true) ||
+        ((it->send_countdown_ == 0) && (it->release_tsc_ <= now))) {
+      it->clients_->at(it->socket_id_)
+          ->Send(it->payload_.data(), it->payload_.size());
+      it = state.held_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
 
-  MLPD_FRAME(
-      "Channel Sim[%zu]: DoTxBs processing frame %zu, symbol %zu, ul symbol "
-      "%zu, samples per symbol %zu ue ant num %zu offset %zu ue plus %zu "
-      "location %zu\n",
-      local.tid_, frame_id, symbol_id, total_symbol_id, cfg_->SampsPerSymbol(),
-      cfg_->UeAntNum(), total_offset_ue, ul_data_plus_pilot_symbols_,
-      (size_t)src_ptr);
-
-  MLPD_TRACE(
-      "Channel Sim[%zu]: SimdConvertShortToFloat: DoTxBs Length %lld samps "
-      "%lld ue ants %lld data size %zu\n",
-      local.tid_, fmat_src.n_elem, fmat_src.n_cols, fmat_src.n_rows,
-      sizeof(arma::cx_float));
-
-#if defined(CHSIM_DEBUG_MEMORY)
-  RtAssert(((convert_length % 16) == 0) &&
-               ((reinterpret_cast<size_t>(src_ptr) % 64) == 0) &&
-               ((reinterpret_cast<size_t>(fmat_src.memptr()) % 64) == 0),
-           "Data Alignment not correct before calling into AVX optimizations");
-#endif
-  // convert received data to complex float,
-  // apply channel, convert back to complex short to TX
-  SimdConvertShortToFloat(src_ptr, reinterpret_cast<float*>(fmat_src.memptr()),
-                          convert_length);
-
-  arma::cx_fmat& fmat_noisy = *local.ue_output_matrix_;
-  // fmat_noisy.zeros(fmat_noisy.n_rows, fmat_noisy.n_cols);
+void ChannelSim::DoTxBs(WorkerThreadStorage& local, const size_t* tags,
+                        size_t num_tags) {
+  const size_t frame_id = gen_tag_t(tags[0]).frame_id_;
+  const size_t n_samps = cfg_->SampsPerSymbol();
 
-  const bool is_downlink = false;
-  bool is_new_frame;
-  if (symbol_id == 0) {
-    is_new_frame = true;
-  } else {
-    is_new_frame = false;
+  if (kPrintDebugTxBs) {
+    std::printf(
+        "Channel Sim[%zu]: DoTxBs processing frame %zu, %zu stacked ul "
+        "symbols starting at symbol %zu, at %f ms\n",
+        local.tid_, frame_id, num_tags, (size_t)gen_tag_t(tags[0]).symbol_id_,
+        GetTime::GetTimeUs() / 1000);
+  }
+
+  // Stack the batched symbols into one (num_tags * n_samps) x UeAntNum
+  // matrix. All tags belong to the same frame, so one gemm against the
+  // frame's H applies the channel to the whole batch
+  arma::cx_fmat fmat_src(local.ue_input_storage_, n_samps * num_tags,
+                         cfg_->UeAntNum(), false, true);
+  // 2 for complex type
+  const size_t convert_per_ant = (2 * n_samps);
+  bool is_new_frame = false;
+  for (size_t sym = 0; sym < num_tags; sym++) {
+    const size_t symbol_id = gen_tag_t(tags[sym]).symbol_id_;
+    if (symbol_id == 0) {
+      is_new_frame = true;
+    }
+    // Modify this to check the symbol type
+    const size_t pilot_symbol_id = cfg_->Frame().GetPilotSymbolIdx(symbol_id);
+    const size_t ul_symbol_id = cfg_->Frame().GetULSymbolIdx(symbol_id);
+    size_t total_symbol_id = pilot_symbol_id;
+    if (pilot_symbol_id == SIZE_MAX) {
+      total_symbol_id = ul_symbol_id + cfg_->Frame().NumPilotSyms();
+    }
+    const size_t symbol_offset =
+        (frame_id % kFrameWnd) * ul_data_plus_pilot_symbols_ + total_symbol_id;
+    const size_t total_offset_ue =
+        symbol_offset * payload_length_ * cfg_->UeAntNum();
+    const auto* src_ptr =
+        reinterpret_cast<const short*>(&rx_buffer_ue_.at(total_offset_ue));
+
+    MLPD_FRAME(
+        "Channel Sim[%zu]: DoTxBs processing frame %zu, symbol %zu, ul symbol "
+        "%zu, samples per symbol %zu ue ant num %zu offset %zu ue plus %zu "
+        "location %zu\n",
+        local.tid_, frame_id, symbol_id, total_symbol_id, n_samps,
+        cfg_->UeAntNum(), total_offset_ue, ul_data_plus_pilot_symbols_,
+        (size_t)src_ptr);
+
+    // convert received data to complex float,
+    // apply channel, convert back to complex short to TX
+    for (size_t ant_id = 0; ant_id < cfg_->UeAntNum(); ant_id++) {
+      SimdConvertShortToFloat(
+          &src_ptr[ant_id * convert_per_ant],
+          reinterpret_cast<float*>(fmat_src.colptr(ant_id) + (sym * n_samps)),
+          convert_per_ant);
+    }
   }
+
+  arma::cx_fmat fmat_noisy(local.ue_output_storage_, n_samps * num_tags,
+                           cfg_->BsAntNum(), false, true);
   // Apply Channel
+  const bool is_downlink = false;
   channel_->ApplyChan(fmat_src, fmat_noisy, is_downlink, is_new_frame);
 
   MLPD_TRACE("Noisy dimensions %lld x %lld : %lld\n", fmat_noisy.n_rows,
@@ -727,80 +872,75 @@ void ChannelSim::DoTxBs(WorkerThreadStorage& local, size_t tag) {
     Utils::PrintMat(fmat_noisy, "rx_ul");
   }
 
-  DoTx(frame_id, symbol_id, cfg_->BsAntNum(),
-       &local.bs_tx_buffer_->at(total_offset_bs), fmat_noisy.memptr(),
-       local.udp_tx_buffer_, client_bs_, cfg_->BsServerAddr(),
-       cfg_->BsServerPort());
+  for (size_t sym = 0; sym < num_tags; sym++) {
+    const size_t symbol_id = gen_tag_t(tags[sym]).symbol_id_;
 
-  RtAssert(message_queue_.enqueue(
-               *task_ptok_[local.tid_],
-               EventData(EventType::kPacketTX,
-                         gen_tag_t::FrmSymAnt(frame_id, symbol_id, 0).tag_)),
-           "BS TX message enqueue failed!\n");
+    DoTx(frame_id, symbol_id, cfg_->BsAntNum(), fmat_noisy, sym * n_samps,
+         local, client_bs_, bs_dest_);
+
+    RtAssert(message_queue_.enqueue(
+                 *task_ptok_[local.tid_],
+                 EventData(EventType::kPacketTX,
+                           gen_tag_t::FrmSymAnt(frame_id, symbol_id, 0).tag_)),
+             "BS TX message enqueue failed!\n");
+  }
 }
 
-void ChannelSim::DoTxUser(WorkerThreadStorage& local, size_t tag) {
-  const size_t frame_id = gen_tag_t(tag).frame_id_;
-  const size_t symbol_id = gen_tag_t(tag).symbol_id_;
-  // If id = 0, then return 0;
-  const size_t dl_symbol_id = GetDlSymbolIdx(symbol_id);
+void ChannelSim::DoTxUser(WorkerThreadStorage& local, const size_t* tags,
+                          size_t num_tags) {
+  const size_t frame_id = gen_tag_t(tags[0]).frame_id_;
+  const size_t n_samps = cfg_->SampsPerSymbol();
 
   if (kPrintDebugTxUser) {
     MLPD_INFO(
-        "Channel Sim[%zu]: DoTxUser processing frame %zu, symbol %zu, dl "
-        "symbol %zu, at %f ms\n",
-        local.tid_, frame_id, symbol_id, dl_symbol_id,
+        "Channel Sim[%zu]: DoTxUser processing frame %zu, %zu stacked dl "
+        "symbols starting at symbol %zu, at %f ms\n",
+        local.tid_, frame_id, num_tags, (size_t)gen_tag_t(tags[0]).symbol_id_,
         GetTime::GetTimeUs() / 1000);
   }
 
-  const size_t symbol_offset =
-      (frame_id % kFrameWnd) * dl_data_plus_beacon_symbols_ + dl_symbol_id;
-  const size_t total_offset_bs =
-      symbol_offset * payload_length_ * cfg_->BsAntNum();
-  const size_t total_offset_ue =
-      dl_symbol_id * payload_length_ * cfg_->UeAntNum();
-
-  const auto* src_ptr =
-      reinterpret_cast<const short*>(&rx_buffer_bs_.at(total_offset_bs));
-
-  arma::cx_fmat& fmat_src = *local.bs_input_matrix_;
-  // fmat_src.zeros(fmat_src.n_rows, fmat_src.n_cols);
+  // Stack the batched symbols into one (num_tags * n_samps) x BsAntNum
+  // matrix sharing the frame's H
+  arma::cx_fmat fmat_src(local.bs_input_storage_, n_samps * num_tags,
+                         cfg_->BsAntNum(), false, true);
   // 2 for complex type
-  const size_t convert_length = (2 * fmat_src.n_rows * fmat_src.n_cols);
+  const size_t convert_per_ant = (2 * n_samps);
+  bool is_new_frame = false;
+  for (size_t sym = 0; sym < num_tags; sym++) {
+    const size_t symbol_id = gen_tag_t(tags[sym]).symbol_id_;
+    if (symbol_id == 0) {
+      is_new_frame = true;
+    }
+    // If id = 0, then return 0;
+    const size_t dl_symbol_id = GetDlSymbolIdx(symbol_id);
+    const size_t symbol_offset =
+        (frame_id % kFrameWnd) * dl_data_plus_beacon_symbols_ + dl_symbol_id;
+    const size_t total_offset_bs =
+        symbol_offset * payload_length_ * cfg_->BsAntNum();
+    const auto* src_ptr =
+        reinterpret_cast<const short*>(&rx_buffer_bs_.at(total_offset_bs));
+
+    MLPD_FRAME(
+        "Channel Sim[%zu]: DoTxUser processing frame %zu, symbol %zu, dl "
+        "symbol %zu, samples per symbol %zu bs ant num %zu offset %zu "
+        "location %zu\n",
+        local.tid_, frame_id, symbol_id, dl_symbol_id, n_samps,
+        cfg_->BsAntNum(), total_offset_bs, (size_t)src_ptr);
+
+    // convert received data to complex float,
+    // apply channel, convert back to complex short to TX
+    for (size_t ant_id = 0; ant_id < cfg_->BsAntNum(); ant_id++) {
+      SimdConvertShortToFloat(
+          &src_ptr[ant_id * convert_per_ant],
+          reinterpret_cast<float*>(fmat_src.colptr(ant_id) + (sym * n_samps)),
+          convert_per_ant);
+    }
+  }
 
-  MLPD_FRAME(
-      "Channel Sim[%zu]: DoTxUser processing frame %zu, symbol %zu, dl symbol "
-      "%zu, samples per symbol %zu bs ant num %zu offset %zu location %zu\n",
-      local.tid_, frame_id, symbol_id, dl_symbol_id, cfg_->SampsPerSymbol(),
-      cfg_->BsAntNum(), total_offset_bs, (size_t)src_ptr);
-
-  MLPD_TRACE(
-      "Channel Sim[%zu]: SimdConvertShortToFloat: DoTxUser Length %lld samps "
-      "%lld bs ants %lld data size %zu\n",
-      local.tid_, fmat_src.n_elem, fmat_src.n_cols, fmat_src.n_rows,
-      sizeof(arma::cx_float));
-
-#if defined(CHSIM_DEBUG_MEMORY)
-  RtAssert(((convert_length % 16) == 0) &&
-               ((reinterpret_cast<size_t>(src_ptr) % 64) == 0) &&
-               ((reinterpret_cast<size_t>(fmat_src.memptr()) % 64) == 0),
-           "Data Alignment not correct before calling into AVX optimizations");
-#endif
-  // convert received data to complex float,
-  // apply channel, convert back to complex short to TX
-  SimdConvertShortToFloat(src_ptr, reinterpret_cast<float*>(fmat_src.memptr()),
-                          convert_length);
-
-  arma::cx_fmat& fmat_noisy = *local.bs_output_matrix_;
-  // fmat_noisy.zeros(fmat_noisy.n_rows, fmat_noisy.n_cols);
+  arma::cx_fmat fmat_noisy(local.bs_output_storage_, n_samps * num_tags,
+                           cfg_->UeAntNum(), false, true);
   // Apply Channel
   const bool is_downlink = true;
-  bool is_new_frame;
-  if (symbol_id == 0) {
-    is_new_frame = true;
-  } else {
-    is_new_frame = false;
-  }
   channel_->ApplyChan(fmat_src, fmat_noisy, is_downlink, is_new_frame);
 
   MLPD_TRACE("Noisy dimensions %lld x %lld : %lld\n", fmat_noisy.n_rows,
@@ -810,14 +950,16 @@ void ChannelSim::DoTxUser(WorkerThreadStorage& local, size_t tag) {
     Utils::PrintMat(fmat_noisy, "rx_dl");
   }
 
-  DoTx(frame_id, symbol_id, cfg_->UeAntNum(),
-       &local.ue_tx_buffer_->at(total_offset_ue), fmat_noisy.memptr(),
-       local.udp_tx_buffer_, client_ue_, cfg_->UeServerAddr(),
-       cfg_->UeServerPort());
+  for (size_t sym = 0; sym < num_tags; sym++) {
+    const size_t symbol_id = gen_tag_t(tags[sym]).symbol_id_;
+
+    DoTx(frame_id, symbol_id, cfg_->UeAntNum(), fmat_noisy, sym * n_samps,
+         local, client_ue_, ue_dest_);
 
-  RtAssert(message_queue_.enqueue(
-               *task_ptok_[local.tid_],
-               EventData(EventType::kPacketTX,
-                         gen_tag_t::FrmSymUe(frame_id, symbol_id, 0).tag_)),
-           "UE TX message enqueue failed!\n");
+    RtAssert(message_queue_.enqueue(
+                 *task_ptok_[local.tid_],
+                 EventData(EventType::kPacketTX,
+                           gen_tag_t::FrmSymUe(frame_id, symbol_id, 0).tag_)),
+             "UE TX message enqueue failed!\n");
+  }
 }
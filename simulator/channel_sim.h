@@ -12,6 +12,7 @@
 #include <ctime>
 #include <iomanip>
 #include <numeric>
+#include <random>
 
 #include "buffer.h"
 #include "channel.h"
@@ -28,17 +29,40 @@ using AlignedByteVector =
     std::vector<unsigned char,
                 boost::alignment::aligned_allocator<unsigned char, 64>>;
 
+// One packet held back by the impairment engine until both its reorder
+// countdown and its jitter deadline expire
+struct ImpairedPacket {
+  uint64_t release_tsc_;
+  size_t send_countdown_;
+  size_t socket_id_;
+  // The owning client is connected to its fixed destination, so the held
+  // packet needs no endpoint of its own
+  std::vector<std::unique_ptr<UDPClient>>* clients_;
+  AlignedByteVector payload_;
+};
+
+// Per-worker impairment engine: a seeded RNG for reproducible loss /
+// reorder / jitter decisions, the packets currently held back, and
+// counters for the exit summary
+struct ImpairmentState {
+  std::mt19937 rng_;
+  std::vector<ImpairedPacket> held_;
+  size_t dropped_ = 0;
+  size_t reordered_ = 0;
+  size_t jittered_ = 0;
+};
+
 struct WorkerThreadStorage {
   size_t tid_;
-  // Aligned
-  AlignedByteVector* ue_tx_buffer_;
-  arma::cx_fmat* ue_input_matrix_;
-  arma::cx_fmat* ue_output_matrix_;
+  // Network-impairment engine state, one per worker (null when disabled)
+  ImpairmentState* impairment_;
+  // Scratch for up to kTxBatchSize stacked symbols (column-major, one
+  // samps-per-symbol row block per symbol)
+  arma::cx_float* ue_input_storage_;
+  arma::cx_float* ue_output_storage_;
 
-  // Aligned
-  AlignedByteVector* bs_tx_buffer_;
-  arma::cx_fmat* bs_input_matrix_;
-  arma::cx_fmat* bs_output_matrix_;
+  arma::cx_float* bs_input_storage_;
+  arma::cx_float* bs_output_storage_;
 
   AlignedByteVector* udp_tx_buffer_;
 };
@@ -49,14 +73,26 @@ struct WorkerThreadStorage {
  * and applies it to incoming baseband samples from BS and sends them
  * to the UE application. Similarly, applies the same channel (TDD) to
  * uplink baseband samples from UE and sends them to BS.
+ *
+ * Multi-cell: with cells > 1 the channel grid spans the antennas of all
+ * cells, so one gemm over the full grid sums every cell's contribution at
+ * each UE (downlink inter-cell interference) and delivers each UE to every
+ * cell's antennas (uplink). BS packets are stamped with (cell, in-cell
+ * antenna) ids and routed to the cell's endpoint from bs_server_addr_list.
  */
 class ChannelSim {
  public:
+  // Maximum number of same-frame symbols a worker stacks into one
+  // channel-application gemm
+  static constexpr size_t kTxBatchSize = 4;
+
   ChannelSim(const Config* const config, size_t bs_thread_num,
              size_t user_thread_num, size_t worker_thread_num,
              size_t in_core_offset = 30,
              std::string in_chan_type = std::string("RAYLEIGH"),
-             double in_chan_snr = 20);
+             double in_chan_snr = 20, double loss_rate = 0.0,
+             double reorder_rate = 0.0, size_t reorder_window = 0,
+             double jitter_max_us = 0.0, size_t impairment_seed = 1);
   ~ChannelSim();
 
   void Start();
@@ -67,11 +103,14 @@ class ChannelSim {
   // Loop thread receiving symbols from BS antennas
   void* BsRxLoop(size_t tid);
 
-  // Transmits symbol to BS antennas after applying channel
-  void DoTxBs(WorkerThreadStorage& local, size_t tag);
+  // Transmits a batch of same-frame uplink symbols to BS antennas after
+  // applying the channel with one stacked gemm
+  void DoTxBs(WorkerThreadStorage& local, const size_t* tags, size_t num_tags);
 
-  // Transmit symbols to client antennas after applying channel
-  void DoTxUser(WorkerThreadStorage& local, size_t tag);
+  // Transmits a batch of same-frame downlink symbols to client antennas
+  // after applying the channel with one stacked gemm
+  void DoTxUser(WorkerThreadStorage& local, const size_t* tags,
+                size_t num_tags);
 
   void ScheduleTask(EventData do_task,
                     moodycamel::ConcurrentQueue<EventData>* in_queue,
@@ -79,11 +118,33 @@ class ChannelSim {
   void* TaskThread(size_t tid);
 
  private:
+  // TX destination of one antenna: endpoint plus the (cell, in-cell
+  // antenna) ids stamped on the packet. Cells only differ on the BS side
+  struct TxDestination {
+    std::string addr_;
+    size_t port_;
+    size_t cell_id_;
+    size_t ant_id_;
+  };
+
+  // Packetize and send one symbol whose samples start at row [row_offset]
+  // of the (possibly stacked) channel output matrix. Each antenna's
+  // samples are converted directly into the UDP packet payload
   void DoTx(size_t frame_id, size_t symbol_id, size_t max_ant,
-            uint8_t* tx_buffer, const arma::cx_float* source_data,
-            AlignedByteVector* udp_pkt_buf,
+            const arma::cx_fmat& source_data, size_t row_offset,
+            WorkerThreadStorage& local,
             std::vector<std::unique_ptr<UDPClient>>& udp_clients,
-            const std::string& dest_address, size_t dest_port);
+            const std::vector<TxDestination>& dests);
+
+  // Impairment stage decision for the packet staged in [local]'s udp
+  // buffer. Returns true if the packet should still be sent now; a false
+  // return means it was dropped or held back
+  bool ImpairPacket(WorkerThreadStorage& local, size_t socket_id,
+                    std::vector<std::unique_ptr<UDPClient>>& udp_clients);
+
+  // Send held-back packets whose reorder countdown and jitter deadline
+  // expired ([drain_all] releases everything, for shutdown)
+  void FlushImpairedPackets(WorkerThreadStorage& local, bool drain_all);
 
   // BS-facing sending clients
   std::vector<std::unique_ptr<UDPClient>> client_bs_;
@@ -130,6 +191,23 @@ class ChannelSim {
   std::string channel_type_;
   double channel_snr_;
 
+  // Network-impairment stage at the forwarding point, all off by default:
+  // packet loss fraction, reorder probability with a max hold-back window
+  // (in packets), and a per-packet uniform jitter upper bound. The seed
+  // makes each worker's decision sequence reproducible
+  const double loss_rate_;
+  const double reorder_rate_;
+  const size_t reorder_window_;
+  const double jitter_max_us_;
+  const size_t impairment_seed_;
+  const bool impairments_enabled_;
+  // RDTSC frequency in GHz, for jitter deadlines
+  const double freq_ghz_;
+
+  // Per-antenna TX destinations toward the BS cells and the UEs
+  std::vector<TxDestination> bs_dest_;
+  std::vector<TxDestination> ue_dest_;
+
   size_t* bs_rx_counter_;
   size_t* user_rx_counter_;
   std::array<size_t, kFrameWnd> bs_tx_counter_;
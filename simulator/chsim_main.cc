@@ -20,6 +20,17 @@ DEFINE_string(conf_file, TOSTRING(PROJECT_DIRECTORY) "/data/tddconfig-sim.json",
               "Config filename");
 DEFINE_string(chan_model, "RAYLEIGH", "Simulator Channel Type: RAYLEIGH/AWGN");
 DEFINE_double(chan_snr, 20.0, "Signal-to-Noise Ratio");
+DEFINE_double(loss_rate, 0.0,
+              "Fraction of forwarded packets to drop, in [0, 1)");
+DEFINE_double(reorder_rate, 0.0,
+              "Fraction of forwarded packets to reorder, in [0, 1]");
+DEFINE_uint64(reorder_window, 0,
+              "Maximum number of later packets a reordered packet is held "
+              "behind (0 disables reordering)");
+DEFINE_double(jitter_max_us, 0.0,
+              "Upper bound of the per-packet uniform jitter in microseconds");
+DEFINE_uint64(impairment_seed, 1,
+              "Seed for the per-worker impairment RNGs (reproducible runs)");
 
 int main(int argc, char* argv[]) {
   int ret = EXIT_FAILURE;
@@ -36,7 +47,8 @@ int main(int argc, char* argv[]) {
       auto sim = std::make_unique<ChannelSim>(
           config.get(), FLAGS_bs_threads, FLAGS_ue_threads,
           FLAGS_worker_threads, FLAGS_core_offset, FLAGS_chan_model,
-          FLAGS_chan_snr);
+          FLAGS_chan_snr, FLAGS_loss_rate, FLAGS_reorder_rate,
+          FLAGS_reorder_window, FLAGS_jitter_max_us, FLAGS_impairment_seed);
       sim->Start();
       ret = EXIT_SUCCESS;
     } catch (SignalException& e) {
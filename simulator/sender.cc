@@ -9,6 +9,7 @@
 
 #include "datatype_conversion.h"
 #include "logger.h"
+#include "mmap_reader.h"
 #include "udp_client.h"
 
 #if defined(USE_DPDK)
@@ -26,10 +27,11 @@ void InterruptHandler(int /*unused*/) {
   keep_running.store(false);
 }
 
-void DelayTicks(uint64_t start, uint64_t ticks) {
-  while ((GetTime::Rdtsc() - start) < ticks) {
-    _mm_pause();
-  }
+// Wait until the TSC reaches the absolute deadline [tsc_deadline]. The
+// master thread accumulates deadlines from the start of frame 0, so wakeup
+// overshoot in one symbol never drifts the symbols that follow it
+static void DelayTicksUntil(uint64_t tsc_deadline) {
+  GetTime::WaitUntilTsc(tsc_deadline);
 }
 
 Sender::Sender(Config* cfg, size_t socket_thread_num, size_t core_offset,
@@ -73,6 +75,9 @@ Sender::Sender(Config* cfg, size_t socket_thread_num, size_t core_offset,
   InitIqFromFile(std::string(TOSTRING(PROJECT_DIRECTORY)) +
                  "/data/LDPC_rx_data_" + std::to_string(cfg->OfdmCaNum()) +
                  "_ant" + std::to_string(cfg->BsAntNum()) + ".bin");
+  if (cfg->FftInRru() == true) {
+    PrecomputeFftData();
+  }
 
   task_ptok_ =
       static_cast<moodycamel::ProducerToken**>(Agora_memory::PaddedAlignedAlloc(
@@ -148,6 +153,9 @@ Sender::~Sender() {
   }
 
   iq_data_short_.Free();
+  if (cfg_->FftInRru() == true) {
+    iq_data_fft_.Free();
+  }
   for (auto& i : packet_count_per_symbol_) {
     delete[] i;
   }
@@ -210,7 +218,9 @@ void* Sender::MasterThread(int /*unused*/) {
     // Wait
   }
 
-  uint64_t tick_start = GetTime::Rdtsc();
+  // Absolute TSC deadline for the symbol being scheduled, accumulated from
+  // the start of frame 0 so the pacing never drifts
+  uint64_t tick_deadline = GetTime::Rdtsc();
   double frame_start_us = GetTime::GetTimeUs();
   double frame_end_us = 0;
   this->frame_start_[0] = frame_start_us;
@@ -219,8 +229,8 @@ void* Sender::MasterThread(int /*unused*/) {
   // Delay until the start of the first symbol
   if (start_symbol > 0) {
     MLPD_INFO("Sender: Starting symbol %zu delaying\n", start_symbol);
-    DelayTicks(tick_start, GetTicksForFrame(0) * start_symbol);
-    tick_start = tick_start + (GetTicksForFrame(0) * start_symbol);
+    tick_deadline += (GetTicksForFrame(0) * start_symbol);
+    DelayTicksUntil(tick_deadline);
   }
   RtAssert(start_symbol != cfg_->Frame().NumTotalSyms(),
            "Sender: No valid symbols to transmit");
@@ -254,8 +264,8 @@ void* Sender::MasterThread(int /*unused*/) {
               symbol_delay);
         }
         // Add inter-symbol delay
-        DelayTicks(tick_start, GetTicksForFrame(ctag.frame_id_) * symbol_delay);
-        tick_start += (GetTicksForFrame(ctag.frame_id_) * symbol_delay);
+        tick_deadline += (GetTicksForFrame(ctag.frame_id_) * symbol_delay);
+        DelayTicksUntil(tick_deadline);
 
         size_t next_frame_id = ctag.frame_id_;
         // Check to see if the current frame is finished
@@ -284,8 +294,8 @@ void* Sender::MasterThread(int /*unused*/) {
             break; /* Finished */
           } else {
             // Wait for the inter-frame delay
-            DelayTicks(tick_start, ticks_inter_frame_);
-            tick_start += ticks_inter_frame_;
+            tick_deadline += ticks_inter_frame_;
+            DelayTicksUntil(tick_deadline);
             frame_start_us = GetTime::GetTimeUs();
 
             // Set the frame start time to the start time of the frame
@@ -294,9 +304,9 @@ void* Sender::MasterThread(int /*unused*/) {
                 frame_start_us;
 
             // Wait until the first tx symbol
-            DelayTicks(tick_start,
-                       (GetTicksForFrame(ctag.frame_id_) * next_symbol_id));
-            tick_start += (GetTicksForFrame(ctag.frame_id_) * next_symbol_id);
+            tick_deadline +=
+                (GetTicksForFrame(ctag.frame_id_) * next_symbol_id);
+            DelayTicksUntil(tick_deadline);
           }
         }  // if (next_symbol_id == cfg_->Frame().NumTotalSyms()) {
         ScheduleSymbol(next_frame_id, next_symbol_id);
@@ -319,11 +329,6 @@ void* Sender::WorkerThread(int tid) {
   }
   MLPD_FRAME("Sender: worker thread %d running\n", tid);
 
-  DFTI_DESCRIPTOR_HANDLE mkl_handle;
-  DftiCreateDescriptor(&mkl_handle, DFTI_SINGLE, DFTI_COMPLEX, 1,
-                       cfg_->OfdmCaNum());
-  DftiCommitDescriptor(mkl_handle);
-
   const size_t max_symbol_id =
       cfg_->Frame().NumPilotSyms() +
       cfg_->Frame().NumULSyms();  // TEMP not sure if this is ok
@@ -343,10 +348,6 @@ void* Sender::WorkerThread(int tid) {
   UDPClient udp_client;
 #endif
 
-  auto* fft_inout =
-      static_cast<complex_float*>(Agora_memory::PaddedAlignedAlloc(
-          Agora_memory::Alignment_t::kAlign64,
-          cfg_->OfdmCaNum() * sizeof(complex_float)));
   auto* socks_pkt_buf = static_cast<Packet*>(PaddedAlignedAlloc(
       Agora_memory::Alignment_t::kAlign32, cfg_->PacketLength()));
 
@@ -399,13 +400,14 @@ void* Sender::WorkerThread(int tid) {
         pkt->symbol_id_ = tag.symbol_id_;
         pkt->cell_id_ = tag.ant_id_ / ant_num_per_cell;
         pkt->ant_id_ = tag.ant_id_ - ant_num_per_cell * (pkt->cell_id_);
-        std::memcpy(
-            pkt->data_,
-            iq_data_short_[(pkt->symbol_id_ * cfg_->BsAntNum()) + tag.ant_id_],
-            (cfg_->CpLen() + cfg_->OfdmCaNum()) * (kUse12BitIQ ? 3 : 4));
-        if (cfg_->FftInRru() == true) {
-          RunFft(pkt, fft_inout, mkl_handle);
-        }
+        // The payload is static per (symbol, antenna); with fft_in_rru it
+        // was FFT'd once at startup, so no per-packet transform runs here
+        const size_t payload_idx =
+            (pkt->symbol_id_ * cfg_->BsAntNum()) + tag.ant_id_;
+        std::memcpy(pkt->data_,
+                    (cfg_->FftInRru() == true) ? iq_data_fft_[payload_idx]
+                                               : iq_data_short_[payload_idx],
+                    (cfg_->CpLen() + cfg_->OfdmCaNum()) * (kUse12BitIQ ? 3 : 4));
 
 #ifndef USE_DPDK
         udp_client.Send(cfg_->BsServerAddr(), cfg_->BsServerPort() + cur_radio,
@@ -461,10 +463,7 @@ void* Sender::WorkerThread(int tid) {
     }  // if (num_tags > 0)
   }    // while (keep_running.load() == true)
 
-  DftiFreeDescriptor(&mkl_handle);
-
   std::free(static_cast<void*>(socks_pkt_buf));
-  std::free(static_cast<void*>(fft_inout));
   MLPD_FRAME("Sender: worker thread %d exit\n", tid);
   std::printf("Sender: worker thread %d exit\n", tid);
   return nullptr;
@@ -489,40 +488,35 @@ void Sender::InitIqFromFile(const std::string& filename) {
                         (cfg_->CpLen() + cfg_->OfdmCaNum()) * 2,
                         Agora_memory::Alignment_t::kAlign64);
 
-  Table<float> iq_data_float;
-  iq_data_float.Calloc(packets_per_frame,
-                       (cfg_->CpLen() + cfg_->OfdmCaNum()) * 2,
-                       Agora_memory::Alignment_t::kAlign64);
-
-  FILE* fp = std::fopen(filename.c_str(), "rb");
-  RtAssert(fp != nullptr, "Failed to open IQ data file");
-
+  // Convert straight out of the mapped file instead of staging the whole
+  // float file in a second heap table; the float pages are dropped by the
+  // kernel as soon as they fall out of the page cache
+  MmapReader iq_file(filename);
+  const size_t expected_count = (cfg_->CpLen() + cfg_->OfdmCaNum()) * 2;
   for (size_t i = 0; i < packets_per_frame; i++) {
-    const size_t expected_count = (cfg_->CpLen() + cfg_->OfdmCaNum()) * 2;
-    const size_t actual_count =
-        std::fread(iq_data_float[i], sizeof(float), expected_count, fp);
-    if (expected_count != actual_count) {
-      std::fprintf(
-          stderr,
-          "Sender: Failed to read IQ data file %s. Packet %zu: expected "
-          "%zu I/Q samples but read %zu. Errno %s\n",
-          filename.c_str(), i, expected_count, actual_count, strerror(errno));
+    const uint8_t* section =
+        iq_file.TryAt(i * expected_count * sizeof(float),
+                      expected_count * sizeof(float));
+    if (section == nullptr) {
+      std::fprintf(stderr,
+                   "Sender: Failed to read IQ data file %s. Packet %zu: "
+                   "expected %zu I/Q samples past end of file\n",
+                   filename.c_str(), i, expected_count);
       throw std::runtime_error("Sender: Failed to read IQ data file");
     }
+    const auto* iq_data_float = reinterpret_cast<const float*>(section);
     if (kUse12BitIQ) {
       // Adapt 32-bit IQ samples to 24-bit to reduce network throughput
-      ConvertFloatTo12bitIq(iq_data_float[i],
+      ConvertFloatTo12bitIq(iq_data_float,
                             reinterpret_cast<uint8_t*>(iq_data_short_[i]),
                             expected_count);
     } else {
       for (size_t j = 0; j < expected_count; j++) {
         iq_data_short_[i][j] =
-            static_cast<unsigned short>(iq_data_float[i][j] * 32768);
+            static_cast<unsigned short>(iq_data_float[j] * 32768);
       }
     }
   }
-  std::fclose(fp);
-  iq_data_float.Free();
 }
 
 void Sender::CreateWorkerThreads(size_t num_workers) {
@@ -542,17 +536,36 @@ void Sender::WriteStatsToFile(size_t tx_frame_count) const {
   }
 }
 
-void Sender::RunFft(Packet* pkt, complex_float* fft_inout,
-                    DFTI_DESCRIPTOR_HANDLE mkl_handle) const {
-  // pkt->data has (cp_len + ofdm_ca_num) unsigned short samples. After FFT,
-  // we'll remove the cyclic prefix and have ofdm_ca_num() short samples left.
-  SimdConvertShortToFloat(&pkt->data_[2 * cfg_->CpLen()],
-                          reinterpret_cast<float*>(fft_inout),
-                          cfg_->OfdmCaNum() * 2);
+void Sender::PrecomputeFftData() {
+  const size_t packets_per_frame =
+      cfg_->Frame().NumTotalSyms() * cfg_->BsAntNum();
+  const size_t samps_per_packet = cfg_->CpLen() + cfg_->OfdmCaNum();
+  iq_data_fft_.Calloc(packets_per_frame, samps_per_packet * 2,
+                      Agora_memory::Alignment_t::kAlign64);
+
+  DFTI_DESCRIPTOR_HANDLE mkl_handle;
+  DftiCreateDescriptor(&mkl_handle, DFTI_SINGLE, DFTI_COMPLEX, 1,
+                       cfg_->OfdmCaNum());
+  DftiCommitDescriptor(mkl_handle);
+  auto* fft_inout =
+      static_cast<complex_float*>(Agora_memory::PaddedAlignedAlloc(
+          Agora_memory::Alignment_t::kAlign64,
+          cfg_->OfdmCaNum() * sizeof(complex_float)));
 
-  DftiComputeForward(mkl_handle, reinterpret_cast<float*>(fft_inout));
+  for (size_t i = 0; i < packets_per_frame; i++) {
+    // Same payload transform the workers used to run per packet: skip the
+    // cyclic prefix, FFT, write the result back as packed float16
+    std::memcpy(iq_data_fft_[i], iq_data_short_[i],
+                samps_per_packet * 2 * sizeof(unsigned short));
+    SimdConvertShortToFloat(
+        reinterpret_cast<short*>(&iq_data_fft_[i][2 * cfg_->CpLen()]),
+        reinterpret_cast<float*>(fft_inout), cfg_->OfdmCaNum() * 2);
+    DftiComputeForward(mkl_handle, reinterpret_cast<float*>(fft_inout));
+    SimdConvertFloat32ToFloat16(reinterpret_cast<float*>(iq_data_fft_[i]),
+                                reinterpret_cast<float*>(fft_inout),
+                                cfg_->OfdmCaNum() * 2);
+  }
 
-  SimdConvertFloat32ToFloat16(reinterpret_cast<float*>(pkt->data_),
-                              reinterpret_cast<float*>(fft_inout),
-                              cfg_->OfdmCaNum() * 2);
+  DftiFreeDescriptor(&mkl_handle);
+  std::free(static_cast<void*>(fft_inout));
 }
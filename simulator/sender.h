@@ -88,18 +88,15 @@ class Sender {
   // Launch threads to run worker with thread IDs from tid_start to tid_end
   void CreateWorkerThreads(size_t num_workers);
 
-  void DelayForSymbol(size_t tx_frame_count, uint64_t tick_start);
-  void DelayForFrame(size_t tx_frame_count, uint64_t tick_start);
-
   void WriteStatsToFile(size_t tx_frame_count) const;
 
   size_t FindNextSymbol(size_t start_symbol);
   void ScheduleSymbol(size_t frame, size_t symbol_id);
 
-  // Run FFT on the data field in pkt, output to fft_inout
-  // Recombine pkt header data and fft output data into payload
-  void RunFft(Packet* pkt, complex_float* fft_inout,
-              DFTI_DESCRIPTOR_HANDLE mkl_handle) const;
+  // With fft_in_rru, run the FFT once per (symbol, antenna) over the static
+  // IQ data and store the wire-format payloads in iq_data_fft_, so the
+  // worker loop is reduced to header stamping and send
+  void PrecomputeFftData();
 
   Config* cfg_;
   const double freq_ghz_;           // RDTSC frequency in GHz
@@ -136,6 +133,10 @@ class Sender {
   // Second dimension: (CP_LEN + OFDM_CA_NUM) * 2
   Table<unsigned short> iq_data_short_;
 
+  // Post-FFT wire-format payloads, same dimensions as iq_data_short_.
+  // Allocated only with fft_in_rru; the data is static across the run
+  Table<unsigned short> iq_data_fft_;
+
   // Number of packets transmitted for each symbol in a frame
   size_t* packet_count_per_symbol_[kFrameWnd];
 
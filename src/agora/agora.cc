@@ -6,50 +6,191 @@
 #include "agora.h"
 
 #include <cmath>
+#include <cstring>
 #include <memory>
 
+#include "build_profile.h"
+#include "trace_ring.h"
+#include "utils_ldpc.h"
+
 static const bool kDebugDeferral = true;
 static const size_t kDefaultMessageQueueSize = 512;
 static const size_t kDefaultWorkerQueueSize = 256;
+// With hybrid polling, the master parks after this many consecutive empty
+// polls, and wakes on worker notification or after the timeout (which also
+// bounds the wait for packet RX, whose threads do not notify)
+static const size_t kMasterIdlePollsBeforePark = 1024;
+static const size_t kMasterParkTimeoutUs = 100;
+// Scratch capacity of each per-frame bump arena
+static const size_t kFrameArenaBytes = (1 << 20);
+// With deadline scheduling, the downlink chain becomes urgent once a frame
+// has consumed this fraction of the frame duration since its first RX symbol
+static const double kDeadlineUrgentFraction = 0.75;
+// With antenna load shedding (ant_shed_num), a frame whose uplink chain
+// overruns the frame duration engages shedding; it disengages after this
+// many consecutive frames finish under this fraction of the frame duration
+static const double kAntShedRecoverFraction = 0.85;
+static const size_t kAntShedRecoverFrames = 4;
+
+/// Short name of an event type, used to label monitored task queues
+static const char* EventTypeString(size_t event_type) {
+  switch (static_cast<EventType>(event_type)) {
+    case EventType::kPacketRX:
+      return "rx";
+    case EventType::kFFT:
+      return "fft";
+    case EventType::kZF:
+      return "zf";
+    case EventType::kDemul:
+      return "demul";
+    case EventType::kIFFT:
+      return "ifft";
+    case EventType::kPrecode:
+      return "precode";
+    case EventType::kPacketTX:
+      return "tx";
+    case EventType::kPacketPilotTX:
+      return "pilot_tx";
+    case EventType::kDecode:
+      return "decode";
+    case EventType::kEncode:
+      return "encode";
+    case EventType::kModul:
+      return "modul";
+    case EventType::kPacketFromMac:
+      return "from_mac";
+    case EventType::kPacketToMac:
+      return "to_mac";
+    case EventType::kFFTPilot:
+      return "fft_pilot";
+    default:
+      return "event";
+  }
+}
 
 Agora::Agora(Config* const cfg)
     : base_worker_core_offset_(cfg->CoreOffset() + 1 + cfg->SocketThreadNum()),
       config_(cfg),
       stats_(std::make_unique<Stats>(cfg)),
       phy_stats_(std::make_unique<PhyStats>(cfg, Direction::kUplink)),
-      csi_buffers_(kFrameWnd, cfg->UeAntNum(),
-                   cfg->BsAntNum() * cfg->OfdmDataNum()),
-      ul_zf_matrices_(kFrameWnd, cfg->OfdmDataNum(),
+      // Half-size cells when CSI is stored as fp16
+      csi_buffers_(cfg->FrameWnd(), cfg->UeAntNum(),
+                   (cfg->BsAntNum() * cfg->OfdmDataNum()) /
+                       (cfg->CsiFp16() ? 2 : 1)),
+      ul_zf_matrices_(cfg->FrameWnd(), cfg->OfdmDataNum(),
                       cfg->BsAntNum() * cfg->UeAntNum()),
-      demod_buffers_(kFrameWnd, cfg->Frame().NumULSyms(), cfg->UeAntNum(),
-                     kMaxModType * cfg->OfdmDataNum()),
-      decoded_buffer_(kFrameWnd, cfg->Frame().NumULSyms(), cfg->UeAntNum(),
-                      cfg->LdpcConfig().NumBlocksInSymbol() *
-                          Roundup<64>(cfg->NumBytesPerCb())),
-      dl_zf_matrices_(kFrameWnd, cfg->OfdmDataNum(),
+      // Half-size cells in the 4-bit packed LLR mode
+      demod_buffers_(cfg->FrameWnd(), cfg->Frame().NumULSyms(), cfg->UeAntNum(),
+                     ((kMaxModType * cfg->OfdmDataNum()) /
+                      (cfg->Llr4Bit() ? 2 : 1)) +
+                         kLdpcHelperFunctionInputBufferSizePaddingBytes),
+      // Sized for the highest modulation order so a runtime MCS switch can
+      // raise the per-symbol code block count without reallocation
+      decoded_buffer_(cfg->FrameWnd(), cfg->Frame().NumULSyms(), cfg->UeAntNum(),
+                      cfg->HardDemod()
+                          ? Roundup<64>((cfg->OfdmDataNum() * kMaxModType) / 8)
+                          : ((cfg->OfdmDataNum() * kMaxModType) /
+                             cfg->LdpcConfig().NumCbCodewLen()) *
+                                Roundup<64>(cfg->NumBytesPerCb())),
+      // No rows on uplink-only schedules: the precoder grid is the one
+      // large downlink buffer allocated outside InitializeDownlinkBuffers(),
+      // and a hot-swapped schedule can never add downlink symbols past the
+      // parse-time count (see Config::UpdateFrameSchedule())
+      dl_zf_matrices_((cfg->Frame().NumDLSyms() > 0) ? cfg->FrameWnd() : 0,
+                      cfg->OfdmDataNum(),
                       cfg->UeAntNum() * cfg->BsAntNum()) {
   std::string directory = TOSTRING(PROJECT_DIRECTORY);
   std::printf("Agora: project directory [%s], RDTSC frequency = %.2f GHz\n",
               directory.c_str(), cfg->FreqGhz());
 
+  // A binary built with BUILD_PROFILE has the doers' loop dimensions baked
+  // in; refuse a config with a different shape rather than corrupt buffers
+  RtAssert(BuildProfile::Matches(cfg->BsAntNum(), cfg->UeAntNum(),
+                                 cfg->OfdmCaNum(), cfg->OfdmDataNum(),
+                                 cfg->ModOrderBits()),
+           "Config dimensions do not match the compiled build profile");
+
+  // The windowed buffers above were sized with the runtime frame window;
+  // the slot ownership monitor must wrap at the same boundary
+  FrameSlotMonitor::SetWindow(cfg->FrameWnd());
+
+  if ((cfg->HarqCombining() == true) && (cfg->Frame().NumULSyms() > 0)) {
+    // One slot mirrors one demod_buffers_ cell so held and incoming LLRs
+    // share offsets; one slot per (UE, uplink symbol) key is the worst case
+    harq_store_ = std::make_unique<HarqStore>(
+        cfg->UeAntNum(), cfg->Frame().NumULSyms(),
+        (kMaxModType * cfg->OfdmDataNum()) +
+            kLdpcHelperFunctionInputBufferSizePaddingBytes,
+        cfg->UeAntNum() * cfg->Frame().NumULSyms());
+  }
+
+  if (cfg->TopologyPinning() == true) {
+    // Declare the thread roles up front and let the planner place them
+    // from the NUMA/frequency topology; the PinToCoreWithOffset() calls
+    // below then ignore their offset arithmetic
+    size_t worker_cores = cfg->WorkerThreadNum();
+    if (cfg->ShadowBench() == true) {
+      // The shadow worker pins as kWorker with an index past the
+      // production workers (and the MAC threads when those are enabled)
+      worker_cores += (kEnableMac ? cfg->MacThreadNum() : 0) + 1;
+    }
+    PlanCoreAllocation(
+        {{ThreadType::kMaster, 1},
+         {ThreadType::kWorkerTXRX, cfg->SocketThreadNum()},
+         {ThreadType::kWorker, worker_cores},
+         {ThreadType::kWorkerMacTXRX, kEnableMac ? cfg->MacThreadNum() : 0}});
+  }
   PinToCoreWithOffset(ThreadType::kMaster, cfg->CoreOffset(), 0,
                       false /* quiet */);
-  CheckIncrementScheduleFrame(0, ScheduleProcessingFlags::kProcessingComplete);
-  // Important to set cur_sche_frame_id_ after the call to
-  // CheckIncrementScheduleFrame because it will be incremented however,
-  // CheckIncrementScheduleFrame will initialize the schedule tracking variable
-  // correctly.
+  // Seed the per-frame schedule flags: components a frame doesn't have
+  // (no uplink or no downlink symbols) are pre-completed.
+  for (auto& flags : schedule_process_flags_) {
+    flags = ScheduleProcessingFlags::kNone;
+    if (cfg->Frame().NumULSyms() == 0) {
+      flags += ScheduleProcessingFlags::kUplinkComplete;
+    }
+    if (cfg->Frame().NumDLSyms() == 0) {
+      flags += ScheduleProcessingFlags::kDownlinkComplete;
+    }
+  }
   cur_sche_frame_id_ = 0;
   cur_proc_frame_id_ = 0;
 
+  for (auto& arena : frame_arenas_) {
+    arena.Alloc(kFrameArenaBytes);
+  }
+
+  // Until the first frame's stats arrive every worker polls the queues in
+  // the static order, so seed all primaries with the first polled type
+  for (auto& primary : worker_primary_event_) {
+    primary.store(static_cast<size_t>(EventType::kZF),
+                  std::memory_order_relaxed);
+  }
+
   InitializeQueues();
   InitializeUplinkBuffers();
   InitializeDownlinkBuffers();
+  // Flag hugepage fallbacks now rather than debugging them later as
+  // degraded demul throughput
+  Agora_memory::PrintAllocReport();
+  if (cfg->PrefaultBuffers() == true) {
+    PrefaultBuffers();
+  }
+  if (cfg->TraceFile().empty() == false) {
+    TraceLog::Instance().Start(cfg->TraceFile(), cfg->FreqGhz());
+  }
+#ifdef MLPD_ASYNC_LOG
+  AsyncLog::Instance().Start(stdout);
+#endif
+  if (cfg->PmuCounters() == true) {
+    PmuSampler::Enable();
+  }
 
   /* Initialize TXRX threads */
   packet_tx_rx_ = std::make_unique<PacketTXRX>(
       cfg, cfg->CoreOffset() + 1, &message_queue_,
       GetConq(EventType::kPacketTX, 0), rx_ptoks_ptr_, tx_ptoks_ptr_);
+  packet_tx_rx_->SetRxFrameWatermark(&completed_frame_watermark_);
 
   if (kEnableMac == true) {
     const size_t mac_cpu_core =
@@ -62,9 +203,132 @@ Agora::Agora(Config* const cfg)
         std::thread(&MacThreadBaseStation::RunEventLoop, mac_thread_.get());
   }
 
+  if ((cfg->DecodeOffload() == true) && (cfg->Frame().NumULSyms() > 0)) {
+    // Offloaded blocks bypass the local HARQ store, so the two features
+    // are mutually exclusive
+    RtAssert(cfg->HarqCombining() == false,
+             "decode_offload and harq_combining cannot both be set");
+    // Bridge core sits after the workers and the MAC threads
+    const size_t bridge_core = cfg->CoreOffset() + cfg->SocketThreadNum() +
+                               cfg->WorkerThreadNum() + 1 +
+                               (kEnableMac ? cfg->MacThreadNum() : 0);
+    decode_offload_ = std::make_unique<DecodeOffloadBridge>(
+        cfg, bridge_core, demod_buffers_, decoded_buffer_,
+        complete_task_queue_, kScheduleQueues, &master_notifier_);
+  }
+
+  if (cfg->GpuDecode() == true) {
+#ifdef USE_GPU_DECODE
+    // GPU batches bypass the local HARQ store and the offload tier; all
+    // three route the same kDecode events, so only one may own them
+    RtAssert(cfg->HarqCombining() == false,
+             "gpu_decode and harq_combining cannot both be set");
+    RtAssert(cfg->DecodeOffload() == false,
+             "gpu_decode and decode_offload cannot both be set");
+    const size_t gpu_core = cfg->CoreOffset() + cfg->SocketThreadNum() +
+                            cfg->WorkerThreadNum() + 1 +
+                            (kEnableMac ? cfg->MacThreadNum() : 0);
+    gpu_decode_ = std::make_unique<GpuDecodeEngine>(
+        cfg, gpu_core, demod_buffers_, decoded_buffer_, complete_task_queue_,
+        kScheduleQueues, &master_notifier_);
+#else
+    RtAssert(false, "gpu_decode requires building with USE_GPU_DECODE");
+#endif
+  }
+
+  if (cfg->ScShardNum() > 1) {
+    // Sharded instances only run the uplink chain; the bits and symbols a
+    // shard does not demodulate itself cannot feed downlink processing,
+    // hard demodulation, or a local MAC on the non-owners
+    RtAssert(cfg->Frame().NumDLSyms() == 0,
+             "Subcarrier sharding supports uplink-only configurations");
+    RtAssert(cfg->HardDemod() == false,
+             "Subcarrier sharding requires soft demodulation");
+    RtAssert((cfg->ScShardOwner() == true) || (kEnableMac == false),
+             "Only the shard owner can run the MAC thread");
+    // Bridge core sits after the workers, the MAC threads, and the decode
+    // offload bridge when those are enabled
+    const size_t shard_core = cfg->CoreOffset() + cfg->SocketThreadNum() +
+                              cfg->WorkerThreadNum() + 1 +
+                              (kEnableMac ? cfg->MacThreadNum() : 0) +
+                              ((decode_offload_ != nullptr) ? 1 : 0);
+    sc_shard_ = std::make_unique<ScShardBridge>(
+        cfg, shard_core, demod_buffers_, complete_task_queue_,
+        kScheduleQueues, &master_notifier_);
+  }
+
+  if (cfg->SplitMaster() == true) {
+    // The scheduling thread gets its own core after the workers, the MAC
+    // threads, and any bridge threads created above
+    sched_core_ = cfg->CoreOffset() + cfg->SocketThreadNum() +
+                  cfg->WorkerThreadNum() + 1 +
+                  (kEnableMac ? cfg->MacThreadNum() : 0) +
+                  ((decode_offload_ != nullptr) ? 1 : 0) +
+                  ((sc_shard_ != nullptr) ? 1 : 0);
+#ifdef USE_GPU_DECODE
+    sched_core_ += ((gpu_decode_ != nullptr) ? 1 : 0);
+#endif
+    sched_ring_ = std::make_unique<CompletionRing>();
+    sched_running_ = true;
+    sched_std_thread_ = std::thread(&Agora::RunSchedLoop, this);
+  }
+
+  if ((cfg->FrameDumpDecode() == true) || (cfg->FrameDumpTx() == true)) {
+    // The spool thread gets the next core after the workers, the MAC
+    // threads, and any bridge/scheduling threads created above
+    size_t dump_core = cfg->CoreOffset() + cfg->SocketThreadNum() +
+                       cfg->WorkerThreadNum() + 1 +
+                       (kEnableMac ? cfg->MacThreadNum() : 0) +
+                       ((decode_offload_ != nullptr) ? 1 : 0) +
+                       ((sc_shard_ != nullptr) ? 1 : 0) +
+                       ((sched_ring_ != nullptr) ? 1 : 0);
+#ifdef USE_GPU_DECODE
+    dump_core += ((gpu_decode_ != nullptr) ? 1 : 0);
+#endif
+    frame_dumper_ = std::make_unique<FrameDumper>(
+        cfg, dump_core, decoded_buffer_, dl_socket_buffer_);
+  }
+
+  if (cfg->EqualExport() == true) {
+    equal_export_ = std::make_unique<EqualExport>(cfg);
+  }
+
   // Create worker threads
   CreateThreads();
 
+  if ((cfg->ShadowBench() == true) && (cfg->Frame().NumULSyms() > 0)) {
+    // Spare worker core after the production workers (and the MAC threads
+    // when those are enabled)
+    const size_t shadow_core_id =
+        cfg->WorkerThreadNum() + (kEnableMac ? cfg->MacThreadNum() : 0);
+    shadow_bench_ = std::make_unique<ShadowBench>(
+        cfg, base_worker_core_offset_, shadow_core_id, data_buffer_,
+        ul_zf_matrices_, ue_spec_pilot_buffer_, stats_.get());
+  }
+
+  if (cfg->TelemetryAddr().empty() == false) {
+    telemetry_ = std::make_unique<TelemetryReporter>(
+        cfg, stats_.get(), phy_stats_.get(), &rx_counters_);
+    telemetry_->AddQueue("message", &message_queue_);
+    static const std::array<EventType, 7> kTelemetryEventTypes = {
+        EventType::kFFT,    EventType::kZF,     EventType::kDemul,
+        EventType::kDecode, EventType::kEncode, EventType::kPrecode,
+        EventType::kIFFT};
+    static const std::array<const char*, 7> kTelemetryEventNames = {
+        "fft", "zf", "demul", "decode", "encode", "precode", "ifft"};
+    for (size_t qid = 0; qid < kScheduleQueues; qid++) {
+      telemetry_->AddQueue("complete_q" + std::to_string(qid),
+                           &complete_task_queue_[qid]);
+      for (size_t i = 0; i < kTelemetryEventTypes.size(); i++) {
+        telemetry_->AddQueue(
+            std::string(kTelemetryEventNames.at(i)) + "_q" +
+                std::to_string(qid),
+            GetConq(kTelemetryEventTypes.at(i), qid));
+      }
+    }
+    telemetry_->Start();
+  }
+
   MLPD_INFO(
       "Master thread core %zu, TX/RX thread cores %zu--%zu, worker thread "
       "cores %zu--%zu\n",
@@ -75,6 +339,33 @@ Agora::Agora(Config* const cfg)
 }
 
 Agora::~Agora() {
+  // Stop telemetry first: its snapshot thread reads the queues and stats
+  // that the rest of the teardown frees
+  if (telemetry_ != nullptr) {
+    telemetry_->Stop();
+  }
+  // The shadow worker reads the live uplink buffers; retire it (and print
+  // its A/B report) before the teardown frees them
+  shadow_bench_.reset();
+  // The offload bridge reads the demod buffers and writes the decoded
+  // buffer; retire it before the teardown frees them
+  decode_offload_.reset();
+#ifdef USE_GPU_DECODE
+  // The GPU engine stages from the demod buffers and writes the decoded
+  // buffer; same ordering applies
+  gpu_decode_.reset();
+#endif
+  // The shard bridge reads (non-owner) or writes (owner) the demod
+  // buffers; same ordering applies
+  sc_shard_.reset();
+  // The frame-dump spooler reads the decoded and DL socket buffers; drain
+  // and close its capture files before the teardown frees them
+  frame_dumper_.reset();
+  // Retire the scheduling thread before the worker queues it feeds go away
+  if (sched_std_thread_.joinable() == true) {
+    sched_running_ = false;
+    sched_std_thread_.join();
+  }
   if (kEnableMac == true) {
     mac_std_thread_.join();
   }
@@ -89,6 +380,15 @@ Agora::~Agora() {
   stats_.reset();
   phy_stats_.reset();
   FreeQueues();
+  // Workers are joined, so every ring's tail is safe to flush
+  TraceLog::Instance().Stop();
+#ifdef MLPD_ASYNC_LOG
+  AsyncLog::Instance().Stop();
+#endif
+  if (config_->TraceFile().empty() == false) {
+    TraceLog::ExportChromeTrace(config_->TraceFile(),
+                                config_->TraceFile() + ".json");
+  }
 }
 
 void Agora::Stop() {
@@ -113,11 +413,75 @@ void Agora::SendSnrReport(EventType event_type, size_t frame_id,
   }
 }
 
+void Agora::EnqueueWorkerEvent(EventType event_type, size_t qid,
+                               const EventData& event) {
+  if (config_->WorkStealSched() == true) {
+    // Distribute tasks over the per-worker queues in round-robin order.
+    // Workers that run dry steal from their peers, so the exact placement
+    // only affects the common (uncontended) case.
+    const size_t worker = steal_rr_cursor_++ % config_->WorkerThreadNum();
+    SchedInfoT& sched = steal_info_arr_[qid][worker];
+    TryEnqueueFallback(&sched.concurrent_q_, sched.ptok_, event);
+  } else {
+    TryEnqueueFallback(GetConq(event_type, qid), GetPtok(event_type, qid),
+                       event);
+  }
+}
+
+void Agora::UpdateDownlinkUrgency(size_t frame_id) {
+  const double elapsed_us =
+      this->stats_->MasterGetUsSince(TsType::kFirstSymbolRX, frame_id);
+  const double urgent_after_us =
+      config_->GetFrameDurationSec() * 1e6 * kDeadlineUrgentFraction;
+  this->dl_urgent_.store(elapsed_us > urgent_after_us,
+                         std::memory_order_relaxed);
+}
+
+void Agora::UpdateAntShed(size_t frame_id) {
+  const double frame_us = this->stats_->MasterGetDeltaUs(
+      TsType::kDecodeDone, TsType::kFirstSymbolRX, frame_id);
+  const double budget_us = config_->GetFrameDurationSec() * 1e6;
+  // Latch far enough ahead that every frame already scheduled keeps the
+  // antenna count its FFT skipping started with; DoZF reads the same
+  // per-frame value, so skipped antennas always get zeroed beamweights
+  const size_t effective_frame = frame_id + (2 * kScheduleQueues);
+  if (ant_shed_engaged_ == false) {
+    if (frame_us > budget_us) {
+      ant_shed_engaged_ = true;
+      ant_shed_recover_streak_ = 0;
+      config_->SetAntShed(config_->AntShedNum(), effective_frame);
+      MLPD_WARN(
+          "Agora: frame %zu overran its budget (%.1f of %.1f us), shedding "
+          "%zu antennas from frame %zu\n",
+          frame_id, frame_us, budget_us, config_->AntShedNum(),
+          effective_frame);
+    }
+  } else {
+    if (frame_us < (budget_us * kAntShedRecoverFraction)) {
+      ant_shed_recover_streak_++;
+      if (ant_shed_recover_streak_ >= kAntShedRecoverFrames) {
+        ant_shed_engaged_ = false;
+        config_->SetAntShed(0, effective_frame);
+        MLPD_INFO(
+            "Agora: frame %zu back under budget (%.1f of %.1f us), restoring "
+            "the full array from frame %zu\n",
+            frame_id, frame_us, budget_us, effective_frame);
+      }
+    } else {
+      ant_shed_recover_streak_ = 0;
+    }
+  }
+}
+
 void Agora::ScheduleDownlinkProcessing(size_t frame_id) {
   size_t num_pilot_symbols = config_->Frame().ClientDlPilotSymbols();
 
+  if (config_->DeadlineSched() == true) {
+    UpdateDownlinkUrgency(frame_id);
+  }
+
   for (size_t i = 0; i < num_pilot_symbols; i++) {
-    if (zf_last_frame_ == frame_id) {
+    if (BeamformerReady(frame_id)) {
       ScheduleSubcarriers(EventType::kPrecode, frame_id,
                           config_->Frame().GetDLSymbol(i));
     } else {
@@ -144,7 +508,7 @@ void Agora::ScheduleAntennas(EventType event_type, size_t frame_id,
   EventData event;
   event.num_tags_ = config_->FftBlockSize();
   event.event_type_ = event_type;
-  size_t qid = frame_id & 0x1;
+  size_t qid = frame_id % kScheduleQueues;
   for (size_t i = 0; i < num_blocks; i++) {
     if ((i == num_blocks - 1) && num_remainder > 0) {
       event.num_tags_ = num_remainder;
@@ -153,8 +517,7 @@ void Agora::ScheduleAntennas(EventType event_type, size_t frame_id,
       event.tags_[j] = base_tag.tag_;
       base_tag.ant_id_++;
     }
-    TryEnqueueFallback(GetConq(event_type, qid), GetPtok(event_type, qid),
-                       event);
+    EnqueueWorkerEvent(event_type, qid, event);
   }
 }
 
@@ -196,7 +559,23 @@ void Agora::ScheduleAntennasTX(size_t frame_id, size_t symbol_id) {
 
 void Agora::ScheduleSubcarriers(EventType event_type, size_t frame_id,
                                 size_t symbol_id) {
-  auto base_tag = gen_tag_t::FrmSymSc(frame_id, symbol_id, 0);
+  if (sched_ring_ != nullptr) {
+    EventData cmd(event_type, gen_tag_t::FrmSym(frame_id, symbol_id).tag_);
+    while (sched_ring_->TryPush(cmd) == false) {
+      GetTime::SpinPause();
+    }
+    return;
+  }
+  ScheduleSubcarriersInternal(event_type, frame_id, symbol_id);
+}
+
+void Agora::ScheduleSubcarriersInternal(EventType event_type, size_t frame_id,
+                                        size_t symbol_id) {
+  // Under subcarrier sharding tags keep their absolute subcarrier ids;
+  // each instance simply starts its schedule at its shard's first
+  // subcarrier (0 when the band is not sharded)
+  const size_t shard_start = config_->ScShardStart();
+  auto base_tag = gen_tag_t::FrmSymSc(frame_id, symbol_id, shard_start);
   size_t num_events = SIZE_MAX;
   size_t block_size = SIZE_MAX;
 
@@ -214,11 +593,59 @@ void Agora::ScheduleSubcarriers(EventType event_type, size_t frame_id,
       assert(false);
   }
 
-  size_t qid = (frame_id & 0x1);
-  if (event_type == EventType::kZF) {
+  size_t qid = (frame_id % kScheduleQueues);
+
+  if (((event_type == EventType::kDemul) &&
+       (ul_block_mask_ != UINT64_MAX)) ||
+      ((event_type == EventType::kZF) && (zf_block_mask_ != UINT64_MAX))) {
+    // Resource-block-allocation-aware scheduling: walk only the allocated
+    // blocks. This is the low-occupancy regime, so losing the range/batch
+    // encodings does not matter -- the event count already shrank with
+    // the band. The per-symbol task budgets were reduced to the mask's
+    // popcount when it was applied (ApplyUlBlockMask)
+    const uint64_t block_mask =
+        (event_type == EventType::kZF) ? zf_block_mask_ : ul_block_mask_;
+    for (size_t i = 0; i < num_events; i++) {
+      if (((block_mask >> i) & 1ULL) == 0) {
+        continue;
+      }
+      EnqueueWorkerEvent(
+          event_type, qid,
+          EventData(event_type, gen_tag_t::FrmSymSc(frame_id, symbol_id,
+                                                    shard_start +
+                                                        (i * block_size))
+                                    .tag_));
+    }
+    return;
+  }
+
+  const size_t batch_size = (event_type == EventType::kZF)
+                                ? config_->ZfBatchSize()
+                                : config_->DemulBatchSize();
+  if (((event_type == EventType::kZF) || (event_type == EventType::kDemul)) &&
+      (batch_size > EventData::kMaxTags)) {
+    // Batches too large for the inline tag array are encoded as range
+    // events: a base tag, a task count, and the raw tag stride between
+    // consecutive subcarrier blocks. One event then covers hundreds of
+    // blocks instead of ceil(batch / kMaxTags) tag-list events.
+    const size_t tag_stride =
+        gen_tag_t::FrmSymSc(frame_id, symbol_id, shard_start + block_size)
+            .tag_ -
+        base_tag.tag_;
+    for (size_t i = 0; i < num_events; i += batch_size) {
+      const size_t count = std::min(batch_size, num_events - i);
+      EventData event(event_type,
+                      gen_tag_t::FrmSymSc(frame_id, symbol_id,
+                                          shard_start + (i * block_size))
+                          .tag_,
+                      count, tag_stride);
+      EnqueueWorkerEvent(event_type, qid, event);
+    }
+  } else if ((event_type == EventType::kZF) ||
+             ((event_type == EventType::kDemul) && (batch_size > 1))) {
     EventData event;
     event.event_type_ = event_type;
-    event.num_tags_ = config_->ZfBatchSize();
+    event.num_tags_ = batch_size;
     size_t num_blocks = num_events / event.num_tags_;
     size_t num_remainder = num_events % event.num_tags_;
     if (num_remainder > 0) {
@@ -230,27 +657,120 @@ void Agora::ScheduleSubcarriers(EventType event_type, size_t frame_id,
       }
       for (size_t j = 0; j < event.num_tags_; j++) {
         event.tags_[j] =
-            gen_tag_t::FrmSymSc(frame_id, symbol_id,
-                                block_size * (i * event.num_tags_ + j))
+            gen_tag_t::FrmSymSc(
+                frame_id, symbol_id,
+                shard_start + (block_size * (i * event.num_tags_ + j)))
                 .tag_;
       }
-      TryEnqueueFallback(GetConq(event_type, qid), GetPtok(event_type, qid),
-                         event);
+      EnqueueWorkerEvent(event_type, qid, event);
     }
   } else {
     for (size_t i = 0; i < num_events; i++) {
-      TryEnqueueFallback(GetConq(event_type, qid), GetPtok(event_type, qid),
-                         EventData(event_type, base_tag.tag_));
+      EnqueueWorkerEvent(event_type, qid, EventData(event_type, base_tag.tag_));
       base_tag.sc_id_ += block_size;
     }
   }
 }
 
+void Agora::MarkZfBlockDone(size_t frame_id, size_t base_sc_id) {
+  const size_t frame_slot = (frame_id % config_->FrameWnd());
+  const size_t num_zf = config_->ZfEventsPerSymbol();
+  if (zf_block_frame_.at(frame_slot) != frame_id) {
+    // First ZF block of this frame: recycle the slot's flags. The
+    // previous tenant left the window a full frame window ago
+    zf_block_frame_.at(frame_slot) = frame_id;
+    std::fill_n(&zf_block_done_.at(frame_slot * num_zf), num_zf, 0);
+    const size_t flags_per_slot =
+        config_->Frame().NumULSyms() * config_->DemulEventsPerSymbol();
+    std::fill_n(&demul_block_released_.at(frame_slot * flags_per_slot),
+                flags_per_slot, 0);
+  }
+  const size_t block_idx =
+      (base_sc_id - config_->ScShardStart()) / config_->ZfBlockSize();
+  zf_block_done_.at((frame_slot * num_zf) + block_idx) = 1;
+
+  for (size_t i = 0; i < config_->Frame().NumULSyms(); i++) {
+    if (fft_cur_frame_for_symbol_.at(i) == frame_id) {
+      ReleaseReadyDemulBlocks(frame_id, config_->Frame().GetULSymbol(i));
+    }
+  }
+}
+
+void Agora::ReleaseReadyDemulBlocks(size_t frame_id, size_t symbol_id) {
+  const size_t frame_slot = (frame_id % config_->FrameWnd());
+  if (zf_block_frame_.at(frame_slot) != frame_id) {
+    return;  // No beamweights for this frame have landed yet
+  }
+  const size_t num_zf = config_->ZfEventsPerSymbol();
+  const size_t num_demul = config_->DemulEventsPerSymbol();
+  const size_t demul_block = config_->DemulBlockSize();
+  const size_t zf_block = config_->ZfBlockSize();
+  const size_t shard_start = config_->ScShardStart();
+  const uint8_t* zf_done = &zf_block_done_.at(frame_slot * num_zf);
+  uint8_t* released = &demul_block_released_.at(
+      ((frame_slot * config_->Frame().NumULSyms()) +
+       config_->Frame().GetULSymbolIdx(symbol_id)) *
+      num_demul);
+  const size_t qid = (frame_id % kScheduleQueues);
+  for (size_t d = 0; d < num_demul; d++) {
+    if (released[d] != 0) {
+      continue;
+    }
+    if (UlBlockAllocated(d) == false) {
+      released[d] = 1;  // Unallocated under the RB mask: nothing to run
+      continue;
+    }
+    // Demul block d is ready once every ZF block overlapping its
+    // subcarrier range has delivered weights
+    const size_t zf_lo = (d * demul_block) / zf_block;
+    const size_t zf_hi =
+        std::min((((d + 1) * demul_block) - 1) / zf_block, num_zf - 1);
+    bool ready = true;
+    for (size_t z = zf_lo; z <= zf_hi; z++) {
+      if (zf_done[z] == 0) {
+        ready = false;
+        break;
+      }
+    }
+    if (ready == false) {
+      continue;
+    }
+    released[d] = 1;
+    EnqueueWorkerEvent(
+        EventType::kDemul, qid,
+        EventData(EventType::kDemul,
+                  gen_tag_t::FrmSymSc(frame_id, symbol_id,
+                                      shard_start + (d * demul_block))
+                      .tag_));
+  }
+}
+
 void Agora::ScheduleCodeblocks(EventType event_type, size_t frame_id,
                                size_t symbol_idx) {
+  if (sched_ring_ != nullptr) {
+    EventData cmd(event_type, gen_tag_t::FrmSym(frame_id, symbol_idx).tag_);
+    while (sched_ring_->TryPush(cmd) == false) {
+      GetTime::SpinPause();
+    }
+    return;
+  }
+  ScheduleCodeblocksInternal(event_type, frame_id, symbol_idx);
+}
+
+void Agora::ScheduleCodeblocksInternal(EventType event_type, size_t frame_id,
+                                       size_t symbol_idx) {
+  const bool offload =
+      (event_type == EventType::kDecode) && (decode_offload_ != nullptr);
   auto base_tag = gen_tag_t::FrmSymCb(frame_id, symbol_idx, 0);
   const size_t num_tasks =
       config_->UeAntNum() * config_->LdpcConfig().NumBlocksInSymbol();
+#ifdef USE_GPU_DECODE
+  // Hybrid routing: symbols with enough code blocks amortize the GPU
+  // transfer latency; small transport blocks keep the CPU path
+  const bool gpu = (event_type == EventType::kDecode) &&
+                   (gpu_decode_ != nullptr) &&
+                   (num_tasks >= config_->GpuDecodeMinCbs());
+#endif
   size_t num_blocks = num_tasks / config_->EncodeBlockSize();
   const size_t num_remainder = num_tasks % config_->EncodeBlockSize();
   if (num_remainder > 0) {
@@ -259,7 +779,7 @@ void Agora::ScheduleCodeblocks(EventType event_type, size_t frame_id,
   EventData event;
   event.num_tags_ = config_->EncodeBlockSize();
   event.event_type_ = event_type;
-  size_t qid = frame_id & 0x1;
+  size_t qid = frame_id % kScheduleQueues;
   for (size_t i = 0; i < num_blocks; i++) {
     if ((i == num_blocks - 1) && num_remainder > 0) {
       event.num_tags_ = num_remainder;
@@ -268,9 +788,83 @@ void Agora::ScheduleCodeblocks(EventType event_type, size_t frame_id,
       event.tags_[j] = base_tag.tag_;
       base_tag.cb_id_++;
     }
-    TryEnqueueFallback(GetConq(event_type, qid), GetPtok(event_type, qid),
-                       event);
+#ifdef USE_GPU_DECODE
+    if (gpu == true) {
+      // Route to the GPU engine; decoded bits and the completion events
+      // come back through its stream-completion path
+      gpu_decode_->Offload(event);
+      continue;
+    }
+#endif
+    if (offload == true) {
+      // Route to the offload bridge; decoded bits and the completion
+      // events come back through its receive path
+      decode_offload_->Offload(event);
+    } else {
+      EnqueueWorkerEvent(event_type, qid, event);
+    }
+  }
+}
+
+void Agora::RunSchedLoop() {
+  PinToCoreWithOffset(ThreadType::kMaster, sched_core_, 0);
+  std::printf("Agora: scheduling thread running on core %zu\n", sched_core_);
+
+  while (sched_running_.load(std::memory_order_relaxed) == true) {
+    EventData cmd;
+    if (sched_ring_->TryPop(cmd) == false) {
+      GetTime::SpinPause();
+      continue;
+    }
+    const gen_tag_t tag(cmd.tags_[0]);
+    switch (cmd.event_type_) {
+      case EventType::kZF:
+      case EventType::kDemul:
+      case EventType::kPrecode:
+        ScheduleSubcarriersInternal(cmd.event_type_, tag.frame_id_,
+                                    tag.symbol_id_);
+        break;
+      case EventType::kDecode:
+      case EventType::kEncode:
+        ScheduleCodeblocksInternal(cmd.event_type_, tag.frame_id_,
+                                   tag.symbol_id_);
+        break;
+      default:
+        MLPD_ERROR("Wrong command type in schedule ring!\n");
+        break;
+    }
+  }
+}
+
+bool Agora::ScheduleShardedDecode(size_t frame_id, size_t symbol_id) {
+  if (config_->ScShardOwner() == false) {
+    // Forward this shard's LLR slices to the owner; decode (and the MAC
+    // handoff) happen there, so account the symbol as decoded here the
+    // same way the hard-demod path does
+    sc_shard_->ForwardSymbol(frame_id, symbol_id);
+    bool last_decode_symbol = this->decode_counters_.CompleteSymbol(frame_id);
+    if (last_decode_symbol == true) {
+      this->stats_->MasterSetTsc(TsType::kDecodeDone, frame_id);
+      PrintPerFrameDone(PrintType::kDecode, frame_id);
+      if (config_->AntShedNum() > 0) {
+        UpdateAntShed(frame_id);
+      }
+      assert(this->cur_proc_frame_id_ == frame_id);
+      return this->CheckFrameComplete(frame_id);
+    }
+    return false;
+  }
+  // Owner: run decode once the remote shards' LLRs for this symbol have
+  // been merged into the demod buffer as well
+  const size_t frame_slot = frame_id % config_->FrameWnd();
+  const size_t symbol_idx_ul = config_->Frame().GetULSymbolIdx(symbol_id);
+  shard_demul_done_.at(frame_slot).at(symbol_idx_ul) = true;
+  if (shard_llr_done_.at(frame_slot).at(symbol_idx_ul) == true) {
+    shard_demul_done_.at(frame_slot).at(symbol_idx_ul) = false;
+    shard_llr_done_.at(frame_slot).at(symbol_idx_ul) = false;
+    ScheduleCodeblocks(EventType::kDecode, frame_id, symbol_id);
   }
+  return false;
 }
 
 void Agora::ScheduleUsers(EventType event_type, size_t frame_id,
@@ -300,11 +894,16 @@ void Agora::Start() {
 
   PinToCoreWithOffset(ThreadType::kMaster, cfg->CoreOffset(), 0);
 
+  // All queues exist by now; from here on, a block-sized queue allocation
+  // means a capacity in InitializeQueues() is undersized
+  Agora_memory::QueueArenaSeal();
+
   // Counters for printing summary
   size_t tx_count = 0;
   double tx_begin = GetTime::GetTimeUs();
 
   bool is_turn_to_dequeue_from_io = true;
+  size_t idle_polls = 0;
   const size_t max_events_needed =
       std::max(kDequeueBulkSizeTXRX * (cfg->SocketThreadNum() + 1 /* MAC */),
                kDequeueBulkSizeWorker * cfg->WorkerThreadNum());
@@ -326,12 +925,39 @@ void Agora::Start() {
             events_list + num_events, kDequeueBulkSizeTXRX);
       }
     } else {
-      num_events +=
-          complete_task_queue_[(this->cur_proc_frame_id_ & 0x1)]
-              .try_dequeue_bulk(events_list + num_events, max_events_needed);
+      if (kUseSpscCompletion == true) {
+        // Sweep the per-worker completion rings for the current queue set
+        const size_t ring_qid = (this->cur_proc_frame_id_ % kScheduleQueues);
+        for (size_t i = 0; (i < cfg->WorkerThreadNum()) &&
+                           (num_events < max_events_needed);
+             i++) {
+          while ((num_events < max_events_needed) &&
+                 (completion_rings_[ring_qid][i].TryPop(
+                      events_list[num_events]) == true)) {
+            num_events++;
+          }
+        }
+      } else {
+        num_events +=
+            complete_task_queue_[(this->cur_proc_frame_id_ % kScheduleQueues)]
+                .try_dequeue_bulk(events_list + num_events, max_events_needed);
+      }
     }
     is_turn_to_dequeue_from_io = !is_turn_to_dequeue_from_io;
 
+    // Busy-poll while events arrive; park once the frame schedule goes
+    // idle so the master core's power budget is available to the workers
+    if (cfg->HybridPolling() == true) {
+      if (num_events == 0) {
+        idle_polls++;
+        if (idle_polls >= kMasterIdlePollsBeforePark) {
+          master_notifier_.Park(kMasterParkTimeoutUs);
+        }
+      } else {
+        idle_polls = 0;
+      }
+    }
+
     // Handle each event
     for (size_t ev_i = 0; ev_i < num_events; ev_i++) {
       EventData& event = events_list[ev_i];
@@ -341,19 +967,30 @@ void Agora::Start() {
         case EventType::kPacketRX: {
           Packet* pkt = rx_tag_t(event.tags_[0]).rx_packet_->RawPacket();
 
-          if (pkt->frame_id_ >= ((this->cur_sche_frame_id_ + kFrameWnd))) {
+          if (pkt->frame_id_ >=
+              (this->cur_sche_frame_id_ + config_->FrameWnd())) {
             MLPD_ERROR(
                 "Error: Received packet for future frame %u beyond "
                 "frame window (= %zu + %zu). This can happen if "
                 "Agora is running slowly, e.g., in debug mode\n",
-                pkt->frame_id_, this->cur_sche_frame_id_, kFrameWnd);
+                pkt->frame_id_, this->cur_sche_frame_id_, config_->FrameWnd());
             cfg->Running(false);
             break;
           }
 
-          UpdateRxCounters(pkt->frame_id_, pkt->symbol_id_);
-          fft_queue_arr_[pkt->frame_id_ % kFrameWnd].push(
-              fft_req_tag_t(event.tags_[0]));
+          const bool accepted = UpdateRxCounters(pkt->frame_id_,
+                                                 pkt->symbol_id_, pkt->ant_id_);
+          if (accepted == true) {
+            fft_queue_arr_[pkt->frame_id_ % config_->FrameWnd()].push(
+                fft_req_tag_t(event.tags_[0]));
+          } else {
+            // Duplicate or straggler beyond the window: release the RX
+            // buffer without scheduling an FFT. In frame-epoch mode the
+            // slot is reclaimed by the watermark instead
+            if (config_->RxEpochReclaim() == false) {
+              rx_tag_t(event.tags_[0]).rx_packet_->Free();
+            }
+          }
         } break;
 
         case EventType::kFFT: {
@@ -363,14 +1000,43 @@ void Agora::Start() {
         } break;
 
         case EventType::kZF: {
-          for (size_t tag_id = 0; (tag_id < event.num_tags_); tag_id++) {
-            size_t frame_id = gen_tag_t(event.tags_[tag_id]).frame_id_;
+          for (size_t tag_id = 0; (tag_id < event.NumTasks()); tag_id++) {
+            size_t frame_id = gen_tag_t(event.Tag(tag_id)).frame_id_;
+            if (zf_block_done_.empty() == false) {
+              MarkZfBlockDone(frame_id, gen_tag_t(event.Tag(tag_id)).sc_id_);
+            }
             PrintPerTaskDone(PrintType::kZF, frame_id, 0,
                              zf_counters_.GetTaskCount(frame_id));
             bool last_zf_task = this->zf_counters_.CompleteTask(frame_id);
             if (last_zf_task == true) {
+              const size_t frame_slot = frame_id % config_->FrameWnd();
+              if ((zf_partial_frame_.at(frame_slot) == frame_id) &&
+                  (zf_partial_state_.at(frame_slot) ==
+                   ZfPartialState::kRefineInFlight)) {
+                // Full-CSI refinement pass: the beamweights improved in
+                // place, and the downstream demul/precode work was
+                // already scheduled when the partial pass finished
+                this->zf_counters_.Reset(frame_id);
+                zf_partial_frame_.at(frame_slot) = SIZE_MAX;
+                zf_partial_state_.at(frame_slot) = ZfPartialState::kIdle;
+                continue;
+              }
               this->stats_->MasterSetTsc(TsType::kZFDone, frame_id);
-              zf_last_frame_ = frame_id;
+              // With CSI prediction the ZF pass for this frame also
+              // produced the next frame's beamweights
+              zf_last_frame_ = (config_->ZfPredictFrames() > 0)
+                                   ? (frame_id + 1)
+                                   : frame_id;
+              if ((chained_fft_task_counts_ != nullptr) &&
+                  (ul_block_mask_ == UINT64_MAX)) {
+                // Publish to the DoFFT workers so later FFT completions
+                // can chain straight into demul. With an RB allocation
+                // mask active the publish is withheld: the workers only
+                // know how to dispatch the full band, so the master
+                // claims and schedules every symbol itself
+                chained_beam_ready_frame_.store(zf_last_frame_,
+                                                std::memory_order_release);
+              }
               PrintPerFrameDone(PrintType::kZF, frame_id);
               this->zf_counters_.Reset(frame_id);
               if (kPrintZfStats) {
@@ -378,9 +1044,18 @@ void Agora::Start() {
               }
 
               for (size_t i = 0; i < cfg->Frame().NumULSyms(); i++) {
-                if (this->fft_cur_frame_for_symbol_.at(i) == frame_id) {
-                  ScheduleSubcarriers(EventType::kDemul, frame_id,
-                                      cfg->Frame().GetULSymbol(i));
+                const size_t fft_frame = this->fft_cur_frame_for_symbol_.at(i);
+                const size_t ul_symbol = cfg->Frame().GetULSymbol(i);
+                if ((fft_frame >= frame_id) && (fft_frame <= zf_last_frame_) &&
+                    (TryClaimChainedDemul(fft_frame, ul_symbol) == true)) {
+                  if (config_->ZfBlockGatedDemul() == true) {
+                    // Stragglers only: the per-block completions already
+                    // released everything they could
+                    ReleaseReadyDemulBlocks(fft_frame, ul_symbol);
+                  } else {
+                    ScheduleSubcarriers(EventType::kDemul, fft_frame,
+                                        ul_symbol);
+                  }
                 }
               }
               // Schedule precoding for downlink symbols
@@ -393,60 +1068,140 @@ void Agora::Start() {
                                       cfg->Frame().GetDLSymbol(i));
                 }
               }
+              if (zf_partial_frame_.at(frame_slot) == frame_id) {
+                if (zf_partial_state_.at(frame_slot) ==
+                    ZfPartialState::kRefinePending) {
+                  // Full CSI arrived while the partial pass was
+                  // draining; rerun now that the counters are clean
+                  zf_partial_state_.at(frame_slot) =
+                      ZfPartialState::kRefineInFlight;
+                  ScheduleSubcarriers(EventType::kZF, frame_id, 0);
+                } else {
+                  zf_partial_state_.at(frame_slot) =
+                      ZfPartialState::kPartialDone;
+                }
+              }
             }  // end if (zf_counters_.last_task(frame_id) == true)
           }
         } break;
 
         case EventType::kDemul: {
-          size_t frame_id = gen_tag_t(event.tags_[0]).frame_id_;
-          size_t symbol_id = gen_tag_t(event.tags_[0]).symbol_id_;
-          size_t base_sc_id = gen_tag_t(event.tags_[0]).sc_id_;
-
-          PrintPerTaskDone(PrintType::kDemul, frame_id, symbol_id, base_sc_id);
-          bool last_demul_task =
-              this->demul_counters_.CompleteTask(frame_id, symbol_id);
-
-          if (last_demul_task == true) {
-            ScheduleCodeblocks(EventType::kDecode, frame_id, symbol_id);
-            PrintPerSymbolDone(PrintType::kDemul, frame_id, symbol_id);
-            bool last_demul_symbol =
-                this->demul_counters_.CompleteSymbol(frame_id);
-            if (last_demul_symbol == true) {
-              this->demul_counters_.Reset(frame_id);
-              max_equaled_frame_ = frame_id;
-              if (cfg->BigstationMode() == false) {
-                assert(cur_sche_frame_id_ == frame_id);
-                CheckIncrementScheduleFrame(frame_id, kUplinkComplete);
+          for (size_t tag_id = 0; tag_id < event.NumTasks(); tag_id++) {
+            size_t frame_id = gen_tag_t(event.Tag(tag_id)).frame_id_;
+            size_t symbol_id = gen_tag_t(event.Tag(tag_id)).symbol_id_;
+            size_t base_sc_id = gen_tag_t(event.Tag(tag_id)).sc_id_;
+
+            PrintPerTaskDone(PrintType::kDemul, frame_id, symbol_id,
+                             base_sc_id);
+            if (shadow_bench_ != nullptr) {
+              shadow_bench_->MaybeSubmit(event.Tag(tag_id));
+            }
+            bool last_demul_task =
+                this->demul_counters_.CompleteTask(frame_id, symbol_id);
+
+            if (last_demul_task == true) {
+              if (chained_demul_claimed_ != nullptr) {
+                // Release the claim flag for the slot's next frame
+                chained_demul_claimed_[ChainedDemulIndex(frame_id, symbol_id)]
+                    .store(0, std::memory_order_relaxed);
+              }
+              if (cfg->HardDemod() == true) {
+                // The bits were packed into the decoded buffer during
+                // demodulation; account the symbol as decoded and hand it
+                // to the MAC without scheduling any LDPC work
+                bool last_decode_symbol =
+                    this->decode_counters_.CompleteSymbol(frame_id);
+                if (kEnableMac == true) {
+                  ScheduleUsers(EventType::kPacketToMac, frame_id, symbol_id);
+                }
+                if (last_decode_symbol == true) {
+                  this->stats_->MasterSetTsc(TsType::kDecodeDone, frame_id);
+                  PrintPerFrameDone(PrintType::kDecode, frame_id);
+                  if (config_->AntShedNum() > 0) {
+                    UpdateAntShed(frame_id);
+                  }
+                  if (frame_dumper_ != nullptr) {
+                    frame_dumper_->PostDecode(frame_id);
+                  }
+                }
+              } else if (sc_shard_ != nullptr) {
+                bool work_finished =
+                    ScheduleShardedDecode(frame_id, symbol_id);
+                if (work_finished == true) {
+                  goto finish;
+                }
               } else {
                 ScheduleCodeblocks(EventType::kDecode, frame_id, symbol_id);
               }
-              this->stats_->MasterSetTsc(TsType::kDemulDone, frame_id);
-              PrintPerFrameDone(PrintType::kDemul, frame_id);
+              PrintPerSymbolDone(PrintType::kDemul, frame_id, symbol_id);
+              bool last_demul_symbol =
+                  this->demul_counters_.CompleteSymbol(frame_id);
+              if (last_demul_symbol == true) {
+                this->demul_counters_.Reset(frame_id);
+                max_equaled_frame_ = frame_id;
+                if (equal_export_ != nullptr) {
+                  // Export the same symbol GetEqualData hands the plotters:
+                  // the first uplink data symbol of the frame
+                  equal_export_->Publish(
+                      frame_id,
+                      &equal_buffer_[cfg->GetTotalDataSymbolIdxUl(
+                          frame_id, cfg->Frame().ClientUlPilotSymbols())][0]);
+                }
+                if (cfg->BigstationMode() == false) {
+                  assert(frame_id <
+                         (cur_sche_frame_id_ + kScheduleQueues));
+                  CheckIncrementScheduleFrame(frame_id, kUplinkComplete);
+                } else if (cfg->HardDemod() == false) {
+                  ScheduleCodeblocks(EventType::kDecode, frame_id, symbol_id);
+                }
+                this->stats_->MasterSetTsc(TsType::kDemulDone, frame_id);
+                PrintPerFrameDone(PrintType::kDemul, frame_id);
+                if ((cfg->HardDemod() == true) && (kEnableMac == false)) {
+                  // With the decode stage bypassed the uplink chain ends
+                  // here
+                  assert(this->cur_proc_frame_id_ == frame_id);
+                  bool work_finished = this->CheckFrameComplete(frame_id);
+                  if (work_finished == true) {
+                    goto finish;
+                  }
+                }
+              }
             }
           }
         } break;
 
         case EventType::kDecode: {
-          size_t frame_id = gen_tag_t(event.tags_[0]).frame_id_;
-          size_t symbol_id = gen_tag_t(event.tags_[0]).symbol_id_;
-
-          bool last_decode_task =
-              this->decode_counters_.CompleteTask(frame_id, symbol_id);
-          if (last_decode_task == true) {
-            if (kEnableMac == true) {
-              ScheduleUsers(EventType::kPacketToMac, frame_id, symbol_id);
-            }
-            PrintPerSymbolDone(PrintType::kDecode, frame_id, symbol_id);
-            bool last_decode_symbol =
-                this->decode_counters_.CompleteSymbol(frame_id);
-            if (last_decode_symbol == true) {
-              this->stats_->MasterSetTsc(TsType::kDecodeDone, frame_id);
-              PrintPerFrameDone(PrintType::kDecode, frame_id);
-              if (kEnableMac == false) {
-                assert(this->cur_proc_frame_id_ == frame_id);
-                bool work_finished = this->CheckFrameComplete(frame_id);
-                if (work_finished == true) {
-                  goto finish;
+          // Decode completion is counted per code block: a completion event
+          // carries one tag per block the worker decoded, so every tag must
+          // be accounted before the symbol can be declared done
+          for (size_t tag_id = 0; tag_id < event.NumTasks(); tag_id++) {
+            size_t frame_id = gen_tag_t(event.Tag(tag_id)).frame_id_;
+            size_t symbol_id = gen_tag_t(event.Tag(tag_id)).symbol_id_;
+
+            bool last_decode_task =
+                this->decode_counters_.CompleteTask(frame_id, symbol_id);
+            if (last_decode_task == true) {
+              if (kEnableMac == true) {
+                ScheduleUsers(EventType::kPacketToMac, frame_id, symbol_id);
+              }
+              PrintPerSymbolDone(PrintType::kDecode, frame_id, symbol_id);
+              bool last_decode_symbol =
+                  this->decode_counters_.CompleteSymbol(frame_id);
+              if (last_decode_symbol == true) {
+                this->stats_->MasterSetTsc(TsType::kDecodeDone, frame_id);
+                PrintPerFrameDone(PrintType::kDecode, frame_id);
+                if (config_->AntShedNum() > 0) {
+                  UpdateAntShed(frame_id);
+                }
+                if (frame_dumper_ != nullptr) {
+                  frame_dumper_->PostDecode(frame_id);
+                }
+                if (kEnableMac == false) {
+                  assert(this->cur_proc_frame_id_ == frame_id);
+                  bool work_finished = this->CheckFrameComplete(frame_id);
+                  if (work_finished == true) {
+                    goto finish;
+                  }
                 }
               }
             }
@@ -458,6 +1213,9 @@ void Agora::Start() {
           rc.n_antennas_ = event.tags_[0];
           rc.mod_order_bits_ = event.tags_[1];
           rc.frame_id_ = event.tags_[2];
+          if (event.num_tags_ > 3) {
+            rc.ul_block_mask_ = event.tags_[3];
+          }
           UpdateRanConfig(rc);
         } break;
 
@@ -519,7 +1277,7 @@ void Agora::Start() {
               this->encode_cur_frame_for_symbol_.at(
                   cfg->Frame().GetDLSymbolIdx(symbol_id)) = frame_id;
               // If precoder of the current frame exists
-              if (zf_last_frame_ == frame_id) {
+              if (BeamformerReady(frame_id)) {
                 ScheduleSubcarriers(EventType::kPrecode, frame_id, symbol_id);
               }
               PrintPerSymbolDone(PrintType::kEncode, frame_id, symbol_id);
@@ -547,7 +1305,9 @@ void Agora::Start() {
           if (last_precode_task == true) {
             // precode_cur_frame_for_symbol_.at(
             //    this->config_->Frame().GetDLSymbolIdx(symbol_id)) = frame_id;
-            ScheduleAntennas(EventType::kIFFT, frame_id, symbol_id);
+            if (config_->FusedPrecodeIfft() == false) {
+              ScheduleAntennas(EventType::kIFFT, frame_id, symbol_id);
+            }
             PrintPerSymbolDone(PrintType::kPrecode, frame_id, symbol_id);
 
             bool last_precode_symbol =
@@ -557,54 +1317,34 @@ void Agora::Start() {
               this->stats_->MasterSetTsc(TsType::kPrecodeDone, frame_id);
               PrintPerFrameDone(PrintType::kPrecode, frame_id);
             }
+            // Re-evaluate how close the remaining IFFT/TX work is to the
+            // radio deadline as the downlink chain progresses
+            if (config_->DeadlineSched() == true) {
+              UpdateDownlinkUrgency(frame_id);
+            }
+            if (config_->FusedPrecodeIfft() == true) {
+              // The worker that finished this symbol's final precode block
+              // already ran its IFFTs inline (and all precode completions
+              // have arrived, so those IFFTs are done); account for them
+              // and schedule transmission
+              for (size_t ant_id = 0; ant_id < config_->BsAntNum();
+                   ant_id++) {
+                if (CompleteIfftTask(frame_id, symbol_id, ant_id) == true) {
+                  goto finish;
+                }
+              }
+            }
           }
         } break;
 
         case EventType::kIFFT: {
           for (size_t i = 0; i < event.num_tags_; i++) {
             /* IFFT is done, schedule data transmission */
-            size_t ant_id = gen_tag_t(event.tags_[i]).ant_id_;
-            size_t frame_id = gen_tag_t(event.tags_[i]).frame_id_;
-            size_t symbol_id = gen_tag_t(event.tags_[i]).symbol_id_;
-            size_t symbol_idx_dl = cfg->Frame().GetDLSymbolIdx(symbol_id);
-            PrintPerTaskDone(PrintType::kIFFT, frame_id, symbol_id, ant_id);
-
-            bool last_ifft_task =
-                this->ifft_counters_.CompleteTask(frame_id, symbol_id);
-            if (last_ifft_task == true) {
-              ifft_cur_frame_for_symbol_.at(symbol_idx_dl) = frame_id;
-              if (symbol_idx_dl == ifft_next_symbol_) {
-                // Check the available symbols starting from the current symbol
-                // Only schedule symbols that are continuously available
-                for (size_t sym_id = symbol_idx_dl;
-                     sym_id <= ifft_counters_.GetSymbolCount(frame_id);
-                     sym_id++) {
-                  size_t symbol_ifft_frame =
-                      ifft_cur_frame_for_symbol_.at(sym_id);
-                  if (symbol_ifft_frame == frame_id) {
-                    ScheduleAntennasTX(frame_id,
-                                       cfg->Frame().GetDLSymbol(sym_id));
-                    ifft_next_symbol_++;
-                  } else {
-                    break;
-                  }
-                }
-              }
-              PrintPerSymbolDone(PrintType::kIFFT, frame_id, symbol_id);
-
-              bool last_ifft_symbol =
-                  this->ifft_counters_.CompleteSymbol(frame_id);
-              if (last_ifft_symbol == true) {
-                ifft_next_symbol_ = 0;
-                this->stats_->MasterSetTsc(TsType::kIFFTDone, frame_id);
-                PrintPerFrameDone(PrintType::kIFFT, frame_id);
-                assert(frame_id == this->cur_proc_frame_id_);
-                this->CheckIncrementScheduleFrame(frame_id, kDownlinkComplete);
-                bool work_finished = this->CheckFrameComplete(frame_id);
-                if (work_finished == true) {
-                  goto finish;
-                }
-              }
+            const gen_tag_t tag(event.tags_[i]);
+            bool work_finished =
+                CompleteIfftTask(tag.frame_id_, tag.symbol_id_, tag.ant_id_);
+            if (work_finished == true) {
+              goto finish;
             }
           }
         } break;
@@ -617,7 +1357,7 @@ void Agora::Start() {
           PrintPerTaskDone(PrintType::kPacketTX, frame_id, symbol_id, ant_id);
 
           bool last_tx_task =
-              this->tx_counters_.CompleteTask(frame_id, symbol_id);
+              this->tx_counters_.CompleteTask(frame_id, symbol_id, ant_id);
           if (last_tx_task == true) {
             PrintPerSymbolDone(PrintType::kPacketTX, frame_id, symbol_id);
             // If tx of the first symbol is done
@@ -630,6 +1370,9 @@ void Agora::Start() {
             if (last_tx_symbol == true) {
               this->stats_->MasterSetTsc(TsType::kTXDone, frame_id);
               PrintPerFrameDone(PrintType::kPacketTX, frame_id);
+              if (frame_dumper_ != nullptr) {
+                frame_dumper_->PostTx(frame_id);
+              }
 
               bool work_finished = this->CheckFrameComplete(frame_id);
               if (work_finished == true) {
@@ -658,43 +1401,69 @@ void Agora::Start() {
             }
           }
         } break;
+        case EventType::kLlrShard: {
+          // The shard bridge merged every remote shard's LLRs for one
+          // uplink symbol; decode can run once the local shard's own
+          // demodulation of that symbol is also done
+          const size_t frame_id = gen_tag_t(event.tags_[0]).frame_id_;
+          const size_t symbol_id = gen_tag_t(event.tags_[0]).symbol_id_;
+          const size_t frame_slot = frame_id % config_->FrameWnd();
+          const size_t symbol_idx_ul =
+              config_->Frame().GetULSymbolIdx(symbol_id);
+          shard_llr_done_.at(frame_slot).at(symbol_idx_ul) = true;
+          if (shard_demul_done_.at(frame_slot).at(symbol_idx_ul) == true) {
+            shard_demul_done_.at(frame_slot).at(symbol_idx_ul) = false;
+            shard_llr_done_.at(frame_slot).at(symbol_idx_ul) = false;
+            ScheduleCodeblocks(EventType::kDecode, frame_id, symbol_id);
+          }
+        } break;
+
         default:
           MLPD_ERROR("Wrong event type in message queue!");
           std::exit(0);
       } /* End of switch */
 
       // We schedule FFT processing if the event handling above results in
-      // either (a) sufficient packets received for the current frame,
-      // or (b) the current frame being updated.
-      std::queue<fft_req_tag_t>& cur_fftq =
-          fft_queue_arr_[(this->cur_sche_frame_id_ % kFrameWnd)];
-      size_t qid = this->cur_sche_frame_id_ & 0x1;
-      if (cur_fftq.size() >= config_->FftBlockSize()) {
-        size_t num_fft_blocks = cur_fftq.size() / config_->FftBlockSize();
-        for (size_t i = 0; i < num_fft_blocks; i++) {
-          EventData do_fft_task;
-          do_fft_task.num_tags_ = config_->FftBlockSize();
-          do_fft_task.event_type_ = EventType::kFFT;
-
-          for (size_t j = 0; j < config_->FftBlockSize(); j++) {
-            do_fft_task.tags_[j] = cur_fftq.front().tag_;
-            cur_fftq.pop();
-
-            if (this->fft_created_count_ == 0) {
-              this->stats_->MasterSetTsc(TsType::kProcessingStarted,
-                                         this->cur_sche_frame_id_);
-            }
-            this->fft_created_count_++;
-            if (this->fft_created_count_ == rx_counters_.num_pkts_per_frame_) {
-              this->fft_created_count_ = 0;
-              if (cfg->BigstationMode() == true) {
-                this->CheckIncrementScheduleFrame(cur_sche_frame_id_,
-                                                  kUplinkComplete);
+      // either (a) sufficient packets received for a schedulable frame,
+      // or (b) the current frame being updated. Frames up to the pipeline
+      // depth ahead of cur_sche_frame_id_ are eligible, so with a depth
+      // above two the FFTs of frame N + 1 overlap ZF/demul of frame N.
+      for (size_t sched_offset = 0; sched_offset < kScheduleQueues;
+           sched_offset++) {
+        const size_t sched_frame_id = this->cur_sche_frame_id_ + sched_offset;
+        std::queue<fft_req_tag_t>& cur_fftq =
+            fft_queue_arr_[(sched_frame_id % config_->FrameWnd())];
+        size_t qid = sched_frame_id % kScheduleQueues;
+        if (cur_fftq.size() >= config_->FftBlockSize()) {
+          size_t num_fft_blocks = cur_fftq.size() / config_->FftBlockSize();
+          for (size_t i = 0; i < num_fft_blocks; i++) {
+            EventData do_fft_task;
+            do_fft_task.num_tags_ = config_->FftBlockSize();
+            do_fft_task.event_type_ = EventType::kFFT;
+
+            size_t& fft_created_count =
+                this->fft_created_counts_.at(sched_frame_id %
+                                              config_->FrameWnd());
+            for (size_t j = 0; j < config_->FftBlockSize(); j++) {
+              do_fft_task.tags_[j] = cur_fftq.front().tag_;
+              cur_fftq.pop();
+
+              if (fft_created_count == 0) {
+                this->stats_->MasterSetTsc(TsType::kProcessingStarted,
+                                           sched_frame_id);
+              }
+              fft_created_count++;
+              if (fft_created_count == rx_counters_.num_pkts_per_frame_) {
+                fft_created_count = 0;
+                if ((cfg->BigstationMode() == true) &&
+                    (sched_frame_id == this->cur_sche_frame_id_)) {
+                  this->CheckIncrementScheduleFrame(cur_sche_frame_id_,
+                                                    kUplinkComplete);
+                }
               }
             }
+            EnqueueWorkerEvent(EventType::kFFT, qid, do_fft_task);
           }
-          TryEnqueueFallback(GetConq(EventType::kFFT, qid),
-                             GetPtok(EventType::kFFT, qid), do_fft_task);
         }
       }
     } /* End of for */
@@ -721,16 +1490,43 @@ finish:
 void Agora::HandleEventFft(size_t tag) {
   size_t frame_id = gen_tag_t(tag).frame_id_;
   size_t symbol_id = gen_tag_t(tag).symbol_id_;
+  size_t ant_id = gen_tag_t(tag).ant_id_;
   SymbolType sym_type = config_->GetSymbolType(symbol_id);
 
   if (sym_type == SymbolType::kPilot) {
-    bool last_fft_task = pilot_fft_counters_.CompleteTask(frame_id, symbol_id);
+    const size_t frame_slot = frame_id % config_->FrameWnd();
+    bool last_fft_task =
+        pilot_fft_counters_.CompleteTask(frame_id, symbol_id, ant_id);
+    const bool rec_cal_ready =
+        ((config_->Frame().IsRecCalEnabled() == false) ||
+         (this->rc_last_frame_ == frame_id));
+
+    // Partial-CSI kickoff: once the configured fraction of this frame's
+    // pilot FFTs are in, schedule ZF on the antenna subset instead of
+    // stalling the whole frame on the last stragglers. Antennas without
+    // fresh CSI contribute their previous estimate still sitting in
+    // csi_buffers_
+    if ((config_->ZfPartialCsiFraction() < 1.0) && (rec_cal_ready == true) &&
+        (zf_partial_frame_.at(frame_slot) != frame_id)) {
+      size_t pilot_ffts_done = 0;
+      for (size_t i = 0; i < config_->Frame().NumPilotSyms(); i++) {
+        pilot_ffts_done += pilot_fft_counters_.GetTaskCount(
+            frame_id, config_->Frame().GetPilotSymbol(i));
+      }
+      const size_t pilot_ffts_total =
+          config_->Frame().NumPilotSyms() * config_->BsAntNum();
+      if (pilot_ffts_done >= static_cast<size_t>(
+              config_->ZfPartialCsiFraction() * pilot_ffts_total)) {
+        zf_partial_frame_.at(frame_slot) = frame_id;
+        zf_partial_state_.at(frame_slot) = ZfPartialState::kPartialInFlight;
+        ScheduleSubcarriers(EventType::kZF, frame_id, 0);
+      }
+    }
+
     if (last_fft_task == true) {
       PrintPerSymbolDone(PrintType::kFFTPilots, frame_id, symbol_id);
 
-      if ((config_->Frame().IsRecCalEnabled() == false) ||
-          ((config_->Frame().IsRecCalEnabled() == true) &&
-           (this->rc_last_frame_ == frame_id))) {
+      if (rec_cal_ready == true) {
         // If CSI of all UEs is ready, schedule ZF/prediction
         bool last_pilot_fft = pilot_fft_counters_.CompleteSymbol(frame_id);
         if (last_pilot_fft == true) {
@@ -751,7 +1547,27 @@ void Agora::HandleEventFft(size_t tag) {
           if (kEnableMac == true) {
             SendSnrReport(EventType::kSNRReport, frame_id, symbol_id);
           }
-          ScheduleSubcarriers(EventType::kZF, frame_id, 0);
+          if (zf_partial_frame_.at(frame_slot) == frame_id) {
+            // ZF already kicked off on a subset. Refine with the late
+            // antennas only while the frame is still in the processing
+            // window; past that cutoff the partial weights stand
+            if (frame_id < this->cur_proc_frame_id_) {
+              zf_partial_frame_.at(frame_slot) = SIZE_MAX;
+              zf_partial_state_.at(frame_slot) = ZfPartialState::kIdle;
+            } else if (zf_partial_state_.at(frame_slot) ==
+                       ZfPartialState::kPartialDone) {
+              zf_partial_state_.at(frame_slot) =
+                  ZfPartialState::kRefineInFlight;
+              ScheduleSubcarriers(EventType::kZF, frame_id, 0);
+            } else {
+              // Partial pass still draining; the kZF completion handler
+              // schedules the refinement once the counters are clean
+              zf_partial_state_.at(frame_slot) =
+                  ZfPartialState::kRefinePending;
+            }
+          } else {
+            ScheduleSubcarriers(EventType::kZF, frame_id, 0);
+          }
         }
       }
     }
@@ -759,14 +1575,20 @@ void Agora::HandleEventFft(size_t tag) {
     size_t symbol_idx_ul = config_->Frame().GetULSymbolIdx(symbol_id);
 
     bool last_fft_per_symbol =
-        uplink_fft_counters_.CompleteTask(frame_id, symbol_id);
+        uplink_fft_counters_.CompleteTask(frame_id, symbol_id, ant_id);
 
     if (last_fft_per_symbol == true) {
       fft_cur_frame_for_symbol_.at(symbol_idx_ul) = frame_id;
 
       PrintPerSymbolDone(PrintType::kFFTData, frame_id, symbol_id);
-      // If precoder exist, schedule demodulation
-      if (zf_last_frame_ == frame_id) {
+      // If precoder exist, schedule demodulation (unless a chained DoFFT
+      // worker already dispatched this symbol's demul tasks)
+      if (config_->ZfBlockGatedDemul() == true) {
+        // Dispatch the demul blocks whose beamweights already landed; the
+        // rest follow from their ZF block completions
+        ReleaseReadyDemulBlocks(frame_id, symbol_id);
+      } else if (BeamformerReady(frame_id) &&
+                 (TryClaimChainedDemul(frame_id, symbol_id) == true)) {
         ScheduleSubcarriers(EventType::kDemul, frame_id, symbol_id);
       }
       bool last_uplink_fft = uplink_fft_counters_.CompleteSymbol(frame_id);
@@ -796,37 +1618,67 @@ void Agora::Worker(int tid) {
       this->config_, tid, this->csi_buffers_, calib_dl_buffer_,
       calib_ul_buffer_, this->calib_dl_msum_buffer_,
       this->calib_ul_msum_buffer_, this->ul_zf_matrices_, this->dl_zf_matrices_,
-      this->phy_stats_.get(), this->stats_.get());
+      this->dl_zf_unchanged_, this->phy_stats_.get(), this->stats_.get());
 
   auto compute_fft = std::make_unique<DoFFT>(
       this->config_, tid, this->data_buffer_, this->csi_buffers_,
       this->calib_dl_buffer_, this->calib_ul_buffer_, this->phy_stats_.get(),
       this->stats_.get());
+  if (cfo_phase_per_sample_ != nullptr) {
+    compute_fft->SetCfoTracker(cfo_phase_per_sample_.get());
+  }
 
-  // Downlink workers
-  auto compute_ifft =
-      std::make_unique<DoIFFT>(this->config_, tid, this->dl_ifft_buffer_,
-                               this->dl_socket_buffer_, this->stats_.get());
-
-  auto compute_precode = std::make_unique<DoPrecode>(
-      this->config_, tid, this->dl_zf_matrices_, this->dl_ifft_buffer_,
-      this->dl_encoded_buffer_, this->stats_.get());
-
-  auto compute_encoding = std::make_unique<DoEncode>(
-      config_, tid, Direction::kDownlink,
-      (kEnableMac == true) ? dl_bits_buffer_ : config_->DlBits(),
-      (kEnableMac == true) ? kFrameWnd : 1, dl_encoded_buffer_,
-      this->stats_.get());
+  // Downlink workers, constructed only when the schedule has downlink
+  // symbols: their constructors commit FFT plans and scratch allocations
+  std::unique_ptr<DoIFFT> compute_ifft;
+  std::unique_ptr<DoPrecode> compute_precode;
+  std::unique_ptr<DoEncode> compute_encoding;
+  if (config_->Frame().NumDLSyms() > 0) {
+    compute_ifft =
+        std::make_unique<DoIFFT>(this->config_, tid, this->dl_ifft_buffer_,
+                                 this->dl_socket_buffer_, this->stats_.get());
+
+    compute_precode = std::make_unique<DoPrecode>(
+        this->config_, tid, this->dl_zf_matrices_, this->dl_zf_unchanged_,
+        this->dl_ifft_buffer_, this->dl_encoded_buffer_, this->stats_.get());
+    if (config_->FusedPrecodeIfft() == true) {
+      compute_precode->SetFusedIfft(compute_ifft.get(),
+                                    fused_precode_task_counts_.get());
+    }
 
-  // Uplink workers
-  auto compute_decoding = std::make_unique<DoDecode>(
-      this->config_, tid, this->demod_buffers_, this->decoded_buffer_,
-      this->phy_stats_.get(), this->stats_.get());
+    compute_encoding = std::make_unique<DoEncode>(
+        config_, tid, Direction::kDownlink,
+        (kEnableMac == true) ? dl_bits_buffer_ : config_->DlBits(),
+        (kEnableMac == true) ? config_->FrameWnd() : 1, dl_encoded_buffer_,
+        this->stats_.get());
+  }
 
-  auto compute_demul = std::make_unique<DoDemul>(
-      this->config_, tid, this->data_buffer_, this->ul_zf_matrices_,
-      this->ue_spec_pilot_buffer_, this->equal_buffer_, this->demod_buffers_,
-      this->phy_stats_.get(), this->stats_.get());
+  // Uplink workers, likewise only for schedules with uplink symbols
+  std::unique_ptr<DoDecode> compute_decoding;
+  std::unique_ptr<DoDemul> compute_demul;
+  if (config_->Frame().NumULSyms() > 0) {
+    compute_decoding = std::make_unique<DoDecode>(
+        this->config_, tid, this->demod_buffers_, this->decoded_buffer_,
+        this->harq_store_.get(), this->phy_stats_.get(), this->stats_.get());
+
+    compute_demul = std::make_unique<DoDemul>(
+        this->config_, tid, this->data_buffer_, this->ul_zf_matrices_,
+        this->ue_spec_pilot_buffer_, this->equal_buffer_, this->demod_buffers_,
+        this->decoded_buffer_, this->phy_stats_.get(), this->stats_.get());
+
+    if (config_->ChainedFftDemul() == true) {
+      // Chained demul events go into the regular demul task queues
+      // (tokenless enqueue, safe alongside the master's producer tokens)
+      std::array<moodycamel::ConcurrentQueue<EventData>*, kScheduleQueues>
+          demul_queues;
+      for (size_t qid = 0; qid < kScheduleQueues; qid++) {
+        demul_queues.at(qid) = GetConq(EventType::kDemul, qid);
+      }
+      compute_fft->SetChainedDemul(
+          demul_queues.data(), kScheduleQueues, chained_fft_task_counts_.get(),
+          chained_demul_claimed_.get(), &chained_beam_ready_frame_);
+    }
+  }
 
   std::vector<Doer*> computers_vec;
   std::vector<EventType> events_vec;
@@ -852,14 +1704,56 @@ void Agora::Worker(int tid) {
     events_vec.push_back(EventType::kEncode);
   }
 
+  for (auto* doer : computers_vec) {
+    doer->SetFrameArenas(frame_arenas_.data(), kScheduleQueues);
+  }
+
   size_t cur_qid = 0;
   size_t empty_queue_itrs = 0;
   bool empty_queue = true;
   while (this->config_->Running() == true) {
-    for (size_t i = 0; i < computers_vec.size(); i++) {
-      if (computers_vec.at(i)->TryLaunch(*GetConq(events_vec.at(i), cur_qid),
-                                         complete_task_queue_[cur_qid],
-                                         worker_ptoks_ptr_[tid][cur_qid])) {
+    // With adaptive scheduling, poll this worker's master-assigned primary
+    // event type first and fall back to the rest in the static order
+    size_t first_idx = 0;
+    if (config_->AdaptiveSched() == true) {
+      const auto primary = static_cast<EventType>(
+          worker_primary_event_[tid].load(std::memory_order_relaxed));
+      for (size_t i = 0; i < events_vec.size(); i++) {
+        if (events_vec.at(i) == primary) {
+          first_idx = i;
+          break;
+        }
+      }
+    }
+    // Near-deadline downlink work preempts the static or adaptive poll
+    // order: start at the IFFT queue so the precode/IFFT chain drains first
+    if ((config_->DeadlineSched() == true) &&
+        (config_->Frame().NumDLSyms() > 0) &&
+        (dl_urgent_.load(std::memory_order_relaxed) == true)) {
+      for (size_t i = 0; i < events_vec.size(); i++) {
+        if (events_vec.at(i) == EventType::kIFFT) {
+          first_idx = i;
+          break;
+        }
+      }
+    }
+    for (size_t k = 0; k < computers_vec.size(); k++) {
+      const size_t i = (first_idx + k) % computers_vec.size();
+      bool launched;
+      if (kUseSpscCompletion == true) {
+        launched =
+            computers_vec.at(i)->TryLaunch(*GetConq(events_vec.at(i), cur_qid),
+                                           completion_rings_[cur_qid][tid]);
+      } else {
+        launched =
+            computers_vec.at(i)->TryLaunch(*GetConq(events_vec.at(i), cur_qid),
+                                           complete_task_queue_[cur_qid],
+                                           worker_ptoks_ptr_[tid][cur_qid]);
+      }
+      if (launched == true) {
+        if (config_->HybridPolling() == true) {
+          master_notifier_.Notify();
+        }
         empty_queue = false;
         break;
       }
@@ -870,9 +1764,9 @@ void Agora::Worker(int tid) {
       empty_queue_itrs++;
       if (empty_queue_itrs == 5) {
         if (this->cur_sche_frame_id_ != this->cur_proc_frame_id_) {
-          cur_qid ^= 0x1;
+          cur_qid = (cur_qid + 1) % kScheduleQueues;
         } else {
-          cur_qid = (this->cur_sche_frame_id_ & 0x1);
+          cur_qid = (this->cur_sche_frame_id_ % kScheduleQueues);
         }
         empty_queue_itrs = 0;
       }
@@ -883,6 +1777,148 @@ void Agora::Worker(int tid) {
   MLPD_SYMBOL("Agora worker %d exit\n", tid);
 }
 
+void Agora::WorkerSteal(int tid) {
+  PinToCoreWithOffset(ThreadType::kWorker, base_worker_core_offset_, tid);
+
+  /* Initialize operators */
+  auto compute_zf = std::make_unique<DoZF>(
+      this->config_, tid, this->csi_buffers_, calib_dl_buffer_,
+      calib_ul_buffer_, this->calib_dl_msum_buffer_,
+      this->calib_ul_msum_buffer_, this->ul_zf_matrices_, this->dl_zf_matrices_,
+      this->dl_zf_unchanged_, this->phy_stats_.get(), this->stats_.get());
+
+  auto compute_fft = std::make_unique<DoFFT>(
+      this->config_, tid, this->data_buffer_, this->csi_buffers_,
+      this->calib_dl_buffer_, this->calib_ul_buffer_, this->phy_stats_.get(),
+      this->stats_.get());
+  if (cfo_phase_per_sample_ != nullptr) {
+    compute_fft->SetCfoTracker(cfo_phase_per_sample_.get());
+  }
+
+  // Downlink and uplink doers are only constructed for directions the
+  // schedule uses; events for a missing direction are never enqueued, and
+  // the dispatch table below asserts on any that slip through
+  std::unique_ptr<DoIFFT> compute_ifft;
+  std::unique_ptr<DoPrecode> compute_precode;
+  std::unique_ptr<DoEncode> compute_encoding;
+  if (config_->Frame().NumDLSyms() > 0) {
+    compute_ifft =
+        std::make_unique<DoIFFT>(this->config_, tid, this->dl_ifft_buffer_,
+                                 this->dl_socket_buffer_, this->stats_.get());
+
+    compute_precode = std::make_unique<DoPrecode>(
+        this->config_, tid, this->dl_zf_matrices_, this->dl_zf_unchanged_,
+        this->dl_ifft_buffer_, this->dl_encoded_buffer_, this->stats_.get());
+    if (config_->FusedPrecodeIfft() == true) {
+      compute_precode->SetFusedIfft(compute_ifft.get(),
+                                    fused_precode_task_counts_.get());
+    }
+
+    compute_encoding = std::make_unique<DoEncode>(
+        config_, tid, Direction::kDownlink,
+        (kEnableMac == true) ? dl_bits_buffer_ : config_->DlBits(),
+        (kEnableMac == true) ? config_->FrameWnd() : 1, dl_encoded_buffer_,
+        this->stats_.get());
+  }
+
+  std::unique_ptr<DoDecode> compute_decoding;
+  std::unique_ptr<DoDemul> compute_demul;
+  if (config_->Frame().NumULSyms() > 0) {
+    compute_decoding = std::make_unique<DoDecode>(
+        this->config_, tid, this->demod_buffers_, this->decoded_buffer_,
+        this->harq_store_.get(), this->phy_stats_.get(), this->stats_.get());
+
+    compute_demul = std::make_unique<DoDemul>(
+        this->config_, tid, this->data_buffer_, this->ul_zf_matrices_,
+        this->ue_spec_pilot_buffer_, this->equal_buffer_, this->demod_buffers_,
+        this->decoded_buffer_, this->phy_stats_.get(), this->stats_.get());
+
+    if (config_->ChainedFftDemul() == true) {
+      // Chained demul events go into this worker's own local queues, where
+      // idle peers can steal them like any master-assigned work
+      std::array<moodycamel::ConcurrentQueue<EventData>*, kScheduleQueues>
+          demul_queues;
+      for (size_t qid = 0; qid < kScheduleQueues; qid++) {
+        demul_queues.at(qid) = &steal_info_arr_[qid][tid].concurrent_q_;
+      }
+      compute_fft->SetChainedDemul(
+          demul_queues.data(), kScheduleQueues, chained_fft_task_counts_.get(),
+          chained_demul_claimed_.get(), &chained_beam_ready_frame_);
+    }
+  }
+
+  // Per-worker queues carry mixed event types, so dispatch by event type
+  std::array<Doer*, kNumEventTypes> doer_for_event;
+  doer_for_event.fill(nullptr);
+  doer_for_event.at(static_cast<size_t>(EventType::kZF)) = compute_zf.get();
+  doer_for_event.at(static_cast<size_t>(EventType::kFFT)) = compute_fft.get();
+  doer_for_event.at(static_cast<size_t>(EventType::kDemul)) =
+      compute_demul.get();
+  doer_for_event.at(static_cast<size_t>(EventType::kDecode)) =
+      compute_decoding.get();
+  doer_for_event.at(static_cast<size_t>(EventType::kIFFT)) = compute_ifft.get();
+  doer_for_event.at(static_cast<size_t>(EventType::kPrecode)) =
+      compute_precode.get();
+  doer_for_event.at(static_cast<size_t>(EventType::kEncode)) =
+      compute_encoding.get();
+
+  for (auto* doer : doer_for_event) {
+    if (doer != nullptr) {
+      doer->SetFrameArenas(frame_arenas_.data(), kScheduleQueues);
+    }
+  }
+
+  const size_t num_workers = config_->WorkerThreadNum();
+  size_t cur_qid = 0;
+  size_t empty_queue_itrs = 0;
+  bool empty_queue = true;
+  while (this->config_->Running() == true) {
+    EventData req_event;
+    bool found_event =
+        steal_info_arr_[cur_qid][tid].concurrent_q_.try_dequeue(req_event);
+
+    // Local queue is empty: steal from peers, starting with our neighbor to
+    // spread the stealing load across the worker set
+    for (size_t i = 1; (found_event == false) && (i < num_workers); i++) {
+      found_event = steal_info_arr_[cur_qid][(tid + i) % num_workers]
+                        .concurrent_q_.try_dequeue(req_event);
+    }
+
+    if (found_event == true) {
+      Doer* doer =
+          doer_for_event.at(static_cast<size_t>(req_event.event_type_));
+      RtAssert(doer != nullptr, "WorkerSteal: event type without a Doer");
+      if (kUseSpscCompletion == true) {
+        doer->ProcessEvent(req_event, completion_rings_[cur_qid][tid]);
+      } else {
+        doer->ProcessEvent(req_event, complete_task_queue_[cur_qid],
+                           worker_ptoks_ptr_[tid][cur_qid]);
+      }
+      if (config_->HybridPolling() == true) {
+        master_notifier_.Notify();
+      }
+      empty_queue = false;
+    }
+
+    // If all queues in this set are empty for 5 iterations,
+    // check the other set of queues
+    if (empty_queue == true) {
+      empty_queue_itrs++;
+      if (empty_queue_itrs == 5) {
+        if (this->cur_sche_frame_id_ != this->cur_proc_frame_id_) {
+          cur_qid = (cur_qid + 1) % kScheduleQueues;
+        } else {
+          cur_qid = (this->cur_sche_frame_id_ % kScheduleQueues);
+        }
+        empty_queue_itrs = 0;
+      }
+    } else {
+      empty_queue = true;
+    }
+  }
+  MLPD_SYMBOL("Agora stealing worker %d exit\n", tid);
+}
+
 void Agora::WorkerFft(int tid) {
   PinToCoreWithOffset(ThreadType::kWorkerFFT, base_worker_core_offset_, tid);
 
@@ -890,8 +1926,14 @@ void Agora::WorkerFft(int tid) {
   std::unique_ptr<DoFFT> compute_fft(
       new DoFFT(config_, tid, data_buffer_, csi_buffers_, calib_dl_buffer_,
                 calib_ul_buffer_, this->phy_stats_.get(), this->stats_.get()));
-  std::unique_ptr<DoIFFT> compute_ifft(new DoIFFT(
-      config_, tid, dl_ifft_buffer_, dl_socket_buffer_, this->stats_.get()));
+  if (cfo_phase_per_sample_ != nullptr) {
+    compute_fft->SetCfoTracker(cfo_phase_per_sample_.get());
+  }
+  std::unique_ptr<DoIFFT> compute_ifft;
+  if (config_->Frame().NumDLSyms() > 0) {
+    compute_ifft = std::make_unique<DoIFFT>(
+        config_, tid, dl_ifft_buffer_, dl_socket_buffer_, this->stats_.get());
+  }
 
   while (this->config_->Running() == true) {
     // TODO refactor the if / else
@@ -915,7 +1957,8 @@ void Agora::WorkerZf(int tid) {
   std::unique_ptr<DoZF> compute_zf(
       new DoZF(config_, tid, csi_buffers_, calib_dl_buffer_, calib_ul_buffer_,
                calib_dl_msum_buffer_, calib_ul_msum_buffer_, ul_zf_matrices_,
-               dl_zf_matrices_, this->phy_stats_.get(), this->stats_.get()));
+               dl_zf_matrices_, dl_zf_unchanged_, this->phy_stats_.get(),
+               this->stats_.get()));
 
   while (this->config_->Running() == true) {
     compute_zf->TryLaunch(*GetConq(EventType::kZF, 0), complete_task_queue_[0],
@@ -926,15 +1969,19 @@ void Agora::WorkerZf(int tid) {
 void Agora::WorkerDemul(int tid) {
   PinToCoreWithOffset(ThreadType::kWorkerDemul, base_worker_core_offset_, tid);
 
-  std::unique_ptr<DoDemul> compute_demul(
-      new DoDemul(config_, tid, data_buffer_, ul_zf_matrices_,
-                  ue_spec_pilot_buffer_, equal_buffer_, demod_buffers_,
-                  this->phy_stats_.get(), this->stats_.get()));
-
-  /* Initialize Precode operator */
-  std::unique_ptr<DoPrecode> compute_precode(
-      new DoPrecode(config_, tid, dl_zf_matrices_, dl_ifft_buffer_,
-                    dl_encoded_buffer_, this->stats_.get()));
+  // Only the doer this thread's direction branch below uses gets built
+  std::unique_ptr<DoDemul> compute_demul;
+  std::unique_ptr<DoPrecode> compute_precode;
+  if (config_->Frame().NumDLSyms() > 0) {
+    compute_precode = std::make_unique<DoPrecode>(
+        config_, tid, dl_zf_matrices_, dl_zf_unchanged_, dl_ifft_buffer_,
+        dl_encoded_buffer_, this->stats_.get());
+  } else {
+    compute_demul = std::make_unique<DoDemul>(
+        config_, tid, data_buffer_, ul_zf_matrices_, ue_spec_pilot_buffer_,
+        equal_buffer_, demod_buffers_, decoded_buffer_, this->phy_stats_.get(),
+        this->stats_.get());
+  }
 
   assert(false);
 
@@ -954,15 +2001,20 @@ void Agora::WorkerDemul(int tid) {
 void Agora::WorkerDecode(int tid) {
   PinToCoreWithOffset(ThreadType::kWorkerDecode, base_worker_core_offset_, tid);
 
-  std::unique_ptr<DoEncode> compute_encoding(
-      new DoEncode(config_, tid, Direction::kDownlink,
-                   (kEnableMac == true) ? dl_bits_buffer_ : config_->DlBits(),
-                   (kEnableMac == true) ? kFrameWnd : 1, dl_encoded_buffer_,
-                   this->stats_.get()));
-
-  std::unique_ptr<DoDecode> compute_decoding(
-      new DoDecode(config_, tid, demod_buffers_, decoded_buffer_,
-                   this->phy_stats_.get(), this->stats_.get()));
+  // Only the doer this thread's direction branch below uses gets built
+  std::unique_ptr<DoEncode> compute_encoding;
+  std::unique_ptr<DoDecode> compute_decoding;
+  if (config_->Frame().NumDLSyms() > 0) {
+    compute_encoding = std::make_unique<DoEncode>(
+        config_, tid, Direction::kDownlink,
+        (kEnableMac == true) ? dl_bits_buffer_ : config_->DlBits(),
+        (kEnableMac == true) ? config_->FrameWnd() : 1, dl_encoded_buffer_,
+        this->stats_.get());
+  } else {
+    compute_decoding = std::make_unique<DoDecode>(
+        config_, tid, demod_buffers_, decoded_buffer_, this->harq_store_.get(),
+        this->phy_stats_.get(), this->stats_.get());
+  }
 
   while (this->config_->Running() == true) {
     if (config_->Frame().NumDLSyms() > 0) {
@@ -1000,17 +2052,186 @@ void Agora::CreateThreads() {
   } else {
     MLPD_SYMBOL("Agora: creating %zu workers\n", cfg->WorkerThreadNum());
     for (size_t i = 0; i < cfg->WorkerThreadNum(); i++) {
-      workers_.emplace_back(&Agora::Worker, this, i);
+      if (cfg->WorkStealSched() == true) {
+        workers_.emplace_back(&Agora::WorkerSteal, this, i);
+      } else {
+        workers_.emplace_back(&Agora::Worker, this, i);
+      }
     }
   }
 }
 
 void Agora::UpdateRanConfig(RanConfig rc) {
-  config_->UpdateModCfgs(rc.mod_order_bits_);
+  if ((rc.frame_id_ <= this->cur_proc_frame_id_) &&
+      (rc.frame_schedule_.empty() == true) &&
+      (rc.ul_block_mask_ == this->ul_block_mask_)) {
+    // The target frame is already current (or past); nothing is gained by
+    // waiting, so apply the new modulation configuration right away. A
+    // schedule or allocation-mask change never takes this path: the
+    // symbol maps and task budgets can only swap between frames
+    config_->UpdateModCfgs(rc.mod_order_bits_);
+  } else {
+    // Defer to the boundary of the requested frame. Doers read ModTable()
+    // and ModOrderBits() throughout a frame, so the switch must happen
+    // between frames, in CheckFrameComplete(). A newer request simply
+    // replaces an older pending one.
+    this->pending_ran_config_ = rc;
+    this->ran_config_pending_ = true;
+  }
 }
 
-void Agora::UpdateRxCounters(size_t frame_id, size_t symbol_id) {
-  const size_t frame_slot = frame_id % kFrameWnd;
+void Agora::ApplyFrameSchedule(const std::string& new_schedule) {
+  if (config_->UpdateFrameSchedule(new_schedule) == false) {
+    return;  // Rejected; keep running on the current schedule
+  }
+  const auto& cfg = config_;
+
+  // Re-derive the per-frame symbol budgets the schedule feeds. Buffer
+  // shapes are untouched: UpdateFrameSchedule capped the new symbol
+  // counts at the capacities the buffers were sized for
+  rx_counters_.num_pkts_per_frame_ =
+      cfg->BsAntNum() *
+      (cfg->Frame().NumPilotSyms() + cfg->Frame().NumULSyms() +
+       static_cast<size_t>(cfg->Frame().IsRecCalEnabled()));
+  rx_counters_.num_pilot_pkts_per_frame_ =
+      cfg->BsAntNum() * cfg->Frame().NumPilotSyms();
+
+  uplink_fft_counters_.Init(cfg->Frame().NumULSyms(), cfg->BsAntNum());
+  demul_counters_.Init(cfg->Frame().NumULSyms(), cfg->DemulEventsPerSymbol());
+  decode_counters_.Init(
+      cfg->Frame().NumULSyms(),
+      cfg->LdpcConfig().NumBlocksInSymbol() * cfg->UeAntNum());
+  tomac_counters_.Init(cfg->Frame().NumULSyms(), cfg->UeAntNum());
+  fft_cur_frame_for_symbol_.assign(cfg->Frame().NumULSyms(), SIZE_MAX);
+
+  if (cfg->Frame().NumDLSyms() > 0) {
+    encode_counters_.Init(
+        cfg->Frame().NumDlDataSyms(),
+        cfg->LdpcConfig().NumBlocksInSymbol() * cfg->UeAntNum());
+    precode_counters_.Init(cfg->Frame().NumDLSyms(),
+                           cfg->DemulEventsPerSymbol());
+    ifft_counters_.Init(cfg->Frame().NumDLSyms(), cfg->BsAntNum());
+    tx_counters_.Init(cfg->Frame().NumDLSyms(), cfg->BsAntNum());
+    encode_cur_frame_for_symbol_.assign(cfg->Frame().NumDLSyms(), SIZE_MAX);
+    ifft_cur_frame_for_symbol_.assign(cfg->Frame().NumDLSyms(), SIZE_MAX);
+  }
+
+  if (ul_block_mask_ != UINT64_MAX) {
+    // Re-derive the masked ZF/demul task budgets the re-init just reset
+    ApplyUlBlockMask(ul_block_mask_);
+  }
+}
+
+void Agora::ApplyUlBlockMask(uint64_t mask) {
+  const size_t num_demul = config_->DemulEventsPerSymbol();
+  const size_t num_zf = config_->ZfEventsPerSymbol();
+  const uint64_t full =
+      (num_demul >= 64) ? UINT64_MAX : ((uint64_t{1} << num_demul) - 1);
+  uint64_t normalized = mask;
+  if (num_demul < 64) {
+    normalized &= full;
+  }
+  if ((num_demul > 64) || (num_zf > 64)) {
+    MLPD_WARN(
+        "Ignoring RB allocation mask: band has %zu demul / %zu ZF blocks, "
+        "more than the 64 a mask can express\n",
+        num_demul, num_zf);
+    normalized = full;
+  } else if (config_->SplitMaster() == true) {
+    // The dedicated scheduling thread reads the masks concurrently with
+    // the boundary update; keep the full band rather than racing it
+    MLPD_WARN("Ignoring RB allocation mask under split-master scheduling\n");
+    normalized = full;
+  } else if (normalized == 0) {
+    MLPD_WARN(
+        "Ignoring empty RB allocation mask: a frame with zero active uplink "
+        "blocks cannot complete\n");
+    normalized = full;
+  }
+
+  if (normalized == full) {
+    ul_block_mask_ = UINT64_MAX;
+    zf_block_mask_ = UINT64_MAX;
+    demul_counters_.SetMaxTaskCount(num_demul);
+    zf_counters_.SetMaxTaskCount(num_zf);
+    return;
+  }
+
+  // A ZF block is needed when any allocated demul block overlaps it; the
+  // downlink precoder reads the whole band, so DL-bearing schedules keep
+  // the full ZF pass
+  const uint64_t zf_full =
+      (num_zf >= 64) ? UINT64_MAX : ((uint64_t{1} << num_zf) - 1);
+  uint64_t zf_mask = 0;
+  if (config_->Frame().NumDLSyms() > 0) {
+    zf_mask = zf_full;
+  } else {
+    const size_t demul_block = config_->DemulBlockSize();
+    const size_t zf_block = config_->ZfBlockSize();
+    for (size_t d = 0; d < num_demul; d++) {
+      if (((normalized >> d) & 1ULL) == 0) {
+        continue;
+      }
+      const size_t first = (d * demul_block) / zf_block;
+      const size_t last =
+          std::min((((d + 1) * demul_block) - 1) / zf_block, num_zf - 1);
+      for (size_t z = first; z <= last; z++) {
+        zf_mask |= (uint64_t{1} << z);
+      }
+    }
+  }
+
+  ul_block_mask_ = normalized;
+  zf_block_mask_ = (zf_mask == zf_full) ? UINT64_MAX : zf_mask;
+  const auto active_demul =
+      static_cast<size_t>(__builtin_popcountll(normalized));
+  const auto active_zf = static_cast<size_t>(__builtin_popcountll(zf_mask));
+  demul_counters_.SetMaxTaskCount(active_demul);
+  zf_counters_.SetMaxTaskCount(active_zf);
+  std::printf(
+      "Agora: RB allocation mask applied at frame %zu: %zu of %zu demul "
+      "blocks, %zu of %zu ZF blocks active\n",
+      cur_proc_frame_id_, active_demul, num_demul, active_zf, num_zf);
+}
+
+bool Agora::UpdateRxCounters(size_t frame_id, size_t symbol_id,
+                             size_t ant_id) {
+  const size_t frame_slot = frame_id % config_->FrameWnd();
+
+  // Reassembly window: claim the frame slot's bitmap for this frame, or
+  // reject the packet if a newer frame already recycled the slot. Within
+  // the window each (symbol, antenna) pair is accepted exactly once, so
+  // packets reordered across frames (e.g. by multi-queue RSS) still
+  // complete their own frame's symbols
+  if (rx_counters_.bitmap_frame_.at(frame_slot) != frame_id) {
+    if ((rx_counters_.bitmap_frame_.at(frame_slot) == SIZE_MAX) ||
+        (frame_id > rx_counters_.bitmap_frame_.at(frame_slot))) {
+      auto& bitmap = rx_counters_.pkt_bitmap_.at(frame_slot);
+      std::fill(bitmap.begin(), bitmap.end(), 0u);
+      rx_counters_.bitmap_frame_.at(frame_slot) = frame_id;
+    } else {
+      rx_counters_.num_stale_drops_++;
+      MLPD_WARN(
+          "Main: Dropping stale packet (frame %zu, symbol %zu, ant %zu) "
+          "whose frame left the RX window (%zu stale drops total)\n",
+          frame_id, symbol_id, ant_id, rx_counters_.num_stale_drops_);
+      return false;
+    }
+  }
+  const size_t pkt_slot = (symbol_id * config_->BsAntNum()) + ant_id;
+  uint8_t& bitmap_byte =
+      rx_counters_.pkt_bitmap_.at(frame_slot).at(pkt_slot / 8);
+  const uint8_t bitmap_mask = (1u << (pkt_slot % 8));
+  if ((bitmap_byte & bitmap_mask) != 0) {
+    rx_counters_.num_duplicate_drops_++;
+    MLPD_WARN(
+        "Main: Dropping duplicate packet (frame %zu, symbol %zu, ant %zu) "
+        "(%zu duplicate drops total)\n",
+        frame_id, symbol_id, ant_id, rx_counters_.num_duplicate_drops_);
+    return false;
+  }
+  bitmap_byte |= bitmap_mask;
+
   if (config_->IsPilot(frame_id, symbol_id)) {
     rx_counters_.num_pilot_pkts_[frame_slot]++;
     if (rx_counters_.num_pilot_pkts_[frame_slot] ==
@@ -1029,6 +2250,17 @@ void Agora::UpdateRxCounters(size_t frame_id, size_t symbol_id) {
   }
   // Receive first packet in a frame
   if (rx_counters_.num_pkts_[frame_slot] == 0) {
+    // Claim the frame-window slot for this frame. A previous occupant that
+    // never completed means processing fell more than FrameWnd() frames
+    // behind and the windowed buffers are being recycled under it
+    const size_t prev_owner = FrameSlotMonitor::Claim(frame_id);
+    if (prev_owner != SIZE_MAX) {
+      MLPD_ERROR(
+          "Main: Frame %zu claimed the window slot of unfinished frame "
+          "%zu -- processing fell behind the frame window (%zu overruns "
+          "total)\n",
+          frame_id, prev_owner, FrameSlotMonitor::OverrunCount());
+    }
     if (kEnableMac == false) {
       // schedule this frame's encoding
       // Defer the schedule.  If frames are already deferred or the current
@@ -1044,8 +2276,10 @@ void Agora::UpdateRxCounters(size_t frame_id, size_t symbol_id) {
       }
     }
     this->stats_->MasterSetTsc(TsType::kFirstSymbolRX, frame_id);
+    TraceLog::Emit(kTraceFrameStart, 0, static_cast<uint32_t>(frame_id));
     if (kDebugPrintPerFrameStart) {
-      const size_t prev_frame_slot = (frame_slot + kFrameWnd - 1) % kFrameWnd;
+      const size_t prev_frame_slot =
+          (frame_slot + config_->FrameWnd() - 1) % config_->FrameWnd();
       std::printf(
           "Main [frame %zu + %.2f ms since last frame]: Received "
           "first packet. Remaining packets in prev frame: %zu\n",
@@ -1062,9 +2296,12 @@ void Agora::UpdateRxCounters(size_t frame_id, size_t symbol_id) {
     PrintPerFrameDone(PrintType::kPacketRX, frame_id);
     rx_counters_.num_pkts_[frame_slot] = 0;
   }
+  return true;
 }
 
 void Agora::PrintPerFrameDone(PrintType print_type, size_t frame_id) {
+  TraceLog::Emit(kTracePerFrameDone | static_cast<uint16_t>(print_type), 0,
+                 static_cast<uint32_t>(frame_id));
   if (kDebugPrintPerFrameDone == true) {
     switch (print_type) {
       case (PrintType::kPacketRXPilots):
@@ -1163,6 +2400,9 @@ void Agora::PrintPerFrameDone(PrintType print_type, size_t frame_id) {
 
 void Agora::PrintPerSymbolDone(PrintType print_type, size_t frame_id,
                                size_t symbol_id) {
+  TraceLog::Emit(kTracePerSymbolDone | static_cast<uint16_t>(print_type),
+                 static_cast<uint16_t>(symbol_id),
+                 static_cast<uint32_t>(frame_id));
   if (kDebugPrintPerSymbolDone == true) {
     switch (print_type) {
       case (PrintType::kFFTPilots):
@@ -1180,7 +2420,7 @@ void Agora::PrintPerSymbolDone(PrintType print_type, size_t frame_id,
             frame_id, symbol_id,
             this->stats_->MasterGetMsSince(TsType::kFirstSymbolRX, frame_id),
             uplink_fft_counters_.GetSymbolCount(frame_id) + 1,
-            static_cast<int>(zf_last_frame_ == frame_id));
+            static_cast<int>(BeamformerReady(frame_id)));
         break;
       case (PrintType::kDemul):
         std::printf(
@@ -1247,6 +2487,9 @@ void Agora::PrintPerSymbolDone(PrintType print_type, size_t frame_id,
 
 void Agora::PrintPerTaskDone(PrintType print_type, size_t frame_id,
                              size_t symbol_id, size_t ant_or_sc_id) {
+  TraceLog::Emit(kTracePerTaskDone | static_cast<uint16_t>(print_type),
+                 static_cast<uint16_t>(ant_or_sc_id),
+                 static_cast<uint32_t>(frame_id));
   if (kDebugPrintPerTaskDone == true) {
     switch (print_type) {
       case (PrintType::kZF):
@@ -1298,21 +2541,131 @@ void Agora::PrintPerTaskDone(PrintType print_type, size_t frame_id,
   }
 }
 
+// Worst-case number of events one frame can put into event_type's task
+// queue, derived from the config instead of a fixed constant. These are
+// per-task counts, so batched range events only come in under them
+static size_t WorstCaseFrameEvents(const Config* cfg, EventType event_type) {
+  const size_t ul_syms = cfg->Frame().NumULSyms();
+  const size_t dl_syms = cfg->Frame().NumDLSyms();
+  const size_t cbs_per_symbol =
+      cfg->UeAntNum() * cfg->LdpcConfig().NumBlocksInSymbol();
+  switch (event_type) {
+    case EventType::kFFT:
+    case EventType::kFFTPilot:
+      return cfg->BsAntNum() * cfg->Frame().NumTotalSyms();
+    case EventType::kZF:
+      return cfg->ZfEventsPerSymbol();
+    case EventType::kDemul:
+      return cfg->DemulEventsPerSymbol() * ul_syms;
+    case EventType::kPrecode:
+      return cfg->DemulEventsPerSymbol() * dl_syms;
+    case EventType::kDecode:
+      return cbs_per_symbol * ul_syms;
+    case EventType::kEncode:
+    case EventType::kModul:
+      return cbs_per_symbol * dl_syms;
+    case EventType::kIFFT:
+    case EventType::kPacketTX:
+      return cfg->BsAntNum() * dl_syms;
+    default:
+      // Control-plane events (MAC, SNR reports, RAN updates): a handful
+      // per frame at most
+      return kDefaultWorkerQueueSize;
+  }
+}
+
 void Agora::InitializeQueues() {
   using mt_queue_t = moodycamel::ConcurrentQueue<EventData>;
 
-  int data_symbol_num_perframe = config_->Frame().NumDataSyms();
-  message_queue_ =
-      mt_queue_t(kDefaultMessageQueueSize * data_symbol_num_perframe);
-  for (auto& c : complete_task_queue_) {
-    c = mt_queue_t(kDefaultWorkerQueueSize * data_symbol_num_perframe);
+  if (config_->QueueStats() == true) {
+    QueueMonitor::Enable();
+  }
+
+  // Capacities are sized so that every in-flight frame's events fit at
+  // once: under burst the queues must never malloc new blocks mid-frame
+  // (we have caught page faults inside TryEnqueueFallback on the master
+  // thread). The frame window bounds the frames in flight, so worst-case
+  // events per frame times the window is a true upper bound
+  const size_t rx_events =
+      config_->BsAntNum() * config_->Frame().NumTotalSyms();
+  size_t frame_task_events = 0;
+  std::array<size_t, kNumEventTypes> task_queue_cap{};
+  for (size_t ev = 0; ev < kNumEventTypes; ev++) {
+    const size_t events =
+        WorstCaseFrameEvents(config_, static_cast<EventType>(ev));
+    frame_task_events += events;
+    task_queue_cap.at(ev) =
+        std::max(events * config_->FrameWnd(), kDefaultWorkerQueueSize);
+  }
+  const size_t message_cap = std::max(
+      (rx_events + frame_task_events) * config_->FrameWnd(),
+      kDefaultMessageQueueSize);
+  const size_t complete_cap =
+      std::max(frame_task_events * config_->FrameWnd(),
+               kDefaultWorkerQueueSize);
+  // The master round-robins tasks over the per-worker steal queues, so
+  // each holds its even share; one default queue of slack absorbs the
+  // skew from the shared round-robin cursor
+  const size_t worker_num = config_->WorkerThreadNum();
+  const size_t steal_cap =
+      (((frame_task_events + worker_num - 1) / worker_num) *
+       config_->FrameWnd()) +
+      kDefaultWorkerQueueSize;
+  // MAC-side queues carry a few control events per frame
+  const size_t mac_cap = std::max(
+      config_->UeAntNum() * config_->FrameWnd(), kDefaultMessageQueueSize);
+
+  // Back all queue storage with one preallocated hugepage arena so block
+  // pulls never fault and never take the allocator lock. sizeof(EventData)
+  // plus a per-slot share of the block headers covers the blocks; the
+  // per-queue constant covers block indices, tokens and producer hashes
+  size_t total_capacity =
+      message_cap + (2 * mac_cap) + (kScheduleQueues * complete_cap);
+  for (size_t ev = 0; ev < kNumEventTypes; ev++) {
+    total_capacity += kScheduleQueues * task_queue_cap.at(ev);
+  }
+  size_t num_queues = 3 + (kScheduleQueues * (1 + kNumEventTypes));
+  if (config_->WorkStealSched() == true) {
+    total_capacity += kScheduleQueues * worker_num * steal_cap;
+    num_queues += kScheduleQueues * worker_num;
+  }
+  const size_t arena_bytes = (total_capacity * (sizeof(EventData) + 16)) +
+                             (num_queues * (64 * 1024));
+  Agora_memory::QueueArenaInit(arena_bytes);
+
+  message_queue_ = mt_queue_t(message_cap);
+  QueueMonitor::Register("message", &message_queue_);
+  mac_request_queue_ = mt_queue_t(mac_cap);
+  mac_response_queue_ = mt_queue_t(mac_cap);
+  for (size_t qid = 0; qid < kScheduleQueues; qid++) {
+    complete_task_queue_[qid] = mt_queue_t(complete_cap);
+    QueueMonitor::Register("complete_q" + std::to_string(qid),
+                           &complete_task_queue_[qid]);
   }
   // Create concurrent queues for each Doer
-  for (auto& vec : sched_info_arr_) {
-    for (auto& s : vec) {
-      s.concurrent_q_ =
-          mt_queue_t(kDefaultWorkerQueueSize * data_symbol_num_perframe);
+  for (size_t qid = 0; qid < kScheduleQueues; qid++) {
+    for (size_t ev = 0; ev < kNumEventTypes; ev++) {
+      SchedInfoT& s = sched_info_arr_[qid][ev];
+      s.concurrent_q_ = mt_queue_t(task_queue_cap.at(ev));
       s.ptok_ = new moodycamel::ProducerToken(s.concurrent_q_);
+      QueueMonitor::Register(
+          std::string(EventTypeString(ev)) + "_q" + std::to_string(qid),
+          &s.concurrent_q_);
+    }
+  }
+
+  if (config_->WorkStealSched() == true) {
+    // Per-worker task queues used in work-stealing mode. The master thread
+    // is the only producer; any worker may consume.
+    for (size_t qid = 0; qid < kScheduleQueues; qid++) {
+      for (size_t i = 0; i < worker_num; i++) {
+        SchedInfoT& s = steal_info_arr_[qid][i];
+        s.concurrent_q_ = mt_queue_t(steal_cap);
+        s.ptok_ = new moodycamel::ProducerToken(s.concurrent_q_);
+        QueueMonitor::Register(
+            "steal_w" + std::to_string(i) + "_q" + std::to_string(qid),
+            &s.concurrent_q_);
+      }
     }
   }
 
@@ -1328,6 +2681,12 @@ void Agora::InitializeQueues() {
           new moodycamel::ProducerToken(complete_task_queue_[j]);
     }
   }
+
+  if (kUseSpscCompletion == true) {
+    for (auto& rings : completion_rings_) {
+      rings = std::make_unique<CompletionRing[]>(config_->WorkerThreadNum());
+    }
+  }
 }
 
 void Agora::FreeQueues() {
@@ -1338,6 +2697,14 @@ void Agora::FreeQueues() {
     }
   }
 
+  if (config_->WorkStealSched() == true) {
+    for (auto& vec : steal_info_arr_) {
+      for (size_t i = 0; i < config_->WorkerThreadNum(); i++) {
+        delete vec[i].ptok_;
+      }
+    }
+  }
+
   for (size_t i = 0; i < config_->SocketThreadNum(); i++) {
     delete rx_ptoks_ptr_[i];
     delete tx_ptoks_ptr_[i];
@@ -1352,24 +2719,41 @@ void Agora::FreeQueues() {
 
 void Agora::InitializeUplinkBuffers() {
   const auto& cfg = config_;
-  const size_t task_buffer_symbol_num_ul = cfg->Frame().NumULSyms() * kFrameWnd;
+  const size_t task_buffer_symbol_num_ul =
+      cfg->Frame().NumULSyms() * cfg->FrameWnd();
 
-  socket_buffer_size_ = cfg->PacketLength() * cfg->BsAntNum() * kFrameWnd *
+  socket_buffer_size_ = cfg->PacketLength() * cfg->BsAntNum() *
+                        cfg->FrameWnd() *
                         cfg->Frame().NumTotalSyms();
 
   socket_buffer_.Malloc(cfg->SocketThreadNum() /* RX */, socket_buffer_size_,
-                        Agora_memory::Alignment_t::kAlign64);
+                        Agora_memory::Alignment_t::kAlign64, -1,
+                        "socket_buffer");
+
+  // With NUMA binding enabled, place the buffers the doers hammer on the
+  // node that hosts the worker cores, so demul/equalization traffic stays
+  // on-socket on multi-socket machines
+  int worker_numa_node = -1;
+  if (cfg->NumaBind() == true) {
+    worker_numa_node = GetNumaNodeOfCore(base_worker_core_offset_);
+    MLPD_INFO("Agora: binding uplink worker buffers to NUMA node %d\n",
+              worker_numa_node);
+  }
 
   data_buffer_.Malloc(task_buffer_symbol_num_ul,
                       cfg->OfdmDataNum() * cfg->BsAntNum(),
-                      Agora_memory::Alignment_t::kAlign64);
+                      Agora_memory::Alignment_t::kAlign64, worker_numa_node,
+                      "data_buffer");
 
   equal_buffer_.Malloc(task_buffer_symbol_num_ul,
                        cfg->OfdmDataNum() * cfg->UeAntNum(),
-                       Agora_memory::Alignment_t::kAlign64);
+                       Agora_memory::Alignment_t::kAlign64, worker_numa_node);
   ue_spec_pilot_buffer_.Calloc(
-      kFrameWnd, cfg->Frame().ClientUlPilotSymbols() * cfg->UeAntNum(),
+      cfg->FrameWnd(),
+      cfg->Frame().ClientUlPilotSymbols() * cfg->UeAntNum(),
       Agora_memory::Alignment_t::kAlign64);
+  dl_zf_unchanged_.Calloc(config_->FrameWnd(), cfg->OfdmDataNum(),
+                          Agora_memory::Alignment_t::kAlign64);
 
   rx_counters_.num_pkts_per_frame_ =
       cfg->BsAntNum() *
@@ -1378,8 +2762,11 @@ void Agora::InitializeUplinkBuffers() {
   rx_counters_.num_pilot_pkts_per_frame_ =
       cfg->BsAntNum() * cfg->Frame().NumPilotSyms();
   rx_counters_.num_reciprocity_pkts_per_frame_ = cfg->BsAntNum();
+  rx_counters_.InitBitmap(cfg->Frame().NumTotalSyms() * cfg->BsAntNum());
 
-  fft_created_count_ = 0;
+  fft_created_counts_.fill(0);
+  zf_partial_frame_.fill(SIZE_MAX);
+  zf_partial_state_.fill(ZfPartialState::kIdle);
   pilot_fft_counters_.Init(cfg->Frame().NumPilotSyms(), cfg->BsAntNum());
   uplink_fft_counters_.Init(cfg->Frame().NumULSyms(), cfg->BsAntNum());
   fft_cur_frame_for_symbol_ =
@@ -1396,6 +2783,30 @@ void Agora::InitializeUplinkBuffers() {
       cfg->LdpcConfig().NumBlocksInSymbol() * cfg->UeAntNum());
 
   tomac_counters_.Init(cfg->Frame().NumULSyms(), cfg->UeAntNum());
+
+  if ((cfg->ChainedFftDemul() == true) && (cfg->Frame().NumULSyms() > 0)) {
+    // Value-initialized, so counts start at 0 and no symbol is claimed.
+    // Shared with every DoFFT instance (see DoFFT::SetChainedDemul)
+    chained_fft_task_counts_ = std::make_unique<std::atomic<size_t>[]>(
+        config_->FrameWnd() * cfg->Frame().NumULSyms());
+    chained_demul_claimed_ = std::make_unique<std::atomic<uint8_t>[]>(
+        config_->FrameWnd() * cfg->Frame().NumULSyms());
+  }
+
+  if (cfg->CfoCorrection() == true) {
+    // Value-initialized: every UE starts with a zero (no-op) estimate
+    cfo_phase_per_sample_ =
+        std::make_unique<std::atomic<float>[]>(cfg->UeAntNum());
+  }
+
+  if ((cfg->ZfBlockGatedDemul() == true) && (cfg->Frame().NumULSyms() > 0)) {
+    zf_block_done_.assign(config_->FrameWnd() * cfg->ZfEventsPerSymbol(), 0);
+    demul_block_released_.assign(
+        cfg->FrameWnd() * cfg->Frame().NumULSyms() *
+            cfg->DemulEventsPerSymbol(),
+        0);
+    zf_block_frame_.fill(SIZE_MAX);
+  }
 }
 
 void Agora::InitializeDownlinkBuffers() {
@@ -1403,42 +2814,55 @@ void Agora::InitializeDownlinkBuffers() {
     std::printf("Agora: Initializing downlink buffers\n");
 
     const size_t task_buffer_symbol_num =
-        config_->Frame().NumDLSyms() * kFrameWnd;
+        config_->Frame().NumDLSyms() * config_->FrameWnd();
 
     size_t dl_socket_buffer_status_size =
         config_->BsAntNum() * task_buffer_symbol_num;
+    // Payloads only: TX attaches Packet headers via scatter-gather, so
+    // the buffer carries no per-packet header gaps. Zero-initialized: the
+    // TX zero prefix/postfix guard samples of every downlink symbol are
+    // written here once and never again -- DoIFFT only writes the
+    // [OfdmTxZeroPrefix, OfdmTxZeroPrefix + CpLen + OfdmCaNum) sample
+    // range, so the guards act as a persistent symbol template
     size_t dl_socket_buffer_size =
-        config_->DlPacketLength() * dl_socket_buffer_status_size;
+        config_->DlPayloadLength() * dl_socket_buffer_status_size;
     AllocBuffer1d(&dl_socket_buffer_, dl_socket_buffer_size,
-                  Agora_memory::Alignment_t::kAlign64, 0);
+                  Agora_memory::Alignment_t::kAlign64, 1);
     AllocBuffer1d(&dl_socket_buffer_status_, dl_socket_buffer_status_size,
                   Agora_memory::Alignment_t::kAlign64, 1);
 
-    size_t dl_bits_buffer_size = kFrameWnd * config_->DlMacBytesNumPerframe();
+    size_t dl_bits_buffer_size =
+        config_->FrameWnd() * config_->DlMacBytesNumPerframe();
     this->dl_bits_buffer_.Calloc(config_->UeAntNum(), dl_bits_buffer_size,
                                  Agora_memory::Alignment_t::kAlign64);
-    this->dl_bits_buffer_status_.Calloc(config_->UeAntNum(), kFrameWnd,
+    this->dl_bits_buffer_status_.Calloc(config_->UeAntNum(),
+                                        config_->FrameWnd(),
                                         Agora_memory::Alignment_t::kAlign64);
 
     dl_ifft_buffer_.Calloc(config_->BsAntNum() * task_buffer_symbol_num,
                            config_->OfdmCaNum(),
                            Agora_memory::Alignment_t::kAlign64);
-    calib_dl_buffer_.Calloc(kFrameWnd,
+    if (config_->FusedPrecodeIfft() == true) {
+      // Value-initialized, so every per-(slot, symbol) count starts at 0
+      fused_precode_task_counts_ = std::make_unique<std::atomic<size_t>[]>(
+          config_->FrameWnd() * config_->Frame().NumDLSyms());
+    }
+    calib_dl_buffer_.Calloc(config_->FrameWnd(),
                             config_->BfAntNum() * config_->OfdmDataNum(),
                             Agora_memory::Alignment_t::kAlign64);
-    calib_ul_buffer_.Calloc(kFrameWnd,
+    calib_ul_buffer_.Calloc(config_->FrameWnd(),
                             config_->BfAntNum() * config_->OfdmDataNum(),
                             Agora_memory::Alignment_t::kAlign64);
-    calib_dl_msum_buffer_.Calloc(kFrameWnd,
+    calib_dl_msum_buffer_.Calloc(config_->FrameWnd(),
                                  config_->BfAntNum() * config_->OfdmDataNum(),
                                  Agora_memory::Alignment_t::kAlign64);
-    calib_ul_msum_buffer_.Calloc(kFrameWnd,
+    calib_ul_msum_buffer_.Calloc(config_->FrameWnd(),
                                  config_->BfAntNum() * config_->OfdmDataNum(),
                                  Agora_memory::Alignment_t::kAlign64);
     // initialize the content of the last window to 1
     for (size_t i = 0; i < config_->OfdmDataNum() * config_->BfAntNum(); i++) {
-      calib_dl_buffer_[kFrameWnd - 1][i] = {1, 0};
-      calib_ul_buffer_[kFrameWnd - 1][i] = {1, 0};
+      calib_dl_buffer_[config_->FrameWnd() - 1][i] = {1, 0};
+      calib_ul_buffer_[config_->FrameWnd() - 1][i] = {1, 0};
     }
     dl_encoded_buffer_.Calloc(
         task_buffer_symbol_num,
@@ -1463,11 +2887,277 @@ void Agora::InitializeDownlinkBuffers() {
   }
 }
 
+void Agora::PrefaultBuffers() {
+  const auto& cfg = config_;
+  // Every long-lived buffer live traffic touches. Calloc'd tables are
+  // already faulted by their clearing memset, but locking them too keeps
+  // the kernel from ever evicting them. The FFT plans need no pass of
+  // their own: MKL commits them in the doer constructors, which run on
+  // the worker threads before Start()
+  std::vector<std::pair<void*, size_t>> regions;
+  const auto add_region = [&regions](void* mem, size_t bytes) {
+    if ((mem != nullptr) && (bytes > 0)) {
+      regions.emplace_back(mem, bytes);
+    }
+  };
+  add_region(socket_buffer_[0], socket_buffer_.AllocBytes());
+  add_region(ue_spec_pilot_buffer_[0], ue_spec_pilot_buffer_.AllocBytes());
+  add_region(csi_buffers_[0][0], csi_buffers_.AllocBytes());
+  add_region(ul_zf_matrices_[0][0], ul_zf_matrices_.AllocBytes());
+  if (cfg->Frame().NumULSyms() > 0) {
+    add_region(data_buffer_[0], data_buffer_.AllocBytes());
+    add_region(equal_buffer_[0], equal_buffer_.AllocBytes());
+    add_region(demod_buffers_[0][0][0], demod_buffers_.AllocBytes());
+    add_region(decoded_buffer_[0][0][0], decoded_buffer_.AllocBytes());
+  }
+  // The modulation table in the shared config is on every demul path
+  add_region(cfg->ModTable()[0], cfg->ModTable().AllocBytes());
+  if (cfg->Frame().NumDLSyms() > 0) {
+    const size_t dl_socket_buffer_status_size =
+        cfg->BsAntNum() * cfg->Frame().NumDLSyms() * config_->FrameWnd();
+    add_region(dl_zf_matrices_[0][0], dl_zf_matrices_.AllocBytes());
+    add_region(dl_socket_buffer_,
+               cfg->DlPayloadLength() * dl_socket_buffer_status_size);
+    add_region(dl_socket_buffer_status_,
+               dl_socket_buffer_status_size * sizeof(int));
+    add_region(dl_bits_buffer_[0], dl_bits_buffer_.AllocBytes());
+    add_region(dl_bits_buffer_status_[0], dl_bits_buffer_status_.AllocBytes());
+    add_region(dl_ifft_buffer_[0], dl_ifft_buffer_.AllocBytes());
+    add_region(calib_dl_buffer_[0], calib_dl_buffer_.AllocBytes());
+    add_region(calib_ul_buffer_[0], calib_ul_buffer_.AllocBytes());
+    add_region(calib_dl_msum_buffer_[0], calib_dl_msum_buffer_.AllocBytes());
+    add_region(calib_ul_msum_buffer_[0], calib_ul_msum_buffer_.AllocBytes());
+    add_region(dl_encoded_buffer_[0], dl_encoded_buffer_.AllocBytes());
+  }
+
+  // Touch in parallel: split the regions into fixed-size chunks and fault
+  // them in with one startup-only thread per worker core. The socket and
+  // data buffers dwarf everything else, so per-region parallelism alone
+  // would leave most threads idle
+  static constexpr size_t kPrefaultChunkBytes = 16 * 1024 * 1024;
+  struct Chunk {
+    char* mem;
+    size_t bytes;
+  };
+  std::vector<Chunk> chunks;
+  size_t total_bytes = 0;
+  for (const auto& region : regions) {
+    total_bytes += region.second;
+    for (size_t offset = 0; offset < region.second;
+         offset += kPrefaultChunkBytes) {
+      chunks.push_back({static_cast<char*>(region.first) + offset,
+                        std::min(kPrefaultChunkBytes, region.second - offset)});
+    }
+  }
+
+  const double start_us = GetTime::GetTimeUs();
+  const size_t num_threads = std::max(cfg->WorkerThreadNum(), size_t{1});
+  std::atomic<size_t> next_chunk(0);
+  std::vector<std::thread> touch_threads;
+  touch_threads.reserve(num_threads);
+  for (size_t i = 0; i < num_threads; i++) {
+    touch_threads.emplace_back([&chunks, &next_chunk]() {
+      for (size_t c = next_chunk.fetch_add(1); c < chunks.size();
+           c = next_chunk.fetch_add(1)) {
+        Agora_memory::PrefaultPages(chunks.at(c).mem, chunks.at(c).bytes);
+      }
+    });
+  }
+  for (auto& thread : touch_threads) {
+    thread.join();
+  }
+
+  size_t lock_failed_bytes = 0;
+  for (const auto& region : regions) {
+    if (Agora_memory::LockPages(region.first, region.second) == false) {
+      lock_failed_bytes += region.second;
+    }
+  }
+  MLPD_INFO("Agora: prefaulted %zu buffers (%.1f MB) with %zu threads in "
+            "%.1f ms\n",
+            regions.size(), total_bytes / (1024.0 * 1024.0), num_threads,
+            (GetTime::GetTimeUs() - start_us) / 1000.0);
+  if (lock_failed_bytes > 0) {
+    std::printf(
+        "Agora: WARNING: mlock failed for %.1f MB of prefaulted buffers "
+        "(check RLIMIT_MEMLOCK); the pages stay faulted in but remain "
+        "evictable\n",
+        lock_failed_bytes / (1024.0 * 1024.0));
+  }
+}
+
+bool Agora::PrintMemoryPlan(const Config* cfg) {
+  // One row per planned allocation. Mirrors the constructor,
+  // InitializeUplinkBuffers() and InitializeDownlinkBuffers(); keep the
+  // formulas in sync when the allocations change.
+  struct PlanEntry {
+    const char* name_;
+    size_t dim1_;
+    size_t dim2_;
+    size_t elem_bytes_;
+  };
+  std::vector<PlanEntry> entries;
+
+  const size_t task_buffer_symbol_num_ul =
+      cfg->Frame().NumULSyms() * cfg->FrameWnd();
+  const size_t socket_buffer_size = cfg->PacketLength() * cfg->BsAntNum() *
+                                    cfg->FrameWnd() *
+                                    cfg->Frame().NumTotalSyms();
+  entries.push_back(
+      {"socket_buffer", cfg->SocketThreadNum(), socket_buffer_size, 1});
+  entries.push_back({"data_buffer", task_buffer_symbol_num_ul,
+                     cfg->OfdmDataNum() * cfg->BsAntNum(),
+                     sizeof(complex_float)});
+  entries.push_back({"equal_buffer", task_buffer_symbol_num_ul,
+                     cfg->OfdmDataNum() * cfg->UeAntNum(),
+                     sizeof(complex_float)});
+  entries.push_back(
+      {"ue_spec_pilot_buffer", cfg->FrameWnd(),
+       cfg->Frame().ClientUlPilotSymbols() * cfg->UeAntNum(),
+       sizeof(complex_float)});
+  entries.push_back({"csi_buffers", cfg->FrameWnd() * cfg->UeAntNum(),
+                     (cfg->BsAntNum() * cfg->OfdmDataNum()) /
+                         (cfg->CsiFp16() ? 2 : 1),
+                     sizeof(complex_float)});
+  entries.push_back({"ul_zf_matrices", cfg->FrameWnd() * cfg->OfdmDataNum(),
+                     cfg->BsAntNum() * cfg->UeAntNum(),
+                     sizeof(complex_float)});
+  entries.push_back({"dl_zf_matrices", cfg->FrameWnd() * cfg->OfdmDataNum(),
+                     cfg->UeAntNum() * cfg->BsAntNum(),
+                     sizeof(complex_float)});
+  entries.push_back(
+      {"demod_buffers",
+       cfg->FrameWnd() * cfg->Frame().NumULSyms() * cfg->UeAntNum(),
+       ((kMaxModType * cfg->OfdmDataNum()) / (cfg->Llr4Bit() ? 2 : 1)) +
+           kLdpcHelperFunctionInputBufferSizePaddingBytes,
+       1});
+  entries.push_back(
+      {"decoded_buffer",
+       cfg->FrameWnd() * cfg->Frame().NumULSyms() * cfg->UeAntNum(),
+       cfg->HardDemod()
+           ? Roundup<64>((cfg->OfdmDataNum() * kMaxModType) / 8)
+           : ((cfg->OfdmDataNum() * kMaxModType) /
+              cfg->LdpcConfig().NumCbCodewLen()) *
+                 Roundup<64>(cfg->NumBytesPerCb()),
+       1});
+
+  if (cfg->Frame().NumDLSyms() > 0) {
+    const size_t task_buffer_symbol_num =
+        cfg->Frame().NumDLSyms() * cfg->FrameWnd();
+    const size_t dl_socket_buffer_status_size =
+        cfg->BsAntNum() * task_buffer_symbol_num;
+    entries.push_back({"dl_socket_buffer", dl_socket_buffer_status_size,
+                       cfg->DlPayloadLength(), 1});
+    entries.push_back(
+        {"dl_socket_buffer_status", dl_socket_buffer_status_size, 1,
+         sizeof(int)});
+    entries.push_back({"dl_bits_buffer", cfg->UeAntNum(),
+                       cfg->FrameWnd() * cfg->DlMacBytesNumPerframe(), 1});
+    entries.push_back(
+        {"dl_bits_buffer_status", cfg->UeAntNum(), cfg->FrameWnd(),
+         sizeof(int)});
+    entries.push_back({"dl_ifft_buffer",
+                       cfg->BsAntNum() * task_buffer_symbol_num,
+                       cfg->OfdmCaNum(), sizeof(complex_float)});
+    for (const char* calib : {"calib_dl_buffer", "calib_ul_buffer",
+                              "calib_dl_msum_buffer", "calib_ul_msum_buffer"}) {
+      entries.push_back({calib, cfg->FrameWnd(),
+                         cfg->BfAntNum() * cfg->OfdmDataNum(),
+                         sizeof(complex_float)});
+    }
+    entries.push_back({"dl_encoded_buffer", task_buffer_symbol_num,
+                       Roundup<64>(cfg->OfdmDataNum()) * cfg->UeAntNum(), 1});
+  }
+
+  std::printf("Agora memory plan (%zu frame window):\n", cfg->FrameWnd());
+  size_t total_bytes = 0;
+  for (const auto& e : entries) {
+    const size_t bytes = e.dim1_ * e.dim2_ * e.elem_bytes_;
+    total_bytes += bytes;
+    std::printf("  %-24s %10zu x %-10zu = %9.1f MB\n", e.name_, e.dim1_,
+                e.dim2_ * e.elem_bytes_, bytes / (1024.0 * 1024.0));
+  }
+
+  // Queue storage is reserved up front in the event-queue arena (see
+  // InitializeQueues); mirror its worst-case sizing. The slot payloads
+  // dominate, so report those (the queue bookkeeping adds a few percent)
+  const size_t rx_events = cfg->BsAntNum() * cfg->Frame().NumTotalSyms();
+  size_t frame_task_events = 0;
+  size_t task_slots = 0;
+  for (size_t ev = 0; ev < kNumEventTypes; ev++) {
+    const size_t events = WorstCaseFrameEvents(cfg, static_cast<EventType>(ev));
+    frame_task_events += events;
+    task_slots += kScheduleQueues *
+                  std::max(events * cfg->FrameWnd(), kDefaultWorkerQueueSize);
+  }
+  size_t num_queues = 1 + (kScheduleQueues * (1 + kNumEventTypes));
+  size_t queue_slots =
+      ((rx_events + frame_task_events) * cfg->FrameWnd()) +
+      (kScheduleQueues * frame_task_events * cfg->FrameWnd()) + task_slots;
+  if (cfg->WorkStealSched() == true) {
+    const size_t workers = cfg->WorkerThreadNum();
+    const size_t steal_cap =
+        (((frame_task_events + workers - 1) / workers) * cfg->FrameWnd()) +
+        kDefaultWorkerQueueSize;
+    queue_slots += kScheduleQueues * workers * steal_cap;
+    num_queues += kScheduleQueues * workers;
+  }
+  const size_t queue_bytes = queue_slots * sizeof(EventData);
+  total_bytes += queue_bytes;
+  std::printf("  %-24s %10zu queues         = %9.1f MB\n", "event_queues",
+              num_queues, queue_bytes / (1024.0 * 1024.0));
+
+  // Compare against what the machine can actually back
+  auto meminfo_kb = [](const char* key) -> size_t {
+    std::FILE* fp = std::fopen("/proc/meminfo", "r");
+    if (fp == nullptr) {
+      return 0;
+    }
+    char line[256];
+    size_t value = 0;
+    while (std::fgets(line, sizeof(line), fp) != nullptr) {
+      if (std::strncmp(line, key, std::strlen(key)) == 0) {
+        std::sscanf(line + std::strlen(key), ": %zu", &value);
+        break;
+      }
+    }
+    std::fclose(fp);
+    return value;
+  };
+  const size_t hugepages_free = meminfo_kb("HugePages_Free");
+  const size_t hugepage_kb = meminfo_kb("Hugepagesize");
+  const size_t hugepage_bytes = hugepages_free * hugepage_kb * 1024;
+  const size_t available_bytes = meminfo_kb("MemAvailable") * 1024;
+
+  std::printf(
+      "Agora memory plan: total %.2f GB; free hugepages %zu x %zu kB "
+      "(%.2f GB), MemAvailable %.2f GB\n",
+      total_bytes / (1024.0 * 1024.0 * 1024.0), hugepages_free, hugepage_kb,
+      hugepage_bytes / (1024.0 * 1024.0 * 1024.0),
+      available_bytes / (1024.0 * 1024.0 * 1024.0));
+
+  const bool fits = (total_bytes <= (hugepage_bytes + available_bytes));
+  if (fits == false) {
+    std::printf(
+        "Agora memory plan: DOES NOT FIT -- raise vm.nr_hugepages or "
+        "shrink the config\n");
+  } else if (total_bytes > hugepage_bytes) {
+    std::printf(
+        "Agora memory plan: fits, but only %.2f GB is hugepage-backed; "
+        "the rest falls back to base pages\n",
+        hugepage_bytes / (1024.0 * 1024.0 * 1024.0));
+  } else {
+    std::printf("Agora memory plan: fits in free hugepages\n");
+  }
+  return fits;
+}
+
 void Agora::FreeUplinkBuffers() {
   socket_buffer_.Free();
   data_buffer_.Free();
   equal_buffer_.Free();
   ue_spec_pilot_buffer_.Free();
+  dl_zf_unchanged_.Free();
 }
 
 void Agora::FreeDownlinkBuffers() {
@@ -1498,7 +3188,7 @@ void Agora::SaveDecodeDataToFile(int frame_id) {
 
   for (size_t i = 0; i < cfg->Frame().NumULSyms(); i++) {
     for (size_t j = 0; j < cfg->UeAntNum(); j++) {
-      int8_t* ptr = decoded_buffer_[(frame_id % kFrameWnd)][i][j];
+      int8_t* ptr = decoded_buffer_[(frame_id % config_->FrameWnd())][i][j];
       std::fwrite(ptr, num_decoded_bytes, sizeof(uint8_t), fp);
     }
   }
@@ -1518,9 +3208,8 @@ void Agora::SaveTxDataToFile(UNUSED int frame_id) {
 
     for (size_t ant_id = 0; ant_id < cfg->BsAntNum(); ant_id++) {
       size_t offset = total_data_symbol_id * cfg->BsAntNum() + ant_id;
-      auto* pkt = reinterpret_cast<struct Packet*>(
-          &dl_socket_buffer_[offset * cfg->DlPacketLength()]);
-      short* socket_ptr = pkt->data_;
+      auto* socket_ptr = reinterpret_cast<short*>(
+          &dl_socket_buffer_[offset * cfg->DlPayloadLength()]);
       std::fwrite(socket_ptr, cfg->SampsPerSymbol() * 2, sizeof(short), fp);
     }
   }
@@ -1534,23 +3223,110 @@ void Agora::GetEqualData(float** ptr, int* size) {
   *ptr = (float*)&equal_buffer_[offset][0];
   *size = cfg->UeAntNum() * cfg->OfdmDataNum() * 2;
 }
+bool Agora::CompleteIfftTask(size_t frame_id, size_t symbol_id,
+                             size_t ant_id) {
+  const size_t symbol_idx_dl = config_->Frame().GetDLSymbolIdx(symbol_id);
+  PrintPerTaskDone(PrintType::kIFFT, frame_id, symbol_id, ant_id);
+
+  bool last_ifft_task =
+      this->ifft_counters_.CompleteTask(frame_id, symbol_id, ant_id);
+  if (last_ifft_task == true) {
+    ifft_cur_frame_for_symbol_.at(symbol_idx_dl) = frame_id;
+    if (symbol_idx_dl == ifft_next_symbol_) {
+      // Check the available symbols starting from the current symbol
+      // Only schedule symbols that are continuously available
+      for (size_t sym_id = symbol_idx_dl;
+           sym_id <= ifft_counters_.GetSymbolCount(frame_id); sym_id++) {
+        size_t symbol_ifft_frame = ifft_cur_frame_for_symbol_.at(sym_id);
+        if (symbol_ifft_frame == frame_id) {
+          ScheduleAntennasTX(frame_id, config_->Frame().GetDLSymbol(sym_id));
+          ifft_next_symbol_++;
+        } else {
+          break;
+        }
+      }
+    }
+    PrintPerSymbolDone(PrintType::kIFFT, frame_id, symbol_id);
+
+    bool last_ifft_symbol = this->ifft_counters_.CompleteSymbol(frame_id);
+    if (last_ifft_symbol == true) {
+      ifft_next_symbol_ = 0;
+      this->stats_->MasterSetTsc(TsType::kIFFTDone, frame_id);
+      PrintPerFrameDone(PrintType::kIFFT, frame_id);
+      assert(frame_id == this->cur_proc_frame_id_);
+      this->CheckIncrementScheduleFrame(frame_id, kDownlinkComplete);
+      return this->CheckFrameComplete(frame_id);
+    }
+  }
+  return false;
+}
+
 void Agora::CheckIncrementScheduleFrame(size_t frame_id,
                                         ScheduleProcessingFlags completed) {
-  this->schedule_process_flags_ += completed;
-  assert(this->cur_sche_frame_id_ == frame_id);
-  unused(frame_id);
-
-  if (this->schedule_process_flags_ ==
-      static_cast<uint8_t>(ScheduleProcessingFlags::kProcessingComplete)) {
-    this->cur_sche_frame_id_++;
-    this->schedule_process_flags_ = ScheduleProcessingFlags::kNone;
+  assert(frame_id < (this->cur_sche_frame_id_ + kScheduleQueues));
+  this->schedule_process_flags_.at(frame_id % kScheduleQueues) += completed;
+
+  // Advance the schedule frame past every fully-scheduled frame. With a
+  // pipeline depth above two, frames complete their scheduling slightly out
+  // of order, so each frame in flight tracks its own flags.
+  for (size_t adv = 0; adv < kScheduleQueues; adv++) {
+    const size_t sche_slot = this->cur_sche_frame_id_ % kScheduleQueues;
+    if (this->schedule_process_flags_.at(sche_slot) !=
+        static_cast<uint8_t>(ScheduleProcessingFlags::kProcessingComplete)) {
+      break;
+    }
+    // Re-seed the slot for the frame that will reuse it
+    uint8_t& flags = this->schedule_process_flags_.at(sche_slot);
+    flags = ScheduleProcessingFlags::kNone;
     if (this->config_->Frame().NumULSyms() == 0) {
-      this->schedule_process_flags_ += ScheduleProcessingFlags::kUplinkComplete;
+      flags += ScheduleProcessingFlags::kUplinkComplete;
     }
     if (this->config_->Frame().NumDLSyms() == 0) {
-      this->schedule_process_flags_ +=
-          ScheduleProcessingFlags::kDownlinkComplete;
+      flags += ScheduleProcessingFlags::kDownlinkComplete;
     }
+    this->cur_sche_frame_id_++;
+  }
+}
+
+void Agora::UpdateWorkerAssignments(size_t frame_id) {
+  // Doer types serviced by Worker(tid), paired with the polled event type.
+  // CSI and RC tasks are carried by the FFT queue and need no entry here.
+  static constexpr std::array<std::pair<DoerType, EventType>, 7> kWorkerDoers =
+      {{{DoerType::kZF, EventType::kZF},
+        {DoerType::kFFT, EventType::kFFT},
+        {DoerType::kDecode, EventType::kDecode},
+        {DoerType::kDemul, EventType::kDemul},
+        {DoerType::kIFFT, EventType::kIFFT},
+        {DoerType::kPrecode, EventType::kPrecode},
+        {DoerType::kEncode, EventType::kEncode}}};
+
+  std::array<double, kWorkerDoers.size()> load;
+  double total_us = 0.0;
+  for (size_t d = 0; d < kWorkerDoers.size(); d++) {
+    load.at(d) = this->stats_->DoerUs(kWorkerDoers.at(d).first, frame_id);
+    total_us += load.at(d);
+  }
+  if (total_us <= 0.0) {
+    return;  // Worker timing disabled or an idle frame: keep assignments
+  }
+
+  // Hand out primaries in proportion to each doer type's share of the busy
+  // time last frame, by stepping each worker's quantile through the
+  // cumulative load distribution
+  const size_t num_workers = this->config_->WorkerThreadNum();
+  double cumulative_us = 0.0;
+  size_t d = 0;
+  for (size_t w = 0; w < num_workers; w++) {
+    const double target_us = (static_cast<double>(w) + 0.5) * total_us /
+                             static_cast<double>(num_workers);
+    while (((d + 1) < kWorkerDoers.size()) &&
+           ((cumulative_us + load.at(d)) < target_us)) {
+      cumulative_us += load.at(d);
+      d++;
+    }
+    this->worker_primary_event_[w].store(
+        static_cast<size_t>(kWorkerDoers.at(d).second),
+        std::memory_order_relaxed);
   }
 }
 
@@ -1574,17 +3350,56 @@ bool Agora::CheckFrameComplete(size_t frame_id) {
        ((true == kEnableMac) &&
         (true == this->tomac_counters_.IsLastSymbol(frame_id))))) {
     this->stats_->UpdateStats(frame_id);
+    // One depth sample per frame catches standing backlogs without
+    // touching the queues in the hot scheduling loops
+    QueueMonitor::SampleDepths(frame_id);
+    if (this->config_->AdaptiveSched() == true) {
+      UpdateWorkerAssignments(frame_id);
+    }
     assert(frame_id == this->cur_proc_frame_id_);
     this->decode_counters_.Reset(frame_id);
     this->tomac_counters_.Reset(frame_id);
     this->ifft_counters_.Reset(frame_id);
     this->tx_counters_.Reset(frame_id);
+    // All of this frame's tasks are done, so its scratch can be reclaimed
+    // and its frame-window slot released for reuse
+    FrameSlotMonitor::Release(frame_id);
+    this->frame_arenas_.at(frame_id % kScheduleQueues).Reset();
+    this->dl_urgent_.store(false, std::memory_order_relaxed);
     if (config_->Frame().NumDLSyms() > 0) {
       for (size_t ue_id = 0; ue_id < config_->UeAntNum(); ue_id++) {
-        this->dl_bits_buffer_status_[ue_id][frame_id % kFrameWnd] = 0;
+        this->dl_bits_buffer_status_[ue_id][frame_id % config_->FrameWnd()] = 0;
       }
     }
+    TraceLog::Emit(kTraceFrameDone, 0, static_cast<uint32_t>(frame_id));
     this->cur_proc_frame_id_++;
+    // Unblocks RX slot reuse for this frame's packets in frame-epoch
+    // reclamation mode
+    completed_frame_watermark_.store(cur_proc_frame_id_,
+                                     std::memory_order_release);
+
+    // Frame boundary: no uplink or downlink task of the finished frame is in
+    // flight anymore, so a pending RAN reconfiguration can now be applied by
+    // re-pointing the modulation tables without tearing down worker threads
+    if ((this->ran_config_pending_ == true) &&
+        (this->pending_ran_config_.frame_id_ <= this->cur_proc_frame_id_)) {
+      config_->UpdateModCfgs(this->pending_ran_config_.mod_order_bits_);
+      // The per-symbol code block budget follows the modulation order
+      const size_t cb_tasks_per_symbol =
+          config_->LdpcConfig().NumBlocksInSymbol() * config_->UeAntNum();
+      this->decode_counters_.SetMaxTaskCount(cb_tasks_per_symbol);
+      if (config_->Frame().NumDLSyms() > 0) {
+        this->encode_counters_.SetMaxTaskCount(cb_tasks_per_symbol);
+      }
+      if (this->pending_ran_config_.frame_schedule_.empty() == false) {
+        ApplyFrameSchedule(this->pending_ran_config_.frame_schedule_);
+        this->pending_ran_config_.frame_schedule_.clear();
+      }
+      if (this->pending_ran_config_.ul_block_mask_ != this->ul_block_mask_) {
+        ApplyUlBlockMask(this->pending_ran_config_.ul_block_mask_);
+      }
+      this->ran_config_pending_ = false;
+    }
 
     if (this->encode_deferral_.empty() == false) {
       for (size_t encode = 0; encode < kScheduleQueues; encode++) {
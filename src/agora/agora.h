@@ -9,6 +9,7 @@
 #include <unistd.h>
 
 #include <algorithm>
+#include <atomic>
 #include <iostream>
 #include <memory>
 #include <queue>
@@ -16,9 +17,11 @@
 #include <vector>
 
 #include "buffer.h"
+#include "completion_ring.h"
 #include "concurrent_queue_wrapper.h"
 #include "concurrentqueue.h"
 #include "config.h"
+#include "decode_offload.h"
 #include "dodecode.h"
 #include "dodemul.h"
 #include "doencode.h"
@@ -26,11 +29,17 @@
 #include "doifft.h"
 #include "doprecode.h"
 #include "dozf.h"
+#include "gpu_decode.h"
 #include "mac_thread_basestation.h"
 #include "memory_manage.h"
 #include "phy_stats.h"
+#include "equal_export.h"
+#include "frame_dumper.h"
+#include "sc_shard.h"
+#include "shadow_bench.h"
 #include "signal_handler.h"
 #include "stats.h"
+#include "telemetry.h"
 #include "txrx.h"
 #include "utils.h"
 
@@ -41,7 +50,16 @@ class Agora {
   static const size_t kDequeueBulkSizeWorker = 4;
   // Max number of worker threads allowed
   static const size_t kMaxWorkerNum = 50;
-  static const size_t kScheduleQueues = 2;
+  // Number of frames that may be in the scheduling pipeline concurrently.
+  // The default double-buffers scheduling; building with a depth of 3 or 4
+  // (cmake -DSCHEDULE_QUEUES=n) overlaps e.g. ZF of frame N with pilot FFTs
+  // of frame N + 1.
+#ifdef AGORA_SCHEDULE_QUEUES
+  static constexpr size_t kScheduleQueues = AGORA_SCHEDULE_QUEUES;
+#else
+  static constexpr size_t kScheduleQueues = 2;
+#endif
+  static_assert(kScheduleQueues >= 2, "Schedule pipeline depth must be >= 2");
 
   explicit Agora(
       Config* /*cfg*/);  /// Create an Agora object and start the worker threads
@@ -51,6 +69,13 @@ class Agora {
   void Stop();
   void GetEqualData(float** ptr, int* size);
 
+  /// Compute and print the size of every major buffer and queue that
+  /// running cfg would allocate, without allocating anything, and compare
+  /// the total against the machine's free hugepages and available memory.
+  /// Returns true if the plan fits. Used by the agora binary's --dry_run
+  /// flag for capacity planning.
+  static bool PrintMemoryPlan(const Config* cfg);
+
   // Flags that allow developer control over Agora internals
   struct {
     //     void getEqualData(float** ptr, int* size);Before exiting, save
@@ -77,22 +102,101 @@ class Agora {
   /// otherwise.
   bool CheckFrameComplete(size_t frame_id);
 
+  /// Master-side bookkeeping for one completed IFFT task: advance the
+  /// counters, schedule transmission of the symbols that became
+  /// contiguously ready, and close out the frame's downlink when the last
+  /// antenna lands. Returns true when all frame processing has finished.
+  /// Called per completion event, or per antenna from the precode handler
+  /// in fused precode+IFFT mode (where the worker ran the IFFTs inline)
+  bool CompleteIfftTask(size_t frame_id, size_t symbol_id, size_t ant_id);
+
   /// Increments the cur_sche_frame_id when all ScheduleProcessingFlags have
   /// been acheived.
   void CheckIncrementScheduleFrame(size_t frame_id,
                                    ScheduleProcessingFlags completed);
 
+  /// Re-assign each worker's primary event type from the per-doer duration
+  /// stats of the frame that just completed. Called at frame boundaries
+  /// when adaptive scheduling is enabled.
+  void UpdateWorkerAssignments(size_t frame_id);
+
+  /// Flag the downlink chain as urgent when frame_id's processing time
+  /// approaches the radio TX deadline. Workers then poll the precode/IFFT
+  /// queues ahead of uplink work. Called when deadline scheduling is enabled.
+  void UpdateDownlinkUrgency(size_t frame_id);
+
+  /// Antenna load-shedding controller, called when frame_id's uplink decode
+  /// completes and Config::AntShedNum() is nonzero. Engages shedding via
+  /// Config::SetAntShed() when a frame overruns the frame duration and
+  /// disengages it after several consecutive frames back under budget
+  void UpdateAntShed(size_t frame_id);
+
+  /// True if beamweights for frame_id are ready. With CSI prediction
+  /// enabled, the beamweights for a frame are computed during the previous
+  /// frame, so zf_last_frame_ can run one frame ahead of processing.
+  inline bool BeamformerReady(size_t frame_id) const {
+    return (zf_last_frame_ != SIZE_MAX) && (frame_id <= zf_last_frame_);
+  }
+
+  /// Index of (frame_id, symbol_id) in the chained FFT->demul shared
+  /// arrays (one entry per frame-window slot and uplink symbol)
+  inline size_t ChainedDemulIndex(size_t frame_id, size_t symbol_id) const {
+    return (config_->FrameSlot(frame_id) * config_->Frame().NumULSyms()) +
+           config_->Frame().GetULSymbolIdx(symbol_id);
+  }
+
+  /// Claim the right to schedule demul for (frame_id, symbol_id). Always
+  /// true outside chained FFT->demul mode; in chained mode, false means a
+  /// DoFFT worker already dispatched this symbol's demul tasks
+  inline bool TryClaimChainedDemul(size_t frame_id, size_t symbol_id) {
+    if (chained_demul_claimed_ == nullptr) {
+      return true;
+    }
+    return (chained_demul_claimed_[ChainedDemulIndex(frame_id, symbol_id)]
+                .exchange(1, std::memory_order_acq_rel) == 0);
+  }
+
+  /// Whether demul subcarrier block idx (indexed from the shard start)
+  /// carries scheduled uplink data under the active allocation mask.
+  /// Blocks past 64 cannot be masked (ApplyUlBlockMask keeps the full
+  /// band for such configs), so they always count as allocated
+  inline bool UlBlockAllocated(size_t block_idx) const {
+    return (block_idx >= 64) ||
+           (((ul_block_mask_ >> block_idx) & 1ULL) != 0);
+  }
+
+  /// Whether ZF block idx is needed to cover an allocated demul block
+  /// (or the downlink, which always uses the full band)
+  inline bool ZfBlockNeeded(size_t block_idx) const {
+    return (block_idx >= 64) ||
+           (((zf_block_mask_ >> block_idx) & 1ULL) != 0);
+  }
+
+  /// Apply an uplink resource-block allocation mask at a frame boundary:
+  /// normalize it, derive the covering ZF block mask, and shrink the
+  /// per-symbol ZF/demul task budgets so completion tracking matches the
+  /// reduced schedules. Invalid masks (empty, or a band wider than 64
+  /// blocks) keep the full band with a warning
+  void ApplyUlBlockMask(uint64_t mask);
+
   void WorkerFft(int tid);
   void WorkerZf(int tid);
   void WorkerDemul(int tid);
   void WorkerDecode(int tid);
   void Worker(int tid);
+  void WorkerSteal(int tid);
 
   void CreateThreads();  /// Launch worker threads
 
   void InitializeQueues();
   void InitializeUplinkBuffers();
   void InitializeDownlinkBuffers();
+
+  /// With Config::PrefaultBuffers(), fault in and mlock every long-lived
+  /// buffer before live traffic, parallelized across WorkerThreadNum()
+  /// startup-only threads, so frame 0 does not pay the lazy page faults
+  void PrefaultBuffers();
+
   void FreeQueues();
   void FreeUplinkBuffers();
   void FreeDownlinkBuffers();
@@ -101,7 +205,10 @@ class Agora {
   void SaveTxDataToFile(int frame_id);
 
   void HandleEventFft(size_t tag);
-  void UpdateRxCounters(size_t frame_id, size_t symbol_id);
+  // Account one received packet. Returns true if the packet should be
+  // processed; false for duplicates and stragglers whose frame slot in
+  // the RX window was already recycled
+  bool UpdateRxCounters(size_t frame_id, size_t symbol_id, size_t ant_id);
   void PrintPerFrameDone(PrintType print_type, size_t frame_id);
   void PrintPerSymbolDone(PrintType print_type, size_t frame_id,
                           size_t symbol_id);
@@ -111,6 +218,13 @@ class Agora {
   /// Update Agora's RAN config parameters
   void UpdateRanConfig(RanConfig rc);
 
+  /// Apply a hot-swapped frame schedule at a frame boundary: swap the
+  /// symbol maps via Config::UpdateFrameSchedule() and re-derive every
+  /// per-frame symbol budget that follows them. Best scheduled a few
+  /// frames ahead of the direction change, so frames pipelined past the
+  /// boundary do not mix old and new accounting
+  void ApplyFrameSchedule(const std::string& new_schedule);
+
   void ScheduleSubcarriers(EventType event_type, size_t frame_id,
                            size_t symbol_id);
   void ScheduleAntennas(EventType event_type, size_t frame_id,
@@ -128,8 +242,41 @@ class Agora {
   void ScheduleCodeblocks(EventType event_type, size_t frame_id,
                           size_t symbol_idx);
 
+  /// Fan-out bodies behind the scheduling wrappers above. With split_master
+  /// the wrappers only push a command into sched_ring_ and the scheduling
+  /// thread runs these; otherwise the wrappers call them directly.
+  void ScheduleSubcarriersInternal(EventType event_type, size_t frame_id,
+                                   size_t symbol_id);
+  void ScheduleCodeblocksInternal(EventType event_type, size_t frame_id,
+                                  size_t symbol_idx);
+
+  /// Block-gated demul (zf_block_gated_demul): record one ZF block's
+  /// completion for frame_id, recycling the frame slot's flags on the
+  /// frame's first block, then release newly ready demul blocks for every
+  /// uplink symbol whose FFT already finished for this frame
+  void MarkZfBlockDone(size_t frame_id, size_t base_sc_id);
+
+  /// Dispatch every not-yet-released demul block of (frame_id, symbol_id)
+  /// whose covering ZF blocks have all delivered beamweights. Idempotent;
+  /// called from both the ZF-completion and FFT-completion paths
+  void ReleaseReadyDemulBlocks(size_t frame_id, size_t symbol_id);
+
+  /// Scheduling thread main loop (split_master): drains sched_ring_ and
+  /// performs the per-symbol task fan-out into the worker queues
+  void RunSchedLoop();
+
   void ScheduleUsers(EventType event_type, size_t frame_id, size_t symbol_id);
 
+  /**
+   * @brief Route a demodulated uplink symbol to decode under subcarrier
+   * sharding: the owner defers kDecode until the remote shards' LLRs have
+   * merged, a non-owner forwards its slices and accounts the symbol as
+   * decoded (its uplink chain ends at demodulation)
+   * @return True if all work for the frame is complete on a non-owner
+   * (without MAC the caller must then stop processing the frame)
+   */
+  bool ScheduleShardedDecode(size_t frame_id, size_t symbol_id);
+
   // Send current frame's SNR measurements from PHY to MAC
   void SendSnrReport(EventType event_type, size_t frame_id, size_t symbol_id);
 
@@ -148,7 +295,7 @@ class Agora {
   std::string GetFftQueueSizesString() const {
     std::ostringstream ret;
     ret << "[";
-    for (size_t i = 0; i < kFrameWnd; i++) {
+    for (size_t i = 0; i < config_->FrameWnd(); i++) {
       ret << std::to_string(fft_queue_arr_[i].size()) << " ";
     }
     ret << "]";
@@ -159,7 +306,8 @@ class Agora {
   const size_t base_worker_core_offset_;
 
   Config* const config_;
-  size_t fft_created_count_;
+  // Per-frame count of FFT tasks created, indexed by frame_id % kFrameWnd
+  std::array<size_t, kFrameWnd> fft_created_counts_;
   size_t max_equaled_frame_ = SIZE_MAX;
   std::unique_ptr<PacketTXRX> packet_tx_rx_;
 
@@ -172,6 +320,48 @@ class Agora {
   std::unique_ptr<Stats> stats_;
   std::unique_ptr<PhyStats> phy_stats_;
 
+  // Streams live metrics snapshots over UDP for dashboards. Only allocated
+  // when the config sets a telemetry collector address.
+  std::unique_ptr<TelemetryReporter> telemetry_;
+
+  // A/B kernel harness: a spare worker re-runs sampled demul launches
+  // through both soft-demod kernel variants (shadow_bench config flag)
+  std::unique_ptr<ShadowBench> shadow_bench_;
+
+  // Ships uplink decode work to remote decode_worker processes. Only
+  // allocated when the config sets decode_offload.
+  std::unique_ptr<DecodeOffloadBridge> decode_offload_;
+
+#ifdef USE_GPU_DECODE
+  // Routes large-batch LDPC decode through a CUDA device. Only allocated
+  // when the config sets gpu_decode (see gpu_decode.h).
+  std::unique_ptr<GpuDecodeEngine> gpu_decode_;
+#endif
+
+  // Moves per-UE LLR slices between cooperating instances when the OFDM
+  // band is subcarrier-sharded. Only allocated when sc_shard_num > 1.
+  std::unique_ptr<ScShardBridge> sc_shard_;
+  // Shard owner only, per (frame slot, uplink symbol index): whether the
+  // local shard's demodulation has finished, and whether every remote
+  // shard's LLR slices have been merged. Decode is scheduled once both
+  // halves of a symbol are in place; both flags are cleared at that point.
+  std::array<std::array<bool, kMaxSymbols>, kFrameWnd> shard_demul_done_ = {};
+  std::array<std::array<bool, kMaxSymbols>, kFrameWnd> shard_llr_done_ = {};
+
+  // Publishes equalized symbols to a shared-memory window external
+  // visualizers map read-only. Only allocated when the config sets
+  // equal_export (see equal_export.h).
+  std::unique_ptr<EqualExport> equal_export_;
+
+  // Spools each completed frame's decoded bits and/or TX samples to disk
+  // off the critical path. Only allocated when the config sets
+  // frame_dump_decode or frame_dump_tx (see frame_dumper.h).
+  std::unique_ptr<FrameDumper> frame_dumper_;
+
+  // Soft-LLR store for HARQ retransmission combining, shared by all decode
+  // workers. Only allocated when the config enables harq_combining.
+  std::unique_ptr<HarqStore> harq_store_;
+
   /*****************************************************
    * Buffers
    *****************************************************/
@@ -208,7 +398,10 @@ class Agora {
   Table<complex_float> equal_buffer_;
 
   // Data after demodulation. Each buffer has kMaxModType * number of OFDM
-  // data subcarriers
+  // data subcarriers. The layout is the decoder's native channel-LLR stream
+  // (ModOrderBits int8 LLRs per subcarrier), so DoDecode consumes it in
+  // place; each buffer is padded so the decoder's 32-byte-wide reads of the
+  // last code block stay inside the allocation.
   PtrCube<kFrameWnd, kMaxSymbols, kMaxUEs, int8_t> demod_buffers_;
 
   // Data after LDPC decoding. Each buffer [decoded bytes per UE] bytes.
@@ -234,6 +427,52 @@ class Agora {
   size_t rc_last_frame_ = SIZE_MAX;
   size_t ifft_next_symbol_ = 0;
 
+  // Fused precode+IFFT mode: per-(frame slot, downlink symbol) count of
+  // completed precode blocks, shared with the DoPrecode workers so the one
+  // that finishes a symbol can run its IFFTs inline
+  std::unique_ptr<std::atomic<size_t>[]> fused_precode_task_counts_;
+
+  // Chained FFT->demul mode: per-(frame slot, uplink symbol) FFT
+  // completion counts and demul claim flags shared with the DoFFT
+  // workers, plus the beamformer-ready frame the master publishes on ZF
+  // completion. A symbol's demul is scheduled exactly once by whichever
+  // side claims its flag first: the worker that finished the symbol's
+  // last FFT (beamformer already ready), or the master (from the ZF
+  // completion fan-out or this FFT's completion event otherwise)
+  std::unique_ptr<std::atomic<size_t>[]> chained_fft_task_counts_;
+  std::unique_ptr<std::atomic<uint8_t>[]> chained_demul_claimed_;
+  std::atomic<size_t> chained_beam_ready_frame_ = SIZE_MAX;
+
+  // Per-UE smoothed CFO estimates (radians per sample), allocated only in
+  // cfo_correction mode and shared with every DoFFT instance: antenna 0's
+  // pilot task writes each UE's entry, all pilot tasks read it
+  std::unique_ptr<std::atomic<float>[]> cfo_phase_per_sample_;
+
+  // Block-gated demul state (zf_block_gated_demul), master-thread only:
+  // per-(frame slot, ZF block) completion flags, per-(frame slot, uplink
+  // symbol, demul block) released flags, and the frame each slot's flags
+  // currently describe. Flags are recycled when a new frame's first ZF
+  // block completes in the slot
+  std::vector<uint8_t> zf_block_done_;
+  std::vector<uint8_t> demul_block_released_;
+  std::array<size_t, kFrameWnd> zf_block_frame_;
+
+  // Partial-CSI ZF kickoff (zf_partial_csi_fraction < 1.0): ZF for a
+  // frame is scheduled once a fraction of its pilot FFTs are in, and
+  // runs once more with the full CSI if the stragglers make it before
+  // the frame leaves the processing window. The per-slot state machine
+  // keeps the refinement pass from re-firing the zf_counters_ completion
+  // actions (demul/precode scheduling) a second time
+  enum class ZfPartialState : uint8_t {
+    kIdle,            // No early kickoff for this slot's frame
+    kPartialInFlight, // ZF scheduled on a pilot subset, still draining
+    kPartialDone,     // Partial pass drained, full CSI not yet in
+    kRefinePending,   // Full CSI in while the partial pass was draining
+    kRefineInFlight   // Full-CSI refinement pass scheduled
+  };
+  std::array<size_t, kFrameWnd> zf_partial_frame_;
+  std::array<ZfPartialState, kFrameWnd> zf_partial_state_;
+
   // Agora schedules and processes a frame in FIFO order
   // cur_proc_frame_id is the frame that is currently being processed.
   // cur_sche_frame_id is the frame that is currently being scheduled.
@@ -242,6 +481,27 @@ class Agora {
   size_t cur_proc_frame_id_ = 0;
   size_t cur_sche_frame_id_ = 0;
 
+  // cur_proc_frame_id_ republished atomically for the RX threads, which
+  // use it as the slot-reuse watermark in frame-epoch packet reclamation
+  // (rx_epoch_reclaim). Stored once per completed frame
+  std::atomic<size_t> completed_frame_watermark_ = 0;
+
+  // A RAN reconfiguration from the MAC targeting a future frame. It is held
+  // here until that frame becomes the current processing frame, then applied
+  // in CheckFrameComplete() at the frame boundary so in-flight doers never
+  // see the modulation configuration change mid-frame.
+  RanConfig pending_ran_config_ = {};
+  bool ran_config_pending_ = false;
+
+  // Active uplink resource allocation at demul-block granularity (bit b =
+  // subcarrier block b carries scheduled uplink data), and the ZF blocks
+  // needed to cover it. UINT64_MAX is the canonical full-band value; both
+  // are only rewritten at a frame boundary (see ApplyUlBlockMask), so
+  // under low band occupancy ZF and demul are simply never scheduled for
+  // the unallocated blocks and compute scales with occupancy
+  uint64_t ul_block_mask_ = UINT64_MAX;
+  uint64_t zf_block_mask_ = UINT64_MAX;
+
   // The frame index for a symbol whose FFT is done
   std::vector<size_t> fft_cur_frame_for_symbol_;
   // The frame index for a symbol whose encode is done
@@ -266,6 +526,11 @@ class Agora {
   // [number of UEs] rows and [number of antennas] columns.
   PtrGrid<kFrameWnd, kMaxDataSCs, complex_float> dl_zf_matrices_;
 
+  // Per-(frame slot, subcarrier) flags set by DoZF when its near-static
+  // cache reused the previous frame's beamweights unchanged; DoPrecode
+  // reads them to reuse frame-invariant precoded output (downlink pilots)
+  Table<bool> dl_zf_unchanged_;
+
   // 1st dimension: kFrameWnd
   // 2nd dimension: number of OFDM data subcarriers * number of antennas
   Table<complex_float> calib_ul_buffer_;
@@ -305,6 +570,50 @@ class Agora {
   };
   SchedInfoT sched_info_arr_[kScheduleQueues][kNumEventTypes];
 
+  // Per-worker task queues used when work stealing is enabled. Each worker
+  // dequeues from its own queue first and steals from peers when empty.
+  SchedInfoT steal_info_arr_[kScheduleQueues][kMaxWorkerNum];
+  // Round-robin cursor for distributing tasks over the per-worker queues
+  size_t steal_rr_cursor_ = 0;
+
+  // Set by the master when the in-flight frame's downlink symbols are close
+  // to their TX deadline; workers then poll downlink queues first
+  std::atomic<bool> dl_urgent_ = {false};
+
+  // Antenna load-shedding controller state, owned by UpdateAntShed() on the
+  // master thread: whether shedding is engaged, and how many consecutive
+  // frames have finished under budget since it engaged
+  bool ant_shed_engaged_ = false;
+  size_t ant_shed_recover_streak_ = 0;
+
+  // Per-worker primary event type, written by the master at frame boundaries
+  // when adaptive scheduling is enabled and read by Worker(tid) to decide
+  // which task queue to poll first
+  std::array<std::atomic<size_t>, kMaxWorkerNum> worker_primary_event_;
+
+  /// Enqueue a worker-bound event, either to the per-doer-type shared queue
+  /// or, in work-stealing mode, to a per-worker queue in round-robin order
+  void EnqueueWorkerEvent(EventType event_type, size_t qid,
+                          const EventData& event);
+
+  // Per-frame bump arenas for worker scratch, one per in-flight frame slot.
+  // The master resets a frame's arena in CheckFrameComplete().
+  std::array<FrameArena, kScheduleQueues> frame_arenas_;
+
+  // Wakes the master out of its parked state when hybrid polling is enabled.
+  // Workers notify after enqueueing completion events.
+  QueueNotifier master_notifier_;
+
+  // Scheduling thread state (split_master): the master loop keeps draining
+  // completion queues and updating counters while a dedicated thread runs
+  // the ZF/demul/precode/decode/encode fan-out. Commands (an EventType plus
+  // a FrmSym tag) travel over a padded SPSC ring; the scheduling thread is
+  // then the sole user of those event types' producer tokens.
+  std::unique_ptr<CompletionRing> sched_ring_;
+  std::atomic<bool> sched_running_ = false;
+  size_t sched_core_ = 0;
+  std::thread sched_std_thread_;
+
   // Master thread's message queue for receiving packets
   moodycamel::ConcurrentQueue<EventData> message_queue_;
 
@@ -318,10 +627,16 @@ class Agora {
   moodycamel::ConcurrentQueue<EventData> complete_task_queue_[kScheduleQueues];
   moodycamel::ProducerToken* worker_ptoks_ptr_[kMaxThreads][kScheduleQueues];
 
+  // Per-worker SPSC completion rings, used instead of complete_task_queue_
+  // when Agora is built with USE_SPSC_COMPLETION
+  std::unique_ptr<CompletionRing[]> completion_rings_[kScheduleQueues];
+
   moodycamel::ProducerToken* rx_ptoks_ptr_[kMaxThreads];
   moodycamel::ProducerToken* tx_ptoks_ptr_[kMaxThreads];
 
-  uint8_t schedule_process_flags_;
+  // Per-frame-in-flight schedule completion flags, indexed by
+  // frame_id % kScheduleQueues
+  std::array<uint8_t, kScheduleQueues> schedule_process_flags_;
 
   std::queue<size_t> encode_deferral_;
 };
@@ -0,0 +1,60 @@
+/**
+ * @file completion_ring.h
+ * @brief Single-producer single-consumer ring for worker completion events.
+ * One worker thread pushes response events into its own ring and the master
+ * thread sweeps all rings, avoiding the CAS-heavy MPMC completion queue.
+ */
+#ifndef COMPLETION_RING_H_
+#define COMPLETION_RING_H_
+
+#include <atomic>
+#include <array>
+
+#include "buffer.h"
+#include "symbols.h"
+
+// Number of events each completion ring can hold. Must be a power of two so
+// that slot indexing reduces to a mask.
+static constexpr size_t kCompletionRingSize = 2048;
+static_assert(IsPowerOfTwo(kCompletionRingSize));
+
+class CompletionRing {
+ public:
+  CompletionRing() : head_(0), tail_(0) {}
+
+  // Disallow copy: each ring is owned by exactly one worker
+  CompletionRing(const CompletionRing&) = delete;
+  CompletionRing& operator=(const CompletionRing&) = delete;
+
+  /// Called by the owning worker thread only. Returns false if the ring is
+  /// full (the master has fallen behind).
+  bool TryPush(const EventData& event) {
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    if ((tail - head_.load(std::memory_order_acquire)) == kCompletionRingSize) {
+      return false;
+    }
+    slots_[tail & (kCompletionRingSize - 1)] = event;
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  /// Called by the master thread only. Returns false if the ring is empty.
+  bool TryPop(EventData& event) {
+    const size_t head = head_.load(std::memory_order_relaxed);
+    if (head == tail_.load(std::memory_order_acquire)) {
+      return false;
+    }
+    event = slots_[head & (kCompletionRingSize - 1)];
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+ private:
+  // Head (consumer) and tail (producer) indices live on separate cache lines
+  // to avoid false sharing between the master and the worker
+  alignas(64) std::atomic<size_t> head_;
+  alignas(64) std::atomic<size_t> tail_;
+  alignas(64) std::array<EventData, kCompletionRingSize> slots_;
+};
+
+#endif  // COMPLETION_RING_H_
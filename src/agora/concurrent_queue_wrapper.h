@@ -6,16 +6,167 @@
 #ifndef CONCURRENT_QUEUE_WRAPPER_H_
 #define CONCURRENT_QUEUE_WRAPPER_H_
 
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <string>
+
 #include "buffer.h"
 #include "concurrentqueue.h"
 #include "utils.h"
 
+/// Wakes a consumer that parks itself after repeated empty polls. Producers
+/// call Notify() after enqueueing; this is a single atomic load unless the
+/// consumer is actually parked, so the hot path stays lock-free. The
+/// condition variable is futex-backed on Linux.
+class QueueNotifier {
+ public:
+  void Notify() {
+    if (consumer_parked_.load(std::memory_order_acquire) == true) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      cond_.notify_one();
+    }
+  }
+
+  /// Park the consumer until Notify() is called or timeout_us elapses.
+  /// The timeout bounds the staleness from wakeups that race with parking
+  /// (and from producers, like packet RX, that do not carry a notifier).
+  void Park(size_t timeout_us) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    consumer_parked_.store(true, std::memory_order_release);
+    cond_.wait_for(lock, std::chrono::microseconds(timeout_us));
+    consumer_parked_.store(false, std::memory_order_release);
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  std::atomic<bool> consumer_parked_ = {false};
+};
+
+/// Optional congestion instrumentation over the task queues. Tracks two
+/// things per registered queue: the deepest size_approx() observation
+/// (sampled by the master at frame boundaries, with the frame it occurred
+/// in) and the number of times TryEnqueueFallback() had to fall back to a
+/// blocking enqueue, which previously vanished into an unattributed
+/// printf. Registration happens during single-threaded startup; fallback
+/// counts are atomics so any thread can record them. Off unless the
+/// config sets queue_stats, in which case the only hot-path cost is the
+/// enabled check on the fallback (already slow) path.
+class QueueMonitor {
+ public:
+  static constexpr size_t kMaxMonitoredQueues = 256;
+
+  static void Enable() { enabled_ = true; }
+  static bool IsEnabled() { return enabled_; }
+
+  /// Register a queue for monitoring. Called during startup only
+  static void Register(const std::string& name,
+                       const moodycamel::ConcurrentQueue<EventData>* queue) {
+    if ((enabled_ == false) || (num_queues_ >= kMaxMonitoredQueues)) {
+      return;
+    }
+    Entry& entry = entries_[num_queues_];
+    entry.name_ = name;
+    entry.queue_ = queue;
+    num_queues_++;
+  }
+
+  /// Count one blocking fallback enqueue on queue. Fallback path only
+  static void RecordFallback(
+      const moodycamel::ConcurrentQueue<EventData>* queue) {
+    if (enabled_ == false) {
+      return;
+    }
+    for (size_t i = 0; i < num_queues_; i++) {
+      if (entries_[i].queue_ == queue) {
+        entries_[i].fallback_retries_.fetch_add(1, std::memory_order_relaxed);
+        return;
+      }
+    }
+    unregistered_fallbacks_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  /// Sample every registered queue's approximate depth and keep the
+  /// deepest observation. Called by the master once per completed frame
+  static void SampleDepths(size_t frame_id) {
+    if (enabled_ == false) {
+      return;
+    }
+    for (size_t i = 0; i < num_queues_; i++) {
+      Entry& entry = entries_[i];
+      const size_t depth = entry.queue_->size_approx();
+      if (depth > entry.depth_high_watermark_) {
+        entry.depth_high_watermark_ = depth;
+        entry.watermark_frame_ = frame_id;
+      }
+    }
+  }
+
+  /// Print every monitored queue that ever held an event or forced a
+  /// fallback enqueue
+  static void PrintReport() {
+    if (enabled_ == false) {
+      return;
+    }
+    std::printf("QueueMonitor: congestion report over %zu queues\n",
+                num_queues_);
+    for (size_t i = 0; i < num_queues_; i++) {
+      const Entry& entry = entries_[i];
+      const size_t retries =
+          entry.fallback_retries_.load(std::memory_order_relaxed);
+      if ((entry.depth_high_watermark_ == 0) && (retries == 0)) {
+        continue;
+      }
+      std::printf(
+          "  %s: depth high watermark %zu (frame %zu), fallback enqueues "
+          "%zu\n",
+          entry.name_.c_str(), entry.depth_high_watermark_,
+          entry.watermark_frame_, retries);
+    }
+    const size_t unregistered =
+        unregistered_fallbacks_.load(std::memory_order_relaxed);
+    if (unregistered > 0) {
+      std::printf("  (unregistered queues): fallback enqueues %zu\n",
+                  unregistered);
+    }
+  }
+
+ private:
+  struct Entry {
+    // Explicit constructor instead of default member initializers: gcc
+    // refuses to instantiate std::array<Entry, N> for the inline static
+    // member below while the enclosing class is still open if Entry
+    // carries NSDMIs
+    Entry()
+        : queue_(nullptr),
+          depth_high_watermark_(0),
+          watermark_frame_(0),
+          fallback_retries_(0) {}
+
+    std::string name_;
+    const moodycamel::ConcurrentQueue<EventData>* queue_;
+    size_t depth_high_watermark_;
+    size_t watermark_frame_;
+    std::atomic<size_t> fallback_retries_;
+  };
+
+  static inline std::array<Entry, kMaxMonitoredQueues> entries_;
+  static inline size_t num_queues_ = 0;
+  static inline std::atomic<size_t> unregistered_fallbacks_ = {0};
+  static inline bool enabled_ = false;
+};
+
 /// Enqueue one event to a concurrent queue and print a warning message
 /// if we're short on queue space
 static inline void TryEnqueueFallback(
     moodycamel::ConcurrentQueue<EventData>* mc_queue,
     moodycamel::ProducerToken* producer_token, const EventData& event) {
   if (!mc_queue->try_enqueue(*producer_token, event)) {
+    QueueMonitor::RecordFallback(mc_queue);
     std::printf("Need more memory\n");
     RtAssert(mc_queue->enqueue(*producer_token, event),
              "Message enqueue failed");
@@ -27,6 +178,7 @@ static inline void TryEnqueueFallback(
 static inline void TryEnqueueFallback(
     moodycamel::ConcurrentQueue<EventData>* mc_queue, const EventData& event) {
   if (!mc_queue->try_enqueue(event)) {
+    QueueMonitor::RecordFallback(mc_queue);
     std::printf("Need more memory\n");
     RtAssert(mc_queue->enqueue(event), "Message enqueue failed");
   }
@@ -39,6 +191,7 @@ static inline void TryEnqueueBulkFallback(
     moodycamel::ProducerToken* producer_token, const EventData* event_list,
     size_t num_events) {
   if (!mc_queue->try_enqueue_bulk(*producer_token, event_list, num_events)) {
+    QueueMonitor::RecordFallback(mc_queue);
     std::printf("Need more memory\n");
     RtAssert(mc_queue->enqueue_bulk(*producer_token, event_list, num_events),
              "Message bulk enqueue failed\n");
@@ -0,0 +1,131 @@
+/**
+ * @file decode_offload.cc
+ * @brief Implementation of the decode offload bridge (see decode_offload.h)
+ */
+#include "decode_offload.h"
+
+#include <cstring>
+
+#include "gettime.h"
+#include "logger.h"
+#include "utils.h"
+
+// Largest UDP payload the bridge will put on the wire; one LLR slice and
+// one decoded block must each fit in a single datagram
+static constexpr size_t kMaxWireBytes = 65000;
+
+DecodeOffloadBridge::DecodeOffloadBridge(
+    Config* cfg, size_t core_offset,
+    PtrCube<kFrameWnd, kMaxSymbols, kMaxUEs, int8_t>& demod_buffers,
+    PtrCube<kFrameWnd, kMaxSymbols, kMaxUEs, int8_t>& decoded_buffers,
+    moodycamel::ConcurrentQueue<EventData>* complete_queues,
+    size_t num_complete_queues, QueueNotifier* master_notifier)
+    : cfg_(cfg),
+      core_offset_(core_offset),
+      llr_slice_bytes_((cfg->ModOrderBits() *
+                        cfg->LdpcConfig().NumCbCodewLen()) /
+                       (cfg->Llr4Bit() ? 2 : 1)),
+      decoded_cb_bytes_(cfg->NumBytesPerCb()),
+      demod_buffers_(demod_buffers),
+      decoded_buffers_(decoded_buffers),
+      complete_queues_(complete_queues),
+      num_complete_queues_(num_complete_queues),
+      master_notifier_(master_notifier),
+      udp_server_(cfg->DecodeOffloadLocalPort()) {
+  RtAssert((sizeof(DecodeOffloadHdr) + llr_slice_bytes_) <= kMaxWireBytes,
+           "DecodeOffloadBridge: LLR slice does not fit in one datagram");
+  RtAssert((sizeof(DecodeOffloadHdr) + decoded_cb_bytes_) <= kMaxWireBytes,
+           "DecodeOffloadBridge: decoded block does not fit in one datagram");
+  std::printf(
+      "DecodeOffloadBridge: shipping decode to %s ports %zu-%zu, decoded "
+      "bits return to port %zu\n",
+      cfg->DecodeOffloadRemoteAddr().c_str(), cfg->DecodeOffloadRemotePort(),
+      cfg->DecodeOffloadRemotePort() + cfg->DecodeOffloadThreadNum() - 1,
+      cfg->DecodeOffloadLocalPort());
+  thread_ = std::thread(&DecodeOffloadBridge::RunLoop, this);
+}
+
+DecodeOffloadBridge::~DecodeOffloadBridge() {
+  running_ = false;
+  if (thread_.joinable() == true) {
+    thread_.join();
+  }
+}
+
+void DecodeOffloadBridge::RunLoop() {
+  PinToCoreWithOffset(ThreadType::kWorkerTXRX, core_offset_, 0);
+  const LDPCconfig& ldpc_config = cfg_->LdpcConfig();
+  std::vector<uint8_t> rx_buf(kMaxWireBytes);
+
+  while (running_.load(std::memory_order_relaxed) == true) {
+    bool did_work = false;
+
+    // Request side: serialize every code block of a dequeued event
+    EventData req_event;
+    if (request_queue_.try_dequeue(req_event) == true) {
+      did_work = true;
+      for (size_t i = 0; i < req_event.num_tags_; i++) {
+        const gen_tag_t tag(req_event.tags_[i]);
+        const size_t symbol_idx_ul =
+            cfg_->Frame().GetULSymbolIdx(tag.symbol_id_);
+        const size_t cur_cb_id =
+            (tag.cb_id_ % ldpc_config.NumBlocksInSymbol());
+        const size_t ue_id = (tag.cb_id_ / ldpc_config.NumBlocksInSymbol());
+        const int8_t* llr_ptr =
+            demod_buffers_[cfg_->FrameSlot(tag.frame_id_)][symbol_idx_ul]
+                          [ue_id] +
+            (cur_cb_id * llr_slice_bytes_);
+
+        DecodeOffloadHdr hdr;
+        hdr.magic_ = DecodeOffloadHdr::kMagic;
+        hdr.payload_bytes_ = llr_slice_bytes_;
+        hdr.tag_ = req_event.tags_[i];
+        const uint16_t port = static_cast<uint16_t>(
+            cfg_->DecodeOffloadRemotePort() +
+            (next_remote_ % cfg_->DecodeOffloadThreadNum()));
+        next_remote_++;
+        udp_client_.Send(cfg_->DecodeOffloadRemoteAddr(), port,
+                         reinterpret_cast<const uint8_t*>(&hdr), sizeof(hdr),
+                         reinterpret_cast<const uint8_t*>(llr_ptr),
+                         llr_slice_bytes_);
+      }
+    }
+
+    // Response side: decoded bytes land in the same decoded-buffer slot a
+    // local DoDecode worker would have written, then the completion event
+    // takes the normal path through the master's counters
+    const ssize_t ret = udp_server_.Recv(rx_buf.data(), rx_buf.size());
+    if (ret > 0) {
+      did_work = true;
+      if ((static_cast<size_t>(ret) <
+           (sizeof(DecodeOffloadHdr) + decoded_cb_bytes_))) {
+        MLPD_WARN("DecodeOffloadBridge: runt response (%zd bytes)\n", ret);
+        continue;
+      }
+      const auto* hdr = reinterpret_cast<const DecodeOffloadHdr*>(rx_buf.data());
+      if ((hdr->magic_ != DecodeOffloadHdr::kMagic) ||
+          (hdr->payload_bytes_ != decoded_cb_bytes_)) {
+        MLPD_WARN("DecodeOffloadBridge: malformed response dropped\n");
+        continue;
+      }
+      const gen_tag_t tag(hdr->tag_);
+      const size_t symbol_idx_ul = cfg_->Frame().GetULSymbolIdx(tag.symbol_id_);
+      const size_t cur_cb_id = (tag.cb_id_ % ldpc_config.NumBlocksInSymbol());
+      const size_t ue_id = (tag.cb_id_ / ldpc_config.NumBlocksInSymbol());
+      uint8_t* decoded_ptr = reinterpret_cast<uint8_t*>(
+          decoded_buffers_[cfg_->FrameSlot(tag.frame_id_)][symbol_idx_ul]
+                          [ue_id] +
+          (cur_cb_id * Roundup<64>(decoded_cb_bytes_)));
+      std::memcpy(decoded_ptr, rx_buf.data() + sizeof(DecodeOffloadHdr),
+                  decoded_cb_bytes_);
+
+      TryEnqueueFallback(&complete_queues_[tag.frame_id_ % num_complete_queues_],
+                         EventData(EventType::kDecode, hdr->tag_));
+      master_notifier_->Notify();
+    }
+
+    if (did_work == false) {
+      GetTime::SpinPause();
+    }
+  }
+}
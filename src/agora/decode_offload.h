@@ -0,0 +1,85 @@
+/**
+ * @file decode_offload.h
+ * @brief Declarations for the decode offload tier: the bridge thread that
+ * ships demodulated LLR blocks to remote decode_worker processes and feeds
+ * the decoded bits back into the master's completion path
+ */
+#ifndef DECODE_OFFLOAD_H_
+#define DECODE_OFFLOAD_H_
+
+#include <atomic>
+#include <thread>
+
+#include "buffer.h"
+#include "concurrent_queue_wrapper.h"
+#include "concurrentqueue.h"
+#include "config.h"
+#include "memory_manage.h"
+#include "udp_client.h"
+#include "udp_server.h"
+
+/// Wire header shared by requests (header + LLR payload) and responses
+/// (header + decoded bytes). The tag is the same gen_tag_t::FrmSymCb value
+/// the local decode path would carry, so work units keep their global
+/// names across the process boundary.
+struct DecodeOffloadHdr {
+  static constexpr uint32_t kMagic = 0x4f43444cu;  // "LDCO"
+  uint32_t magic_;
+  uint32_t payload_bytes_;
+  uint64_t tag_;
+} __attribute__((packed));
+
+/**
+ * @brief Ships kDecode work to remote decode_worker processes.
+ *
+ * When decode_offload is set, the master routes the per-codeblock decode
+ * events here instead of the worker queues. One bridge thread serializes
+ * each code block's LLR slice from demod_buffers_ over UDP to the helper
+ * (round-robin across its decode_offload_thread_num ports), receives the
+ * decoded bytes back, copies them into the decoded buffer, and enqueues
+ * the same single-tag kDecode completion event a local worker would have
+ * produced. The master's counters and MAC handoff are untouched.
+ */
+class DecodeOffloadBridge {
+ public:
+  DecodeOffloadBridge(
+      Config* cfg, size_t core_offset,
+      PtrCube<kFrameWnd, kMaxSymbols, kMaxUEs, int8_t>& demod_buffers,
+      PtrCube<kFrameWnd, kMaxSymbols, kMaxUEs, int8_t>& decoded_buffers,
+      moodycamel::ConcurrentQueue<EventData>* complete_queues,
+      size_t num_complete_queues, QueueNotifier* master_notifier);
+  ~DecodeOffloadBridge();
+
+  /// Accept one (possibly multi-tag) decode request event from the master.
+  /// Called only from the master thread.
+  void Offload(const EventData& event) { request_queue_.enqueue(event); }
+
+ private:
+  void RunLoop();
+
+  Config* const cfg_;
+  const size_t core_offset_;
+  // Bytes of one code block's LLR slice in demod_buffers_ (halved in the
+  // 4-bit packed LLR mode) and of one decoded code block
+  const size_t llr_slice_bytes_;
+  const size_t decoded_cb_bytes_;
+
+  PtrCube<kFrameWnd, kMaxSymbols, kMaxUEs, int8_t>& demod_buffers_;
+  PtrCube<kFrameWnd, kMaxSymbols, kMaxUEs, int8_t>& decoded_buffers_;
+  moodycamel::ConcurrentQueue<EventData>* const complete_queues_;
+  // Completion queue count (Agora::kScheduleQueues); completions go to
+  // queue frame_id % num_complete_queues_ like any worker's
+  const size_t num_complete_queues_;
+  QueueNotifier* const master_notifier_;
+
+  moodycamel::ConcurrentQueue<EventData> request_queue_;
+  UDPClient udp_client_;
+  UDPServer udp_server_;
+  // Next helper port index for round-robin request spreading
+  size_t next_remote_ = 0;
+
+  std::atomic<bool> running_ = true;
+  std::thread thread_;
+};
+
+#endif  // DECODE_OFFLOAD_H_
@@ -0,0 +1,163 @@
+/**
+ * @file decode_offload_worker.cc
+ * @brief Standalone decode helper process for the decode offload tier.
+ *
+ * Runs decode_offload_thread_num LDPC decode threads, each listening on
+ * decode_offload_remote_port + tid for LLR packets from a
+ * DecodeOffloadBridge, and returns the decoded bytes to the Agora
+ * process's decode_offload_local_port. The helper loads the same
+ * tddconfig JSON as the base station so both sides agree on the LDPC
+ * parameters and slice sizes.
+ */
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "config.h"
+#include "decode_offload.h"
+#include "gettime.h"
+#include "gflags/gflags.h"
+#include "memory_manage.h"
+#include "phy_ldpc_decoder_5gnr.h"
+#include "scrambler.h"
+#include "signal_handler.h"
+#include "udp_client.h"
+#include "udp_server.h"
+#include "utils.h"
+#include "utils_ldpc.h"
+#include "version_config.h"
+
+DEFINE_string(conf_file,
+              TOSTRING(PROJECT_DIRECTORY) "/data/tddconfig-sim-ul.json",
+              "Config filename (must match the Agora process's config)");
+DEFINE_uint64(core_offset, 0, "First core for the decode threads");
+
+static constexpr size_t kVarNodesSize = 1024 * 1024 * sizeof(int16_t);
+static constexpr size_t kMaxWireBytes = 65000;
+
+/// One decode thread: receive LLR packets on port_base + tid, decode, and
+/// return the bytes to the bridge. Mirrors DoDecode::LaunchBatch() minus
+/// the buffer indexing, PHY stats, and HARQ combining, which stay with
+/// the Agora process.
+static void DecodeLoop(Config* cfg, size_t core_offset, size_t tid) {
+  PinToCoreWithOffset(ThreadType::kWorker, core_offset, tid);
+  const LDPCconfig& ldpc_config = cfg->LdpcConfig();
+  const size_t llr_slice_bytes =
+      (cfg->ModOrderBits() * ldpc_config.NumCbCodewLen()) /
+      (cfg->Llr4Bit() ? 2 : 1);
+  const size_t decoded_cb_bytes = cfg->NumBytesPerCb();
+
+  UDPServer udp_server(cfg->DecodeOffloadRemotePort() + tid);
+  UDPClient udp_client;
+  AgoraScrambler::Scrambler scrambler;
+
+  auto* resp_var_nodes = static_cast<int16_t*>(Agora_memory::PaddedAlignedAlloc(
+      Agora_memory::Alignment_t::kAlign64, kVarNodesSize));
+  auto* llr_buffer = static_cast<int8_t*>(Agora_memory::PaddedAlignedAlloc(
+      Agora_memory::Alignment_t::kAlign64,
+      Roundup<64>(ldpc_config.NumCbCodewLen()) +
+          kLdpcHelperFunctionInputBufferSizePaddingBytes));
+  auto* decoded_buffer = static_cast<uint8_t*>(Agora_memory::PaddedAlignedAlloc(
+      Agora_memory::Alignment_t::kAlign64, Roundup<64>(decoded_cb_bytes)));
+  std::vector<uint8_t> rx_buf(kMaxWireBytes);
+
+  // The LDPC parameters are fixed by the config, so one request/response
+  // setup serves every packet
+  struct bblib_ldpc_decoder_5gnr_request ldpc_request {};
+  struct bblib_ldpc_decoder_5gnr_response ldpc_response {};
+  ldpc_request.numChannelLlrs = ldpc_config.NumCbCodewLen();
+  ldpc_request.numFillerBits = 0;
+  ldpc_request.maxIterations = ldpc_config.MaxDecoderIter();
+  ldpc_request.enableEarlyTermination = ldpc_config.EarlyTermination();
+  ldpc_request.Zc = ldpc_config.ExpansionFactor();
+  ldpc_request.baseGraph = ldpc_config.BaseGraph();
+  ldpc_request.nRows = ldpc_config.NumRows();
+  ldpc_response.numMsgBits = ldpc_config.NumCbLen();
+  ldpc_response.varNodes = resp_var_nodes;
+
+  size_t num_decoded = 0;
+  while (SignalHandler::GotExitSignal() == false) {
+    const ssize_t ret = udp_server.Recv(rx_buf.data(), rx_buf.size());
+    if (ret <= 0) {
+      GetTime::SpinPause();
+      continue;
+    }
+    if (static_cast<size_t>(ret) !=
+        (sizeof(DecodeOffloadHdr) + llr_slice_bytes)) {
+      std::fprintf(stderr, "decode_worker %zu: runt request (%zd bytes)\n",
+                   tid, ret);
+      continue;
+    }
+    const auto* hdr = reinterpret_cast<const DecodeOffloadHdr*>(rx_buf.data());
+    if ((hdr->magic_ != DecodeOffloadHdr::kMagic) ||
+        (hdr->payload_bytes_ != llr_slice_bytes)) {
+      std::fprintf(stderr, "decode_worker %zu: malformed request dropped\n",
+                   tid);
+      continue;
+    }
+
+    const auto* llr_wire =
+        reinterpret_cast<const int8_t*>(rx_buf.data() + sizeof(DecodeOffloadHdr));
+    if (cfg->Llr4Bit() == true) {
+      UnpackLlrsFrom4Bit(llr_wire, llr_buffer,
+                         ldpc_config.NumCbCodewLen() +
+                             (ldpc_config.NumCbCodewLen() & 1));
+      ldpc_request.varNodes = llr_buffer;
+    } else {
+      std::memcpy(llr_buffer, llr_wire, llr_slice_bytes);
+      ldpc_request.varNodes = llr_buffer;
+    }
+    ldpc_response.compactedMessageBytes = decoded_buffer;
+    bblib_ldpc_decoder_5gnr(&ldpc_request, &ldpc_response);
+    if (cfg->ScrambleEnabled()) {
+      scrambler.Descramble(decoded_buffer, decoded_cb_bytes);
+    }
+
+    DecodeOffloadHdr resp_hdr;
+    resp_hdr.magic_ = DecodeOffloadHdr::kMagic;
+    resp_hdr.payload_bytes_ = decoded_cb_bytes;
+    resp_hdr.tag_ = hdr->tag_;
+    udp_client.Send(cfg->BsServerAddr(), cfg->DecodeOffloadLocalPort(),
+                    reinterpret_cast<const uint8_t*>(&resp_hdr),
+                    sizeof(resp_hdr), decoded_buffer, decoded_cb_bytes);
+    num_decoded++;
+  }
+
+  std::printf("decode_worker %zu: decoded %zu code blocks\n", tid,
+              num_decoded);
+  std::free(resp_var_nodes);
+  std::free(llr_buffer);
+  std::free(decoded_buffer);
+}
+
+int main(int argc, char* argv[]) {
+  gflags::SetUsageMessage("conf_file : set the configuration filename");
+  gflags::SetVersionString(GetAgoraProjectVersion());
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+
+  std::unique_ptr<Config> cfg = std::make_unique<Config>(FLAGS_conf_file.c_str());
+
+  int ret;
+  try {
+    SignalHandler signal_handler;
+    signal_handler.SetupSignalHandlers();
+
+    std::printf("decode_worker: %zu decode threads on ports %zu-%zu\n",
+                cfg->DecodeOffloadThreadNum(), cfg->DecodeOffloadRemotePort(),
+                cfg->DecodeOffloadRemotePort() + cfg->DecodeOffloadThreadNum() -
+                    1);
+    std::vector<std::thread> threads;
+    for (size_t tid = 0; tid < cfg->DecodeOffloadThreadNum(); tid++) {
+      threads.emplace_back(DecodeLoop, cfg.get(), FLAGS_core_offset, tid);
+    }
+    for (auto& t : threads) {
+      t.join();
+    }
+    ret = EXIT_SUCCESS;
+  } catch (SignalException& e) {
+    std::cerr << "SignalException: " << e.what() << std::endl;
+    ret = EXIT_FAILURE;
+  }
+  gflags::ShutDownCommandLineFlags();
+  return ret;
+}
@@ -5,6 +5,9 @@
  */
 #include "dodecode.h"
 
+#include <array>
+#include <cmath>
+
 #include "concurrent_queue_wrapper.h"
 #include "phy_ldpc_decoder_5gnr.h"
 
@@ -13,47 +16,103 @@ static constexpr bool kPrintDecodedData = false;
 
 static constexpr size_t kVarNodesSize = 1024 * 1024 * sizeof(int16_t);
 
+// Adaptive iteration budget: UEs at or above the strong threshold decode
+// with the floor budget, UEs at or below the weak threshold keep the
+// configured maximum (EVM SNR, dB)
+static constexpr float kAdaptIterSnrStrong = 25.0f;
+static constexpr float kAdaptIterSnrWeak = 10.0f;
+static constexpr int16_t kAdaptIterMin = 2;
+
 DoDecode::DoDecode(
     Config* in_config, int in_tid,
     PtrCube<kFrameWnd, kMaxSymbols, kMaxUEs, int8_t>& demod_buffers,
     PtrCube<kFrameWnd, kMaxSymbols, kMaxUEs, int8_t>& decoded_buffers,
-    PhyStats* in_phy_stats, Stats* in_stats_manager)
+    HarqStore* in_harq_store, PhyStats* in_phy_stats, Stats* in_stats_manager)
     : Doer(in_config, in_tid),
       demod_buffers_(demod_buffers),
       decoded_buffers_(decoded_buffers),
+      harq_store_(in_harq_store),
       phy_stats_(in_phy_stats),
-      scrambler_(std::make_unique<AgoraScrambler::Scrambler>()) {
+      scrambler_(std::make_unique<AgoraScrambler::Scrambler>()),
+      crc_obj_(std::make_unique<DoCRC>()) {
   duration_stat_ = in_stats_manager->GetDurationStat(DoerType::kDecode, in_tid);
+  duration_hist_ = in_stats_manager->GetDurationHist(DoerType::kDecode, in_tid);
+  RegisterTaskStats(&duration_stat_, &duration_hist_);
   resp_var_nodes_ = static_cast<int16_t*>(Agora_memory::PaddedAlignedAlloc(
       Agora_memory::Alignment_t::kAlign64, kVarNodesSize));
+  llr_unpack_buffer_ = static_cast<int8_t*>(Agora_memory::PaddedAlignedAlloc(
+      Agora_memory::Alignment_t::kAlign64,
+      Roundup<64>(cfg_->LdpcConfig().NumCbCodewLen()) +
+          kLdpcHelperFunctionInputBufferSizePaddingBytes));
 }
 
-DoDecode::~DoDecode() { std::free(resp_var_nodes_); }
+DoDecode::~DoDecode() {
+  std::free(resp_var_nodes_);
+  std::free(llr_unpack_buffer_);
+}
 
 EventData DoDecode::Launch(size_t tag) {
+  return LaunchBatch(&tag, 1);
+}
+
+const void* DoDecode::InputAddr(size_t tag) {
+  const gen_tag_t t(tag);
+  const LDPCconfig& ldpc_config = cfg_->LdpcConfig();
+  const size_t cur_cb_id = (t.cb_id_ % ldpc_config.NumBlocksInSymbol());
+  const size_t ue_id = (t.cb_id_ / ldpc_config.NumBlocksInSymbol());
+  const size_t symbol_idx_ul = cfg_->Frame().GetULSymbolIdx(t.symbol_id_);
+  size_t llr_offset =
+      cfg_->ModOrderBits() * (ldpc_config.NumCbCodewLen() * cur_cb_id);
+  if (cfg_->Llr4Bit() == true) {
+    llr_offset /= 2;  // Packed nibbles sit at half the byte offset
+  }
+  return demod_buffers_[t.frame_id_ % cfg_->FrameWnd()][symbol_idx_ul][ue_id] +
+         llr_offset;
+}
+
+int16_t DoDecode::AdaptedMaxIterations(size_t ue_id, size_t ref_frame_id) {
+  const auto max_iter =
+      static_cast<int16_t>(cfg_->LdpcConfig().MaxDecoderIter());
+  if (max_iter <= kAdaptIterMin) {
+    return max_iter;
+  }
+  // The reference frame's EVM may still be partially accumulated when its
+  // decode overlaps this frame's; that only biases the SNR upward, which
+  // early termination already tolerates
+  const float snr = phy_stats_->GetEvmSnr(ref_frame_id, ue_id);
+  if (std::isfinite(snr) == false) {
+    return max_iter;
+  }
+  if (snr >= kAdaptIterSnrStrong) {
+    return kAdaptIterMin;
+  }
+  if (snr <= kAdaptIterSnrWeak) {
+    return max_iter;
+  }
+  const float weak_frac = (kAdaptIterSnrStrong - snr) /
+                          (kAdaptIterSnrStrong - kAdaptIterSnrWeak);
+  return static_cast<int16_t>(
+      kAdaptIterMin + std::lround(weak_frac * (max_iter - kAdaptIterMin)));
+}
+
+EventData DoDecode::LaunchBatch(const size_t* tags, size_t num_tags) {
   const LDPCconfig& ldpc_config = cfg_->LdpcConfig();
-  const size_t frame_id = gen_tag_t(tag).frame_id_;
-  const size_t symbol_id = gen_tag_t(tag).symbol_id_;
+  const size_t frame_id = gen_tag_t(tags[0]).frame_id_;
+  CheckFrameSlotOwner(frame_id);
+  const size_t symbol_id = gen_tag_t(tags[0]).symbol_id_;
   const size_t symbol_idx_ul = cfg_->Frame().GetULSymbolIdx(symbol_id);
-  const size_t cb_id = gen_tag_t(tag).cb_id_;
   const size_t symbol_offset =
       cfg_->GetTotalDataSymbolIdxUl(frame_id, symbol_idx_ul);
-  const size_t cur_cb_id = (cb_id % cfg_->LdpcConfig().NumBlocksInSymbol());
-  const size_t ue_id = (cb_id / cfg_->LdpcConfig().NumBlocksInSymbol());
-  const size_t frame_slot = (frame_id % kFrameWnd);
-  if (kDebugPrintInTask == true) {
-    std::printf(
-        "In doDecode thread %d: frame: %zu, symbol: %zu, code block: "
-        "%zu, ue: %zu offset %zu\n",
-        tid_, frame_id, symbol_id, cur_cb_id, ue_id, symbol_offset);
-  }
+  const size_t frame_slot = (frame_id % cfg_->FrameWnd());
 
   size_t start_tsc = GetTime::WorkerRdtsc();
 
+  // One decoder setup for the whole batch. Every code block of a symbol
+  // shares the same base graph, Zc, and rate, so only the per-block LLR
+  // and output pointers change between decoder calls.
   struct bblib_ldpc_decoder_5gnr_request ldpc_decoder_5gnr_request {};
   struct bblib_ldpc_decoder_5gnr_response ldpc_decoder_5gnr_response {};
 
-  // Decoder setup
   int16_t num_filler_bits = 0;
   int16_t num_channel_llrs = ldpc_config.NumCbCodewLen();
 
@@ -70,71 +129,185 @@ EventData DoDecode::Launch(size_t tag) {
   ldpc_decoder_5gnr_response.numMsgBits = num_msg_bits;
   ldpc_decoder_5gnr_response.varNodes = resp_var_nodes_;
 
-  int8_t* llr_buffer_ptr =
-      demod_buffers_[frame_slot][symbol_idx_ul][ue_id] +
-      (cfg_->ModOrderBits() * (ldpc_config.NumCbCodewLen() * cur_cb_id));
+  size_t start_tsc1 = GetTime::WorkerRdtsc();
+  duration_stat_->task_duration_[1] += start_tsc1 - start_tsc;
 
-  uint8_t* decoded_buffer_ptr =
-      (uint8_t*)decoded_buffers_[frame_slot][symbol_idx_ul][ue_id] +
-      (cur_cb_id * Roundup<64>(cfg_->NumBytesPerCb()));
+  for (size_t i = 0; i < num_tags; i++) {
+    if ((i + 1) < num_tags) {
+      // Pull the next code block's leading LLR cachelines in while this
+      // block decodes
+      PrefetchInput(tags[i + 1]);
+    }
+    const size_t cb_id = gen_tag_t(tags[i]).cb_id_;
+    const size_t cur_cb_id = (cb_id % ldpc_config.NumBlocksInSymbol());
+    const size_t ue_id = (cb_id / ldpc_config.NumBlocksInSymbol());
+    assert(gen_tag_t(tags[i]).frame_id_ == frame_id);
+    assert(gen_tag_t(tags[i]).symbol_id_ == symbol_id);
+    if (kDebugPrintInTask == true) {
+      std::printf(
+          "In doDecode thread %d: frame: %zu, symbol: %zu, code block: "
+          "%zu, ue: %zu offset %zu\n",
+          tid_, frame_id, symbol_id, cur_cb_id, ue_id, symbol_offset);
+    }
 
-  ldpc_decoder_5gnr_request.varNodes = llr_buffer_ptr;
-  ldpc_decoder_5gnr_response.compactedMessageBytes = decoded_buffer_ptr;
+    // The demodulator writes LLRs in the decoder's native stream order, so
+    // the decoder reads demod_buffers_ in place; no reshuffling pass exists
+    // between demodulation and decoding.
+    int8_t* llr_buffer_ptr =
+        demod_buffers_[frame_slot][symbol_idx_ul][ue_id] +
+        (cfg_->ModOrderBits() * (ldpc_config.NumCbCodewLen() * cur_cb_id));
+    if (cfg_->Llr4Bit() == true) {
+      // The demod buffer holds packed nibbles at half the byte offset;
+      // expand this block's slice to byte LLRs for the decoder
+      const int8_t* packed_ptr =
+          demod_buffers_[frame_slot][symbol_idx_ul][ue_id] +
+          ((cfg_->ModOrderBits() * (ldpc_config.NumCbCodewLen() * cur_cb_id)) /
+           2);
+      UnpackLlrsFrom4Bit(packed_ptr, llr_unpack_buffer_,
+                         ldpc_config.NumCbCodewLen() +
+                             (ldpc_config.NumCbCodewLen() & 1));
+      llr_buffer_ptr = llr_unpack_buffer_;
+    }
 
-  size_t start_tsc1 = GetTime::WorkerRdtsc();
-  duration_stat_->task_duration_[1] += start_tsc1 - start_tsc;
+    uint8_t* decoded_buffer_ptr =
+        (uint8_t*)decoded_buffers_[frame_slot][symbol_idx_ul][ue_id] +
+        (cur_cb_id * Roundup<64>(cfg_->NumBytesPerCb()));
 
-  bblib_ldpc_decoder_5gnr(&ldpc_decoder_5gnr_request,
-                          &ldpc_decoder_5gnr_response);
+    if ((cfg_->AdaptiveDecodeIter() == true) && (frame_id > 0)) {
+      // Strong UEs converge in a couple of iterations; spend the budget
+      // where the previous frame's SNR says it is needed
+      ldpc_decoder_5gnr_request.maxIterations =
+          AdaptedMaxIterations(ue_id, frame_id - 1);
+    }
 
-  if (cfg_->ScrambleEnabled()) {
-    scrambler_->Descramble(decoded_buffer_ptr, cfg_->NumBytesPerCb());
-  }
+    if (harq_store_ != nullptr) {
+      // If an earlier attempt at this (UE, symbol) pair failed, fold its
+      // held LLRs into this block's slice before decoding. Blocks of one
+      // symbol occupy disjoint slices, so concurrent workers don't collide.
+      const int8_t* held = harq_store_->Held(ue_id, symbol_idx_ul);
+      if (held != nullptr) {
+        const size_t slice_offset =
+            cfg_->ModOrderBits() * (ldpc_config.NumCbCodewLen() * cur_cb_id);
+        HarqStore::CombineLlrs(held + slice_offset, llr_buffer_ptr,
+                               ldpc_config.NumCbCodewLen());
+      }
+    }
 
-  size_t start_tsc2 = GetTime::WorkerRdtsc();
-  duration_stat_->task_duration_[2] += start_tsc2 - start_tsc1;
+    ldpc_decoder_5gnr_request.varNodes = llr_buffer_ptr;
+    ldpc_decoder_5gnr_response.compactedMessageBytes = decoded_buffer_ptr;
+
+    bblib_ldpc_decoder_5gnr(&ldpc_decoder_5gnr_request,
+                            &ldpc_decoder_5gnr_response);
 
-  if (kPrintLLRData) {
-    std::printf("LLR data, symbol_offset: %zu\n", symbol_offset);
-    for (size_t i = 0; i < ldpc_config.NumCbCodewLen(); i++) {
-      std::printf("%d ", *(llr_buffer_ptr + i));
+    if (cfg_->ScrambleEnabled()) {
+      scrambler_->Descramble(decoded_buffer_ptr, cfg_->NumBytesPerCb());
     }
-    std::printf("\n");
-  }
 
-  if (kPrintDecodedData) {
-    std::printf("Decoded data\n");
-    for (size_t i = 0; i < (ldpc_config.NumCbLen() >> 3); i++) {
-      std::printf("%u ", *(decoded_buffer_ptr + i));
+    if (kPrintLLRData) {
+      std::printf("LLR data, symbol_offset: %zu\n", symbol_offset);
+      for (size_t j = 0; j < ldpc_config.NumCbCodewLen(); j++) {
+        std::printf("%d ", *(llr_buffer_ptr + j));
+      }
+      std::printf("\n");
+    }
+
+    if (kPrintDecodedData) {
+      std::printf("Decoded data\n");
+      for (size_t j = 0; j < (ldpc_config.NumCbLen() >> 3); j++) {
+        std::printf("%u ", *(decoded_buffer_ptr + j));
+      }
+      std::printf("\n");
+    }
+
+    if ((kEnableMac == false) && (kPrintPhyStats == true) &&
+        (symbol_idx_ul >= cfg_->Frame().ClientUlPilotSymbols())) {
+      phy_stats_->UpdateDecodedBits(ue_id, symbol_offset,
+                                    cfg_->NumBytesPerCb() * 8);
+      phy_stats_->IncrementDecodedBlocks(ue_id, symbol_offset);
+      // With early termination enabled the decoder reports how many
+      // iterations it actually ran, which is the per-block compute cost.
+      phy_stats_->UpdateDecoderIterations(
+          ue_id, symbol_offset,
+          ldpc_decoder_5gnr_response.iterationAtTermination);
+      size_t block_error(0);
+      for (size_t j = 0; j < cfg_->NumBytesPerCb(); j++) {
+        uint8_t rx_byte = decoded_buffer_ptr[j];
+        auto tx_byte = static_cast<uint8_t>(cfg_->GetInfoBits(
+            cfg_->UlBits(), symbol_idx_ul, ue_id, cur_cb_id)[j]);
+        phy_stats_->UpdateBitErrors(ue_id, symbol_offset, tx_byte, rx_byte);
+        if (rx_byte != tx_byte) {
+          block_error++;
+        }
+      }
+      phy_stats_->UpdateBlockErrors(ue_id, symbol_offset, block_error);
     }
-    std::printf("\n");
   }
 
-  if ((kEnableMac == false) && (kPrintPhyStats == true) &&
+  // With the MAC attached, the reference-bit PHY stats above are
+  // unavailable; instead verify each fully decoded MAC packet's CRC here,
+  // while its bytes are still warm, so packet failures are visible at
+  // decode time instead of after the MAC-thread handoff
+  if ((kEnableMac == true) &&
       (symbol_idx_ul >= cfg_->Frame().ClientUlPilotSymbols())) {
-    phy_stats_->UpdateDecodedBits(ue_id, symbol_offset,
-                                  cfg_->NumBytesPerCb() * 8);
-    phy_stats_->IncrementDecodedBlocks(ue_id, symbol_offset);
-    size_t block_error(0);
-    for (size_t i = 0; i < cfg_->NumBytesPerCb(); i++) {
-      uint8_t rx_byte = decoded_buffer_ptr[i];
-      auto tx_byte = static_cast<uint8_t>(cfg_->GetInfoBits(
-          cfg_->UlBits(), symbol_idx_ul, ue_id, cur_cb_id)[i]);
-      phy_stats_->UpdateBitErrors(ue_id, symbol_offset, tx_byte, rx_byte);
-      if (rx_byte != tx_byte) {
-        block_error++;
+    const size_t blocks_in_symbol = ldpc_config.NumBlocksInSymbol();
+    std::array<size_t, kMaxUEs> blocks_seen{};
+    for (size_t i = 0; i < num_tags; i++) {
+      blocks_seen.at(gen_tag_t(tags[i]).cb_id_ / blocks_in_symbol)++;
+    }
+    for (size_t ue_id = 0; ue_id < cfg_->UeAntNum(); ue_id++) {
+      // Only check packets this event decoded in full; blocks split across
+      // events may still be in flight on other workers
+      if (blocks_seen.at(ue_id) == blocks_in_symbol) {
+        const auto* pkt = reinterpret_cast<const MacPacketPacked*>(
+            decoded_buffers_[frame_slot][symbol_idx_ul][ue_id]);
+        bool match = false;
+        if (static_cast<size_t>(pkt->PayloadLength()) <=
+            cfg_->MacPayloadMaxLength()) {
+          const auto crc = static_cast<uint16_t>(
+              crc_obj_->CalculateCrc24(pkt->Data(), pkt->PayloadLength()) &
+              0xFFFF);
+          match = (crc == pkt->Crc());
+        }
+        phy_stats_->UpdateMacCrcResult(ue_id, symbol_offset, match);
+        if (match == false) {
+          std::printf(
+              "DoDecode: MAC packet CRC failed, frame %zu symbol %zu ue "
+              "%zu\n",
+              frame_id, symbol_id, ue_id);
+        }
+        if (harq_store_ != nullptr) {
+          if (match == true) {
+            harq_store_->Release(ue_id, symbol_idx_ul);
+          } else {
+            // Hold the (already combined) LLRs of the failed symbol so the
+            // next frame's attempt at the same symbol index accumulates
+            // retransmission energy instead of starting over
+            harq_store_->Store(ue_id, symbol_idx_ul,
+                               demod_buffers_[frame_slot][symbol_idx_ul]
+                                             [ue_id]);
+          }
+        }
       }
     }
-    phy_stats_->UpdateBlockErrors(ue_id, symbol_offset, block_error);
   }
 
+  size_t start_tsc2 = GetTime::WorkerRdtsc();
+  duration_stat_->task_duration_[2] += start_tsc2 - start_tsc1;
+
   size_t duration = GetTime::WorkerRdtsc() - start_tsc;
   duration_stat_->task_duration_[0] += duration;
-  duration_stat_->task_count_++;
-  if (GetTime::CyclesToUs(duration, cfg_->FreqGhz()) > 500) {
+  duration_stat_->task_count_ += num_tags;
+  duration_hist_->Record(duration);
+  if (GetTime::CyclesToUs(duration, cfg_->FreqGhz()) > (500 * num_tags)) {
     std::printf("Thread %d Decode takes %.2f\n", tid_,
                 GetTime::CyclesToUs(duration, cfg_->FreqGhz()));
   }
 
-  return EventData(EventType::kDecode, tag);
+  EventData resp_event;
+  resp_event.num_tags_ = num_tags;
+  resp_event.event_type_ = EventType::kDecode;
+  for (size_t i = 0; i < num_tags; i++) {
+    resp_event.tags_[i] = tags[i];
+  }
+  return resp_event;
 }
@@ -10,7 +10,9 @@
 
 #include "buffer.h"
 #include "config.h"
+#include "crc.h"
 #include "doer.h"
+#include "harq_store.h"
 #include "memory_manage.h"
 #include "phy_stats.h"
 #include "scrambler.h"
@@ -21,18 +23,43 @@ class DoDecode : public Doer {
   DoDecode(Config* in_config, int in_tid,
            PtrCube<kFrameWnd, kMaxSymbols, kMaxUEs, int8_t>& demod_buffers,
            PtrCube<kFrameWnd, kMaxSymbols, kMaxUEs, int8_t>& decoded_buffers,
-           PhyStats* in_phy_stats, Stats* in_stats_manager);
+           HarqStore* in_harq_store, PhyStats* in_phy_stats,
+           Stats* in_stats_manager);
   ~DoDecode() override;
 
   EventData Launch(size_t tag) override;
 
+  /// Decode all code blocks of a request event with one decoder
+  /// request/response setup. Every block of a symbol shares the same LDPC
+  /// parameters (base graph, Zc, rate), so only the per-block LLR and
+  /// output pointers change between decoder calls.
+  EventData LaunchBatch(const size_t* tags, size_t num_tags) override;
+
+  /// Prefetch hint: the first LLR byte of tag's code block in
+  /// demod_buffers_
+  const void* InputAddr(size_t tag) override;
+
  private:
+  /// Per-UE LDPC iteration cap derived from the reference frame's EVM SNR:
+  /// strong UEs get the floor, cell-edge UEs the configured maximum, with
+  /// linear interpolation in between
+  int16_t AdaptedMaxIterations(size_t ue_id, size_t ref_frame_id);
+
   int16_t* resp_var_nodes_;
+  // Byte-LLR staging for the 4-bit packed LLR mode: one code block's
+  // nibbles are expanded here before the decoder runs
+  int8_t* llr_unpack_buffer_;
   PtrCube<kFrameWnd, kMaxSymbols, kMaxUEs, int8_t>& demod_buffers_;
   PtrCube<kFrameWnd, kMaxSymbols, kMaxUEs, int8_t>& decoded_buffers_;
+  // Retransmission combining store shared by all decode workers; nullptr
+  // when HARQ combining is disabled
+  HarqStore* harq_store_;
   PhyStats* phy_stats_;
   DurationStat* duration_stat_;
+  LatencyHistogram* duration_hist_;
   std::unique_ptr<AgoraScrambler::Scrambler> scrambler_;
+  // Verifies MAC packet CRCs at decode time, while the bytes are still hot
+  std::unique_ptr<DoCRC> crc_obj_;
 };
 
 #endif  // DODECODE_H_
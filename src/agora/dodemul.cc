@@ -4,6 +4,7 @@
  */
 #include "dodemul.h"
 
+#include "build_profile.h"
 #include "concurrent_queue_wrapper.h"
 
 static constexpr bool kUseSIMDGather = true;
@@ -14,28 +15,99 @@ DoDemul::DoDemul(
     Table<complex_float>& ue_spec_pilot_buffer,
     Table<complex_float>& equal_buffer,
     PtrCube<kFrameWnd, kMaxSymbols, kMaxUEs, int8_t>& demod_buffers,
-    PhyStats* in_phy_stats, Stats* stats_manager)
+    PtrCube<kFrameWnd, kMaxSymbols, kMaxUEs, int8_t>& decoded_buffers,
+    PhyStats* in_phy_stats, Stats* stats_manager, bool alt_kernel)
     : Doer(config, tid),
       data_buffer_(data_buffer),
       ul_zf_matrices_(ul_zf_matrices),
       ue_spec_pilot_buffer_(ue_spec_pilot_buffer),
       equal_buffer_(equal_buffer),
       demod_buffers_(demod_buffers),
+      decoded_buffers_(decoded_buffers),
       phy_stats_(in_phy_stats) {
   duration_stat_ = stats_manager->GetDurationStat(DoerType::kDemul, tid);
+  duration_hist_ = stats_manager->GetDurationHist(DoerType::kDemul, tid);
+  RegisterTaskStats(&duration_stat_, &duration_hist_);
 
   data_gather_buffer_ =
       static_cast<complex_float*>(Agora_memory::PaddedAlignedAlloc(
           Agora_memory::Alignment_t::kAlign64,
           kSCsPerCacheline * kMaxAntennas * sizeof(complex_float)));
-  equaled_buffer_temp_ =
-      static_cast<complex_float*>(Agora_memory::PaddedAlignedAlloc(
-          Agora_memory::Alignment_t::kAlign64,
-          cfg_->DemulBlockSize() * kMaxUEs * sizeof(complex_float)));
+  // Sized for the largest batched launch (EventData::kMaxTags blocks)
   equaled_buffer_temp_transposed_ =
       static_cast<complex_float*>(Agora_memory::PaddedAlignedAlloc(
           Agora_memory::Alignment_t::kAlign64,
-          cfg_->DemulBlockSize() * kMaxUEs * sizeof(complex_float)));
+          EventData::kMaxTags * cfg_->DemulBlockSize() * kMaxUEs *
+              sizeof(complex_float)));
+  if (cfg_->SmallLinalgKernels() == true) {
+    equalize_cgemv_ =
+        small_linalg::SelectCgemv(cfg_->UeAntNum(), cfg_->BsAntNum());
+  }
+
+  // alt_kernel flips the planar/interleaved soft-demodulator choice
+  // relative to the config; the launch path keys off the allocation
+  const bool use_planar = (cfg_->DemulPlanar() != alt_kernel);
+  if ((use_planar == true) && (cfg_->HardDemod() == false)) {
+    equaled_planar_.Malloc(kMaxUEs,
+                           EventData::kMaxTags * cfg_->DemulBlockSize(),
+                           Agora_memory::Alignment_t::kAlign64);
+  }
+  hard_decision_buffer_ =
+      static_cast<uint8_t*>(Agora_memory::PaddedAlignedAlloc(
+          Agora_memory::Alignment_t::kAlign64,
+          EventData::kMaxTags * cfg_->DemulBlockSize() * sizeof(uint8_t)));
+  llr_soft_scratch_ = static_cast<int8_t*>(Agora_memory::PaddedAlignedAlloc(
+      Agora_memory::Alignment_t::kAlign64,
+      EventData::kMaxTags * cfg_->DemulBlockSize() * kMaxModType));
+
+  // Resolve the demodulator entry point for the configured modulation order
+  // once, here; the per-block switch it replaces was pure branch-prediction
+  // noise in the demul inner loop. Unsupported orders leave the pointer
+  // null (and warn once) so LaunchRange() skips demodulation, matching the
+  // old per-call behavior.
+  if (cfg_->HardDemod() == true) {
+    switch (cfg_->ModOrderBits()) {
+      case (CommsLib::kQaM16):
+        demod_hard_func_ = Demod16qamHardAvx2;
+        break;
+      case (CommsLib::kQaM64):
+        demod_hard_func_ = Demod64qamHardAvx2;
+        break;
+      default:
+        std::printf("Hard demodulation: modulation type %s not supported!\n",
+                    cfg_->Modulation().c_str());
+    }
+  } else if (use_planar == true) {
+    switch (cfg_->ModOrderBits()) {
+      case (CommsLib::kQpsk):
+        demod_soft_planar_func_ = DemodQpskSoftPlanar;
+        break;
+      case (CommsLib::kQaM16):
+        demod_soft_planar_func_ = Demod16qamSoftPlanarAvx2;
+        break;
+      case (CommsLib::kQaM64):
+        demod_soft_planar_func_ = Demod64qamSoftPlanarAvx2;
+        break;
+      default:
+        std::printf("Demodulation: modulation type %s not supported!\n",
+                    cfg_->Modulation().c_str());
+    }
+  } else {
+    switch (cfg_->ModOrderBits()) {
+      case (CommsLib::kQpsk):
+        demod_soft_func_ = DemodQpskSoftSse;
+        break;
+      case (CommsLib::kQaM16):
+        demod_soft_func_ = Demod16qamSoft;
+        break;
+      case (CommsLib::kQaM64):
+        demod_soft_func_ = Demod64qamSoft;
+        break;
+      default:
+        std::printf("Demodulation: modulation type %s not supported!\n",
+                    cfg_->Modulation().c_str());
+    }
+  }
 
   // phase offset calibration data
   auto* ue_pilot_ptr =
@@ -65,8 +137,10 @@ DoDemul::DoDemul(
 
 DoDemul::~DoDemul() {
   std::free(data_gather_buffer_);
-  std::free(equaled_buffer_temp_);
   std::free(equaled_buffer_temp_transposed_);
+  equaled_planar_.Free();
+  std::free(hard_decision_buffer_);
+  std::free(llr_soft_scratch_);
 
 #if USE_MKL_JIT
   mkl_jit_status_t status = mkl_jit_destroy(jitter_);
@@ -77,16 +151,79 @@ DoDemul::~DoDemul() {
 }
 
 EventData DoDemul::Launch(size_t tag) {
+  return LaunchRange(tag, cfg_->DemulBlockSize());
+}
+
+EventData DoDemul::LaunchBatch(const size_t* tags, size_t num_tags) {
+  EventData resp_event;
+  resp_event.num_tags_ = num_tags;
+  resp_event.event_type_ = EventType::kDemul;
+
+  size_t i = 0;
+  while (i < num_tags) {
+    const gen_tag_t first(tags[i]);
+    // Find the longest run of tags covering contiguous subcarrier blocks of
+    // the same symbol
+    size_t run = 1;
+    while ((i + run) < num_tags) {
+      const gen_tag_t next(tags[i + run]);
+      if ((next.frame_id_ != first.frame_id_) ||
+          (next.symbol_id_ != first.symbol_id_) ||
+          (next.sc_id_ != first.sc_id_ + (run * cfg_->DemulBlockSize()))) {
+        break;
+      }
+      run++;
+    }
+    if ((i + run) < num_tags) {
+      // Pull the next run's leading input cachelines in while this run's
+      // gather/equalize pass computes
+      PrefetchInput(tags[i + run]);
+    }
+    LaunchRange(tags[i], run * cfg_->DemulBlockSize());
+    for (size_t j = 0; j < run; j++) {
+      resp_event.tags_[i + j] = tags[i + j];
+    }
+    i += run;
+  }
+  return resp_event;
+}
+
+const void* DoDemul::InputAddr(size_t tag) {
+  const gen_tag_t t(tag);
+  const size_t symbol_idx_ul = cfg_->Frame().GetULSymbolIdx(t.symbol_id_);
+  const size_t total_data_symbol_idx_ul =
+      cfg_->GetTotalDataSymbolIdxUl(t.frame_id_, symbol_idx_ul);
+  // First element the gather pass loads (see LaunchRange): with partial
+  // transpose, the block base plus the subcarrier's offset inside it;
+  // otherwise antenna 0's row at the base subcarrier
+  const size_t offset =
+      kUsePartialTrans
+          ? (((t.sc_id_ / kTransposeBlockSize) *
+              (kTransposeBlockSize * cfg_->BsAntNum())) +
+             (t.sc_id_ % kTransposeBlockSize))
+          : t.sc_id_;
+  return &data_buffer_[total_data_symbol_idx_ul][offset];
+}
+
+EventData DoDemul::LaunchRange(size_t tag, size_t max_scs) {
   const size_t frame_id = gen_tag_t(tag).frame_id_;
+  CheckFrameSlotOwner(frame_id);
   const size_t symbol_id = gen_tag_t(tag).symbol_id_;
   const size_t base_sc_id = gen_tag_t(tag).sc_id_;
 
+  // With a build profile these are compile-time constants, so the gather,
+  // equalize and demodulate loops below get fixed trip counts and strides
+  const size_t bs_ant_num = BuildProfile::BsAntNum(cfg_->BsAntNum());
+  const size_t ue_ant_num = BuildProfile::UeAntNum(cfg_->UeAntNum());
+  const size_t ofdm_data_num = BuildProfile::OfdmDataNum(cfg_->OfdmDataNum());
+  const size_t mod_order_bits = BuildProfile::ModOrderBits(cfg_->ModOrderBits());
+
   const size_t symbol_idx_ul = this->cfg_->Frame().GetULSymbolIdx(symbol_id);
   const size_t total_data_symbol_idx_ul =
       cfg_->GetTotalDataSymbolIdxUl(frame_id, symbol_idx_ul);
   const complex_float* data_buf = data_buffer_[total_data_symbol_idx_ul];
 
-  const size_t frame_slot = frame_id % kFrameWnd;
+  const size_t frame_slot = frame_id % cfg_->FrameWnd();
   size_t start_tsc = GetTime::WorkerRdtsc();
 
   if (kDebugPrintInTask == true) {
@@ -97,8 +234,7 @@ EventData DoDemul::Launch(size_t tag) {
         total_data_symbol_idx_ul);
   }
 
-  size_t max_sc_ite =
-      std::min(cfg_->DemulBlockSize(), cfg_->OfdmDataNum() - base_sc_id);
+  size_t max_sc_ite = std::min(max_scs, ofdm_data_num - base_sc_id);
   assert(max_sc_ite % kSCsPerCacheline == 0);
   // Iterate through cache lines
   for (size_t i = 0; i < max_sc_ite; i += kSCsPerCacheline) {
@@ -112,7 +248,7 @@ EventData DoDemul::Launch(size_t tag) {
     // same partial transpose block.
     const size_t partial_transpose_block_base =
         ((base_sc_id + i) / kTransposeBlockSize) *
-        (kTransposeBlockSize * cfg_->BsAntNum());
+        (kTransposeBlockSize * bs_ant_num);
 
 #ifdef __AVX512F__
     static constexpr size_t kAntNumPerSimd = 8;
@@ -122,7 +258,7 @@ EventData DoDemul::Launch(size_t tag) {
 
     size_t ant_start = 0;
     if (kUseSIMDGather && kUsePartialTrans &&
-        (cfg_->BsAntNum() % kAntNumPerSimd) == 0) {
+        (bs_ant_num % kAntNumPerSimd) == 0) {
       // Gather data for all antennas and 8 subcarriers in the same cache
       // line, 1 subcarrier and 4 (AVX2) or 8 (AVX512) ants per iteration
       size_t cur_sc_offset =
@@ -139,18 +275,18 @@ EventData DoDemul::Launch(size_t tag) {
           kTransposeBlockSize * 10, kTransposeBlockSize * 10 + 1,
           kTransposeBlockSize * 12, kTransposeBlockSize * 12 + 1,
           kTransposeBlockSize * 14, kTransposeBlockSize * 14 + 1);
-      for (size_t ant_i = 0; ant_i < cfg_->BsAntNum();
+      for (size_t ant_i = 0; ant_i < bs_ant_num;
            ant_i += kAntNumPerSimd) {
         for (size_t j = 0; j < kSCsPerCacheline; j++) {
           __m512 data_rx = kTransposeBlockSize == 1
-                               ? _mm512_load_ps(&src[j * cfg_->BsAntNum() * 2])
+                               ? _mm512_load_ps(&src[j * bs_ant_num * 2])
                                : _mm512_i32gather_ps(index, &src[j * 2], 4);
 
-          assert((reinterpret_cast<size_t>(&dst[j * cfg_->BsAntNum() * 2]) %
+          assert((reinterpret_cast<size_t>(&dst[j * bs_ant_num * 2]) %
                   (kAntNumPerSimd * sizeof(float) * 2)) == 0);
-          assert((reinterpret_cast<size_t>(&src[j * cfg_->BsAntNum() * 2]) %
+          assert((reinterpret_cast<size_t>(&src[j * bs_ant_num * 2]) %
                   (kAntNumPerSimd * sizeof(float) * 2)) == 0);
-          _mm512_store_ps(&dst[j * cfg_->BsAntNum() * 2], data_rx);
+          _mm512_store_ps(&dst[j * bs_ant_num * 2], data_rx);
         }
         src += kAntNumPerSimd * kTransposeBlockSize * 2;
         dst += kAntNumPerSimd * 2;
@@ -160,88 +296,126 @@ EventData DoDemul::Launch(size_t tag) {
           0, 1, kTransposeBlockSize * 2, kTransposeBlockSize * 2 + 1,
           kTransposeBlockSize * 4, kTransposeBlockSize * 4 + 1,
           kTransposeBlockSize * 6, kTransposeBlockSize * 6 + 1);
-      for (size_t ant_i = 0; ant_i < cfg_->BsAntNum();
+      for (size_t ant_i = 0; ant_i < bs_ant_num;
            ant_i += kAntNumPerSimd) {
         for (size_t j = 0; j < kSCsPerCacheline; j++) {
           assert((reinterpret_cast<size_t>(&src[j * 2]) %
                   (kAntNumPerSimd * sizeof(float) * 2)) == 0);
-          assert((reinterpret_cast<size_t>(&dst[j * cfg_->BsAntNum() * 2]) %
+          assert((reinterpret_cast<size_t>(&dst[j * bs_ant_num * 2]) %
                   (kAntNumPerSimd * sizeof(float) * 2)) == 0);
           __m256 data_rx = _mm256_i32gather_ps(&src[j * 2], index, 4);
-          _mm256_store_ps(&dst[j * cfg_->BsAntNum() * 2], data_rx);
+          _mm256_store_ps(&dst[j * bs_ant_num * 2], data_rx);
         }
         src += kAntNumPerSimd * kTransposeBlockSize * 2;
         dst += kAntNumPerSimd * 2;
       }
 #endif
       // Set the remaining number of antennas for non-SIMD gather
-      ant_start = cfg_->BsAntNum() - (cfg_->BsAntNum() % kAntNumPerSimd);
+      ant_start = bs_ant_num - (bs_ant_num % kAntNumPerSimd);
     }
-    if (ant_start < cfg_->BsAntNum()) {
+    if (ant_start < bs_ant_num) {
       complex_float* dst = data_gather_buffer_ + ant_start;
       for (size_t j = 0; j < kSCsPerCacheline; j++) {
-        for (size_t ant_i = ant_start; ant_i < cfg_->BsAntNum(); ant_i++) {
+        for (size_t ant_i = ant_start; ant_i < bs_ant_num; ant_i++) {
           *dst++ =
               kUsePartialTrans
                   ? data_buf[partial_transpose_block_base +
                              (ant_i * kTransposeBlockSize) +
                              ((base_sc_id + i + j) % kTransposeBlockSize)]
-                  : data_buf[ant_i * cfg_->OfdmDataNum() + base_sc_id + i + j];
+                  : data_buf[ant_i * ofdm_data_num + base_sc_id + i + j];
         }
       }
     }
     duration_stat_->task_duration_[1] += GetTime::WorkerRdtsc() - start_tsc0;
 
     // Step 2: For each subcarrier, perform equalization by multiplying the
-    // subcarrier's data from each antenna with the subcarrier's precoder
+    // subcarrier's data from each antenna with the subcarrier's precoder.
+    // The equalized vector stays in a small per-subcarrier scratch and is
+    // scattered straight into the subcarrier-major per-UE rows that the
+    // demodulators consume, so the separate ue-major intermediate buffer
+    // and its transpose pass over memory are gone.
+    alignas(64) complex_float equaled_vecs[kSCsPerCacheline * kMaxUEs];
+    if (cfg_->DemulBatchedGemm()) {
+      // Equalize the whole cacheline with one grouped MKL batch-gemm call,
+      // amortizing the per-call dispatch overhead across the subcarriers.
+      // The precoder matrices live in separately-allocated PtrGrid slots,
+      // so the pointer-array batch interface is used rather than the
+      // strided one.
+      CBLAS_TRANSPOSE transa = CblasNoTrans;
+      CBLAS_TRANSPOSE transb = CblasNoTrans;
+      MKL_INT m = ue_ant_num;
+      MKL_INT n = 1;
+      MKL_INT k = bs_ant_num;
+      MKL_INT lda = ue_ant_num;
+      MKL_INT ldb = bs_ant_num;
+      MKL_INT ldc = ue_ant_num;
+      MKL_Complex8 alpha = {1, 0};
+      MKL_Complex8 beta = {0, 0};
+      MKL_INT group_size = kSCsPerCacheline;
+      const void* a_array[kSCsPerCacheline];
+      const void* b_array[kSCsPerCacheline];
+      void* c_array[kSCsPerCacheline];
+      for (size_t j = 0; j < kSCsPerCacheline; j++) {
+        a_array[j] =
+            ul_zf_matrices_.At(frame_slot, cfg_->GetZfScId(base_sc_id + i + j));
+        b_array[j] = &data_gather_buffer_[j * bs_ant_num];
+        c_array[j] = &equaled_vecs[j * ue_ant_num];
+      }
+      cblas_cgemm_batch(CblasColMajor, &transa, &transb, &m, &n, &k, &alpha,
+                        a_array, &lda, b_array, &ldb, &beta, c_array, &ldc, 1,
+                        &group_size);
+    }
     for (size_t j = 0; j < kSCsPerCacheline; j++) {
       const size_t cur_sc_id = base_sc_id + i + j;
 
-      arma::cx_float* equal_ptr = nullptr;
-      if (kExportConstellation) {
-        equal_ptr =
-            (arma::cx_float*)(&equal_buffer_[total_data_symbol_idx_ul]
-                                            [cur_sc_id * cfg_->UeAntNum()]);
-      } else {
-        equal_ptr =
-            (arma::cx_float*)(&equaled_buffer_temp_[(cur_sc_id - base_sc_id) *
-                                                    cfg_->UeAntNum()]);
-      }
-      arma::cx_fmat mat_equaled(equal_ptr, cfg_->UeAntNum(), 1, false);
+      complex_float* equaled_vec = &equaled_vecs[j * ue_ant_num];
+      auto* equal_ptr = reinterpret_cast<arma::cx_float*>(equaled_vec);
+      arma::cx_fmat mat_equaled(equal_ptr, ue_ant_num, 1, false);
 
       auto* data_ptr = reinterpret_cast<arma::cx_float*>(
-          &data_gather_buffer_[j * cfg_->BsAntNum()]);
+          &data_gather_buffer_[j * bs_ant_num]);
       // size_t start_tsc2 = worker_rdtsc();
       auto* ul_zf_ptr = reinterpret_cast<arma::cx_float*>(
-          ul_zf_matrices_[frame_slot][cfg_->GetZfScId(cur_sc_id)]);
+          ul_zf_matrices_.At(frame_slot, cfg_->GetZfScId(cur_sc_id)));
 
       size_t start_tsc2 = GetTime::WorkerRdtsc();
+      if (cfg_->DemulBatchedGemm() == false) {
+        if (equalize_cgemv_ != nullptr) {
+          // Fixed-shape kernel picked at construction: no per-call
+          // dispatch, no matrix-object setup
+          equalize_cgemv_(ue_ant_num, bs_ant_num,
+                          ul_zf_matrices_.At(frame_slot,
+                                             cfg_->GetZfScId(cur_sc_id)),
+                          &data_gather_buffer_[j * bs_ant_num], equaled_vec);
+        } else {
 #if USE_MKL_JIT
-      mkl_jit_cgemm_(jitter_, (MKL_Complex8*)ul_zf_ptr, (MKL_Complex8*)data_ptr,
-                     (MKL_Complex8*)equal_ptr);
+          mkl_jit_cgemm_(jitter_, (MKL_Complex8*)ul_zf_ptr,
+                         (MKL_Complex8*)data_ptr, (MKL_Complex8*)equal_ptr);
 #else
-      arma::cx_fmat mat_data(data_ptr, cfg_->BsAntNum(), 1, false);
+          arma::cx_fmat mat_data(data_ptr, bs_ant_num, 1, false);
 
-      arma::cx_fmat mat_ul_zf(ul_zf_ptr, cfg_->UeAntNum(), cfg_->BsAntNum(),
-                              false);
-      mat_equaled = mat_ul_zf * mat_data;
+          arma::cx_fmat mat_ul_zf(ul_zf_ptr, ue_ant_num, bs_ant_num,
+                                  false);
+          mat_equaled = mat_ul_zf * mat_data;
 #endif
+        }
+      }
 
       if (symbol_idx_ul <
           cfg_->Frame().ClientUlPilotSymbols()) {  // Calc new phase shift
         if (symbol_idx_ul == 0 && cur_sc_id == 0) {
           // Reset previous frame
           auto* phase_shift_ptr = reinterpret_cast<arma::cx_float*>(
-              ue_spec_pilot_buffer_[(frame_id - 1) % kFrameWnd]);
-          arma::cx_fmat mat_phase_shift(phase_shift_ptr, cfg_->UeAntNum(),
+              ue_spec_pilot_buffer_[(frame_id - 1) % cfg_->FrameWnd()]);
+          arma::cx_fmat mat_phase_shift(phase_shift_ptr, ue_ant_num,
                                         cfg_->Frame().ClientUlPilotSymbols(),
                                         false);
           mat_phase_shift.fill(0);
         }
         auto* phase_shift_ptr = reinterpret_cast<arma::cx_float*>(
-            &ue_spec_pilot_buffer_[frame_id % kFrameWnd]
-                                  [symbol_idx_ul * cfg_->UeAntNum()]);
-        arma::cx_fmat mat_phase_shift(phase_shift_ptr, cfg_->UeAntNum(), 1,
+            &ue_spec_pilot_buffer_[frame_id % cfg_->FrameWnd()]
+                                  [symbol_idx_ul * ue_ant_num]);
+        arma::cx_fmat mat_phase_shift(phase_shift_ptr, ue_ant_num, 1,
                                       false);
         arma::cx_fmat shift_sc =
             sign(mat_equaled % conj(ue_pilot_data_.col(cur_sc_id)));
@@ -250,12 +424,12 @@ EventData DoDemul::Launch(size_t tag) {
       // apply previously calc'ed phase shift to data
       else if (cfg_->Frame().ClientUlPilotSymbols() > 0) {
         auto* pilot_corr_ptr = reinterpret_cast<arma::cx_float*>(
-            ue_spec_pilot_buffer_[frame_id % kFrameWnd]);
-        arma::cx_fmat pilot_corr_mat(pilot_corr_ptr, cfg_->UeAntNum(),
+            ue_spec_pilot_buffer_[frame_id % cfg_->FrameWnd()]);
+        arma::cx_fmat pilot_corr_mat(pilot_corr_ptr, ue_ant_num,
                                      cfg_->Frame().ClientUlPilotSymbols(),
                                      false);
         arma::fmat theta_mat = arg(pilot_corr_mat);
-        arma::fmat theta_inc = arma::zeros<arma::fmat>(cfg_->UeAntNum(), 1);
+        arma::fmat theta_inc = arma::zeros<arma::fmat>(ue_ant_num, 1);
         for (size_t s = 1; s < cfg_->Frame().ClientUlPilotSymbols(); s++) {
           arma::fmat theta_diff = theta_mat.col(s) - theta_mat.col(s - 1);
           theta_inc += theta_diff;
@@ -271,12 +445,34 @@ EventData DoDemul::Launch(size_t tag) {
 
         // Measure EVM from ground truth
         if (symbol_idx_ul == cfg_->Frame().ClientUlPilotSymbols()) {
-          phy_stats_->UpdateEvmStats(frame_id, cur_sc_id, mat_equaled);
+          phy_stats_->UpdateEvmStats(frame_id, cur_sc_id, equaled_vec);
           if (kPrintPhyStats && cur_sc_id == 0) {
             phy_stats_->PrintEvmStats(frame_id - 1);
           }
         }
       }
+      // Scatter the finished vector into the per-UE demodulator rows
+      // (split into planes when the planar demodulators are in use), and
+      // into the constellation export buffer when that is enabled
+      const size_t sc_off = i + j;
+      if (equaled_planar_.IsAllocated() == true) {
+        for (size_t ue = 0; ue < ue_ant_num; ue++) {
+          equaled_planar_.Re(ue)[sc_off] = equaled_vec[ue].re;
+          equaled_planar_.Im(ue)[sc_off] = equaled_vec[ue].im;
+        }
+      } else {
+        auto* equal_t_base =
+            reinterpret_cast<complex_float*>(equaled_buffer_temp_transposed_);
+        for (size_t ue = 0; ue < ue_ant_num; ue++) {
+          equal_t_base[(ue * max_sc_ite) + sc_off] = equaled_vec[ue];
+        }
+      }
+      if (kExportConstellation) {
+        std::memcpy(&equal_buffer_[total_data_symbol_idx_ul]
+                                  [cur_sc_id * ue_ant_num],
+                    equaled_vec, ue_ant_num * sizeof(complex_float));
+      }
+
       size_t start_tsc3 = GetTime::WorkerRdtsc();
       duration_stat_->task_duration_[2] += start_tsc3 - start_tsc2;
       duration_stat_->task_count_++;
@@ -284,44 +480,63 @@ EventData DoDemul::Launch(size_t tag) {
   }
 
   size_t start_tsc3 = GetTime::WorkerRdtsc();
-  __m256i index2 =
-      _mm256_setr_epi32(0, 1, cfg_->UeAntNum() * 2, cfg_->UeAntNum() * 2 + 1,
-                        cfg_->UeAntNum() * 4, cfg_->UeAntNum() * 4 + 1,
-                        cfg_->UeAntNum() * 6, cfg_->UeAntNum() * 6 + 1);
-  auto* equal_t_ptr = reinterpret_cast<float*>(equaled_buffer_temp_transposed_);
-  for (size_t i = 0; i < cfg_->UeAntNum(); i++) {
-    float* equal_ptr = nullptr;
-    if (kExportConstellation) {
-      equal_ptr = reinterpret_cast<float*>(
-          &equal_buffer_[total_data_symbol_idx_ul]
-                        [base_sc_id * cfg_->UeAntNum() + i]);
-    } else {
-      equal_ptr = reinterpret_cast<float*>(equaled_buffer_temp_ + i);
-    }
-    size_t k_num_double_in_sim_d256 = sizeof(__m256) / sizeof(double);  // == 4
-    for (size_t j = 0; j < max_sc_ite / k_num_double_in_sim_d256; j++) {
-      __m256 equal_t_temp = _mm256_i32gather_ps(equal_ptr, index2, 4);
-      _mm256_store_ps(equal_t_ptr, equal_t_temp);
-      equal_t_ptr += 8;
-      equal_ptr += cfg_->UeAntNum() * k_num_double_in_sim_d256 * 2;
+  for (size_t i = 0; i < ue_ant_num; i++) {
+    // Each UE's equalized symbols are already contiguous; rows start on a
+    // cacheline boundary because max_sc_ite is a multiple of kSCsPerCacheline
+    auto* equal_t_ptr = reinterpret_cast<float*>(
+        equaled_buffer_temp_transposed_ + (i * max_sc_ite));
+
+    if (cfg_->HardDemod() == true) {
+      // Hard-decision fast path for uncoded configurations: map each
+      // equalized symbol to its constellation index and pack the bits
+      // straight into the decoded buffer, bypassing the LLR buffers and
+      // the LDPC decoder entirely
+      if (demod_hard_func_ != nullptr) {
+        demod_hard_func_(equal_t_ptr, hard_decision_buffer_, max_sc_ite);
+      }
+      // Pack ModOrderBits() bits per subcarrier, MSB first. The bit offset
+      // base_sc_id * ModOrderBits() is byte aligned because launch widths
+      // are multiples of kSCsPerCacheline.
+      auto* packed_ptr = reinterpret_cast<uint8_t*>(
+          decoded_buffers_[frame_slot][symbol_idx_ul][i] +
+          ((base_sc_id * mod_order_bits) / 8));
+      uint32_t bit_acc = 0;
+      size_t acc_bits = 0;
+      for (size_t s = 0; s < max_sc_ite; s++) {
+        bit_acc = (bit_acc << mod_order_bits) | hard_decision_buffer_[s];
+        acc_bits += mod_order_bits;
+        while (acc_bits >= 8) {
+          *packed_ptr++ = static_cast<uint8_t>(bit_acc >> (acc_bits - 8));
+          acc_bits -= 8;
+        }
+      }
+      continue;
     }
-    equal_t_ptr = (float*)(equaled_buffer_temp_transposed_);
+
     int8_t* demod_ptr = demod_buffers_[frame_slot][symbol_idx_ul][i] +
-                        (cfg_->ModOrderBits() * base_sc_id);
+                        (mod_order_bits * base_sc_id);
+    if (cfg_->Llr4Bit() == true) {
+      // Demodulate into byte-LLR scratch first; the quantized nibbles go
+      // into the demod buffer at half the byte offset below
+      demod_ptr = llr_soft_scratch_;
+    }
 
-    switch (cfg_->ModOrderBits()) {
-      case (CommsLib::kQpsk):
-        DemodQpskSoftSse(equal_t_ptr, demod_ptr, max_sc_ite);
-        break;
-      case (CommsLib::kQaM16):
-        Demod16qamSoftAvx2(equal_t_ptr, demod_ptr, max_sc_ite);
-        break;
-      case (CommsLib::kQaM64):
-        Demod64qamSoftAvx2(equal_t_ptr, demod_ptr, max_sc_ite);
-        break;
-      default:
-        std::printf("Demodulation: modulation type %s not supported!\n",
-                    cfg_->Modulation().c_str());
+    if (equaled_planar_.IsAllocated() == true) {
+      const float* re_ptr = equaled_planar_.Re(i);
+      const float* im_ptr = equaled_planar_.Im(i);
+      if (demod_soft_planar_func_ != nullptr) {
+        demod_soft_planar_func_(re_ptr, im_ptr, demod_ptr, max_sc_ite);
+      }
+    } else if (demod_soft_func_ != nullptr) {
+      demod_soft_func_(equal_t_ptr, demod_ptr, max_sc_ite);
+    }
+    if (cfg_->Llr4Bit() == true) {
+      // ModOrderBits() is even and base_sc_id is cacheline-aligned, so the
+      // nibble run starts on a byte boundary
+      PackLlrsTo4Bit(llr_soft_scratch_,
+                     demod_buffers_[frame_slot][symbol_idx_ul][i] +
+                         ((mod_order_bits * base_sc_id) / 2),
+                     mod_order_bits * max_sc_ite);
     }
     // std::printf("In doDemul thread %d: frame: %d, symbol: %d, sc_id: %d \n",
     //     tid, frame_id, symbol_idx_ul, base_sc_id);
@@ -333,6 +548,8 @@ EventData DoDemul::Launch(size_t tag) {
   }
 
   duration_stat_->task_duration_[3] += GetTime::WorkerRdtsc() - start_tsc3;
-  duration_stat_->task_duration_[0] += GetTime::WorkerRdtsc() - start_tsc;
+  const size_t launch_cycles = GetTime::WorkerRdtsc() - start_tsc;
+  duration_stat_->task_duration_[0] += launch_cycles;
+  duration_hist_->Record(launch_cycles);
   return EventData(EventType::kDemul, tag);
 }
@@ -16,17 +16,24 @@
 #include "gettime.h"
 #include "modulation.h"
 #include "phy_stats.h"
+#include "small_linalg.h"
 #include "stats.h"
 #include "symbols.h"
 
 class DoDemul : public Doer {
  public:
+  /// With [alt_kernel] set, the instance uses the planar soft
+  /// demodulators when the production config uses the interleaved ones
+  /// and vice versa. Only the shadow A/B harness constructs such
+  /// instances; production workers leave it defaulted.
   DoDemul(Config* config, int tid, Table<complex_float>& data_buffer,
           PtrGrid<kFrameWnd, kMaxDataSCs, complex_float>& ul_zf_matrices,
           Table<complex_float>& ue_spec_pilot_buffer,
           Table<complex_float>& equal_buffer,
           PtrCube<kFrameWnd, kMaxSymbols, kMaxUEs, int8_t>& demod_buffers_,
-          PhyStats* in_phy_stats, Stats* in_stats_manager);
+          PtrCube<kFrameWnd, kMaxSymbols, kMaxUEs, int8_t>& decoded_buffers,
+          PhyStats* in_phy_stats, Stats* in_stats_manager,
+          bool alt_kernel = false);
   ~DoDemul() override;
 
   /**
@@ -57,25 +64,63 @@ class DoDemul : public Doer {
    */
   EventData Launch(size_t tag) override;
 
+  /// Batched variant of Launch(). Runs of tags that cover contiguous
+  /// subcarrier blocks of the same symbol are folded into one equalization
+  /// pass, amortizing the gather and matmul setup across blocks.
+  EventData LaunchBatch(const size_t* tags, size_t num_tags) override;
+
+  /// Prefetch hint: the first data_buffer_ cacheline the gather pass of
+  /// tag's subcarrier block reads
+  const void* InputAddr(size_t tag) override;
+
  private:
+  /// Equalize and demodulate up to max_scs subcarriers starting at the block
+  /// identified by tag. Launch() calls this with the configured block size.
+  EventData LaunchRange(size_t tag, size_t max_scs);
+
   Table<complex_float>& data_buffer_;
   PtrGrid<kFrameWnd, kMaxDataSCs, complex_float>& ul_zf_matrices_;
   Table<complex_float>& ue_spec_pilot_buffer_;
   Table<complex_float>& equal_buffer_;
   PtrCube<kFrameWnd, kMaxSymbols, kMaxUEs, int8_t>& demod_buffers_;
+  // Bits packed directly by the hard-decision fast path (hard_demod)
+  PtrCube<kFrameWnd, kMaxSymbols, kMaxUEs, int8_t>& decoded_buffers_;
   DurationStat* duration_stat_;
+  LatencyHistogram* duration_hist_;
   PhyStats* phy_stats_;
 
   /// Intermediate buffer to gather raw data. Size = subcarriers per cacheline
   /// times number of antennas
   complex_float* data_gather_buffer_;
 
-  // Intermediate buffers for equalized data
-  complex_float* equaled_buffer_temp_;
+  // Equalized data in subcarrier-major per-UE rows, the layout consumed by
+  // the soft demodulators. Written directly by the equalization loop.
   complex_float* equaled_buffer_temp_transposed_;
+  // Planar variant of the above (demul_planar): per-UE rows split into
+  // real and imaginary planes for the planar soft demodulators
+  PlanarTable<float> equaled_planar_;
+  // Per-UE hard decisions (one constellation index per subcarrier) before
+  // they are packed into the decoded buffer
+  uint8_t* hard_decision_buffer_;
+  // Byte-LLR staging for the 4-bit packed LLR mode: soft demodulators write
+  // here, then the LLRs are quantized into the demod buffer as nibbles
+  int8_t* llr_soft_scratch_;
+  // Demodulator entry points, resolved once at construction. The modulation
+  // order and the hard/planar/interleaved choice are both fixed at config
+  // load, so LaunchRange() jumps through one of these instead of switching
+  // on ModOrderBits() per block. Only the pointer matching the configured
+  // path is non-null.
+  void (*demod_hard_func_)(float* vec_in, uint8_t* vec_out, int num) = nullptr;
+  void (*demod_soft_planar_func_)(const float* vec_re, const float* vec_im,
+                                  int8_t* llr, int num) = nullptr;
+  void (*demod_soft_func_)(float* vec_in, int8_t* llr, int num) = nullptr;
   arma::cx_fmat ue_pilot_data_;
   int ue_num_simd256_;
 
+  // Equalization GEMV kernel picked at construction when
+  // small_linalg_kernels is set; nullptr keeps the MKL/Armadillo path
+  small_linalg::CgemvFn equalize_cgemv_ = nullptr;
+
 #if USE_MKL_JIT
   void* jitter_;
   cgemm_jit_kernel_t mkl_jit_cgemm_;
@@ -23,6 +23,8 @@ DoEncode::DoEncode(Config* in_config, int in_tid, Direction dir,
       encoded_buffer_(in_encoded_buffer),
       scrambler_(std::make_unique<AgoraScrambler::Scrambler>()) {
   duration_stat_ = in_stats_manager->GetDurationStat(DoerType::kEncode, in_tid);
+  duration_hist_ = in_stats_manager->GetDurationHist(DoerType::kEncode, in_tid);
+  RegisterTaskStats(&duration_stat_, &duration_hist_);
   parity_buffer_ = static_cast<int8_t*>(Agora_memory::PaddedAlignedAlloc(
       Agora_memory::Alignment_t::kAlign64,
       LdpcEncodingParityBufSize(cfg_->LdpcConfig().BaseGraph(),
@@ -34,17 +36,29 @@ DoEncode::DoEncode(Config* in_config, int in_tid, Direction dir,
                                  cfg_->LdpcConfig().ExpansionFactor())));
   assert(encoded_buffer_temp_ != nullptr);
 
+  const size_t scrambler_buffer_bytes =
+      cfg_->NumBytesPerCb() + kLdpcHelperFunctionInputBufferSizePaddingBytes;
   scrambler_buffer_ = static_cast<int8_t*>(Agora_memory::PaddedAlignedAlloc(
-      Agora_memory::Alignment_t::kAlign64,
-      cfg_->NumBytesPerCb() + kLdpcHelperFunctionInputBufferSizePaddingBytes));
+      Agora_memory::Alignment_t::kAlign64, scrambler_buffer_bytes));
 
   assert(scrambler_buffer_ != nullptr);
+  std::memset(scrambler_buffer_, 0, scrambler_buffer_bytes);
+
+  // Materialize the scrambling sequence once by scrambling an all-zero code
+  // block: the scrambler XORs a fixed frame-synchronous sequence into the
+  // data, so the scrambled zeros are the sequence itself
+  scramble_seq_ = static_cast<int8_t*>(Agora_memory::PaddedAlignedAlloc(
+      Agora_memory::Alignment_t::kAlign64, scrambler_buffer_bytes));
+  assert(scramble_seq_ != nullptr);
+  std::memset(scramble_seq_, 0, scrambler_buffer_bytes);
+  scrambler_->Scramble(scramble_seq_, cfg_->NumBytesPerCb());
 }
 
 DoEncode::~DoEncode() {
   std::free(parity_buffer_);
   std::free(encoded_buffer_temp_);
   std::free(scrambler_buffer_);
+  std::free(scramble_seq_);
 }
 
 EventData DoEncode::Launch(size_t tag) {
@@ -108,8 +122,21 @@ EventData DoEncode::Launch(size_t tag) {
   int8_t* ldpc_input = nullptr;
 
   if (this->cfg_->ScrambleEnabled()) {
-    std::memcpy(scrambler_buffer_, tx_data_ptr, cfg_->NumBytesPerCb());
-    scrambler_->Scramble(scrambler_buffer_, cfg_->NumBytesPerCb());
+    // Fused copy + scramble: one pass XOR-ing the precomputed sequence into
+    // the input, instead of a memcpy followed by the per-bit scrambler
+    const size_t num_bytes = cfg_->NumBytesPerCb();
+    size_t i = 0;
+    for (; (i + sizeof(uint64_t)) <= num_bytes; i += sizeof(uint64_t)) {
+      uint64_t word;
+      uint64_t seq_word;
+      std::memcpy(&word, tx_data_ptr + i, sizeof(word));
+      std::memcpy(&seq_word, scramble_seq_ + i, sizeof(seq_word));
+      word ^= seq_word;
+      std::memcpy(scrambler_buffer_ + i, &word, sizeof(word));
+    }
+    for (; i < num_bytes; i++) {
+      scrambler_buffer_[i] = tx_data_ptr[i] ^ scramble_seq_[i];
+    }
     ldpc_input = scrambler_buffer_;
   } else {
     ldpc_input = tx_data_ptr;
@@ -142,6 +169,7 @@ EventData DoEncode::Launch(size_t tag) {
   size_t duration = GetTime::WorkerRdtsc() - start_tsc;
   duration_stat_->task_duration_[0] += duration;
   duration_stat_->task_count_++;
+  duration_hist_->Record(duration);
   if (GetTime::CyclesToUs(duration, cfg_->FreqGhz()) > 500) {
     std::printf("Thread %d Encode takes %.2f\n", tid_,
                 GetTime::CyclesToUs(duration, cfg_->FreqGhz()));
@@ -42,7 +42,13 @@ class DoEncode : public Doer {
   // Intermediate buffer to hold pre/post scrambled data
   int8_t* scrambler_buffer_;
 
+  // Precomputed WLAN scrambling sequence, packed as bytes. Scrambling is a
+  // plain XOR with this fixed frame-synchronous sequence, so the per-bit
+  // scrambler pass fuses into the code block input copy.
+  int8_t* scramble_seq_;
+
   DurationStat* duration_stat_;
+  LatencyHistogram* duration_hist_;
   std::unique_ptr<AgoraScrambler::Scrambler> scrambler_;
 };
 
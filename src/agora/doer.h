@@ -6,11 +6,17 @@
 #ifndef DOER_H_
 #define DOER_H_
 
+#include <emmintrin.h>
+
 #include "buffer.h"
+#include "completion_ring.h"
 #include "concurrent_queue_wrapper.h"
 #include "concurrentqueue.h"
 #include "logger.h"
+#include "memory_manage.h"
+#include "pmu_sampler.h"
 #include "stats.h"
+#include "trace_ring.h"
 
 class Doer {
  public:
@@ -20,22 +26,178 @@ class Doer {
       moodycamel::ProducerToken* worker_ptok) {
     EventData req_event;
     if (task_queue.try_dequeue(req_event)) {
-      // We will enqueue one response event containing results for all
-      // request tags in the request event
-      EventData resp_event;
-      resp_event.num_tags_ = req_event.num_tags_;
+      ProcessEvent(req_event, complete_task_queue, worker_ptok);
+      return true;
+    }
+    return false;
+  }
+
+  /// Process one dequeued request event and enqueue the response. Schedulers
+  /// that dequeue request events themselves (e.g., the work-stealing worker)
+  /// call this directly instead of TryLaunch().
+  void ProcessEvent(const EventData& req_event,
+                    moodycamel::ConcurrentQueue<EventData>& complete_task_queue,
+                    moodycamel::ProducerToken* worker_ptok) {
+    // We will enqueue one response event containing results for all
+    // request tags in the request event
+    TryEnqueueFallback(&complete_task_queue, worker_ptok, RunEvent(req_event));
+  }
+
+  /// Variant of TryLaunch() that returns the completion event over the
+  /// worker's SPSC ring instead of the MPMC complete-task queue
+  virtual bool TryLaunch(moodycamel::ConcurrentQueue<EventData>& task_queue,
+                         CompletionRing& completion_ring) {
+    EventData req_event;
+    if (task_queue.try_dequeue(req_event)) {
+      ProcessEvent(req_event, completion_ring);
+      return true;
+    }
+    return false;
+  }
 
-      for (size_t i = 0; i < req_event.num_tags_; i++) {
-        EventData resp_i = Launch(req_event.tags_[i]);
+  /// Ring variant of ProcessEvent(). Spins if the ring is full; the master
+  /// drains rings every loop iteration, so this only blocks under overload.
+  void ProcessEvent(const EventData& req_event,
+                    CompletionRing& completion_ring) {
+    EventData resp_event = RunEvent(req_event);
+    while (completion_ring.TryPush(resp_event) == false) {
+      GetTime::SpinPause();
+    }
+  }
+
+  /// Run every task a request event describes and build the matching
+  /// response event. A range event is executed task by task and answered
+  /// with one range-encoded response mirroring the request.
+  /// When the event's frame falls inside the configured trace window, the
+  /// whole event is bracketed with begin/end trace records so the offline
+  /// chrome-trace export can render per-worker doer spans. With PMU
+  /// sampling enabled, the event is additionally bracketed with hardware
+  /// counter reads accumulated per doer type.
+  EventData RunEvent(const EventData& req_event) {
+    // Task-timing sampling (stats_sample_interval > 1): for 1-in-N events
+    // the doer's DurationStat and histogram writes are recorded and then
+    // weighted by N; for the rest the stat pointers are parked on private
+    // scratch and WorkerRdtsc short-circuits, so the steady state pays
+    // neither the rdtsc nor the shared-array cache traffic. Task counts
+    // stay exact: the scratch counts are folded back after every event.
+    const size_t stats_interval = cfg_->StatsSampleInterval();
+    const bool stats_sampling =
+        (stats_interval > 1) && (num_stat_slots_ > 0);
+    bool stats_record = true;
+    std::array<std::array<size_t, kMaxStatBreakdown>, kMaxTaskStatSlots>
+        duration_before;
+    if (stats_sampling == true) {
+      stats_record = (stats_tick_ == 0);
+      stats_tick_++;
+      if (stats_tick_ >= stats_interval) {
+        stats_tick_ = 0;
+      }
+      for (size_t i = 0; i < num_stat_slots_; i++) {
+        TaskStatSlot& slot = stat_slots_[i];
+        if (stats_record == true) {
+          duration_before[i] = slot.stat_live_->task_duration_;
+        } else {
+          slot.stat_scratch_.Reset();
+          *slot.stat_member_ = &slot.stat_scratch_;
+          if (slot.hist_member_ != nullptr) {
+            *slot.hist_member_ = &slot.hist_scratch_;
+          }
+        }
+      }
+      if (stats_record == false) {
+        GetTime::WorkerTimingThisEvent() = false;
+      }
+    }
+    const gen_tag_t trace_tag(req_event.tags_[0]);
+    const bool trace_span =
+        (trace_tag.frame_id_ >= cfg_->TraceSpanFrameStart()) &&
+        (trace_tag.frame_id_ <
+         (cfg_->TraceSpanFrameStart() + cfg_->TraceSpanFrameCount()));
+    if (trace_span) {
+      TraceLog::Emit(
+          kTraceTaskBegin | static_cast<uint16_t>(req_event.event_type_),
+          trace_tag.symbol_id_, trace_tag.frame_id_);
+    }
+    PmuSampler* pmu = PmuSampler::ThreadInstance();
+    DoerType pmu_doer_type;
+    PmuSampler::Sample pmu_begin;
+    const bool pmu_sample =
+        (pmu != nullptr) &&
+        PmuSampler::DoerTypeOfEvent(req_event.event_type_, &pmu_doer_type) &&
+        pmu->ReadSample(&pmu_begin);
+    EventData resp_event;
+    if (req_event.IsRange()) {
+      resp_event = req_event;
+      for (size_t i = 0; i < req_event.NumTasks(); i++) {
+        if ((i + 1) < req_event.NumTasks()) {
+          PrefetchInput(req_event.Tag(i + 1));
+        }
+        EventData resp_i = Launch(req_event.Tag(i));
         RtAssert(resp_i.num_tags_ == 1, "Invalid num_tags in resp");
-        resp_event.tags_[i] = resp_i.tags_[0];
         resp_event.event_type_ = resp_i.event_type_;
       }
+    } else {
+      resp_event = LaunchBatch(req_event.tags_.data(), req_event.num_tags_);
+      RtAssert(resp_event.num_tags_ == req_event.num_tags_,
+               "Invalid num_tags in batch resp");
+    }
+    if (pmu_sample) {
+      PmuSampler::Sample pmu_end;
+      if (pmu->ReadSample(&pmu_end)) {
+        pmu->AccumulateDelta(pmu_doer_type, pmu_begin, pmu_end);
+      }
+    }
+    if (trace_span) {
+      TraceLog::Emit(
+          kTraceTaskEnd | static_cast<uint16_t>(req_event.event_type_),
+          trace_tag.symbol_id_, trace_tag.frame_id_);
+    }
+    if (stats_sampling == true) {
+      if (stats_record == true) {
+        // Scale this event's duration deltas so the sampled event stands
+        // in for the interval's unrecorded peers
+        for (size_t i = 0; i < num_stat_slots_; i++) {
+          DurationStat* live = stat_slots_[i].stat_live_;
+          for (size_t d = 0; d < kMaxStatBreakdown; d++) {
+            live->task_duration_[d] +=
+                (live->task_duration_[d] - duration_before[i][d]) *
+                (stats_interval - 1);
+          }
+        }
+      } else {
+        GetTime::WorkerTimingThisEvent() = true;
+        for (size_t i = 0; i < num_stat_slots_; i++) {
+          TaskStatSlot& slot = stat_slots_[i];
+          *slot.stat_member_ = slot.stat_live_;
+          if (slot.hist_member_ != nullptr) {
+            *slot.hist_member_ = slot.hist_live_;
+          }
+          // Throughput counters stay exact even for unrecorded events
+          slot.stat_live_->task_count_ += slot.stat_scratch_.task_count_;
+        }
+      }
+    }
+    return resp_event;
+  }
 
-      TryEnqueueFallback(&complete_task_queue, worker_ptok, resp_event);
-      return true;
+  /// Process all tags of a request event in one call, returning a response
+  /// event with one result tag per request tag. The default implementation
+  /// dispatches to Launch() once per tag; doers that can amortize per-call
+  /// setup (e.g., matrix construction) across tags override this.
+  virtual EventData LaunchBatch(const size_t* tags, size_t num_tags) {
+    EventData resp_event;
+    resp_event.num_tags_ = num_tags;
+
+    for (size_t i = 0; i < num_tags; i++) {
+      if ((i + 1) < num_tags) {
+        PrefetchInput(tags[i + 1]);
+      }
+      EventData resp_i = Launch(tags[i]);
+      RtAssert(resp_i.num_tags_ == 1, "Invalid num_tags in resp");
+      resp_event.tags_[i] = resp_i.tags_[0];
+      resp_event.event_type_ = resp_i.event_type_;
     }
-    return false;
+    return resp_event;
   }
 
   /// The main event handling function that performs Doer-specific work.
@@ -55,12 +217,110 @@ class Doer {
     return EventData();
   }
 
+  /// Address of the first input byte Launch(tag) reads, used by the batch
+  /// loops to prefetch the next tag's leading cachelines while the current
+  /// tag computes. Doers whose input address is cheap to derive from the
+  /// tag override this; the default null hint disables the prefetch.
+  virtual const void* InputAddr(size_t tag) {
+    unused(tag);
+    return nullptr;
+  }
+
+  /// Point this Doer at the per-frame scratch arenas, one per in-flight
+  /// frame. Called once after construction, before any Launch().
+  void SetFrameArenas(FrameArena* frame_arenas, size_t num_arenas) {
+    frame_arenas_ = frame_arenas;
+    num_frame_arenas_ = num_arenas;
+  }
+
  protected:
   Doer(Config* in_config, int in_tid) : cfg_(in_config), tid_(in_tid) {}
 
   virtual ~Doer() = default;
 
+  /// A doer's DurationStat (and optional histogram) pointer registered for
+  /// 1-in-N task-timing sampling: RunEvent() parks the member on the
+  /// private scratch copies for unrecorded events
+  struct TaskStatSlot {
+    DurationStat** stat_member_ = nullptr;
+    DurationStat* stat_live_ = nullptr;
+    DurationStat stat_scratch_;
+    LatencyHistogram** hist_member_ = nullptr;
+    LatencyHistogram* hist_live_ = nullptr;
+    LatencyHistogram hist_scratch_;
+  };
+  static constexpr size_t kMaxTaskStatSlots = 2;
+
+  /// Register the doer's timing-stat members for sampling. Called once
+  /// from the derived constructor after the members are fetched from
+  /// Stats; hist_member may be nullptr for doers without a histogram
+  void RegisterTaskStats(DurationStat** stat_member,
+                         LatencyHistogram** hist_member) {
+    RtAssert(num_stat_slots_ < kMaxTaskStatSlots,
+             "Doer: too many task-stat slots");
+    TaskStatSlot& slot = stat_slots_[num_stat_slots_];
+    slot.stat_member_ = stat_member;
+    slot.stat_live_ = *stat_member;
+    slot.hist_member_ = hist_member;
+    if (hist_member != nullptr) {
+      slot.hist_live_ = *hist_member;
+      // Weight the recorded samples so the histogram's percentiles and
+      // totals remain unbiased under sampling
+      slot.hist_live_->SetRecordWeight(cfg_->StatsSampleInterval());
+    }
+    num_stat_slots_++;
+  }
+
+  /// Cachelines prefetched from the next tag's input region: enough to
+  /// cover a launch's leading loads without dragging the whole region in
+  static constexpr size_t kInputPrefetchLines = 4;
+  static constexpr size_t kCachelineBytes = 64;
+
+  /// Prefetch the leading cachelines of tag's input, as reported by
+  /// InputAddr(). A null hint (the base-class default) makes this a no-op.
+  inline void PrefetchInput(size_t tag) {
+    const char* addr = static_cast<const char*>(InputAddr(tag));
+    if (addr == nullptr) {
+      return;
+    }
+    for (size_t i = 0; i < kInputPrefetchLines; i++) {
+      _mm_prefetch(addr + (i * kCachelineBytes), _MM_HINT_T0);
+    }
+  }
+
+  /// Transient scratch for frame_id, valid until the master completes the
+  /// frame and resets its arena. Returns nullptr if no arenas are attached
+  /// or the arena is exhausted; callers then fall back to their own storage.
+  void* FrameScratch(size_t frame_id, size_t bytes) {
+    if (frame_arenas_ == nullptr) {
+      return nullptr;
+    }
+    return frame_arenas_[frame_id % num_frame_arenas_].BumpAlloc(bytes);
+  }
+
+  /// Debug-mode check that frame_id still owns its frame-window slot.
+  /// Catches tasks that would read or write buffers already recycled by a
+  /// window overrun. Compiles to nothing unless kDebugFrameSlotOwnership
+  /// is set.
+  void CheckFrameSlotOwner(size_t frame_id) const {
+    if (kDebugFrameSlotOwnership) {
+      RtAssert(FrameSlotMonitor::Owns(frame_id),
+               "Doer: frame " + std::to_string(frame_id) +
+                   " lost its frame-window slot (window overrun)");
+    }
+  }
+
   Config* cfg_;
   int tid_;  // Thread ID of this Doer
+
+ private:
+  FrameArena* frame_arenas_ = nullptr;
+  size_t num_frame_arenas_ = 0;
+
+  // Task-timing sampling state (see RunEvent and RegisterTaskStats):
+  // decimation tick plus the registered stat slots
+  size_t stats_tick_ = 0;
+  size_t num_stat_slots_ = 0;
+  std::array<TaskStatSlot, kMaxTaskStatSlots> stat_slots_;
 };
 #endif  // DOER_H_
@@ -4,13 +4,22 @@
  */
 #include "dofft.h"
 
+#include "build_profile.h"
 #include "concurrent_queue_wrapper.h"
 #include "datatype_conversion.h"
+#include "fft_plan_cache.h"
 
 static constexpr bool kPrintFFTInput = false;
 static constexpr bool kPrintInputPilot = false;
 static constexpr bool kPrintPilotCorrStats = false;
 
+// CFO estimation (cfo_correction): subcarrier decimation of the
+// cross-frame CSI correlation and the IIR weight of each new estimate.
+// Light smoothing tracks oscillator drift while averaging out the
+// per-frame phase noise of a single-antenna measurement
+static constexpr size_t kCfoEstScStride = 16;
+static constexpr float kCfoSmoothAlpha = 0.1f;
+
 DoFFT::DoFFT(Config* config, size_t tid, Table<complex_float>& data_buffer,
              PtrGrid<kFrameWnd, kMaxUEs, complex_float>& csi_buffers,
              Table<complex_float>& calib_dl_buffer,
@@ -24,14 +33,27 @@ DoFFT::DoFFT(Config* config, size_t tid, Table<complex_float>& data_buffer,
       phy_stats_(in_phy_stats) {
   duration_stat_fft_ = stats_manager->GetDurationStat(DoerType::kFFT, tid);
   duration_stat_csi_ = stats_manager->GetDurationStat(DoerType::kCSI, tid);
-  DftiCreateDescriptor(&mkl_handle_, DFTI_SINGLE, DFTI_COMPLEX, 1,
-                       cfg_->OfdmCaNum());
-  DftiCommitDescriptor(mkl_handle_);
-
-  // Aligned for SIMD
-  fft_inout_ = static_cast<complex_float*>(Agora_memory::PaddedAlignedAlloc(
-      Agora_memory::Alignment_t::kAlign64,
-      cfg_->OfdmCaNum() * sizeof(complex_float)));
+  duration_hist_fft_ = stats_manager->GetDurationHist(DoerType::kFFT, tid);
+  duration_hist_csi_ = stats_manager->GetDurationHist(DoerType::kCSI, tid);
+  RegisterTaskStats(&duration_stat_fft_, &duration_hist_fft_);
+  RegisterTaskStats(&duration_stat_csi_, &duration_hist_csi_);
+  // When the input is 16-bit IQ, fold the short-to-float scaling into the
+  // transform itself (DFTI_FORWARD_SCALE) so the conversion pass is a plain
+  // widening load with no per-sample multiply
+  const bool fold_scale = (cfg_->FftInRru() == false) && (kUse12BitIQ == false);
+  if (fold_scale == true) {
+    mkl_handle_ = FftPlanCache::ComplexForwardScaled(cfg_->OfdmCaNum(),
+                                                     1.0f / 32768.0f);
+  } else {
+    mkl_handle_ = FftPlanCache::Complex(cfg_->OfdmCaNum());
+  }
+  // Per-thread transform workspace, shared with other FFT/IFFT doers on
+  // this thread: the first OfdmCaNum() entries hold the FFT input/output,
+  // the second OfdmCaNum() the pruned sub-FFT outputs
+  fft_inout_ = static_cast<complex_float*>(Agora_memory::GetFftScratch(
+      2 * cfg_->OfdmCaNum() * sizeof(complex_float)));
+  use_pruned_fft_ = SetupPrunedFft(fold_scale);
+
   temp_16bits_iq_ = static_cast<uint16_t*>(Agora_memory::PaddedAlignedAlloc(
       Agora_memory::Alignment_t::kAlign64, 32 * sizeof(uint16_t)));
   rx_samps_tmp_ =
@@ -41,12 +63,134 @@ DoFFT::DoFFT(Config* config, size_t tid, Table<complex_float>& data_buffer,
 }
 
 DoFFT::~DoFFT() {
-  DftiFreeDescriptor(&mkl_handle_);
-  std::free(fft_inout_);
+  // mkl_handle_ is owned by FftPlanCache; the pruned descriptor is not.
+  // fft_inout_ and prune_sub_ffts_ live in the per-thread workspace
+  if (use_pruned_fft_ == true) {
+    DftiFreeDescriptor(&mkl_pruned_handle_);
+    std::free(prune_twiddles_);
+  }
   std::free(rx_samps_tmp_);
   std::free(temp_16bits_iq_);
 }
 
+bool DoFFT::SetupPrunedFft(bool fold_scale) {
+  mkl_pruned_handle_ = nullptr;
+  prune_sub_ffts_ = nullptr;
+  prune_twiddles_ = nullptr;
+  prune_n1_ = 0;
+  prune_n2_ = 0;
+
+  const size_t fft_size = cfg_->OfdmCaNum();
+  const size_t data_num = cfg_->OfdmDataNum();
+  if ((cfg_->FftPruneThresh() <= 0.0) || (cfg_->FftInRru() == true) ||
+      (data_num > (cfg_->FftPruneThresh() * fft_size))) {
+    return false;
+  }
+
+  // Cost model in butterfly-equivalent units: a full transform costs
+  // n log2(n); the pruned path costs n log2(n2) for the sub-FFTs plus
+  // 2 * data_num * n1 for the per-bin recombination
+  const double full_cost = fft_size * std::log2(fft_size);
+  double best_cost = full_cost;
+  for (size_t n1 = 2; (n1 <= 64) && ((fft_size % n1) == 0); n1 *= 2) {
+    const double cost =
+        (fft_size * std::log2(fft_size / n1)) + (2.0 * data_num * n1);
+    if (cost < best_cost) {
+      best_cost = cost;
+      prune_n1_ = n1;
+    }
+  }
+  if (prune_n1_ == 0) {
+    MLPD_WARN(
+        "DoFFT: pruned FFT not profitable for %zu of %zu subcarriers, "
+        "using the full transform\n",
+        data_num, fft_size);
+    return false;
+  }
+  prune_n2_ = fft_size / prune_n1_;
+
+  // Batch of prune_n1_ interleaved sub-FFTs: transform t reads
+  // fft_inout_[t + prune_n1_ * n2] and writes prune_sub_ffts_[t * prune_n2_]
+  MKL_LONG status = DftiCreateDescriptor(&mkl_pruned_handle_, DFTI_SINGLE,
+                                         DFTI_COMPLEX, 1, prune_n2_);
+  if (status == DFTI_NO_ERROR) {
+    status = DftiSetValue(mkl_pruned_handle_, DFTI_PLACEMENT,
+                          DFTI_NOT_INPLACE);
+  }
+  if (status == DFTI_NO_ERROR) {
+    status = DftiSetValue(mkl_pruned_handle_, DFTI_NUMBER_OF_TRANSFORMS,
+                          static_cast<MKL_LONG>(prune_n1_));
+  }
+  MKL_LONG input_strides[2] = {0, static_cast<MKL_LONG>(prune_n1_)};
+  if (status == DFTI_NO_ERROR) {
+    status =
+        DftiSetValue(mkl_pruned_handle_, DFTI_INPUT_STRIDES, input_strides);
+  }
+  if (status == DFTI_NO_ERROR) {
+    status = DftiSetValue(mkl_pruned_handle_, DFTI_INPUT_DISTANCE, 1);
+  }
+  MKL_LONG output_strides[2] = {0, 1};
+  if (status == DFTI_NO_ERROR) {
+    status =
+        DftiSetValue(mkl_pruned_handle_, DFTI_OUTPUT_STRIDES, output_strides);
+  }
+  if (status == DFTI_NO_ERROR) {
+    status = DftiSetValue(mkl_pruned_handle_, DFTI_OUTPUT_DISTANCE,
+                          static_cast<MKL_LONG>(prune_n2_));
+  }
+  if ((status == DFTI_NO_ERROR) && (fold_scale == true)) {
+    status = DftiSetValue(mkl_pruned_handle_, DFTI_FORWARD_SCALE,
+                          1.0f / 32768.0f);
+  }
+  if (status == DFTI_NO_ERROR) {
+    status = DftiCommitDescriptor(mkl_pruned_handle_);
+  }
+  RtAssert(status == DFTI_NO_ERROR,
+           "DoFFT: failed to commit the pruned FFT descriptor");
+
+  // Second half of the per-thread workspace, after the FFT input/output
+  prune_sub_ffts_ = fft_inout_ + fft_size;
+  prune_twiddles_ =
+      static_cast<complex_float*>(Agora_memory::PaddedAlignedAlloc(
+          Agora_memory::Alignment_t::kAlign64,
+          data_num * prune_n1_ * sizeof(complex_float)));
+  for (size_t m = 0; m < data_num; m++) {
+    const size_t bin = cfg_->OfdmDataStart() + m;
+    for (size_t t = 0; t < prune_n1_; t++) {
+      const double angle = -2.0 * M_PI * static_cast<double>(t * bin) /
+                           static_cast<double>(fft_size);
+      prune_twiddles_[(m * prune_n1_) + t].re =
+          static_cast<float>(std::cos(angle));
+      prune_twiddles_[(m * prune_n1_) + t].im =
+          static_cast<float>(std::sin(angle));
+    }
+  }
+  return true;
+}
+
+void DoFFT::PrunedFft() {
+  DftiComputeForward(mkl_pruned_handle_, reinterpret_cast<float*>(fft_inout_),
+                     reinterpret_cast<float*>(prune_sub_ffts_));
+
+  // Recombine the sub-FFT outputs for the occupied bins only:
+  // X[bin] = sum_t twiddle(t, bin) * F_t[bin mod prune_n2_]
+  const size_t data_start = cfg_->OfdmDataStart();
+  for (size_t m = 0; m < cfg_->OfdmDataNum(); m++) {
+    const size_t bin = data_start + m;
+    const size_t sub_bin = bin % prune_n2_;
+    const complex_float* tw = &prune_twiddles_[m * prune_n1_];
+    float re = 0.0f;
+    float im = 0.0f;
+    for (size_t t = 0; t < prune_n1_; t++) {
+      const complex_float f = prune_sub_ffts_[(t * prune_n2_) + sub_bin];
+      re += (tw[t].re * f.re) - (tw[t].im * f.im);
+      im += (tw[t].re * f.im) + (tw[t].im * f.re);
+    }
+    fft_inout_[bin].re = re;
+    fft_inout_[bin].im = im;
+  }
+}
+
 // @brief
 // @in_vec: input complex data to estimate regression params
 // @x0: value of the first x data (assumed consecutive integers)
@@ -84,23 +228,45 @@ EventData DoFFT::Launch(size_t tag) {
   size_t start_tsc = GetTime::WorkerRdtsc();
   Packet* pkt = fft_req_tag_t(tag).rx_packet_->RawPacket();
   size_t frame_id = pkt->frame_id_;
-  size_t frame_slot = frame_id % kFrameWnd;
+  size_t frame_slot = frame_id % cfg_->FrameWnd();
+  CheckFrameSlotOwner(frame_id);
   size_t symbol_id = pkt->symbol_id_;
   size_t ant_id = pkt->ant_id_;
   size_t cell_id = pkt->cell_id_;
   SymbolType sym_type = cfg_->GetSymbolType(symbol_id);
+  // Compile-time constant under a build profile (see build_profile.h)
+  const size_t ofdm_ca_num = BuildProfile::OfdmCaNum(cfg_->OfdmCaNum());
+
+  // Load shedding: drop shed antennas' uplink data symbols without
+  // transforming them. The completion event still fires so the per-symbol
+  // counters stay exact, and DoZF zeroes these antennas' beamweights for
+  // the same frames, so the stale data buffer contents are never read.
+  // Pilot and calibration symbols always keep the full array
+  if (sym_type == SymbolType::kUL) {
+    const size_t num_shed = cfg_->AntShed(frame_id);
+    if ((num_shed > 0) && (ant_id >= cfg_->BsAntNum() - num_shed)) {
+      if (cfg_->RxEpochReclaim() == false) {
+        fft_req_tag_t(tag).rx_packet_->Free();
+      }
+      // Shed antennas still count toward the chained completion tally so
+      // the symbol's demul can dispatch without them
+      ChainedDemulIfLastFft(frame_id, symbol_id);
+      return EventData(EventType::kFFT,
+                       gen_tag_t::FrmSymAnt(frame_id, symbol_id, ant_id).tag_);
+    }
+  }
 
   if (cfg_->FftInRru() == true) {
     SimdConvertFloat16ToFloat32(
         reinterpret_cast<float*>(fft_inout_),
         reinterpret_cast<float*>(&pkt->data_[2 * cfg_->OfdmRxZeroPrefixBs()]),
-        cfg_->OfdmCaNum() * 2);
+        ofdm_ca_num * 2);
   } else {
     if (kUse12BitIQ) {
       SimdConvert12bitIqToFloat(
           (uint8_t*)pkt->data_ + 3 * cfg_->OfdmRxZeroPrefixBs(),
           reinterpret_cast<float*>(fft_inout_), temp_16bits_iq_,
-          cfg_->OfdmCaNum() * 3);
+          ofdm_ca_num * 3);
     } else {
       size_t sample_offset = cfg_->OfdmRxZeroPrefixBs();
       if (sym_type == SymbolType::kCalDL) {
@@ -108,9 +274,10 @@ EventData DoFFT::Launch(size_t tag) {
       } else if (sym_type == SymbolType::kCalUL) {
         sample_offset = cfg_->OfdmRxZeroPrefixCalUl();
       }
-      SimdConvertShortToFloat(&pkt->data_[2 * sample_offset],
-                              reinterpret_cast<float*>(fft_inout_),
-                              cfg_->OfdmCaNum() * 2);
+      // Scaling by 1 / 32768 happens inside the FFT via DFTI_FORWARD_SCALE
+      SimdConvertShortToFloatUnscaled(&pkt->data_[2 * sample_offset],
+                                      reinterpret_cast<float*>(fft_inout_),
+                                      ofdm_ca_num * 2);
     }
     if (kDebugPrintInTask) {
       std::printf("In doFFT thread %d: frame: %zu, symbol: %zu, ant: %zu\n",
@@ -150,7 +317,7 @@ EventData DoFFT::Launch(size_t tag) {
     if (kPrintFFTInput) {
       std::stringstream ss;
       ss << "FFT_input_" << symbol_id << "_" << ant_id << "=[";
-      for (size_t i = 0; i < cfg_->OfdmCaNum(); i++) {
+      for (size_t i = 0; i < ofdm_ca_num; i++) {
         ss << std::fixed << std::setw(5) << std::setprecision(3)
            << fft_inout_[i].re << "+1j*" << fft_inout_[i].im << " ";
       }
@@ -159,12 +326,25 @@ EventData DoFFT::Launch(size_t tag) {
     }
   }
 
+  if ((cfo_phase_per_sample_ != nullptr) &&
+      (sym_type == SymbolType::kPilot) && (cfg_->FftInRru() == false)) {
+    // De-rotate this UE's pilot before the FFT. Data symbols superimpose
+    // all UEs and get no time-domain correction; their residual is
+    // absorbed by DoDemul's post-equalization phase tracking
+    CompensateCfo(cfg_->Frame().GetPilotSymbolIdx(symbol_id));
+  }
+
   DurationStat dummy_duration_stat;  // TODO: timing for calibration symbols
   DurationStat* duration_stat = nullptr;
+  // No dummy histogram for calibration symbols: zeroing its buckets on the
+  // stack every Launch would cost more than the task timing is worth
+  LatencyHistogram* duration_hist = nullptr;
   if (sym_type == SymbolType::kUL) {
     duration_stat = duration_stat_fft_;
+    duration_hist = duration_hist_fft_;
   } else if (sym_type == SymbolType::kPilot) {
     duration_stat = duration_stat_csi_;
+    duration_hist = duration_hist_csi_;
   } else {
     duration_stat = &dummy_duration_stat;  // For calibration symbols
   }
@@ -173,9 +353,20 @@ EventData DoFFT::Launch(size_t tag) {
   duration_stat->task_duration_[1] += start_tsc1 - start_tsc;
 
   if (!cfg_->FftInRru() == true) {
-    DftiComputeForward(
-        mkl_handle_,
-        reinterpret_cast<float*>(fft_inout_));  // Compute FFT in-place
+    if ((use_pruned_fft_ == true) &&
+        ((sym_type == SymbolType::kUL) ||
+         ((sym_type == SymbolType::kPilot) && (kCollectPhyStats == false)))) {
+      // Uplink data consumers only read the occupied bins, so compute just
+      // those. Pilots can take the same fast path when SNR collection is
+      // compiled out; otherwise they and the calibration symbols keep the
+      // full transform, since SNR estimation reads the guard bins for the
+      // noise floor.
+      PrunedFft();
+    } else {
+      DftiComputeForward(
+          mkl_handle_,
+          reinterpret_cast<float*>(fft_inout_));  // Compute FFT in-place
+    }
   }
 
   size_t start_tsc2 = GetTime::WorkerRdtsc();
@@ -187,8 +378,20 @@ EventData DoFFT::Launch(size_t tag) {
       phy_stats_->UpdatePilotSnr(frame_id, pilot_symbol_id, ant_id, fft_inout_);
     }
     const size_t ue_id = pilot_symbol_id;
-    PartialTranspose(csi_buffers_[frame_slot][ue_id], ant_id,
-                     SymbolType::kPilot);
+    if (cfg_->CsiFp16() == true) {
+      PartialTransposeCsiFp16(csi_buffers_[frame_slot][ue_id], ant_id);
+    } else {
+      PartialTranspose(csi_buffers_[frame_slot][ue_id], ant_id,
+                       SymbolType::kPilot);
+      if (cfg_->CsiInterpSpacing() > 1) {
+        InterpolateCsi(csi_buffers_[frame_slot][ue_id], ant_id);
+      }
+      if ((cfo_phase_per_sample_ != nullptr) && (ant_id == 0) &&
+          (frame_id > 0)) {
+        // Antenna 0's task is the per-UE estimate's single writer
+        EstimateCfo(frame_id, ue_id);
+      }
+    }
   } else if (sym_type == SymbolType::kUL) {
     PartialTranspose(cfg_->GetDataBuf(data_buffer_, frame_id, symbol_id),
                      ant_id, SymbolType::kUL);
@@ -200,7 +403,7 @@ EventData DoFFT::Launch(size_t tag) {
         ant_id / cfg_->AntPerGroup() ==
             (frame_id - TX_FRAME_DELTA) % cfg_->AntGroupNum()) {
       size_t frame_grp_id = (frame_id - TX_FRAME_DELTA) / cfg_->AntGroupNum();
-      size_t frame_grp_slot = frame_grp_id % kFrameWnd;
+      size_t frame_grp_slot = frame_grp_id % cfg_->FrameWnd();
       PartialTranspose(
           &calib_ul_buffer_[frame_grp_slot][ant_id * cfg_->OfdmDataNum()],
           ant_id, sym_type);
@@ -210,7 +413,7 @@ EventData DoFFT::Launch(size_t tag) {
              ant_id == cfg_->RefAnt(cell_id)) {
     if (frame_id >= TX_FRAME_DELTA) {
       size_t frame_grp_id = (frame_id - TX_FRAME_DELTA) / cfg_->AntGroupNum();
-      size_t frame_grp_slot = frame_grp_id % kFrameWnd;
+      size_t frame_grp_slot = frame_grp_id % cfg_->FrameWnd();
       size_t cal_dl_symbol_id = symbol_id - cfg_->Frame().GetDLCalSymbol(0);
       size_t cur_ant = ((frame_id - TX_FRAME_DELTA) % cfg_->AntGroupNum()) *
                            cfg_->AntPerGroup() +
@@ -232,21 +435,173 @@ EventData DoFFT::Launch(size_t tag) {
 
   duration_stat->task_duration_[3] += GetTime::WorkerRdtsc() - start_tsc2;
 
-  fft_req_tag_t(tag).rx_packet_->Free();
+  // Chained dispatch runs after the transposed output is written, so the
+  // release on the shared count publishes this antenna's data to whichever
+  // worker picks up the demul tasks
+  if (sym_type == SymbolType::kUL) {
+    ChainedDemulIfLastFft(frame_id, symbol_id);
+  }
+
+  // In frame-epoch reclamation mode the RX thread reuses the slot once
+  // the frame completes; there is no per-packet reference to drop
+  if (cfg_->RxEpochReclaim() == false) {
+    fft_req_tag_t(tag).rx_packet_->Free();
+  }
+  const size_t task_cycles = GetTime::WorkerRdtsc() - start_tsc;
   duration_stat->task_count_++;
-  duration_stat->task_duration_[0] += GetTime::WorkerRdtsc() - start_tsc;
-  return EventData(EventType::kFFT,
-                   gen_tag_t::FrmSym(pkt->frame_id_, pkt->symbol_id_).tag_);
+  duration_stat->task_duration_[0] += task_cycles;
+  if (duration_hist != nullptr) {
+    duration_hist->Record(task_cycles);
+  }
+  // The antenna id rides along so the master can track FFT completions in
+  // a per-antenna bitmap instead of a bare count
+  return EventData(
+      EventType::kFFT,
+      gen_tag_t::FrmSymAnt(pkt->frame_id_, pkt->symbol_id_, ant_id).tag_);
+}
+
+void DoFFT::CompensateCfo(size_t ue_id) {
+  const float omega =
+      cfo_phase_per_sample_[ue_id].load(std::memory_order_relaxed);
+  if (omega == 0.0f) {
+    return;  // No estimate yet (or a perfectly locked oscillator)
+  }
+  // Rotate sample n by exp(-j * omega * n). The phasor advances by a
+  // complex recurrence with periodic renormalization, so the loop is two
+  // complex multiplies per sample and no trig
+  const float step_re = std::cos(omega);
+  const float step_im = -std::sin(omega);
+  float cur_re = 1.0f;
+  float cur_im = 0.0f;
+  const size_t num_samps = cfg_->OfdmCaNum();
+  for (size_t n = 0; n < num_samps; n++) {
+    const float re = fft_inout_[n].re;
+    const float im = fft_inout_[n].im;
+    fft_inout_[n].re = (re * cur_re) - (im * cur_im);
+    fft_inout_[n].im = (re * cur_im) + (im * cur_re);
+    const float next_re = (cur_re * step_re) - (cur_im * step_im);
+    cur_im = (cur_re * step_im) + (cur_im * step_re);
+    cur_re = next_re;
+    if ((n & 0xFF) == 0xFF) {
+      // Pin the recurrence back onto the unit circle
+      const float inv_mag =
+          1.0f / std::sqrt((cur_re * cur_re) + (cur_im * cur_im));
+      cur_re *= inv_mag;
+      cur_im *= inv_mag;
+    }
+  }
+}
+
+void DoFFT::EstimateCfo(size_t frame_id, size_t ue_id) {
+  const complex_float* cur = csi_buffers_[frame_id % cfg_->FrameWnd()][ue_id];
+  const complex_float* prev =
+      csi_buffers_[(frame_id - 1) % cfg_->FrameWnd()][ue_id];
+  // Phase of sum_sc cur[sc] * conj(prev[sc]): per-bin channel phases
+  // cancel, leaving the common rotation one frame of CFO accumulated.
+  // Unambiguous up to half a cycle per frame, ample for residual offsets
+  float corr_re = 0.0f;
+  float corr_im = 0.0f;
+  const size_t num_sc = cfg_->OfdmDataNum();
+  for (size_t sc = 0; sc < num_sc; sc += kCfoEstScStride) {
+    const size_t off = CsiScOffset(sc, 0);
+    corr_re += (cur[off].re * prev[off].re) + (cur[off].im * prev[off].im);
+    corr_im += (cur[off].im * prev[off].re) - (cur[off].re * prev[off].im);
+  }
+  if ((corr_re == 0.0f) && (corr_im == 0.0f)) {
+    return;  // Previous frame's CSI not populated yet
+  }
+  const float frame_samps = static_cast<float>(
+      cfg_->SampsPerSymbol() * cfg_->Frame().NumTotalSyms());
+  const float omega_new = std::atan2(corr_im, corr_re) / frame_samps;
+  std::atomic<float>& est = cfo_phase_per_sample_[ue_id];
+  const float prev_est = est.load(std::memory_order_relaxed);
+  est.store(((1.0f - kCfoSmoothAlpha) * prev_est) +
+                (kCfoSmoothAlpha * omega_new),
+            std::memory_order_relaxed);
+}
+
+void DoFFT::ChainedDemulIfLastFft(size_t frame_id, size_t symbol_id) {
+  if (chained_fft_task_counts_ == nullptr) {
+    return;
+  }
+  const size_t idx = (cfg_->FrameSlot(frame_id) *
+                      cfg_->Frame().NumULSyms()) +
+                     cfg_->Frame().GetULSymbolIdx(symbol_id);
+  const size_t done =
+      chained_fft_task_counts_[idx].fetch_add(1, std::memory_order_acq_rel) + 1;
+  if (done < cfg_->BsAntNum()) {
+    return;
+  }
+  // Last antenna of this symbol. No further increments for this (frame,
+  // symbol) can arrive, so reset the count here for the slot's next frame
+  chained_fft_task_counts_[idx].store(0, std::memory_order_relaxed);
+
+  const size_t ready_frame =
+      chained_beam_ready_frame_->load(std::memory_order_acquire);
+  if ((ready_frame == SIZE_MAX) || (frame_id > ready_frame)) {
+    // Beamformer not ready: the master schedules this symbol, either when
+    // ZF completes or when it processes this FFT's completion event
+    return;
+  }
+  if (chained_demul_claimed_[idx].exchange(1, std::memory_order_acq_rel) != 0) {
+    return;  // The master got there first
+  }
+
+  // Same fan-out as the master's demul scheduling, range-encoded so each
+  // batch is a single enqueue (RunEvent() expands range events generically)
+  const size_t shard_start = cfg_->ScShardStart();
+  const size_t block_size = cfg_->DemulBlockSize();
+  const size_t num_events = cfg_->DemulEventsPerSymbol();
+  const size_t batch_size = std::max(cfg_->DemulBatchSize(), size_t{1});
+  const size_t tag_stride =
+      gen_tag_t::FrmSymSc(frame_id, symbol_id, shard_start + block_size).tag_ -
+      gen_tag_t::FrmSymSc(frame_id, symbol_id, shard_start).tag_;
+  moodycamel::ConcurrentQueue<EventData>* queue =
+      chained_demul_queues_.at(frame_id % chained_demul_queues_.size());
+  for (size_t i = 0; i < num_events; i += batch_size) {
+    const size_t count = std::min(batch_size, num_events - i);
+    EventData event(EventType::kDemul,
+                    gen_tag_t::FrmSymSc(frame_id, symbol_id,
+                                        shard_start + (i * block_size))
+                        .tag_,
+                    count, tag_stride);
+    queue->enqueue(event);
+  }
+}
+
+void DoFFT::InterpolateCsi(complex_float* csi_buf, size_t ant_id) const {
+  const size_t spacing = cfg_->CsiInterpSpacing();
+  const size_t data_num = cfg_->OfdmDataNum();
+  const size_t last_measured = ((data_num - 1) / spacing) * spacing;
+
+  for (size_t base = 0; base < last_measured; base += spacing) {
+    const complex_float left = csi_buf[CsiScOffset(base, ant_id)];
+    const complex_float right = csi_buf[CsiScOffset(base + spacing, ant_id)];
+    for (size_t k = 1; k < spacing; k++) {
+      const float w = static_cast<float>(k) / static_cast<float>(spacing);
+      complex_float& out = csi_buf[CsiScOffset(base + k, ant_id)];
+      out.re = (left.re * (1.0f - w)) + (right.re * w);
+      out.im = (left.im * (1.0f - w)) + (right.im * w);
+    }
+  }
+  // Hold the last measured estimate across the tail of the band
+  const complex_float last = csi_buf[CsiScOffset(last_measured, ant_id)];
+  for (size_t sc = last_measured + 1; sc < data_num; sc++) {
+    csi_buf[CsiScOffset(sc, ant_id)] = last;
+  }
 }
 
 void DoFFT::PartialTranspose(complex_float* out_buf, size_t ant_id,
                              SymbolType symbol_type) const {
-  // We have OfdmDataNum() % kTransposeBlockSize == 0
-  const size_t num_blocks = cfg_->OfdmDataNum() / kTransposeBlockSize;
+  // We have OfdmDataNum() % kTransposeBlockSize == 0. Compile-time
+  // constants under a build profile (see build_profile.h).
+  const size_t bs_ant_num = BuildProfile::BsAntNum(cfg_->BsAntNum());
+  const size_t ofdm_data_num = BuildProfile::OfdmDataNum(cfg_->OfdmDataNum());
+  const size_t num_blocks = ofdm_data_num / kTransposeBlockSize;
 
   for (size_t block_idx = 0; block_idx < num_blocks; block_idx++) {
     const size_t block_base_offset =
-        block_idx * (kTransposeBlockSize * cfg_->BsAntNum());
+        block_idx * (kTransposeBlockSize * bs_ant_num);
     // We have kTransposeBlockSize % kSCsPerCacheline == 0
     for (size_t sc_j = 0; sc_j < kTransposeBlockSize;
          sc_j += kSCsPerCacheline) {
@@ -261,7 +616,7 @@ void DoFFT::PartialTranspose(complex_float* out_buf, size_t ant_id,
         dst = kUsePartialTrans
                   ? &out_buf[block_base_offset +
                              (ant_id * kTransposeBlockSize) + sc_j]
-                  : &out_buf[(cfg_->OfdmDataNum() * ant_id) + sc_j +
+                  : &out_buf[(ofdm_data_num * ant_id) + sc_j +
                              block_idx * kTransposeBlockSize];
       }
 
@@ -272,15 +627,11 @@ void DoFFT::PartialTranspose(complex_float* out_buf, size_t ant_id,
       // AVX-512.
       __m512 fft_result = _mm512_load_ps(reinterpret_cast<const float*>(src));
       if (symbol_type == SymbolType::kPilot) {
-        __m512 pilot_tx = _mm512_set_ps(
-            cfg_->PilotsSgn()[sc_idx + 7].im, cfg_->PilotsSgn()[sc_idx + 7].re,
-            cfg_->PilotsSgn()[sc_idx + 6].im, cfg_->PilotsSgn()[sc_idx + 6].re,
-            cfg_->PilotsSgn()[sc_idx + 5].im, cfg_->PilotsSgn()[sc_idx + 5].re,
-            cfg_->PilotsSgn()[sc_idx + 4].im, cfg_->PilotsSgn()[sc_idx + 4].re,
-            cfg_->PilotsSgn()[sc_idx + 3].im, cfg_->PilotsSgn()[sc_idx + 3].re,
-            cfg_->PilotsSgn()[sc_idx + 2].im, cfg_->PilotsSgn()[sc_idx + 2].re,
-            cfg_->PilotsSgn()[sc_idx + 1].im, cfg_->PilotsSgn()[sc_idx + 1].re,
-            cfg_->PilotsSgn()[sc_idx].im, cfg_->PilotsSgn()[sc_idx].re);
+        // pilots_sgn_ is 64-byte aligned and sc_idx is a multiple of
+        // kSCsPerCacheline, so the cacheline of interleaved IQ pairs can be
+        // loaded directly in memory order
+        const __m512 pilot_tx = _mm512_load_ps(
+            reinterpret_cast<const float*>(&cfg_->PilotsSgn()[sc_idx]));
         fft_result = CommsLib::M512ComplexCf32Mult(fft_result, pilot_tx, true);
       }
       _mm512_stream_ps(reinterpret_cast<float*>(dst), fft_result);
@@ -289,19 +640,16 @@ void DoFFT::PartialTranspose(complex_float* out_buf, size_t ant_id,
       __m256 fft_result1 =
           _mm256_load_ps(reinterpret_cast<const float*>(src + 4));
       if (symbol_type == SymbolType::kPilot) {
-        __m256 pilot_tx0 = _mm256_set_ps(
-            cfg_->PilotsSgn()[sc_idx + 3].im, cfg_->PilotsSgn()[sc_idx + 3].re,
-            cfg_->PilotsSgn()[sc_idx + 2].im, cfg_->PilotsSgn()[sc_idx + 2].re,
-            cfg_->PilotsSgn()[sc_idx + 1].im, cfg_->PilotsSgn()[sc_idx + 1].re,
-            cfg_->PilotsSgn()[sc_idx].im, cfg_->PilotsSgn()[sc_idx].re);
+        // pilots_sgn_ is 64-byte aligned and sc_idx is a multiple of
+        // kSCsPerCacheline, so the interleaved IQ pairs can be loaded
+        // directly in memory order
+        const __m256 pilot_tx0 = _mm256_load_ps(
+            reinterpret_cast<const float*>(&cfg_->PilotsSgn()[sc_idx]));
         fft_result0 =
             CommsLib::M256ComplexCf32Mult(fft_result0, pilot_tx0, true);
 
-        __m256 pilot_tx1 = _mm256_set_ps(
-            cfg_->PilotsSgn()[sc_idx + 7].im, cfg_->PilotsSgn()[sc_idx + 7].re,
-            cfg_->PilotsSgn()[sc_idx + 6].im, cfg_->PilotsSgn()[sc_idx + 6].re,
-            cfg_->PilotsSgn()[sc_idx + 5].im, cfg_->PilotsSgn()[sc_idx + 5].re,
-            cfg_->PilotsSgn()[sc_idx + 4].im, cfg_->PilotsSgn()[sc_idx + 4].re);
+        const __m256 pilot_tx1 = _mm256_load_ps(
+            reinterpret_cast<const float*>(&cfg_->PilotsSgn()[sc_idx + 4]));
         fft_result1 =
             CommsLib::M256ComplexCf32Mult(fft_result1, pilot_tx1, true);
       }
@@ -311,3 +659,54 @@ void DoFFT::PartialTranspose(complex_float* out_buf, size_t ant_id,
     }
   }
 }
+
+void DoFFT::PartialTransposeCsiFp16(complex_float* out_buf,
+                                    size_t ant_id) const {
+  // Same element indexing as the kPilot path of PartialTranspose(), but each
+  // complex sample is stored as 2 x fp16 (4 bytes). The fp32 element offset
+  // therefore doubles as the uint16 pair offset into the halved buffer.
+  const size_t bs_ant_num = BuildProfile::BsAntNum(cfg_->BsAntNum());
+  const size_t ofdm_data_num = BuildProfile::OfdmDataNum(cfg_->OfdmDataNum());
+  const size_t num_blocks = ofdm_data_num / kTransposeBlockSize;
+  auto* out16 = reinterpret_cast<uint16_t*>(out_buf);
+
+  for (size_t block_idx = 0; block_idx < num_blocks; block_idx++) {
+    const size_t block_base_offset =
+        block_idx * (kTransposeBlockSize * bs_ant_num);
+    for (size_t sc_j = 0; sc_j < kTransposeBlockSize;
+         sc_j += kSCsPerCacheline) {
+      const size_t sc_idx = (block_idx * kTransposeBlockSize) + sc_j;
+      const complex_float* src = &fft_inout_[sc_idx + cfg_->OfdmDataStart()];
+
+      const size_t elem_offset =
+          kUsePartialTrans
+              ? block_base_offset + (ant_id * kTransposeBlockSize) + sc_j
+              : (ofdm_data_num * ant_id) + sc_j +
+                    block_idx * kTransposeBlockSize;
+      uint16_t* dst = &out16[elem_offset * 2];
+
+#ifdef __AVX512F__
+      __m512 fft_result = _mm512_load_ps(reinterpret_cast<const float*>(src));
+      const __m512 pilot_tx = _mm512_load_ps(
+          reinterpret_cast<const float*>(&cfg_->PilotsSgn()[sc_idx]));
+      fft_result = CommsLib::M512ComplexCf32Mult(fft_result, pilot_tx, true);
+      _mm256_stream_si256(reinterpret_cast<__m256i*>(dst),
+                          _mm512_cvtps_ph(fft_result, _MM_FROUND_NO_EXC));
+#else
+      __m256 fft_result0 = _mm256_load_ps(reinterpret_cast<const float*>(src));
+      __m256 fft_result1 =
+          _mm256_load_ps(reinterpret_cast<const float*>(src + 4));
+      const __m256 pilot_tx0 = _mm256_load_ps(
+          reinterpret_cast<const float*>(&cfg_->PilotsSgn()[sc_idx]));
+      fft_result0 = CommsLib::M256ComplexCf32Mult(fft_result0, pilot_tx0, true);
+      const __m256 pilot_tx1 = _mm256_load_ps(
+          reinterpret_cast<const float*>(&cfg_->PilotsSgn()[sc_idx + 4]));
+      fft_result1 = CommsLib::M256ComplexCf32Mult(fft_result1, pilot_tx1, true);
+      _mm_stream_si128(reinterpret_cast<__m128i*>(dst),
+                       _mm256_cvtps_ph(fft_result0, _MM_FROUND_NO_EXC));
+      _mm_stream_si128(reinterpret_cast<__m128i*>(dst + 8),
+                       _mm256_cvtps_ph(fft_result1, _MM_FROUND_NO_EXC));
+#endif
+    }
+  }
+}
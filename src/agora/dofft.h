@@ -62,6 +62,41 @@ class DoFFT : public Doer {
    */
   EventData Launch(size_t tag) override;
 
+  /// Enable chained FFT->demul dispatch: the worker that finishes the last
+  /// antenna's FFT of an uplink data symbol enqueues the symbol's demul
+  /// range event into the task queue itself when the beamformer is already
+  /// ready, skipping the completion -> master -> schedule round trip. The
+  /// master keeps its counters from the (still delivered) completion
+  /// events and claims any symbol the workers could not chain (beamformer
+  /// not ready yet) when ZF finishes; the per-symbol claim flags make the
+  /// two paths schedule each symbol exactly once.
+  ///
+  /// @param demul_queues One demul task queue per schedule queue id
+  /// @param num_queues Number of schedule queues (tasks for frame f go to
+  ///        queue f % num_queues)
+  /// @param fft_task_counts Per (frame slot, uplink symbol) FFT completion
+  ///        counts, shared by all DoFFT instances
+  /// @param demul_claimed Per (frame slot, uplink symbol) claim flags,
+  ///        shared with the master
+  /// @param beam_ready_frame Latest frame with ready beamweights,
+  ///        published by the master on ZF completion
+  /// Attach the per-UE CFO estimates (one smoothed phase-per-sample entry
+  /// per UE antenna, owned by Agora and shared by all DoFFT instances).
+  /// Enables the cfo_correction pilot de-rotation and estimation paths.
+  void SetCfoTracker(std::atomic<float>* phase_per_sample) {
+    cfo_phase_per_sample_ = phase_per_sample;
+  }
+
+  void SetChainedDemul(moodycamel::ConcurrentQueue<EventData>* const* demul_queues,
+                       size_t num_queues, std::atomic<size_t>* fft_task_counts,
+                       std::atomic<uint8_t>* demul_claimed,
+                       const std::atomic<size_t>* beam_ready_frame) {
+    chained_demul_queues_.assign(demul_queues, demul_queues + num_queues);
+    chained_fft_task_counts_ = fft_task_counts;
+    chained_demul_claimed_ = demul_claimed;
+    chained_beam_ready_frame_ = beam_ready_frame;
+  }
+
   /**
    * Fill-in the partial transpose of the computed FFT for this antenna into
    * out_buf.
@@ -96,6 +131,59 @@ class DoFFT : public Doer {
                         SymbolType symbol_type) const;
 
  private:
+  /// Half-precision variant of PartialTranspose() for pilot symbols with
+  /// csi_fp16: same layout and element indexing, but each complex CSI
+  /// sample is stored as 2 x fp16 (4 bytes), halving csi_buffers_. DoZF
+  /// expands back to fp32 during its gather pass.
+  void PartialTransposeCsiFp16(complex_float* out_buf, size_t ant_id) const;
+
+  /// Compute only the occupied data bins of fft_inout_ with a pruned
+  /// (transform-decomposition) FFT: prune_n1_ interleaved sub-FFTs of size
+  /// prune_n2_ followed by a twiddle recombination restricted to the
+  /// [OfdmDataStart, OfdmDataStop) band. Guard bins are left untouched, so
+  /// this is only valid for symbols whose consumers read data bins only.
+  void PrunedFft();
+
+  /// Pick the sub-FFT split and build the batched descriptor and twiddle
+  /// table for PrunedFft(). Returns false if pruning is disabled or not
+  /// profitable for this band occupancy.
+  bool SetupPrunedFft(bool fold_scale);
+
+  /// Multiply the converted time-domain pilot samples by the compensating
+  /// phase ramp for ue_id's current CFO estimate. Runs between input
+  /// conversion and the FFT, so no extra buffer walk; the phasor advances
+  /// by complex recurrence instead of per-sample trig
+  void CompensateCfo(size_t ue_id);
+
+  /// Update ue_id's smoothed CFO estimate from the phase of the
+  /// correlation between this frame's and the previous frame's CSI for
+  /// antenna 0 (a single antenna keeps the estimate single-writer per
+  /// pilot task). Per-symbol de-rotation starts each pilot at phase zero,
+  /// so the frame-to-frame progression still measures the full offset
+  void EstimateCfo(size_t frame_id, size_t ue_id);
+
+  /// Chained-mode hook run after an uplink data symbol's FFT output is
+  /// written (or the antenna was shed): count this antenna's completion
+  /// and, when it was the symbol's last and the beamweights are ready,
+  /// claim the symbol and enqueue its demul range event directly
+  void ChainedDemulIfLastFft(size_t frame_id, size_t symbol_id);
+
+  /// With decimated pilots (Config::CsiInterpSpacing() > 1), fill in this
+  /// antenna's CSI for the unmeasured subcarriers by linear interpolation
+  /// between the measured ones, directly in the layout PartialTranspose
+  /// wrote. Subcarriers past the last measured one hold its value.
+  void InterpolateCsi(complex_float* csi_buf, size_t ant_id) const;
+
+  /// Offset of one antenna's CSI sample for subcarrier sc in the (partially
+  /// transposed) pilot output layout of PartialTranspose().
+  inline size_t CsiScOffset(size_t sc, size_t ant_id) const {
+    if (kUsePartialTrans) {
+      const size_t block_idx = sc / kTransposeBlockSize;
+      return (block_idx * kTransposeBlockSize * cfg_->BsAntNum()) +
+             (ant_id * kTransposeBlockSize) + (sc % kTransposeBlockSize);
+    }
+    return (cfg_->OfdmDataNum() * ant_id) + sc;
+  }
   Table<complex_float>& data_buffer_;
   PtrGrid<kFrameWnd, kMaxUEs, complex_float>& csi_buffers_;
   Table<complex_float>& calib_dl_buffer_;
@@ -103,12 +191,34 @@ class DoFFT : public Doer {
   DFTI_DESCRIPTOR_HANDLE mkl_handle_;
   complex_float* fft_inout_;  // Buffer for both FFT input and output
 
+  // Pruned-FFT state, used for uplink data symbols when the occupied band
+  // is narrow enough (see Config::FftPruneThresh())
+  bool use_pruned_fft_;
+  size_t prune_n1_;  // Number of interleaved sub-FFTs
+  size_t prune_n2_;  // Size of each sub-FFT (OfdmCaNum() / prune_n1_)
+  DFTI_DESCRIPTOR_HANDLE mkl_pruned_handle_;
+  complex_float* prune_sub_ffts_;  // Sub-FFT outputs, prune_n1_ x prune_n2_
+  complex_float* prune_twiddles_;  // Recombination twiddles, per data bin
+
   // Buffer for store 16-bit IQ converted from 12-bit IQ
   uint16_t* temp_16bits_iq_;
   std::complex<float>* rx_samps_tmp_;  // Temp buffer for received samples
 
+  // Set only in chained FFT->demul mode (see SetChainedDemul); shared
+  // between all DoFFT instances and the master
+  std::vector<moodycamel::ConcurrentQueue<EventData>*> chained_demul_queues_;
+  std::atomic<size_t>* chained_fft_task_counts_ = nullptr;
+  std::atomic<uint8_t>* chained_demul_claimed_ = nullptr;
+  const std::atomic<size_t>* chained_beam_ready_frame_ = nullptr;
+
+  // Per-UE smoothed CFO estimates in radians per sample, set only in
+  // cfo_correction mode (see SetCfoTracker)
+  std::atomic<float>* cfo_phase_per_sample_ = nullptr;
+
   DurationStat* duration_stat_fft_;
   DurationStat* duration_stat_csi_;
+  LatencyHistogram* duration_hist_fft_;
+  LatencyHistogram* duration_hist_csi_;
   PhyStats* phy_stats_;
 };
 
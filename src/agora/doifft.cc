@@ -6,11 +6,16 @@
 
 #include "concurrent_queue_wrapper.h"
 #include "datatype_conversion.h"
+#include "fft_plan_cache.h"
 
 static constexpr bool kPrintIFFTOutput = false;
 static constexpr bool kPrintSocketOutput = false;
-static constexpr bool kUseOutOfPlaceIFFT = false;
-static constexpr bool kMemcpyBeforeIFFT = true;
+// The out-of-place IFFT reads dl_ifft_buffer_ directly, skipping the
+// full-symbol copy of the memcpy variant. This is safe without zeroing the
+// guard bins per call: dl_ifft_buffer_ is calloc'd and DoPrecode only ever
+// writes the [OfdmDataStart, OfdmDataStop) bins, so the guards stay zero
+static constexpr bool kUseOutOfPlaceIFFT = true;
+static constexpr bool kMemcpyBeforeIFFT = false;
 
 DoIFFT::DoIFFT(Config* in_config, int in_tid,
                Table<complex_float>& in_dl_ifft_buffer,
@@ -19,29 +24,29 @@ DoIFFT::DoIFFT(Config* in_config, int in_tid,
       dl_ifft_buffer_(in_dl_ifft_buffer),
       dl_socket_buffer_(in_dl_socket_buffer) {
   duration_stat_ = in_stats_manager->GetDurationStat(DoerType::kIFFT, in_tid);
-  DftiCreateDescriptor(&mkl_handle_, DFTI_SINGLE, DFTI_COMPLEX, 1,
-                       cfg_->OfdmCaNum());
-  if (kUseOutOfPlaceIFFT) {
-    DftiSetValue(mkl_handle_, DFTI_PLACEMENT, DFTI_NOT_INPLACE);
-  }
-  DftiCommitDescriptor(mkl_handle_);
-
-  // Aligned for SIMD
-  ifft_out_ = static_cast<float*>(
-      Agora_memory::PaddedAlignedAlloc(Agora_memory::Alignment_t::kAlign64,
-                                       2 * cfg_->OfdmCaNum() * sizeof(float)));
+  duration_hist_ = in_stats_manager->GetDurationHist(DoerType::kIFFT, in_tid);
+  RegisterTaskStats(&duration_stat_, &duration_hist_);
+  mkl_handle_ = kUseOutOfPlaceIFFT
+                    ? FftPlanCache::ComplexOutOfPlace(cfg_->OfdmCaNum())
+                    : FftPlanCache::Complex(cfg_->OfdmCaNum());
+
+  // Per-thread transform workspace, shared with DoFFT instances on this
+  // thread. Sized like DoFFT's request so neither doer regrows it
+  ifft_out_ = static_cast<float*>(Agora_memory::GetFftScratch(
+      2 * cfg_->OfdmCaNum() * sizeof(complex_float)));
   ifft_scale_factor_ = cfg_->OfdmCaNum() / std::sqrt(cfg_->BfAntNum() * 1.f);
 }
 
 DoIFFT::~DoIFFT() {
-  DftiFreeDescriptor(&mkl_handle_);
-  std::free(ifft_out_);
+  // mkl_handle_ is owned by FftPlanCache, ifft_out_ by the per-thread
+  // workspace
 }
 
 EventData DoIFFT::Launch(size_t tag) {
   size_t start_tsc = GetTime::WorkerRdtsc();
 
   const size_t frame_id = gen_tag_t(tag).frame_id_;
+  CheckFrameSlotOwner(frame_id);
   const size_t symbol_id = gen_tag_t(tag).symbol_id_;
   const size_t ant_id = gen_tag_t(tag).ant_id_;
 
@@ -100,14 +105,27 @@ EventData DoIFFT::Launch(size_t tag) {
   size_t start_tsc2 = GetTime::WorkerRdtsc();
   duration_stat_->task_duration_[2] += start_tsc2 - start_tsc1;
 
-  auto* pkt = reinterpret_cast<struct Packet*>(
-      &dl_socket_buffer_[offset * cfg_->DlPacketLength()]);
-  short* socket_ptr = &pkt->data_[2 * cfg_->OfdmTxZeroPrefix()];
+  // dl_socket_buffer_ holds payloads only (no Packet header gaps); the
+  // TX threads gather the header onto the wire at send time. The TX zero
+  // prefix/postfix guard samples around this write were zeroed once at
+  // allocation and are never touched per symbol
+  short* socket_ptr =
+      reinterpret_cast<short*>(
+          &dl_socket_buffer_[offset * cfg_->DlPayloadLength()]) +
+      (2 * cfg_->OfdmTxZeroPrefix());
 
   // IFFT scaled results by OfdmCaNum(), we scale down IFFT results
   // during data type coversion
-  SimdConvertFloatToShort(ifft_out_ptr, socket_ptr, cfg_->OfdmCaNum(),
-                          cfg_->CpLen(), ifft_scale_factor_);
+  if (cfg_->ClipIqThresh() > 0.0) {
+    // Polar-clip high-magnitude samples in the same pass for PAPR control
+    SimdConvertFloatToShortClipped(
+        ifft_out_ptr, socket_ptr, cfg_->OfdmCaNum(), cfg_->CpLen(),
+        ifft_scale_factor_,
+        static_cast<float>(cfg_->ClipIqThresh()) * 32768.0f);
+  } else {
+    SimdConvertFloatToShort(ifft_out_ptr, socket_ptr, cfg_->OfdmCaNum(),
+                            cfg_->CpLen(), ifft_scale_factor_);
+  }
 
   duration_stat_->task_duration_[3] += GetTime::WorkerRdtsc() - start_tsc2;
 
@@ -121,7 +139,9 @@ EventData DoIFFT::Launch(size_t tag) {
     std::cout << ss.str();
   }
 
+  const size_t task_cycles = GetTime::WorkerRdtsc() - start_tsc;
   duration_stat_->task_count_++;
-  duration_stat_->task_duration_[0] += GetTime::WorkerRdtsc() - start_tsc;
+  duration_stat_->task_duration_[0] += task_cycles;
+  duration_hist_->Record(task_cycles);
   return EventData(EventType::kIFFT, tag);
 }
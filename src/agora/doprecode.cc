@@ -5,21 +5,26 @@
 #include "doprecode.h"
 
 #include "concurrent_queue_wrapper.h"
+#include "doifft.h"
 
 static constexpr bool kUseSpatialLocality = true;
 
 DoPrecode::DoPrecode(
     Config* in_config, int in_tid,
     PtrGrid<kFrameWnd, kMaxDataSCs, complex_float>& dl_zf_matrices,
-    Table<complex_float>& in_dl_ifft_buffer,
+    Table<bool>& dl_zf_unchanged, Table<complex_float>& in_dl_ifft_buffer,
     Table<int8_t>& dl_encoded_or_raw_data /* Encoded if LDPC is enabled */,
     Stats* in_stats_manager)
     : Doer(in_config, in_tid),
       dl_zf_matrices_(dl_zf_matrices),
+      dl_zf_unchanged_(dl_zf_unchanged),
       dl_ifft_buffer_(in_dl_ifft_buffer),
       dl_raw_data_(dl_encoded_or_raw_data) {
   duration_stat_ =
       in_stats_manager->GetDurationStat(DoerType::kPrecode, in_tid);
+  duration_hist_ =
+      in_stats_manager->GetDurationHist(DoerType::kPrecode, in_tid);
+  RegisterTaskStats(&duration_stat_, &duration_hist_);
 
   AllocBuffer1d(&modulated_buffer_temp_, kSCsPerCacheline * cfg_->UeAntNum(),
                 Agora_memory::Alignment_t::kAlign64, 0);
@@ -27,6 +32,11 @@ DoPrecode::DoPrecode(
                 cfg_->DemulBlockSize() * cfg_->BsAntNum(),
                 Agora_memory::Alignment_t::kAlign64, 0);
 
+  if (cfg_->SmallLinalgKernels() == true) {
+    precode_cgemv_ =
+        small_linalg::SelectCgemv(cfg_->BsAntNum(), cfg_->UeAntNum());
+  }
+
 #if USE_MKL_JIT
   MKL_Complex8 alpha = {1, 0};
   MKL_Complex8 beta = {0, 0};
@@ -64,12 +74,13 @@ DoPrecode::~DoPrecode() {
 EventData DoPrecode::Launch(size_t tag) {
   size_t start_tsc = GetTime::WorkerRdtsc();
   const size_t frame_id = gen_tag_t(tag).frame_id_;
+  CheckFrameSlotOwner(frame_id);
   const size_t base_sc_id = gen_tag_t(tag).sc_id_;
   const size_t symbol_id = gen_tag_t(tag).symbol_id_;
   const size_t symbol_idx_dl = cfg_->Frame().GetDLSymbolIdx(symbol_id);
   const size_t total_data_symbol_idx =
       cfg_->GetTotalDataSymbolIdxDl(frame_id, symbol_idx_dl);
-  const size_t frame_slot = frame_id % kFrameWnd;
+  const size_t frame_slot = frame_id % cfg_->FrameWnd();
 
   // Mark pilot subcarriers in this block
   // In downlink pilot symbols, all subcarriers are used as pilots
@@ -98,6 +109,46 @@ EventData DoPrecode::Launch(size_t tag) {
   size_t max_sc_ite =
       std::min(cfg_->DemulBlockSize(), cfg_->OfdmDataNum() - base_sc_id);
 
+  // In downlink pilot symbols the input is frame-invariant, so when ZF's
+  // near-static cache carried every beamweight in this block over from the
+  // previous frame unchanged, the precoded output matches the previous
+  // frame's and can be copied from its IFFT rows, skipping the modulation
+  // gather and the gemms. The agora-side IFFT is out of place (doifft.cc),
+  // so those rows still hold frequency-domain data; by the time this
+  // frame's ZF has finished, the previous frame's downlink pilots (whose
+  // precode was scheduled a full frame earlier) are long done
+  if ((cfg_->ZfCacheThreshold() > 0.0) && (frame_id > 0) &&
+      (symbol_idx_dl < cfg_->Frame().ClientDlPilotSymbols())) {
+    bool weights_unchanged = true;
+    for (size_t i = 0; i < max_sc_ite; i++) {
+      if (dl_zf_unchanged_[frame_slot][cfg_->GetZfScId(base_sc_id + i)] ==
+          false) {
+        weights_unchanged = false;
+        break;
+      }
+    }
+    if (weights_unchanged == true) {
+      const size_t prev_data_symbol_idx =
+          cfg_->GetTotalDataSymbolIdxDl(frame_id - 1, symbol_idx_dl);
+      for (size_t ant_id = 0; ant_id < cfg_->BsAntNum(); ant_id++) {
+        std::memcpy(
+            &dl_ifft_buffer_[ant_id +
+                             (cfg_->BsAntNum() * total_data_symbol_idx)]
+                            [base_sc_id + cfg_->OfdmDataStart()],
+            &dl_ifft_buffer_[ant_id +
+                             (cfg_->BsAntNum() * prev_data_symbol_idx)]
+                            [base_sc_id + cfg_->OfdmDataStart()],
+            max_sc_ite * sizeof(complex_float));
+      }
+      duration_stat_->task_count_ += max_sc_ite;
+      const size_t task_cycles = GetTime::WorkerRdtsc() - start_tsc;
+      duration_stat_->task_duration_[0] += task_cycles;
+      duration_hist_->Record(task_cycles);
+      FusedIfftIfLastBlock(frame_id, symbol_id, symbol_idx_dl);
+      return EventData(EventType::kPrecode, tag);
+    }
+  }
+
   if (kUseSpatialLocality) {
     for (size_t i = 0; i < max_sc_ite; i = i + kSCsPerCacheline) {
       size_t start_tsc1 = GetTime::WorkerRdtsc();
@@ -110,8 +161,39 @@ EventData DoPrecode::Launch(size_t tag) {
 
       size_t start_tsc2 = GetTime::WorkerRdtsc();
       duration_stat_->task_duration_[1] += start_tsc2 - start_tsc1;
-      for (size_t j = 0; j < kSCsPerCacheline; j++) {
-        PrecodingPerSc(frame_slot, base_sc_id + i + j, i + j);
+      if (cfg_->PrecodeBatchedGemm()) {
+        // Precode the whole cacheline with one grouped MKL batch-gemm call,
+        // amortizing the per-call dispatch overhead across the subcarriers.
+        // The beamweight matrices live in separately-allocated PtrGrid
+        // slots, so the pointer-array batch interface is used rather than
+        // the strided one.
+        CBLAS_TRANSPOSE transa = CblasNoTrans;
+        CBLAS_TRANSPOSE transb = CblasNoTrans;
+        MKL_INT m = cfg_->BsAntNum();
+        MKL_INT n = 1;
+        MKL_INT k = cfg_->UeAntNum();
+        MKL_INT lda = cfg_->BsAntNum();
+        MKL_INT ldb = cfg_->UeAntNum();
+        MKL_INT ldc = cfg_->BsAntNum();
+        MKL_Complex8 alpha = {1, 0};
+        MKL_Complex8 beta = {0, 0};
+        MKL_INT group_size = kSCsPerCacheline;
+        const void* a_array[kSCsPerCacheline];
+        const void* b_array[kSCsPerCacheline];
+        void* c_array[kSCsPerCacheline];
+        for (size_t j = 0; j < kSCsPerCacheline; j++) {
+          a_array[j] =
+              dl_zf_matrices_[frame_slot][cfg_->GetZfScId(base_sc_id + i + j)];
+          b_array[j] = modulated_buffer_temp_ + j * cfg_->UeAntNum();
+          c_array[j] = precoded_buffer_temp_ + (i + j) * cfg_->BsAntNum();
+        }
+        cblas_cgemm_batch(CblasColMajor, &transa, &transb, &m, &n, &k, &alpha,
+                          a_array, &lda, b_array, &ldb, &beta, c_array, &ldc, 1,
+                          &group_size);
+      } else {
+        for (size_t j = 0; j < kSCsPerCacheline; j++) {
+          PrecodingPerSc(frame_slot, base_sc_id + i + j, i + j);
+        }
       }
       duration_stat_->task_count_ =
           duration_stat_->task_count_ + kSCsPerCacheline;
@@ -153,16 +235,42 @@ EventData DoPrecode::Launch(size_t tag) {
     }
   }
   duration_stat_->task_duration_[3] += GetTime::WorkerRdtsc() - start_tsc3;
-  duration_stat_->task_duration_[0] += GetTime::WorkerRdtsc() - start_tsc;
+  const size_t task_cycles = GetTime::WorkerRdtsc() - start_tsc;
+  duration_stat_->task_duration_[0] += task_cycles;
+  duration_hist_->Record(task_cycles);
   if (kDebugPrintInTask) {
     std::printf(
         "In doPrecode thread %d: finished frame: %zu, symbol: %zu, "
         "subcarrier: %zu\n",
         tid_, frame_id, symbol_id, base_sc_id);
   }
+  FusedIfftIfLastBlock(frame_id, symbol_id, symbol_idx_dl);
   return EventData(EventType::kPrecode, tag);
 }
 
+void DoPrecode::FusedIfftIfLastBlock(size_t frame_id, size_t symbol_id,
+                                     size_t symbol_idx_dl) {
+  if (fused_ifft_ == nullptr) {
+    return;
+  }
+  // The transpose above writes the IFFT rows with streaming stores; fence
+  // them out before other workers can observe the completed-block count
+  _mm_sfence();
+  std::atomic<size_t>& count =
+      fused_task_counts_[(cfg_->FrameSlot(frame_id) *
+                          cfg_->Frame().NumDLSyms()) +
+                         symbol_idx_dl];
+  const size_t blocks_done = count.fetch_add(1) + 1;
+  if (blocks_done == cfg_->DemulEventsPerSymbol()) {
+    // Leave the slot ready for its reuse kFrameWnd frames later
+    count.store(0);
+    for (size_t ant_id = 0; ant_id < cfg_->BsAntNum(); ant_id++) {
+      fused_ifft_->Launch(
+          gen_tag_t::FrmSymAnt(frame_id, symbol_id, ant_id).tag_);
+    }
+  }
+}
+
 void DoPrecode::LoadInputData(size_t symbol_idx_dl,
                               size_t total_data_symbol_idx, size_t user_id,
                               size_t sc_id, size_t sc_id_in_block) {
@@ -191,6 +299,14 @@ void DoPrecode::PrecodingPerSc(size_t frame_slot, size_t sc_id,
            : 0));
   auto* precoded_ptr = reinterpret_cast<arma::cx_float*>(
       precoded_buffer_temp_ + sc_id_in_block * cfg_->BsAntNum());
+  if (precode_cgemv_ != nullptr) {
+    // Fixed-shape kernel picked at construction: no per-call dispatch
+    precode_cgemv_(cfg_->BsAntNum(), cfg_->UeAntNum(),
+                   reinterpret_cast<const complex_float*>(precoder_ptr),
+                   reinterpret_cast<const complex_float*>(data_ptr),
+                   reinterpret_cast<complex_float*>(precoded_ptr));
+    return;
+  }
 #if USE_MKL_JIT
   my_cgemm_(jitter_, (MKL_Complex8*)precoder_ptr, (MKL_Complex8*)data_ptr,
             (MKL_Complex8*)precoded_ptr);
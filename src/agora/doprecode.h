@@ -6,6 +6,7 @@
 #define DOPRECODE_H_
 
 #include <armadillo>
+#include <atomic>
 #include <iostream>
 #include <vector>
 
@@ -16,13 +17,17 @@
 #include "gettime.h"
 #include "memory_manage.h"
 #include "modulation.h"
+#include "small_linalg.h"
 #include "stats.h"
 #include "symbols.h"
 
+class DoIFFT;
+
 class DoPrecode : public Doer {
  public:
   DoPrecode(Config* in_config, int in_tid,
             PtrGrid<kFrameWnd, kMaxDataSCs, complex_float>& dl_zf_matrices_,
+            Table<bool>& dl_zf_unchanged,
             Table<complex_float>& in_dl_ifft_buffer,
             Table<int8_t>& dl_encoded_or_raw_data, Stats* in_stats_manager);
   ~DoPrecode() override;
@@ -60,14 +65,41 @@ class DoPrecode : public Doer {
                      size_t user_id, size_t sc_id, size_t sc_id_in_block);
   void PrecodingPerSc(size_t frame_slot, size_t sc_id, size_t sc_id_in_block);
 
+  /// Enable the fused precode+IFFT mode: the worker that finishes the last
+  /// precode block of a downlink symbol runs the symbol's IFFTs inline on
+  /// [ifft] while the rows are still cache resident. [task_counts] is the
+  /// shared per-(frame slot, downlink symbol) completed-block counter.
+  /// Called once after construction, before any Launch()
+  void SetFusedIfft(DoIFFT* ifft, std::atomic<size_t>* task_counts) {
+    fused_ifft_ = ifft;
+    fused_task_counts_ = task_counts;
+  }
+
  private:
+  /// Fused-mode hook run after this block's IFFT rows are written: count
+  /// the block and, if it completed the symbol, run the symbol's IFFTs
+  void FusedIfftIfLastBlock(size_t frame_id, size_t symbol_id,
+                            size_t symbol_idx_dl);
+
   PtrGrid<kFrameWnd, kMaxDataSCs, complex_float>& dl_zf_matrices_;
+  // Set by DoZF when the near-static cache carried a subcarrier's
+  // beamweights over from the previous frame unchanged
+  Table<bool>& dl_zf_unchanged_;
   Table<complex_float>& dl_ifft_buffer_;
   Table<int8_t>& dl_raw_data_;
   Table<float> qam_table_;
   DurationStat* duration_stat_;
+  LatencyHistogram* duration_hist_;
   complex_float* modulated_buffer_temp_;
   complex_float* precoded_buffer_temp_;
+  // Set only in fused precode+IFFT mode (this worker's own IFFT doer and
+  // the Agora-owned completed-block counters)
+  DoIFFT* fused_ifft_ = nullptr;
+  std::atomic<size_t>* fused_task_counts_ = nullptr;
+
+  // Precoding GEMV kernel picked at construction when
+  // small_linalg_kernels is set; nullptr keeps the MKL/Armadillo path
+  small_linalg::CgemvFn precode_cgemv_ = nullptr;
 #if USE_MKL_JIT
   void* jitter_;
   cgemm_jit_kernel_t my_cgemm_;
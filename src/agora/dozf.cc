@@ -5,7 +5,9 @@
  */
 #include "dozf.h"
 
+#include "build_profile.h"
 #include "concurrent_queue_wrapper.h"
+#include "datatype_conversion.h"
 #include "doer.h"
 
 static constexpr bool kUseSIMDGather = true;
@@ -22,7 +24,8 @@ DoZF::DoZF(Config* config, int tid,
            Table<complex_float>& calib_ul_msum_buffer,
            PtrGrid<kFrameWnd, kMaxDataSCs, complex_float>& ul_zf_matrices,
            PtrGrid<kFrameWnd, kMaxDataSCs, complex_float>& dl_zf_matrices,
-           PhyStats* in_phy_stats, Stats* stats_manager)
+           Table<bool>& dl_zf_unchanged, PhyStats* in_phy_stats,
+           Stats* stats_manager)
     : Doer(config, tid),
       csi_buffers_(csi_buffers),
       calib_dl_buffer_(calib_dl_buffer),
@@ -31,8 +34,11 @@ DoZF::DoZF(Config* config, int tid,
       calib_ul_msum_buffer_(calib_ul_msum_buffer),
       ul_zf_matrices_(ul_zf_matrices),
       dl_zf_matrices_(dl_zf_matrices),
+      dl_zf_unchanged_(dl_zf_unchanged),
       phy_stats_(in_phy_stats) {
   duration_stat_ = stats_manager->GetDurationStat(DoerType::kZF, tid);
+  duration_hist_ = stats_manager->GetDurationHist(DoerType::kZF, tid);
+  RegisterTaskStats(&duration_stat_, &duration_hist_);
   pred_csi_buffer_ =
       static_cast<complex_float*>(Agora_memory::PaddedAlignedAlloc(
           Agora_memory::Alignment_t::kAlign64,
@@ -40,10 +46,18 @@ DoZF::DoZF(Config* config, int tid,
   csi_gather_buffer_ =
       static_cast<complex_float*>(Agora_memory::PaddedAlignedAlloc(
           Agora_memory::Alignment_t::kAlign64,
-          kMaxAntennas * kMaxUEs * sizeof(complex_float)));
+          kSCsPerCacheline * kMaxAntennas * kMaxUEs * sizeof(complex_float)));
+  gram_inv_buffer_ =
+      static_cast<complex_float*>(Agora_memory::PaddedAlignedAlloc(
+          Agora_memory::Alignment_t::kAlign64,
+          kSCsPerCacheline * kMaxUEs * kMaxUEs * sizeof(complex_float)));
   calib_gather_buffer_ = static_cast<complex_float*>(
       Agora_memory::PaddedAlignedAlloc(Agora_memory::Alignment_t::kAlign64,
                                        kMaxAntennas * sizeof(complex_float)));
+  calib_cache_ = static_cast<complex_float*>(Agora_memory::PaddedAlignedAlloc(
+      Agora_memory::Alignment_t::kAlign64,
+      cfg_->OfdmDataNum() * cfg_->BfAntNum() * sizeof(complex_float)));
+  calib_cache_epoch_.assign(cfg_->OfdmDataNum(), SIZE_MAX);
 
   num_ext_ref_ = 0;
   for (size_t i = 0; i < cfg_->NumCells(); i++) {
@@ -69,12 +83,27 @@ DoZF::DoZF(Config* config, int tid,
 DoZF::~DoZF() {
   std::free(pred_csi_buffer_);
   std::free(csi_gather_buffer_);
+  std::free(gram_inv_buffer_);
   std::free(calib_gather_buffer_);
+  std::free(calib_cache_);
 }
 
 EventData DoZF::Launch(size_t tag) {
+  CheckFrameSlotOwner(gen_tag_t(tag).frame_id_);
   if (cfg_->FreqOrthogonalPilot()) {
     ZfFreqOrthogonal(tag);
+  } else if (cfg_->ZfPredictFrames() > 0) {
+    // Frame 0 has no earlier prediction to rely on, so compute its
+    // beamweights directly before predicting ahead
+    if (gen_tag_t(tag).frame_id_ == 0) {
+      ZfTimeOrthogonal(tag);
+    }
+    Predict(tag);
+  } else if ((cfg_->ZfBatchedInversion() == true) && (num_ext_ref_ == 0) &&
+             (cfg_->Frame().NumDLSyms() == 0)) {
+    // The batched path covers the common uplink-only case; external
+    // reference nodes and downlink calibration use the per-subcarrier path
+    ZfTimeOrthogonalBatched(tag);
   } else {
     ZfTimeOrthogonal(tag);
   }
@@ -82,15 +111,66 @@ EventData DoZF::Launch(size_t tag) {
   return EventData(EventType::kZF, tag);
 }
 
+bool DoZF::TryMrcBeamweights(const arma::cx_fmat& mat_gram,
+                             const arma::cx_fmat& mat_csi,
+                             arma::cx_fmat& mat_ul_zf) const {
+  const arma::fmat mat_gram_abs = arma::abs(mat_gram);
+  const arma::fvec gram_diag = mat_gram_abs.diag();
+  // Largest per-row ratio of off-diagonal (inter-UE interference) energy
+  // to diagonal (per-UE channel) energy: small means the UE channels are
+  // near-orthogonal on this subcarrier and nulling buys nothing
+  const float dominance = arma::max(
+      (arma::sum(mat_gram_abs, 1) - gram_diag) / gram_diag);
+  if ((dominance >= static_cast<float>(cfg_->ZfMrcThreshold())) ||
+      (dominance != dominance)) {
+    return false;
+  }
+  // Conjugate beamweights, with each UE's row normalized by its channel
+  // energy (the Gram diagonal). This keeps the equalized symbols at the
+  // unit signal gain full ZF produces, so DoDemul's LLR scaling and the
+  // downlink precoder derivation need no MRC-specific handling.
+  mat_ul_zf = mat_csi.t();
+  for (size_t ue = 0; ue < mat_ul_zf.n_rows; ue++) {
+    mat_ul_zf.row(ue) /= gram_diag(ue);
+  }
+  return true;
+}
+
+arma::cx_fmat DoZF::ComputeGram(const arma::cx_fmat& mat_csi) const {
+  if (cfg_->SmallLinalgKernels() == true) {
+    arma::cx_fmat mat_gram(mat_csi.n_cols, mat_csi.n_cols);
+    small_linalg::GramHermitian(
+        mat_csi.n_rows, mat_csi.n_cols,
+        reinterpret_cast<const complex_float*>(mat_csi.memptr()),
+        reinterpret_cast<complex_float*>(mat_gram.memptr()));
+    return mat_gram;
+  }
+  return mat_csi.t() * mat_csi;
+}
+
 float DoZF::ComputePrecoder(const arma::cx_fmat& mat_csi,
                             complex_float* calib_ptr, complex_float* _mat_ul_zf,
-                            complex_float* _mat_dl_zf) {
+                            complex_float* _mat_dl_zf, size_t num_shed_ants) {
   arma::cx_fmat mat_ul_zf(reinterpret_cast<arma::cx_float*>(_mat_ul_zf),
                           cfg_->UeAntNum(), cfg_->BsAntNum(), false);
   arma::cx_fmat mat_ul_zf_tmp;
-  if (kUseInverseForZF != 0u) {
+  if ((cfg_->ZfMrcThreshold() > 0.0) &&
+      TryMrcBeamweights(ComputeGram(mat_csi), mat_csi, mat_ul_zf_tmp)) {
+    // Low-interference subcarrier: conjugate beamweights, no inversion
+  } else if (cfg_->ZfDiagLoadFactor() > 0.0) {
+    // Regularized (MMSE-style) inversion: load the Gram diagonal with a
+    // fraction of its mean energy so the matrix is positive definite even
+    // on ill-conditioned subcarriers. This keeps every subcarrier on the
+    // Cholesky path with bounded latency, at the cost of a small bias.
+    arma::cx_fmat mat_gram = ComputeGram(mat_csi);
+    const float sigma = static_cast<float>(cfg_->ZfDiagLoadFactor()) *
+                        arma::trace(mat_gram).real() /
+                        static_cast<float>(mat_gram.n_rows);
+    mat_gram.diag() += sigma;
+    mat_ul_zf_tmp = arma::inv_sympd(mat_gram) * mat_csi.t();
+  } else if (kUseInverseForZF != 0u) {
     try {
-      mat_ul_zf_tmp = arma::inv_sympd(mat_csi.t() * mat_csi) * mat_csi.t();
+      mat_ul_zf_tmp = arma::inv_sympd(ComputeGram(mat_csi)) * mat_csi.t();
     } catch (std::runtime_error&) {
       MLPD_WARN("Failed to invert channel matrix, falling back to pinv()\n");
       arma::pinv(mat_ul_zf_tmp, mat_csi, 1e-2, "dc");
@@ -114,7 +194,7 @@ float DoZF::ComputePrecoder(const arma::cx_fmat& mat_csi,
       arma::cx_fmat mat_dl_csi = arma::diagmat(calib_vec) * mat_csi;
       try {
         mat_dl_zf_tmp =
-            arma::inv_sympd(mat_dl_csi.t() * mat_dl_csi) * mat_dl_csi.t();
+            arma::inv_sympd(ComputeGram(mat_dl_csi)) * mat_dl_csi.t();
       } catch (std::runtime_error&) {
         arma::pinv(mat_dl_zf_tmp, mat_dl_csi, 1e-2, "dc");
       }
@@ -144,6 +224,13 @@ float DoZF::ComputePrecoder(const arma::cx_fmat& mat_csi,
                                          arma::fill::zeros));
     }
   }
+  if (num_shed_ants > 0) {
+    // Shed antennas' data FFTs were skipped; zero beamweights keep their
+    // stale data buffer contents out of the combined symbols
+    mat_ul_zf_tmp.insert_cols(
+        mat_ul_zf_tmp.n_cols,
+        arma::cx_fmat(cfg_->UeAntNum(), num_shed_ants, arma::fill::zeros));
+  }
   mat_ul_zf = mat_ul_zf_tmp;
   float rcond = -1;
   if (kPrintZfStats) {
@@ -156,20 +243,32 @@ void DoZF::ComputeCalib(size_t frame_id, size_t sc_id) {
   arma::cx_fvec calib_vec(
       reinterpret_cast<arma::cx_float*>(calib_gather_buffer_), cfg_->BfAntNum(),
       false);
-  size_t frame_cal_slot = kFrameWnd - 1;
-  size_t frame_cal_slot_prev = kFrameWnd - 1;
+  size_t frame_cal_slot = cfg_->FrameWnd() - 1;
+  size_t frame_cal_slot_prev = cfg_->FrameWnd() - 1;
   size_t frame_cal_slot_old = 0;
   size_t frame_grp_id = 0;
   if (cfg_->Frame().IsRecCalEnabled() && frame_id >= TX_FRAME_DELTA) {
     frame_grp_id = (frame_id - TX_FRAME_DELTA) / cfg_->AntGroupNum();
 
     // use the previous window which has a full set of calibration results
-    frame_cal_slot = (frame_grp_id + kFrameWnd - 1) % kFrameWnd;
+    frame_cal_slot = (frame_grp_id + cfg_->FrameWnd() - 1) % cfg_->FrameWnd();
     if (frame_id >= TX_FRAME_DELTA + cfg_->AntGroupNum()) {
-      frame_cal_slot_prev = (frame_grp_id + kFrameWnd - 2) % kFrameWnd;
+      frame_cal_slot_prev =
+          (frame_grp_id + cfg_->FrameWnd() - 2) % cfg_->FrameWnd();
     }
     frame_cal_slot_old =
-        (frame_cal_slot + 2) % kFrameWnd;  // oldest frame data in buffer
+        (frame_cal_slot + 2) % cfg_->FrameWnd();  // oldest frame data in buffer
+  }
+
+  // The calibration windows picked above are fully-swept, stable result
+  // sets that only change between frame groups (epochs). Within an epoch,
+  // serve the fused vector from the per-subcarrier cache and skip the
+  // moving-sum and divide chain entirely.
+  complex_float* cache_entry = calib_cache_ + (sc_id * cfg_->BfAntNum());
+  if (calib_cache_epoch_.at(sc_id) == frame_grp_id) {
+    std::memcpy(calib_gather_buffer_, cache_entry,
+                cfg_->BfAntNum() * sizeof(complex_float));
+    return;
   }
 
   arma::cx_fmat cur_calib_dl_mat(
@@ -203,13 +302,27 @@ void DoZF::ComputeCalib(size_t frame_id, size_t sc_id) {
           calib_ul_msum_buffer_[frame_cal_slot_prev]),
       cfg_->OfdmDataNum(), cfg_->BfAntNum(), false);
 
-  // Calculate a moving sum
-  cur_calib_dl_msum_mat.row(sc_id) = cur_calib_dl_mat.row(sc_id) +
-                                     pre_calib_dl_msum_mat.row(sc_id) -
-                                     old_calib_dl_mat.row(sc_id);
-  cur_calib_ul_msum_mat.row(sc_id) = cur_calib_ul_mat.row(sc_id) +
-                                     pre_calib_ul_msum_mat.row(sc_id) -
-                                     old_calib_ul_mat.row(sc_id);
+  const float alpha = static_cast<float>(cfg_->CalibSmoothAlpha());
+  if (alpha > 0.0f) {
+    // Exponential smoothing: the msum buffers hold the smoothed estimate
+    // instead of a moving sum. Unlike the uniform window this weights the
+    // newest sweep most, so the estimate tracks slow thermal drift without
+    // waiting kFrameWnd frame groups for stale measurements to age out.
+    cur_calib_dl_msum_mat.row(sc_id) =
+        cur_calib_dl_mat.row(sc_id) * alpha +
+        pre_calib_dl_msum_mat.row(sc_id) * (1.0f - alpha);
+    cur_calib_ul_msum_mat.row(sc_id) =
+        cur_calib_ul_mat.row(sc_id) * alpha +
+        pre_calib_ul_msum_mat.row(sc_id) * (1.0f - alpha);
+  } else {
+    // Calculate a moving sum
+    cur_calib_dl_msum_mat.row(sc_id) = cur_calib_dl_mat.row(sc_id) +
+                                       pre_calib_dl_msum_mat.row(sc_id) -
+                                       old_calib_dl_mat.row(sc_id);
+    cur_calib_ul_msum_mat.row(sc_id) = cur_calib_ul_mat.row(sc_id) +
+                                       pre_calib_ul_msum_mat.row(sc_id) -
+                                       old_calib_ul_mat.row(sc_id);
+  }
 
   if (cfg_->InitCalibRepeat() == 0u && frame_grp_id == 0) {
     // fill with one until one full sweep
@@ -220,6 +333,10 @@ void DoZF::ComputeCalib(size_t frame_id, size_t sc_id) {
         (cur_calib_dl_msum_mat.row(sc_id) / cur_calib_ul_msum_mat.row(sc_id))
             .st();
   }
+
+  std::memcpy(cache_entry, calib_gather_buffer_,
+              cfg_->BfAntNum() * sizeof(complex_float));
+  calib_cache_epoch_.at(sc_id) = frame_grp_id;
 }
 
 // Gather data of one symbol from partially-transposed buffer
@@ -301,89 +418,412 @@ static inline void TransposeGather(size_t cur_sc_id, float* src, float*& dst,
   }
 }
 
+// Expand one complex fp16 sample (2 x fp16 in one 32-bit word) to a fp32
+// complex_float at dst
+static inline void StoreFp16Sample(uint32_t bits, complex_float* dst) {
+  const __m128 sample =
+      _mm_cvtph_ps(_mm_cvtsi32_si128(static_cast<int>(bits)));
+  _mm_storel_pi(reinterpret_cast<__m64*>(dst), sample);
+}
+
+// PartialTransposeGather() for fp16 CSI buffers (csi_fp16): a complex fp16
+// sample is 4 bytes, so one 32-bit gather lane fetches a whole sample, which
+// is then widened to fp32 on the way into the gather buffer
+static inline void PartialTransposeGatherFp16(size_t cur_sc_id, float* src,
+                                              float*& dst, size_t bs_ant_num) {
+#ifdef __AVX512F__
+  static constexpr size_t kAntNumPerSimd = 16;
+#else
+  static constexpr size_t kAntNumPerSimd = 8;
+#endif
+
+  size_t ant_start = 0;
+  if (kUseSIMDGather && (bs_ant_num >= kAntNumPerSimd)) {
+    const size_t transpose_block_id = cur_sc_id / kTransposeBlockSize;
+    const size_t sc_inblock_idx = cur_sc_id % kTransposeBlockSize;
+    const int* src32 = reinterpret_cast<const int*>(src) +
+                       (transpose_block_id * bs_ant_num * kTransposeBlockSize) +
+                       sc_inblock_idx;
+#ifdef __AVX512F__
+    __m512i index = _mm512_setr_epi32(
+        0, kTransposeBlockSize, kTransposeBlockSize * 2,
+        kTransposeBlockSize * 3, kTransposeBlockSize * 4,
+        kTransposeBlockSize * 5, kTransposeBlockSize * 6,
+        kTransposeBlockSize * 7, kTransposeBlockSize * 8,
+        kTransposeBlockSize * 9, kTransposeBlockSize * 10,
+        kTransposeBlockSize * 11, kTransposeBlockSize * 12,
+        kTransposeBlockSize * 13, kTransposeBlockSize * 14,
+        kTransposeBlockSize * 15);
+    for (size_t ant_idx = 0; ant_idx < bs_ant_num; ant_idx += kAntNumPerSimd) {
+      // fetch 16 complex fp16 samples (one per antenna), widen to fp32
+      const __m512i packed = _mm512_i32gather_epi32(index, src32, 4);
+      _mm512_storeu_ps(
+          dst, _mm512_cvtph_ps(_mm512_castsi512_si256(packed)));
+      _mm512_storeu_ps(
+          dst + 16, _mm512_cvtph_ps(_mm512_extracti64x4_epi64(packed, 1)));
+      src32 += kAntNumPerSimd * kTransposeBlockSize;
+      dst += kAntNumPerSimd * 2;
+    }
+#else
+    __m256i index = _mm256_setr_epi32(
+        0, kTransposeBlockSize, kTransposeBlockSize * 2,
+        kTransposeBlockSize * 3, kTransposeBlockSize * 4,
+        kTransposeBlockSize * 5, kTransposeBlockSize * 6,
+        kTransposeBlockSize * 7);
+    for (size_t ant_idx = 0; ant_idx < bs_ant_num; ant_idx += kAntNumPerSimd) {
+      // fetch 8 complex fp16 samples (one per antenna), widen to fp32
+      const __m256i packed = _mm256_i32gather_epi32(src32, index, 4);
+      _mm256_storeu_ps(dst, _mm256_cvtph_ps(_mm256_castsi256_si128(packed)));
+      _mm256_storeu_ps(dst + 8,
+                       _mm256_cvtph_ps(_mm256_extracti128_si256(packed, 1)));
+      src32 += kAntNumPerSimd * kTransposeBlockSize;
+      dst += kAntNumPerSimd * 2;
+    }
+#endif
+    // Set the of the remaining antennas to use non-SIMD gather
+    ant_start = bs_ant_num - (bs_ant_num % kAntNumPerSimd);
+  }
+  if (ant_start < bs_ant_num) {
+    const size_t pt_base_offset =
+        (cur_sc_id / kTransposeBlockSize) * (kTransposeBlockSize * bs_ant_num);
+    const auto* src32 = reinterpret_cast<const uint32_t*>(src);
+    auto* cx_dst = reinterpret_cast<complex_float*>(dst);
+    for (size_t ant_i = ant_start; ant_i < bs_ant_num; ant_i++) {
+      StoreFp16Sample(src32[pt_base_offset + (ant_i * kTransposeBlockSize) +
+                            (cur_sc_id % kTransposeBlockSize)],
+                      cx_dst);
+      cx_dst++;
+    }
+  }
+}
+
+// TransposeGather() for fp16 CSI buffers (csi_fp16)
+static inline void TransposeGatherFp16(size_t cur_sc_id, float* src,
+                                       float*& dst, size_t bs_ant_num,
+                                       size_t ofdm_data_num) {
+  const auto* src32 = reinterpret_cast<const uint32_t*>(src);
+  auto* cx_dst = reinterpret_cast<complex_float*>(dst);
+  for (size_t ant_i = 0; ant_i < bs_ant_num; ant_i++) {
+    StoreFp16Sample(src32[(ant_i * ofdm_data_num) + cur_sc_id], cx_dst);
+    cx_dst++;
+  }
+}
+
+void DoZF::GatherCsi(size_t cur_sc_id, const complex_float* src,
+                     float* dst) const {
+  auto* src_f = reinterpret_cast<float*>(const_cast<complex_float*>(src));
+  if (cfg_->CsiFp16() == true) {
+    if (kUsePartialTrans) {
+      PartialTransposeGatherFp16(cur_sc_id, src_f, dst, cfg_->BsAntNum());
+    } else {
+      TransposeGatherFp16(cur_sc_id, src_f, dst, cfg_->BsAntNum(),
+                          cfg_->OfdmDataNum());
+    }
+  } else if (kUsePartialTrans) {
+    PartialTransposeGather(cur_sc_id, src_f, dst, cfg_->BsAntNum());
+  } else {
+    TransposeGather(cur_sc_id, src_f, dst, cfg_->BsAntNum(),
+                    cfg_->OfdmDataNum());
+  }
+}
+
 void DoZF::ZfTimeOrthogonal(size_t tag) {
   const size_t frame_id = gen_tag_t(tag).frame_id_;
   const size_t base_sc_id = gen_tag_t(tag).sc_id_;
-  const size_t frame_slot = frame_id % kFrameWnd;
+  const size_t frame_slot = frame_id % cfg_->FrameWnd();
+  // Compile-time constants under a build profile (see build_profile.h)
+  const size_t bs_ant_num = BuildProfile::BsAntNum(cfg_->BsAntNum());
+  const size_t ue_ant_num = BuildProfile::UeAntNum(cfg_->UeAntNum());
   if (kDebugPrintInTask) {
     std::printf("In doZF thread %d: frame: %zu, base subcarrier: %zu\n", tid_,
                 frame_id, base_sc_id);
   }
   size_t num_subcarriers =
-      std::min(cfg_->ZfBlockSize(), cfg_->OfdmDataNum() - base_sc_id);
+      std::min(cfg_->ZfBlockSize(),
+               BuildProfile::OfdmDataNum(cfg_->OfdmDataNum()) - base_sc_id);
+  // Antennas shed for this frame by the master's load-shedding controller
+  const size_t num_shed_ants = cfg_->AntShed(frame_id);
 
   // Handle each subcarrier one by one
   for (size_t i = 0; i < num_subcarriers; i++) {
     size_t start_tsc1 = GetTime::WorkerRdtsc();
     const size_t cur_sc_id = base_sc_id + i;
+    // Assume recomputed beamweights until the cache path proves otherwise
+    // (the slot may hold a stale flag from kFrameWnd frames ago)
+    dl_zf_unchanged_[frame_slot][cur_sc_id] = false;
 
     // Gather CSI matrices of each pilot from partially-transposed CSIs.
-    for (size_t ue_idx = 0; ue_idx < cfg_->UeAntNum(); ue_idx++) {
+    for (size_t ue_idx = 0; ue_idx < ue_ant_num; ue_idx++) {
       auto* dst_csi_ptr = reinterpret_cast<float*>(csi_gather_buffer_ +
-                                                   cfg_->BsAntNum() * ue_idx);
-      if (kUsePartialTrans) {
-        PartialTransposeGather(cur_sc_id,
-                               (float*)csi_buffers_[frame_slot][ue_idx],
-                               dst_csi_ptr, cfg_->BsAntNum());
-      } else {
-        TransposeGather(cur_sc_id, (float*)csi_buffers_[frame_slot][ue_idx],
-                        dst_csi_ptr, cfg_->BsAntNum(), cfg_->OfdmDataNum());
-      }
+                                                   bs_ant_num * ue_idx);
+      GatherCsi(cur_sc_id, csi_buffers_.At(frame_slot, ue_idx), dst_csi_ptr);
     }
 
     size_t start_tsc2 = GetTime::WorkerRdtsc();
     duration_stat_->task_duration_[1] += start_tsc2 - start_tsc1;
 
-    arma::cx_fmat mat_csi((arma::cx_float*)csi_gather_buffer_, cfg_->BsAntNum(),
-                          cfg_->UeAntNum(), false);
+    arma::cx_fmat mat_csi((arma::cx_float*)csi_gather_buffer_, bs_ant_num,
+                          ue_ant_num, false);
 
     if (cfg_->Frame().NumDLSyms() > 0) {
       ComputeCalib(frame_id, cur_sc_id);
     }
+
+    // In near-static channels the precoder from the previous frame is still
+    // valid. When caching is enabled, compare this subcarrier's CSI against
+    // the previous frame's and reuse the cached precoder if the relative
+    // change is below the configured threshold, skipping the inversion.
+    if ((cfg_->ZfCacheThreshold() > 0.0) && (frame_id > 0)) {
+      const size_t prev_slot = (frame_id - 1) % cfg_->FrameWnd();
+      for (size_t ue_idx = 0; ue_idx < ue_ant_num; ue_idx++) {
+        auto* dst_csi_ptr = reinterpret_cast<float*>(pred_csi_buffer_ +
+                                                     bs_ant_num * ue_idx);
+        GatherCsi(cur_sc_id, csi_buffers_.At(prev_slot, ue_idx), dst_csi_ptr);
+      }
+      arma::cx_fmat mat_csi_prev((arma::cx_float*)pred_csi_buffer_,
+                                 bs_ant_num, ue_ant_num, false);
+      const float prev_norm = arma::norm(mat_csi_prev, "fro");
+      if ((prev_norm > 0.0f) &&
+          ((arma::norm(mat_csi - mat_csi_prev, "fro") / prev_norm) <
+           cfg_->ZfCacheThreshold())) {
+        std::memcpy(ul_zf_matrices_.At(frame_slot, cur_sc_id),
+                    ul_zf_matrices_.At(prev_slot, cur_sc_id),
+                    ue_ant_num * bs_ant_num * sizeof(complex_float));
+        if (cfg_->Frame().NumDLSyms() > 0) {
+          std::memcpy(
+              dl_zf_matrices_.At(frame_slot, cur_sc_id),
+              dl_zf_matrices_.At(prev_slot, cur_sc_id),
+              bs_ant_num * ue_ant_num * sizeof(complex_float));
+        }
+        dl_zf_unchanged_[frame_slot][cur_sc_id] = true;
+        const size_t task_cycles = GetTime::WorkerRdtsc() - start_tsc1;
+        duration_stat_->task_count_++;
+        duration_stat_->task_duration_[0] += task_cycles;
+        duration_hist_->Record(task_cycles);
+        continue;
+      }
+    }
+
     if (num_ext_ref_ > 0) {
       mat_csi.shed_rows(ext_ref_id_);
     }
+    if (num_shed_ants > 0) {
+      mat_csi.shed_rows(mat_csi.n_rows - num_shed_ants, mat_csi.n_rows - 1);
+    }
 
     double start_tsc3 = GetTime::WorkerRdtsc();
     duration_stat_->task_duration_[2] += start_tsc3 - start_tsc2;
 
     auto rcond = ComputePrecoder(mat_csi, calib_gather_buffer_,
-                                 ul_zf_matrices_[frame_slot][cur_sc_id],
-                                 dl_zf_matrices_[frame_slot][cur_sc_id]);
+                                 ul_zf_matrices_.At(frame_slot, cur_sc_id),
+                                 dl_zf_matrices_.At(frame_slot, cur_sc_id),
+                                 num_shed_ants);
     if (kPrintZfStats) {
       phy_stats_->UpdateCsiCond(frame_id, cur_sc_id, rcond);
     }
 
     duration_stat_->task_duration_[3] += GetTime::WorkerRdtsc() - start_tsc3;
+    const size_t task_cycles = GetTime::WorkerRdtsc() - start_tsc1;
     duration_stat_->task_count_++;
-    duration_stat_->task_duration_[0] += GetTime::WorkerRdtsc() - start_tsc1;
+    duration_stat_->task_duration_[0] += task_cycles;
+    duration_hist_->Record(task_cycles);
     // if (duration > 500) {
     //     std::printf("Thread %d ZF takes %.2f\n", tid, duration);
     // }
   }
 }
 
+void DoZF::ZfTimeOrthogonalBatched(size_t tag) {
+  const size_t frame_id = gen_tag_t(tag).frame_id_;
+  const size_t base_sc_id = gen_tag_t(tag).sc_id_;
+  const size_t frame_slot = frame_id % cfg_->FrameWnd();
+  const size_t bs_ant_num = BuildProfile::BsAntNum(cfg_->BsAntNum());
+  const size_t ue_num = BuildProfile::UeAntNum(cfg_->UeAntNum());
+  if (kDebugPrintInTask) {
+    std::printf("In doZF thread %d: frame: %zu, base subcarrier: %zu (batch)\n",
+                tid_, frame_id, base_sc_id);
+  }
+  const size_t num_subcarriers =
+      std::min(cfg_->ZfBlockSize(),
+               BuildProfile::OfdmDataNum(cfg_->OfdmDataNum()) - base_sc_id);
+  // Antennas shed for this frame by the master's load-shedding controller;
+  // only the leading act_ant_num CSI rows enter the linear algebra
+  const size_t num_shed_ants = cfg_->AntShed(frame_id);
+  const size_t act_ant_num = bs_ant_num - num_shed_ants;
+
+  // Process a cacheline of subcarriers per iteration
+  for (size_t chunk = 0; chunk < num_subcarriers; chunk += kSCsPerCacheline) {
+    const size_t batch = std::min(kSCsPerCacheline, num_subcarriers - chunk);
+    size_t start_tsc1 = GetTime::WorkerRdtsc();
+
+    // Gather CSI for the whole batch before any linear algebra, so the
+    // inversions then run back to back out of a warm cache
+    const size_t chunk_sc_id = base_sc_id + chunk;
+    if (kUsePartialTrans && (cfg_->CsiFp16() == false) &&
+        (kTransposeBlockSize == 8) && (batch == kTransposeBlockSize) &&
+        ((chunk_sc_id % kTransposeBlockSize) == 0)) {
+      // Full aligned transpose block: one cacheline load per antenna feeds
+      // the CSI columns of all 8 subcarriers in one pass
+      for (size_t ue_idx = 0; ue_idx < ue_num; ue_idx++) {
+        float* dst_cols[kTransposeBlockSize];
+        for (size_t b = 0; b < kTransposeBlockSize; b++) {
+          dst_cols[b] = reinterpret_cast<float*>(
+              csi_gather_buffer_ + (b * bs_ant_num * ue_num) +
+              (bs_ant_num * ue_idx));
+        }
+        const float* src = (float*)csi_buffers_.At(frame_slot, ue_idx) +
+                           ((chunk_sc_id / kTransposeBlockSize) *
+                            (bs_ant_num * kTransposeBlockSize * 2));
+        SimdGatherCsiTransposeBlock(src, dst_cols, bs_ant_num);
+      }
+    } else {
+      for (size_t b = 0; b < batch; b++) {
+        const size_t cur_sc_id = chunk_sc_id + b;
+        for (size_t ue_idx = 0; ue_idx < ue_num; ue_idx++) {
+          auto* dst_csi_ptr = reinterpret_cast<float*>(
+              csi_gather_buffer_ + (b * bs_ant_num * ue_num) +
+              (bs_ant_num * ue_idx));
+          GatherCsi(cur_sc_id, csi_buffers_.At(frame_slot, ue_idx),
+                    dst_csi_ptr);
+        }
+      }
+    }
+    size_t start_tsc2 = GetTime::WorkerRdtsc();
+    duration_stat_->task_duration_[1] += start_tsc2 - start_tsc1;
+
+    // Form the Gram matrix H^H * H of every subcarrier in the batch
+    bool mrc_used[kSCsPerCacheline] = {false};
+    for (size_t b = 0; b < batch; b++) {
+      arma::cx_fmat mat_csi(reinterpret_cast<arma::cx_float*>(
+                                csi_gather_buffer_ + (b * bs_ant_num * ue_num)),
+                            bs_ant_num, ue_num, false);
+      arma::cx_fmat mat_gram(reinterpret_cast<arma::cx_float*>(
+                                 gram_inv_buffer_ + (b * ue_num * ue_num)),
+                             ue_num, ue_num, false);
+      if (num_shed_ants > 0) {
+        mat_gram = mat_csi.head_rows(act_ant_num).t() *
+                   mat_csi.head_rows(act_ant_num);
+        // Zero the shed antennas' detector columns (the matrix tail in
+        // column-major storage) so their unprocessed data is never combined
+        std::memset(ul_zf_matrices_.At(frame_slot, chunk_sc_id + b) +
+                        (act_ant_num * ue_num),
+                    0, num_shed_ants * ue_num * sizeof(complex_float));
+      } else {
+        mat_gram = ComputeGram(mat_csi);
+      }
+      if (cfg_->ZfMrcThreshold() > 0.0) {
+        // A ue_num x act_ant_num view covers exactly the leading columns
+        // of the full detector matrix
+        arma::cx_fmat mat_ul_zf(
+            reinterpret_cast<arma::cx_float*>(
+                ul_zf_matrices_.At(frame_slot, chunk_sc_id + b)),
+            ue_num, act_ant_num, false);
+        mrc_used[b] =
+            (num_shed_ants > 0)
+                ? TryMrcBeamweights(
+                      mat_gram, arma::cx_fmat(mat_csi.head_rows(act_ant_num)),
+                      mat_ul_zf)
+                : TryMrcBeamweights(mat_gram, mat_csi, mat_ul_zf);
+        if (mrc_used[b]) {
+          // Skips diagonal loading too: the Gram matrix will not be
+          // factorized for this subcarrier
+          continue;
+        }
+      }
+      if (cfg_->ZfDiagLoadFactor() > 0.0) {
+        // Same diagonal loading as ComputePrecoder(): keeps ill-conditioned
+        // subcarriers on the Cholesky path
+        const float sigma = static_cast<float>(cfg_->ZfDiagLoadFactor()) *
+                            arma::trace(mat_gram).real() /
+                            static_cast<float>(ue_num);
+        mat_gram.diag() += sigma;
+      }
+    }
+    size_t start_tsc3 = GetTime::WorkerRdtsc();
+    duration_stat_->task_duration_[2] += start_tsc3 - start_tsc2;
+
+    // Invert the Gram matrices with Cholesky factorization; they are
+    // Hermitian positive definite whenever the CSI has full column rank
+    for (size_t b = 0; b < batch; b++) {
+      if (mrc_used[b]) {
+        continue;
+      }
+      const size_t cur_sc_id = base_sc_id + chunk + b;
+      auto* gram_ptr =
+          reinterpret_cast<MKL_Complex8*>(gram_inv_buffer_ + b * ue_num * ue_num);
+      lapack_int info =
+          LAPACKE_cpotrf(LAPACK_COL_MAJOR, 'L', ue_num, gram_ptr, ue_num);
+      if (info == 0) {
+        info = LAPACKE_cpotri(LAPACK_COL_MAJOR, 'L', ue_num, gram_ptr, ue_num);
+      }
+
+      arma::cx_fmat mat_csi(reinterpret_cast<arma::cx_float*>(
+                                csi_gather_buffer_ + (b * bs_ant_num * ue_num)),
+                            bs_ant_num, ue_num, false);
+      arma::cx_fmat mat_ul_zf(reinterpret_cast<arma::cx_float*>(
+                                  ul_zf_matrices_.At(frame_slot, cur_sc_id)),
+                              ue_num, act_ant_num, false);
+      if (info == 0) {
+        // cpotri fills only the lower triangle; mirror it before the gemm
+        arma::cx_fmat mat_gram_inv(reinterpret_cast<arma::cx_float*>(
+                                       gram_inv_buffer_ + b * ue_num * ue_num),
+                                   ue_num, ue_num, false);
+        if (num_shed_ants > 0) {
+          mat_ul_zf = arma::cx_fmat(arma::symmatl(mat_gram_inv)) *
+                      mat_csi.head_rows(act_ant_num).t();
+        } else {
+          mat_ul_zf = arma::cx_fmat(arma::symmatl(mat_gram_inv)) * mat_csi.t();
+        }
+      } else {
+        // Rare ill-conditioned subcarrier: fall back to the pseudoinverse
+        MLPD_WARN("Failed to invert Gram matrix, falling back to pinv()\n");
+        arma::cx_fmat mat_ul_zf_tmp;
+        if (num_shed_ants > 0) {
+          arma::pinv(mat_ul_zf_tmp,
+                     arma::cx_fmat(mat_csi.head_rows(act_ant_num)), 1e-2, "dc");
+        } else {
+          arma::pinv(mat_ul_zf_tmp, mat_csi, 1e-2, "dc");
+        }
+        mat_ul_zf = mat_ul_zf_tmp;
+      }
+    }
+
+    duration_stat_->task_duration_[3] += GetTime::WorkerRdtsc() - start_tsc3;
+    duration_stat_->task_count_ += batch;
+    duration_stat_->task_duration_[0] += GetTime::WorkerRdtsc() - start_tsc1;
+  }
+}
+
 void DoZF::ZfFreqOrthogonal(size_t tag) {
   const size_t frame_id = gen_tag_t(tag).frame_id_;
   const size_t base_sc_id = gen_tag_t(tag).sc_id_;
-  const size_t frame_slot = frame_id % kFrameWnd;
+  const size_t frame_slot = frame_id % cfg_->FrameWnd();
+  // Compile-time constants under a build profile (see build_profile.h)
+  const size_t bs_ant_num = BuildProfile::BsAntNum(cfg_->BsAntNum());
+  const size_t ue_ant_num = BuildProfile::UeAntNum(cfg_->UeAntNum());
   if (kDebugPrintInTask) {
     std::printf(
         "In doZF thread %d: frame: %zu, subcarrier: %zu, block: %zu, "
         "Basestation ant number: %zu\n",
-        tid_, frame_id, base_sc_id, base_sc_id / cfg_->UeAntNum(),
-        cfg_->BsAntNum());
+        tid_, frame_id, base_sc_id, base_sc_id / ue_ant_num,
+        bs_ant_num);
   }
 
   double start_tsc1 = GetTime::WorkerRdtsc();
 
   // Gather CSIs from partially-transposed CSIs
-  for (size_t i = 0; i < cfg_->UeAntNum(); i++) {
+  for (size_t i = 0; i < ue_ant_num; i++) {
     const size_t cur_sc_id = base_sc_id + i;
     auto* dst_csi_ptr =
-        reinterpret_cast<float*>(csi_gather_buffer_ + cfg_->BsAntNum() * i);
-    PartialTransposeGather(cur_sc_id, (float*)csi_buffers_[frame_slot][0],
-                           dst_csi_ptr, cfg_->BsAntNum());
+        reinterpret_cast<float*>(csi_gather_buffer_ + bs_ant_num * i);
+    if (cfg_->CsiFp16() == true) {
+      PartialTransposeGatherFp16(cur_sc_id,
+                                 (float*)csi_buffers_.At(frame_slot, 0),
+                                 dst_csi_ptr, bs_ant_num);
+    } else {
+      PartialTransposeGather(cur_sc_id, (float*)csi_buffers_.At(frame_slot, 0),
+                             dst_csi_ptr, bs_ant_num);
+    }
   }
 
   size_t start_tsc2 = GetTime::WorkerRdtsc();
@@ -393,15 +833,16 @@ void DoZF::ZfFreqOrthogonal(size_t tag) {
     arma::cx_fvec calib_vec(
         reinterpret_cast<arma::cx_float*>(calib_gather_buffer_),
         cfg_->BfAntNum(), false);
-    size_t frame_cal_slot = kFrameWnd - 1;
-    size_t frame_cal_slot_prev = kFrameWnd - 1;
+    size_t frame_cal_slot = cfg_->FrameWnd() - 1;
+    size_t frame_cal_slot_prev = cfg_->FrameWnd() - 1;
     if (cfg_->Frame().IsRecCalEnabled() && (frame_id >= TX_FRAME_DELTA)) {
       size_t frame_grp_id = (frame_id - TX_FRAME_DELTA) / cfg_->AntGroupNum();
 
       // use the previous window which has a full set of calibration results
-      frame_cal_slot = (frame_grp_id + kFrameWnd - 1) % kFrameWnd;
+      frame_cal_slot = (frame_grp_id + cfg_->FrameWnd() - 1) % cfg_->FrameWnd();
       if (frame_id >= TX_FRAME_DELTA + cfg_->AntGroupNum()) {
-        frame_cal_slot_prev = (frame_grp_id + kFrameWnd - 2) % kFrameWnd;
+        frame_cal_slot_prev =
+            (frame_grp_id + cfg_->FrameWnd() - 2) % cfg_->FrameWnd();
       }
     }
     arma::cx_fmat calib_dl_mat(
@@ -429,43 +870,112 @@ void DoZF::ZfFreqOrthogonal(size_t tag) {
   duration_stat_->task_duration_[2] += start_tsc3 - start_tsc2;
 
   arma::cx_fmat mat_csi(reinterpret_cast<arma::cx_float*>(csi_gather_buffer_),
-                        cfg_->BsAntNum(), cfg_->UeAntNum(), false);
+                        bs_ant_num, ue_ant_num, false);
+  const size_t num_shed_ants = cfg_->AntShed(frame_id);
+  if (num_shed_ants > 0) {
+    mat_csi.shed_rows(mat_csi.n_rows - num_shed_ants, mat_csi.n_rows - 1);
+  }
 
+  dl_zf_unchanged_[frame_slot][cfg_->GetZfScId(base_sc_id)] = false;
   ComputePrecoder(mat_csi, calib_gather_buffer_,
-                  ul_zf_matrices_[frame_slot][cfg_->GetZfScId(base_sc_id)],
-                  dl_zf_matrices_[frame_slot][cfg_->GetZfScId(base_sc_id)]);
+                  ul_zf_matrices_.At(frame_slot, cfg_->GetZfScId(base_sc_id)),
+                  dl_zf_matrices_.At(frame_slot, cfg_->GetZfScId(base_sc_id)),
+                  num_shed_ants);
 
   duration_stat_->task_duration_[3] += GetTime::WorkerRdtsc() - start_tsc3;
+  const size_t task_cycles = GetTime::WorkerRdtsc() - start_tsc1;
   duration_stat_->task_count_++;
-  duration_stat_->task_duration_[0] += GetTime::WorkerRdtsc() - start_tsc1;
+  duration_stat_->task_duration_[0] += task_cycles;
+  duration_hist_->Record(task_cycles);
 
   // if (duration > 500) {
   //     std::printf("Thread %d ZF takes %.2f\n", tid, duration);
   // }
 }
 
-// Currently unused
-/*
-void DoZF::Predict(size_t tag)
-{
-    size_t frame_id = gen_tag_t(tag).frame_id;
-    size_t base_sc_id = gen_tag_t(tag).sc_id;
-
-    // Use stale CSI as predicted CSI
-    // TODO: add prediction algorithm
-    const size_t offset_in_buffer
-        = ((frame_id % kFrameWnd) * cfg_->OfdmDataNum())
-        + base_sc_id;
-    auto* ptr_in = (arma::cx_float*)pred_csi_buffer;
-    std::memcpy(ptr_in, (arma::cx_float*)csi_buffer_[offset_in_buffer],
-        sizeof(arma::cx_float) * cfg->BsAntNum() * cfg->UE_NUM);
-    arma::cx_fmat mat_input(ptr_in, cfg->BsAntNum(), cfg->UE_NUM, false);
-
-    // Input matrix and calibration are for current frame, output precoders are
-    // for the next frame
-    compute_precoder(mat_input,
-        cfg_->GetCalibBuffer(calib_buffer_, frame_id, base_sc_id),
-        cfg_->get_ul_zf_mat(ul_zf_buffer_, frame_id + 1, base_sc_id),
-        cfg_->get_dl_zf_mat(dl_zf_buffer_, frame_id + 1, base_sc_id));
+void DoZF::Predict(size_t tag) {
+  const size_t frame_id = gen_tag_t(tag).frame_id_;
+  const size_t base_sc_id = gen_tag_t(tag).sc_id_;
+  const size_t frame_slot = frame_id % cfg_->FrameWnd();
+  const size_t next_slot = (frame_id + 1) % cfg_->FrameWnd();
+  // Number of frames of CSI history actually available for extrapolation
+  const size_t num_hist = std::min(cfg_->ZfPredictFrames(), frame_id + 1);
+  if (kDebugPrintInTask) {
+    std::printf(
+        "In doZF thread %d: predicting frame: %zu, base subcarrier: %zu\n",
+        tid_, frame_id + 1, base_sc_id);
+  }
+  const size_t num_subcarriers =
+      std::min(cfg_->ZfBlockSize(), cfg_->OfdmDataNum() - base_sc_id);
+
+  // Old-frame CSI is gathered past the current frame's matrix in the
+  // (cacheline-sized) gather buffer, so neither aliases the other
+  complex_float* old_csi_buffer = csi_gather_buffer_ + (kMaxAntennas * kMaxUEs);
+
+  for (size_t i = 0; i < num_subcarriers; i++) {
+    size_t start_tsc1 = GetTime::WorkerRdtsc();
+    const size_t cur_sc_id = base_sc_id + i;
+
+    // Gather the current frame's CSI, and the oldest frame in the history
+    // window when there is enough history to fit a slope
+    for (size_t ue_idx = 0; ue_idx < cfg_->UeAntNum(); ue_idx++) {
+      auto* dst_csi_ptr = reinterpret_cast<float*>(csi_gather_buffer_ +
+                                                   cfg_->BsAntNum() * ue_idx);
+      auto* dst_old_ptr =
+          reinterpret_cast<float*>(old_csi_buffer + cfg_->BsAntNum() * ue_idx);
+      GatherCsi(cur_sc_id, csi_buffers_.At(frame_slot, ue_idx), dst_csi_ptr);
+      if (num_hist >= 2) {
+        const size_t old_slot = (frame_id - (num_hist - 1)) % cfg_->FrameWnd();
+        GatherCsi(cur_sc_id, csi_buffers_.At(old_slot, ue_idx), dst_old_ptr);
+      }
+    }
+
+    size_t start_tsc2 = GetTime::WorkerRdtsc();
+    duration_stat_->task_duration_[1] += start_tsc2 - start_tsc1;
+
+    arma::cx_fmat mat_csi((arma::cx_float*)csi_gather_buffer_, cfg_->BsAntNum(),
+                          cfg_->UeAntNum(), false);
+    arma::cx_fmat mat_pred((arma::cx_float*)pred_csi_buffer_, cfg_->BsAntNum(),
+                           cfg_->UeAntNum(), false);
+    if (num_hist >= 2) {
+      // Linear extrapolation one frame ahead using the mean per-frame slope
+      // across the history window
+      arma::cx_fmat mat_old((arma::cx_float*)old_csi_buffer, cfg_->BsAntNum(),
+                            cfg_->UeAntNum(), false);
+      const float slope_scale = 1.0f / static_cast<float>(num_hist - 1);
+      mat_pred = mat_csi + ((mat_csi - mat_old) * slope_scale);
+    } else {
+      // No history yet: carry the stale CSI forward unchanged
+      mat_pred = mat_csi;
+    }
+
+    if (cfg_->Frame().NumDLSyms() > 0) {
+      ComputeCalib(frame_id, cur_sc_id);
+    }
+    if (num_ext_ref_ > 0) {
+      mat_pred.shed_rows(ext_ref_id_);
+    }
+    // The beamweights are for the next frame, so its shed count applies
+    const size_t num_shed_ants = cfg_->AntShed(frame_id + 1);
+    if (num_shed_ants > 0) {
+      mat_pred.shed_rows(mat_pred.n_rows - num_shed_ants,
+                         mat_pred.n_rows - 1);
+    }
+
+    double start_tsc3 = GetTime::WorkerRdtsc();
+    duration_stat_->task_duration_[2] += start_tsc3 - start_tsc2;
+
+    // The input CSI and calibration are for the current frame; the output
+    // beamweights are for the next frame
+    dl_zf_unchanged_[next_slot][cur_sc_id] = false;
+    ComputePrecoder(mat_pred, calib_gather_buffer_,
+                    ul_zf_matrices_.At(next_slot, cur_sc_id),
+                    dl_zf_matrices_.At(next_slot, cur_sc_id), num_shed_ants);
+
+    duration_stat_->task_duration_[3] += GetTime::WorkerRdtsc() - start_tsc3;
+    const size_t task_cycles = GetTime::WorkerRdtsc() - start_tsc1;
+    duration_stat_->task_count_++;
+    duration_stat_->task_duration_[0] += task_cycles;
+    duration_hist_->Record(task_cycles);
+  }
 }
-*/
@@ -7,6 +7,7 @@
 
 #include <armadillo>
 #include <iostream>
+#include <vector>
 
 #include "buffer.h"
 #include "concurrentqueue.h"
@@ -14,6 +15,7 @@
 #include "doer.h"
 #include "gettime.h"
 #include "phy_stats.h"
+#include "small_linalg.h"
 #include "stats.h"
 #include "symbols.h"
 #include "utils.h"
@@ -28,7 +30,8 @@ class DoZF : public Doer {
        Table<complex_float>& calib_ul_msum_buffer,
        PtrGrid<kFrameWnd, kMaxDataSCs, complex_float>& ul_zf_matrices_,
        PtrGrid<kFrameWnd, kMaxDataSCs, complex_float>& dl_zf_matrices_,
-       PhyStats* in_phy_stats, Stats* stats_manager);
+       Table<bool>& dl_zf_unchanged, PhyStats* in_phy_stats,
+       Stats* stats_manager);
   ~DoZF() override;
 
   /**
@@ -52,36 +55,59 @@ class DoZF : public Doer {
  private:
   void ZfTimeOrthogonal(size_t tag);
 
+  /// Batched variant of ZfTimeOrthogonal() for uplink-only configurations:
+  /// gathers CSI for a cacheline of subcarriers, then inverts all of their
+  /// Gram matrices back to back with Cholesky (cpotrf/cpotri)
+  void ZfTimeOrthogonalBatched(size_t tag);
+
   /// Compute the uplink zeroforcing detector matrix and/or the downlink
-  /// zeroforcing precoder using this CSI matrix and calibration buffer
+  /// zeroforcing precoder using this CSI matrix and calibration buffer.
+  /// num_shed_ants > 0 means the caller shed that many trailing antenna
+  /// rows from mat_csi for load shedding; the written detector gets zero
+  /// columns for them so their unprocessed data is never combined
   float ComputePrecoder(const arma::cx_fmat& mat_csi, complex_float* calib_ptr,
-                        complex_float* mat_ul_zf, complex_float* mat_dl_zf);
+                        complex_float* mat_ul_zf, complex_float* mat_dl_zf,
+                        size_t num_shed_ants = 0);
+
+  /// Maximum-ratio-combining fast path: when mat_gram is diagonally
+  /// dominant enough (largest per-row off-diagonal energy ratio below
+  /// Config::ZfMrcThreshold()), write conjugate beamweights scaled by the
+  /// per-UE channel energy into mat_ul_zf and return true; otherwise leave
+  /// mat_ul_zf untouched and return false so the caller inverts as usual
+  bool TryMrcBeamweights(const arma::cx_fmat& mat_gram,
+                         const arma::cx_fmat& mat_csi,
+                         arma::cx_fmat& mat_ul_zf) const;
+
+  /// Gram product csi^H * csi, on the internal AVX2 kernel when
+  /// small_linalg_kernels is set and through Armadillo otherwise. The
+  /// inversion that consumes the result stays on Armadillo/LAPACK either
+  /// way (that is where the inv_sympd / pinv fallback semantics live)
+  arma::cx_fmat ComputeGram(const arma::cx_fmat& mat_csi) const;
   void ComputeCalib(size_t frame_id, size_t sc_id);
   void ZfFreqOrthogonal(size_t tag);
 
+  /// Gather one subcarrier's CSI column (one complex sample per BS antenna)
+  /// from a per-UE CSI buffer into dst, dispatching on the buffer layout
+  /// (kUsePartialTrans) and storage precision (Config::CsiFp16())
+  void GatherCsi(size_t cur_sc_id, const complex_float* src, float* dst) const;
+
   /**
-   * Do prediction task for one subcarrier
-   * @param tid: task thread index, used for selecting task ptok
-   * @param offset: offset of the subcarrier in csi_buffer_
-   * Buffers: csi_buffer_, pred_csi_buffer_, precoder_buffer_
-   *     Input buffer: csi_buffer_
-   *     Output buffer: precoder_buffer_
+   * Do prediction task for one block of subcarriers: extrapolate the CSI
+   * one frame ahead from up to ZfPredictFrames() frames of history and
+   * compute the next frame's beamweights from the predicted CSI, so they
+   * are ready before the next frame's pilots even arrive
+   * @param tag: frame and base subcarrier of the current frame's CSI
+   * Buffers: csi_buffers_, pred_csi_buffer_, ul/dl_zf_matrices_
+   *     Input buffer: csi_buffers_ (current and oldest frame in history)
+   *     Output buffer: ul_zf_matrices_/dl_zf_matrices_ at frame index + 1
    *     Intermediate buffer: pred_csi_buffer_
-   * Offsets:
-   *     csi_buffer_:
-   *         dim1: frame index * FFT size + subcarrier index in the current
-   * frame pred_csi_buffer: dim1: subcarrier index in the current frame
-   *     precoder_buffer_:
-   *         dim1: (frame index + 1) * FFT size + subcarrier index in the
-   * current frame Event offset: offset Description:
-   *     1. predict CSI (copy CSI from the current frame if prediction is
-   * based on stale CSI)
-   *     2. perform pseudo-inverse (pinv) on pred_csi_buffer_ and store
-   * results in precoder_buffer_
-   *     3. add an event to the message queue to infrom main thread the
-   * completion of this task
+   * Description:
+   *     1. predict CSI by linear extrapolation (copy CSI from the current
+   * frame if there is no history yet)
+   *     2. compute the zeroforcing detector/precoder on pred_csi_buffer_
+   * and store the results in the next frame's slot
    */
-  void Predict(size_t offset);
+  void Predict(size_t tag);
 
   PtrGrid<kFrameWnd, kMaxUEs, complex_float>& csi_buffers_;
   complex_float* pred_csi_buffer_;
@@ -91,11 +117,25 @@ class DoZF : public Doer {
   Table<complex_float> calib_ul_msum_buffer_;
   PtrGrid<kFrameWnd, kMaxDataSCs, complex_float>& ul_zf_matrices_;
   PtrGrid<kFrameWnd, kMaxDataSCs, complex_float>& dl_zf_matrices_;
+  // Per-(frame slot, subcarrier) flag set when the near-static cache reused
+  // the previous frame's beamweights unchanged, cleared when they are
+  // recomputed. DoPrecode reads it to skip frame-invariant work
+  Table<bool>& dl_zf_unchanged_;
   DurationStat* duration_stat_;
+  LatencyHistogram* duration_hist_;
 
   complex_float* csi_gather_buffer_;  // Intermediate buffer to gather CSI
+  // Gram matrices (and, after inversion, their inverses) for a batch of
+  // subcarriers in the batched inversion path
+  complex_float* gram_inv_buffer_;
   // Intermediate buffer to gather reciprical calibration data vector
   complex_float* calib_gather_buffer_;
+  // Per-subcarrier cache of the fused calibration vector, keyed by the
+  // calibration epoch (frame group) it was computed in. Calibration windows
+  // only change between epochs, so within an epoch the cached vector is
+  // exact and the per-frame multiply chain can be skipped.
+  complex_float* calib_cache_;
+  std::vector<size_t> calib_cache_epoch_;
   PhyStats* phy_stats_;
   arma::uvec ext_ref_id_;
   size_t num_ext_ref_;
@@ -0,0 +1,221 @@
+/**
+ * @file frame_dumper.cc
+ * @brief Implementation of the continuous frame-data capture spooler
+ * (see frame_dumper.h)
+ */
+#include "frame_dumper.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstring>
+
+#include "gettime.h"
+#include "logger.h"
+#include "utils.h"
+
+FrameDumper::FrameDumper(
+    Config* cfg, size_t core_offset,
+    PtrCube<kFrameWnd, kMaxSymbols, kMaxUEs, int8_t>& decoded_buffers,
+    char* dl_socket_buffer)
+    : cfg_(cfg),
+      core_offset_(core_offset),
+      decode_frame_bytes_(cfg->Frame().NumULSyms() * cfg->UeAntNum() *
+                          cfg->NumBytesPerCb() *
+                          cfg->LdpcConfig().NumBlocksInSymbol()),
+      tx_frame_bytes_(cfg->Frame().NumDLSyms() * cfg->BsAntNum() *
+                      cfg->SampsPerSymbol() * 2 * sizeof(short)),
+      decoded_buffers_(decoded_buffers),
+      dl_socket_buffer_(dl_socket_buffer),
+      decode_queue_(cfg_->FrameWnd()),
+      tx_queue_(cfg_->FrameWnd()) {
+  std::string directory = cfg->FrameDumpPath();
+  if (directory.empty() == true) {
+    directory = std::string(TOSTRING(PROJECT_DIRECTORY)) + "/data";
+  }
+  if (cfg->FrameDumpDecode() == true) {
+    RtAssert(cfg->Frame().NumULSyms() > 0,
+             "frame_dump_decode requires uplink symbols");
+    OpenStream(decode_stream_, directory + "/decode_capture.bin",
+               decode_frame_bytes_);
+  }
+  if (cfg->FrameDumpTx() == true) {
+    RtAssert(cfg->Frame().NumDLSyms() > 0,
+             "frame_dump_tx requires downlink symbols");
+    OpenStream(tx_stream_, directory + "/tx_capture.bin", tx_frame_bytes_);
+  }
+  running_ = true;
+  spool_thread_ = std::thread(&FrameDumper::RunLoop, this);
+}
+
+FrameDumper::~FrameDumper() {
+  running_ = false;
+  if (spool_thread_.joinable() == true) {
+    spool_thread_.join();
+  }
+  CloseStream(decode_stream_, "decode");
+  CloseStream(tx_stream_, "tx");
+  const uint64_t dropped = decode_dropped_.load() + tx_dropped_.load();
+  if (dropped > 0) {
+    std::printf("FrameDumper: disk fell behind, %lu frames dropped\n",
+                dropped);
+  }
+}
+
+void FrameDumper::PostDecode(size_t frame_id) {
+  if (decode_stream_.fd_ < 0) {
+    return;
+  }
+  if (decode_queue_.try_enqueue(frame_id) == false) {
+    decode_dropped_.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+void FrameDumper::PostTx(size_t frame_id) {
+  if (tx_stream_.fd_ < 0) {
+    return;
+  }
+  if (tx_queue_.try_enqueue(frame_id) == false) {
+    tx_dropped_.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+void FrameDumper::OpenStream(DumpStream& stream, const std::string& filename,
+                             size_t frame_bytes) {
+  stream.fd_ = open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_DIRECT,
+                    0644);
+  RtAssert(stream.fd_ >= 0,
+           "FrameDumper: failed to open " + filename + " for O_DIRECT writes");
+  // Room for one frame plus the sub-alignment tail carried over from the
+  // previous write
+  stream.staging_bytes_ =
+      ((frame_bytes + kDirectIoAlignment - 1) & ~(kDirectIoAlignment - 1)) +
+      kDirectIoAlignment;
+  for (auto*& buf : stream.staging_) {
+    buf = static_cast<uint8_t*>(Agora_memory::PaddedAlignedAlloc(
+        Agora_memory::Alignment_t::kAlign4096, stream.staging_bytes_));
+  }
+  std::printf("FrameDumper: capturing %zu bytes per frame to %s\n",
+              frame_bytes, filename.c_str());
+}
+
+void FrameDumper::FlushAligned(DumpStream& stream) {
+  const size_t aligned = stream.fill_ & ~(kDirectIoAlignment - 1);
+  if (aligned == 0) {
+    return;
+  }
+  const ssize_t ret = pwrite(stream.fd_, stream.staging_.at(stream.cur_),
+                             aligned, stream.file_offset_);
+  if (ret != static_cast<ssize_t>(aligned)) {
+    MLPD_ERROR("FrameDumper: pwrite of %zu bytes failed (%zd)\n", aligned,
+               ret);
+  }
+  stream.file_offset_ += aligned;
+  // Carry the unaligned tail into the other staging buffer, which becomes
+  // the one the next frame is gathered into
+  const size_t other = stream.cur_ ^ 1;
+  const size_t tail = stream.fill_ - aligned;
+  if (tail > 0) {
+    std::memcpy(stream.staging_.at(other),
+                stream.staging_.at(stream.cur_) + aligned, tail);
+  }
+  stream.cur_ = other;
+  stream.fill_ = tail;
+}
+
+void FrameDumper::CloseStream(DumpStream& stream, const char* label) {
+  if (stream.fd_ < 0) {
+    return;
+  }
+  if (stream.fill_ > 0) {
+    // The final sub-alignment tail cannot go out O_DIRECT; drop the flag
+    // for this one write
+    fcntl(stream.fd_, F_SETFL, fcntl(stream.fd_, F_GETFL) & ~O_DIRECT);
+    const ssize_t ret = pwrite(stream.fd_, stream.staging_.at(stream.cur_),
+                               stream.fill_, stream.file_offset_);
+    if (ret != static_cast<ssize_t>(stream.fill_)) {
+      MLPD_ERROR("FrameDumper: final pwrite of %zu bytes failed (%zd)\n",
+                 stream.fill_, ret);
+    }
+    stream.file_offset_ += stream.fill_;
+    stream.fill_ = 0;
+  }
+  close(stream.fd_);
+  stream.fd_ = -1;
+  for (auto*& buf : stream.staging_) {
+    std::free(buf);
+    buf = nullptr;
+  }
+  std::printf("FrameDumper: wrote %lu frames (%lu bytes) of %s data\n",
+              stream.frames_written_, stream.file_offset_, label);
+}
+
+void FrameDumper::GatherDecode(size_t frame_id) {
+  // Same layout SaveDecodeDataToFile writes: UL symbols outer, UEs inner,
+  // one symbol's decoded bytes per row
+  const size_t num_decoded_bytes =
+      cfg_->NumBytesPerCb() * cfg_->LdpcConfig().NumBlocksInSymbol();
+  uint8_t* dst = decode_stream_.staging_.at(decode_stream_.cur_) +
+                 decode_stream_.fill_;
+  for (size_t i = 0; i < cfg_->Frame().NumULSyms(); i++) {
+    for (size_t j = 0; j < cfg_->UeAntNum(); j++) {
+      std::memcpy(dst, decoded_buffers_[(frame_id % cfg_->FrameWnd())][i][j],
+                  num_decoded_bytes);
+      dst += num_decoded_bytes;
+    }
+  }
+  decode_stream_.fill_ += decode_frame_bytes_;
+  decode_stream_.frames_written_++;
+  FlushAligned(decode_stream_);
+}
+
+void FrameDumper::GatherTx(size_t frame_id) {
+  // Same layout SaveTxDataToFile writes: DL symbols outer, antennas inner,
+  // one symbol of IQ samples per row
+  const size_t bytes_per_ant = cfg_->SampsPerSymbol() * 2 * sizeof(short);
+  uint8_t* dst = tx_stream_.staging_.at(tx_stream_.cur_) + tx_stream_.fill_;
+  for (size_t i = 0; i < cfg_->Frame().NumDLSyms(); i++) {
+    const size_t total_data_symbol_id =
+        cfg_->GetTotalDataSymbolIdxDl(frame_id, i);
+    for (size_t ant_id = 0; ant_id < cfg_->BsAntNum(); ant_id++) {
+      const size_t offset = total_data_symbol_id * cfg_->BsAntNum() + ant_id;
+      std::memcpy(dst, &dl_socket_buffer_[offset * cfg_->DlPayloadLength()],
+                  bytes_per_ant);
+      dst += bytes_per_ant;
+    }
+  }
+  tx_stream_.fill_ += tx_frame_bytes_;
+  tx_stream_.frames_written_++;
+  FlushAligned(tx_stream_);
+}
+
+void FrameDumper::RunLoop() {
+  PinToCoreWithOffset(ThreadType::kWorkerTXRX, core_offset_, 0);
+  std::printf("FrameDumper: spool thread running on core %zu\n", core_offset_);
+
+  while (running_.load(std::memory_order_relaxed) == true) {
+    bool did_work = false;
+    size_t frame_id;
+    // Bounded to kFrameWnd outstanding frames, so the rows gathered here
+    // cannot have been reused by a newer frame yet
+    if (decode_queue_.try_dequeue(frame_id) == true) {
+      GatherDecode(frame_id);
+      did_work = true;
+    }
+    if (tx_queue_.try_dequeue(frame_id) == true) {
+      GatherTx(frame_id);
+      did_work = true;
+    }
+    if (did_work == false) {
+      GetTime::SpinPause();
+    }
+  }
+  // Capture whatever was still queued when the run ended
+  size_t frame_id;
+  while (decode_queue_.try_dequeue(frame_id) == true) {
+    GatherDecode(frame_id);
+  }
+  while (tx_queue_.try_dequeue(frame_id) == true) {
+    GatherTx(frame_id);
+  }
+}
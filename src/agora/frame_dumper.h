@@ -0,0 +1,102 @@
+/**
+ * @file frame_dumper.h
+ * @brief Declarations for the continuous frame-data capture spooler: a
+ * background thread that streams decoded bits and/or TX samples to disk
+ * with O_DIRECT writes while the run is live
+ */
+#ifndef FRAME_DUMPER_H_
+#define FRAME_DUMPER_H_
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+#include "buffer.h"
+#include "concurrentqueue.h"
+#include "config.h"
+#include "memory_manage.h"
+
+/**
+ * @brief Spools per-frame capture data to disk off the master's critical
+ * path.
+ *
+ * The shutdown-time SaveDecodeDataToFile/SaveTxDataToFile helpers write
+ * one frame synchronously through stdio, which stalls the master for
+ * milliseconds and cannot run continuously. With frame_dump_decode (or
+ * frame_dump_tx) set, the master instead posts each completed frame id to
+ * this spooler; one background thread gathers the frame's rows into an
+ * aligned staging buffer and appends them to the dump file with O_DIRECT
+ * writes, bypassing the page cache so multi-minute captures do not evict
+ * the working set. Two staging buffers alternate so the unaligned tail of
+ * one write can be carried into the next without copying it twice.
+ *
+ * The queue is bounded to kFrameWnd frames: if the disk falls behind the
+ * frame rate, whole frames are dropped and counted rather than blocking
+ * the master or letting the gather race the buffers' reuse.
+ */
+class FrameDumper {
+ public:
+  FrameDumper(Config* cfg, size_t core_offset,
+              PtrCube<kFrameWnd, kMaxSymbols, kMaxUEs, int8_t>& decoded_buffers,
+              char* dl_socket_buffer);
+  ~FrameDumper();
+
+  /// Post one fully-decoded (or fully-transmitted) frame for capture.
+  /// Called only from the master thread; never blocks
+  void PostDecode(size_t frame_id);
+  void PostTx(size_t frame_id);
+
+ private:
+  /// O_DIRECT writes need buffer, offset and length aligned to this
+  static constexpr size_t kDirectIoAlignment = 4096;
+
+  /// One capture file: its fd plus the double-buffered staging area.
+  /// fill_ counts the bytes staged so far in staging_[cur_], including
+  /// the unaligned tail carried over from the previous write
+  struct DumpStream {
+    int fd_ = -1;
+    std::array<uint8_t*, 2> staging_ = {nullptr, nullptr};
+    size_t staging_bytes_ = 0;
+    size_t cur_ = 0;
+    size_t fill_ = 0;
+    uint64_t file_offset_ = 0;
+    uint64_t frames_written_ = 0;
+  };
+
+  void RunLoop();
+  void OpenStream(DumpStream& stream, const std::string& filename,
+                  size_t frame_bytes);
+  /// Write the aligned prefix of the staging buffer and carry the
+  /// unaligned tail into the other one
+  void FlushAligned(DumpStream& stream);
+  /// Write the final unaligned tail (O_DIRECT dropped for this one write)
+  /// and close the file
+  void CloseStream(DumpStream& stream, const char* label);
+  void GatherDecode(size_t frame_id);
+  void GatherTx(size_t frame_id);
+
+  Config* const cfg_;
+  const size_t core_offset_;
+  // Bytes of one frame's capture payload per stream
+  const size_t decode_frame_bytes_;
+  const size_t tx_frame_bytes_;
+
+  PtrCube<kFrameWnd, kMaxSymbols, kMaxUEs, int8_t>& decoded_buffers_;
+  char* const dl_socket_buffer_;
+
+  DumpStream decode_stream_;
+  DumpStream tx_stream_;
+
+  // Bounded frame-id queues; a failed enqueue means the frame is dropped
+  moodycamel::ConcurrentQueue<size_t> decode_queue_;
+  moodycamel::ConcurrentQueue<size_t> tx_queue_;
+  std::atomic<uint64_t> decode_dropped_ = 0;
+  std::atomic<uint64_t> tx_dropped_ = 0;
+
+  std::atomic<bool> running_ = false;
+  std::thread spool_thread_;
+};
+
+#endif  // FRAME_DUMPER_H_
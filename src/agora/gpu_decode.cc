@@ -0,0 +1,187 @@
+/**
+ * @file gpu_decode.cc
+ * @brief Implementation of the CUDA LDPC decode backend (see gpu_decode.h)
+ */
+#include "gpu_decode.h"
+
+#ifdef USE_GPU_DECODE
+
+#include <cstring>
+
+#include "gettime.h"
+#include "logger.h"
+#include "utils.h"
+#include "utils_ldpc.h"
+
+/// RtAssert-style check for CUDA runtime calls
+static inline void CudaCheck(cudaError_t err, const char* what) {
+  RtAssert(err == cudaSuccess, std::string(what) + ": " +
+                                   std::string(cudaGetErrorString(err)));
+}
+
+GpuDecodeEngine::GpuDecodeEngine(
+    Config* cfg, size_t core_offset,
+    PtrCube<kFrameWnd, kMaxSymbols, kMaxUEs, int8_t>& demod_buffers,
+    PtrCube<kFrameWnd, kMaxSymbols, kMaxUEs, int8_t>& decoded_buffers,
+    moodycamel::ConcurrentQueue<EventData>* complete_queues,
+    size_t num_complete_queues, QueueNotifier* master_notifier)
+    : cfg_(cfg),
+      core_offset_(core_offset),
+      llr_stride_(Roundup<64>(cfg->LdpcConfig().NumCbCodewLen() +
+                              kLdpcHelperFunctionInputBufferSizePaddingBytes)),
+      out_stride_(Roundup<64>(cfg->NumBytesPerCb())),
+      llr_slice_bytes_((cfg->ModOrderBits() *
+                        cfg->LdpcConfig().NumCbCodewLen()) /
+                       (cfg->Llr4Bit() ? 2 : 1)),
+      max_cbs_per_batch_(cfg->UeAntNum() *
+                         cfg->LdpcConfig().NumBlocksInSymbol()),
+      demod_buffers_(demod_buffers),
+      decoded_buffers_(decoded_buffers),
+      complete_queues_(complete_queues),
+      num_complete_queues_(num_complete_queues),
+      master_notifier_(master_notifier),
+      scrambler_(std::make_unique<AgoraScrambler::Scrambler>()) {
+  const LDPCconfig& ldpc_config = cfg->LdpcConfig();
+  params_.base_graph_ = ldpc_config.BaseGraph();
+  params_.expansion_factor_ = ldpc_config.ExpansionFactor();
+  params_.num_rows_ = ldpc_config.NumRows();
+  params_.max_iterations_ = ldpc_config.MaxDecoderIter();
+  params_.early_termination_ = ldpc_config.EarlyTermination() ? 1 : 0;
+  params_.num_channel_llrs_ = ldpc_config.NumCbCodewLen();
+  params_.num_msg_bits_ = ldpc_config.NumCbLen();
+
+  slots_.resize(cfg->GpuDecodeStreams());
+  for (auto& slot : slots_) {
+    CudaCheck(cudaStreamCreateWithFlags(&slot.stream_, cudaStreamNonBlocking),
+              "GpuDecodeEngine: stream create");
+    CudaCheck(cudaHostAlloc(reinterpret_cast<void**>(&slot.pinned_llrs_),
+                            max_cbs_per_batch_ * llr_stride_,
+                            cudaHostAllocDefault),
+              "GpuDecodeEngine: pinned LLR alloc");
+    CudaCheck(cudaHostAlloc(reinterpret_cast<void**>(&slot.pinned_out_),
+                            max_cbs_per_batch_ * out_stride_,
+                            cudaHostAllocDefault),
+              "GpuDecodeEngine: pinned output alloc");
+    CudaCheck(cudaMalloc(reinterpret_cast<void**>(&slot.dev_llrs_),
+                         max_cbs_per_batch_ * llr_stride_),
+              "GpuDecodeEngine: device LLR alloc");
+    CudaCheck(cudaMalloc(reinterpret_cast<void**>(&slot.dev_out_),
+                         max_cbs_per_batch_ * out_stride_),
+              "GpuDecodeEngine: device output alloc");
+  }
+  std::printf(
+      "GpuDecodeEngine: %zu streams, up to %zu code blocks per batch, "
+      "symbols with fewer than %zu blocks stay on the CPU workers\n",
+      cfg->GpuDecodeStreams(), max_cbs_per_batch_, cfg->GpuDecodeMinCbs());
+  thread_ = std::thread(&GpuDecodeEngine::RunLoop, this);
+}
+
+GpuDecodeEngine::~GpuDecodeEngine() {
+  running_ = false;
+  if (thread_.joinable() == true) {
+    thread_.join();
+  }
+  for (auto& slot : slots_) {
+    cudaStreamSynchronize(slot.stream_);
+    cudaStreamDestroy(slot.stream_);
+    cudaFreeHost(slot.pinned_llrs_);
+    cudaFreeHost(slot.pinned_out_);
+    cudaFree(slot.dev_llrs_);
+    cudaFree(slot.dev_out_);
+  }
+}
+
+void GpuDecodeEngine::LaunchBatch(StreamSlot& slot, const EventData& event) {
+  const LDPCconfig& ldpc_config = cfg_->LdpcConfig();
+  for (size_t i = 0; i < event.num_tags_; i++) {
+    const gen_tag_t tag(event.tags_[i]);
+    const size_t symbol_idx_ul = cfg_->Frame().GetULSymbolIdx(tag.symbol_id_);
+    const size_t cur_cb_id = (tag.cb_id_ % ldpc_config.NumBlocksInSymbol());
+    const size_t ue_id = (tag.cb_id_ / ldpc_config.NumBlocksInSymbol());
+    const int8_t* llr_slice =
+        demod_buffers_[tag.frame_id_ % cfg_->FrameWnd()][symbol_idx_ul][ue_id] +
+        (cur_cb_id * llr_slice_bytes_);
+    int8_t* staged = slot.pinned_llrs_ + (i * llr_stride_);
+    if (cfg_->Llr4Bit() == true) {
+      UnpackLlrsFrom4Bit(llr_slice, staged,
+                         ldpc_config.NumCbCodewLen() +
+                             (ldpc_config.NumCbCodewLen() & 1));
+    } else {
+      std::memcpy(staged, llr_slice, llr_slice_bytes_);
+    }
+  }
+
+  CudaCheck(cudaMemcpyAsync(slot.dev_llrs_, slot.pinned_llrs_,
+                            event.num_tags_ * llr_stride_,
+                            cudaMemcpyHostToDevice, slot.stream_),
+            "GpuDecodeEngine: H2D copy");
+  const int decode_ret = AgoraGpuLdpcDecodeBatch(
+      &params_, slot.dev_llrs_, llr_stride_, slot.dev_out_, out_stride_,
+      event.num_tags_, slot.stream_);
+  RtAssert(decode_ret == 0, "GpuDecodeEngine: device decode launch failed");
+  CudaCheck(cudaMemcpyAsync(slot.pinned_out_, slot.dev_out_,
+                            event.num_tags_ * out_stride_,
+                            cudaMemcpyDeviceToHost, slot.stream_),
+            "GpuDecodeEngine: D2H copy");
+  slot.event_ = event;
+  slot.busy_ = true;
+}
+
+void GpuDecodeEngine::CompleteBatch(StreamSlot& slot) {
+  const LDPCconfig& ldpc_config = cfg_->LdpcConfig();
+  const size_t decoded_cb_bytes = cfg_->NumBytesPerCb();
+  for (size_t i = 0; i < slot.event_.num_tags_; i++) {
+    const gen_tag_t tag(slot.event_.tags_[i]);
+    const size_t symbol_idx_ul = cfg_->Frame().GetULSymbolIdx(tag.symbol_id_);
+    const size_t cur_cb_id = (tag.cb_id_ % ldpc_config.NumBlocksInSymbol());
+    const size_t ue_id = (tag.cb_id_ / ldpc_config.NumBlocksInSymbol());
+    uint8_t* staged = slot.pinned_out_ + (i * out_stride_);
+    if (cfg_->ScrambleEnabled()) {
+      scrambler_->Descramble(staged, decoded_cb_bytes);
+    }
+    std::memcpy(
+        decoded_buffers_[cfg_->FrameSlot(tag.frame_id_)][symbol_idx_ul]
+                        [ue_id] +
+            (cur_cb_id * Roundup<64>(decoded_cb_bytes)),
+        staged, decoded_cb_bytes);
+  }
+
+  const size_t frame_id = gen_tag_t(slot.event_.tags_[0]).frame_id_;
+  TryEnqueueFallback(&complete_queues_[frame_id % num_complete_queues_],
+                     slot.event_);
+  master_notifier_->Notify();
+  slot.busy_ = false;
+}
+
+void GpuDecodeEngine::RunLoop() {
+  PinToCoreWithOffset(ThreadType::kWorkerTXRX, core_offset_, 0);
+
+  while (running_.load(std::memory_order_relaxed) == true) {
+    bool did_work = false;
+
+    for (auto& slot : slots_) {
+      if (slot.busy_ == false) {
+        EventData req_event;
+        if (request_queue_.try_dequeue(req_event) == true) {
+          did_work = true;
+          LaunchBatch(slot, req_event);
+        }
+        break;  // At most one new launch per pass keeps completions fresh
+      }
+    }
+
+    for (auto& slot : slots_) {
+      if ((slot.busy_ == true) &&
+          (cudaStreamQuery(slot.stream_) == cudaSuccess)) {
+        did_work = true;
+        CompleteBatch(slot);
+      }
+    }
+
+    if (did_work == false) {
+      GetTime::SpinPause();
+    }
+  }
+}
+
+#endif  // USE_GPU_DECODE
@@ -0,0 +1,123 @@
+/**
+ * @file gpu_decode.h
+ * @brief Declarations for the CUDA LDPC decode backend: a staging engine
+ * that batches a symbol's LLR blocks, ships them through pinned memory and
+ * async streams to an external GPU decoder, and feeds the decoded bytes
+ * back through the master's normal completion path
+ */
+#ifndef GPU_DECODE_H_
+#define GPU_DECODE_H_
+
+#ifdef USE_GPU_DECODE
+
+#include <cuda_runtime.h>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "buffer.h"
+#include "concurrent_queue_wrapper.h"
+#include "concurrentqueue.h"
+#include "config.h"
+#include "memory_manage.h"
+#include "scrambler.h"
+
+/// LDPC parameters passed to the external GPU decoder. Every code block of
+/// a run shares them, so they are filled once at engine construction.
+struct GpuLdpcParams {
+  int16_t base_graph_;
+  uint16_t expansion_factor_;
+  int16_t num_rows_;
+  int16_t max_iterations_;
+  int8_t early_termination_;
+  int32_t num_channel_llrs_;
+  int32_t num_msg_bits_;
+};
+
+/// Entry point of the external GPU decoder library (GPU_DECODE_LIB at
+/// build time, the CUDA analogue of the FlexRAN SDK dependency on the CPU
+/// path). Decodes num_cbs code blocks from device memory: byte LLRs at
+/// d_llrs + i * llr_stride, packed message bytes to d_out + i * out_stride.
+/// All work is enqueued on the given stream; returns 0 on success.
+extern "C" int AgoraGpuLdpcDecodeBatch(const GpuLdpcParams* params,
+                                       const int8_t* d_llrs, size_t llr_stride,
+                                       uint8_t* d_out, size_t out_stride,
+                                       size_t num_cbs, cudaStream_t stream);
+
+/**
+ * @brief Routes large-batch LDPC decode through a CUDA device.
+ *
+ * When gpu_decode is set, the master hands whole-symbol kDecode batches of
+ * at least gpu_decode_min_cbs code blocks to this engine instead of the
+ * worker queues; smaller batches keep the low-latency CPU path. One engine
+ * thread gathers each batch's LLR slices from demod_buffers_ into pinned
+ * staging, issues the H2D copy, decode and D2H copy asynchronously on one
+ * of gpu_decode_streams streams, and on stream completion copies the bytes
+ * into the decoded buffer and enqueues the same kDecode completion event a
+ * CPU worker would have produced. The master loop is oblivious.
+ */
+class GpuDecodeEngine {
+ public:
+  GpuDecodeEngine(
+      Config* cfg, size_t core_offset,
+      PtrCube<kFrameWnd, kMaxSymbols, kMaxUEs, int8_t>& demod_buffers,
+      PtrCube<kFrameWnd, kMaxSymbols, kMaxUEs, int8_t>& decoded_buffers,
+      moodycamel::ConcurrentQueue<EventData>* complete_queues,
+      size_t num_complete_queues, QueueNotifier* master_notifier);
+  ~GpuDecodeEngine();
+
+  /// Accept one batched decode request event from the master. Called only
+  /// from the master thread.
+  void Offload(const EventData& event) { request_queue_.enqueue(event); }
+
+ private:
+  /// One in-flight batch: a stream plus its pinned and device staging
+  struct StreamSlot {
+    cudaStream_t stream_;
+    int8_t* pinned_llrs_;
+    uint8_t* pinned_out_;
+    int8_t* dev_llrs_;
+    uint8_t* dev_out_;
+    EventData event_;
+    bool busy_ = false;
+  };
+
+  void RunLoop();
+  /// Stage a request's LLR blocks and launch its async pipeline
+  void LaunchBatch(StreamSlot& slot, const EventData& event);
+  /// Scatter a finished batch's bytes and post its completion event
+  void CompleteBatch(StreamSlot& slot);
+
+  Config* const cfg_;
+  const size_t core_offset_;
+  // Per-block strides in the staging buffers: byte LLRs in (4-bit packed
+  // LLRs are expanded while gathering), packed message bytes out
+  const size_t llr_stride_;
+  const size_t out_stride_;
+  // Bytes of one code block's LLR slice as stored in demod_buffers_
+  const size_t llr_slice_bytes_;
+  const size_t max_cbs_per_batch_;
+  GpuLdpcParams params_;
+
+  PtrCube<kFrameWnd, kMaxSymbols, kMaxUEs, int8_t>& demod_buffers_;
+  PtrCube<kFrameWnd, kMaxSymbols, kMaxUEs, int8_t>& decoded_buffers_;
+  moodycamel::ConcurrentQueue<EventData>* const complete_queues_;
+  // Completion queue count (Agora::kScheduleQueues); completions go to
+  // queue frame_id % num_complete_queues_ like any worker's
+  const size_t num_complete_queues_;
+  QueueNotifier* const master_notifier_;
+
+  moodycamel::ConcurrentQueue<EventData> request_queue_;
+  std::vector<StreamSlot> slots_;
+  // Descrambles decoded bytes on the host, matching the CPU decode path
+  std::unique_ptr<AgoraScrambler::Scrambler> scrambler_;
+
+  std::atomic<bool> running_ = true;
+  std::thread thread_;
+};
+
+#endif  // USE_GPU_DECODE
+
+#endif  // GPU_DECODE_H_
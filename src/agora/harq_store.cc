@@ -0,0 +1,103 @@
+/**
+ * @file harq_store.cc
+ * @brief Implementation file for the HarqStore class.
+ */
+#include "harq_store.h"
+
+#include <immintrin.h>
+#include <sys/mman.h>
+
+#include <cstring>
+
+#include "memory_manage.h"
+
+HarqStore::HarqStore(size_t num_ues, size_t num_symbols, size_t slot_bytes,
+                     size_t num_slots)
+    : num_symbols_(num_symbols),
+      slot_bytes_(slot_bytes),
+      num_slots_(num_slots),
+      slot_of_key_(num_ues * num_symbols),
+      combines_(num_slots, 0),
+      free_slots_(num_slots),
+      free_count_(num_slots) {
+  pool_ = static_cast<int8_t*>(Agora_memory::PaddedAlignedAlloc(
+      Agora_memory::Alignment_t::kAlign4096, num_slots * slot_bytes));
+#ifdef MADV_HUGEPAGE
+  // Page-aligned, so THP can back the whole pool with hugepages
+  madvise(pool_, num_slots * slot_bytes, MADV_HUGEPAGE);
+#endif
+  for (auto& key : slot_of_key_) {
+    key.store(SIZE_MAX, std::memory_order_relaxed);
+  }
+  for (size_t i = 0; i < num_slots; i++) {
+    free_slots_.at(i) = i;
+  }
+}
+
+HarqStore::~HarqStore() { std::free(pool_); }
+
+int8_t* HarqStore::Held(size_t ue_id, size_t symbol_idx_ul) const {
+  const size_t slot = slot_of_key_.at((ue_id * num_symbols_) + symbol_idx_ul)
+                          .load(std::memory_order_acquire);
+  if (slot == SIZE_MAX) {
+    return nullptr;
+  }
+  return pool_ + (slot * slot_bytes_);
+}
+
+void HarqStore::Store(size_t ue_id, size_t symbol_idx_ul, const int8_t* llrs) {
+  auto& key = slot_of_key_.at((ue_id * num_symbols_) + symbol_idx_ul);
+  size_t slot = key.load(std::memory_order_relaxed);
+  if (slot != SIZE_MAX) {
+    // The pair already holds a slot from an earlier failed attempt
+    if (combines_.at(slot) >= kMaxCombines) {
+      this->Release(ue_id, symbol_idx_ul);
+      return;
+    }
+    combines_.at(slot)++;
+  } else {
+    {
+      std::scoped_lock lock(free_mutex_);
+      if (free_count_ == 0) {
+        return;  // Pool exhausted; this failure is not held
+      }
+      slot = free_slots_.at(free_head_);
+      free_head_ = (free_head_ + 1) % num_slots_;
+      free_count_--;
+    }
+    combines_.at(slot) = 0;
+  }
+  std::memcpy(pool_ + (slot * slot_bytes_), llrs, slot_bytes_);
+  key.store(slot, std::memory_order_release);
+}
+
+void HarqStore::Release(size_t ue_id, size_t symbol_idx_ul) {
+  auto& key = slot_of_key_.at((ue_id * num_symbols_) + symbol_idx_ul);
+  const size_t slot = key.exchange(SIZE_MAX, std::memory_order_acq_rel);
+  if (slot == SIZE_MAX) {
+    return;
+  }
+  std::scoped_lock lock(free_mutex_);
+  free_slots_.at((free_head_ + free_count_) % num_slots_) = slot;
+  free_count_++;
+}
+
+void HarqStore::CombineLlrs(const int8_t* held, int8_t* incoming,
+                            size_t bytes) {
+  size_t i = 0;
+  for (; (i + 32) <= bytes; i += 32) {
+    const __m256i a =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(held + i));
+    const __m256i b =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(incoming + i));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(incoming + i),
+                        _mm256_adds_epi8(a, b));
+  }
+  for (; i < bytes; i++) {
+    const int sum = static_cast<int>(held[i]) + static_cast<int>(incoming[i]);
+    incoming[i] =
+        static_cast<int8_t>(sum > INT8_MAX
+                                ? INT8_MAX
+                                : (sum < INT8_MIN ? INT8_MIN : sum));
+  }
+}
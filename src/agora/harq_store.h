@@ -0,0 +1,82 @@
+/**
+ * @file harq_store.h
+ * @brief Declaration file for the HarqStore class, a pooled store of soft
+ * LLRs from failed decode attempts used for retransmission combining.
+ */
+#ifndef HARQ_STORE_H_
+#define HARQ_STORE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+/**
+ * @brief Pooled circular store of demodulator soft output (LLRs) for
+ * (UE, uplink symbol) pairs whose MAC packet failed its CRC.
+ *
+ * When a packet fails, DoDecode stashes the symbol's LLRs here; when the
+ * next frame carries the same symbol index, DoDecode adds the held LLRs
+ * onto the incoming ones (saturating) before decoding, so retransmission
+ * energy accumulates instead of being dropped. Slots come from one
+ * hugepage-backed pool sized at construction; when the pool is exhausted a
+ * failure is simply not held, which degrades to today's drop behavior.
+ *
+ * Concurrency: the per-key slot index is atomic so decode workers can look
+ * a held buffer up without a lock; within one frame, workers combining
+ * different code blocks of the same symbol touch disjoint slices of the
+ * held buffer. Store() and Release() only run in the worker that decoded
+ * all blocks of the (UE, symbol) pair, and the free list behind them is
+ * mutex-protected since failures are off the common path.
+ */
+class HarqStore {
+ public:
+  /// Give up on a (UE, symbol) pair after this many combined retransmissions
+  static constexpr size_t kMaxCombines = 3;
+
+  HarqStore(size_t num_ues, size_t num_symbols, size_t slot_bytes,
+            size_t num_slots);
+  ~HarqStore();
+
+  HarqStore(HarqStore const&) = delete;
+  HarqStore& operator=(HarqStore const&) = delete;
+
+  /// Return the LLRs held from a failed attempt at this (UE, symbol) pair,
+  /// or nullptr when none are held
+  int8_t* Held(size_t ue_id, size_t symbol_idx_ul) const;
+
+  /// Hold a copy of this symbol's LLRs (already combined with any earlier
+  /// attempts by the caller). Drops silently when the pool is exhausted or
+  /// the pair has reached kMaxCombines.
+  void Store(size_t ue_id, size_t symbol_idx_ul, const int8_t* llrs);
+
+  /// Return the pair's slot to the pool after a successful decode
+  void Release(size_t ue_id, size_t symbol_idx_ul);
+
+  /// Saturating per-byte add of the held LLRs into the incoming buffer
+  static void CombineLlrs(const int8_t* held, int8_t* incoming, size_t bytes);
+
+ private:
+  const size_t num_symbols_;
+  const size_t slot_bytes_;
+  const size_t num_slots_;
+
+  // The backing pool; slot i starts at (i * slot_bytes_)
+  int8_t* pool_;
+
+  // Slot index held by each (UE, symbol) key, SIZE_MAX when none. Flat
+  // [num_ues * num_symbols_] layout, indexed by (ue * num_symbols_ + sym).
+  std::vector<std::atomic<size_t>> slot_of_key_;
+
+  // Combined retransmission count per slot
+  std::vector<size_t> combines_;
+
+  // Circular free list of slot indices
+  std::vector<size_t> free_slots_;
+  size_t free_head_ = 0;
+  size_t free_count_;
+  std::mutex free_mutex_;
+};
+
+#endif  // HARQ_STORE_H_
@@ -9,6 +9,10 @@
 DEFINE_string(conf_file,
               TOSTRING(PROJECT_DIRECTORY) "/data/tddconfig-sim-both.json",
               "Config filename");
+DEFINE_bool(dry_run, false,
+            "Print the memory plan for the config and exit without "
+            "allocating; fails if the plan exceeds free hugepages plus "
+            "available memory");
 
 int main(int argc, char* argv[]) {
   gflags::SetUsageMessage("conf_file : set the configuration filename");
@@ -26,6 +30,15 @@ int main(int argc, char* argv[]) {
   }
 
   std::unique_ptr<Config> cfg = std::make_unique<Config>(conf_file.c_str());
+
+  if (FLAGS_dry_run == true) {
+    // Capacity planning only: report what this config would allocate and
+    // whether the machine can back it, without allocating any of it
+    const bool fits = Agora::PrintMemoryPlan(cfg.get());
+    gflags::ShutDownCommandLineFlags();
+    return fits ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+
   cfg->GenData();
 
   int ret;
@@ -4,10 +4,14 @@
  */
 #include "phy_stats.h"
 
+#include <immintrin.h>
+
 #include <cfloat>
 #include <cmath>
 
 PhyStats::PhyStats(Config* const cfg, Direction dir) : config_(cfg), dir_(dir) {
+  evm_decimation_ = cfg->EvmDecimation();
+  evm_sc_count_ = (cfg->OfdmDataNum() + evm_decimation_ - 1) / evm_decimation_;
   if (dir_ == Direction::kDownlink) {
     num_rx_symbols_ = cfg->Frame().NumDLSyms();
   } else {
@@ -24,6 +28,12 @@ PhyStats::PhyStats(Config* const cfg, Direction dir) : config_(cfg), dir_(dir) {
                                Agora_memory::Alignment_t::kAlign64);
   block_error_count_.Calloc(cfg->UeAntNum(), task_buffer_symbol_num,
                             Agora_memory::Alignment_t::kAlign64);
+  decoder_iter_count_.Calloc(cfg->UeAntNum(), task_buffer_symbol_num,
+                             Agora_memory::Alignment_t::kAlign64);
+  mac_crc_count_.Calloc(cfg->UeAntNum(), task_buffer_symbol_num,
+                        Agora_memory::Alignment_t::kAlign64);
+  mac_crc_error_count_.Calloc(cfg->UeAntNum(), task_buffer_symbol_num,
+                              Agora_memory::Alignment_t::kAlign64);
 
   uncoded_bits_count_.Calloc(cfg->UeAntNum(), task_buffer_symbol_num,
                              Agora_memory::Alignment_t::kAlign64);
@@ -34,20 +44,17 @@ PhyStats::PhyStats(Config* const cfg, Direction dir) : config_(cfg), dir_(dir) {
                      Agora_memory::Alignment_t::kAlign64);
 
   if (num_rx_symbols_ > 0) {
+    // Point at the config's own frequency-domain IQ instead of keeping a
+    // transposed copy of the full subcarrier grid; only the sampled
+    // subcarriers get materialized, one row at a time, on first use
     if (dir_ == Direction::kDownlink) {
-      auto* dl_iq_f_ptr = reinterpret_cast<arma::cx_float*>(
-          cfg->DlIqF()[cfg->Frame().ClientDlPilotSymbols()]);
-      arma::cx_fmat dl_iq_f_mat(dl_iq_f_ptr, cfg->OfdmCaNum(), cfg->UeAntNum(),
-                                false);
-      gt_mat_ = dl_iq_f_mat.st();
+      gt_src_ = cfg->DlIqF()[cfg->Frame().ClientDlPilotSymbols()];
     } else {
-      auto* ul_iq_f_ptr = reinterpret_cast<arma::cx_float*>(
-          cfg->UlIqF()[cfg->Frame().ClientUlPilotSymbols()]);
-      arma::cx_fmat ul_iq_f_mat(ul_iq_f_ptr, cfg->OfdmCaNum(), cfg->UeAntNum(),
-                                false);
-      gt_mat_ = ul_iq_f_mat.st();
+      gt_src_ = cfg->UlIqF()[cfg->Frame().ClientUlPilotSymbols()];
     }
-    gt_mat_ = gt_mat_.cols(cfg->OfdmDataStart(), (cfg->OfdmDataStop() - 1));
+    gt_sampled_.Calloc(evm_sc_count_, 2 * cfg->UeAntNum(),
+                       Agora_memory::Alignment_t::kAlign64);
+    gt_materialized_ = std::make_unique<std::atomic<bool>[]>(evm_sc_count_);
   }
   pilot_snr_.Calloc(kFrameWnd, cfg->UeAntNum() * cfg->BsAntNum(),
                     Agora_memory::Alignment_t::kAlign64);
@@ -63,11 +70,15 @@ PhyStats::~PhyStats() {
 
   decoded_blocks_count_.Free();
   block_error_count_.Free();
+  decoder_iter_count_.Free();
+  mac_crc_count_.Free();
+  mac_crc_error_count_.Free();
 
   uncoded_bits_count_.Free();
   uncoded_bit_error_count_.Free();
 
   evm_buffer_.Free();
+  gt_sampled_.Free();
   pilot_snr_.Free();
   csi_cond_.Free();
   calib_pilot_snr_.Free();
@@ -88,20 +99,35 @@ void PhyStats::PrintPhyStats() {
       size_t total_bit_errors(0);
       size_t total_decoded_blocks(0);
       size_t total_block_errors(0);
+      size_t total_decoder_iters(0);
+      size_t total_crc_checks(0);
+      size_t total_crc_errors(0);
 
       for (size_t i = 0u; i < task_buffer_symbol_num; i++) {
         total_decoded_bits += decoded_bits_count_[ue_id][i];
         total_bit_errors += bit_error_count_[ue_id][i];
         total_decoded_blocks += decoded_blocks_count_[ue_id][i];
         total_block_errors += block_error_count_[ue_id][i];
+        total_decoder_iters += decoder_iter_count_[ue_id][i];
+        total_crc_checks += mac_crc_count_[ue_id][i];
+        total_crc_errors += mac_crc_error_count_[ue_id][i];
       }
       std::cout << "UE " << ue_id << ": " << tx_type << " bit errors (BER) "
                 << total_bit_errors << "/" << total_decoded_bits << "("
                 << 1.0 * total_bit_errors / total_decoded_bits
                 << "), block errors (BLER) " << total_block_errors << "/"
                 << total_decoded_blocks << " ("
-                << 1.0 * total_block_errors / total_decoded_blocks << ")"
+                << 1.0 * total_block_errors / total_decoded_blocks
+                << "), avg decoder iterations "
+                << 1.0 * total_decoder_iters / total_decoded_blocks
                 << std::endl;
+      if (total_crc_checks > 0) {
+        std::cout << "UE " << ue_id << ": " << tx_type
+                  << " MAC packet CRC failures " << total_crc_errors << "/"
+                  << total_crc_checks << " ("
+                  << 1.0 * total_crc_errors / total_crc_checks << ")"
+                  << std::endl;
+      }
     }
   }
 }
@@ -109,7 +135,7 @@ void PhyStats::PrintPhyStats() {
 void PhyStats::PrintEvmStats(size_t frame_id) {
   arma::fmat evm_mat(evm_buffer_[frame_id % kFrameWnd], config_->UeAntNum(), 1,
                      false);
-  evm_mat = sqrt(evm_mat) / config_->OfdmDataNum();
+  evm_mat = sqrt(evm_mat) / evm_sc_count_;
   std::stringstream ss;
   ss << "Frame " << frame_id << " Constellation:\n"
      << "  EVM " << 100 * evm_mat.st() << ", SNR " << -10 * log10(evm_mat.st());
@@ -118,7 +144,7 @@ void PhyStats::PrintEvmStats(size_t frame_id) {
 
 float PhyStats::GetEvmSnr(size_t frame_id, size_t ue_id) {
   float evm = evm_buffer_[frame_id % kFrameWnd][ue_id];
-  evm = std::sqrt(evm) / config_->OfdmDataNum();
+  evm = std::sqrt(evm) / evm_sc_count_;
   return -10 * std::log10(evm);
 }
 
@@ -261,13 +287,52 @@ void PhyStats::UpdateCsiCond(size_t frame_id, size_t sc_id, float cond) {
   csi_cond_[frame_id % kFrameWnd][sc_id] = cond;
 }
 
+void PhyStats::MaterializeGtRow(size_t row) {
+  const size_t ue_num = config_->UeAntNum();
+  const size_t src_sc = (row * evm_decimation_) + config_->OfdmDataStart();
+  float* dst = gt_sampled_[row];
+  for (size_t ue = 0; ue < ue_num; ue++) {
+    const complex_float& gt =
+        gt_src_[(ue * config_->OfdmCaNum()) + src_sc];
+    dst[2 * ue] = gt.re;
+    dst[(2 * ue) + 1] = gt.im;
+  }
+  gt_materialized_[row].store(true, std::memory_order_release);
+}
+
 void PhyStats::UpdateEvmStats(size_t frame_id, size_t sc_id,
-                              const arma::cx_fmat& eq) {
-  if (num_rx_symbols_ > 0) {
-    arma::fmat evm = abs(eq - gt_mat_.col(sc_id));
-    arma::fmat cur_evm_mat(evm_buffer_[frame_id % kFrameWnd],
-                           config_->UeAntNum(), 1, false);
-    cur_evm_mat += evm % evm;
+                              const complex_float* eq_vec) {
+  if ((num_rx_symbols_ == 0) || ((sc_id % evm_decimation_) != 0)) {
+    return;
+  }
+  const size_t ue_num = config_->UeAntNum();
+  const auto* eq = reinterpret_cast<const float*>(eq_vec);
+  const size_t row = sc_id / evm_decimation_;
+  if (gt_materialized_[row].load(std::memory_order_acquire) == false) {
+    MaterializeGtRow(row);
+  }
+  const float* gt = gt_sampled_[row];
+  float* evm_accum = evm_buffer_[frame_id % kFrameWnd];
+
+  // Accumulate |eq - gt|^2 per UE, four UEs (eight floats) per iteration
+  size_t i = 0;
+  for (; (i + 4) <= ue_num; i += 4) {
+    const __m256 diff = _mm256_sub_ps(_mm256_loadu_ps(&eq[2 * i]),
+                                      _mm256_loadu_ps(&gt[2 * i]));
+    const __m256 sq = _mm256_mul_ps(diff, diff);
+    // Pairwise re^2 + im^2: each 128-bit lane of hadd holds the power of
+    // its two UEs duplicated, so one shuffle yields [p0 p1 p2 p3]
+    const __m256 pair_sums = _mm256_hadd_ps(sq, sq);
+    const __m128 lo = _mm256_castps256_ps128(pair_sums);
+    const __m128 hi = _mm256_extractf128_ps(pair_sums, 1);
+    const __m128 powers = _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(1, 0, 1, 0));
+    _mm_storeu_ps(&evm_accum[i],
+                  _mm_add_ps(_mm_loadu_ps(&evm_accum[i]), powers));
+  }
+  for (; i < ue_num; i++) {
+    const float re = eq[2 * i] - gt[2 * i];
+    const float im = eq[(2 * i) + 1] - gt[(2 * i) + 1];
+    evm_accum[i] += (re * re) + (im * im);
   }
 }
 
@@ -300,6 +365,18 @@ void PhyStats::IncrementDecodedBlocks(size_t ue_id, size_t offset) {
   decoded_blocks_count_[ue_id][offset]++;
 }
 
+void PhyStats::UpdateDecoderIterations(size_t ue_id, size_t offset,
+                                       size_t iterations) {
+  decoder_iter_count_[ue_id][offset] += iterations;
+}
+
+void PhyStats::UpdateMacCrcResult(size_t ue_id, size_t offset, bool match) {
+  mac_crc_count_[ue_id][offset]++;
+  if (match == false) {
+    mac_crc_error_count_[ue_id][offset]++;
+  }
+}
+
 void PhyStats::UpdateUncodedBitErrors(size_t ue_id, size_t offset,
                                       size_t mod_bit_size, uint8_t tx_byte,
                                       uint8_t rx_byte) {
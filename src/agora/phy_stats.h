@@ -7,6 +7,9 @@
 
 #include <armadillo>
 
+#include <atomic>
+#include <memory>
+
 #include "config.h"
 #include "memory_manage.h"
 #include "symbols.h"
@@ -23,13 +26,21 @@ class PhyStats {
   void UpdateBlockErrors(size_t /*ue_id*/, size_t /*offset*/,
                          size_t /*block_error_count*/);
   void IncrementDecodedBlocks(size_t /*ue_id*/, size_t /*offset*/);
+  void UpdateDecoderIterations(size_t /*ue_id*/, size_t /*offset*/,
+                               size_t /*iterations*/);
+  void UpdateMacCrcResult(size_t /*ue_id*/, size_t /*offset*/,
+                          bool /*match*/);
   void UpdateUncodedBitErrors(size_t /*ue_id*/, size_t /*offset*/,
                               size_t /*mod_bit_size*/, uint8_t /*tx_byte*/,
                               uint8_t /*rx_byte*/);
   void UpdateUncodedBits(size_t /*ue_id*/, size_t /*offset*/,
                          size_t /*new_bits_num*/);
+  /// Accumulate |equalized - ground truth|^2 per UE for one subcarrier.
+  /// eq_vec holds UeAntNum() equalized symbols. Subcarriers are sampled
+  /// 1-in-EvmDecimation(); calls for unsampled subcarriers return
+  /// immediately
   void UpdateEvmStats(size_t /*frame_id*/, size_t /*sc_id*/,
-                      const arma::cx_fmat& /*eq*/);
+                      const complex_float* /*eq_vec*/);
   void PrintEvmStats(size_t /*frame_id*/);
   float GetEvmSnr(size_t frame_id, size_t ue_id);
   void UpdatePilotSnr(size_t /*frame_id*/, size_t /*ue_id*/, size_t /*ant_id*/,
@@ -43,12 +54,20 @@ class PhyStats {
   void PrintZfStats(size_t /*frame_id*/);
 
  private:
+  /// Fill one row of gt_sampled_ from the config's IQ and publish it.
+  /// Concurrent calls for the same row write identical values, so the
+  /// race between workers is benign
+  void MaterializeGtRow(size_t row);
+
   Config const* const config_;
   Direction dir_;
   Table<size_t> decoded_bits_count_;
   Table<size_t> bit_error_count_;
   Table<size_t> decoded_blocks_count_;
   Table<size_t> block_error_count_;
+  Table<size_t> decoder_iter_count_;
+  Table<size_t> mac_crc_count_;
+  Table<size_t> mac_crc_error_count_;
   Table<size_t> uncoded_bits_count_;
   Table<size_t> uncoded_bit_error_count_;
   Table<float> evm_buffer_;
@@ -56,8 +75,21 @@ class PhyStats {
   Table<float> calib_pilot_snr_;
   Table<float> csi_cond_;
 
-  arma::cx_fmat gt_mat_;
+  // Ground truth for the sampled subcarriers only, kept as interleaved
+  // (I, Q) floats per UE antenna. Rows are materialized lazily on first
+  // comparison from the config's frequency-domain IQ (the same data
+  // DataGenerator produced), so the resident footprint tracks the EVM
+  // sampling pattern instead of the full subcarrier grid
+  Table<float> gt_sampled_;
+  std::unique_ptr<std::atomic<bool>[]> gt_materialized_;
+  // One symbol of OfdmCaNum() x UeAntNum() IQ in the config, UE major
+  const complex_float* gt_src_ = nullptr;
   size_t num_rx_symbols_;
+
+  // EVM subcarrier decimation factor and the resulting number of sampled
+  // subcarriers, which normalizes the accumulated error power
+  size_t evm_decimation_;
+  size_t evm_sc_count_;
 };
 
 #endif  // PHY_STATS_H_
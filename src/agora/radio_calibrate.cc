@@ -10,6 +10,11 @@ static constexpr size_t kMaxArraySampleOffset = 10;
 static constexpr bool kReciprocalCalibPlot = false;
 static constexpr bool kIQImbalancePlot = false;
 static constexpr bool kVerboseCalibration = false;
+// Compensate the residual sub-sample offset left by the integer peak
+// search. The fractional delay appears as a per-subcarrier phase ramp in
+// the calibration estimates, which would otherwise degrade the
+// conditioning of the downlink precoder.
+static constexpr bool kFracSampleOffsetComp = true;
 
 std::vector<std::complex<float>> RadioConfig::SnoopSamples(
     SoapySDR::Device* dev, size_t channel, size_t readSize) {
@@ -750,6 +755,8 @@ bool RadioConfig::InitialCalib(bool sample_adjust) {
     std::vector<std::vector<std::complex<float>>> dn(m);
     std::vector<size_t> start_up(m, 0);
     std::vector<size_t> start_dn(m, 0);
+    std::vector<float> frac_up(m, 0.0f);
+    std::vector<float> frac_dn(m, 0.0f);
     std::vector<int> offset(r);
     if (good_csi == true) {
       for (size_t i = 0; i < m; i++) {
@@ -792,10 +799,10 @@ bool RadioConfig::InitialCalib(bool sample_adjust) {
           continue;
         }
         if (i % cfg_->NumChannels() == 0) {
-          size_t peak_up =
-              CommsLib::FindPilotSeq(up.at(i), cfg_->PilotCf32(), seq_len);
-          size_t peak_dn =
-              CommsLib::FindPilotSeq(dn.at(i), cfg_->PilotCf32(), seq_len);
+          size_t peak_up = CommsLib::FindPilotSeq(up.at(i), cfg_->PilotCf32(),
+                                                  seq_len, frac_up.at(i));
+          size_t peak_dn = CommsLib::FindPilotSeq(dn.at(i), cfg_->PilotCf32(),
+                                                  seq_len, frac_dn.at(i));
           start_up[i] =
               peak_up < seq_len ? 0 : peak_up - seq_len + cfg_->CpLen();
           start_dn[i] =
@@ -829,6 +836,8 @@ bool RadioConfig::InitialCalib(bool sample_adjust) {
         } else {
           start_up.at(i) = start_up.at(i - 1);
           start_dn.at(i) = start_dn.at(i - 1);
+          frac_up.at(i) = frac_up.at(i - 1);
+          frac_dn.at(i) = frac_dn.at(i - 1);
         }
 
         float sig_up = 0;
@@ -970,6 +979,16 @@ bool RadioConfig::InitialCalib(bool sample_adjust) {
 
         auto dn_f = CommsLib::FFT(dn_ofdm, cfg_->OfdmCaNum());
         auto up_f = CommsLib::FFT(up_ofdm, cfg_->OfdmCaNum());
+        if (kFracSampleOffsetComp) {
+          // A residual delay of frac samples multiplies DFT bin j by
+          // exp(-2*pi*1j*j*frac/N); undo the ramp so it does not end up
+          // baked into the cached calibration vector
+          const float scale = 2 * M_PI / cfg_->OfdmCaNum();
+          for (size_t j = 0; j < cfg_->OfdmCaNum(); j++) {
+            dn_f[j] *= std::polar(1.0f, scale * j * frac_dn.at(i));
+            up_f[j] *= std::polar(1.0f, scale * j * frac_up.at(i));
+          }
+        }
         if (cfg_->ExternalRefNode(0) == false &&
             i / cfg_->NumChannels() == ref) {
           for (size_t j = 0; j < cfg_->OfdmCaNum(); j++) {
@@ -4,14 +4,50 @@
  */
 #include "radio_lib.h"
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <ctime>
+
 #include "comms-lib.h"
 #include "nlohmann/json.hpp"
 
 static constexpr bool kPrintCalibrationMats = false;
 static constexpr size_t kSoapyMakeMaxAttemps = 2;
 
+// Warm-restart calibration snapshot file: a fixed header identifying the
+// config shape and RF settings the measurement was taken under, followed
+// by the processed downlink then uplink calibration matrices
+static constexpr uint64_t kCalibSnapshotMagic = 0x41474F5243414C31;  // AGORCAL1
+static constexpr uint32_t kCalibSnapshotVersion = 1;
+struct CalibSnapshotHeader {
+  uint64_t magic_;
+  uint32_t version_;
+  uint32_t pad_;
+  uint64_t unix_time_sec_;  // When the snapshot was written
+  uint64_t ofdm_data_num_;
+  uint64_t bf_ant_num_;
+  double freq_;  // RF center frequency the calibration was measured at
+  double rate_;  // Sample rate the calibration was measured at
+};
+
+// Slow AGC loop parameters: adjustment cadence, minimum sample mass
+// before an RSSI estimate is trusted, the largest single gain step, and
+// the bound on the cumulative correction either side of the configured
+// gains
+static constexpr size_t kAgcIntervalMs = 1000;
+static constexpr uint64_t kAgcMinSamples = 4096;
+static constexpr double kAgcMaxStepDb = 3.0;
+static constexpr double kAgcMaxOffsetDb = 30.0;
+
 RadioConfig::RadioConfig(Config* cfg)
-    : cfg_(cfg), num_radios_initialized_(0), num_radios_configured_(0) {
+    : cfg_(cfg),
+      num_radios_initialized_(0),
+      num_radios_configured_(0),
+      num_radios_tdd_configured_(0),
+      agc_running_(false) {
   SoapySDR::Kwargs args;
   SoapySDR::Kwargs sargs;
   // load channels
@@ -53,6 +89,10 @@ RadioConfig::RadioConfig(Config* cfg)
   tx_streams_.resize(radio_num_);
   rx_streams_.resize(radio_num_);
 
+  agc_rssi_energy_ = std::make_unique<std::atomic<uint64_t>[]>(radio_num_);
+  agc_rssi_samps_ = std::make_unique<std::atomic<uint64_t>[]>(radio_num_);
+  agc_gain_offset_.resize(radio_num_, 0.0);
+
   std::vector<std::thread> init_bs_threads;
 
   for (size_t i = 0; i < this->radio_num_; i++) {
@@ -329,6 +369,194 @@ void RadioConfig::ConfigureBsRadio(size_t tid) {
   this->num_radios_configured_.fetch_add(1);
 }
 
+void RadioConfig::ConfigureTddModeBsRadio(size_t tid) {
+  size_t i = tid;
+  size_t cell_id = cfg_->CellId().at(i);
+  bool is_ref_radio = (i == cfg_->RefRadio(cell_id));
+  if (cfg_->HwFramer() == true) {
+    nlohmann::json conf;
+    conf["tdd_enabled"] = true;
+    conf["frame_mode"] = "free_running";
+    conf["max_frame"] = 0;
+    conf["symbol_size"] = cfg_->SampsPerSymbol();
+    conf["beacon_start"] = cfg_->OfdmTxZeroPrefix();
+    conf["beacon_stop"] = cfg_->OfdmTxZeroPrefix() + cfg_->BeaconLen();
+
+    ba_stn_.at(i)->writeSetting(
+        "TX_SW_DELAY",
+        "30");  // experimentally good value for dev front-end
+    ba_stn_.at(i)->writeSetting("TDD_MODE", "true");
+    std::vector<std::string> tdd_sched;
+
+    std::string sched = cfg_->Frame().FrameIdentifier();
+    size_t sched_size = sched.length();
+    for (size_t s = 0; s < sched_size; s++) {
+      char c = cfg_->Frame().FrameIdentifier().at(s);
+      if (c == 'C') {
+        sched.replace(s, 1, is_ref_radio ? "R" : "T");
+      } else if (c == 'L') {
+        sched.replace(s, 1, is_ref_radio ? "T" : "R");
+      } else if (c == 'P') {
+        sched.replace(s, 1, "R");
+      } else if (c == 'U') {
+        sched.replace(s, 1, "R");
+      } else if (c == 'D') {
+        sched.replace(s, 1, "T");
+      } else if (c != 'B') {
+        sched.replace(s, 1, "G");
+      }
+    }
+    std::cout << "Radio " << i << " Frame 1: " << sched << std::endl;
+    tdd_sched.push_back(sched);
+
+    conf["frames"] = tdd_sched;
+    std::string conf_string = conf.dump();
+    ba_stn_.at(i)->writeSetting("TDD_CONFIG", conf_string);
+
+    ba_stn_.at(i)->writeRegisters("BEACON_RAM", 0, cfg_->Beacon());
+    // First antenna index on this radio (channels are numbered
+    // radio-major, NumChannels antennas per radio)
+    size_t ndx = i * cfg_->NumChannels();
+    for (char const& c : cfg_->Channel()) {
+      bool is_beacon_antenna = !cfg_->Beamsweep() && ndx == cfg_->BeaconAnt();
+      std::vector<unsigned> beacon_weights(
+          cfg_->NumRadios() * cfg_->NumChannels(), is_beacon_antenna ? 1 : 0);
+      std::string tx_ram_wgt = "BEACON_RAM_WGT_";
+      if (cfg_->Beamsweep()) {
+        for (size_t j = 0; j < beacon_weights.size(); j++) {
+          beacon_weights.at(j) = CommsLib::Hadamard2(ndx, j);
+        }
+      }
+      ba_stn_.at(i)->writeRegisters(tx_ram_wgt + c, 0, beacon_weights);
+      ++ndx;
+    }
+    ba_stn_.at(i)->writeSetting("BEACON_START", std::to_string(radio_num_));
+  }
+
+  if (!kUseUHD) {
+    ba_stn_.at(i)->setHardwareTime(0, "TRIGGER");
+    if (cfg_->HwFramer() == true) {
+      ba_stn_.at(i)->activateStream(this->rx_streams_.at(i));
+      ba_stn_.at(i)->activateStream(this->tx_streams_.at(i));
+    }
+  } else {
+    ba_stn_.at(i)->setHardwareTime(0, "UNKNOWN_PPS");
+    ba_stn_.at(i)->activateStream(this->rx_streams_.at(i), SOAPY_SDR_HAS_TIME,
+                                  1e9, 0);
+    ba_stn_.at(i)->activateStream(this->tx_streams_.at(i), SOAPY_SDR_HAS_TIME,
+                                  1e9, 0);
+  }
+  this->num_radios_tdd_configured_.fetch_add(1);
+}
+
+bool RadioConfig::LoadCalibSnapshot() {
+  const std::string& path = cfg_->CalibSnapshotPath();
+  if (path.empty() == true) {
+    return false;
+  }
+  const size_t mat_elems = cfg_->OfdmDataNum() * cfg_->BfAntNum();
+  const size_t payload_bytes = 2 * mat_elems * sizeof(arma::cx_float);
+  const size_t file_bytes = sizeof(CalibSnapshotHeader) + payload_bytes;
+
+  const int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;  // No snapshot yet; measure as usual
+  }
+  struct stat st;
+  if ((fstat(fd, &st) != 0) || (static_cast<size_t>(st.st_size) != file_bytes)) {
+    std::printf("RadioConfig: calibration snapshot %s has the wrong size\n",
+                path.c_str());
+    close(fd);
+    return false;
+  }
+  void* mem = mmap(nullptr, file_bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (mem == MAP_FAILED) {
+    std::printf("RadioConfig: failed to map calibration snapshot %s\n",
+                path.c_str());
+    return false;
+  }
+
+  bool loaded = false;
+  const auto* header = static_cast<const CalibSnapshotHeader*>(mem);
+  const uint64_t now_sec = static_cast<uint64_t>(std::time(nullptr));
+  const uint64_t age_sec = (now_sec > header->unix_time_sec_)
+                               ? (now_sec - header->unix_time_sec_)
+                               : 0;
+  if ((header->magic_ != kCalibSnapshotMagic) ||
+      (header->version_ != kCalibSnapshotVersion) ||
+      (header->ofdm_data_num_ != cfg_->OfdmDataNum()) ||
+      (header->bf_ant_num_ != cfg_->BfAntNum()) ||
+      (header->freq_ != cfg_->Freq()) || (header->rate_ != cfg_->Rate())) {
+    std::printf(
+        "RadioConfig: calibration snapshot %s does not match this config, "
+        "re-measuring\n",
+        path.c_str());
+  } else if (age_sec > cfg_->CalibSnapshotMaxAgeSecs()) {
+    std::printf(
+        "RadioConfig: calibration snapshot %s is %zu seconds old (limit "
+        "%zu), re-measuring\n",
+        path.c_str(), age_sec, cfg_->CalibSnapshotMaxAgeSecs());
+  } else {
+    const auto* payload = reinterpret_cast<const arma::cx_float*>(header + 1);
+    std::memcpy(init_calib_dl_processed_, payload,
+                mat_elems * sizeof(arma::cx_float));
+    std::memcpy(init_calib_ul_processed_, payload + mat_elems,
+                mat_elems * sizeof(arma::cx_float));
+    std::printf(
+        "RadioConfig: restored reciprocity calibration from %s (%zu seconds "
+        "old), skipping initial calibration\n",
+        path.c_str(), age_sec);
+    loaded = true;
+  }
+  munmap(mem, file_bytes);
+  return loaded;
+}
+
+void RadioConfig::SaveCalibSnapshot() const {
+  const std::string& path = cfg_->CalibSnapshotPath();
+  if (path.empty() == true) {
+    return;
+  }
+  const size_t mat_elems = cfg_->OfdmDataNum() * cfg_->BfAntNum();
+  const std::string tmp_path = path + ".tmp";
+  const int fd = open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    std::printf("RadioConfig: failed to create calibration snapshot %s: %s\n",
+                tmp_path.c_str(), std::strerror(errno));
+    return;
+  }
+
+  CalibSnapshotHeader header;
+  std::memset(&header, 0, sizeof(header));
+  header.magic_ = kCalibSnapshotMagic;
+  header.version_ = kCalibSnapshotVersion;
+  header.unix_time_sec_ = static_cast<uint64_t>(std::time(nullptr));
+  header.ofdm_data_num_ = cfg_->OfdmDataNum();
+  header.bf_ant_num_ = cfg_->BfAntNum();
+  header.freq_ = cfg_->Freq();
+  header.rate_ = cfg_->Rate();
+
+  bool ok = (write(fd, &header, sizeof(header)) ==
+             static_cast<ssize_t>(sizeof(header)));
+  const size_t mat_bytes = mat_elems * sizeof(arma::cx_float);
+  ok = ok && (write(fd, init_calib_dl_processed_, mat_bytes) ==
+              static_cast<ssize_t>(mat_bytes));
+  ok = ok && (write(fd, init_calib_ul_processed_, mat_bytes) ==
+              static_cast<ssize_t>(mat_bytes));
+  close(fd);
+
+  // Atomic replace so readers never see a torn snapshot
+  if ((ok == false) || (rename(tmp_path.c_str(), path.c_str()) != 0)) {
+    std::printf("RadioConfig: failed to write calibration snapshot %s\n",
+                path.c_str());
+    unlink(tmp_path.c_str());
+    return;
+  }
+  std::printf("RadioConfig: saved reciprocity calibration snapshot to %s\n",
+              path.c_str());
+}
+
 bool RadioConfig::RadioStart() {
   bool good_calib = false;
   AllocBuffer1d(&init_calib_dl_processed_,
@@ -351,7 +579,13 @@ bool RadioConfig::RadioStart() {
     init_calib_dl_.Calloc(calib_meas_num_,
                           cfg_->OfdmDataNum() * cfg_->BfAntNum(),
                           Agora_memory::Alignment_t::kAlign64);
+    // Warm restart: a fresh snapshot of the processed calibration replaces
+    // the whole measurement sequence below
+    bool calib_restored = false;
     if (cfg_->Frame().NumDLSyms() > 0) {
+      calib_restored = LoadCalibSnapshot();
+    }
+    if ((cfg_->Frame().NumDLSyms() > 0) && (calib_restored == false)) {
       int iter = 0;
       int max_iter = 1;
       std::cout << "Start initial reciprocity calibration..." << std::endl;
@@ -415,6 +649,7 @@ bool RadioConfig::RadioStart() {
         Utils::SaveMat(calib_ul_mean_mat, "calib_ul_mat.m",
                        "init_calib_ul_mat_mean", true /*append*/);
       }
+      SaveCalibSnapshot();
     }
     init_calib_dl_.Free();
     init_calib_ul_.Free();
@@ -423,80 +658,39 @@ bool RadioConfig::RadioStart() {
   std::vector<unsigned> zeros(cfg_->SampsPerSymbol(), 0);
 
   DrainBuffers();
-  nlohmann::json conf;
-  conf["tdd_enabled"] = true;
-  conf["frame_mode"] = "free_running";
-  conf["max_frame"] = 0;
-  conf["symbol_size"] = cfg_->SampsPerSymbol();
-  conf["beacon_start"] = cfg_->OfdmTxZeroPrefix();
-  conf["beacon_stop"] = cfg_->OfdmTxZeroPrefix() + cfg_->BeaconLen();
-
-  size_t ndx = 0;
+
+  // The per-radio TDD/beacon configuration below only touches radio i, so
+  // it is spread across one thread per radio like InitBsRadio /
+  // ConfigureBsRadio in the constructor. The hub devices were brought up
+  // serially in the constructor, and the trigger fan-out (Go) stays after
+  // the join, so the hub/chain ordering is preserved.
+  std::vector<std::thread> start_bs_threads;
   for (size_t i = 0; i < this->radio_num_; i++) {
-    size_t cell_id = cfg_->CellId().at(i);
-    bool is_ref_radio = (i == cfg_->RefRadio(cell_id));
-    if (cfg_->HwFramer() == true) {
-      ba_stn_.at(i)->writeSetting(
-          "TX_SW_DELAY",
-          "30");  // experimentally good value for dev front-end
-      ba_stn_.at(i)->writeSetting("TDD_MODE", "true");
-      std::vector<std::string> tdd_sched;
-
-      std::string sched = cfg_->Frame().FrameIdentifier();
-      size_t sched_size = sched.length();
-      for (size_t s = 0; s < sched_size; s++) {
-        char c = cfg_->Frame().FrameIdentifier().at(s);
-        if (c == 'C') {
-          sched.replace(s, 1, is_ref_radio ? "R" : "T");
-        } else if (c == 'L') {
-          sched.replace(s, 1, is_ref_radio ? "T" : "R");
-        } else if (c == 'P') {
-          sched.replace(s, 1, "R");
-        } else if (c == 'U') {
-          sched.replace(s, 1, "R");
-        } else if (c == 'D') {
-          sched.replace(s, 1, "T");
-        } else if (c != 'B') {
-          sched.replace(s, 1, "G");
-        }
-      }
-      std::cout << "Radio " << i << " Frame 1: " << sched << std::endl;
-      tdd_sched.push_back(sched);
-
-      conf["frames"] = tdd_sched;
-      std::string conf_string = conf.dump();
-      ba_stn_.at(i)->writeSetting("TDD_CONFIG", conf_string);
-
-      ba_stn_.at(i)->writeRegisters("BEACON_RAM", 0, cfg_->Beacon());
-      for (char const& c : cfg_->Channel()) {
-        bool is_beacon_antenna = !cfg_->Beamsweep() && ndx == cfg_->BeaconAnt();
-        std::vector<unsigned> beacon_weights(
-            cfg_->NumRadios() * cfg_->NumChannels(), is_beacon_antenna ? 1 : 0);
-        std::string tx_ram_wgt = "BEACON_RAM_WGT_";
-        if (cfg_->Beamsweep()) {
-          for (size_t j = 0; j < beacon_weights.size(); j++) {
-            beacon_weights.at(j) = CommsLib::Hadamard2(ndx, j);
-          }
-        }
-        ba_stn_.at(i)->writeRegisters(tx_ram_wgt + c, 0, beacon_weights);
-        ++ndx;
-      }
-      ba_stn_.at(i)->writeSetting("BEACON_START", std::to_string(radio_num_));
-    }
+#ifdef THREADED_INIT
+    start_bs_threads.emplace_back(&RadioConfig::ConfigureTddModeBsRadio, this,
+                                  i);
+#else
+    ConfigureTddModeBsRadio(i);
+#endif
+  }
 
-    if (!kUseUHD) {
-      ba_stn_.at(i)->setHardwareTime(0, "TRIGGER");
-      if (cfg_->HwFramer() == true) {
-        ba_stn_.at(i)->activateStream(this->rx_streams_.at(i));
-        ba_stn_.at(i)->activateStream(this->tx_streams_.at(i));
-      }
-    } else {
-      ba_stn_.at(i)->setHardwareTime(0, "UNKNOWN_PPS");
-      ba_stn_.at(i)->activateStream(this->rx_streams_.at(i), SOAPY_SDR_HAS_TIME,
-                                    1e9, 0);
-      ba_stn_.at(i)->activateStream(this->tx_streams_.at(i), SOAPY_SDR_HAS_TIME,
-                                    1e9, 0);
+  // Block until all radios are configured for TDD operation
+  size_t num_checks = 0;
+  size_t num_radios_tdd = num_radios_tdd_configured_.load();
+  while (num_radios_tdd != this->radio_num_) {
+    num_checks++;
+    if (num_checks > 1e9) {
+      std::printf(
+          "RadioConfig: Waiting for radio TDD configuration, %zu of %zu "
+          "ready\n",
+          num_radios_tdd, this->radio_num_);
+      num_checks = 0;
     }
+    num_radios_tdd = num_radios_tdd_configured_.load();
+  }
+
+  for (auto& join_thread : start_bs_threads) {
+    join_thread.join();
   }
 
   if (!kUseUHD && cfg_->HwFramer() == false) {
@@ -522,6 +716,67 @@ void RadioConfig::Go() {
       }
     }
   }
+  if (cfg_->AgcEnabled() == true) {
+    StartAgc();
+  }
+}
+
+void RadioConfig::UpdateRxRssi(size_t radio_id, uint64_t energy,
+                               size_t num_samps) {
+  agc_rssi_energy_[radio_id].fetch_add(energy, std::memory_order_relaxed);
+  agc_rssi_samps_[radio_id].fetch_add(num_samps, std::memory_order_relaxed);
+}
+
+void RadioConfig::StartAgc() {
+  if (agc_running_.load() == true) {
+    return;
+  }
+  agc_running_.store(true);
+  agc_thread_ = std::thread(&RadioConfig::AgcLoop, this);
+}
+
+void RadioConfig::StopAgc() {
+  agc_running_.store(false);
+  if (agc_thread_.joinable() == true) {
+    agc_thread_.join();
+  }
+}
+
+void RadioConfig::AgcLoop() {
+  while (agc_running_.load() == true) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(kAgcIntervalMs));
+    for (size_t i = 0; i < this->radio_num_; i++) {
+      const uint64_t samps = agc_rssi_samps_[i].exchange(0);
+      const uint64_t energy = agc_rssi_energy_[i].exchange(0);
+      if (samps < kAgcMinSamples) {
+        continue;
+      }
+      const double mean_sq = static_cast<double>(energy) / samps;
+      const double rssi_db =
+          10.0 * std::log10((mean_sq / (32768.0 * 32768.0)) + 1e-12);
+      const double err = cfg_->AgcTargetRssiDb() - rssi_db;
+      // Hysteresis: leave the gains alone while the RSSI sits inside the
+      // deadband so measurement noise does not cause gain hunting
+      if (std::abs(err) <= cfg_->AgcHysteresisDb()) {
+        continue;
+      }
+      double step = std::max(-kAgcMaxStepDb, std::min(kAgcMaxStepDb, err));
+      double offset = agc_gain_offset_.at(i) + step;
+      offset = std::max(-kAgcMaxOffsetDb, std::min(kAgcMaxOffsetDb, offset));
+      if (offset == agc_gain_offset_.at(i)) {
+        continue;
+      }
+      agc_gain_offset_.at(i) = offset;
+      for (size_t ch = 0; ch < cfg_->NumChannels(); ch++) {
+        const double base = ch != 0u ? cfg_->RxGainB() : cfg_->RxGainA();
+        ba_stn_.at(i)->setGain(SOAPY_SDR_RX, ch, base + offset);
+      }
+      std::printf(
+          "AgcLoop: radio %zu RSSI %.1f dBFS (target %.1f), rx gain "
+          "offset now %+.1f dB\n",
+          i, rssi_db, cfg_->AgcTargetRssiDb(), offset);
+    }
+  }
 }
 
 void RadioConfig::RadioTx(void** buffs) {
@@ -610,6 +865,25 @@ int RadioConfig::RadioRx(size_t r /*radio id*/, void** buffs,
   return 0;
 }
 
+int RadioConfig::RadioRx(size_t r /*radio id*/, void** buffs, size_t num_samps,
+                         long long& frameTime) {
+  int flags = 0;
+  if (r < this->radio_num_) {
+    long long frame_time_ns = 0;
+    int ret = ba_stn_.at(r)->readStream(this->rx_streams_[r], buffs, num_samps,
+                                        flags, frame_time_ns, 1000000);
+
+    if (cfg_->HwFramer() == true) {
+      frameTime = frame_time_ns;
+    } else {
+      frameTime = SoapySDR::timeNsToTicks(frame_time_ns, cfg_->Rate());
+    }
+    return ret;
+  }
+  std::cout << "invalid radio id " << r << std::endl;
+  return 0;
+}
+
 void RadioConfig::DrainBuffers() {
   std::vector<std::complex<int16_t>> dummy_buff0(cfg_->SampsPerSymbol());
   std::vector<std::complex<int16_t>> dummy_buff1(cfg_->SampsPerSymbol());
@@ -666,6 +940,7 @@ void RadioConfig::ReadSensors() {
 void RadioConfig::RadioStop() {
   std::vector<uint32_t> zeros(4096, 0);
   std::string corr_conf_str = "{\"corr_enabled\":false}";
+  StopAgc();
   std::string tdd_conf_str = "{\"tdd_enabled\":false}";
   for (size_t i = 0; i < this->radio_num_; i++) {
     ba_stn_.at(i)->deactivateStream(this->rx_streams_.at(i));
@@ -676,6 +951,7 @@ void RadioConfig::RadioStop() {
 }
 
 RadioConfig::~RadioConfig() {
+  StopAgc();
   FreeBuffer1d(&init_calib_dl_processed_);
   FreeBuffer1d(&init_calib_ul_processed_);
 
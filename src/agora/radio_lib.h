@@ -16,7 +16,9 @@
 #include <cstdint>
 #include <cstdlib>
 #include <iostream>
+#include <memory>
 #include <string>
+#include <thread>
 
 #include "config.h"
 
@@ -30,8 +32,17 @@ class RadioConfig {
   void RadioRx(void** buffs);
   int RadioTx(size_t /*r*/, void** buffs, int flags, long long& frameTime);
   int RadioRx(size_t /*r*/, void** buffs, long long& frameTime);
+  // Variable-length read, used for sub-symbol realignment after
+  // timestamp drift
+  int RadioRx(size_t /*r*/, void** buffs, size_t num_samps,
+              long long& frameTime);
   bool DoCalib() const { return calib_; }
   void Go();
+  /// RSSI tap for the slow AGC loop: RX threads report the summed
+  /// |I|^2+|Q|^2 of num_samps raw int16 samples received on this radio
+  void UpdateRxRssi(size_t radio_id, uint64_t energy, size_t num_samps);
+  void StartAgc();
+  void StopAgc();
   arma::cx_float* GetCalibUl() { return init_calib_ul_processed_; }
   arma::cx_float* GetCalibDl() { return init_calib_dl_processed_; }
   ~RadioConfig();
@@ -39,9 +50,23 @@ class RadioConfig {
   // Thread functions
   void InitBsRadio(size_t tid);
   void ConfigureBsRadio(size_t tid);
+  void ConfigureTddModeBsRadio(size_t tid);
 
  private:
   bool InitialCalib(bool /*sample_adjust*/);
+
+  /// Try to restore the processed reciprocity calibration from the
+  /// snapshot file at Config::CalibSnapshotPath(). Returns true when a
+  /// snapshot existed, matched this config's dimensions and RF settings,
+  /// and was younger than Config::CalibSnapshotMaxAgeSecs(); the caller
+  /// then skips the InitialCalib() measurement entirely
+  bool LoadCalibSnapshot();
+
+  /// Write the processed reciprocity calibration to the snapshot file,
+  /// atomically (write to a temp file, then rename), so a crashed restart
+  /// can come back up without re-measuring
+  void SaveCalibSnapshot() const;
+  void AgcLoop();
   static void DrainRxBuffer(SoapySDR::Device* ibsSdrs,
                             SoapySDR::Stream* istream, std::vector<void*> buffs,
                             size_t symSamp);
@@ -77,5 +102,16 @@ class RadioConfig {
 
   std::atomic<size_t> num_radios_initialized_;
   std::atomic<size_t> num_radios_configured_;
+  std::atomic<size_t> num_radios_tdd_configured_;
+
+  // Per-radio RSSI accumulators fed by the RX threads and drained by the
+  // AGC thread (signal energy and number of complex samples summed)
+  std::unique_ptr<std::atomic<uint64_t>[]> agc_rssi_energy_;
+  std::unique_ptr<std::atomic<uint64_t>[]> agc_rssi_samps_;
+  // Cumulative per-radio gain correction in dB relative to the configured
+  // receive gains (AGC thread only)
+  std::vector<double> agc_gain_offset_;
+  std::thread agc_thread_;
+  std::atomic<bool> agc_running_;
 };
 #endif  // RADIO_LIB_H_
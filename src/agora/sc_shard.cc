@@ -0,0 +1,140 @@
+/**
+ * @file sc_shard.cc
+ * @brief Implementation of the subcarrier shard LLR merge bridge
+ * (see sc_shard.h)
+ */
+#include "sc_shard.h"
+
+#include <cstring>
+
+#include "gettime.h"
+#include "logger.h"
+#include "utils.h"
+
+// Largest UDP payload the bridge will put on the wire; one shard's per-UE
+// LLR slice must fit in a single datagram
+static constexpr size_t kMaxWireBytes = 65000;
+
+ScShardBridge::ScShardBridge(
+    Config* cfg, size_t core_offset,
+    PtrCube<kFrameWnd, kMaxSymbols, kMaxUEs, int8_t>& demod_buffers,
+    moodycamel::ConcurrentQueue<EventData>* complete_queues,
+    size_t num_complete_queues, QueueNotifier* master_notifier)
+    : cfg_(cfg),
+      core_offset_(core_offset),
+      llr_shard_bytes_((cfg->ModOrderBits() * cfg->ScShardCount()) /
+                       (cfg->Llr4Bit() ? 2 : 1)),
+      slices_per_symbol_((cfg->ScShardNum() - 1) * cfg->UeAntNum()),
+      demod_buffers_(demod_buffers),
+      complete_queues_(complete_queues),
+      num_complete_queues_(num_complete_queues),
+      master_notifier_(master_notifier) {
+  RtAssert((sizeof(ScShardHdr) + llr_shard_bytes_) <= kMaxWireBytes,
+           "ScShardBridge: LLR shard slice does not fit in one datagram");
+  if (cfg->ScShardOwner() == true) {
+    udp_server_ = std::make_unique<UDPServer>(cfg->ScShardMergePort());
+    std::printf(
+        "ScShardBridge: shard 0/%zu owns decode, merging LLRs from %zu "
+        "remote shards on port %zu\n",
+        cfg->ScShardNum(), cfg->ScShardNum() - 1, cfg->ScShardMergePort());
+  } else {
+    std::printf(
+        "ScShardBridge: shard %zu/%zu (subcarriers %zu-%zu) forwards LLRs "
+        "to %s:%zu\n",
+        cfg->ScShardIndex(), cfg->ScShardNum(), cfg->ScShardStart(),
+        cfg->ScShardStart() + cfg->ScShardCount() - 1,
+        cfg->ScShardMergeAddr().c_str(), cfg->ScShardMergePort());
+  }
+  thread_ = std::thread(&ScShardBridge::RunLoop, this);
+}
+
+ScShardBridge::~ScShardBridge() {
+  running_ = false;
+  if (thread_.joinable() == true) {
+    thread_.join();
+  }
+}
+
+void ScShardBridge::ForwardSymbol(size_t frame_id, size_t symbol_id) {
+  forward_queue_.enqueue(EventData(
+      EventType::kLlrShard, gen_tag_t::FrmSym(frame_id, symbol_id).tag_));
+}
+
+void ScShardBridge::SendSymbol(size_t frame_id, size_t symbol_id) {
+  const size_t symbol_idx_ul = cfg_->Frame().GetULSymbolIdx(symbol_id);
+  ScShardHdr hdr;
+  hdr.magic_ = ScShardHdr::kMagic;
+  hdr.frame_id_ = frame_id;
+  hdr.symbol_id_ = symbol_id;
+  hdr.shard_index_ = cfg_->ScShardIndex();
+  hdr.payload_bytes_ = llr_shard_bytes_;
+  for (size_t ue_id = 0; ue_id < cfg_->UeAntNum(); ue_id++) {
+    hdr.ue_id_ = ue_id;
+    const int8_t* slice =
+        demod_buffers_[frame_id % cfg_->FrameWnd()][symbol_idx_ul][ue_id] +
+        (cfg_->ScShardIndex() * llr_shard_bytes_);
+    udp_client_.Send(cfg_->ScShardMergeAddr(), cfg_->ScShardMergePort(),
+                     reinterpret_cast<const uint8_t*>(&hdr), sizeof(hdr),
+                     reinterpret_cast<const uint8_t*>(slice),
+                     llr_shard_bytes_);
+  }
+}
+
+void ScShardBridge::ReceiveSlice(const uint8_t* buf, size_t bytes) {
+  if (bytes != (sizeof(ScShardHdr) + llr_shard_bytes_)) {
+    MLPD_WARN("ScShardBridge: runt slice (%zu bytes)\n", bytes);
+    return;
+  }
+  const auto* hdr = reinterpret_cast<const ScShardHdr*>(buf);
+  if ((hdr->magic_ != ScShardHdr::kMagic) ||
+      (hdr->payload_bytes_ != llr_shard_bytes_) ||
+      (hdr->shard_index_ == 0) ||
+      (hdr->shard_index_ >= cfg_->ScShardNum()) ||
+      (hdr->ue_id_ >= cfg_->UeAntNum())) {
+    MLPD_WARN("ScShardBridge: malformed slice dropped\n");
+    return;
+  }
+  const size_t frame_slot = hdr->frame_id_ % cfg_->FrameWnd();
+  const size_t symbol_idx_ul = cfg_->Frame().GetULSymbolIdx(hdr->symbol_id_);
+  int8_t* dst = demod_buffers_[frame_slot][symbol_idx_ul][hdr->ue_id_] +
+                (hdr->shard_index_ * llr_shard_bytes_);
+  std::memcpy(dst, buf + sizeof(ScShardHdr), llr_shard_bytes_);
+
+  arrived_.at(frame_slot).at(symbol_idx_ul)++;
+  if (arrived_.at(frame_slot).at(symbol_idx_ul) == slices_per_symbol_) {
+    arrived_.at(frame_slot).at(symbol_idx_ul) = 0;
+    TryEnqueueFallback(
+        &complete_queues_[hdr->frame_id_ % num_complete_queues_],
+        EventData(EventType::kLlrShard,
+                  gen_tag_t::FrmSym(hdr->frame_id_, hdr->symbol_id_).tag_));
+    master_notifier_->Notify();
+  }
+}
+
+void ScShardBridge::RunLoop() {
+  PinToCoreWithOffset(ThreadType::kWorkerTXRX, core_offset_, 0);
+  std::vector<uint8_t> rx_buf(kMaxWireBytes);
+
+  while (running_.load(std::memory_order_relaxed) == true) {
+    bool did_work = false;
+
+    if (cfg_->ScShardOwner() == true) {
+      const ssize_t ret = udp_server_->Recv(rx_buf.data(), rx_buf.size());
+      if (ret > 0) {
+        did_work = true;
+        ReceiveSlice(rx_buf.data(), static_cast<size_t>(ret));
+      }
+    } else {
+      EventData fwd_event;
+      if (forward_queue_.try_dequeue(fwd_event) == true) {
+        did_work = true;
+        const gen_tag_t tag(fwd_event.tags_[0]);
+        SendSymbol(tag.frame_id_, tag.symbol_id_);
+      }
+    }
+
+    if (did_work == false) {
+      GetTime::SpinPause();
+    }
+  }
+}
@@ -0,0 +1,98 @@
+/**
+ * @file sc_shard.h
+ * @brief Declarations for subcarrier sharding: the bridge thread that moves
+ * per-UE LLR slices between cooperating Agora instances when the OFDM band
+ * is split across several nodes
+ */
+#ifndef SC_SHARD_H_
+#define SC_SHARD_H_
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <thread>
+
+#include "buffer.h"
+#include "concurrent_queue_wrapper.h"
+#include "concurrentqueue.h"
+#include "config.h"
+#include "memory_manage.h"
+#include "udp_client.h"
+#include "udp_server.h"
+
+/// Wire header in front of one UE's LLR slice for one uplink symbol. The
+/// receiving side places the payload by (frame, symbol, ue, shard), so
+/// packets may arrive in any order and from any shard.
+struct ScShardHdr {
+  static constexpr uint32_t kMagic = 0x44485343u;  // "CSHD"
+  uint32_t magic_;
+  uint32_t frame_id_;
+  uint32_t symbol_id_;
+  uint32_t ue_id_;
+  uint32_t shard_index_;
+  uint32_t payload_bytes_;
+} __attribute__((packed));
+
+/**
+ * @brief Merges per-shard LLR streams when the band is subcarrier-sharded.
+ *
+ * With sc_shard_num > 1 every instance runs FFT, ZF and demodulation for
+ * its own contiguous range of data subcarriers (the schedule already keys
+ * work by absolute subcarrier id, so shards simply start their tags at
+ * sc_shard_start). Decode needs a UE's full-band LLR row, so shard 0 owns
+ * it: the non-owner bridges forward each finished symbol's per-UE LLR
+ * slices to the owner over UDP, and the owner's bridge copies them into
+ * the matching demod_buffers_ region and posts a kLlrShard event to the
+ * master once every remote slice for a symbol has landed. The master then
+ * schedules kDecode when its own shard's demodulation for that symbol is
+ * also complete.
+ */
+class ScShardBridge {
+ public:
+  ScShardBridge(Config* cfg, size_t core_offset,
+                PtrCube<kFrameWnd, kMaxSymbols, kMaxUEs, int8_t>& demod_buffers,
+                moodycamel::ConcurrentQueue<EventData>* complete_queues,
+                size_t num_complete_queues, QueueNotifier* master_notifier);
+  ~ScShardBridge();
+
+  /// Non-owner only: queue one finished uplink symbol's LLR slices for
+  /// forwarding to the shard owner. Called only from the master thread.
+  void ForwardSymbol(size_t frame_id, size_t symbol_id);
+
+ private:
+  void RunLoop();
+  /// Serialize and send this shard's per-UE LLR slices for one symbol
+  void SendSymbol(size_t frame_id, size_t symbol_id);
+  /// Place one received slice and post kLlrShard when a symbol completes
+  void ReceiveSlice(const uint8_t* buf, size_t bytes);
+
+  Config* const cfg_;
+  const size_t core_offset_;
+  // Bytes of one UE's LLR slice for one shard's subcarrier range (halved
+  // in the 4-bit packed LLR mode); slices of shard i start at byte
+  // i * llr_shard_bytes_ of the full-band demod row
+  const size_t llr_shard_bytes_;
+  // Remote slices per symbol the owner waits for before posting kLlrShard
+  const size_t slices_per_symbol_;
+
+  PtrCube<kFrameWnd, kMaxSymbols, kMaxUEs, int8_t>& demod_buffers_;
+  moodycamel::ConcurrentQueue<EventData>* const complete_queues_;
+  // Completion queue count (Agora::kScheduleQueues); kLlrShard events go
+  // to queue frame_id % num_complete_queues_ like any worker completion
+  const size_t num_complete_queues_;
+  QueueNotifier* const master_notifier_;
+
+  // Non-owner: symbols waiting to be forwarded (kLlrShard FrmSym tags)
+  moodycamel::ConcurrentQueue<EventData> forward_queue_;
+  // Owner: remote slices received so far per (frame slot, uplink symbol)
+  std::array<std::array<size_t, kMaxSymbols>, kFrameWnd> arrived_ = {};
+
+  UDPClient udp_client_;
+  // Owner only: listens on sc_shard_merge_port for the other shards
+  std::unique_ptr<UDPServer> udp_server_;
+
+  std::atomic<bool> running_ = true;
+  std::thread thread_;
+};
+
+#endif  // SC_SHARD_H_
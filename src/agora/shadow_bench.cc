@@ -0,0 +1,205 @@
+/**
+ * @file shadow_bench.cc
+ * @brief Implementation of the shadow-execution A/B demodulation harness
+ */
+
+#include "shadow_bench.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+
+#include "gettime.h"
+#include "logger.h"
+#include "utils.h"
+
+ShadowBench::ShadowBench(
+    Config* cfg, size_t core_offset, size_t core_id,
+    Table<complex_float>& data_buffer,
+    PtrGrid<kFrameWnd, kMaxDataSCs, complex_float>& ul_zf_matrices,
+    Table<complex_float>& ue_spec_pilot_buffer, Stats* stats)
+    : cfg_(cfg),
+      core_offset_(core_offset),
+      core_id_(core_id),
+      sample_interval_(cfg->ShadowBenchInterval()),
+      prod_ue_spec_pilot_buffer_(ue_spec_pilot_buffer),
+      shadow_queue_(kShadowQueueSize) {
+  RtAssert(cfg->Frame().NumULSyms() > 0,
+           "shadow_bench requires uplink symbols");
+  RtAssert(cfg->HardDemod() == false,
+           "shadow_bench compares the soft demodulators; hard_demod has no "
+           "alternate kernel");
+  // The shadow instances log timing through DurationStat slots past the
+  // production workers, keeping the A/B numbers out of the per-frame
+  // aggregates while reusing the normal Stats machinery
+  RtAssert((cfg->WorkerThreadNum() + 2) <= kMaxThreads,
+           "shadow_bench needs two spare DurationStat slots");
+
+  // Private output buffers, sized exactly like the production set
+  shadow_ue_spec_pilot_buffer_.Calloc(
+      cfg_->FrameWnd(), cfg->Frame().ClientUlPilotSymbols() * cfg->UeAntNum(),
+      Agora_memory::Alignment_t::kAlign64);
+  if (kExportConstellation) {
+    shadow_equal_buffer_.Malloc(cfg->Frame().NumULSyms() * cfg_->FrameWnd(),
+                                cfg->OfdmDataNum() * cfg->UeAntNum(),
+                                Agora_memory::Alignment_t::kAlign64);
+  }
+  const size_t demod_cell_bytes =
+      ((kMaxModType * cfg->OfdmDataNum()) / (cfg->Llr4Bit() ? 2 : 1)) +
+      kLdpcHelperFunctionInputBufferSizePaddingBytes;
+  const size_t decoded_cell_bytes =
+      ((cfg->OfdmDataNum() * kMaxModType) /
+       cfg->LdpcConfig().NumCbCodewLen()) *
+      Roundup<64>(cfg->NumBytesPerCb());
+  demod_buffers_base_.Alloc(cfg_->FrameWnd(), cfg->Frame().NumULSyms(),
+                            cfg->UeAntNum(), demod_cell_bytes);
+  demod_buffers_alt_.Alloc(cfg_->FrameWnd(), cfg->Frame().NumULSyms(),
+                           cfg->UeAntNum(), demod_cell_bytes);
+  decoded_buffers_base_.Alloc(cfg_->FrameWnd(), cfg->Frame().NumULSyms(),
+                              cfg->UeAntNum(), decoded_cell_bytes);
+  decoded_buffers_alt_.Alloc(cfg_->FrameWnd(), cfg->Frame().NumULSyms(),
+                             cfg->UeAntNum(), decoded_cell_bytes);
+  shadow_phy_stats_ = std::make_unique<PhyStats>(cfg, Direction::kUplink);
+
+  demul_base_ = std::make_unique<DoDemul>(
+      cfg, cfg->WorkerThreadNum(), data_buffer, ul_zf_matrices,
+      shadow_ue_spec_pilot_buffer_, shadow_equal_buffer_, demod_buffers_base_,
+      decoded_buffers_base_, shadow_phy_stats_.get(), stats,
+      false /* production kernels */);
+  demul_alt_ = std::make_unique<DoDemul>(
+      cfg, cfg->WorkerThreadNum() + 1, data_buffer, ul_zf_matrices,
+      shadow_ue_spec_pilot_buffer_, shadow_equal_buffer_, demod_buffers_alt_,
+      decoded_buffers_alt_, shadow_phy_stats_.get(), stats,
+      true /* alternate kernels */);
+
+  MLPD_INFO(
+      "ShadowBench: shadowing every %zuth demul launch, baseline planar=%d\n",
+      sample_interval_, static_cast<int>(cfg->DemulPlanar()));
+  running_.store(true);
+  shadow_thread_ = std::thread(&ShadowBench::ShadowLoop, this);
+}
+
+ShadowBench::~ShadowBench() {
+  running_.store(false);
+  if (shadow_thread_.joinable() == true) {
+    shadow_thread_.join();
+  }
+
+  std::printf(
+      "ShadowBench: shadowed %zu of %zu submitted demul launches "
+      "(%zu queue drops, %zu stale skips)\n",
+      num_shadowed_, num_submitted_, num_queue_drops_, num_stale_skips_);
+  if (num_shadowed_ > 0) {
+    const double base_us = GetTime::CyclesToUs(
+        cycles_base_ / num_shadowed_, cfg_->FreqGhz());
+    const double alt_us =
+        GetTime::CyclesToUs(cycles_alt_ / num_shadowed_, cfg_->FreqGhz());
+    std::printf(
+        "ShadowBench: baseline (planar=%d) %.2f us/launch, alternate "
+        "(planar=%d) %.2f us/launch\n",
+        static_cast<int>(cfg_->DemulPlanar()), base_us,
+        static_cast<int>(!cfg_->DemulPlanar()), alt_us);
+    std::printf(
+        "ShadowBench: outputs: %zu of %zu LLR bytes differ, max delta %d\n",
+        bytes_mismatched_, bytes_compared_, max_llr_delta_);
+  }
+
+  shadow_ue_spec_pilot_buffer_.Free();
+  if (kExportConstellation) {
+    shadow_equal_buffer_.Free();
+  }
+}
+
+void ShadowBench::MaybeSubmit(size_t tag) {
+  const gen_tag_t tag_parsed(tag);
+  // Data symbols only: shadowing a pilot symbol would re-run the phase
+  // accumulation the production launch already performed
+  const size_t symbol_idx_ul =
+      cfg_->Frame().GetULSymbolIdx(tag_parsed.symbol_id_);
+  if (symbol_idx_ul < cfg_->Frame().ClientUlPilotSymbols()) {
+    return;
+  }
+  if ((sample_counter_++ % sample_interval_) != 0) {
+    return;
+  }
+  latest_frame_.store(tag_parsed.frame_id_, std::memory_order_relaxed);
+  num_submitted_++;
+  if (shadow_queue_.try_enqueue(EventData(EventType::kDemul, tag)) == false) {
+    num_queue_drops_++;
+  }
+}
+
+void ShadowBench::ShadowLoop() {
+  PinToCoreWithOffset(ThreadType::kWorker, core_offset_, core_id_);
+
+  const size_t pilot_row_bytes = cfg_->Frame().ClientUlPilotSymbols() *
+                                 cfg_->UeAntNum() * sizeof(complex_float);
+  while (running_.load() == true) {
+    EventData event;
+    if (shadow_queue_.try_dequeue(event) == false) {
+      std::this_thread::sleep_for(std::chrono::microseconds(100));
+      continue;
+    }
+    const size_t tag = event.tags_[0];
+    const size_t frame_id = gen_tag_t(tag).frame_id_;
+
+    // The shared inputs are only valid while the frame holds its window
+    // slot; drop anything the shadow worker fell behind on
+    if ((frame_id + 2) <= latest_frame_.load(std::memory_order_relaxed)) {
+      num_stale_skips_++;
+      continue;
+    }
+
+    // Clone the production phase-tracking row so the phase-correction
+    // path sees what the production launch saw
+    if (pilot_row_bytes > 0) {
+      const size_t frame_slot = frame_id % cfg_->FrameWnd();
+      std::memcpy(shadow_ue_spec_pilot_buffer_[frame_slot],
+                  prod_ue_spec_pilot_buffer_[frame_slot], pilot_row_bytes);
+    }
+
+    const size_t start_tsc = GetTime::WorkerRdtsc();
+    demul_base_->Launch(tag);
+    const size_t mid_tsc = GetTime::WorkerRdtsc();
+    demul_alt_->Launch(tag);
+    cycles_alt_ += GetTime::WorkerRdtsc() - mid_tsc;
+    cycles_base_ += mid_tsc - start_tsc;
+    num_shadowed_++;
+
+    CompareOutputs(tag);
+  }
+}
+
+void ShadowBench::CompareOutputs(size_t tag) {
+  const size_t frame_slot = gen_tag_t(tag).frame_id_ % cfg_->FrameWnd();
+  const size_t symbol_idx_ul =
+      cfg_->Frame().GetULSymbolIdx(gen_tag_t(tag).symbol_id_);
+  const size_t base_sc_id = gen_tag_t(tag).sc_id_;
+  const size_t sc_count =
+      std::min(cfg_->DemulBlockSize(), cfg_->OfdmDataNum() - base_sc_id);
+
+  // Nibble-packed offsets stay byte aligned for the same reason the
+  // production demul path's do: even mod bits, cacheline-aligned blocks
+  const size_t divisor = cfg_->Llr4Bit() ? 2 : 1;
+  const size_t byte_offset = (cfg_->ModOrderBits() * base_sc_id) / divisor;
+  const size_t byte_count = (cfg_->ModOrderBits() * sc_count) / divisor;
+
+  for (size_t ue = 0; ue < cfg_->UeAntNum(); ue++) {
+    const int8_t* base_ptr =
+        demod_buffers_base_[frame_slot][symbol_idx_ul][ue] + byte_offset;
+    const int8_t* alt_ptr =
+        demod_buffers_alt_[frame_slot][symbol_idx_ul][ue] + byte_offset;
+    for (size_t i = 0; i < byte_count; i++) {
+      const int delta = std::abs(static_cast<int>(base_ptr[i]) -
+                                 static_cast<int>(alt_ptr[i]));
+      if (delta != 0) {
+        bytes_mismatched_++;
+        if (delta > max_llr_delta_) {
+          max_llr_delta_ = delta;
+        }
+      }
+    }
+    bytes_compared_ += byte_count;
+  }
+}
@@ -0,0 +1,109 @@
+/**
+ * @file shadow_bench.h
+ * @brief Shadow-execution A/B harness for demodulation kernels.
+ *
+ * A designated spare worker re-runs a sampled fraction of completed
+ * demul launches against live buffers, once with the production kernel
+ * configuration and once with the alternate one (planar vs interleaved
+ * soft demodulators), comparing outputs and timing. This validates
+ * kernel changes under real cache pressure instead of microbenchmarks.
+ * The shadow instances write into private output buffers, so production
+ * results are never touched; inputs (data_buffer_, ul_zf_matrices_) are
+ * shared read-only.
+ */
+
+#ifndef SHADOW_BENCH_H_
+#define SHADOW_BENCH_H_
+
+#include <atomic>
+#include <memory>
+#include <thread>
+
+#include "buffer.h"
+#include "concurrentqueue.h"
+#include "config.h"
+#include "dodemul.h"
+#include "memory_manage.h"
+#include "phy_stats.h"
+#include "stats.h"
+#include "symbols.h"
+
+class ShadowBench {
+ public:
+  /// The shadow worker is pinned to core (core_offset + core_id), which
+  /// the caller picks outside the production worker range
+  ShadowBench(Config* cfg, size_t core_offset, size_t core_id,
+              Table<complex_float>& data_buffer,
+              PtrGrid<kFrameWnd, kMaxDataSCs, complex_float>& ul_zf_matrices,
+              Table<complex_float>& ue_spec_pilot_buffer, Stats* stats);
+
+  /// Stops the shadow worker and prints the A/B report
+  ~ShadowBench();
+
+  ShadowBench(const ShadowBench&) = delete;
+  ShadowBench& operator=(const ShadowBench&) = delete;
+
+  /// Offer one completed demul task tag for shadowing. Called by the
+  /// master; every shadow_bench_interval-th data-symbol launch is
+  /// enqueued, the rest return immediately
+  void MaybeSubmit(size_t tag);
+
+ private:
+  /// Pending shadow tasks; submissions are dropped (counted) when full
+  static constexpr size_t kShadowQueueSize = 512;
+
+  void ShadowLoop();
+  void CompareOutputs(size_t tag);
+
+  Config* const cfg_;
+  const size_t core_offset_;
+  const size_t core_id_;
+  const size_t sample_interval_;
+
+  // Production phase-tracking state, cloned per shadow task so the
+  // phase-correction path sees what the production launch saw
+  Table<complex_float>& prod_ue_spec_pilot_buffer_;
+
+  // Private buffer set for the shadow instances. Both instances share
+  // the pilot clone and the constellation-export scratch (only the
+  // demod outputs are compared); each has its own demod output cube
+  Table<complex_float> shadow_ue_spec_pilot_buffer_;
+  Table<complex_float> shadow_equal_buffer_;
+  PtrCube<kFrameWnd, kMaxSymbols, kMaxUEs, int8_t> demod_buffers_base_;
+  PtrCube<kFrameWnd, kMaxSymbols, kMaxUEs, int8_t> demod_buffers_alt_;
+  PtrCube<kFrameWnd, kMaxSymbols, kMaxUEs, int8_t> decoded_buffers_base_;
+  PtrCube<kFrameWnd, kMaxSymbols, kMaxUEs, int8_t> decoded_buffers_alt_;
+
+  // Private PhyStats sink so shadow re-runs never double-count EVM into
+  // the production statistics
+  std::unique_ptr<PhyStats> shadow_phy_stats_;
+
+  std::unique_ptr<DoDemul> demul_base_;
+  std::unique_ptr<DoDemul> demul_alt_;
+
+  moodycamel::ConcurrentQueue<EventData> shadow_queue_;
+
+  // Newest frame offered for shadowing; the shadow worker drops tasks
+  // that have fallen behind it, since their shared inputs may have been
+  // recycled by the frame window
+  std::atomic<size_t> latest_frame_ = {0};
+
+  // Master-side counters
+  size_t sample_counter_ = 0;
+  size_t num_submitted_ = 0;
+  size_t num_queue_drops_ = 0;
+
+  // Shadow-worker-side counters
+  size_t num_shadowed_ = 0;
+  size_t num_stale_skips_ = 0;
+  size_t cycles_base_ = 0;
+  size_t cycles_alt_ = 0;
+  size_t bytes_compared_ = 0;
+  size_t bytes_mismatched_ = 0;
+  int max_llr_delta_ = 0;
+
+  std::atomic<bool> running_ = {false};
+  std::thread shadow_thread_;
+};
+
+#endif  // SHADOW_BENCH_H_
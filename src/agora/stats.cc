@@ -4,8 +4,36 @@
  */
 #include "stats.h"
 
+#include <algorithm>
+#include <cmath>
 #include <typeinfo>
 
+#include "concurrent_queue_wrapper.h"
+#include "pmu_sampler.h"
+
+/// Frames between periodic histogram percentile printouts
+static constexpr size_t kHistSummaryFrameInterval = 1000;
+
+/// Pipeline stages tracked by the deadline-miss detector, each bounded by
+/// two master timestamps. Stages whose end timestamp was not set for a
+/// frame (e.g. the downlink chain in an uplink-only config) are skipped.
+struct DeadlineStage {
+  const char* name_;
+  TsType start_;
+  TsType end_;
+};
+static constexpr std::array<DeadlineStage, 8> kDeadlineStages = {{
+    {"RX", TsType::kFirstSymbolRX, TsType::kRXDone},
+    {"PilotFFT", TsType::kPilotAllRX, TsType::kFFTPilotsDone},
+    {"ZF", TsType::kFFTPilotsDone, TsType::kZFDone},
+    {"Demul", TsType::kZFDone, TsType::kDemulDone},
+    {"Decode", TsType::kDemulDone, TsType::kDecodeDone},
+    {"Precode", TsType::kZFDone, TsType::kPrecodeDone},
+    {"IFFT", TsType::kPrecodeDone, TsType::kIFFTDone},
+    {"TX", TsType::kIFFTDone, TsType::kTXDone},
+}};
+static_assert(kDeadlineStages.size() == Stats::kNumDeadlineStages);
+
 Stats::Stats(const Config* const cfg)
     : config_(cfg),
       task_thread_num_(cfg->WorkerThreadNum()),
@@ -14,7 +42,9 @@ Stats::Stats(const Config* const cfg)
       demul_thread_num_(cfg->DemulThreadNum()),
       decode_thread_num_(cfg->DecodeThreadNum()),
       freq_ghz_(cfg->FreqGhz()),
-      creation_tsc_(GetTime::Rdtsc()) {
+      creation_tsc_(GetTime::Rdtsc()),
+      last_frame_id_(0),
+      deadline_us_(cfg->GetFrameDurationSec() * 1e6) {
   frame_start_.Calloc(config_->SocketThreadNum(), kNumStatsFrames,
                       Agora_memory::Alignment_t::kAlign64);
 }
@@ -84,6 +114,18 @@ void Stats::UpdateStats(size_t frame_id) {
   this->last_frame_id_ = frame_id;
   size_t frame_slot = (frame_id % kNumStatsFrames);
 
+  // UpdateStats() runs at frame completion, so the gap since the frame's
+  // first received packet is its end-to-end processing latency
+  const size_t latency_cycles =
+      GetTime::Rdtsc() - MasterGetTsc(TsType::kFirstSymbolRX, frame_id);
+  this->frame_latency_hist_.Record(latency_cycles);
+  UpdateDeadlineStats(frame_id,
+                      GetTime::CyclesToUs(latency_cycles, freq_ghz_));
+  if ((frame_id % kHistSummaryFrameInterval) ==
+      (kHistSummaryFrameInterval - 1)) {
+    PrintHistogramSummary();
+  }
+
   if (kIsWorkerTimingEnabled == true) {
     std::vector<FrameSummary> work_summary(kAllDoerTypes.size());
     for (size_t i = 0u; i < task_thread_num_; i++) {
@@ -252,6 +294,11 @@ void Stats::SaveToFile() {
 
   std::fclose(fp_debug);
 
+  // Per-doer hardware counter totals, when PMU sampling is on
+  PmuSampler::PrintReport();
+  // Queue depth watermarks and fallback enqueue counts, when enabled
+  QueueMonitor::PrintReport();
+
   if (kIsWorkerTimingEnabled == true) {
     std::string filename_detailed =
         cur_directory + "/data/timeresult_detail.txt";
@@ -330,8 +377,120 @@ size_t Stats::GetTotalTaskCount(DoerType doer_type, size_t thread_num) {
   return total_count;
 }
 
+void Stats::UpdateDeadlineStats(size_t frame_id, double latency_us) {
+  const size_t hist_slot = this->deadline_frames_seen_ % kDeadlineHistoryFrames;
+  const size_t first_rx_tsc = MasterGetTsc(TsType::kFirstSymbolRX, frame_id);
+  for (size_t s = 0; s < kNumDeadlineStages; s++) {
+    const DeadlineStage& stage = kDeadlineStages.at(s);
+    const size_t start_tsc = MasterGetTsc(stage.start_, frame_id);
+    const size_t end_tsc = MasterGetTsc(stage.end_, frame_id);
+    // A boundary timestamp older than this frame's first RX is left over
+    // from an earlier frame in the stats window: the stage did not run
+    if ((start_tsc >= first_rx_tsc) && (end_tsc >= start_tsc)) {
+      this->stage_history_us_.at(s).at(hist_slot) =
+          GetTime::CyclesToUs(end_tsc - start_tsc, freq_ghz_);
+    } else {
+      this->stage_history_us_.at(s).at(hist_slot) = std::nan("");
+    }
+  }
+  this->deadline_frames_seen_++;
+
+  if (latency_us <= this->deadline_us_) {
+    return;
+  }
+  this->deadline_miss_count_++;
+
+  // Attribute the miss to the stage that slipped most against its median
+  // over the history window. Misses are rare, so sorting a 128-entry
+  // scratch copy per stage here is fine
+  const char* worst_name = nullptr;
+  double worst_us = 0.0;
+  double worst_median_us = 0.0;
+  std::array<double, kDeadlineHistoryFrames> scratch;
+  for (size_t s = 0; s < kNumDeadlineStages; s++) {
+    const double stage_us = this->stage_history_us_.at(s).at(hist_slot);
+    if (std::isnan(stage_us)) {
+      continue;
+    }
+    size_t num_valid = 0;
+    const size_t filled =
+        std::min(this->deadline_frames_seen_, kDeadlineHistoryFrames);
+    for (size_t i = 0; i < filled; i++) {
+      const double sample = this->stage_history_us_.at(s).at(i);
+      if (std::isnan(sample) == false) {
+        scratch.at(num_valid++) = sample;
+      }
+    }
+    if (num_valid == 0) {
+      continue;
+    }
+    std::nth_element(scratch.begin(), scratch.begin() + (num_valid / 2),
+                     scratch.begin() + num_valid);
+    const double median_us = scratch.at(num_valid / 2);
+    if ((worst_name == nullptr) ||
+        ((stage_us - median_us) > (worst_us - worst_median_us))) {
+      worst_name = kDeadlineStages.at(s).name_;
+      worst_us = stage_us;
+      worst_median_us = median_us;
+    }
+  }
+
+  std::printf(
+      "Stats: frame %zu missed deadline: %.1f us processing vs %.1f us "
+      "budget (miss %zu)",
+      frame_id, latency_us, this->deadline_us_, this->deadline_miss_count_);
+  if (worst_name != nullptr) {
+    std::printf(": largest slip %s, %.1f us vs %.1f us median (+%.1f us)\n",
+                worst_name, worst_us, worst_median_us,
+                worst_us - worst_median_us);
+  } else {
+    std::printf(": no stage history to attribute it to\n");
+  }
+}
+
+void Stats::PrintHistogramSummary() {
+  if (this->frame_latency_hist_.TotalCount() > 0) {
+    std::printf(
+        "Stats: frame latency over %zu frames: p50 %.1f us, p99 %.1f us, "
+        "p99.9 %.1f us\n",
+        this->frame_latency_hist_.TotalCount(),
+        this->frame_latency_hist_.PercentileUs(0.50, freq_ghz_),
+        this->frame_latency_hist_.PercentileUs(0.99, freq_ghz_),
+        this->frame_latency_hist_.PercentileUs(0.999, freq_ghz_));
+  }
+  if (kIsWorkerTimingEnabled == false) {
+    return;
+  }
+  for (auto doer_type : kAllDoerTypes) {
+    LatencyHistogram merged;
+    for (size_t tid = 0; tid < task_thread_num_; tid++) {
+      merged.Merge(*GetDurationHist(doer_type, tid));
+    }
+    if (merged.TotalCount() > 0) {
+      std::printf(
+          "Stats: %s task duration (%zu tasks): p50 %.1f us, p99 %.1f us, "
+          "p99.9 %.1f us\n",
+          kDoerNames.at(doer_type).c_str(), merged.TotalCount(),
+          merged.PercentileUs(0.50, freq_ghz_),
+          merged.PercentileUs(0.99, freq_ghz_),
+          merged.PercentileUs(0.999, freq_ghz_));
+    }
+  }
+}
+
 void Stats::PrintSummary() {
   std::printf("Stats: total processed frames %zu\n", this->last_frame_id_ + 1);
+  PrintHistogramSummary();
+  std::printf("Stats: hugepage-backed buffer bytes %zu, base-page fallback %zu\n",
+              Agora_memory::HugePageAllocBytes(),
+              Agora_memory::HugePageFallbackBytes());
+  if (FrameSlotMonitor::OverrunCount() > 0) {
+    std::printf(
+        "Stats: WARNING %zu frame-window overruns -- frames recycled the "
+        "buffers of unfinished frames, decode output of those frames is "
+        "unreliable\n",
+        FrameSlotMonitor::OverrunCount());
+  }
   if (kIsWorkerTimingEnabled == false) {
     std::printf("Stats: Worker timing is disabled. Not printing summary\n");
   } else {
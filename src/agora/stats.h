@@ -10,6 +10,7 @@
 
 #include "config.h"
 #include "gettime.h"
+#include "latency_histogram.h"
 #include "memory_manage.h"
 #include "symbols.h"
 
@@ -59,6 +60,11 @@ static constexpr size_t kNumTimestampTypes =
 
 class Stats {
  public:
+  /// Number of pipeline stages tracked by the deadline-miss detector
+  static constexpr size_t kNumDeadlineStages = 8;
+  /// Frames of per-stage duration history behind the detector's medians
+  static constexpr size_t kDeadlineHistoryFrames = 128;
+
   explicit Stats(const Config* const cfg);
   ~Stats();
 
@@ -163,6 +169,31 @@ class Stats {
                 .duration_stat_[static_cast<size_t>(doer_type)];
   }
 
+  /// Get the per-task latency histogram written by thread thread_id for
+  /// DoerType doer_type. Kept outside DurationStat so the per-frame
+  /// stale-copy bookkeeping in PopulateSummary() does not copy histograms
+  LatencyHistogram* GetDurationHist(DoerType doer_type, size_t thread_id) {
+    return &this->worker_hists_[thread_id][static_cast<size_t>(doer_type)];
+  }
+
+  /// Print p50/p99/p99.9 of frame processing latency and of per-doer task
+  /// durations, merged across worker threads. Called at exit and
+  /// periodically from UpdateStats()
+  void PrintHistogramSummary();
+
+  /// Get the master-thread frame latency histogram. Readers on other
+  /// threads should copy it before walking the buckets
+  const LatencyHistogram& FrameLatencyHist() const {
+    return this->frame_latency_hist_;
+  }
+
+  /// From the master, get the total worker microseconds spent in doer_type
+  /// for frame_id, as computed by the last UpdateStats() call
+  double DoerUs(DoerType doer_type, size_t frame_id) const {
+    return this->doer_us_.at(static_cast<size_t>(doer_type))
+        .at(frame_id % kNumStatsFrames);
+  }
+
   inline size_t LastFrameId() const { return this->last_frame_id_; }
   /// Dimensions = number of packet RX threads x kNumStatsFrames.
   /// frame_start[i][j] is the RDTSC timestamp taken by thread i when it
@@ -175,6 +206,12 @@ class Stats {
   void PopulateSummary(FrameSummary* frame_summary, size_t thread_id,
                        DoerType doer_type);
 
+  /// At frame completion, record each pipeline stage's duration from the
+  /// master timestamps and, if the frame's processing latency blew the
+  /// one-frame-duration budget, report the stage with the largest slip
+  /// against its historical median
+  void UpdateDeadlineStats(size_t frame_id, double latency_us);
+
   static void ComputeAvgOverThreads(FrameSummary* frame_summary,
                                     size_t thread_num, size_t break_down_num);
   static void PrintPerThreadPerTask(std::string const& doer_string,
@@ -218,6 +255,25 @@ class Stats {
 
   size_t last_frame_id_;
 
+  /// Per-task duration histograms, one per (worker thread, Doer type).
+  /// Single writer each (the owning worker); merged at report time
+  std::array<std::array<LatencyHistogram, kNumDoerTypes>, kMaxThreads>
+      worker_hists_;
+
+  /// End-to-end frame processing latency (first packet RX to frame
+  /// completion). Master thread only
+  LatencyHistogram frame_latency_hist_;
+
+  /// Per-stage duration rings for the deadline-miss detector, in
+  /// microseconds; NaN marks a stage that did not run that frame
+  std::array<std::array<double, kDeadlineHistoryFrames>, kNumDeadlineStages>
+      stage_history_us_;
+  /// Frames recorded into stage_history_us_ so far
+  size_t deadline_frames_seen_ = 0;
+  /// Frame processing budget: one frame duration, in microseconds
+  double deadline_us_;
+  size_t deadline_miss_count_ = 0;
+
   /// Dimensions = number of packet RX threads x kNumStatsFrames.
   /// frame_start[i][j] is the RDTSC timestamp taken by thread i when it
   /// starts receiving frame j.
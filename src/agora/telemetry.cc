@@ -0,0 +1,144 @@
+/**
+ * @file telemetry.cc
+ * @brief Implementation file for the TelemetryReporter class.
+ */
+#include "telemetry.h"
+
+#include <chrono>
+#include <cstdio>
+
+#include "logger.h"
+
+// Poll period of the snapshot thread while waiting for the processed frame
+// ID to advance by the configured interval
+static constexpr size_t kTelemetryPollMs = 1;
+
+TelemetryReporter::TelemetryReporter(Config* cfg, Stats* stats,
+                                     PhyStats* phy_stats,
+                                     const RxCounters* rx_counters)
+    : cfg_(cfg),
+      stats_(stats),
+      phy_stats_(phy_stats),
+      rx_counters_(rx_counters) {
+  // One snapshot is a few KB; reserve once so SendSnapshot never allocates
+  report_buf_.reserve(8192);
+}
+
+TelemetryReporter::~TelemetryReporter() { Stop(); }
+
+void TelemetryReporter::AddQueue(
+    const std::string& name,
+    const moodycamel::ConcurrentQueue<EventData>* queue) {
+  queues_.emplace_back(name, queue);
+}
+
+void TelemetryReporter::Start() {
+  running_.store(true);
+  report_thread_ = std::thread(&TelemetryReporter::ReportLoop, this);
+  MLPD_INFO("TelemetryReporter: streaming to %s:%zu every %zu frames\n",
+            cfg_->TelemetryAddr().c_str(), cfg_->TelemetryPort(),
+            cfg_->TelemetryFrameInterval());
+}
+
+void TelemetryReporter::Stop() {
+  if (running_.exchange(false) == true) {
+    report_thread_.join();
+  }
+}
+
+void TelemetryReporter::ReportLoop() {
+  const size_t interval = cfg_->TelemetryFrameInterval();
+  size_t next_report_frame = interval;
+  while (running_.load() == true) {
+    const size_t frame_id = stats_->LastFrameId();
+    if (frame_id >= next_report_frame) {
+      SendSnapshot(frame_id);
+      // Re-arm off the observed frame so a stall does not cause a burst of
+      // back-to-back snapshots when processing catches up
+      next_report_frame = frame_id + interval;
+    } else {
+      std::this_thread::sleep_for(std::chrono::milliseconds(kTelemetryPollMs));
+    }
+  }
+}
+
+/// Append one "name{labels} value" exposition line to buf
+static void AppendMetric(std::string& buf, const char* name,
+                         const char* labels, double value) {
+  char line[256];
+  if (labels != nullptr) {
+    std::snprintf(line, sizeof(line), "%s{%s} %.3f\n", name, labels, value);
+  } else {
+    std::snprintf(line, sizeof(line), "%s %.3f\n", name, value);
+  }
+  buf.append(line);
+}
+
+void TelemetryReporter::SendSnapshot(size_t frame_id) {
+  report_buf_.clear();
+  AppendMetric(report_buf_, "agora_frame_id", nullptr,
+               static_cast<double>(frame_id));
+
+  // Copy the master's histogram before walking it: percentiles then come
+  // from one consistent-enough snapshot instead of a moving target
+  const LatencyHistogram frame_hist = stats_->FrameLatencyHist();
+  if (frame_hist.TotalCount() > 0) {
+    AppendMetric(report_buf_, "agora_frame_latency_us", "quantile=\"0.5\"",
+                 frame_hist.PercentileUs(0.50, cfg_->FreqGhz()));
+    AppendMetric(report_buf_, "agora_frame_latency_us", "quantile=\"0.99\"",
+                 frame_hist.PercentileUs(0.99, cfg_->FreqGhz()));
+    AppendMetric(report_buf_, "agora_frame_latency_us", "quantile=\"0.999\"",
+                 frame_hist.PercentileUs(0.999, cfg_->FreqGhz()));
+  }
+
+  if (kIsWorkerTimingEnabled == true) {
+    for (const DoerType doer_type : kAllDoerTypes) {
+      const double doer_us = stats_->DoerUs(doer_type, frame_id);
+      if (doer_us > 0.0) {
+        char labels[64];
+        std::snprintf(labels, sizeof(labels), "doer=\"%s\"",
+                      kDoerNames.at(doer_type).c_str());
+        AppendMetric(report_buf_, "agora_doer_us", labels, doer_us);
+      }
+    }
+  }
+
+  for (const auto& named_queue : queues_) {
+    char labels[96];
+    std::snprintf(labels, sizeof(labels), "queue=\"%s\"",
+                  named_queue.first.c_str());
+    AppendMetric(report_buf_, "agora_queue_depth", labels,
+                 static_cast<double>(named_queue.second->size_approx()));
+  }
+
+  AppendMetric(report_buf_, "agora_rx_stale_drops_total", nullptr,
+               static_cast<double>(rx_counters_->num_stale_drops_));
+  AppendMetric(report_buf_, "agora_rx_duplicate_drops_total", nullptr,
+               static_cast<double>(rx_counters_->num_duplicate_drops_));
+
+  if ((kCollectPhyStats == true) && (phy_stats_ != nullptr) &&
+      (cfg_->Frame().NumULSyms() > 0)) {
+    for (size_t ue_id = 0; ue_id < cfg_->UeAntNum(); ue_id++) {
+      char labels[32];
+      std::snprintf(labels, sizeof(labels), "ue=\"%zu\"", ue_id);
+      AppendMetric(report_buf_, "agora_evm_snr_db", labels,
+                   phy_stats_->GetEvmSnr(frame_id, ue_id));
+    }
+  }
+
+  try {
+    // The collector endpoint is fixed for the run, so pin the socket on
+    // first use and send without per-datagram address lookup afterwards.
+    // Connecting lazily inside the try keeps an unresolvable collector
+    // hostname a per-snapshot warning, as before
+    if (udp_client_.Connected() == false) {
+      udp_client_.Connect(cfg_->TelemetryAddr(),
+                          static_cast<uint16_t>(cfg_->TelemetryPort()));
+    }
+    udp_client_.Send(reinterpret_cast<const uint8_t*>(report_buf_.data()),
+                     report_buf_.size());
+  } catch (const std::runtime_error& e) {
+    // A dead collector must never take the cell down with it
+    MLPD_WARN("TelemetryReporter: send failed: %s\n", e.what());
+  }
+}
@@ -0,0 +1,72 @@
+/**
+ * @file telemetry.h
+ * @brief Declaration file for the TelemetryReporter class. Periodically
+ * snapshots runtime stats and ships them over UDP for live dashboards.
+ */
+#ifndef TELEMETRY_H_
+#define TELEMETRY_H_
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "buffer.h"
+#include "concurrentqueue.h"
+#include "config.h"
+#include "phy_stats.h"
+#include "stats.h"
+#include "udp_client.h"
+
+/**
+ * @brief Streams a live metrics snapshot over UDP every
+ * Config::TelemetryFrameInterval() frames.
+ *
+ * Each datagram is a Prometheus-style text exposition ("name{labels} value"
+ * lines) covering frame latency percentiles, per-doer worker time for the
+ * last completed frame, approximate depths of registered task queues, RX
+ * drop counters and per-UE EVM SNR. The snapshot thread only reads: it
+ * races benignly with the writers (moodycamel size_approx() is already an
+ * estimate, and a torn histogram read skews one datagram, not the stats
+ * themselves), so the hot path pays nothing for telemetry.
+ */
+class TelemetryReporter {
+ public:
+  TelemetryReporter(Config* cfg, Stats* stats, PhyStats* phy_stats,
+                    const RxCounters* rx_counters);
+  ~TelemetryReporter();
+
+  /// Register a queue whose size_approx() is exported as
+  /// agora_queue_depth{queue="name"}. Must be called before Start()
+  void AddQueue(const std::string& name,
+                const moodycamel::ConcurrentQueue<EventData>* queue);
+
+  void Start();
+  void Stop();
+
+ private:
+  /// Body of the snapshot thread: waits for the processed frame ID to
+  /// advance by the configured interval, then builds and sends one datagram
+  void ReportLoop();
+
+  /// Format the current snapshot into report_buf_ and send it
+  void SendSnapshot(size_t frame_id);
+
+  Config* const cfg_;
+  Stats* const stats_;
+  PhyStats* const phy_stats_;
+  const RxCounters* const rx_counters_;
+
+  /// Queues to export, registered by the owner before Start()
+  std::vector<
+      std::pair<std::string, const moodycamel::ConcurrentQueue<EventData>*>>
+      queues_;
+
+  UDPClient udp_client_;
+  std::string report_buf_;
+  std::thread report_thread_;
+  std::atomic<bool> running_ = false;
+};
+
+#endif  // TELEMETRY_H_
@@ -0,0 +1,234 @@
+/**
+ * @file packet_spool.cc
+ * @brief Implementation of packet spool capture and replay file access
+ */
+
+#include "packet_spool.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#include "logger.h"
+#include "symbols.h"
+#include "utils.h"
+
+static constexpr uint64_t kSpoolMagic = 0x31505341524f4741ULL;  // "AGORASP1"
+static constexpr uint32_t kSpoolVersion = 1;
+
+PacketSpoolWriter::PacketSpoolWriter(const std::string& path,
+                                     size_t packet_length, size_t max_bytes,
+                                     size_t core_offset, size_t core_id)
+    : path_(path),
+      packet_length_(packet_length),
+      record_size_(sizeof(uint64_t) + packet_length),
+      core_offset_(core_offset),
+      core_id_(core_id),
+      staging_(kStagingSlots * (sizeof(uint64_t) + packet_length)),
+      slot_seq_(kStagingSlots) {
+  static_assert((kStagingSlots & (kStagingSlots - 1)) == 0,
+                "Staging ring size must be a power of two");
+  for (size_t i = 0; i < kStagingSlots; i++) {
+    slot_seq_.at(i).store(i, std::memory_order_relaxed);
+  }
+
+  fd_ = ::open(path_.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  RtAssert(fd_ >= 0, "PacketSpoolWriter: failed to create spool file " + path_);
+
+  // Pre-size to a whole number of records plus the header, and map the
+  // full capacity up front so the writer never remaps on the data path
+  const size_t record_capacity = max_bytes / record_size_;
+  RtAssert(record_capacity > 0, "capture_spool_bytes smaller than one record");
+  map_bytes_ = sizeof(PacketSpoolHeader) + (record_capacity * record_size_);
+  RtAssert(::ftruncate(fd_, map_bytes_) == 0,
+           "PacketSpoolWriter: failed to size spool file " + path_);
+
+  void* map = ::mmap(nullptr, map_bytes_, PROT_READ | PROT_WRITE, MAP_SHARED,
+                     fd_, 0);
+  RtAssert(map != MAP_FAILED,
+           "PacketSpoolWriter: failed to mmap spool file " + path_);
+  map_ = static_cast<uint8_t*>(map);
+
+  auto* header = reinterpret_cast<PacketSpoolHeader*>(map_);
+  header->magic_ = kSpoolMagic;
+  header->version_ = kSpoolVersion;
+  header->packet_length_ = static_cast<uint32_t>(packet_length_);
+  header->num_records_ = 0;
+  write_offset_ = sizeof(PacketSpoolHeader);
+  flushed_offset_ = write_offset_;
+
+  MLPD_INFO("PacketSpoolWriter: capturing to %s, capacity %zu packets\n",
+            path_.c_str(), record_capacity);
+  running_.store(true);
+  writer_thread_ = std::thread(&PacketSpoolWriter::WriterLoop, this);
+}
+
+PacketSpoolWriter::~PacketSpoolWriter() {
+  running_.store(false);
+  if (writer_thread_.joinable() == true) {
+    writer_thread_.join();
+  }
+
+  // Finalize the header, flush everything, and trim the preallocation
+  // down to the bytes actually written
+  auto* header = reinterpret_cast<PacketSpoolHeader*>(map_);
+  header->num_records_ = num_records_;
+  ::msync(map_, write_offset_, MS_SYNC);
+  ::munmap(map_, map_bytes_);
+  const int trunc_ret = ::ftruncate(fd_, write_offset_);
+  if (trunc_ret != 0) {
+    MLPD_WARN("PacketSpoolWriter: failed to trim spool file %s\n",
+              path_.c_str());
+  }
+  ::close(fd_);
+
+  std::printf("PacketSpoolWriter: %s holds %zu packets (%zu dropped%s)\n",
+              path_.c_str(), num_records_, num_dropped_.load(),
+              (file_full_ == true) ? ", spool filled up" : "");
+}
+
+void PacketSpoolWriter::Capture(const void* pkt, uint64_t rx_time_ns) {
+  size_t pos = head_.load(std::memory_order_relaxed);
+  for (;;) {
+    const size_t slot = pos & (kStagingSlots - 1);
+    const size_t seq = slot_seq_.at(slot).load(std::memory_order_acquire);
+    const intptr_t dif =
+        static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+    if (dif == 0) {
+      if (head_.compare_exchange_weak(pos, pos + 1,
+                                      std::memory_order_relaxed) == true) {
+        uint8_t* dst = &staging_.at(slot * record_size_);
+        std::memcpy(dst, &rx_time_ns, sizeof(uint64_t));
+        std::memcpy(dst + sizeof(uint64_t), pkt, packet_length_);
+        slot_seq_.at(slot).store(pos + 1, std::memory_order_release);
+        return;
+      }
+    } else if (dif < 0) {
+      // Writer has fallen a full lap behind: drop rather than stall RX
+      num_dropped_.fetch_add(1, std::memory_order_relaxed);
+      return;
+    } else {
+      pos = head_.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+void PacketSpoolWriter::WriterLoop() {
+  PinToCoreWithOffset(ThreadType::kWorkerTXRX, core_offset_, core_id_);
+
+  bool warned_full = false;
+  while (true) {
+    const size_t slot = tail_ & (kStagingSlots - 1);
+    const size_t seq = slot_seq_.at(slot).load(std::memory_order_acquire);
+    if (seq != (tail_ + 1)) {
+      // Ring empty: exit once capture has stopped, otherwise nap briefly
+      if (running_.load() == false) {
+        break;
+      }
+      std::this_thread::sleep_for(std::chrono::microseconds(100));
+      continue;
+    }
+
+    if ((write_offset_ + record_size_) <= map_bytes_) {
+      std::memcpy(&map_[write_offset_], &staging_.at(slot * record_size_),
+                  record_size_);
+      write_offset_ += record_size_;
+      num_records_++;
+    } else if (warned_full == false) {
+      MLPD_WARN("PacketSpoolWriter: spool file %s full, discarding packets\n",
+                path_.c_str());
+      file_full_ = true;
+      warned_full = true;
+    }
+
+    // Release the slot for the producers' next lap
+    slot_seq_.at(slot).store(tail_ + kStagingSlots, std::memory_order_release);
+    tail_++;
+
+    if ((write_offset_ - flushed_offset_) >= kFlushBytes) {
+      // Kick writeback for the finished region and drop it from the page
+      // cache so a long capture never accumulates gigabytes of dirty
+      // pages. Offsets are rounded to page boundaries; the partial tail
+      // page is left alone
+      const size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+      const size_t flush_from = flushed_offset_ & ~(page - 1);
+      const size_t flush_to = write_offset_ & ~(page - 1);
+      if (flush_to > flush_from) {
+        ::msync(&map_[flush_from], flush_to - flush_from, MS_ASYNC);
+        ::madvise(&map_[flush_from], flush_to - flush_from, MADV_DONTNEED);
+      }
+      flushed_offset_ = write_offset_;
+    }
+  }
+}
+
+PacketSpoolReader::PacketSpoolReader(const std::string& path,
+                                     size_t packet_length)
+    : packet_length_(packet_length),
+      record_size_(sizeof(uint64_t) + packet_length) {
+  fd_ = ::open(path.c_str(), O_RDONLY);
+  RtAssert(fd_ >= 0, "PacketSpoolReader: failed to open spool file " + path);
+
+  struct stat st;
+  RtAssert(::fstat(fd_, &st) == 0,
+           "PacketSpoolReader: failed to stat spool file " + path);
+  map_bytes_ = static_cast<size_t>(st.st_size);
+  RtAssert(map_bytes_ >= sizeof(PacketSpoolHeader),
+           "PacketSpoolReader: spool file too short: " + path);
+
+  void* map = ::mmap(nullptr, map_bytes_, PROT_READ, MAP_SHARED, fd_, 0);
+  RtAssert(map != MAP_FAILED,
+           "PacketSpoolReader: failed to mmap spool file " + path);
+  map_ = static_cast<const uint8_t*>(map);
+
+  const auto* header = reinterpret_cast<const PacketSpoolHeader*>(map_);
+  RtAssert(header->magic_ == kSpoolMagic,
+           "PacketSpoolReader: bad magic in spool file " + path);
+  RtAssert(header->version_ == kSpoolVersion,
+           "PacketSpoolReader: unsupported spool version in " + path);
+  RtAssert(header->packet_length_ == packet_length_,
+           "PacketSpoolReader: spool packet length does not match the "
+           "running config");
+
+  // Trust the lesser of the header count and what the file can hold, so
+  // a spool from a crashed capture (header never finalized) still replays
+  const size_t file_records =
+      (map_bytes_ - sizeof(PacketSpoolHeader)) / record_size_;
+  num_records_ = std::min<size_t>(header->num_records_, file_records);
+  if ((header->num_records_ == 0) && (file_records > 0)) {
+    MLPD_WARN(
+        "PacketSpoolReader: %s header not finalized; replaying %zu records "
+        "from the file size\n",
+        path.c_str(), file_records);
+    num_records_ = file_records;
+  }
+
+  MLPD_INFO("PacketSpoolReader: %s holds %zu packets\n", path.c_str(),
+            num_records_);
+}
+
+PacketSpoolReader::~PacketSpoolReader() {
+  if (map_ != nullptr) {
+    ::munmap(const_cast<uint8_t*>(map_), map_bytes_);
+  }
+  if (fd_ >= 0) {
+    ::close(fd_);
+  }
+}
+
+uint64_t PacketSpoolReader::RxTimeNs(size_t rec) const {
+  uint64_t ts;
+  std::memcpy(&ts, &map_[sizeof(PacketSpoolHeader) + (rec * record_size_)],
+              sizeof(uint64_t));
+  return ts;
+}
+
+const uint8_t* PacketSpoolReader::PacketAt(size_t rec) const {
+  return &map_[sizeof(PacketSpoolHeader) + (rec * record_size_) +
+               sizeof(uint64_t)];
+}
@@ -0,0 +1,120 @@
+/**
+ * @file packet_spool.h
+ * @brief Spool-file capture of received packets for offline replay.
+ *
+ * Capture side: RX threads mirror each received packet (with its RX
+ * timestamp) into a bounded staging ring; a dedicated writer thread
+ * drains the ring into a memory-mapped spool file, so the only RX-path
+ * cost is one memcpy into warm staging memory. Replay side: a read-only
+ * mapping of a recorded spool, indexed by record, that LoopTxRxReplay()
+ * feeds back through the pipeline at original or accelerated timing.
+ */
+
+#ifndef PACKET_SPOOL_H_
+#define PACKET_SPOOL_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+/// On-disk layout: one PacketSpoolHeader followed by num_records_
+/// records, each an 8-byte RX timestamp (nanoseconds, CLOCK_MONOTONIC
+/// base) followed by packet_length_ raw packet bytes
+struct PacketSpoolHeader {
+  uint64_t magic_;
+  uint32_t version_;
+  uint32_t packet_length_;
+  uint64_t num_records_;  // Finalized when the writer shuts down
+};
+
+class PacketSpoolWriter {
+ public:
+  /// Creates (truncating) the spool file at [path], pre-sizes it to hold
+  /// up to [max_bytes] of records, and starts the writer thread on core
+  /// (core_offset + core_id)
+  PacketSpoolWriter(const std::string& path, size_t packet_length,
+                    size_t max_bytes, size_t core_offset, size_t core_id);
+
+  /// Stops the writer thread, finalizes the header, and trims the file
+  /// to the bytes actually written
+  ~PacketSpoolWriter();
+
+  PacketSpoolWriter(const PacketSpoolWriter&) = delete;
+  PacketSpoolWriter& operator=(const PacketSpoolWriter&) = delete;
+
+  /// Mirror one received packet into the staging ring. Callable from any
+  /// RX thread; drops (counted) rather than blocks when the writer has
+  /// fallen behind or the spool file is full
+  void Capture(const void* pkt, uint64_t rx_time_ns);
+
+ private:
+  /// Staging ring slots; must be a power of two. At a typical packet
+  /// size this is a few MB of staging memory
+  static constexpr size_t kStagingSlots = 4096;
+
+  /// Bytes written between asynchronous flushes of the mapping. Keeps
+  /// the dirty page set bounded so writeback never stalls the writer
+  static constexpr size_t kFlushBytes = 4 * 1024 * 1024;
+
+  void WriterLoop();
+
+  const std::string path_;
+  const size_t packet_length_;
+  const size_t record_size_;  // Timestamp + packet bytes
+  const size_t core_offset_;
+  const size_t core_id_;
+
+  int fd_ = -1;
+  uint8_t* map_ = nullptr;  // Shared writable mapping of the whole file
+  size_t map_bytes_ = 0;    // Mapping size (header + record capacity)
+  size_t write_offset_ = 0;  // Next record byte offset, writer thread only
+  size_t flushed_offset_ = 0;
+  size_t num_records_ = 0;
+  bool file_full_ = false;
+
+  // Bounded MPSC staging ring: RX threads claim a slot with a CAS on
+  // head_ and publish it through the slot's sequence number; the writer
+  // thread consumes in claim order. seq == slot index means empty for
+  // that lap; seq == claim position + 1 means ready
+  std::vector<uint8_t> staging_;
+  std::vector<std::atomic<size_t>> slot_seq_;
+  std::atomic<size_t> head_ = {0};
+  size_t tail_ = 0;  // Writer thread only
+
+  std::atomic<size_t> num_dropped_ = {0};
+  std::atomic<bool> running_ = {false};
+  std::thread writer_thread_;
+};
+
+class PacketSpoolReader {
+ public:
+  /// Maps the spool file at [path] read-only and validates its header
+  /// against the running config's packet length
+  PacketSpoolReader(const std::string& path, size_t packet_length);
+  ~PacketSpoolReader();
+
+  PacketSpoolReader(const PacketSpoolReader&) = delete;
+  PacketSpoolReader& operator=(const PacketSpoolReader&) = delete;
+
+  size_t NumRecords() const { return num_records_; }
+
+  /// RX timestamp of record [rec] in nanoseconds (offset from the first
+  /// record is what matters; the absolute base is the capture machine's)
+  uint64_t RxTimeNs(size_t rec) const;
+
+  /// Raw packet bytes of record [rec] (packet_length bytes)
+  const uint8_t* PacketAt(size_t rec) const;
+
+ private:
+  const size_t packet_length_;
+  const size_t record_size_;
+  int fd_ = -1;
+  const uint8_t* map_ = nullptr;
+  size_t map_bytes_ = 0;
+  size_t num_records_ = 0;
+};
+
+#endif  // PACKET_SPOOL_H_
@@ -17,6 +17,11 @@ static constexpr bool kDebugPrintBeacon = false;
 static constexpr size_t kSlowStartMulStage1 = 32;
 static constexpr size_t kSlowStartMulStage2 = 8;
 
+// Packets pulled from a socket with one recvmmsg() call
+static constexpr size_t kRxBatchSize = 16;
+static_assert(kRxBatchSize <= UDPServer::kMaxRecvBurst,
+              "RX batch must fit in one RecvMulti() call");
+
 PacketTXRX::PacketTXRX(Config* cfg, size_t core_offset)
     : cfg_(cfg),
       core_offset_(core_offset),
@@ -71,10 +76,10 @@ bool PacketTXRX::StartTxRx(Table<char>& buffer, size_t packet_num_in_buffer,
 
     if (cfg_->Frame().NumDLSyms() > 0) {
       std::memcpy(
-          calib_dl_buffer[kFrameWnd - 1], radioconfig_->GetCalibDl(),
+          calib_dl_buffer[cfg_->FrameWnd() - 1], radioconfig_->GetCalibDl(),
           cfg_->OfdmDataNum() * cfg_->BfAntNum() * sizeof(arma::cx_float));
       std::memcpy(
-          calib_ul_buffer[kFrameWnd - 1], radioconfig_->GetCalibUl(),
+          calib_ul_buffer[cfg_->FrameWnd() - 1], radioconfig_->GetCalibUl(),
           cfg_->OfdmDataNum() * cfg_->BfAntNum() * sizeof(arma::cx_float));
     }
   }
@@ -86,6 +91,75 @@ bool PacketTXRX::StartTxRx(Table<char>& buffer, size_t packet_num_in_buffer,
   /// Make sure we can fit each channel in the tread buffer without rollover
   assert(buffers_per_socket_ % cfg_->NumChannels() == 0);
 
+  tx_pace_interval_tsc_.assign(socket_thread_num_, 0);
+  next_tx_tsc_.assign(socket_thread_num_, 0);
+
+  rx_next_expected_time_.assign(cfg_->NumRadios(), -1);
+  rx_drift_samples_.assign(cfg_->NumRadios(), 0);
+  rx_drift_corrections_.assign(cfg_->NumRadios(), 0);
+  rx_drift_reads_.assign(cfg_->NumRadios(), 0);
+
+  // One header slot per event a DequeueSend call can dequeue
+  const size_t tx_header_slots = (cfg_->BsAntNum() / socket_thread_num_) + 1;
+  tx_pkt_headers_.assign(
+      socket_thread_num_,
+      std::vector<char>(tx_header_slots * Packet::kOffsetOfData));
+
+  // Render the beacon symbol packets once; TxBeacon() replays them with
+  // only the header patched instead of rebuilding a zeroed buffer per
+  // frame. The beacon antenna transmits the actual time-domain beacon
+  // sequence rather than the zero payload it used to
+  beacon_zero_pkts_.assign(socket_thread_num_,
+                           std::vector<uint8_t>(cfg_->PacketLength(), 0));
+  beacon_ant_pkt_.assign(cfg_->PacketLength(), 0);
+  const size_t beacon_bytes =
+      std::min(cfg_->BeaconCi16().size() * sizeof(std::complex<int16_t>),
+               cfg_->PacketLength() - Packet::kOffsetOfData);
+  std::memcpy(beacon_ant_pkt_.data() + Packet::kOffsetOfData,
+              cfg_->BeaconCi16().data(), beacon_bytes);
+
+  if (cfg_->RxEpochReclaim() == true) {
+    // Every other datapath keeps per-packet reference counting: the
+    // hardware backends manage slots differently and DPDK zero-copy needs
+    // the per-packet GcPacket() hook to return mbufs
+    RtAssert((kUseArgos == false) && (kUseUHD == false) &&
+                 (cfg_->XdpTransport() == false),
+             "rx_epoch_reclaim is only supported on the plain socket "
+             "datapath");
+#if defined(USE_URING) || defined(USE_DPDK)
+    RtAssert(false,
+             "rx_epoch_reclaim is only supported on the plain socket "
+             "datapath");
+#endif
+    RtAssert(rx_frame_watermark_ != nullptr,
+             "rx_epoch_reclaim requires the completed-frame watermark");
+  }
+
+  // Capture and replay ride the plain socket datapath only: the hardware
+  // backends and the kernel-bypass RX paths deliver packets outside
+  // RecvEnqueueBatch()
+  if (cfg_->CaptureSpool().empty() == false) {
+    RtAssert((kUseArgos == false) && (kUseUHD == false) &&
+                 (cfg_->XdpTransport() == false),
+             "capture_spool is only supported on the plain socket datapath");
+#if defined(USE_URING)
+    RtAssert(false,
+             "capture_spool is only supported on the plain socket datapath");
+#endif
+    // Writer thread runs on the core after the RX threads
+    spool_writer_ = std::make_unique<PacketSpoolWriter>(
+        cfg_->CaptureSpool(), cfg_->PacketLength(), cfg_->CaptureSpoolBytes(),
+        core_offset_, socket_thread_num_);
+  }
+  const bool replay_mode = (cfg_->ReplaySpool().empty() == false);
+  if (replay_mode == true) {
+    RtAssert((kUseArgos == false) && (kUseUHD == false) &&
+                 (cfg_->XdpTransport() == false),
+             "replay_spool is only supported on the plain socket datapath");
+    spool_reader_ = std::make_unique<PacketSpoolReader>(cfg_->ReplaySpool(),
+                                                        cfg_->PacketLength());
+  }
+
   rx_packets_.resize(socket_thread_num_);
   for (size_t i = 0; i < socket_thread_num_; i++) {
     rx_packets_.at(i).reserve(buffers_per_socket_);
@@ -102,9 +176,39 @@ bool PacketTXRX::StartTxRx(Table<char>& buffer, size_t packet_num_in_buffer,
       socket_std_threads_.emplace_back(&PacketTXRX::LoopTxRxUsrp, this, i);
     } else {
       MLPD_SYMBOL("LoopTXRX: Starting thread %zu\n", i);
+      if (replay_mode == true) {
+        socket_std_threads_.emplace_back(&PacketTXRX::LoopTxRxReplay, this, i);
+        continue;
+      }
+#if defined(USE_AF_XDP)
+      if (cfg_->XdpTransport() == true) {
+        socket_std_threads_.emplace_back(&PacketTXRX::LoopTxRxXdp, this, i);
+        continue;
+      }
+#else
+      RtAssert(cfg_->XdpTransport() == false,
+               "xdp_transport requires a binary built with USE_AF_XDP");
+#endif
+#if defined(USE_URING)
+      socket_std_threads_.emplace_back(&PacketTXRX::LoopTxRxUring, this, i);
+#else
       socket_std_threads_.emplace_back(&PacketTXRX::LoopTxRx, this, i);
+#endif
     }
   }
+
+  // Argos mode: dedicated beacon/calibration TX thread (pinned after the
+  // RX threads), so a slow SoapySDR writeStream never stalls pilot RX.
+  // Not needed when the HW framer beacons by itself and there are no
+  // calibration pilots to send
+  if ((kUseArgos == true) &&
+      ((cfg_->HwFramer() == false) ||
+       ((cfg_->Frame().NumDLSyms() > 0) &&
+        (cfg_->Frame().IsRecCalEnabled() == true)))) {
+    MLPD_SYMBOL("LoopTxBeaconArgos: Starting thread %zu\n", socket_thread_num_);
+    socket_std_threads_.emplace_back(&PacketTXRX::LoopTxBeaconArgos, this,
+                                     socket_thread_num_);
+  }
   //Need to wait for all the threads to have started......
   while (threads_started_.load() != socket_std_threads_.size()) {
     std::this_thread::sleep_for(std::chrono::milliseconds(10));
@@ -113,6 +217,14 @@ bool PacketTXRX::StartTxRx(Table<char>& buffer, size_t packet_num_in_buffer,
   }
   MLPD_INFO("LoopTXRX: socket threads are waiting for events\n");
 
+  if (replay_mode == true) {
+    // Publish the common pacing origin, with a little headroom so no
+    // thread starts behind schedule and bursts its first records
+    replay_epoch_ns_.store(
+        static_cast<long long>(GetTime::GetTimeUs() * 1e3) +
+        (100LL * 1000 * 1000) /* 100 ms */);
+  }
+
   if ((kUseArgos == true && cfg_->HwFramer() == true) || (kUseUHD == true)) {
     radioconfig_->Go();
   }
@@ -125,25 +237,29 @@ void PacketTXRX::TxBeacon(int tid, size_t frame_id) {
   size_t radio_lo = tid * cfg_->NumRadios() / socket_thread_num_;
   size_t radio_hi = (tid + 1) * cfg_->NumRadios() / socket_thread_num_;
 
-  // Send a beacon packet in the downlink to trigger user pilot
-  std::vector<uint8_t> udp_pkt_buf(cfg_->PacketLength(), 0);
-  auto* pkt = reinterpret_cast<Packet*>(&udp_pkt_buf[0]);
-
   if (kDebugPrintBeacon) {
     std::printf("TXRX [%d]: Sending beacon for frame %zu tx delta %f ms\n", tid,
                 frame_id, time_now - send_time);
   }
   send_time = time_now;
 
+  // Send the beacon packets rendered at startup in the downlink to trigger
+  // user pilot, patching only the header fields per antenna. Antenna
+  // ranges are disjoint, so only this thread touches the beacon antenna's
+  // packet
   for (size_t beacon_sym = 0; beacon_sym < cfg_->Frame().NumBeaconSyms();
        beacon_sym++) {
     for (size_t ant_id = radio_lo; ant_id < radio_hi; ant_id++) {
+      uint8_t* pkt_buf = (ant_id == cfg_->BeaconAnt())
+                             ? beacon_ant_pkt_.data()
+                             : beacon_zero_pkts_.at(tid).data();
+      auto* pkt = reinterpret_cast<Packet*>(pkt_buf);
       new (pkt) Packet(frame_id, cfg_->Frame().GetBeaconSymbol(beacon_sym),
                        0 /* cell_id */, ant_id);
 
       udp_clients_.at(ant_id)->Send(cfg_->BsRruAddr(),
-                                    cfg_->BsRruPort() + ant_id,
-                                    udp_pkt_buf.data(), cfg_->PacketLength());
+                                    cfg_->BsRruPort() + ant_id, pkt_buf,
+                                    cfg_->PacketLength());
     }
   }
 }
@@ -160,16 +276,24 @@ void PacketTXRX::LoopTxRx(size_t tid) {
   const size_t slow_start_tsc1 =
       std::max(kSlowStartMulStage1 * frame_tsc_delta, two_hundred_ms_ticks);
 
-  const size_t slow_start_thresh1 = kFrameWnd;
+  const size_t slow_start_thresh1 = cfg_->FrameWnd();
   const size_t slow_start_tsc2 = kSlowStartMulStage2 * frame_tsc_delta;
-  const size_t slow_start_thresh2 = kFrameWnd * 4;
+  const size_t slow_start_thresh2 = cfg_->FrameWnd() * 4;
   size_t delay_tsc = frame_tsc_delta;
 
   if (kEnableSlowStart) {
     delay_tsc = slow_start_tsc1;
   }
 
-  size_t* const rx_frame_start = (*frame_start_)[tid];
+  if (cfg_->TxPacing()) {
+    // Wire-time budget per packet: spread this thread's share of a
+    // downlink symbol evenly across the symbol duration
+    const size_t ants_per_thread = std::max(
+        static_cast<size_t>(1), cfg_->BsAntNum() / socket_thread_num_);
+    tx_pace_interval_tsc_.at(tid) =
+        frame_tsc_delta / (cfg_->Frame().NumTotalSyms() * ants_per_thread);
+  }
+
   size_t rx_slot = 0;
   size_t radios_per_thread = (cfg_->NumRadios() / socket_thread_num_);
   if (cfg_->NumRadios() % socket_thread_num_ > 0) {
@@ -180,11 +304,13 @@ void PacketTXRX::LoopTxRx(size_t tid) {
       std::min((radio_lo + radios_per_thread), cfg_->BsAntNum()) - 1;
 
   static constexpr size_t kSockBufSize = (1024 * 1024 * 64 * 8) - 1;
+  const size_t sock_buf_size =
+      (cfg_->UdpRxBufferBytes() != 0) ? cfg_->UdpRxBufferBytes() : kSockBufSize;
   for (size_t radio_id = radio_lo; radio_id <= radio_hi; ++radio_id) {
     size_t local_port_id = cfg_->BsServerPort() + radio_id;
 
-    udp_servers_.at(radio_id) =
-        std::make_unique<UDPServer>(local_port_id, kSockBufSize);
+    udp_servers_.at(radio_id) = std::make_unique<UDPServer>(
+        local_port_id, sock_buf_size, cfg_->UdpBusyPollUs());
     udp_clients_.at(radio_id) = std::make_unique<UDPClient>();
     MLPD_FRAME(
         "TXRX thread %d: set up UDP socket server listening to port %d"
@@ -203,6 +329,11 @@ void PacketTXRX::LoopTxRx(size_t tid) {
   size_t tx_frame_start = GetTime::Rdtsc();
   size_t tx_frame_id = 0;
   size_t send_time = delay_tsc + tx_frame_start;
+  // Scrape the kernel drop counters about once a second: an SO_RCVBUF
+  // overflow is otherwise silent and only shows up in netstat
+  const size_t drop_poll_tsc_delta =
+      static_cast<size_t>(cfg_->FreqGhz() * 1e9);
+  size_t drop_poll_time = tx_frame_start + drop_poll_tsc_delta;
   // Send Beacons for the first time to kick off sim
   // TxBeacon(tid, tx_frame_id++);
   while (cfg_->Running() == true) {
@@ -226,22 +357,20 @@ void PacketTXRX::LoopTxRx(size_t tid) {
       send_time += delay_tsc;
     }
 
+    if (rdtsc_now > drop_poll_time) {
+      for (size_t r = radio_lo; r <= radio_hi; r++) {
+        udp_servers_.at(r)->PollKernelDrops("BS RX");
+      }
+      drop_poll_time = rdtsc_now + drop_poll_tsc_delta;
+    }
+
     const size_t send_result = DequeueSend(tid);
     if (0 == send_result) {
       // receive data
 
-      Packet* pkt = RecvEnqueue(tid, radio_id, rx_slot);
-      if (pkt != nullptr) {
-        rx_slot = (rx_slot + 1) % buffers_per_socket_;
-
-        if (kIsWorkerTimingEnabled) {
-          int frame_id = pkt->frame_id_;
-          if (frame_id > prev_frame_id) {
-            rx_frame_start[frame_id % kNumStatsFrames] = GetTime::Rdtsc();
-            prev_frame_id = frame_id;
-          }
-        }
-
+      const size_t num_rx =
+          RecvEnqueueBatch(tid, radio_id, prev_frame_id, rx_slot);
+      if (num_rx > 0) {
         if (++radio_id == (radio_hi + 1)) {
           radio_id = radio_lo;
         }
@@ -250,27 +379,73 @@ void PacketTXRX::LoopTxRx(size_t tid) {
   }    // end while
 }
 
-Packet* PacketTXRX::RecvEnqueue(size_t tid, size_t radio_id, size_t rx_slot) {
+size_t PacketTXRX::RecvEnqueueBatch(size_t tid, size_t radio_id,
+                                    int& prev_frame_id, size_t& rx_slot) {
   moodycamel::ProducerToken* local_ptok = rx_ptoks_[tid];
-  size_t packet_length = cfg_->PacketLength();
-  RxPacket& rx = rx_packets_.at(tid).at(rx_slot);
-
-  // if rx_buffer is full, exit
-  if (rx.Empty() == false) {
-    MLPD_ERROR("TXRX thread %zu rx_buffer full, offset: %zu\n", tid, rx_slot);
-    cfg_->Running(false);
-    return (nullptr);
+  const size_t packet_length = cfg_->PacketLength();
+  size_t* const rx_frame_start = (*frame_start_)[tid];
+
+  // Gather destination buffers from consecutive ring slots, then drain the
+  // socket with a single recvmmsg() call
+  uint8_t* pkt_bufs[kRxBatchSize];
+  size_t rx_lengths[kRxBatchSize];
+  const bool epoch_reclaim = cfg_->RxEpochReclaim();
+  for (size_t i = 0; i < kRxBatchSize; i++) {
+    const size_t slot = (rx_slot + i) % buffers_per_socket_;
+    RxPacket& rx = rx_packets_.at(tid).at(slot);
+
+    // In frame-epoch mode a slot is free once the frame stamped on it has
+    // completed; otherwise the per-packet reference count decides
+    bool slot_free;
+    if (epoch_reclaim == true) {
+      slot_free =
+          (rx.FrameEpoch() == SIZE_MAX) ||
+          (rx.FrameEpoch() <
+           rx_frame_watermark_->load(std::memory_order_acquire));
+    } else {
+      slot_free = rx.Empty();
+    }
+
+    // if rx_buffer is full, exit
+    if (slot_free == false) {
+      MLPD_ERROR("TXRX thread %zu rx_buffer full, offset: %zu\n", tid, slot);
+      cfg_->Running(false);
+      return (0);
+    }
+    pkt_bufs[i] = reinterpret_cast<uint8_t*>(rx.RawPacket());
+  }
+
+  const ssize_t num_rx = udp_servers_.at(radio_id)->RecvMulti(
+      pkt_bufs, packet_length, kRxBatchSize, rx_lengths);
+  if (0 > num_rx) {
+    MLPD_ERROR("RecvEnqueueBatch: Udp RecvMulti failed with error\n");
+    throw std::runtime_error("PacketTXRX: recvmmsg failed");
   }
-  Packet* pkt = rx.RawPacket();
-
-  ssize_t rx_bytes = udp_servers_.at(radio_id)->Recv(
-      reinterpret_cast<uint8_t*>(pkt), packet_length);
-  if (0 > rx_bytes) {
-    MLPD_ERROR("RecvEnqueue: Udp Recv failed with error\n");
-    throw std::runtime_error("PacketTXRX: recv failed");
-  } else if (rx_bytes == 0) {
-    pkt = nullptr;
-  } else if (static_cast<size_t>(rx_bytes) == packet_length) {
+
+  // One timestamp per recvmmsg() batch: the packets hit the socket
+  // together, and capture only needs the inter-packet spacing for replay
+  const uint64_t rx_time_ns =
+      (spool_writer_ != nullptr)
+          ? static_cast<uint64_t>(GetTime::GetTimeUs() * 1e3)
+          : 0;
+
+  for (ssize_t i = 0; i < num_rx; i++) {
+    if (rx_lengths[i] != packet_length) {
+      MLPD_ERROR(
+          "RecvEnqueueBatch: Udp Recv failed to receive all expected bytes");
+      throw std::runtime_error(
+          "PacketTXRX::RecvEnqueueBatch: Udp Recv failed to receive all "
+          "expected bytes");
+    }
+    RxPacket& rx = rx_packets_.at(tid).at(rx_slot);
+    Packet* pkt = rx.RawPacket();
+
+    if (spool_writer_ != nullptr) {
+      // Mirror the raw wire bytes, before the multicell antenna-id
+      // rewrite below; replay reapplies the rewrite like the live path
+      spool_writer_->Capture(pkt, rx_time_ns);
+    }
+
     if (kDebugPrintInTask) {
       std::printf("In TXRX thread %zu: Received frame %d, symbol %d, ant %d\n",
                   tid, pkt->frame_id_, pkt->symbol_id_, pkt->ant_id_);
@@ -289,20 +464,28 @@ Packet* PacketTXRX::RecvEnqueue(size_t tid, size_t radio_id, size_t rx_slot) {
           pkt->ant_id_, pkt->cell_id_);
     }
 
+    if (kIsWorkerTimingEnabled) {
+      const int frame_id = pkt->frame_id_;
+      if (frame_id > prev_frame_id) {
+        rx_frame_start[frame_id % kNumStatsFrames] = GetTime::Rdtsc();
+        prev_frame_id = frame_id;
+      }
+    }
+
     // Push kPacketRX event into the queue.
-    rx.Use();
+    if (epoch_reclaim == true) {
+      rx.SetFrameEpoch(pkt->frame_id_);
+    } else {
+      rx.Use();
+    }
     EventData rx_message(EventType::kPacketRX, rx_tag_t(rx).tag_);
     if (message_queue_->enqueue(*local_ptok, rx_message) == false) {
       MLPD_ERROR("socket message enqueue failed\n");
       throw std::runtime_error("PacketTXRX: socket message enqueue failed");
     }
-  } else {
-    MLPD_ERROR("RecvEnqueue: Udp Recv failed to receive all expected bytes");
-    throw std::runtime_error(
-        "PacketTXRX::RecvEnqueue: Udp Recv failed to receive all expected "
-        "bytes");
+    rx_slot = (rx_slot + 1) % buffers_per_socket_;
   }
-  return pkt;
+  return static_cast<size_t>(num_rx);
 }
 
 size_t PacketTXRX::DequeueSend(int tid) {
@@ -314,6 +497,15 @@ size_t PacketTXRX::DequeueSend(int tid) {
   // Single producer ordering in q is preserved
   const size_t dequeued_items = task_queue_->try_dequeue_bulk_from_producer(
       *tx_ptoks_[tid], events.data(), events.size());
+  if (dequeued_items == 0) {
+    return 0;
+  }
+
+  std::vector<const uint8_t*> tx_hdrs(dequeued_items);
+  std::vector<const uint8_t*> tx_payloads(dequeued_items);
+  std::vector<uint16_t> tx_ports(dequeued_items);
+  std::vector<size_t> tx_ants(dequeued_items);
+  char* const hdr_pool = tx_pkt_headers_.at(tid).data();
 
   for (size_t item = 0; item < dequeued_items; item++) {
     EventData& current_event = events.at(item);
@@ -340,18 +532,62 @@ size_t PacketTXRX::DequeueSend(int tid) {
           message_queue_->size_approx());
     }
 
+    // Scatter-gather: header from the per-thread pool, payload straight
+    // from the (payload-only) DL socket buffer
     auto* pkt =
-        reinterpret_cast<Packet*>(&tx_buffer_[offset * cfg_->DlPacketLength()]);
+        reinterpret_cast<Packet*>(hdr_pool + (item * Packet::kOffsetOfData));
     new (pkt) Packet(frame_id, symbol_id, 0 /* cell_id */, ant_id);
 
-    // Send data (one OFDM symbol)
-    udp_clients_.at(ant_id)->Send(cfg_->BsRruAddr(), cfg_->BsRruPort() + ant_id,
-                                  reinterpret_cast<uint8_t*>(pkt),
-                                  cfg_->DlPacketLength());
+    tx_hdrs.at(item) = reinterpret_cast<const uint8_t*>(pkt);
+    tx_payloads.at(item) = reinterpret_cast<const uint8_t*>(
+        &tx_buffer_[offset * cfg_->DlPayloadLength()]);
+    tx_ports.at(item) = static_cast<uint16_t>(cfg_->BsRruPort() + ant_id);
+    tx_ants.at(item) = ant_id;
+  }
 
+  const size_t pace_interval = tx_pace_interval_tsc_.at(tid);
+  if (pace_interval != 0) {
+    // Paced mode: one packet per wire-time deadline, with a calibrated
+    // busy-wait between sends. Bursting a whole symbol through sendmmsg
+    // would defeat the spacing.
+    for (size_t item = 0; item < dequeued_items; item++) {
+      size_t& deadline = next_tx_tsc_.at(tid);
+      size_t now = GetTime::Rdtsc();
+      if (now >= deadline) {
+        // Fell behind (or first send): transmit now and restart the
+        // schedule from here
+        deadline = now + pace_interval;
+      } else {
+        while (GetTime::Rdtsc() < deadline) {
+          // calibrated busy-wait until this packet's wire time
+        }
+        deadline += pace_interval;
+      }
+      udp_clients_.at(tx_ants.at(item))
+          ->Send(cfg_->BsRruAddr(), tx_ports.at(item), tx_hdrs.at(item),
+                 Packet::kOffsetOfData, tx_payloads.at(item),
+                 cfg_->DlPayloadLength());
+    }
+  } else {
+    // Send data (one OFDM symbol per packet). The TX sockets are
+    // unconnected, so one client can carry packets for any antenna; the
+    // destination port selects the receiver.
+    size_t item = 0;
+    while (item < dequeued_items) {
+      const size_t batch_size =
+          std::min(dequeued_items - item, UDPClient::kMaxSendBurst);
+      udp_clients_.at(tx_ants.at(item))
+          ->SendBatch(cfg_->BsRruAddr(), &tx_ports.at(item), &tx_hdrs.at(item),
+                      Packet::kOffsetOfData, &tx_payloads.at(item),
+                      cfg_->DlPayloadLength(), batch_size);
+      item += batch_size;
+    }
+  }
+
+  for (size_t item = 0; item < dequeued_items; item++) {
     RtAssert(message_queue_->enqueue(
                  *rx_ptoks_[tid],
-                 EventData(EventType::kPacketTX, current_event.tags_[0])),
+                 EventData(EventType::kPacketTX, events.at(item).tags_[0])),
              "Socket message enqueue failed\n");
   }
   return dequeued_items;
@@ -8,6 +8,7 @@
 #define PACKETTXRX_H_
 
 #include <algorithm>
+#include <array>
 #include <cassert>
 #include <chrono>
 #include <ctime>
@@ -20,6 +21,7 @@
 #include "concurrentqueue.h"
 #include "config.h"
 #include "gettime.h"
+#include "packet_spool.h"
 #include "radio_lib.h"
 #include "symbols.h"
 #include "udp_client.h"
@@ -28,8 +30,12 @@
 #if defined(USE_DPDK)
 #include "dpdk_transport.h"
 
-// Removed support for copy free dpdk memory due to slowdown issue.
-//#define USE_DPDK_MEMORY
+// Zero-copy RX: DoFFT consumes the payload inside the mbuf and the
+// RxPacket GC hook frees it once the FFT worker is done, deleting the
+// per-packet FastMemcpy into the socket buffer table. Enabled with the
+// USE_DPDK_MEMORY cmake switch; mbufs then live until the FFT completes,
+// so the mempool must cover the whole RX packet budget (checked in
+// StartTxRx)
 
 #if defined(USE_DPDK_MEMORY)
 class DPDKRxPacket : public RxPacket {
@@ -99,29 +105,86 @@ class PacketTXRX {
                  Table<complex_float>& calib_dl_buffer_,
                  Table<complex_float>& calib_ul_buffer_);
 
+  /// Point the RX threads at the master's completed-frame watermark.
+  /// Required for frame-epoch packet-slot reclamation (rx_epoch_reclaim):
+  /// a slot is reusable once the frame stamped on it falls below the
+  /// watermark. Called once before StartTxRx().
+  void SetRxFrameWatermark(const std::atomic<size_t>* watermark) {
+    rx_frame_watermark_ = watermark;
+  }
+
   void TxBeacon(int tid, size_t frame_id);
   void TxBeaconHW(size_t frame_id, size_t radio_id, long long time0);
   void TxReciprocityCalibPilots(size_t frame_id, size_t radio_id,
                                 long long time0);
 
+  /// Accumulated per-radio RX timestamp drift in samples (Argos software
+  /// framer mode)
+  const std::vector<long long>& RxDriftSamples() const {
+    return rx_drift_samples_;
+  }
+
  private:
   void LoopTxRx(size_t tid);  // The thread function for thread [tid]
   size_t DequeueSend(int tid);
-  Packet* RecvEnqueue(size_t tid, size_t radio_id, size_t rx_slot);
+  // Drain up to one recvmmsg() burst from radio [radio_id] into the ring
+  // starting at rx_slot, enqueue a kPacketRX event per packet, and advance
+  // rx_slot past the received packets. Returns the number received.
+  size_t RecvEnqueueBatch(size_t tid, size_t radio_id, int& prev_frame_id,
+                          size_t& rx_slot);
+
+  // Replay datapath (replay_spool config key): feed this thread's share
+  // of a captured spool back through the pipeline at original or
+  // accelerated timing, instead of receiving from the network
+  void LoopTxRxReplay(size_t tid);
+
+#if defined(USE_URING)
+  // io_uring datapath: same role as LoopTxRx, but RX reads complete
+  // straight into the registered packet ring and, with SQPOLL, the
+  // steady state issues no per-packet syscalls
+  void LoopTxRxUring(size_t tid);
+#endif
+
+#if defined(USE_AF_XDP)
+  // AF_XDP datapath (xdp_transport config flag): RX through a per-thread
+  // XDP socket bound to one NIC queue, bypassing the UDP stack without
+  // taking the NIC away from the host. TX stays on the socket path
+  void LoopTxRxXdp(size_t tid);
+#endif
 
   void LoopTxRxArgos(size_t tid);
+  // Dedicated low-rate thread for beacon and reciprocity calibration
+  // pilot TX in Argos mode. A slow SoapySDR writeStream for a beacon
+  // stalls whichever thread issues it; offloading keeps the
+  // RecvEnqueueArgos threads pure RX
+  void LoopTxBeaconArgos(size_t tid);
+  // Tell the beacon thread that [frame_id]'s beacon is due (monotonic;
+  // safe to call from multiple threads)
+  void PublishBeaconFrame(size_t frame_id);
   size_t DequeueSendArgos(int tid, long long time0);
   std::vector<Packet*> RecvEnqueueArgos(size_t tid, size_t radio_id,
                                         size_t rx_slot, size_t frame_id,
                                         size_t symbol_id);
 
+  // Compare radio [radio_id]'s reported read timestamp against the
+  // prediction chain and realign the stream onto symbol boundaries when
+  // it drifts (Argos software framer mode)
+  void TrackRxDrift(size_t radio_id, long long rx_time);
+
   long long rx_time_bs_;
   long long tx_time_bs_;
   void LoopTxRxUsrp(size_t tid);
   int DequeueSendUsrp(int tid);
   int DequeueSendUsrp(int tid, int frame_id, int symbol_id);
-  Packet* RecvEnqueueUsrp(size_t tid, size_t radio_id, size_t rx_slot,
-                          size_t frame_id, size_t symbol_id);
+  /// Drain one multi-symbol quantum from radio_id's stream into the
+  /// per-channel staging buffers, then split it into per-antenna RX
+  /// packets in userspace. Returns the number of whole symbols consumed
+  /// (0 on error or shutdown) and advances rx_slot past the packets it
+  /// enqueued. frame_id/symbol_id identify the first symbol of the quantum
+  size_t RecvEnqueueBatchUsrp(size_t tid, size_t radio_id, size_t& rx_slot,
+                              size_t frame_id, size_t symbol_id,
+                              void** staging, size_t* rx_frame_start,
+                              int& prev_frame_id);
 
   Config* cfg_;
 
@@ -135,6 +198,10 @@ class PacketTXRX {
   std::vector<std::thread> socket_std_threads_;
   size_t buffers_per_socket_;
 
+  // First frame the master has not yet completed, published by the master
+  // once per frame. Read by RX threads in frame-epoch reclamation mode
+  const std::atomic<size_t>* rx_frame_watermark_ = nullptr;
+
   char* tx_buffer_;
   Table<size_t>* frame_start_;
   moodycamel::ConcurrentQueue<EventData>* message_queue_;
@@ -145,13 +212,80 @@ class PacketTXRX {
   std::vector<std::unique_ptr<UDPServer>> udp_servers_;
   std::vector<std::unique_ptr<UDPClient>> udp_clients_;
 
+  // Packet capture to a spool file (capture_spool config key) and replay
+  // from one (replay_spool). The writer runs on its own thread; the
+  // reader is a shared read-only mapping every replay thread indexes.
+  // Replay threads pace against replay_epoch_ns_, the common wall-clock
+  // origin published once all of them have started
+  std::unique_ptr<PacketSpoolWriter> spool_writer_;
+  std::unique_ptr<PacketSpoolReader> spool_reader_;
+  std::atomic<long long> replay_epoch_ns_ = {0};
+
   std::atomic<size_t> threads_started_;
 
+  // Per-radio RX timestamp drift tracking (Argos software framer mode):
+  // predicted timestamp of the next read, accumulated drift in samples,
+  // realignment count, and total reads (for the periodic rate report).
+  // A negative expected time means the radio is not yet anchored
+  std::vector<long long> rx_next_expected_time_;
+  std::vector<long long> rx_drift_samples_;
+  std::vector<size_t> rx_drift_corrections_;
+  std::vector<size_t> rx_drift_reads_;
+
+  // Beacon TX offload state (Argos mode): the highest frame whose beacon
+  // is due, and the hardware time base published by the first RX thread
+  // to finish its sync (all threads derive nominally identical values
+  // from the common FPGA clock)
+  std::atomic<ssize_t> beacon_tx_frame_ = {-1};
+  std::atomic<long long> argos_time0_ = {0};
+  std::atomic<bool> argos_time0_set_ = {false};
+
+  // Per-thread pools of Packet headers for scatter-gather TX. The DL
+  // socket buffer holds payloads only; headers are built here and
+  // gathered onto the wire by sendmsg/sendmmsg
+  std::vector<std::vector<char>> tx_pkt_headers_;
+
+  // Beacon symbols carry config-constant content, so their wire-format
+  // packets are rendered once at startup and replayed every frame with
+  // only the header patched: the beacon antenna's packet holds the
+  // time-domain beacon sequence, the per-thread packets hold the zero
+  // payload the remaining antennas transmit
+  std::vector<std::vector<uint8_t>> beacon_zero_pkts_;
+  std::vector<uint8_t> beacon_ant_pkt_;
+
+  // TX pacing (tx_pacing config flag): rdtsc ticks between consecutive
+  // paced sends of one thread, and the per-thread deadline of the next
+  // allowed send. Zero interval disables pacing
+  std::vector<size_t> tx_pace_interval_tsc_;
+  std::vector<size_t> next_tx_tsc_;
+
 #if defined(USE_DPDK)
   std::vector<uint16_t> port_ids_;
   uint32_t bs_rru_addr_;     // IPv4 address of the simulator sender
   uint32_t bs_server_addr_;  // IPv4 address of the Agora server
+  // Shared mempool; nullptr when dpdk_rss gives every queue a private pool
   struct rte_mempool* mbuf_pool_;
+  // TX timestamp offload state (tx_pacing): mbuf dynamic field offset and
+  // flag, per-thread next wire time in device clock ticks, and a one-time
+  // device-clock/TSC calibration so the datapath never reads the device
+  // clock over PCIe. dynfield offset stays -1 when the NIC cannot
+  // schedule wire times, in which case pacing falls back to a busy-wait
+  int tx_ts_dynfield_offset_ = -1;
+  uint64_t tx_ts_dynflag_ = 0;
+  uint64_t tx_pace_interval_dev_ = 0;
+  std::vector<uint64_t> next_tx_dev_ts_;
+  uint64_t dev_clock_hz_ = 0;
+  uint64_t dev_clock_anchor_ = 0;
+  uint64_t tsc_anchor_ = 0;
+  double dev_per_tsc_ = 0.0;
+  // One entry per RX/TX queue. Private pools with dpdk_rss, otherwise all
+  // entries alias mbuf_pool_
+  std::vector<struct rte_mempool*> mbuf_pools_;
+  // Per-thread prebuilt Ethernet+IPv4+UDP header image for downlink TX.
+  // Destination, ports, and packet length are fixed per thread for the
+  // whole run, so DequeueSend stamps headers with one copy instead of
+  // field-by-field assembly (built in StartTxRx)
+  std::vector<std::array<uint8_t, kInetHdrsTotSize>> tx_hdr_templates_;
 
   // Dimension 1: socket_thread
   // Dimension 2: rx_packet
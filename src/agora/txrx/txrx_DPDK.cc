@@ -20,8 +20,6 @@ PacketTXRX::PacketTXRX(Config* cfg, size_t core_offset)
       rte_socket_id());
   RtAssert(cfg_->DpdkNumPorts() <= rte_eth_dev_count_avail(),
            "Invalid number of DPDK ports");
-  mbuf_pool_ = DpdkTransport::CreateMempool(cfg->DpdkNumPorts());
-
   int ret = inet_pton(AF_INET, cfg_->BsRruAddr().c_str(), &bs_rru_addr_);
   RtAssert(ret == 1, "Invalid sender IP address");
   ret = inet_pton(AF_INET, cfg_->BsServerAddr().c_str(), &bs_server_addr_);
@@ -36,27 +34,98 @@ PacketTXRX::PacketTXRX(Config* cfg, size_t core_offset)
     }
   }
 
+  if (cfg_->DpdkRss()) {
+    // One private mempool per RX queue so queues never contend on mbuf
+    // allocation, placed on the NUMA node of the port the queue belongs
+    // to. The copy path frees mbufs right after FastMemcpy, so each pool
+    // only needs to cover its descriptor ring plus the slice of the
+    // packet buffer budget its queue can hold in flight
+    const size_t packet_num_in_buffer =
+        cfg->FrameWnd() * cfg->Frame().NumTotalSyms() * cfg->BsAntNum();
+    const size_t mbufs_per_queue =
+        std::max((2 * kRxRingSize) + (packet_num_in_buffer / socket_thread_num_),
+                 kNumMBufs / socket_thread_num_);
+    mbuf_pool_ = nullptr;
+    for (size_t i = 0; i < socket_thread_num_; i++) {
+      char pool_name[RTE_MEMPOOL_NAMESIZE];
+      snprintf(pool_name, sizeof(pool_name), "MBUF_POOL_Q%zu", i);
+      const int port_socket = rte_eth_dev_socket_id(
+          port_ids_.at(i % cfg_->DpdkNumPorts()));
+      mbuf_pools_.push_back(
+          DpdkTransport::CreateMempool(cfg->DpdkNumPorts(), kJumboFrameMaxSize,
+                                       mbufs_per_queue, pool_name,
+                                       port_socket));
+    }
+  } else {
+    mbuf_pool_ = DpdkTransport::CreateMempool(
+        cfg->DpdkNumPorts(), kJumboFrameMaxSize, kNumMBufs, "MBUF_POOL",
+        rte_eth_dev_socket_id(port_ids_.at(0)));
+    mbuf_pools_.assign(socket_thread_num_, mbuf_pool_);
+  }
+
   for (size_t i = 0; i < cfg_->DpdkNumPorts(); i++) {
-    if (DpdkTransport::NicInit(port_ids_.at(i), mbuf_pool_,
-                               socket_thread_num_) != 0) {
+    if (DpdkTransport::NicInit(port_ids_.at(i), mbuf_pools_,
+                               socket_thread_num_, cfg_->DpdkRss(),
+                               kJumboFrameMaxSize, cfg_->TxPacing()) != 0) {
       rte_exit(EXIT_FAILURE, "Cannot init port %u\n", port_ids_.at(i));
     }
   }
 
-  for (size_t i = 0; i < socket_thread_num_; i++) {
-    uint16_t src_port = rte_cpu_to_be_16(cfg_->BsRruPort() + i);
-    uint16_t dst_port = rte_cpu_to_be_16(cfg_->BsServerPort() + i);
+#if defined(RTE_MBUF_DYNFLAG_TX_TIMESTAMP_NAME)
+  if (cfg_->TxPacing()) {
+    struct rte_eth_dev_info dev_info;
+    rte_eth_dev_info_get(port_ids_.at(0), &dev_info);
+    if ((dev_info.tx_offload_capa & DEV_TX_OFFLOAD_SEND_ON_TIMESTAMP) != 0) {
+      if (rte_mbuf_dyn_tx_timestamp_register(&tx_ts_dynfield_offset_,
+                                             &tx_ts_dynflag_) != 0) {
+        tx_ts_dynfield_offset_ = -1;
+      }
+    }
+    if (tx_ts_dynfield_offset_ >= 0) {
+      // Calibrate the device clock against the TSC once, so the datapath
+      // can compute wire times without reading the device clock per packet
+      uint64_t dev_t0 = 0;
+      uint64_t dev_t1 = 0;
+      rte_eth_read_clock(port_ids_.at(0), &dev_t0);
+      const uint64_t tsc_t0 = rte_get_tsc_cycles();
+      rte_delay_us_block(100000 /* 100 ms */);
+      rte_eth_read_clock(port_ids_.at(0), &dev_t1);
+      const uint64_t tsc_t1 = rte_get_tsc_cycles();
+      dev_clock_hz_ = (dev_t1 - dev_t0) * 10;
+      dev_clock_anchor_ = dev_t1;
+      tsc_anchor_ = tsc_t1;
+      dev_per_tsc_ = static_cast<double>(dev_t1 - dev_t0) /
+                     static_cast<double>(tsc_t1 - tsc_t0);
+      std::printf(
+          "TX pacing: send-on-timestamp offload, device clock %.1f MHz\n",
+          dev_clock_hz_ / 1e6);
+    } else {
+      std::printf("TX pacing: NIC lacks send-on-timestamp, using busy-wait\n");
+    }
+  }
+#endif  // defined(RTE_MBUF_DYNFLAG_TX_TIMESTAMP_NAME)
 
-    size_t port_id = port_ids_.at(i % this->cfg_->DpdkNumPorts());
-    size_t q_id = i / this->cfg_->DpdkNumPorts();
-    std::printf(
-        "Adding steering rule for src IP %s, dest IP %s, src port: %zu, "
-        "dst port: %zu, DPDK port %zu, queue: %zu\n",
-        this->cfg_->BsRruAddr().c_str(), this->cfg_->BsServerAddr().c_str(),
-        this->cfg_->BsRruPort() + i, this->cfg_->BsServerPort() + i, port_id,
-        q_id);
-    DpdkTransport::InstallFlowRule(port_id, q_id, bs_rru_addr_, bs_server_addr_,
-                                   src_port, dst_port);
+  if (cfg_->DpdkRss()) {
+    // The NIC spreads flows across the queue set by hashing source and
+    // destination ports, so no exact-match steering rules are needed
+    std::printf("Using symmetric RSS across %zu queues per DPDK port\n",
+                socket_thread_num_ / cfg_->DpdkNumPorts());
+  } else {
+    for (size_t i = 0; i < socket_thread_num_; i++) {
+      uint16_t src_port = rte_cpu_to_be_16(cfg_->BsRruPort() + i);
+      uint16_t dst_port = rte_cpu_to_be_16(cfg_->BsServerPort() + i);
+
+      size_t port_id = port_ids_.at(i % this->cfg_->DpdkNumPorts());
+      size_t q_id = i / this->cfg_->DpdkNumPorts();
+      std::printf(
+          "Adding steering rule for src IP %s, dest IP %s, src port: %zu, "
+          "dst port: %zu, DPDK port %zu, queue: %zu\n",
+          this->cfg_->BsRruAddr().c_str(), this->cfg_->BsServerAddr().c_str(),
+          this->cfg_->BsRruPort() + i, this->cfg_->BsServerPort() + i, port_id,
+          q_id);
+      DpdkTransport::InstallFlowRule(port_id, q_id, bs_rru_addr_,
+                                     bs_server_addr_, src_port, dst_port);
+    }
   }
 
   std::printf("Number of DPDK cores: %d\n", rte_lcore_count());
@@ -74,7 +143,15 @@ PacketTXRX::PacketTXRX(Config* cfg, size_t core_offset,
   tx_ptoks_ = tx_ptoks;
 }
 
-PacketTXRX::~PacketTXRX() { rte_mempool_free(mbuf_pool_); }
+PacketTXRX::~PacketTXRX() {
+  if (mbuf_pool_ != nullptr) {
+    rte_mempool_free(mbuf_pool_);
+  } else {
+    for (auto* pool : mbuf_pools_) {
+      rte_mempool_free(pool);
+    }
+  }
+}
 
 bool PacketTXRX::StartTxRx(Table<char>& buffer, size_t packet_num_in_buffer,
                            Table<size_t>& frame_start, char* tx_buffer,
@@ -87,11 +164,53 @@ bool PacketTXRX::StartTxRx(Table<char>& buffer, size_t packet_num_in_buffer,
   buffers_per_socket_ = packet_num_in_buffer / socket_thread_num_;
   tx_buffer_ = tx_buffer;
 
+  tx_pace_interval_tsc_.assign(socket_thread_num_, 0);
+  next_tx_tsc_.assign(socket_thread_num_, 0);
+  next_tx_dev_ts_.assign(socket_thread_num_, 0);
+  if (cfg_->TxPacing()) {
+    // Wire-time budget per packet: spread one thread's share of a
+    // downlink symbol evenly across the symbol duration
+    const size_t ants_per_thread = std::max(
+        static_cast<size_t>(1), cfg_->BsAntNum() / socket_thread_num_);
+    const double symbol_packets =
+        static_cast<double>(cfg_->Frame().NumTotalSyms() * ants_per_thread);
+    tx_pace_interval_tsc_.assign(
+        socket_thread_num_,
+        static_cast<size_t>((cfg_->GetFrameDurationSec() * rte_get_tsc_hz()) /
+                            symbol_packets));
+    if (dev_clock_hz_ != 0) {
+      tx_pace_interval_dev_ = static_cast<uint64_t>(
+          (cfg_->GetFrameDurationSec() * dev_clock_hz_) / symbol_packets);
+    }
+  }
+
+  // Prebuild each TX thread's header image once. The destination, the
+  // per-thread port pair, and the downlink packet length never change, so
+  // even the length fields and the UDP pseudo-header checksum are baked
+  // in. The RRU side runs promiscuous, so a broadcast destination MAC
+  // reaches it without MAC discovery
+  tx_hdr_templates_.resize(socket_thread_num_);
+  for (size_t i = 0; i < socket_thread_num_; i++) {
+    rte_ether_addr src_mac;
+    rte_eth_macaddr_get(port_ids_.at(i % cfg_->DpdkNumPorts()), &src_mac);
+    rte_ether_addr dst_mac;
+    std::memset(dst_mac.addr_bytes, 0xff, RTE_ETHER_ADDR_LEN);
+    DpdkTransport::FillUdpHeaderTemplate(
+        tx_hdr_templates_.at(i).data(), src_mac, dst_mac, bs_server_addr_,
+        bs_rru_addr_, cfg_->BsServerPort() + i, cfg_->BsRruPort() + i,
+        cfg_->DlPacketLength());
+  }
+
   rx_packets_.resize(socket_thread_num_);
   for (size_t i = 0; i < socket_thread_num_; i++) {
     rx_packets_.at(i).reserve(buffers_per_socket_);
 #if defined(USE_DPDK_MEMORY)
     unused(buffer);
+    // Mbufs back the RX ring until the FFT worker frees them, so the pool
+    // must be able to hold every in-flight packet
+    RtAssert(packet_num_in_buffer <=
+                 (kNumMBufs * static_cast<size_t>(cfg_->DpdkNumPorts())),
+             "DPDK mempool too small for zero-copy RX");
     rx_packets_.at(i).resize(buffers_per_socket_);
 #else
     for (size_t number_packets = 0; number_packets < buffers_per_socket_;
@@ -104,23 +223,39 @@ bool PacketTXRX::StartTxRx(Table<char>& buffer, size_t packet_num_in_buffer,
   }
 
   unsigned int lcore_id;
-  size_t worker_id = 0;
-  // Launch specific task to cores
   // For dpdk version >= 20.11.1 use RTE_LCORE_FOREACH_WORKER
-  RTE_LCORE_FOREACH_SLAVE(lcore_id) {
-    // launch communication and task thread onto specific core
-    if (worker_id < socket_thread_num_) {
-      auto context = new EventHandlerContext<PacketTXRX>;
-      context->obj_ptr_ = this;
-      context->id_ = worker_id;
-      rte_eal_remote_launch(
-          (lcore_function_t*)
-              PthreadFunWrapper<PacketTXRX, &PacketTXRX::LoopTxRx>,
-          context, lcore_id);
-      std::printf("DPDK TXRX thread %zu: pinned to core %d\n", worker_id,
-                  lcore_id);
+  std::vector<unsigned int> free_lcores;
+  RTE_LCORE_FOREACH_SLAVE(lcore_id) { free_lcores.push_back(lcore_id); }
+
+  // Launch each worker on an lcore from the NUMA node of the port it
+  // polls when one is free, so descriptor rings and mbufs stay
+  // node-local on multi-port machines; otherwise take any free lcore
+  for (size_t worker_id = 0; worker_id < socket_thread_num_; worker_id++) {
+    if (free_lcores.empty()) {
+      break;
     }
-    worker_id++;
+    const int port_socket = rte_eth_dev_socket_id(
+        port_ids_.at(worker_id % cfg_->DpdkNumPorts()));
+    size_t chosen = 0;
+    for (size_t i = 0; i < free_lcores.size(); i++) {
+      if (static_cast<int>(rte_lcore_to_socket_id(free_lcores.at(i))) ==
+          port_socket) {
+        chosen = i;
+        break;
+      }
+    }
+    const unsigned int launch_lcore = free_lcores.at(chosen);
+    free_lcores.erase(free_lcores.begin() + chosen);
+
+    auto context = new EventHandlerContext<PacketTXRX>;
+    context->obj_ptr_ = this;
+    context->id_ = worker_id;
+    rte_eal_remote_launch(
+        (lcore_function_t*)
+            PthreadFunWrapper<PacketTXRX, &PacketTXRX::LoopTxRx>,
+        context, launch_lcore);
+    std::printf("DPDK TXRX thread %zu: pinned to core %d (socket %d)\n",
+                worker_id, launch_lcore, port_socket);
   }
   return true;
 }
@@ -200,6 +335,12 @@ uint16_t PacketTXRX::DpdkRecv(int tid, uint16_t port_id, uint16_t queue_id,
 
     auto* payload = reinterpret_cast<uint8_t*>(eth_hdr) + kPayloadOffset;
 #if defined(USE_DPDK_MEMORY)
+    // The SIMD short->float converters DoFFT runs on pkt->data_ use
+    // aligned loads, so the in-place payload must sit on the same 64-byte
+    // alignment the copy path guarantees
+    assert((reinterpret_cast<size_t>(payload) % 64) == 0);
+    // Warm the header lines the master thread inspects first
+    rte_prefetch0(payload);
     rx.Set(dpdk_pkt, reinterpret_cast<Packet*>(payload));
 #else
     DpdkTransport::FastMemcpy(reinterpret_cast<uint8_t*>(rx.RawPacket()),
@@ -256,34 +397,66 @@ size_t PacketTXRX::DequeueSend(int tid) {
         offset, message_queue_->size_approx());
   }
 
-  char* cur_buffer_ptr = tx_buffer_ + offset * this->cfg_->DlPacketLength();
-  auto* pkt = (Packet*)cur_buffer_ptr;
-  new (pkt) Packet(frame_id, symbol_id, 0 /* cell_id */, ant_id);
-
   struct rte_mbuf* tx_bufs[kTxBatchSize] __attribute__((aligned(64)));
-  tx_bufs[0] = rte_pktmbuf_alloc(mbuf_pool_);
-  struct rte_ether_hdr* eth_hdr =
-      rte_pktmbuf_mtod(tx_bufs[0], struct rte_ether_hdr*);
-  eth_hdr->ether_type = rte_be_to_cpu_16(RTE_ETHER_TYPE_IPV4);
-
-  struct rte_ipv4_hdr* ip_h =
-      (struct rte_ipv4_hdr*)((char*)eth_hdr + sizeof(struct rte_ether_hdr));
-  ip_h->src_addr = bs_server_addr_;
-  ip_h->dst_addr = bs_rru_addr_;
-  ip_h->next_proto_id = IPPROTO_UDP;
-
-  struct rte_udp_hdr* udp_h =
-      (struct rte_udp_hdr*)((char*)ip_h + sizeof(struct rte_ipv4_hdr));
-  udp_h->src_port = rte_cpu_to_be_16(this->cfg_->BsServerPort() + tid);
-  udp_h->dst_port = rte_cpu_to_be_16(this->cfg_->BsRruPort() + tid);
-
-  tx_bufs[0]->pkt_len = this->cfg_->DlPacketLength() + kPayloadOffset;
-  tx_bufs[0]->data_len = this->cfg_->DlPacketLength() + kPayloadOffset;
-  char* payload = (char*)eth_hdr + kPayloadOffset;
-  DpdkTransport::FastMemcpy(payload, (char*)pkt, this->cfg_->DlPacketLength());
-
-  // Send data (one OFDM symbol)
-  size_t nb_tx_new = rte_eth_tx_burst(0, tid, tx_bufs, 1);
+  // Allocate from this thread's queue pool so TX never contends with the
+  // other queues (all entries alias the shared pool when RSS is off),
+  // then stamp the wire headers from this thread's prebuilt image; the
+  // NIC fills both checksums
+  tx_bufs[0] = DpdkTransport::AllocUdpFromTemplate(
+      mbuf_pools_.at(tid / cfg_->DpdkNumPorts()),
+      tx_hdr_templates_.at(tid).data(), this->cfg_->DlPacketLength());
+  // Scatter-gather assembly: the Packet header is built in place in the
+  // mbuf and only the samples are copied from the (payload-only) DL
+  // socket buffer, so no staged wire-format packet exists in host memory
+  char* payload = rte_pktmbuf_mtod(tx_bufs[0], char*) + kPayloadOffset;
+  new (payload) Packet(frame_id, symbol_id, 0 /* cell_id */, ant_id);
+  DpdkTransport::FastMemcpy(
+      payload + Packet::kOffsetOfData,
+      tx_buffer_ + (offset * this->cfg_->DlPayloadLength()),
+      this->cfg_->DlPayloadLength());
+
+  if (tx_pace_interval_tsc_.at(tid) != 0) {
+#if defined(RTE_MBUF_DYNFLAG_TX_TIMESTAMP_NAME)
+    if (tx_ts_dynfield_offset_ >= 0) {
+      // Stamp the wire time and let the NIC hold the packet until then;
+      // the device clock is derived from the TSC via the startup
+      // calibration instead of a per-packet PCIe read
+      const uint64_t now_dev =
+          dev_clock_anchor_ +
+          static_cast<uint64_t>(
+              (GetTime::Rdtsc() - tsc_anchor_) * dev_per_tsc_);
+      uint64_t& next_ts = next_tx_dev_ts_.at(tid);
+      if (now_dev >= next_ts) {
+        // Fell behind (or first send): restart the schedule from now
+        next_ts = now_dev;
+      }
+      *RTE_MBUF_DYNFIELD(tx_bufs[0], tx_ts_dynfield_offset_, uint64_t*) =
+          next_ts;
+      tx_bufs[0]->ol_flags |= tx_ts_dynflag_;
+      next_ts += tx_pace_interval_dev_;
+    } else
+#endif  // defined(RTE_MBUF_DYNFLAG_TX_TIMESTAMP_NAME)
+    {
+      // Calibrated busy-wait until this packet's wire time
+      size_t& deadline = next_tx_tsc_.at(tid);
+      const size_t now = GetTime::Rdtsc();
+      if (now >= deadline) {
+        deadline = now + tx_pace_interval_tsc_.at(tid);
+      } else {
+        while (GetTime::Rdtsc() < deadline) {
+          rte_pause();
+        }
+        deadline += tx_pace_interval_tsc_.at(tid);
+      }
+    }
+  }
+
+  // Send data (one OFDM symbol) through this thread's port and queue;
+  // TX uses the same port interleaving as RX so multi-port setups spread
+  // the downlink across all NICs
+  const uint16_t tx_port_id = port_ids_.at(tid % cfg_->DpdkNumPorts());
+  const uint16_t tx_queue_id = tid / cfg_->DpdkNumPorts();
+  size_t nb_tx_new = rte_eth_tx_burst(tx_port_id, tx_queue_id, tx_bufs, 1);
   if (unlikely(nb_tx_new != 1)) {
     std::printf("rte_eth_tx_burst() failed\n");
     throw std::runtime_error("PacketTXRX: rte_eth_tx_burst() failed");
@@ -8,6 +8,12 @@
 
 static constexpr bool kDebugDownlink = false;
 
+// Frames between per-radio drift rate reports
+static constexpr size_t kDriftReportFrames = 1000;
+
+// Complex samples summed per received symbol for the AGC RSSI tap
+static constexpr size_t kAgcRssiSamps = 64;
+
 void PacketTXRX::LoopTxRxArgos(size_t tid) {
   PinToCoreWithOffset(ThreadType::kWorkerTXRX, core_offset_, tid);
 
@@ -116,6 +122,13 @@ void PacketTXRX::LoopTxRxArgos(size_t tid) {
     std::cout << "Start BS main recv loop..." << std::endl;
   }
 
+  // Publish the time base for the beacon TX thread (first thread to get
+  // here wins; in HW framer mode time0 stays 0)
+  if (argos_time0_set_.load() == false) {
+    argos_time0_.store(time0);
+    argos_time0_set_.store(true);
+  }
+
   if (radio_lo > radio_hi) {
     MLPD_INFO("LoopTxRxArgos[%zu] has no radios, exiting\n", tid);
     return;
@@ -153,9 +166,8 @@ void PacketTXRX::LoopTxRxArgos(size_t tid) {
             global_symbol_id = 0;
             global_frame_id++;
             if (cfg_->Frame().NumDLSyms() == 0) {
-              for (size_t radio = radio_lo; radio <= radio_hi; radio++) {
-                this->TxBeaconHW(global_frame_id, radio, time0);
-              }
+              // The dedicated beacon thread transmits for all radios
+              this->PublishBeaconFrame(global_frame_id);
             }
           }
         }
@@ -167,6 +179,109 @@ void PacketTXRX::LoopTxRxArgos(size_t tid) {
   }    // cfg_->Running() == true
 }
 
+void PacketTXRX::TrackRxDrift(size_t radio_id, long long rx_time) {
+  const auto symbol_samps = static_cast<long long>(cfg_->SampsPerSymbol());
+  long long& expected = rx_next_expected_time_.at(radio_id);
+  if (expected < 0) {
+    // First read of this radio anchors the prediction chain
+    expected = rx_time + symbol_samps;
+    return;
+  }
+  const long long drift = rx_time - expected;
+  expected = rx_time + symbol_samps;
+  if (drift != 0) {
+    rx_drift_samples_.at(radio_id) += drift;
+    // Sub-symbol misalignment is what smears the cyclic prefix; absorb
+    // it with a short scratch read so the next read lands back on a
+    // symbol boundary
+    const long long misalign =
+        ((drift % symbol_samps) + symbol_samps) % symbol_samps;
+    if (misalign != 0) {
+      std::vector<std::complex<int16_t>> scratch0(cfg_->SampsPerSymbol());
+      std::vector<std::complex<int16_t>> scratch1(cfg_->SampsPerSymbol());
+      std::vector<void*> scratch(2);
+      scratch[0] = scratch0.data();
+      scratch[1] = scratch1.data();
+      const auto absorb = static_cast<size_t>(symbol_samps - misalign);
+      long long scratch_time = 0;
+      if (radioconfig_->RadioRx(radio_id, scratch.data(), absorb,
+                                scratch_time) > 0) {
+        expected += static_cast<long long>(absorb);
+        rx_drift_corrections_.at(radio_id)++;
+        MLPD_WARN(
+            "TrackRxDrift: radio %zu drifted %lld samples (total %lld); "
+            "absorbed %zu samples to realign the symbol boundary\n",
+            radio_id, drift, rx_drift_samples_.at(radio_id), absorb);
+      }
+    }
+  }
+
+  rx_drift_reads_.at(radio_id)++;
+  const size_t report_interval =
+      kDriftReportFrames * cfg_->Frame().NumTotalSyms();
+  if ((rx_drift_reads_.at(radio_id) % report_interval) == 0) {
+    const size_t frames_elapsed =
+        rx_drift_reads_.at(radio_id) / cfg_->Frame().NumTotalSyms();
+    MLPD_INFO(
+        "TrackRxDrift: radio %zu drift rate %.4f samples/frame "
+        "(%lld samples over %zu frames, %zu corrections)\n",
+        radio_id,
+        static_cast<double>(rx_drift_samples_.at(radio_id)) / frames_elapsed,
+        rx_drift_samples_.at(radio_id), frames_elapsed,
+        rx_drift_corrections_.at(radio_id));
+  }
+}
+
+void PacketTXRX::PublishBeaconFrame(size_t frame_id) {
+  auto frame = static_cast<ssize_t>(frame_id);
+  ssize_t current = beacon_tx_frame_.load();
+  while ((frame > current) &&
+         (beacon_tx_frame_.compare_exchange_weak(current, frame) == false)) {
+    // current was reloaded by the failed exchange
+  }
+}
+
+void PacketTXRX::LoopTxBeaconArgos(size_t tid) {
+  PinToCoreWithOffset(ThreadType::kWorkerTXRX, core_offset_, tid);
+  threads_started_.fetch_add(1);
+
+  // Wait for an RX thread to sync the hardware time base
+  while ((cfg_->Running() == true) && (argos_time0_set_.load() == false)) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  const long long time0 = argos_time0_.load();
+  const bool tx_beacons = (cfg_->HwFramer() == false);
+  const bool tx_cal_pilots = (cfg_->Frame().NumDLSyms() > 0) &&
+                             (cfg_->Frame().IsRecCalEnabled() == true);
+  MLPD_INFO("LoopTxBeaconArgos[%zu]: beacons %d, calibration pilots %d\n", tid,
+            tx_beacons, tx_cal_pilots);
+
+  ssize_t last_tx_frame = -1;
+  while (cfg_->Running() == true) {
+    const ssize_t due_frame = beacon_tx_frame_.load();
+    if (due_frame > last_tx_frame) {
+      // Beacons are timestamped TX_FRAME_DELTA frames ahead, so this
+      // thread only has to stay a frame ahead of the radios rather than
+      // keep symbol-level pace. Cover skipped frames so every beacon
+      // interval is served
+      for (ssize_t frame = last_tx_frame + 1; frame <= due_frame; frame++) {
+        for (size_t radio = 0; radio < cfg_->NumRadios(); radio++) {
+          if (tx_beacons == true) {
+            this->TxBeaconHW(static_cast<size_t>(frame), radio, time0);
+          }
+          if (tx_cal_pilots == true) {
+            this->TxReciprocityCalibPilots(static_cast<size_t>(frame), radio,
+                                           time0);
+          }
+        }
+      }
+      last_tx_frame = due_frame;
+    } else {
+      std::this_thread::yield();
+    }
+  }
+}
+
 std::vector<Packet*> PacketTXRX::RecvEnqueueArgos(size_t tid, size_t radio_id,
                                                   size_t rx_slot,
                                                   size_t global_frame_id,
@@ -214,7 +329,10 @@ std::vector<Packet*> PacketTXRX::RecvEnqueueArgos(size_t tid, size_t radio_id,
       samp_buffer[1] = samp_buffer1.data();
     }
     if (cfg_->Running() == true) {
-      radioconfig_->RadioRx(radio_id, samp_buffer.data(), frame_time);
+      if (radioconfig_->RadioRx(radio_id, samp_buffer.data(), frame_time) >
+          0) {
+        TrackRxDrift(radio_id, frame_time);
+      }
     }
     std::vector<Packet*> empty_pkt;
     return empty_pkt;
@@ -224,6 +342,21 @@ std::vector<Packet*> PacketTXRX::RecvEnqueueArgos(size_t tid, size_t radio_id,
       std::vector<Packet*> empty_pkt;
       return empty_pkt;
     }
+    if (cfg_->HwFramer() == false) {
+      // HW framer timestamps encode (frame, symbol) rather than ticks
+      TrackRxDrift(radio_id, frame_time);
+    }
+    if (cfg_->AgcEnabled() == true) {
+      // Cheap RSSI tap for the slow AGC loop: sum the energy of a short
+      // prefix of the channel-A samples
+      const auto* iq = reinterpret_cast<const int16_t*>(samp.at(0));
+      const size_t num_samps = std::min(kAgcRssiSamps, cfg_->SampsPerSymbol());
+      uint64_t energy = 0;
+      for (size_t s = 0; s < (2 * num_samps); s++) {
+        energy += static_cast<uint64_t>(static_cast<int64_t>(iq[s]) * iq[s]);
+      }
+      radioconfig_->UpdateRxRssi(radio_id, energy, num_samps);
+    }
     size_t frame_id = global_frame_id;
     size_t symbol_id = global_symbol_id;
 
@@ -406,14 +539,10 @@ size_t PacketTXRX::DequeueSendArgos(int tid, long long time0) {
 
     if (last_antenna) {
       if (symbol_id == cfg_->Frame().GetDLSymbol(0)) {
-        // Schedule beacon in the future
-        if (cfg_->HwFramer() == false) {
-          this->TxBeaconHW(frame_id, radio_id, time0);
-        }
-
-        if (cfg_->Frame().IsRecCalEnabled() == true) {
-          this->TxReciprocityCalibPilots(frame_id, radio_id, time0);
-        }
+        // Beacon and calibration pilot TX is offloaded to the dedicated
+        // beacon thread; schedule it for this frame (idempotent across
+        // radios and TX threads)
+        this->PublishBeaconFrame(frame_id);
       }
       std::vector<void*> txbuf(cfg_->NumChannels());
       if (kDebugDownlink == true) {
@@ -433,10 +562,9 @@ size_t PacketTXRX::DequeueSendArgos(int tid, long long time0) {
         }
       } else {
         for (size_t ch = 0; ch < cfg_->NumChannels(); ch++) {
-          char* cur_buffer_ptr =
-              tx_buffer_ + (offset + ch) * cfg_->DlPacketLength();
-          auto* pkt = reinterpret_cast<Packet*>(cur_buffer_ptr);
-          txbuf.at(ch) = reinterpret_cast<void*>(pkt->data_);
+          // Payload-only DL buffer: the samples start at the slot base
+          txbuf.at(ch) = reinterpret_cast<void*>(
+              tx_buffer_ + ((offset + ch) * cfg_->DlPayloadLength()));
         }
       }
 
@@ -0,0 +1,124 @@
+/**
+ * @file txrx_replay.cc
+ * @brief Replay datapath: feed a captured packet spool back through the
+ * full pipeline at original or accelerated timing.
+ */
+
+#include <cstring>
+
+#include "logger.h"
+#include "txrx.h"
+
+void PacketTXRX::LoopTxRxReplay(size_t tid) {
+  PinToCoreWithOffset(ThreadType::kWorkerTXRX, core_offset_, tid);
+
+  // TX sockets only: RX comes from the spool, but downlink packets still
+  // go out to the configured RRU address
+  size_t radios_per_thread = (cfg_->NumRadios() / socket_thread_num_);
+  if (cfg_->NumRadios() % socket_thread_num_ > 0) {
+    radios_per_thread++;
+  }
+  const size_t radio_lo = tid * radios_per_thread;
+  const size_t radio_hi =
+      std::min((radio_lo + radios_per_thread), cfg_->BsAntNum()) - 1;
+  for (size_t radio_id = radio_lo; radio_id <= radio_hi; ++radio_id) {
+    udp_clients_.at(radio_id) = std::make_unique<UDPClient>();
+  }
+
+  moodycamel::ProducerToken* local_ptok = rx_ptoks_[tid];
+  size_t* const rx_frame_start = (*frame_start_)[tid];
+  const bool epoch_reclaim = cfg_->RxEpochReclaim();
+  const size_t packet_length = cfg_->PacketLength();
+  const size_t num_records = spool_reader_->NumRecords();
+  const double speedup = cfg_->ReplaySpeedup();
+  const uint64_t first_ts = (num_records > 0) ? spool_reader_->RxTimeNs(0) : 0;
+
+  MLPD_INFO("LoopTxRxReplay[%zu]: replaying every %zuth of %zu records\n", tid,
+            socket_thread_num_, num_records);
+  threads_started_.fetch_add(1);
+
+  // Wait for the common pacing origin, published by StartTxRx() once
+  // every thread has started
+  long long epoch_ns = 0;
+  while ((epoch_ns = replay_epoch_ns_.load()) == 0) {
+    if (cfg_->Running() == false) {
+      return;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+
+  int prev_frame_id = -1;
+  size_t rx_slot = 0;
+  size_t records_fed = 0;
+  // Records interleave across threads round-robin, mirroring how the
+  // capture interleaved the RX threads' packets
+  for (size_t rec = tid; rec < num_records; rec += socket_thread_num_) {
+    if (cfg_->Running() == false) {
+      break;
+    }
+
+    // Pace against the captured offset from the first record, scaled by
+    // the speedup. Keep draining TX while waiting so downlink never
+    // backs up
+    const long long due_ns =
+        epoch_ns + static_cast<long long>(
+                       (spool_reader_->RxTimeNs(rec) - first_ts) / speedup);
+    while (static_cast<long long>(GetTime::GetTimeUs() * 1e3) < due_ns) {
+      DequeueSend(tid);
+      if (cfg_->Running() == false) {
+        return;
+      }
+    }
+
+    // Same slot-reclamation rules as the live RX path
+    RxPacket& rx = rx_packets_.at(tid).at(rx_slot);
+    bool slot_free;
+    if (epoch_reclaim == true) {
+      slot_free =
+          (rx.FrameEpoch() == SIZE_MAX) ||
+          (rx.FrameEpoch() <
+           rx_frame_watermark_->load(std::memory_order_acquire));
+    } else {
+      slot_free = rx.Empty();
+    }
+    if (slot_free == false) {
+      MLPD_ERROR("Replay thread %zu rx_buffer full, offset: %zu\n", tid,
+                 rx_slot);
+      cfg_->Running(false);
+      break;
+    }
+
+    Packet* pkt = rx.RawPacket();
+    std::memcpy(pkt, spool_reader_->PacketAt(rec), packet_length);
+    // Spools hold raw wire bytes, so reapply the multicell combine
+    pkt->ant_id_ += pkt->cell_id_ * ant_per_cell_;
+
+    if (kIsWorkerTimingEnabled) {
+      const int frame_id = pkt->frame_id_;
+      if (frame_id > prev_frame_id) {
+        rx_frame_start[frame_id % kNumStatsFrames] = GetTime::Rdtsc();
+        prev_frame_id = frame_id;
+      }
+    }
+
+    if (epoch_reclaim == true) {
+      rx.SetFrameEpoch(pkt->frame_id_);
+    } else {
+      rx.Use();
+    }
+    EventData rx_message(EventType::kPacketRX, rx_tag_t(rx).tag_);
+    if (message_queue_->enqueue(*local_ptok, rx_message) == false) {
+      MLPD_ERROR("replay message enqueue failed\n");
+      throw std::runtime_error("PacketTXRX: replay message enqueue failed");
+    }
+    rx_slot = (rx_slot + 1) % buffers_per_socket_;
+    records_fed++;
+  }
+
+  MLPD_INFO("LoopTxRxReplay[%zu]: spool exhausted after %zu records\n", tid,
+            records_fed);
+  // Keep servicing downlink TX until shutdown
+  while (cfg_->Running() == true) {
+    DequeueSend(tid);
+  }
+}
@@ -0,0 +1,377 @@
+/**
+ * @file txrx_uring.cc
+ * @brief Implementation of the io_uring datapath for PacketTXRX. Middle
+ * ground between the raw socket loop (txrx.cc) and DPDK (txrx_DPDK.cc):
+ * RX lands directly in the registered packet ring and, with SQPOLL, the
+ * steady-state datapath runs without per-packet syscalls, on stock
+ * kernels and without NIC binding.
+ */
+#if defined(USE_URING)
+
+#include <liburing.h>
+#include <netdb.h>
+
+#include <cstring>
+
+#include "logger.h"
+#include "txrx.h"
+
+static constexpr bool kEnableSlowStart = true;
+static constexpr bool kEnableSlowSending = false;
+
+static constexpr size_t kSlowStartMulStage1 = 32;
+static constexpr size_t kSlowStartMulStage2 = 8;
+
+// Queue depth of each per-thread ring (submission and completion entries)
+static constexpr unsigned int kUringQueueDepth = 256;
+// Registered-buffer reads kept armed per radio socket
+static constexpr size_t kUringRecvsPerRadio = 4;
+// Idle time in milliseconds before the kernel SQPOLL thread goes to sleep
+static constexpr unsigned int kUringSqPollIdleMs = 100;
+// TX sendmsg operations in flight per thread
+static constexpr size_t kUringTxDepth = 64;
+
+// Completion user_data layout: TX completions set the top bit and carry a
+// TX context index; RX completions carry (radio_id << 32) | rx_slot
+static constexpr uint64_t kUringTxFlag = (1ULL << 63U);
+
+namespace {
+/// Per-operation TX state. The msghdr, iovecs, and Packet header must
+/// stay valid until the kernel completes the sendmsg, so they live in a
+/// fixed pool rather than on the submitting function's stack. The wire
+/// packet is gathered from the header here plus the payload in the
+/// (payload-only) DL socket buffer.
+struct UringTxContext {
+  struct msghdr hdr;
+  struct iovec iov[2];
+  char pkt_hdr[Packet::kOffsetOfData];
+  size_t tag;
+};
+
+/// Resolve hostname:port once, AF_INET6 like the UDPClient cache
+struct addrinfo* UringResolveDest(const std::string& hostname, uint16_t port) {
+  char port_str[16u];
+  snprintf(port_str, sizeof(port_str), "%u", port);
+
+  struct addrinfo hints;
+  std::memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_INET6;
+  hints.ai_socktype = SOCK_DGRAM;
+  hints.ai_protocol = IPPROTO_UDP;
+
+  struct addrinfo* dest = nullptr;
+  int r = getaddrinfo(hostname.c_str(), port_str, &hints, &dest);
+  if ((r != 0) || (dest == nullptr)) {
+    throw std::runtime_error("LoopTxRxUring: Failed to resolve " + hostname +
+                             ":" + std::string(port_str) + ". " +
+                             gai_strerror(r));
+  }
+  return dest;
+}
+}  // namespace
+
+void PacketTXRX::LoopTxRxUring(size_t tid) {
+  PinToCoreWithOffset(ThreadType::kWorkerTXRX, core_offset_, tid);
+
+  const double rdtsc_freq = GetTime::MeasureRdtscFreq();
+  const size_t frame_tsc_delta =
+      cfg_->GetFrameDurationSec() * 1e9f * rdtsc_freq;
+  const size_t two_hundred_ms_ticks = (0.2f /* 200 ms */ * 1e9f * rdtsc_freq);
+
+  // Slow start variables (Start with no less than 200 ms)
+  const size_t slow_start_tsc1 =
+      std::max(kSlowStartMulStage1 * frame_tsc_delta, two_hundred_ms_ticks);
+
+  const size_t slow_start_thresh1 = cfg_->FrameWnd();
+  const size_t slow_start_tsc2 = kSlowStartMulStage2 * frame_tsc_delta;
+  const size_t slow_start_thresh2 = cfg_->FrameWnd() * 4;
+  size_t delay_tsc = frame_tsc_delta;
+
+  if (kEnableSlowStart) {
+    delay_tsc = slow_start_tsc1;
+  }
+
+  size_t* const rx_frame_start = (*frame_start_)[tid];
+  const size_t packet_length = cfg_->PacketLength();
+  size_t rx_slot = 0;
+  size_t radios_per_thread = (cfg_->NumRadios() / socket_thread_num_);
+  if (cfg_->NumRadios() % socket_thread_num_ > 0) {
+    radios_per_thread++;
+  }
+  const size_t radio_lo = tid * radios_per_thread;
+  const size_t radio_hi =
+      std::min((radio_lo + radios_per_thread), cfg_->BsAntNum()) - 1;
+  const size_t num_local_radios = (radio_hi - radio_lo) + 1;
+
+  static constexpr size_t kSockBufSize = (1024 * 1024 * 64 * 8) - 1;
+  const size_t sock_buf_size =
+      (cfg_->UdpRxBufferBytes() != 0) ? cfg_->UdpRxBufferBytes() : kSockBufSize;
+  for (size_t radio_id = radio_lo; radio_id <= radio_hi; ++radio_id) {
+    size_t local_port_id = cfg_->BsServerPort() + radio_id;
+
+    udp_servers_.at(radio_id) = std::make_unique<UDPServer>(
+        local_port_id, sock_buf_size, cfg_->UdpBusyPollUs());
+    udp_clients_.at(radio_id) = std::make_unique<UDPClient>();
+    MLPD_FRAME(
+        "TXRX thread %d: set up UDP socket server listening to port %d"
+        " with remote address %s:%d \n",
+        tid, local_port_id, cfg_->BsRruAddr().c_str(),
+        cfg_->BsRruPort() + radio_id);
+  }
+
+  // Unconnected TX socket for the io_uring sendmsg path; each operation
+  // carries its own per-antenna destination. Beacons still go through
+  // udp_clients_ (once per frame, not worth a ring slot).
+  int tx_fd = socket(AF_INET6, SOCK_DGRAM, IPPROTO_UDP);
+  if (tx_fd == -1) {
+    throw std::runtime_error("LoopTxRxUring: Failed to create TX socket");
+  }
+  std::vector<struct addrinfo*> tx_dests(cfg_->BsAntNum());
+  for (size_t ant_id = 0; ant_id < cfg_->BsAntNum(); ant_id++) {
+    tx_dests.at(ant_id) = UringResolveDest(
+        cfg_->BsRruAddr(), static_cast<uint16_t>(cfg_->BsRruPort() + ant_id));
+  }
+
+  // One ring per thread. SQPOLL needs privileges on older kernels; fall
+  // back to plain submission (still one submit syscall per burst, not
+  // per packet) if it is unavailable.
+  struct io_uring ring;
+  struct io_uring_params params;
+  std::memset(&params, 0, sizeof(params));
+  params.flags = IORING_SETUP_SQPOLL;
+  params.sq_thread_idle = kUringSqPollIdleMs;
+  int ret = io_uring_queue_init_params(kUringQueueDepth, &ring, &params);
+  if (ret < 0) {
+    MLPD_WARN(
+        "LoopTxRxUring[%zu]: SQPOLL unavailable (%s), using standard "
+        "submission\n",
+        tid, std::strerror(-ret));
+    std::memset(&params, 0, sizeof(params));
+    ret = io_uring_queue_init_params(kUringQueueDepth, &ring, &params);
+  }
+  if (ret < 0) {
+    throw std::runtime_error("LoopTxRxUring: io_uring_queue_init failed: " +
+                             std::string(std::strerror(-ret)));
+  }
+
+  // Register the sockets (mandatory for SQPOLL on older kernels) and the
+  // thread's slice of the RX packet ring, which is one contiguous region,
+  // so reads complete straight into the ring with no copy
+  std::vector<int> reg_fds(num_local_radios + 1);
+  for (size_t i = 0; i < num_local_radios; i++) {
+    reg_fds.at(i) = udp_servers_.at(radio_lo + i)->SockFd();
+  }
+  const int tx_fd_index = static_cast<int>(num_local_radios);
+  reg_fds.at(tx_fd_index) = tx_fd;
+  ret = io_uring_register_files(&ring, reg_fds.data(), reg_fds.size());
+  if (ret < 0) {
+    throw std::runtime_error("LoopTxRxUring: io_uring_register_files failed: " +
+                             std::string(std::strerror(-ret)));
+  }
+
+  struct iovec reg_iov;
+  reg_iov.iov_base = rx_packets_.at(tid).at(0).RawPacket();
+  reg_iov.iov_len = buffers_per_socket_ * packet_length;
+  ret = io_uring_register_buffers(&ring, &reg_iov, 1);
+  if (ret < 0) {
+    throw std::runtime_error(
+        "LoopTxRxUring: io_uring_register_buffers failed: " +
+        std::string(std::strerror(-ret)));
+  }
+
+  std::vector<UringTxContext> tx_ctx(kUringTxDepth);
+  std::vector<size_t> tx_ctx_free(kUringTxDepth);
+  std::iota(tx_ctx_free.begin(), tx_ctx_free.end(), 0);
+
+  // Reads not yet armed per radio; replenished from completions and
+  // drained whenever submission entries are available
+  std::vector<size_t> recv_deficit(num_local_radios, kUringRecvsPerRadio);
+
+  // Reserve the next empty RX ring slot and arm a registered-buffer read
+  // on radio [radio_id]. A read() on a bound UDP socket returns exactly
+  // one datagram, so IORING_OP_READ_FIXED gives registered-buffer RX.
+  auto arm_recv = [&](size_t radio_id) -> bool {
+    RxPacket& rx = rx_packets_.at(tid).at(rx_slot);
+    // if rx_buffer is full, exit
+    if (rx.Empty() == false) {
+      MLPD_ERROR("TXRX thread %zu rx_buffer full, offset: %zu\n", tid, rx_slot);
+      cfg_->Running(false);
+      return false;
+    }
+    struct io_uring_sqe* sqe = io_uring_get_sqe(&ring);
+    if (sqe == nullptr) {
+      return false;
+    }
+    io_uring_prep_read_fixed(sqe, static_cast<int>(radio_id - radio_lo),
+                             rx.RawPacket(), packet_length, 0, 0);
+    sqe->flags |= IOSQE_FIXED_FILE;
+    io_uring_sqe_set_data(
+        sqe, reinterpret_cast<void*>((radio_id << 32U) | rx_slot));
+    rx_slot = (rx_slot + 1) % buffers_per_socket_;
+    return true;
+  };
+
+  MLPD_INFO("LoopTxRxUring[%zu] has %zu:%zu total radios %zu\n", tid, radio_lo,
+            radio_hi, num_local_radios);
+  threads_started_.fetch_add(1);
+
+  const size_t max_dequeue_items =
+      (cfg_->BsAntNum() / cfg_->SocketThreadNum()) + 1;
+  std::vector<EventData> events(max_dequeue_items);
+
+  int prev_frame_id = -1;
+  size_t tx_frame_start = GetTime::Rdtsc();
+  size_t tx_frame_id = 0;
+  size_t send_time = delay_tsc + tx_frame_start;
+  while (cfg_->Running() == true) {
+    size_t rdtsc_now = GetTime::Rdtsc();
+
+    if (rdtsc_now > send_time) {
+      TxBeacon(tid, tx_frame_id++);
+
+      if (kEnableSlowStart) {
+        if (tx_frame_id == slow_start_thresh1) {
+          delay_tsc = slow_start_tsc2;
+        } else if (tx_frame_id == slow_start_thresh2) {
+          delay_tsc = frame_tsc_delta;
+          if (kEnableSlowSending) {
+            // Temp for historic reasons
+            delay_tsc = frame_tsc_delta * 4;
+          }
+        }
+      }
+      tx_frame_start = send_time;
+      send_time += delay_tsc;
+    }
+
+    // TX: pull at most as many events as there are free contexts; the
+    // remainder stays queued for the next iteration
+    const size_t tx_budget = std::min(max_dequeue_items, tx_ctx_free.size());
+    const size_t dequeued_items =
+        (tx_budget == 0)
+            ? 0
+            : task_queue_->try_dequeue_bulk_from_producer(
+                  *tx_ptoks_[tid], events.data(), tx_budget);
+    for (size_t item = 0; item < dequeued_items; item++) {
+      EventData& current_event = events.at(item);
+      assert(current_event.event_type_ == EventType::kPacketTX);
+
+      const size_t ant_id = gen_tag_t(current_event.tags_[0]).ant_id_;
+      const size_t frame_id = gen_tag_t(current_event.tags_[0]).frame_id_;
+      const size_t symbol_id = gen_tag_t(current_event.tags_[0]).symbol_id_;
+
+      const size_t data_symbol_idx_dl = cfg_->Frame().GetDLSymbolIdx(symbol_id);
+      const size_t offset =
+          (cfg_->GetTotalDataSymbolIdxDl(frame_id, data_symbol_idx_dl) *
+           cfg_->BsAntNum()) +
+          ant_id;
+
+      const size_t ctx_id = tx_ctx_free.back();
+      tx_ctx_free.pop_back();
+      UringTxContext& ctx = tx_ctx.at(ctx_id);
+      ctx.tag = current_event.tags_[0];
+      auto* pkt = reinterpret_cast<Packet*>(ctx.pkt_hdr);
+      new (pkt) Packet(frame_id, symbol_id, 0 /* cell_id */, ant_id);
+      ctx.iov[0].iov_base = ctx.pkt_hdr;
+      ctx.iov[0].iov_len = Packet::kOffsetOfData;
+      ctx.iov[1].iov_base = &tx_buffer_[offset * cfg_->DlPayloadLength()];
+      ctx.iov[1].iov_len = cfg_->DlPayloadLength();
+      std::memset(&ctx.hdr, 0, sizeof(ctx.hdr));
+      ctx.hdr.msg_name = tx_dests.at(ant_id)->ai_addr;
+      ctx.hdr.msg_namelen = tx_dests.at(ant_id)->ai_addrlen;
+      ctx.hdr.msg_iov = ctx.iov;
+      ctx.hdr.msg_iovlen = 2;
+
+      struct io_uring_sqe* sqe = io_uring_get_sqe(&ring);
+      RtAssert(sqe != nullptr,
+               "LoopTxRxUring: submission queue full with free TX contexts");
+      io_uring_prep_sendmsg(sqe, tx_fd_index, &ctx.hdr, 0);
+      sqe->flags |= IOSQE_FIXED_FILE;
+      io_uring_sqe_set_data(sqe,
+                            reinterpret_cast<void*>(kUringTxFlag | ctx_id));
+    }
+
+    // RX: top the armed reads back up to kUringRecvsPerRadio per radio
+    for (size_t i = 0; i < num_local_radios; i++) {
+      while ((recv_deficit.at(i) > 0) && arm_recv(radio_lo + i)) {
+        recv_deficit.at(i)--;
+      }
+    }
+
+    io_uring_submit(&ring);
+
+    // Reap everything that has completed, without blocking
+    struct io_uring_cqe* cqe = nullptr;
+    unsigned int head = 0;
+    unsigned int handled = 0;
+    io_uring_for_each_cqe(&ring, head, cqe) {
+      const auto user_data =
+          reinterpret_cast<uint64_t>(io_uring_cqe_get_data(cqe));
+      if ((user_data & kUringTxFlag) != 0) {
+        const size_t ctx_id = user_data & ~kUringTxFlag;
+        UringTxContext& ctx = tx_ctx.at(ctx_id);
+        if (cqe->res != static_cast<int>(cfg_->DlPacketLength())) {
+          MLPD_ERROR("LoopTxRxUring: sendmsg failed: %s\n",
+                     std::strerror(-cqe->res));
+          throw std::runtime_error("PacketTXRX: io_uring sendmsg failed");
+        }
+        RtAssert(message_queue_->enqueue(
+                     *rx_ptoks_[tid],
+                     EventData(EventType::kPacketTX, ctx.tag)),
+                 "Socket message enqueue failed\n");
+        tx_ctx_free.push_back(ctx_id);
+      } else {
+        const size_t radio_id = user_data >> 32U;
+        const size_t slot = user_data & 0xFFFFFFFFU;
+        recv_deficit.at(radio_id - radio_lo)++;
+        if (cqe->res < 0) {
+          MLPD_ERROR("LoopTxRxUring: read failed: %s\n",
+                     std::strerror(-cqe->res));
+          throw std::runtime_error("PacketTXRX: io_uring read failed");
+        }
+        if (static_cast<size_t>(cqe->res) != packet_length) {
+          MLPD_ERROR(
+              "LoopTxRxUring: read failed to receive all expected bytes");
+          throw std::runtime_error(
+              "PacketTXRX::LoopTxRxUring: read failed to receive all "
+              "expected bytes");
+        }
+        RxPacket& rx = rx_packets_.at(tid).at(slot);
+        Packet* pkt = rx.RawPacket();
+        if (kDebugPrintInTask) {
+          std::printf(
+              "In TXRX thread %zu: Received frame %d, symbol %d, ant %d\n",
+              tid, pkt->frame_id_, pkt->symbol_id_, pkt->ant_id_);
+        }
+        pkt->ant_id_ += pkt->cell_id_ * ant_per_cell_;
+
+        if (kIsWorkerTimingEnabled) {
+          const int frame_id = pkt->frame_id_;
+          if (frame_id > prev_frame_id) {
+            rx_frame_start[frame_id % kNumStatsFrames] = GetTime::Rdtsc();
+            prev_frame_id = frame_id;
+          }
+        }
+
+        // Push kPacketRX event into the queue.
+        rx.Use();
+        EventData rx_message(EventType::kPacketRX, rx_tag_t(rx).tag_);
+        if (message_queue_->enqueue(*rx_ptoks_[tid], rx_message) == false) {
+          MLPD_ERROR("socket message enqueue failed\n");
+          throw std::runtime_error(
+              "PacketTXRX: socket message enqueue failed");
+        }
+      }
+      handled++;
+    }
+    io_uring_cq_advance(&ring, handled);
+  }  // end while
+
+  io_uring_queue_exit(&ring);
+  for (auto* dest : tx_dests) {
+    freeaddrinfo(dest);
+  }
+  close(tx_fd);
+}
+
+#endif  // defined(USE_URING)
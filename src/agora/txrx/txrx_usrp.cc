@@ -4,10 +4,17 @@
  * with USRP hardware
  */
 
+#include <cstring>
+
 #include "txrx.h"
 
 static constexpr bool kDebugDownlink = false;
 
+// Symbols fetched per readStream call. UHD's per-call overhead is fixed, so
+// larger quanta raise the achievable aggregate sample rate; the cost is up
+// to this many symbols of added latency before a pilot reaches the FFT
+static constexpr size_t kUsrpRxSymbolBatch = 4;
+
 void PacketTXRX::LoopTxRxUsrp(size_t tid) {
   PinToCoreWithOffset(ThreadType::kWorkerTXRX, core_offset_, tid);
   size_t* rx_frame_start = (*frame_start_)[tid];
@@ -58,107 +65,109 @@ void PacketTXRX::LoopTxRxUsrp(size_t tid) {
   std::cout << "Init BS sync done..." << std::endl;
   std::cout << "Start BS main recv loop..." << std::endl;
 
+  // Per-channel staging for one multi-symbol readStream quantum. The
+  // stream delivers one deinterleaved buffer per channel, so the userspace
+  // split below is one aligned copy per (symbol, channel)
+  std::vector<std::vector<std::complex<int16_t>>> staging_storage(
+      cfg_->NumChannels(),
+      std::vector<std::complex<int16_t>>(
+          cfg_->SampsPerSymbol() * kUsrpRxSymbolBatch, 0));
+  std::vector<void*> staging(cfg_->NumChannels());
+  for (size_t ch = 0; ch < cfg_->NumChannels(); ch++) {
+    staging.at(ch) = staging_storage.at(ch).data();
+  }
+
   size_t global_frame_id = 0;
   size_t global_symbol_id = 0;
 
   int prev_frame_id = -1;
   size_t radio_id = radio_lo;
   while (cfg_->Running() == true) {
-    // transmit data
-    // if (-1 != dequeue_send_usrp(tid))
-    //   continue;
-    // receive data
-    struct Packet* pkt = RecvEnqueueUsrp(tid, radio_id, rx_slot,
-                                         global_frame_id, global_symbol_id);
-
-    // Schedule beacon in the future
-    if (global_symbol_id == 0) {
-      tx_time_bs_ = rx_time_bs_ +
-                    cfg_->SampsPerSymbol() * cfg_->Frame().NumTotalSyms() * 20;
-      int tx_ret = radioconfig_->RadioTx(0, beaconbuff.data(), 2, tx_time_bs_);
-      if (tx_ret != (int)cfg_->SampsPerSymbol()) {
-        std::cerr << "BAD Transmit(" << tx_ret << "/" << cfg_->SampsPerSymbol()
-                  << ") at Time " << tx_time_bs_ << ", frame count "
-                  << global_frame_id << std::endl;
-      }
-    }
+    // receive one multi-symbol quantum and split it into packets
+    const size_t num_rx_syms = RecvEnqueueBatchUsrp(
+        tid, radio_id, rx_slot, global_frame_id, global_symbol_id,
+        staging.data(), rx_frame_start, prev_frame_id);
 
     if (++radio_id == radio_hi) {
       radio_id = radio_lo;
     }
 
-    // Update global frame_id and symbol_id
-    global_symbol_id++;
-    if (global_symbol_id == cfg_->Frame().NumTotalSyms()) {
-      global_symbol_id = 0;
-      global_frame_id++;
+    if (num_rx_syms == 0) {
+      continue;
     }
 
-    if (pkt == nullptr) {
-      continue;
+    // Update global frame_id and symbol_id past the received quantum
+    const bool crossed_frame = (global_symbol_id + num_rx_syms) >=
+                               cfg_->Frame().NumTotalSyms();
+    global_symbol_id += num_rx_syms;
+    while (global_symbol_id >= cfg_->Frame().NumTotalSyms()) {
+      global_symbol_id -= cfg_->Frame().NumTotalSyms();
+      global_frame_id++;
     }
-    rx_slot = (rx_slot + cfg_->NumChannels()) % buffers_per_socket_;
 
-    if (kIsWorkerTimingEnabled) {
-      int frame_id = pkt->frame_id_;
-      if (frame_id > prev_frame_id) {
-        rx_frame_start[frame_id % kNumStatsFrames] = GetTime::Rdtsc();
-        prev_frame_id = frame_id;
+    // Schedule the next beacon once per frame boundary, far in the future
+    if (crossed_frame) {
+      tx_time_bs_ = rx_time_bs_ +
+                    cfg_->SampsPerSymbol() * cfg_->Frame().NumTotalSyms() * 20;
+      int tx_ret = radioconfig_->RadioTx(0, beaconbuff.data(), 2, tx_time_bs_);
+      if (tx_ret != (int)cfg_->SampsPerSymbol()) {
+        std::cerr << "BAD Transmit(" << tx_ret << "/" << cfg_->SampsPerSymbol()
+                  << ") at Time " << tx_time_bs_ << ", frame count "
+                  << global_frame_id << std::endl;
       }
     }
   }
 }
 
-struct Packet* PacketTXRX::RecvEnqueueUsrp(size_t tid, size_t radio_id,
-                                           size_t rx_slot, size_t frame_id,
-                                           size_t symbol_id) {
+size_t PacketTXRX::RecvEnqueueBatchUsrp(size_t tid, size_t radio_id,
+                                        size_t& rx_slot, size_t frame_id,
+                                        size_t symbol_id, void** staging,
+                                        size_t* rx_frame_start,
+                                        int& prev_frame_id) {
   moodycamel::ProducerToken* local_ptok = rx_ptoks_[tid];
-
-  // init samp_buffer for dummy read
-  std::vector<std::complex<int16_t>> samp_buffer0(
-      cfg_->SampsPerSymbol() * cfg_->Frame().NumTotalSyms(), 0);
-  std::vector<std::complex<int16_t>> samp_buffer1(
-      cfg_->SampsPerSymbol() * cfg_->Frame().NumTotalSyms(), 0);
-  std::vector<void*> samp_buffer(2);
-  samp_buffer[0] = samp_buffer0.data();
-  if (cfg_->NumChannels() == 2) {
-    samp_buffer[1] = samp_buffer1.data();
+  const size_t n_channels = cfg_->NumChannels();
+  const size_t samps = cfg_->SampsPerSymbol();
+  const size_t total_syms = cfg_->Frame().NumTotalSyms();
+
+  // One large read covering several symbols: UHD's per-call overhead is
+  // fixed, so the quantum size sets the achievable aggregate rate
+  const int ret = radioconfig_->RadioRx(radio_id, staging,
+                                        samps * kUsrpRxSymbolBatch,
+                                        rx_time_bs_);
+  if ((cfg_->Running() == false) || (ret <= 0)) {
+    return 0;
   }
-
-  size_t n_channels = cfg_->NumChannels();
-  std::vector<void*> samp(n_channels);
-  for (size_t ch = 0; ch < n_channels; ++ch) {
-    RxPacket& rx = rx_packets_.at(tid).at(rx_slot + ch);
-    // if rx_buffer is full, exit
-    if (rx.Empty() == false) {
-      std::printf("Receive thread %zu rx_buffer full, offset: %zu\n", tid,
-                  rx_slot);
-      cfg_->Running(false);
-      break;
-    }
-    samp.at(ch) = rx.RawPacket();
+  const size_t symbols_rxed = static_cast<size_t>(ret) / samps;
+  if ((static_cast<size_t>(ret) % samps) != 0) {
+    std::cerr << "RecvEnqueueBatchUsrp: radio " << radio_id << " returned "
+              << ret << " samples, not a whole number of symbols" << std::endl;
   }
 
-  int tmp_ret;
-  if (cfg_->IsPilot(frame_id, symbol_id) ||
-      cfg_->IsUplink(frame_id, symbol_id)) {
-    tmp_ret = radioconfig_->RadioRx(radio_id, samp.data(), rx_time_bs_);
-  } else {
-    tmp_ret = radioconfig_->RadioRx(radio_id, samp_buffer.data(), rx_time_bs_);
-  }
-
-  if ((cfg_->Running() == false) || tmp_ret <= 0 ||
-      (!cfg_->IsPilot(frame_id, symbol_id) &&
-       !cfg_->IsUplink(frame_id, symbol_id))) {
-    return nullptr;
-  }
+  for (size_t k = 0; k < symbols_rxed; k++) {
+    const size_t sym = (symbol_id + k) % total_syms;
+    const size_t frm = frame_id + ((symbol_id + k) / total_syms);
+    if ((cfg_->IsPilot(frm, sym) == false) &&
+        (cfg_->IsUplink(frm, sym) == false)) {
+      // Guard/downlink symbols carry nothing for the uplink chain; the
+      // samples stay in the staging buffer and are simply overwritten
+      continue;
+    }
 
-  size_t ant_id = radio_id * n_channels;
-  if (cfg_->IsPilot(frame_id, symbol_id) ||
-      cfg_->IsUplink(frame_id, symbol_id)) {
-    for (size_t ch = 0; ch < n_channels; ++ch) {
-      RxPacket& rx = rx_packets_.at(tid).at(rx_slot + ch);
-      new (rx.RawPacket()) Packet(frame_id, symbol_id, 0, ant_id + ch);
+    const size_t ant_id = radio_id * n_channels;
+    for (size_t ch = 0; ch < n_channels; ch++) {
+      RxPacket& rx = rx_packets_.at(tid).at(rx_slot);
+      // if rx_buffer is full, exit
+      if (rx.Empty() == false) {
+        std::printf("Receive thread %zu rx_buffer full, offset: %zu\n", tid,
+                    rx_slot);
+        cfg_->Running(false);
+        return 0;
+      }
+      auto* pkt = new (rx.RawPacket()) Packet(frm, sym, 0, ant_id + ch);
+      std::memcpy(
+          pkt->data_,
+          static_cast<std::complex<int16_t>*>(staging[ch]) + (k * samps),
+          samps * sizeof(std::complex<int16_t>));
       rx.Use();
       // Push kPacketRX event into the queue
       EventData rx_message(EventType::kPacketRX, rx_tag_t(rx).tag_);
@@ -167,9 +176,17 @@ struct Packet* PacketTXRX::RecvEnqueueUsrp(size_t tid, size_t radio_id,
         std::printf("socket message enqueue failed\n");
         throw std::runtime_error("PacketTXRX: socket message enqueue failed");
       }
+      rx_slot = (rx_slot + 1) % buffers_per_socket_;
+    }
+
+    if (kIsWorkerTimingEnabled) {
+      if (static_cast<int>(frm) > prev_frame_id) {
+        rx_frame_start[frm % kNumStatsFrames] = GetTime::Rdtsc();
+        prev_frame_id = static_cast<int>(frm);
+      }
     }
   }
-  return rx_packets_.at(tid).at(rx_slot).RawPacket();
+  return symbols_rxed;
 }
 
 int PacketTXRX::DequeueSendUsrp(int tid) {
@@ -210,9 +227,10 @@ int PacketTXRX::DequeueSendUsrp(int tid) {
           c->DlIqT()[dl_symbol_idx - c->Frame().ClientDlPilotSymbols()]);
     }
   } else {
-    char* cur_buffer_ptr = tx_buffer_ + offset * c->PacketLength();
-    auto* pkt = reinterpret_cast<struct Packet*>(cur_buffer_ptr);
-    txbuf[ch] = reinterpret_cast<void*>(pkt->data_);
+    // Payload-only DL buffer: the samples start at the slot base (this
+    // also fixes the stride, which wrongly used the UL packet length)
+    txbuf[ch] =
+        reinterpret_cast<void*>(tx_buffer_ + (offset * c->DlPayloadLength()));
   }
 
   size_t last = c->Frame().GetDLSymbolLast();
@@ -279,9 +297,10 @@ int PacketTXRX::DequeueSendUsrp(int tid, int frame_id, int symbol_id) {
           c->DlIqT()[dl_symbol_idx - c->Frame().ClientDlPilotSymbols()]);
     }
   } else {
-    char* cur_buffer_ptr = tx_buffer_ + offset * c->PacketLength();
-    auto* pkt = reinterpret_cast<struct Packet*>(cur_buffer_ptr);
-    txbuf[ch] = reinterpret_cast<void*>(pkt->data_);
+    // Payload-only DL buffer: the samples start at the slot base (this
+    // also fixes the stride, which wrongly used the UL packet length)
+    txbuf[ch] =
+        reinterpret_cast<void*>(tx_buffer_ + (offset * c->DlPayloadLength()));
   }
 
   size_t last = c->Frame().GetDLSymbolLast();
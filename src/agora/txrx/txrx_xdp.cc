@@ -0,0 +1,250 @@
+/**
+ * @file txrx_xdp.cc
+ * @brief Implementation of the AF_XDP datapath for PacketTXRX. Selected
+ * at runtime with the xdp_transport config flag (binary built with
+ * USE_AF_XDP): uplink RX bypasses the UDP stack through one XDP socket
+ * per thread, each bound to its own NIC queue, without taking the NIC
+ * away from the host the way DPDK does. TX (beacons and downlink) stays
+ * on the regular socket path, which is never the bottleneck.
+ */
+#if defined(USE_AF_XDP)
+
+#include <arpa/inet.h>
+#include <linux/if_ether.h>
+#include <linux/ip.h>
+#include <linux/udp.h>
+#include <sys/socket.h>
+#include <xdp/xsk.h>
+
+#include <cstring>
+
+#include "logger.h"
+#include "txrx.h"
+
+static constexpr bool kEnableSlowStart = true;
+static constexpr bool kEnableSlowSending = false;
+
+static constexpr size_t kSlowStartMulStage1 = 32;
+static constexpr size_t kSlowStartMulStage2 = 8;
+
+// UMEM geometry: each thread owns [kXdpNumFrames] frames of
+// [kXdpFrameSize] bytes, allocated with AllocBuffer1d like the other
+// large packet buffers
+static constexpr size_t kXdpFrameSize = 4096;
+static constexpr size_t kXdpNumFrames = 4096;
+// Descriptors consumed per RX poll
+static constexpr uint32_t kXdpBatchSize = 32;
+// Ethernet + IPv4 + UDP headers ahead of the Packet payload
+static constexpr size_t kXdpPayloadOffset =
+    sizeof(struct ethhdr) + sizeof(struct iphdr) + sizeof(struct udphdr);
+
+void PacketTXRX::LoopTxRxXdp(size_t tid) {
+  PinToCoreWithOffset(ThreadType::kWorkerTXRX, core_offset_, tid);
+
+  const double rdtsc_freq = GetTime::MeasureRdtscFreq();
+  const size_t frame_tsc_delta =
+      cfg_->GetFrameDurationSec() * 1e9f * rdtsc_freq;
+  const size_t two_hundred_ms_ticks = (0.2f /* 200 ms */ * 1e9f * rdtsc_freq);
+
+  // Slow start variables (Start with no less than 200 ms)
+  const size_t slow_start_tsc1 =
+      std::max(kSlowStartMulStage1 * frame_tsc_delta, two_hundred_ms_ticks);
+
+  const size_t slow_start_thresh1 = cfg_->FrameWnd();
+  const size_t slow_start_tsc2 = kSlowStartMulStage2 * frame_tsc_delta;
+  const size_t slow_start_thresh2 = cfg_->FrameWnd() * 4;
+  size_t delay_tsc = frame_tsc_delta;
+
+  if (kEnableSlowStart) {
+    delay_tsc = slow_start_tsc1;
+  }
+
+  size_t* const rx_frame_start = (*frame_start_)[tid];
+  const size_t packet_length = cfg_->PacketLength();
+  RtAssert((kXdpPayloadOffset + packet_length) <= kXdpFrameSize,
+           "LoopTxRxXdp: packet does not fit in one UMEM frame");
+
+  size_t rx_slot = 0;
+  size_t radios_per_thread = (cfg_->NumRadios() / socket_thread_num_);
+  if (cfg_->NumRadios() % socket_thread_num_ > 0) {
+    radios_per_thread++;
+  }
+  const size_t radio_lo = tid * radios_per_thread;
+  const size_t radio_hi =
+      std::min((radio_lo + radios_per_thread), cfg_->BsAntNum()) - 1;
+
+  // TX clients for beacons and DequeueSend; no UDP servers, RX bypasses
+  // the stack entirely
+  for (size_t radio_id = radio_lo; radio_id <= radio_hi; ++radio_id) {
+    udp_clients_.at(radio_id) = std::make_unique<UDPClient>();
+  }
+
+  // UMEM region, carved like the other packet buffers
+  char* umem_area = nullptr;
+  AllocBuffer1d(&umem_area, kXdpNumFrames * kXdpFrameSize,
+                Agora_memory::Alignment_t::kAlign4096, 0);
+
+  struct xsk_umem* umem = nullptr;
+  struct xsk_ring_prod fill_ring;
+  struct xsk_ring_cons comp_ring;
+  int ret = xsk_umem__create(&umem, umem_area, kXdpNumFrames * kXdpFrameSize,
+                             &fill_ring, &comp_ring, nullptr);
+  RtAssert(ret == 0, "LoopTxRxXdp: xsk_umem__create failed: " +
+                         std::string(std::strerror(-ret)));
+
+  // One XDP socket per thread, bound to NIC queue [tid]. The default
+  // libxdp program redirects everything on that queue here, so which
+  // radio lands on which thread follows the NIC's RSS spread (like the
+  // dpdk_rss mode) rather than the per-radio port layout
+  struct xsk_socket* xsk = nullptr;
+  struct xsk_ring_cons rx_ring;
+  struct xsk_socket_config xsk_cfg;
+  std::memset(&xsk_cfg, 0, sizeof(xsk_cfg));
+  xsk_cfg.rx_size = XSK_RING_CONS__DEFAULT_NUM_DESCS;
+  xsk_cfg.tx_size = XSK_RING_PROD__DEFAULT_NUM_DESCS;
+  ret = xsk_socket__create(&xsk, cfg_->XdpIf().c_str(), tid, umem, &rx_ring,
+                           nullptr, &xsk_cfg);
+  RtAssert(ret == 0, "LoopTxRxXdp: xsk_socket__create failed on " +
+                         cfg_->XdpIf() + " queue " + std::to_string(tid) +
+                         ": " + std::string(std::strerror(-ret)));
+
+  // All frames start out available to the kernel's fill ring
+  std::vector<uint64_t> free_frames;
+  free_frames.reserve(kXdpNumFrames);
+  for (size_t i = 0; i < kXdpNumFrames; i++) {
+    free_frames.push_back(i * kXdpFrameSize);
+  }
+  auto refill = [&]() {
+    // Reserve in batches: the fill ring is smaller than the frame pool,
+    // so leftover frames simply wait for the next refill
+    while (free_frames.empty() == false) {
+      const auto want = static_cast<uint32_t>(std::min(
+          free_frames.size(), static_cast<size_t>(kXdpBatchSize)));
+      uint32_t idx = 0;
+      if (xsk_ring_prod__reserve(&fill_ring, want, &idx) != want) {
+        break;
+      }
+      for (uint32_t i = 0; i < want; i++) {
+        *xsk_ring_prod__fill_addr(&fill_ring, idx + i) = free_frames.back();
+        free_frames.pop_back();
+      }
+      xsk_ring_prod__submit(&fill_ring, want);
+    }
+    if (xsk_ring_prod__needs_wakeup(&fill_ring)) {
+      recvfrom(xsk_socket__fd(xsk), nullptr, 0, MSG_DONTWAIT, nullptr,
+               nullptr);
+    }
+  };
+  refill();
+
+  MLPD_INFO("LoopTxRxXdp[%zu]: bound to %s queue %zu, %zu UMEM frames\n", tid,
+            cfg_->XdpIf().c_str(), tid, kXdpNumFrames);
+  threads_started_.fetch_add(1);
+
+  moodycamel::ProducerToken* local_ptok = rx_ptoks_[tid];
+  int prev_frame_id = -1;
+  size_t tx_frame_start = GetTime::Rdtsc();
+  size_t tx_frame_id = 0;
+  size_t send_time = delay_tsc + tx_frame_start;
+  while (cfg_->Running() == true) {
+    const size_t rdtsc_now = GetTime::Rdtsc();
+
+    if (rdtsc_now > send_time) {
+      TxBeacon(tid, tx_frame_id++);
+
+      if (kEnableSlowStart) {
+        if (tx_frame_id == slow_start_thresh1) {
+          delay_tsc = slow_start_tsc2;
+        } else if (tx_frame_id == slow_start_thresh2) {
+          delay_tsc = frame_tsc_delta;
+          if (kEnableSlowSending) {
+            // Temp for historic reasons
+            delay_tsc = frame_tsc_delta * 4;
+          }
+        }
+      }
+      tx_frame_start = send_time;
+      send_time += delay_tsc;
+    }
+
+    if (DequeueSend(tid) != 0) {
+      continue;
+    }
+
+    // RX: drain up to one batch of descriptors from the XDP ring
+    uint32_t idx_rx = 0;
+    const uint32_t num_rx = xsk_ring_cons__peek(&rx_ring, kXdpBatchSize,
+                                                &idx_rx);
+    if (num_rx == 0) {
+      refill();
+      continue;
+    }
+    for (uint32_t i = 0; i < num_rx; i++) {
+      const struct xdp_desc* desc = xsk_ring_cons__rx_desc(&rx_ring,
+                                                           idx_rx + i);
+      char* frame = umem_area + desc->addr;
+      bool valid = (desc->len >= (kXdpPayloadOffset + packet_length));
+      if (valid) {
+        const auto* ip_h =
+            reinterpret_cast<const struct iphdr*>(frame +
+                                                  sizeof(struct ethhdr));
+        const auto* udp_h = reinterpret_cast<const struct udphdr*>(
+            frame + sizeof(struct ethhdr) + sizeof(struct iphdr));
+        const uint16_t dst_port = ntohs(udp_h->dest);
+        valid = (ip_h->protocol == IPPROTO_UDP) &&
+                (dst_port >= cfg_->BsServerPort()) &&
+                (dst_port < (cfg_->BsServerPort() + cfg_->NumRadios()));
+      }
+      if (valid == false) {
+        // Stray traffic on the queue (the XDP program sees everything)
+        MLPD_FRAME("LoopTxRxXdp[%zu]: dropping stray frame of %u bytes\n",
+                   tid, desc->len);
+        free_frames.push_back(desc->addr);
+        continue;
+      }
+
+      RxPacket& rx = rx_packets_.at(tid).at(rx_slot);
+      if (rx.Empty() == false) {
+        MLPD_ERROR("LoopTxRxXdp[%zu]: rx_buffer full, slot: %zu\n", tid,
+                   rx_slot);
+        cfg_->Running(false);
+        break;
+      }
+      Packet* pkt = rx.RawPacket();
+      std::memcpy(pkt, frame + kXdpPayloadOffset, packet_length);
+      free_frames.push_back(desc->addr);
+
+      if (kDebugPrintInTask) {
+        std::printf(
+            "In TXRX thread %zu: Received frame %d, symbol %d, ant %d\n", tid,
+            pkt->frame_id_, pkt->symbol_id_, pkt->ant_id_);
+      }
+      if (kIsWorkerTimingEnabled) {
+        const int frame_id = pkt->frame_id_;
+        if (frame_id > prev_frame_id) {
+          rx_frame_start[frame_id % kNumStatsFrames] = GetTime::Rdtsc();
+          prev_frame_id = frame_id;
+        }
+      }
+      pkt->ant_id_ += pkt->cell_id_ * ant_per_cell_;
+
+      rx.Use();
+      if (message_queue_->enqueue(*local_ptok,
+                                  EventData(EventType::kPacketRX,
+                                            rx_tag_t(rx).tag_)) == false) {
+        std::printf("socket message enqueue failed\n");
+        throw std::runtime_error("PacketTXRX: socket message enqueue failed");
+      }
+      rx_slot = (rx_slot + 1) % buffers_per_socket_;
+    }
+    xsk_ring_cons__release(&rx_ring, num_rx);
+    refill();
+  }
+
+  xsk_socket__delete(xsk);
+  xsk_umem__delete(umem);
+  FreeBuffer1d(&umem_area);
+  MLPD_SYMBOL("LoopTxRxXdp[%zu] exit\n", tid);
+}
+
+#endif  // defined(USE_AF_XDP)
@@ -23,6 +23,7 @@ DoDecodeClient::DoDecodeClient(
       phy_stats_(in_phy_stats),
       scrambler_(std::make_unique<AgoraScrambler::Scrambler>()) {
   duration_stat_ = in_stats_manager->GetDurationStat(DoerType::kDecode, in_tid);
+  RegisterTaskStats(&duration_stat_, nullptr);
   resp_var_nodes_ = static_cast<int16_t*>(Agora_memory::PaddedAlignedAlloc(
       Agora_memory::Alignment_t::kAlign64, kVarNodesSize));
 }
@@ -40,7 +41,7 @@ EventData DoDecodeClient::Launch(size_t tag) {
       cfg_->GetTotalDataSymbolIdxDl(frame_id, symbol_idx_dl);
   const size_t cur_cb_id = (cb_id % cfg_->LdpcConfig().NumBlocksInSymbol());
   const size_t ue_id = (cb_id / cfg_->LdpcConfig().NumBlocksInSymbol());
-  const size_t frame_slot = (frame_id % kFrameWnd);
+  const size_t frame_slot = (frame_id % cfg_->FrameWnd());
 
   if (kDebugPrintInTask == true) {
     std::printf(
@@ -22,6 +22,7 @@ DoIFFTClient::DoIFFTClient(Config* in_config, int in_tid,
       ifft_buffer_(in_ifft_buffer),
       socket_buffer_(in_socket_buffer) {
   duration_stat_ = in_stats_manager->GetDurationStat(DoerType::kIFFT, in_tid);
+  RegisterTaskStats(&duration_stat_, nullptr);
   DftiCreateDescriptor(&mkl_handle_, DFTI_SINGLE, DFTI_COMPLEX, 1,
                        cfg_->OfdmCaNum());
   if (kUseOutOfPlaceIFFT) {
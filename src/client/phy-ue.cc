@@ -21,9 +21,11 @@ static const size_t kDefaultQueueSize = 36;
 PhyUe::PhyUe(Config* config)
     : stats_(std::make_unique<Stats>(config)),
       phy_stats_(std::make_unique<PhyStats>(config, Direction::kDownlink)),
-      demod_buffer_(kFrameWnd, config->Frame().NumDLSyms(), config->UeAntNum(),
-                    kMaxModType * config->OfdmDataNum()),
-      decoded_buffer_(kFrameWnd, config->Frame().NumDLSyms(),
+      demod_buffer_(config->FrameWnd(), config->Frame().NumDLSyms(),
+                    config->UeAntNum(),
+                    (kMaxModType * config->OfdmDataNum()) +
+                        kLdpcHelperFunctionInputBufferSizePaddingBytes),
+      decoded_buffer_(config->FrameWnd(), config->Frame().NumDLSyms(),
                       config->UeAntNum(),
                       config->LdpcConfig().NumBlocksInSymbol() *
                           Roundup<64>(config->NumBytesPerCb())) {
@@ -34,6 +36,12 @@ PhyUe::PhyUe(Config* config)
   this->config_ = config;
   InitializeVarsFromCfg();
 
+  // Must be armed before the workers start; they read it on every
+  // demul/decode task
+  for (auto& shed : shed_frame_) {
+    shed.store(SIZE_MAX, std::memory_order_relaxed);
+  }
+
   std::vector<size_t> data_sc_ind;
   for (size_t i = config_->OfdmDataStart();
        i < config_->OfdmDataStart() + config_->OfdmDataNum(); i++) {
@@ -55,15 +63,21 @@ PhyUe::PhyUe(Config* config)
   }
 
   complete_queue_ = moodycamel::ConcurrentQueue<EventData>(
-      kFrameWnd * config_->Frame().NumTotalSyms() * config_->UeAntNum() *
+      config_->FrameWnd() * config_->Frame().NumTotalSyms() *
+      config_->UeAntNum() *
       kDefaultQueueSize);
   work_queue_ = moodycamel::ConcurrentQueue<EventData>(
-      kFrameWnd * config_->Frame().NumTotalSyms() * config_->UeAntNum() *
+      config_->FrameWnd() * config_->Frame().NumTotalSyms() *
+      config_->UeAntNum() *
+      kDefaultQueueSize);
+  decode_queue_ = moodycamel::ConcurrentQueue<EventData>(
+      config_->FrameWnd() * config_->Frame().NumTotalSyms() *
+      config_->UeAntNum() *
       kDefaultQueueSize);
   tx_queue_ = moodycamel::ConcurrentQueue<EventData>(
-      kFrameWnd * config_->UeAntNum() * kDefaultQueueSize);
+      config_->FrameWnd() * config_->UeAntNum() * kDefaultQueueSize);
   to_mac_queue_ = moodycamel::ConcurrentQueue<EventData>(
-      kFrameWnd * config_->UeAntNum() * kDefaultQueueSize);
+      config_->FrameWnd() * config_->UeAntNum() * kDefaultQueueSize);
 
   for (size_t i = 0; i < rx_thread_num_; i++) {
     rx_ptoks_ptr_[i] = new moodycamel::ProducerToken(complete_queue_);
@@ -74,6 +88,10 @@ PhyUe::PhyUe(Config* config)
 
   work_producer_token_ =
       std::make_unique<moodycamel::ProducerToken>(work_queue_);
+  if (config_->UeDecodeThreadNum() > 0) {
+    decode_producer_token_ =
+        std::make_unique<moodycamel::ProducerToken>(decode_queue_);
+  }
 
   ru_ = std::make_unique<RadioTxRx>(
       config_, rx_thread_num_, config_->UeCoreOffset() + 1, &complete_queue_,
@@ -101,12 +119,28 @@ PhyUe::PhyUe(Config* config)
         *work_producer_token_.get(), ul_bits_buffer_, ul_syms_buffer_,
         modul_buffer_, ifft_buffer_, tx_buffer_, rx_buffer_, csi_buffer_,
         equal_buffer_, non_null_sc_ind_, fft_buffer_, demod_buffer_,
-        decoded_buffer_, ue_pilot_vec_);
+        decoded_buffer_, ue_pilot_vec_, shed_frame_);
 
     new_worker->Start(core_offset_worker);
     workers_.push_back(std::move(new_worker));
   }
 
+  // Dedicated decode pool (ue_decode_thread_num): these workers drain the
+  // decode-only queue, overlapping symbol N+1 front-end work on the shared
+  // pool with symbol N LDPC decode, like the basestation's WorkerDecode
+  for (size_t i = 0; i < config_->UeDecodeThreadNum(); i++) {
+    auto decode_worker = std::make_unique<UeWorker>(
+        config_->UeWorkerThreadNum() + i, *config_, *stats_, *phy_stats_,
+        complete_queue_, decode_queue_, *decode_producer_token_.get(),
+        ul_bits_buffer_, ul_syms_buffer_, modul_buffer_, ifft_buffer_,
+        tx_buffer_, rx_buffer_, csi_buffer_, equal_buffer_, non_null_sc_ind_,
+        fft_buffer_, demod_buffer_, decoded_buffer_, ue_pilot_vec_,
+        shed_frame_);
+
+    decode_worker->Start(core_offset_worker);
+    workers_.push_back(std::move(decode_worker));
+  }
+
   // initilize all kinds of checkers
   // Init the frame work tracking structure
   for (size_t frame = 0; frame < this->frame_tasks_.size(); frame++) {
@@ -133,6 +167,12 @@ PhyUe::PhyUe(Config* config)
     ue.tx_ready_frames_.clear();
   }
 
+  std::printf(
+      "PhyUe: hosting %zu UEs (%zu antennas) over %zu shared workers and "
+      "%zu dedicated decode workers\n",
+      config_->UeNum(), config_->UeAntNum(), config_->UeWorkerThreadNum(),
+      config_->UeDecodeThreadNum());
+
   // This usage doesn't effect the user num_reciprocity_pkts_per_frame_;
   rx_counters_.num_pkts_per_frame_ =
       config_->UeAntNum() *
@@ -140,16 +180,16 @@ PhyUe::PhyUe(Config* config)
   rx_counters_.num_pilot_pkts_per_frame_ =
       config_->UeAntNum() * config_->Frame().ClientDlPilotSymbols();
 
-  rx_downlink_deferral_.resize(kFrameWnd);
+  rx_downlink_deferral_.resize(config_->FrameWnd());
+  csi_slot_frame_.fill(SIZE_MAX);
 
   // Mac counters for downlink data
   tomac_counters_.Init(config_->Frame().NumDlDataSyms(), config_->UeAntNum());
 }
 
 PhyUe::~PhyUe() {
-  for (size_t i = 0; i < config_->UeWorkerThreadNum(); i++) {
-    std::printf("Joining Phy worker: %zu : %zu\n", i,
-                config_->UeWorkerThreadNum());
+  for (size_t i = 0; i < workers_.size(); i++) {
+    std::printf("Joining Phy worker: %zu : %zu\n", i, workers_.size());
     workers_.at(i)->Stop();
   }
   workers_.clear();
@@ -167,6 +207,11 @@ PhyUe::~PhyUe() {
 
   FreeUplinkBuffers();
   FreeDownlinkBuffers();
+
+  if (shed_frame_count_ > 0) {
+    std::printf("PhyUe: shed demul/decode work on %zu frames under overload\n",
+                shed_frame_count_);
+  }
 }
 
 void PhyUe::ScheduleTask(EventData do_task,
@@ -182,8 +227,21 @@ void PhyUe::ScheduleTask(EventData do_task,
 }
 
 void PhyUe::ScheduleWork(EventData do_task) {
-  if (work_queue_.try_enqueue(*(work_producer_token_.get()), do_task) ==
-      false) {
+  // Decode goes to the dedicated pool when one is configured; everything
+  // else (and decode without a pool) shares work_queue_
+  if ((do_task.event_type_ == EventType::kDecode) &&
+      (decode_producer_token_ != nullptr)) {
+    if (decode_queue_.try_enqueue(*(decode_producer_token_.get()), do_task) ==
+        false) {
+      std::printf("PhyUe: Cannot enqueue decode task, need more memory");
+      if (decode_queue_.enqueue(*(decode_producer_token_.get()), do_task) ==
+          false) {
+        std::printf("PhyUe: decode task enqueue failed\n");
+        throw std::runtime_error("PhyUe: decode task enqueue failed");
+      }
+    }
+  } else if (work_queue_.try_enqueue(*(work_producer_token_.get()), do_task) ==
+             false) {
     std::printf("PhyUe: Cannot enqueue work task, need more memory");
     if (work_queue_.enqueue(*(work_producer_token_.get()), do_task) == false) {
       std::printf("PhyUe: work task enqueue failed\n");
@@ -193,26 +251,42 @@ void PhyUe::ScheduleWork(EventData do_task) {
 }
 
 void PhyUe::ReceiveDownlinkSymbol(struct Packet* rx_packet, size_t tag) {
-  const size_t frame_slot = rx_packet->frame_id_ % kFrameWnd;
+  const size_t frame_id = rx_packet->frame_id_;
+  const size_t frame_slot = frame_id % config_->FrameWnd();
   const size_t dl_symbol_idx =
       config_->Frame().GetDLSymbolIdx(rx_packet->symbol_id_);
 
   // if symbol is a pilot or we are finished with all pilot ffts for the given
   // frame
   if (dl_symbol_idx < config_->Frame().ClientDlPilotSymbols()) {
+    if ((config_->UeStaleCsiFallback() == true) &&
+        (csi_slot_frame_.at(frame_slot) != frame_id)) {
+      // With the fallback, ClearCsi() leaves the previous estimate in
+      // place for reuse, so the slot must be zeroed here, before any of
+      // this frame's pilot ffts are scheduled
+      csi_slot_frame_.at(frame_slot) = frame_id;
+      ZeroCsiSlot(frame_slot);
+    }
     ScheduleWork(EventData(EventType::kFFTPilot, tag));
-  } else if (fft_dlpilot_counters_.IsLastSymbol(rx_packet->frame_id_)) {
+  } else if (fft_dlpilot_counters_.IsLastSymbol(frame_id)) {
     ScheduleWork(EventData(EventType::kFFT, tag));
+  } else if ((config_->UeStaleCsiFallback() == true) &&
+             (csi_fallback_ready_ == true) &&
+             (frame_id == (last_csi_frame_ + 1))) {
+    // The pilot ffts are late: equalize against the previous frame's CSI
+    // rather than hold the symbol back. tags_[1] tells the worker
+    EventData do_fft_task(EventType::kFFT, tag);
+    do_fft_task.num_tags_ = 2;
+    do_fft_task.tags_.at(1) = 1;
+    ScheduleWork(do_fft_task);
   } else {
-    std::queue<EventData>* defferal_queue =
-        &rx_downlink_deferral_.at(frame_slot);
-
-    defferal_queue->push(EventData(EventType::kFFT, tag));
+    rx_downlink_deferral_.at(frame_slot)
+        .push(DeferredEvent{dl_symbol_idx, EventData(EventType::kFFT, tag)});
   }
 }
 
 void PhyUe::ScheduleDefferedDownlinkSymbols(size_t frame_id) {
-  const size_t frame_slot = frame_id % kFrameWnd;
+  const size_t frame_slot = frame_id % config_->FrameWnd();
   // Complete the csi offset
   const size_t csi_offset_base = frame_slot * config_->UeAntNum();
 
@@ -227,34 +301,52 @@ void PhyUe::ScheduleDefferedDownlinkSymbols(size_t frame_id) {
       csi_buffer_ptr[ofdm_data] /= dl_pilot_symbol_perframe_;
     }
   }
-  std::queue<EventData>* defferal_queue = &rx_downlink_deferral_.at(frame_slot);
+  csi_fallback_ready_ = true;
+  last_csi_frame_ = frame_id;
 
-  while (defferal_queue->empty() == false) {
-    ScheduleWork(defferal_queue->front());
-    defferal_queue->pop();
+  // Release one symbol's worth of tasks now; the rest follow one per fft
+  // completion so the backlog doesn't land on the workers all at once
+  ReleaseDeferredSymbols(frame_id, config_->UeAntNum());
+}
+
+void PhyUe::ReleaseDeferredSymbols(size_t frame_id, size_t max_release) {
+  auto& defferal_queue =
+      rx_downlink_deferral_.at(config_->FrameSlot(frame_id));
+  for (size_t i = 0; (i < max_release) && (defferal_queue.empty() == false);
+       i++) {
+    ScheduleWork(defferal_queue.top().event_);
+    defferal_queue.pop();
   }
 }
 
 void PhyUe::ClearCsi(size_t frame_id) {
-  const size_t frame_slot = frame_id % kFrameWnd;
+  const size_t frame_slot = frame_id % config_->FrameWnd();
 
   if (config_->Frame().ClientDlPilotSymbols() > 0) {
-    const size_t csi_offset_base = frame_slot * config_->UeAntNum();
-    for (size_t user = 0; user < config_->UeAntNum(); user++) {
-      const size_t csi_offset = csi_offset_base + user;
-      for (size_t ofdm_data = 0u; ofdm_data < config_->OfdmDataNum();
-           ofdm_data++) {
-        auto* csi_buffer_ptr = reinterpret_cast<arma::cx_float*>(
-            csi_buffer_.at(csi_offset).data());
-
-        csi_buffer_ptr[ofdm_data] = 0;
-      }
+    if (config_->UeStaleCsiFallback() == false) {
+      // With the fallback the estimate stays valid for the next frame's
+      // late symbols; the slot is zeroed on its next pilot arrival instead
+      ZeroCsiSlot(frame_slot);
     }
     fft_dlpilot_counters_.Reset(frame_id);
   }  // Only do work if there are DL pilot symbols
   assert(rx_downlink_deferral_.at(frame_slot).empty() == true);
 }
 
+void PhyUe::ZeroCsiSlot(size_t frame_slot) {
+  const size_t csi_offset_base = frame_slot * config_->UeAntNum();
+  for (size_t user = 0; user < config_->UeAntNum(); user++) {
+    const size_t csi_offset = csi_offset_base + user;
+    for (size_t ofdm_data = 0u; ofdm_data < config_->OfdmDataNum();
+         ofdm_data++) {
+      auto* csi_buffer_ptr =
+          reinterpret_cast<arma::cx_float*>(csi_buffer_.at(csi_offset).data());
+
+      csi_buffer_ptr[ofdm_data] = 0;
+    }
+  }
+}
+
 void PhyUe::Stop() {
   std::cout << "PhyUe: Stopping threads " << std::endl;
   config_->Running(false);
@@ -316,19 +408,36 @@ void PhyUe::Start() {
           size_t symbol_id = pkt->symbol_id_;
           size_t ant_id = pkt->ant_id_;
           size_t ue_id = ant_id / config_->NumUeChannels();
-          size_t frame_slot = frame_id % kFrameWnd;
-          RtAssert(pkt->frame_id_ < (cur_frame_id + kFrameWnd),
+          size_t frame_slot = frame_id % config_->FrameWnd();
+          RtAssert(pkt->frame_id_ < (cur_frame_id + config_->FrameWnd()),
                    "Error: Received packet for future frame beyond frame "
                    "window. This can happen if PHY is running "
                    "slowly, e.g., in debug mode");
 
+          const size_t shed_margin = config_->UeFrameShedMargin();
+          if ((shed_margin > 0) &&
+              (frame_id >= (cur_frame_id + shed_margin)) &&
+              (shed_frame_.at(cur_frame_id % config_->FrameWnd())
+                   .load(std::memory_order_relaxed) != cur_frame_id)) {
+            // The oldest incomplete frame has fallen too far behind: shed
+            // its remaining demul/decode work so it drains quickly instead
+            // of delaying every newer frame. Pilot/CSI tasks keep running
+            shed_frame_.at(cur_frame_id % config_->FrameWnd())
+                .store(cur_frame_id, std::memory_order_relaxed);
+            shed_frame_count_++;
+            MLPD_WARN(
+                "PhyUe: overload - shedding demul/decode work of frame %zu "
+                "(frame %zu arrived, margin %zu)\n",
+                cur_frame_id, frame_id, shed_margin);
+          }
+
           PrintPerTaskDone(PrintType::kPacketRX, frame_id, symbol_id, ant_id);
 
           if (rx_counters_.num_pkts_.at(frame_slot) == 0) {
             this->stats_->MasterSetTsc(TsType::kFirstSymbolRX, frame_id);
             if (kDebugPrintPerFrameStart) {
               const size_t prev_frame_slot =
-                  (frame_slot + kFrameWnd - 1) % kFrameWnd;
+                  (frame_slot + config_->FrameWnd() - 1) % config_->FrameWnd();
               std::printf(
                   "PhyUe [frame %zu + %.2f ms since last frame]: Received "
                   "first packet. Remaining packets in prev frame: %zu\n",
@@ -437,6 +546,10 @@ void PhyUe::Start() {
           EventData do_demul_task(EventType::kDemul, event.tags_[0]);
           ScheduleWork(do_demul_task);
 
+          // Each finished fft lets one more deferred symbol out, so the
+          // catch-up is paced by the workers' drain rate
+          ReleaseDeferredSymbols(frame_id, 1);
+
           PrintPerTaskDone(PrintType::kFFTData, frame_id, symbol_id, ant_id);
           bool tasks_complete =
               fft_dldata_counters_.CompleteTask(frame_id, symbol_id);
@@ -560,7 +673,8 @@ void PhyUe::Start() {
           // This is an entire frame (multiple mac packets)
           const size_t ue_id = rx_mac_tag_t(event.tags_[0]).tid_;
           const size_t radio_buf_id = rx_mac_tag_t(event.tags_[0]).offset_;
-          RtAssert(radio_buf_id == (expected_frame_id_from_mac_ % kFrameWnd),
+          RtAssert(radio_buf_id ==
+                       config_->FrameSlot(expected_frame_id_from_mac_),
                    "Radio buffer id does not match expected");
 
           const auto* pkt = reinterpret_cast<const MacPacketPacked*>(
@@ -748,7 +862,8 @@ void PhyUe::Start() {
                    "PhyUe: Unexpected frame was transmitted!");
 
           ul_bits_buffer_status_[ue_id]
-                                [next_frame_processed_[ue_id] % kFrameWnd] = 0;
+                                [config_->FrameSlot(
+                                    next_frame_processed_[ue_id])] = 0;
           next_frame_processed_[ue_id]++;
 
           PrintPerTaskDone(PrintType::kPacketTX, frame_id, 0, ue_id);
@@ -799,20 +914,20 @@ void PhyUe::InitializeVarsFromCfg() {
           : std::min(config_->UeNum(), config_->UeSocketThreadNum());
 
   tx_buffer_status_size_ =
-      (ul_symbol_perframe_ * config_->UeAntNum() * kFrameWnd);
+      (ul_symbol_perframe_ * config_->UeAntNum() * config_->FrameWnd());
   tx_buffer_size_ = config_->PacketLength() * tx_buffer_status_size_;
 
   rx_buffer_size_ = config_->PacketLength() *
                     (dl_symbol_perframe_ + config_->Frame().NumBeaconSyms()) *
-                    config_->UeAntNum() * kFrameWnd;
+                    config_->UeAntNum() * config_->FrameWnd();
 }
 
 void PhyUe::InitializeUplinkBuffers() {
   // initialize ul data buffer
-  ul_bits_buffer_size_ = kFrameWnd * config_->UlMacBytesNumPerframe();
+  ul_bits_buffer_size_ = config_->FrameWnd() * config_->UlMacBytesNumPerframe();
   ul_bits_buffer_.Malloc(config_->UeAntNum(), ul_bits_buffer_size_,
                          Agora_memory::Alignment_t::kAlign64);
-  ul_bits_buffer_status_.Calloc(config_->UeAntNum(), kFrameWnd,
+  ul_bits_buffer_status_.Calloc(config_->UeAntNum(), config_->FrameWnd(),
                                 Agora_memory::Alignment_t::kAlign64);
 
   // Temp -- Using more memory than necessary to comply with the DoEncode
@@ -821,7 +936,7 @@ void PhyUe::InitializeUplinkBuffers() {
   //    kFrameWnd * ul_symbol_perframe_ * config_->OfdmDataNum();
   // ul_syms_buffer_.Calloc(config_->UeAntNum(), ul_syms_buffer_size_,
   //                       Agora_memory::Alignment_t::kAlign64);
-  const size_t ul_syms_buffer_dim1 = ul_symbol_perframe_ * kFrameWnd;
+  const size_t ul_syms_buffer_dim1 = ul_symbol_perframe_ * config_->FrameWnd();
   const size_t ul_syms_buffer_dim2 =
       Roundup<64>(config_->OfdmDataNum()) * config_->UeAntNum();
 
@@ -835,7 +950,7 @@ void PhyUe::InitializeUplinkBuffers() {
 
   // initialize IFFT buffer
   size_t ifft_buffer_block_num =
-      config_->UeAntNum() * ul_symbol_perframe_ * kFrameWnd;
+      config_->UeAntNum() * ul_symbol_perframe_ * config_->FrameWnd();
   ifft_buffer_.Calloc(ifft_buffer_block_num, config_->OfdmCaNum(),
                       Agora_memory::Alignment_t::kAlign64);
 
@@ -863,12 +978,12 @@ void PhyUe::InitializeDownlinkBuffers() {
 
   // initialize FFT buffer
   size_t fft_buffer_block_num =
-      config_->UeAntNum() * dl_symbol_perframe_ * kFrameWnd;
+      config_->UeAntNum() * dl_symbol_perframe_ * config_->FrameWnd();
   fft_buffer_.Calloc(fft_buffer_block_num, config_->OfdmCaNum(),
                      Agora_memory::Alignment_t::kAlign64);
 
   // initialize CSI buffer
-  csi_buffer_.resize(config_->UeAntNum() * kFrameWnd);
+  csi_buffer_.resize(config_->UeAntNum() * config_->FrameWnd());
   for (auto& i : csi_buffer_) {
     i.resize(config_->OfdmDataNum());
 
@@ -886,7 +1001,7 @@ void PhyUe::InitializeDownlinkBuffers() {
   if (dl_data_symbol_perframe_ > 0) {
     // initialize equalized data buffer
     const size_t task_buffer_symbol_num_dl =
-        dl_data_symbol_perframe_ * kFrameWnd;
+        dl_data_symbol_perframe_ * config_->FrameWnd();
     size_t buffer_size = config_->UeAntNum() * task_buffer_symbol_num_dl;
     equal_buffer_.resize(buffer_size);
     for (auto& i : equal_buffer_) {
@@ -1159,13 +1274,14 @@ void PhyUe::FrameInit(size_t frame) {
   if ((kEnableMac == false) || (config_->Frame().NumDLSyms() == 0)) {
     initial |= static_cast<std::uint8_t>(FrameTasksFlags::kMacTxComplete);
   }
-  frame_tasks_.at(frame % kFrameWnd) = initial;
+  frame_tasks_.at(frame % config_->FrameWnd()) = initial;
 }
 
 bool PhyUe::FrameComplete(size_t frame, FrameTasksFlags complete) {
-  frame_tasks_.at(frame % kFrameWnd) |= static_cast<std::uint8_t>(complete);
+  frame_tasks_.at(frame % config_->FrameWnd()) |=
+      static_cast<std::uint8_t>(complete);
   bool is_complete =
-      (frame_tasks_.at(frame % kFrameWnd) ==
+      (frame_tasks_.at(frame % config_->FrameWnd()) ==
        static_cast<std::uint8_t>(FrameTasksFlags::kFrameComplete));
   return is_complete;
 }
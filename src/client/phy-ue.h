@@ -7,6 +7,7 @@
 #define PHY_UE_H_
 
 #include <array>
+#include <atomic>
 #include <list>
 #include <queue>
 #include <thread>
@@ -25,6 +26,16 @@
 #include "txrx_client.h"
 #include "ue_worker.h"
 
+/**
+ * @brief The PHY for every UE hosted by this process.
+ *
+ * One PhyUe instance serves all UEs in the config (UeNum()) over a single
+ * shared UeWorker pool; per-UE and per-antenna state lives in buffers
+ * indexed by UE antenna, and the single MAC thread shards its work by UE.
+ * Emulation rigs hosting many UEs on one box should therefore scale
+ * ue_num within one process instead of running one process per UE, which
+ * duplicates worker threads, FFT descriptors and generated data tables.
+ */
 class PhyUe {
  public:
   enum class FrameTasksFlags : std::uint8_t {
@@ -57,9 +68,39 @@ class PhyUe {
 
   void ReceiveDownlinkSymbol(struct Packet* rx_packet, size_t tag);
   void ScheduleDefferedDownlinkSymbols(size_t frame_id);
+  // Release up to max_release deferred downlink symbols, earliest first
+  void ReleaseDeferredSymbols(size_t frame_id, size_t max_release);
   void ClearCsi(size_t frame_id);
+  void ZeroCsiSlot(size_t frame_slot);
 
-  std::vector<std::queue<EventData>> rx_downlink_deferral_;
+  // A downlink data symbol held back until the frame's pilot CSI is ready.
+  // Ordered by downlink symbol index so the release is earliest-first
+  struct DeferredEvent {
+    size_t dl_symbol_idx_;
+    EventData event_;
+  };
+  struct DeferredEventCompare {
+    bool operator()(const DeferredEvent& lhs, const DeferredEvent& rhs) const {
+      return lhs.dl_symbol_idx_ > rhs.dl_symbol_idx_;
+    }
+  };
+  std::vector<std::priority_queue<DeferredEvent, std::vector<DeferredEvent>,
+                                  DeferredEventCompare>>
+      rx_downlink_deferral_;
+
+  // Most recent frame whose pilot CSI was normalized, for the stale-CSI
+  // fallback (ue_stale_csi_fallback)
+  bool csi_fallback_ready_ = false;
+  size_t last_csi_frame_ = 0;
+  // Frame currently occupying each CSI slot; with the stale-CSI fallback
+  // the slot is zeroed lazily, when its first pilot of a new frame arrives
+  std::array<size_t, kFrameWnd> csi_slot_frame_;
+
+  // Load shedding (ue_frame_shed_margin): a slot holding a frame id marks
+  // that frame as shed; workers skip its demul/decode compute. Shared with
+  // the UeWorkers, master-written
+  std::array<std::atomic<size_t>, kFrameWnd> shed_frame_;
+  size_t shed_frame_count_ = 0;
   std::unique_ptr<Stats> stats_;
   std::unique_ptr<PhyStats> phy_stats_;
   RxCounters rx_counters_;
@@ -81,6 +122,9 @@ class PhyUe {
   void ScheduleWork(EventData do_task);
 
   std::unique_ptr<moodycamel::ProducerToken> work_producer_token_;
+  // Producer token for the dedicated decode queue (ue_decode_thread_num);
+  // null when decode stays in the shared worker pool
+  std::unique_ptr<moodycamel::ProducerToken> decode_producer_token_;
 
   void InitializeVarsFromCfg();
 
@@ -192,7 +236,8 @@ class PhyUe {
   std::vector<myVec> equal_buffer_;
 
   // Data after demodulation. Each buffer has kMaxModType * number of OFDM
-  // data subcarriers
+  // data subcarriers, in the decoder's native channel-LLR stream layout and
+  // padded for the decoder's 32-byte-wide reads of the last code block
   PtrCube<kFrameWnd, kMaxSymbols, kMaxUEs, int8_t> demod_buffer_;
 
   // Data after LDPC decoding. Each buffer [decoded bytes per UE] bytes.
@@ -204,6 +249,9 @@ class PhyUe {
   // Communication queues
   moodycamel::ConcurrentQueue<EventData> complete_queue_;
   moodycamel::ConcurrentQueue<EventData> work_queue_;
+  // Decode-only queue drained by the dedicated decode workers, so a slow
+  // LDPC decode never delays the next symbol's front-end tasks
+  moodycamel::ConcurrentQueue<EventData> decode_queue_;
 
   moodycamel::ConcurrentQueue<EventData> tx_queue_;
   moodycamel::ConcurrentQueue<EventData> to_mac_queue_;
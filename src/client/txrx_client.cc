@@ -14,6 +14,8 @@ RadioTxRx::RadioTxRx(Config* const cfg, int n_threads, int in_core_id)
   if ((kUseArgos == false) && (kUseUHD == false)) {
     udp_servers_.resize(config_->UeAntNum());
     udp_clients_.resize(config_->UeAntNum());
+    tx_pilot_pkt_buf_.resize(thread_num_);
+    tx_zero_pkt_buf_.resize(thread_num_);
   } else {
     radioconfig_ = std::make_unique<ClientRadioConfig>(config_);
   }
@@ -150,10 +152,9 @@ int RadioTxRx::DequeueSend(int tid) {
   // std::printf("tx queue length: %d\n", task_queue_->size_approx());
   size_t ue_id = gen_tag_t(event.tags_[0]).ue_id_;
   size_t frame_id = gen_tag_t(event.tags_[0]).frame_id_;
-  std::vector<char> zeros(c->PacketLength(), 0);
-  std::vector<char> pilot(c->PacketLength(), 0);
-  std::memcpy(&pilot[Packet::kOffsetOfData], c->PilotCi16().data(),
-              c->PacketLength() - Packet::kOffsetOfData);
+  // Payloads were rendered once in LoopTxRx(); only headers change below
+  std::vector<char>& zeros = tx_zero_pkt_buf_.at(tid);
+  std::vector<char>& pilot = tx_pilot_pkt_buf_.at(tid);
 
   // Transmit pilot symbols on each UE channel
   for (size_t channel = 0; channel < c->NumUeChannels(); channel++) {
@@ -227,10 +228,13 @@ void* RadioTxRx::LoopTxRx(size_t tid) {
   std::printf("Receiver thread %zu has %zu antennas\n", tid, ant_hi - ant_lo);
 
   size_t sock_buf_size = (1024 * 1024 * 64 * 8) - 1;
+  if (config_->UdpRxBufferBytes() != 0) {
+    sock_buf_size = config_->UdpRxBufferBytes();
+  }
   for (size_t ant_id = ant_lo; ant_id < ant_hi; ++ant_id) {
     size_t local_port_id = config_->UeServerPort() + ant_id;
-    udp_servers_.at(ant_id) =
-        std::make_unique<UDPServer>(local_port_id, sock_buf_size);
+    udp_servers_.at(ant_id) = std::make_unique<UDPServer>(
+        local_port_id, sock_buf_size, config_->UdpBusyPollUs());
     udp_clients_.at(ant_id) = std::make_unique<UDPClient>();
     MLPD_FRAME(
         "TXRX thread %zu: set up UDP socket server listening to port %d"
@@ -239,6 +243,14 @@ void* RadioTxRx::LoopTxRx(size_t tid) {
         config_->UeRruPort() + ant_id);
   }
 
+  // Render the constant wire-format TX packets for this thread once; the
+  // pilot payload never changes across frames
+  tx_zero_pkt_buf_.at(tid).assign(config_->PacketLength(), 0);
+  tx_pilot_pkt_buf_.at(tid).assign(config_->PacketLength(), 0);
+  std::memcpy(&tx_pilot_pkt_buf_.at(tid).at(Packet::kOffsetOfData),
+              config_->PilotCi16().data(),
+              config_->PacketLength() - Packet::kOffsetOfData);
+
   size_t ant_id = ant_lo;
   while (config_->Running() == true) {
     if (-1 != DequeueSend(tid)) {
@@ -575,6 +587,11 @@ void* RadioTxRx::LoopTxRxArgosSync(size_t tid) {
   size_t resync_retry_max(100);
   size_t resync_success(0);
   rx_offset = 0;
+  // Persistent working set for the periodic resyncs below; after the first
+  // resync the beacon tracker runs without heap allocation
+  std::vector<std::complex<float>> sync_buff;
+  sync_buff.reserve(num_samps);
+  CommsLib::BeaconScratch beacon_scratch;
   while (c->Running() == true) {
     if (c->FramesToTest() > 0 && frame_id > c->FramesToTest()) {
       c->Running(false);
@@ -616,13 +633,22 @@ void* RadioTxRx::LoopTxRxArgosSync(size_t tid) {
     rx_offset = 0;
     if (resync) {
       // convert data to complex float for sync detection
-      std::vector<std::complex<float>> sync_buff;
-      sync_buff.reserve(num_samps);
+      sync_buff.clear();
       for (size_t i = 0; i < num_samps; i++) {
         sync_buff.emplace_back(frm_buff0[i].real() / 32768.0,
                                frm_buff0[i].imag() / 32768.0);
       }
-      sync_index = CommsLib::FindBeaconAvx(sync_buff, c->GoldCf32());
+      // Track first: the beacon can only have drifted a little since the
+      // last sync, so search a small window around its nominal position
+      // and fall back to the full-frame scan on a miss
+      static const size_t kBeaconTrackWindow = 200;
+      const size_t expected_index = c->BeaconLen() + c->OfdmTxZeroPrefix();
+      sync_index =
+          CommsLib::FindBeaconAvx(sync_buff, c->GoldCf32(), expected_index,
+                                  kBeaconTrackWindow, beacon_scratch);
+      if (sync_index < 0) {
+        sync_index = CommsLib::FindBeaconAvx(sync_buff, c->GoldCf32());
+      }
       if (sync_index >= 0) {
         rx_offset = sync_index - c->BeaconLen() - c->OfdmTxZeroPrefix();
         time0 += rx_offset;
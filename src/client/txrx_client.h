@@ -169,5 +169,11 @@ class RadioTxRx {
   // helper buffers
   std::vector<void*> pilot_buff0_;
   std::vector<void*> pilot_buff1_;
+
+  // Per-thread wire-format TX packets rendered once at thread startup: the
+  // pilot payload (Config's ue_specific_pilot_) and the all-zero payload
+  // never change, so DequeueSend() only rewrites the packet headers
+  std::vector<std::vector<char>> tx_pilot_pkt_buf_;
+  std::vector<std::vector<char>> tx_zero_pkt_buf_;
 };
 #endif  // RADIOTXRX_H_
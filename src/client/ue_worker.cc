@@ -5,6 +5,7 @@
  */
 #include "ue_worker.h"
 
+#include <cassert>
 #include <memory>
 
 #include "datatype_conversion.h"
@@ -37,7 +38,8 @@ UeWorker::UeWorker(
     Table<complex_float>& fft_buffer,
     PtrCube<kFrameWnd, kMaxSymbols, kMaxUEs, int8_t>& demod_buffer,
     PtrCube<kFrameWnd, kMaxSymbols, kMaxUEs, int8_t>& decoded_buffer,
-    std::vector<std::vector<std::complex<float>>>& ue_pilot_vec)
+    std::vector<std::vector<std::complex<float>>>& ue_pilot_vec,
+    std::array<std::atomic<size_t>, kFrameWnd>& shed_frame)
     : tid_(tid),
 
       notify_queue_(notify_queue),
@@ -58,7 +60,8 @@ UeWorker::UeWorker(
       fft_buffer_(fft_buffer),
       demod_buffer_(demod_buffer),
       decoded_buffer_(decoded_buffer),
-      ue_pilot_vec_(ue_pilot_vec) {
+      ue_pilot_vec_(ue_pilot_vec),
+      shed_frame_(shed_frame) {
   ptok_ = std::make_unique<moodycamel::ProducerToken>(notify_queue);
 
   AllocBuffer1d(&rx_samps_tmp_, config_.SampsPerSymbol(),
@@ -96,7 +99,7 @@ void UeWorker::TaskThread(size_t core_offset) {
   auto encoder = std::make_unique<DoEncode>(
       &config_, (int)tid_, Direction::kUplink,
       (kEnableMac == true) ? ul_bits_buffer_ : config_.UlBits(),
-      (kEnableMac == true) ? kFrameWnd : 1, encoded_buffer_, &stats_);
+      (kEnableMac == true) ? config_.FrameWnd() : 1, encoded_buffer_, &stats_);
 
   auto iffter = std::make_unique<DoIFFTClient>(
       &config_, (int)tid_, ifft_buffer_, tx_buffer_, &stats_);
@@ -130,7 +133,8 @@ void UeWorker::TaskThread(size_t core_offset) {
           DoFftPilot(event.tags_[0]);
         } break;
         case EventType::kFFT: {
-          DoFftData(event.tags_[0]);
+          DoFftData(event.tags_[0],
+                    (event.num_tags_ == 2) && (event.tags_[1] == 1));
         } break;
         default: {
           std::printf("***** Invalid Event Type [%d] in Work Queue\n",
@@ -144,7 +148,7 @@ void UeWorker::TaskThread(size_t core_offset) {
 //////////////////////////////////////////////////////////
 //                   DOWNLINK Operations                //
 //////////////////////////////////////////////////////////
-void UeWorker::DoFftData(size_t tag) {
+void UeWorker::DoFftData(size_t tag, bool stale_csi) {
   size_t start_tsc = GetTime::Rdtsc();
 
   // read info of one frame
@@ -153,7 +157,7 @@ void UeWorker::DoFftData(size_t tag) {
   size_t frame_id = pkt->frame_id_;
   size_t symbol_id = pkt->symbol_id_;
   size_t ant_id = pkt->ant_id_;
-  size_t frame_slot = frame_id % kFrameWnd;
+  size_t frame_slot = frame_id % config_.FrameWnd();
 
   if (kDebugPrintInTask || kDebugPrintFft) {
     std::printf("UeWorker[%zu]: Fft Data(frame %zu, symbol %zu, ant %zu)\n",
@@ -195,7 +199,13 @@ void UeWorker::DoFftData(size_t tag) {
   // perform fft
   DftiComputeForward(mkl_handle_, fft_buffer_[fft_buffer_target_id]);
 
-  size_t csi_offset = frame_slot * config_.UeAntNum() + ant_id;
+  // When the master released this symbol before the frame's pilot ffts
+  // finished, fall back to the previous frame's (already normalized) CSI
+  size_t csi_frame_slot = frame_slot;
+  if (stale_csi == true) {
+    csi_frame_slot = (frame_id - 1) % config_.FrameWnd();
+  }
+  size_t csi_offset = csi_frame_slot * config_.UeAntNum() + ant_id;
   auto* csi_buffer_ptr =
       reinterpret_cast<arma::cx_float*>(csi_buffer_.at(csi_offset).data());
   auto* fft_buffer_ptr =
@@ -215,7 +225,6 @@ void UeWorker::DoFftData(size_t tag) {
   float theta = 0;
   for (size_t j = 0; j < config_.OfdmDataNum(); j++) {
     if (j % config_.OfdmPilotSpacing() == 0) {
-      equ_buffer_ptr[j] = 0;
       size_t sc_id = non_null_sc_ind_[j];
       arma::cx_float y = fft_buffer_ptr[sc_id];
       auto pilot_eq = y / csi_buffer_ptr[j];
@@ -227,13 +236,25 @@ void UeWorker::DoFftData(size_t tag) {
     theta /= config_.GetOFDMPilotNum();
   }
   auto phc = exp(arma::cx_float(0, -theta));
+
+  // Equalize the whole data run in one blocked AVX2 kernel.
+  // non_null_sc_ind_ holds OfdmDataStart()..OfdmDataStart()+OfdmDataNum(),
+  // so the fft output subcarriers are one contiguous run
+  assert(non_null_sc_ind_[config_.OfdmDataNum() - 1] ==
+         non_null_sc_ind_[0] + config_.OfdmDataNum() - 1);
+  CommsLib::EqualizeAvx(
+      reinterpret_cast<std::complex<float>*>(
+          &fft_buffer_ptr[non_null_sc_ind_[0]]),
+      reinterpret_cast<std::complex<float>*>(csi_buffer_ptr),
+      reinterpret_cast<std::complex<float>*>(equ_buffer_ptr),
+      config_.OfdmDataNum(), phc);
+
   float evm = 0;
   for (size_t j = 0; j < config_.OfdmDataNum(); j++) {
-    if (j % config_.OfdmPilotSpacing() != 0) {
-      // divide fft output by pilot data to get CSI estimation
-      size_t sc_id = non_null_sc_ind_[j];
-      arma::cx_float y = fft_buffer_ptr[sc_id];
-      equ_buffer_ptr[j] = (y / csi_buffer_ptr[j]) * phc;
+    if (j % config_.OfdmPilotSpacing() == 0) {
+      // phase-tracking pilots carry no data
+      equ_buffer_ptr[j] = 0;
+    } else {
       complex_float tx =
           config_.DlIqF()[dl_symbol_id][ant_id * config_.OfdmCaNum() +
                                         config_.OfdmDataStart() + j];
@@ -291,7 +312,7 @@ void UeWorker::DoFftPilot(size_t tag) {
   size_t frame_id = pkt->frame_id_;
   size_t symbol_id = pkt->symbol_id_;
   size_t ant_id = pkt->ant_id_;
-  size_t frame_slot = frame_id % kFrameWnd;
+  size_t frame_slot = frame_id % config_.FrameWnd();
 
   if (kDebugPrintInTask || kDebugPrintFft) {
     std::printf("UeWorker[%zu]: Fft Pilot(frame %zu, symbol %zu, ant %zu)\n",
@@ -408,9 +429,20 @@ void UeWorker::DoDemul(size_t tag) {
     std::printf("UeWorker[%zu]: Demul  (frame %zu, symbol %zu, ant %zu)\n",
                 tid_, frame_id, symbol_id, ant_id);
   }
+
+  if (shed_frame_.at(frame_id % config_.FrameWnd())
+          .load(std::memory_order_relaxed) ==
+      frame_id) {
+    // The master shed this frame under overload: skip the compute but keep
+    // the completion flowing so the frame's bookkeeping still drains
+    RtAssert(
+        notify_queue_.enqueue(*ptok_.get(), EventData(EventType::kDemul, tag)),
+        "Demodulation message enqueue failed");
+    return;
+  }
   size_t start_tsc = GetTime::Rdtsc();
 
-  const size_t frame_slot = frame_id % kFrameWnd;
+  const size_t frame_slot = frame_id % config_.FrameWnd();
   size_t dl_symbol_id = config_.Frame().GetDLSymbolIdx(symbol_id);
   size_t dl_data_symbol_perframe = config_.Frame().NumDlDataSyms();
   size_t total_dl_symbol_id = frame_slot * dl_data_symbol_perframe +
@@ -429,10 +461,10 @@ void UeWorker::DoDemul(size_t tag) {
       DemodQpskSoftSse(equal_ptr, demod_ptr, config_.OfdmDataNum());
       break;
     case (CommsLib::kQaM16):
-      Demod16qamSoftAvx2(equal_ptr, demod_ptr, config_.OfdmDataNum());
+      Demod16qamSoft(equal_ptr, demod_ptr, config_.OfdmDataNum());
       break;
     case (CommsLib::kQaM64):
-      Demod64qamSoftAvx2(equal_ptr, demod_ptr, config_.OfdmDataNum());
+      Demod64qamSoft(equal_ptr, demod_ptr, config_.OfdmDataNum());
       break;
     default:
       std::printf("UeWorker[%zu]: Demul - modulation type %s not supported!\n",
@@ -465,6 +497,20 @@ void UeWorker::DoDecodeUe(DoDecodeClient* decoder, size_t tag) {
   const size_t symbol_id = gen_tag_t(tag).symbol_id_;
   const size_t ant_id = gen_tag_t(tag).ant_id_;
 
+  if (shed_frame_.at(frame_id % config_.FrameWnd())
+          .load(std::memory_order_relaxed) ==
+      frame_id) {
+    // Shed frame: leave the (stale) decoded buffer untouched and post the
+    // completion directly
+    RtAssert(notify_queue_.enqueue(
+                 *ptok_.get(),
+                 EventData(EventType::kDecode,
+                           gen_tag_t::FrmSymUe(frame_id, symbol_id, ant_id)
+                               .tag_)),
+             "Decode Symbol message enqueue failed");
+    return;
+  }
+
   for (size_t cb_id = 0; cb_id < config_.LdpcConfig().NumBlocksInSymbol();
        cb_id++) {
     // For now, call for each cb
@@ -553,10 +599,10 @@ void UeWorker::DoModul(size_t tag) {
     }
 
     // TODO place directly into the correct location of the fft buffer
-    for (size_t sc = 0; sc < config_.OfdmDataNum(); sc++) {
-      modul_buf[sc] =
-          ModSingleUint8(static_cast<uint8_t>(ul_bits[sc]), config_.ModTable());
-    }
+    complex_float* modul_ptr = modul_buf;
+    ModSimdComputed(reinterpret_cast<uint8_t*>(ul_bits), modul_ptr,
+                    config_.OfdmDataNum(), config_.ModOrderBits(),
+                    config_.ModTable());
   }
 
   if ((kDebugPrintPerTaskDone == true) || (kDebugPrintModul == true)) {
@@ -617,7 +663,7 @@ void UeWorker::DoIfft(size_t tag) {
   const size_t symbol_id = gen_tag_t(tag).symbol_id_;
   const size_t user_id = gen_tag_t(tag).ue_id_;
 
-  const size_t frame_slot = frame_id % kFrameWnd;
+  const size_t frame_slot = frame_id % config_.FrameWnd();
 
   if (kDebugPrintInTask) {
     std::printf("User Task[%zu]: iFFT   (frame %zu, symbol %zu, user %zu)\n",
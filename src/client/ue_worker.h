@@ -6,6 +6,8 @@
 #ifndef UE_WORKER_H_
 #define UE_WORKER_H_
 
+#include <array>
+#include <atomic>
 #include <complex>
 #include <thread>
 #include <vector>
@@ -38,7 +40,8 @@ class UeWorker {
       Table<complex_float>& fft_buffer,
       PtrCube<kFrameWnd, kMaxSymbols, kMaxUEs, int8_t>& demod_buffer,
       PtrCube<kFrameWnd, kMaxSymbols, kMaxUEs, int8_t>& decoded_buffer,
-      std::vector<std::vector<std::complex<float>>>& ue_pilot_vec);
+      std::vector<std::vector<std::complex<float>>>& ue_pilot_vec,
+      std::array<std::atomic<size_t>, kFrameWnd>& shed_frame);
   ~UeWorker();
 
   void Start(size_t core_offset);
@@ -89,7 +92,9 @@ class UeWorker {
    * completion of this task
    */
   void DoFftPilot(size_t tag);
-  void DoFftData(size_t tag);
+  // stale_csi selects the previous frame's CSI for equalization (set when
+  // the master released the symbol before this frame's pilot ffts finished)
+  void DoFftData(size_t tag, bool stale_csi);
 
   /**
    * Do demodulation task for a block of subcarriers (demul_block_size)
@@ -153,5 +158,10 @@ class UeWorker {
   PtrCube<kFrameWnd, kMaxSymbols, kMaxUEs, int8_t>& decoded_buffer_;
 
   std::vector<std::vector<std::complex<float>>>& ue_pilot_vec_;
+
+  // Per-slot shed markers written by the master (ue_frame_shed_margin):
+  // when a slot holds this task's exact frame id, demul/decode skip the
+  // compute and only post their completion events
+  std::array<std::atomic<size_t>, kFrameWnd>& shed_frame_;
 };
 #endif  // UE_WORKER_H_
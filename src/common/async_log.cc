@@ -0,0 +1,168 @@
+/**
+ * @file async_log.cc
+ * @brief Implementation of the asynchronous logging backend (see
+ * async_log.h). Deliberately avoids the MLPD macros, which may route here.
+ */
+#include "async_log.h"
+
+#include <chrono>
+#include <cstdarg>
+#include <cstring>
+#include <ctime>
+
+/// Milliseconds the drain thread sleeps between sweeps
+static constexpr size_t kAsyncLogDrainIntervalMs = 2;
+
+/// Level tag matching MlpdOutputLogHeader in logger.h
+static const char* AsyncLogLevelName(uint32_t level) {
+  switch (level) {
+    case 1:
+      return "ERROR";
+    case 2:
+      return "WARNG";
+    case 3:
+      return "INFOR";
+    case 4:
+      return "FRAME";
+    case 5:
+      return "SBFRM";
+    case 6:
+      return "TRACE";
+    default:
+      return "UNKWN";
+  }
+}
+
+AsyncLog& AsyncLog::Instance() {
+  static AsyncLog instance;
+  return instance;
+}
+
+void AsyncLog::Start(std::FILE* stream) {
+  if (this->running_.load() == true) {
+    return;
+  }
+  this->out_stream_ = stream;
+  this->running_.store(true);
+  this->drain_thread_ = std::thread(&AsyncLog::DrainLoop, this);
+  std::fprintf(stream,
+               "AsyncLog: logging asynchronously (%zu-byte records, %zu per "
+               "ring)\n",
+               sizeof(AsyncLogRecord), AsyncLogRing::kRecordsPerRing);
+}
+
+void AsyncLog::Stop() {
+  if (this->running_.load() == false) {
+    return;
+  }
+  this->running_.store(false);
+  this->drain_thread_.join();
+
+  // Final sweep for records emitted before running_ went false
+  uint64_t total_dropped = 0;
+  const size_t num_rings = this->num_rings_.load(std::memory_order_acquire);
+  for (size_t ring_id = 0; ring_id < num_rings; ring_id++) {
+    this->DrainRing(ring_id);
+    total_dropped += this->rings_.at(ring_id)->dropped_.load();
+  }
+  if (total_dropped > 0) {
+    std::fprintf(this->out_stream_,
+                 "AsyncLog: drain thread fell behind, %lu messages dropped\n",
+                 total_dropped);
+  }
+  std::fflush(this->out_stream_);
+  this->out_stream_ = nullptr;
+  // The rings stay allocated: threads cache their ring pointer in a
+  // thread_local, which must not dangle if logging restarts
+}
+
+void AsyncLog::Emit(int level, const char* format, ...) {
+  AsyncLog& log = Instance();
+  va_list args;
+  va_start(args, format);
+
+  if (log.running_.load(std::memory_order_relaxed) == false) {
+    // Synchronous fallback, matching the default logger.h behavior
+    struct timespec t;
+    clock_gettime(CLOCK_REALTIME, &t);
+    std::fprintf(stdout, "%u:%06u %s: ",
+                 static_cast<uint32_t>(t.tv_sec % 100),
+                 static_cast<uint32_t>(t.tv_nsec / 1000),
+                 AsyncLogLevelName(level));
+    std::vfprintf(stdout, format, args);
+    std::fflush(stdout);
+    va_end(args);
+    return;
+  }
+
+  thread_local AsyncLogRing* ring = nullptr;
+  if (ring == nullptr) {
+    ring = log.RegisterThread();
+  }
+
+  const uint64_t idx = ring->write_idx_.load(std::memory_order_relaxed);
+  if ((idx - ring->read_idx_.load(std::memory_order_acquire)) ==
+      AsyncLogRing::kRecordsPerRing) {
+    // Full: count the overflow instead of blocking or overwriting
+    ring->dropped_.fetch_add(1, std::memory_order_relaxed);
+    va_end(args);
+    return;
+  }
+
+  AsyncLogRecord& rec =
+      ring->records_[idx & (AsyncLogRing::kRecordsPerRing - 1)];
+  struct timespec t;
+  clock_gettime(CLOCK_REALTIME, &t);
+  rec.seconds_ = static_cast<uint32_t>(t.tv_sec % 100);
+  rec.usec_ = static_cast<uint32_t>(t.tv_nsec / 1000);
+  rec.level_ = static_cast<uint32_t>(level);
+  std::vsnprintf(rec.msg_, sizeof(rec.msg_), format, args);
+  va_end(args);
+  // Publish after the record body; the drain thread acquires write_idx_
+  ring->write_idx_.store(idx + 1, std::memory_order_release);
+}
+
+AsyncLogRing* AsyncLog::RegisterThread() {
+  std::scoped_lock lock(this->reg_mutex_);
+  this->rings_.push_back(std::make_unique<AsyncLogRing>());
+  AsyncLogRing* ring = this->rings_.back().get();
+  // Publish the count last so the drain thread never sees a ring slot
+  // before its unique_ptr is in place
+  this->num_rings_.store(this->rings_.size(), std::memory_order_release);
+  return ring;
+}
+
+void AsyncLog::DrainLoop() {
+  while (this->running_.load() == true) {
+    std::this_thread::sleep_for(
+        std::chrono::milliseconds(kAsyncLogDrainIntervalMs));
+    const size_t num_rings = this->num_rings_.load(std::memory_order_acquire);
+    bool printed = false;
+    for (size_t ring_id = 0; ring_id < num_rings; ring_id++) {
+      const uint64_t before =
+          this->rings_.at(ring_id)->read_idx_.load(std::memory_order_relaxed);
+      this->DrainRing(ring_id);
+      printed |= (this->rings_.at(ring_id)->read_idx_.load(
+                      std::memory_order_relaxed) != before);
+    }
+    if (printed == true) {
+      std::fflush(this->out_stream_);
+    }
+  }
+}
+
+void AsyncLog::DrainRing(size_t ring_id) {
+  AsyncLogRing* ring = this->rings_.at(ring_id).get();
+  uint64_t read_idx = ring->read_idx_.load(std::memory_order_relaxed);
+  const uint64_t write_idx = ring->write_idx_.load(std::memory_order_acquire);
+
+  while (read_idx < write_idx) {
+    const AsyncLogRecord& rec =
+        ring->records_[read_idx & (AsyncLogRing::kRecordsPerRing - 1)];
+    std::fprintf(this->out_stream_, "%u:%06u %s: %s", rec.seconds_, rec.usec_,
+                 AsyncLogLevelName(rec.level_), rec.msg_);
+    read_idx++;
+    // Release the slot so the producer can reuse it
+    ring->read_idx_.store(read_idx, std::memory_order_release);
+  }
+}
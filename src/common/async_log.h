@@ -0,0 +1,92 @@
+/**
+ * @file async_log.h
+ * @brief Asynchronous backend for the MLPD logging macros.
+ *
+ * The default macros in logger.h format and flush on the calling thread,
+ * so a single warning fired from the RX or worker loops can cost a
+ * deadline. With MLPD_ASYNC_LOG (USE_ASYNC_LOG build flag) the macros
+ * instead write a fixed-size record into a lock-free per-thread ring and
+ * a background thread does the stream formatting and flushing. A full
+ * ring drops the record and counts the overflow instead of blocking the
+ * producer, so INFO-level logging can stay on in production.
+ *
+ * Until Start() runs (and after Stop()) emits fall back to the
+ * synchronous path, so early startup and teardown messages still appear
+ * in order.
+ */
+#ifndef ASYNC_LOG_H_
+#define ASYNC_LOG_H_
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// One fixed-size log record: capture time, level, and the formatted
+/// message (truncated to fit)
+struct AsyncLogRecord {
+  uint32_t seconds_;  /// Emit time, seconds (mod 100, like the sync header)
+  uint32_t usec_;     /// Emit time, microseconds
+  uint32_t level_;    /// MLPD_LOG_LEVEL_* of the message
+  char msg_[244];     /// NUL-terminated formatted message
+};
+static_assert(sizeof(AsyncLogRecord) == 256,
+              "AsyncLogRecord must stay 256 bytes");
+
+/// Single-producer ring written by one thread and drained by the log's
+/// background thread. The producer never blocks: when the ring is full
+/// the record is dropped and counted
+class AsyncLogRing {
+ public:
+  /// 1Ki records = 256 KiB per thread; must be a power of two
+  static constexpr size_t kRecordsPerRing = 1 << 10;
+
+ private:
+  friend class AsyncLog;
+  std::array<AsyncLogRecord, kRecordsPerRing> records_;
+  alignas(64) std::atomic<uint64_t> write_idx_{0};
+  alignas(64) std::atomic<uint64_t> read_idx_{0};
+  /// Records dropped because the drain thread fell behind
+  std::atomic<uint64_t> dropped_{0};
+};
+
+/// Process-wide registry of per-thread rings plus the drain thread,
+/// mirroring TraceLog. Rings registered by threads persist for the
+/// process lifetime so thread-local pointers never dangle
+class AsyncLog {
+ public:
+  static AsyncLog& Instance();
+
+  /// Start the background drain thread writing to stream (not owned)
+  void Start(std::FILE* stream);
+
+  /// Final drain, join the drain thread, and report overflow counts.
+  /// Later emits fall back to the synchronous path
+  void Stop();
+
+  /// Format and enqueue one message from the calling thread's ring, or
+  /// write it synchronously when the drain thread is not running
+  static void Emit(int level, const char* format, ...)
+      __attribute__((format(printf, 2, 3)));
+
+ private:
+  AsyncLog() = default;
+  AsyncLogRing* RegisterThread();
+  void DrainLoop();
+  /// Print everything published in rings_[ring_id] since the last drain
+  void DrainRing(size_t ring_id);
+
+  /// Guards ring registration only; the hot Emit path takes no lock
+  std::mutex reg_mutex_;
+  std::vector<std::unique_ptr<AsyncLogRing>> rings_;
+  std::atomic<size_t> num_rings_{0};
+  std::atomic<bool> running_{false};
+  std::thread drain_thread_;
+  std::FILE* out_stream_{nullptr};
+};
+
+#endif  // ASYNC_LOG_H_
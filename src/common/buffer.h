@@ -142,6 +142,10 @@ static_assert(sizeof(gen_tag_t) == sizeof(size_t));
  */
 struct EventData {
   static constexpr size_t kMaxTags = 7;
+  // num_tags_ values with this bit set mark a range event: tags_[0] holds
+  // the base tag, tags_[1] the task count, and tags_[2] the raw tag stride
+  // between consecutive tasks
+  static constexpr uint32_t kRangeFlag = 0x80000000u;
   EventType event_type_;
   uint32_t num_tags_{0};
   std::array<size_t, kMaxTags> tags_;
@@ -158,6 +162,29 @@ struct EventData {
     tags_.at(0) = tag;
   }
 
+  // Create a range event describing count tasks whose tags start at base_tag
+  // and advance by tag_stride. This exploits gen_tag_t's layout: the varying
+  // field (e.g., sc_id_) occupies contiguous bits, so one raw addition
+  // advances the tag to the next task.
+  EventData(EventType event_type, size_t base_tag, size_t count,
+            size_t tag_stride)
+      : event_type_(event_type), num_tags_(kRangeFlag) {
+    tags_.fill(0);
+    tags_.at(0) = base_tag;
+    tags_.at(1) = count;
+    tags_.at(2) = tag_stride;
+  }
+
+  bool IsRange() const { return (num_tags_ & kRangeFlag) != 0; }
+
+  // Number of tasks this event describes, for both tag-list and range events
+  size_t NumTasks() const { return IsRange() ? tags_.at(1) : num_tags_; }
+
+  // The tag of the i-th task, for both tag-list and range events
+  size_t Tag(size_t i) const {
+    return IsRange() ? (tags_.at(0) + (i * tags_.at(2))) : tags_.at(i);
+  }
+
   EventData() = default;
 };
 static_assert(sizeof(EventData) == 64);
@@ -188,6 +215,9 @@ class RxPacket {
  private:
   std::atomic<unsigned> references_;
   Packet *packet_;
+  // Frame occupying this slot in frame-epoch reclamation mode; SIZE_MAX
+  // while the slot has never been used
+  size_t frame_epoch_ = SIZE_MAX;
 
   inline virtual void GcPacket() {}
 
@@ -214,6 +244,14 @@ class RxPacket {
   inline Packet *RawPacket() { return packet_; }
   inline bool Empty() const { return references_.load() == 0; }
   inline void Use() { references_.fetch_add(1); }
+
+  // Frame-epoch reclamation (rx_epoch_reclaim): instead of Use()/Free()
+  // reference counting, the RX thread stamps the frame id occupying this
+  // slot and reuses the slot once the master's completed-frame watermark
+  // passes that frame. Only the owning RX thread touches the stamp, so it
+  // needs no atomics; the watermark is the only shared state.
+  inline void SetFrameEpoch(size_t frame_id) { frame_epoch_ = frame_id; }
+  inline size_t FrameEpoch() const { return frame_epoch_; }
   inline void Free() {
     unsigned value = references_.fetch_sub(1);
     if (value == 0) {
@@ -337,10 +375,122 @@ class RxCounters {
   // Number of reciprocity pilot packets we'll receive per frame
   size_t num_reciprocity_pkts_per_frame_;
 
+  // Per-(symbol, antenna) arrival bitmap for each frame slot in the
+  // window, and the frame each slot currently tracks. With multi-queue
+  // RX the socket threads deliver packets out of order across frames, so
+  // the master uses the bitmap to accept each packet of a windowed frame
+  // exactly once: duplicates and stragglers whose frame slot was already
+  // recycled are rejected instead of corrupting the counters above
+  std::array<std::vector<uint8_t>, kFrameWnd> pkt_bitmap_;
+  std::array<size_t, kFrameWnd> bitmap_frame_;
+
+  // Rejected packets: stragglers from recycled frames, and duplicates
+  size_t num_stale_drops_;
+  size_t num_duplicate_drops_;
+
+  // Size each frame slot's bitmap for [num_pkt_slots] (symbol, antenna)
+  // pairs
+  void InitBitmap(size_t num_pkt_slots) {
+    for (auto& bitmap : pkt_bitmap_) {
+      bitmap.assign((num_pkt_slots + 7) / 8, 0u);
+    }
+  }
+
   RxCounters() {
     num_pkts_.fill(0);
     num_pilot_pkts_.fill(0);
     num_reciprocity_pkts_.fill(0);
+    bitmap_frame_.fill(SIZE_MAX);
+    num_stale_drops_ = 0;
+    num_duplicate_drops_ = 0;
+  }
+};
+
+/**
+ * @brief Tracks which frame currently owns each frame-window slot.
+ *
+ * All windowed buffers are indexed by their runtime frame-window slot
+ * (Config::FrameSlot()), so when processing falls behind by more than a
+ * window of frames a new frame
+ * silently overwrites the buffers of an unfinished one and the decode
+ * output is corrupted without any error. The master claims a frame's slot
+ * when its first packet arrives and releases it when the frame completes;
+ * a claim that finds the previous occupant still unreleased is counted as
+ * a window overrun. With kDebugFrameSlotOwnership set, doers additionally
+ * validate at task entry that their frame still owns its slot.
+ */
+class FrameSlotMonitor {
+ public:
+  /// Set the runtime frame window (Config::FrameWnd()) before any claims
+  /// are made. Defaults to the compile-time capacity kFrameWnd
+  static void SetWindow(size_t frame_wnd) { Window() = frame_wnd; }
+
+  /// Master only: record frame_id as the owner of its window slot.
+  /// Returns the unfinished frame that still owned the slot (a window
+  /// overrun, also counted), or SIZE_MAX if the slot was free.
+  static size_t Claim(size_t frame_id) {
+    const size_t prev = SlotFrames()
+                            .at(frame_id % Window())
+                            .exchange(frame_id, std::memory_order_relaxed);
+    if (prev != SIZE_MAX) {
+      OverrunCounter().fetch_add(1, std::memory_order_relaxed);
+    }
+    return prev;
+  }
+
+  /// Master only: mark the completed frame's slot as free. A slot already
+  /// recycled by a newer frame is left to its new owner.
+  static void Release(size_t frame_id) {
+    size_t expected = frame_id;
+    SlotFrames()
+        .at(frame_id % Window())
+        .compare_exchange_strong(expected, SIZE_MAX,
+                                 std::memory_order_relaxed);
+  }
+
+  /// Current owner of frame_id's window slot, or SIZE_MAX if the slot is
+  /// free. Lets late consumers of windowed buffers (e.g. the MAC thread's
+  /// zero-copy uplink handoff) distinguish a slot reclaimed by a newer
+  /// frame from one released normally at frame completion
+  static size_t Owner(size_t frame_id) {
+    return SlotFrames()
+        .at(frame_id % Window())
+        .load(std::memory_order_relaxed);
+  }
+
+  /// True if frame_id still owns its window slot (worker-side validation)
+  static bool Owns(size_t frame_id) {
+    return (SlotFrames().at(frame_id % Window()).load(
+                std::memory_order_relaxed) == frame_id);
+  }
+
+  /// Number of frames that claimed a slot still owned by an unfinished
+  /// frame
+  static size_t OverrunCount() {
+    return OverrunCounter().load(std::memory_order_relaxed);
+  }
+
+ private:
+  static size_t& Window() {
+    static size_t wnd = kFrameWnd;
+    return wnd;
+  }
+
+  static std::array<std::atomic<size_t>, kFrameWnd>& SlotFrames() {
+    static std::array<std::atomic<size_t>, kFrameWnd> slot_frames;
+    static const bool init = []() {
+      for (auto& slot : slot_frames) {
+        slot.store(SIZE_MAX, std::memory_order_relaxed);
+      }
+      return true;
+    }();
+    static_cast<void>(init);
+    return slot_frames;
+  }
+
+  static std::atomic<size_t>& OverrunCounter() {
+    static std::atomic<size_t> overruns(0);
+    return overruns;
   }
 };
 
@@ -348,6 +498,11 @@ class RxCounters {
  * @brief This class stores the counters corresponding to a frame.
  * Specifically, it contains a) the number of symbols per frame
  * and b) the number of tasks per symbol, per frame.
+ *
+ * Counters are keyed by frame_id and wrap at the compile-time capacity
+ * kFrameWnd rather than the runtime window: the in-flight frames span at
+ * most Config::FrameWnd() <= kFrameWnd distinct frames, so the wider wrap
+ * never aliases two live frames and the class needs no Config access.
  */
 class FrameCounters {
  public:
@@ -360,12 +515,25 @@ class FrameCounters {
     for (auto &frame : task_count_) {
       frame.fill(0);
     }
+    for (auto &frame : task_bitmap_) {
+      frame.fill(0);
+    }
   }
 
   void Reset(size_t frame_id) {
     const size_t frame_slot = (frame_id % kFrameWnd);
     this->symbol_count_.at(frame_slot) = 0;
     this->task_count_.at(frame_slot).fill(0);
+    this->task_bitmap_.at(frame_slot).fill(0);
+  }
+
+  /**
+   * @brief Update the number of tasks that complete a symbol without
+   * clearing any in-flight counts. Used when a RAN reconfiguration changes
+   * the per-symbol task budget at a frame boundary.
+   */
+  void SetMaxTaskCount(size_t max_task_count) {
+    this->max_task_count_ = max_task_count;
   }
 
   /**
@@ -389,6 +557,31 @@ class FrameCounters {
     return this->IsLastTask(frame_id, symbol_id);
   }
 
+  /**
+   * @brief Marks task unit [unit_id] of the input frame and symbol as
+   * complete in a per-symbol bitmap, and returns true when all units are
+   * done. One bit-set plus popcount per event, and unlike the plain
+   * counter a duplicate completion trips the assert instead of silently
+   * inflating the count. Usable when the completion event identifies its
+   * unit (e.g., the antenna id) and max_task_count fits one bitmap word,
+   * which per-antenna tracking always does while kMaxAntennas is 64
+   * @param frame_id The frame id of the task to mark
+   * @param symbol_id The symbol id of the task to mark
+   * @param unit_id The task unit (e.g., antenna id) to mark
+   */
+  bool CompleteTask(size_t frame_id, size_t symbol_id, size_t unit_id) {
+    assert(this->max_task_count_ <= 64);
+    assert(unit_id < this->max_task_count_);
+    const size_t frame_slot = (frame_id % kFrameWnd);
+    uint64_t &word = this->task_bitmap_.at(frame_slot).at(symbol_id);
+    const uint64_t bit = (uint64_t(1) << unit_id);
+    // This should never happen (duplicate completion of one task unit)
+    assert((word & bit) == 0);
+    word |= bit;
+    return (static_cast<size_t>(__builtin_popcountll(word)) ==
+            this->max_task_count_);
+  }
+
   /**
    * @brief Increments the symbol count for input frame
    * @param symbol_id The symbol id to increment
@@ -456,7 +649,12 @@ class FrameCounters {
   }
 
   size_t GetTaskCount(size_t frame_id, size_t symbol_id) const {
-    return this->task_count_.at(frame_id % kFrameWnd).at(symbol_id);
+    // A counter is driven through either the counting or the bitmap
+    // CompleteTask overload, so at most one of these terms is nonzero
+    const size_t frame_slot = (frame_id % kFrameWnd);
+    return this->task_count_.at(frame_slot).at(symbol_id) +
+           static_cast<size_t>(__builtin_popcountll(
+               this->task_bitmap_.at(frame_slot).at(symbol_id)));
   }
 
   inline size_t MaxSymbolCount() const { return this->max_symbol_count_; }
@@ -466,6 +664,9 @@ class FrameCounters {
   // task_count[i][j] is the number of tasks completed for
   // frame (i % kFrameWnd) and symbol j
   std::array<std::array<size_t, kMaxSymbols>, kFrameWnd> task_count_;
+  // task_bitmap[i][j] has one bit set per task unit completed for
+  // frame (i % kFrameWnd) and symbol j (bitmap CompleteTask overload)
+  std::array<std::array<uint64_t, kMaxSymbols>, kFrameWnd> task_bitmap_;
   // symbol_count[i] is the number of symbols completed for
   // frame (i % kFrameWnd)
   std::array<size_t, kFrameWnd> symbol_count_;
@@ -0,0 +1,74 @@
+/**
+ * @file build_profile.h
+ * @brief Optional compile-time config dimensions (BUILD_PROFILE in cmake)
+ */
+#ifndef BUILD_PROFILE_H_
+#define BUILD_PROFILE_H_
+
+#include <cstddef>
+
+#ifdef USE_BUILD_PROFILE
+#include "build_profile_generated.h"
+#endif
+
+/// Hot loops read their dimensions through these accessors. Without a
+/// build profile they pass the runtime config value through untouched.
+/// With one (cmake -DBUILD_PROFILE=<tddconfig.json>) they return the
+/// frozen constant instead, so the compiler can constant-fold, unroll,
+/// and strength-reduce the doers' inner loops for that one deployment
+/// shape. Matches() lets startup refuse a config that differs from the
+/// shape the binary was specialized for.
+namespace BuildProfile {
+#ifdef USE_BUILD_PROFILE
+static constexpr bool kEnabled = true;
+static constexpr size_t kBsAntNum = BUILD_PROFILE_BS_ANT_NUM;
+static constexpr size_t kUeAntNum = BUILD_PROFILE_UE_ANT_NUM;
+static constexpr size_t kOfdmCaNum = BUILD_PROFILE_OFDM_CA_NUM;
+static constexpr size_t kOfdmDataNum = BUILD_PROFILE_OFDM_DATA_NUM;
+static constexpr size_t kModOrderBits = BUILD_PROFILE_MOD_ORDER_BITS;
+
+static constexpr size_t BsAntNum(size_t /*runtime_value*/) {
+  return kBsAntNum;
+}
+static constexpr size_t UeAntNum(size_t /*runtime_value*/) {
+  return kUeAntNum;
+}
+static constexpr size_t OfdmCaNum(size_t /*runtime_value*/) {
+  return kOfdmCaNum;
+}
+static constexpr size_t OfdmDataNum(size_t /*runtime_value*/) {
+  return kOfdmDataNum;
+}
+static constexpr size_t ModOrderBits(size_t /*runtime_value*/) {
+  return kModOrderBits;
+}
+
+static inline bool Matches(size_t bs_ant_num, size_t ue_ant_num,
+                           size_t ofdm_ca_num, size_t ofdm_data_num,
+                           size_t mod_order_bits) {
+  return (bs_ant_num == kBsAntNum) && (ue_ant_num == kUeAntNum) &&
+         (ofdm_ca_num == kOfdmCaNum) && (ofdm_data_num == kOfdmDataNum) &&
+         (mod_order_bits == kModOrderBits);
+}
+#else
+static constexpr bool kEnabled = false;
+
+static inline size_t BsAntNum(size_t runtime_value) { return runtime_value; }
+static inline size_t UeAntNum(size_t runtime_value) { return runtime_value; }
+static inline size_t OfdmCaNum(size_t runtime_value) { return runtime_value; }
+static inline size_t OfdmDataNum(size_t runtime_value) {
+  return runtime_value;
+}
+static inline size_t ModOrderBits(size_t runtime_value) {
+  return runtime_value;
+}
+
+static inline bool Matches(size_t /*bs_ant_num*/, size_t /*ue_ant_num*/,
+                           size_t /*ofdm_ca_num*/, size_t /*ofdm_data_num*/,
+                           size_t /*mod_order_bits*/) {
+  return true;
+}
+#endif  // USE_BUILD_PROFILE
+}  // namespace BuildProfile
+
+#endif  // BUILD_PROFILE_H_
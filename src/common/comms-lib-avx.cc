@@ -10,6 +10,7 @@
 
 #include <immintrin.h>
 
+#include <cstring>
 #include <iomanip>
 #include <queue>
 
@@ -106,6 +107,110 @@ int CommsLib::FindBeaconAvx(const std::vector<std::complex<float>>& iq,
   return valid_peaks.back();
 }
 
+/// Windowed variant for beacon tracking: correlate only the region around
+/// an expected peak position instead of the whole frame. Returns a peak
+/// index into the full iq vector (same semantics as the full scan), or -1
+/// when no peak clears the threshold inside the window
+int CommsLib::FindBeaconAvx(const std::vector<std::complex<float>>& iq,
+                            const std::vector<std::complex<float>>& seq,
+                            size_t expected_index, size_t search_window) {
+  const size_t seq_len = seq.size();
+  // Lead-in ahead of the earliest candidate peak so the correlator, the
+  // (seq_len-) delayed auto-correlation, and the moving-sum threshold all
+  // have full history where peaks are accepted
+  const size_t lead = 4 * seq_len;
+
+  const size_t window_start =
+      (expected_index > search_window) ? (expected_index - search_window) : 0;
+  const size_t region_start = (window_start > lead) ? (window_start - lead) : 0;
+  const size_t region_end =
+      std::min(iq.size(), expected_index + search_window + 1);
+  if ((region_end <= region_start) ||
+      ((region_end - region_start) < (2 * seq_len))) {
+    return -1;
+  }
+
+  const std::vector<std::complex<float>> region(iq.begin() + region_start,
+                                                iq.begin() + region_end);
+
+  auto gold_corr_avx = CommsLib::CorrelateAvx(region, seq);
+  auto gold_auto_corr = CommsLib::AutoCorrMultAvx(gold_corr_avx, seq_len);
+  auto gold_corr_avx_2 = CommsLib::Abs2Avx(gold_auto_corr);
+
+  std::vector<float> consts1(seq_len, 1);
+  auto corr_abs_avx = CommsLib::Abs2Avx(gold_corr_avx);
+  auto thresh_avx = CommsLib::CorrelateAvxS(corr_abs_avx, consts1);
+
+  // Accept only peaks inside the requested window; the lead-in indices
+  // carry startup transients
+  int best_peak = -1;
+  for (size_t i = 0; i < gold_corr_avx_2.size(); i++) {
+    const size_t global_index = region_start + i;
+    if ((global_index >= window_start) &&
+        (global_index <= (expected_index + search_window)) &&
+        (gold_corr_avx_2[i] > thresh_avx[i])) {
+      best_peak = global_index;
+    }
+  }
+  return best_peak;
+}
+
+/// Scratch variant of the windowed beacon tracker: same search and peak
+/// semantics, but every intermediate lives in the caller's BeaconScratch,
+/// so a sync loop that reuses one scratch does no per-call allocation
+/// once the vectors have grown to size
+int CommsLib::FindBeaconAvx(const std::vector<std::complex<float>>& iq,
+                            const std::vector<std::complex<float>>& seq,
+                            size_t expected_index, size_t search_window,
+                            BeaconScratch& scratch) {
+  const size_t seq_len = seq.size();
+  const size_t lead = 4 * seq_len;
+
+  const size_t window_start =
+      (expected_index > search_window) ? (expected_index - search_window) : 0;
+  const size_t region_start = (window_start > lead) ? (window_start - lead) : 0;
+  const size_t region_end =
+      std::min(iq.size(), expected_index + search_window + 1);
+  if ((region_end <= region_start) ||
+      ((region_end - region_start) < (2 * seq_len))) {
+    return -1;
+  }
+  const size_t region_len = region_end - region_start;
+  scratch.region.assign(iq.begin() + region_start, iq.begin() + region_end);
+
+  const size_t corr_len = region_len + seq_len - 1;
+  scratch.padded.resize(corr_len + 8);
+  scratch.corr.resize(corr_len + 8);
+  CorrelateAvx(scratch.region.data(), region_len, seq.data(), seq_len,
+               scratch.padded.data(), scratch.corr.data());
+
+  scratch.delayed.resize(corr_len);
+  scratch.auto_corr.resize(corr_len);
+  AutoCorrMultAvx(scratch.corr.data(), corr_len, seq_len, true,
+                  scratch.delayed.data(), scratch.auto_corr.data());
+  scratch.auto_corr_abs2.resize(corr_len);
+  Abs2Avx(scratch.auto_corr.data(), corr_len, scratch.auto_corr_abs2.data());
+
+  scratch.ones.assign(seq_len, 1.0f);
+  scratch.corr_abs2.resize(corr_len);
+  Abs2Avx(scratch.corr.data(), corr_len, scratch.corr_abs2.data());
+  scratch.padded_s.resize(corr_len + seq_len + 8);
+  scratch.thresh.resize(corr_len + 8);
+  CorrelateAvxS(scratch.corr_abs2.data(), corr_len, scratch.ones.data(),
+                seq_len, scratch.padded_s.data(), scratch.thresh.data());
+
+  int best_peak = -1;
+  for (size_t i = 0; i < corr_len; i++) {
+    const size_t global_index = region_start + i;
+    if ((global_index >= window_start) &&
+        (global_index <= (expected_index + search_window)) &&
+        (scratch.auto_corr_abs2[i] > scratch.thresh[i])) {
+      best_peak = global_index;
+    }
+  }
+  return best_peak;
+}
+
 static inline __m256i M256ComplexCs16Mult(__m256i data1, __m256i data2,
                                           bool conj) {
   const __m256i neg0 = _mm256_set1_epi32(0xFFFF0000);
@@ -265,17 +370,13 @@ __m512 CommsLib::M512ComplexCf32Mult(__m512 data1, __m512 data2, bool conj) {
 }
 #endif
 
-std::vector<std::complex<float>> CommsLib::ComplexMultAvx(
-    std::vector<std::complex<float>> const& f,
-    std::vector<std::complex<float>> const& g, const bool conj) {
-  size_t length1 = 2 * g.size();
-  size_t length0 = 2 * f.size();
-  size_t res_len = std::min(length0, length1);
-
-  const auto* in0 = reinterpret_cast<const float*>(f.data());
-  const auto* in1 = reinterpret_cast<const float*>(g.data());
-  std::vector<std::complex<float>> out(res_len / 2, 0);
-  auto* outf = reinterpret_cast<float*>(out.data());
+void CommsLib::ComplexMultAvx(const std::complex<float>* f,
+                              const std::complex<float>* g, size_t len,
+                              bool conj, std::complex<float>* out) {
+  const size_t res_len = 2 * len;
+  const auto* in0 = reinterpret_cast<const float*>(f);
+  const auto* in1 = reinterpret_cast<const float*>(g);
+  auto* outf = reinterpret_cast<float*>(out);
 
   __m256 data0 __attribute__((aligned(ALIGNMENT)));
   __m256 data1 __attribute__((aligned(ALIGNMENT)));
@@ -293,41 +394,37 @@ std::vector<std::complex<float>> CommsLib::ComplexMultAvx(
   for (size_t i = rem; i < res_len; i += 2) {
     out[i / 2] = f[i / 2] * (conj ? std::conj(g[i / 2]) : g[i / 2]);
   }
+}
 
+std::vector<std::complex<float>> CommsLib::ComplexMultAvx(
+    std::vector<std::complex<float>> const& f,
+    std::vector<std::complex<float>> const& g, const bool conj) {
+  size_t res_len = std::min(f.size(), g.size());
+  std::vector<std::complex<float>> out(res_len, 0);
+  ComplexMultAvx(f.data(), g.data(), res_len, conj, out.data());
   return out;
 }
 
+void CommsLib::AutoCorrMultAvx(const std::complex<float>* f, size_t len,
+                               size_t dly, bool conj,
+                               std::complex<float>* delayed_scratch,
+                               std::complex<float>* out) {
+  // delayed_scratch = f delayed by dly samples with zero fill, so the
+  // product below is f[i] * conj(f[i - dly])
+  for (size_t i = 0; i < dly; i++) {
+    delayed_scratch[i] = 0;
+  }
+  std::memcpy(&delayed_scratch[dly], f,
+              (len - dly) * sizeof(std::complex<float>));
+  ComplexMultAvx(f, delayed_scratch, len, conj, out);
+}
+
 std::vector<std::complex<float>> CommsLib::AutoCorrMultAvx(
     std::vector<std::complex<float>> const& f, const int dly, const bool conj) {
-#if 0
-    size_t length = 2 * f.size();
-    float* in = (float*)(f.data());
-    std::vector<std::complex<float>> out(length / 2, 0);
-    float* outf = (float*)(out.data());
-    int d = 2 * dly;
-
-    __m256 data1 __attribute__((aligned(ALIGNMENT)));
-    __m256 data2 __attribute__((aligned(ALIGNMENT)));
-    __m256 res __attribute__((aligned(ALIGNMENT)));
-
-    size_t rem = length - (length % AVX_PACKED_SP);
-    if (rem > 0) {
-        for (size_t i = d; i < rem; i += AVX_PACKED_SP) {
-            data1 = _mm256_loadu_ps(in + i);
-            data2 = _mm256_loadu_ps(in + i - d);
-            res = __m256_complex_cf32_mult(data1, data2, conj);
-            _mm256_storeu_ps(outf + i, res);
-        }
-    }
-    for (size_t i = rem; i < length; i += 2)
-        out[i / 2] = f[i / 2] * (conj ? std::conj(f[i / 2 - dly]) : f[i / 2 - dly]);
-    return out;
-#else
-  std::vector<std::complex<float>> g(f.begin(), f.end() - dly);
-  std::vector<std::complex<float>> z(dly, 0);
-  g.insert(g.begin(), z.begin(), z.end());
-  return CommsLib::ComplexMultAvx(f, g, conj);
-#endif
+  std::vector<std::complex<float>> delayed(f.size());
+  std::vector<std::complex<float>> out(f.size(), 0);
+  AutoCorrMultAvx(f.data(), f.size(), dly, conj, delayed.data(), out.data());
+  return out;
 }
 
 std::vector<std::complex<int16_t>> CommsLib::AutoCorrMultAvx(
@@ -339,12 +436,10 @@ std::vector<std::complex<int16_t>> CommsLib::AutoCorrMultAvx(
   return CommsLib::ComplexMultAvx(f, g, conj);
 }
 
-std::vector<float> CommsLib::Abs2Avx(
-    std::vector<std::complex<float>> const& f) {
-  size_t length = 2 * f.size();
-  const auto* in = reinterpret_cast<const float*>(f.data());
-  std::vector<float> out(length / 2, 0);
-  auto* outf = static_cast<float*>(out.data());
+void CommsLib::Abs2Avx(const std::complex<float>* f, size_t len, float* out) {
+  const size_t length = 2 * len;
+  const auto* in = reinterpret_cast<const float*>(f);
+  auto* outf = out;
 
   __m256 data1 __attribute__((aligned(ALIGNMENT)));
   __m256 data2 __attribute__((aligned(ALIGNMENT)));
@@ -373,6 +468,12 @@ std::vector<float> CommsLib::Abs2Avx(
   for (size_t i = rem; i < length; i += 2) {
     outf[i / 2] = in[i] * in[i] + in[i + 1] * in[i + 1];
   }
+}
+
+std::vector<float> CommsLib::Abs2Avx(
+    std::vector<std::complex<float>> const& f) {
+  std::vector<float> out(f.size(), 0);
+  Abs2Avx(f.data(), f.size(), out.data());
   return out;
 }
 
@@ -438,95 +539,167 @@ std::vector<std::complex<int16_t>> CommsLib::CorrelateAvx(
   return out;
 }
 
-std::vector<std::complex<float>> CommsLib::CorrelateAvx(
-    std::vector<std::complex<float>> const& f,
-    std::vector<std::complex<float>> const& g) {
-  // assuming length0 is larger or equal to length1
-  size_t length0 = f.size();
-  size_t length1 = g.size();
-
-  std::vector<std::complex<float>> in(length0 + length1 - 1, 0);
-  // std::copy(f.begin(), f.end(), std::back_inserter(in));
-  // in.insert(in.end(), f.begin(), f.end());
-  for (size_t i = length1 - 1; i < in.size(); i++) {
-    size_t j = i - length1 + 1;
-    in[i] = f[j];
+void CommsLib::CorrelateAvx(const std::complex<float>* f, size_t f_len,
+                            const std::complex<float>* g, size_t g_len,
+                            std::complex<float>* padded_scratch,
+                            std::complex<float>* out) {
+  // assuming f_len is larger or equal to g_len
+  const size_t length = f_len + g_len - 1;
+
+  // padded_scratch = f with a (g_len - 1)-sample zero lead-in, so the
+  // correlator has full history at index 0
+  for (size_t i = 0; i < (g_len - 1); i++) {
+    padded_scratch[i] = 0;
   }
-  size_t length = in.size();
+  std::memcpy(&padded_scratch[g_len - 1], f,
+              f_len * sizeof(std::complex<float>));
 
-  const auto* in0 = reinterpret_cast<const float*>(in.data());
-  const auto* in1 = reinterpret_cast<const float*>(g.data());
-  std::vector<std::complex<float>> out(length, 0);
-  auto* outf = reinterpret_cast<float*>(out.data());
+  const auto* in0 = reinterpret_cast<const float*>(padded_scratch);
+  const auto* in1 = reinterpret_cast<const float*>(g);
+  auto* outf = reinterpret_cast<float*>(out);
+  // The SIMD loops cover [0, simd_bound); zero the remainder so the output
+  // matches the zero-initialized vector version
+  const size_t simd_bound = 2 * (length - g_len);
+  std::memset(outf + simd_bound, 0,
+              ((2 * length) - simd_bound) * sizeof(float));
 
-  __m256 seq_samp[length1] __attribute__((aligned(ALIGNMENT)));
+  __m256 seq_samp[g_len] __attribute__((aligned(ALIGNMENT)));
 
-  for (size_t i = 0; i < length1; i++) {
+  for (size_t i = 0; i < g_len; i++) {
     __m256 samp_i = _mm256_broadcast_ss(&in1[i * 2]);
     __m256 samp_q = _mm256_broadcast_ss(&in1[i * 2 + 1]);
     seq_samp[i] = _mm256_shuffle_ps(samp_i, samp_q, 0x0);
     seq_samp[i] = _mm256_permute_ps(seq_samp[i], 0xd8);
   }
 
-  for (size_t i = 0; i < 2 * (length - length1); i += AVX_PACKED_SP) {
+  size_t i = 0;
+#ifdef __AVX512F__
+  // Eight complex floats per iteration when the build targets AVX-512;
+  // the AVX2 loop below picks up the remainder
+  __m512 seq_samp_wide[g_len] __attribute__((aligned(64)));
+  for (size_t k = 0; k < g_len; k++) {
+    seq_samp_wide[k] = _mm512_insertf32x8(
+        _mm512_castps256_ps512(seq_samp[k]), seq_samp[k], 1);
+  }
+  for (; (i + (2 * AVX_PACKED_SP)) <= simd_bound; i += (2 * AVX_PACKED_SP)) {
+    __m512 accm = _mm512_setzero_ps();
+    for (size_t j = 0; j < g_len; j++) {
+      __m512 data = _mm512_loadu_ps(in0 + i + j * 2);
+      __m512 prod = M512ComplexCf32Mult(data, seq_samp_wide[j], true);
+      accm = _mm512_add_ps(prod, accm);
+    }
+    _mm512_storeu_ps(outf + i, accm);
+  }
+#endif
+
+  for (; i < simd_bound; i += AVX_PACKED_SP) {
     __m256 accm = _mm256_setzero_ps();
-    for (size_t j = 0; j < length1; j++) {
+    for (size_t j = 0; j < g_len; j++) {
       __m256 data = _mm256_loadu_ps(in0 + i + j * 2);
       __m256 prod = M256ComplexCf32Mult(data, seq_samp[j], true);
       accm = _mm256_add_ps(prod, accm);
     }
     _mm256_storeu_ps(outf + i, accm);
   }
-  return out;
 }
 
-std::vector<float> CommsLib::CorrelateAvxS(std::vector<float> const& f,
-                                           std::vector<float> const& g) {
-  size_t length_f = f.size();
-  size_t length_g = g.size();
-  assert(length_f > length_g);
+std::vector<std::complex<float>> CommsLib::CorrelateAvx(
+    std::vector<std::complex<float>> const& f,
+    std::vector<std::complex<float>> const& g) {
+  const size_t length = f.size() + g.size() - 1;
+  // 8 elements of slack for the SIMD load/store overshoot (see header)
+  std::vector<std::complex<float>> padded(length + 8);
+  std::vector<std::complex<float>> out(length + 8, 0);
+  CorrelateAvx(f.data(), f.size(), g.data(), g.size(), padded.data(),
+               out.data());
+  out.resize(length);
+  return out;
+}
 
-  std::vector<float> in(length_f + length_g, 0);
-  size_t length = in.size();
+void CommsLib::CorrelateAvxS(const float* f, size_t f_len, const float* g,
+                             size_t g_len, float* padded_scratch, float* out) {
+  assert(f_len > g_len);
+  const size_t length = f_len + g_len;
 
-  // MLPD_TRACE("correlate_avx_s len_f: %zu, len_g: %zu, length: %zu\n",
-  // length_f, length_g, length); in[length_g:length] = f[0:length_f]
-  for (size_t i = length_g; i < length; i++) {
-    size_t j = i - length_g;
-    in.at(i) = f.at(j);
+  // padded_scratch[g_len:length] = f[0:f_len], zero lead-in ahead of it
+  for (size_t i = 0; i < g_len; i++) {
+    padded_scratch[i] = 0;
   }
-
-  float* in_data_ptr = in.data();
-  const float* in_g = g.data();
+  std::memcpy(&padded_scratch[g_len], f, f_len * sizeof(float));
 
   __m256 data __attribute__((aligned(ALIGNMENT)));
   __m256 prod __attribute__((aligned(ALIGNMENT)));
   __m256 accm __attribute__((aligned(ALIGNMENT)));
-  __m256 seq_samp[length_g] __attribute__((aligned(ALIGNMENT)));
+  __m256 seq_samp[g_len] __attribute__((aligned(ALIGNMENT)));
 
   // Repeat the kernel across the vector
-  for (size_t i = 0; i < length_g; i++) {
-    seq_samp[i] = _mm256_broadcast_ss(&in_g[i]);
+  for (size_t i = 0; i < g_len; i++) {
+    seq_samp[i] = _mm256_broadcast_ss(&g[i]);
   }
 
   static const size_t kKAddressIncrement = ALIGNMENT / sizeof(float);
   static_assert((ALIGNMENT % sizeof(float)) == 0,
                 "Address alignment not correct");
 
-  size_t padding = kKAddressIncrement - (length_f % kKAddressIncrement);
-  std::vector<float> out(length_f + padding);
+  const size_t padding = kKAddressIncrement - (f_len % kKAddressIncrement);
+  const size_t out_len = f_len + padding;
 
   // Verify no memory overruns
-  assert((out.size() % kKAddressIncrement) == 0);
-  for (size_t i = 0; i < (out.size() - 1); i += kKAddressIncrement) {
+  assert((out_len % kKAddressIncrement) == 0);
+  for (size_t i = 0; i < (out_len - 1); i += kKAddressIncrement) {
     accm = _mm256_setzero_ps();
-    for (size_t j = 0; j < length_g; j++) {
-      data = _mm256_loadu_ps(in_data_ptr + i + j);
+    for (size_t j = 0; j < g_len; j++) {
+      data = _mm256_loadu_ps(padded_scratch + i + j);
       prod = _mm256_mul_ps(data, seq_samp[j]);
       accm = _mm256_add_ps(prod, accm);
     }
-    _mm256_storeu_ps(out.data() + i, accm);
+    _mm256_storeu_ps(out + i, accm);
   }
-  out.resize(length_f);
+}
+
+std::vector<float> CommsLib::CorrelateAvxS(std::vector<float> const& f,
+                                           std::vector<float> const& g) {
+  static const size_t kKAddressIncrement = ALIGNMENT / sizeof(float);
+  const size_t padding = kKAddressIncrement - (f.size() % kKAddressIncrement);
+  std::vector<float> padded(f.size() + g.size() + kKAddressIncrement);
+  std::vector<float> out(f.size() + padding);
+  CorrelateAvxS(f.data(), f.size(), g.data(), g.size(), padded.data(),
+                out.data());
+  out.resize(f.size());
   return out;
 }
+
+/// Equalize a contiguous run of downlink subcarriers against the stored
+/// CSI: out[i] = (y[i] * conj(csi[i]) / |csi[i]|^2) * phase_corr, four
+/// complex floats per AVX2 iteration with a scalar tail. The divide-free
+/// conjugate-multiply form matches y / csi up to rounding
+void CommsLib::EqualizeAvx(const std::complex<float>* fft_in,
+                           const std::complex<float>* csi,
+                           std::complex<float>* equal_out, size_t num_sc,
+                           std::complex<float> phase_corr) {
+  const __m256 phc =
+      _mm256_setr_ps(phase_corr.real(), phase_corr.imag(), phase_corr.real(),
+                     phase_corr.imag(), phase_corr.real(), phase_corr.imag(),
+                     phase_corr.real(), phase_corr.imag());
+
+  size_t sc = 0;
+  for (; (sc + AVX_PACKED_CS / 2) <= num_sc; sc += AVX_PACKED_CS / 2) {
+    const __m256 y =
+        _mm256_loadu_ps(reinterpret_cast<const float*>(&fft_in[sc]));
+    const __m256 h = _mm256_loadu_ps(reinterpret_cast<const float*>(&csi[sc]));
+
+    // y * conj(h)
+    const __m256 num = M256ComplexCf32Mult(y, h, true);
+    // |h|^2 replicated into both slots of each complex lane
+    const __m256 h_sq = _mm256_mul_ps(h, h);
+    const __m256 h_norm = _mm256_add_ps(h_sq, _mm256_permute_ps(h_sq, 0xb1));
+
+    __m256 eq = _mm256_div_ps(num, h_norm);
+    eq = M256ComplexCf32Mult(eq, phc, false);
+    _mm256_storeu_ps(reinterpret_cast<float*>(&equal_out[sc]), eq);
+  }
+  for (; sc < num_sc; sc++) {
+    equal_out[sc] =
+        (fft_in[sc] * std::conj(csi[sc]) / std::norm(csi[sc])) * phase_corr;
+  }
+}
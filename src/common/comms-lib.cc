@@ -46,6 +46,38 @@ size_t CommsLib::FindPilotSeq(std::vector<std::complex<float>> iq,
   return best_peak;
 }
 
+size_t CommsLib::FindPilotSeq(std::vector<std::complex<float>> iq,
+                              std::vector<std::complex<float>> pilot,
+                              size_t seq_len, float& frac_offset) {
+  std::vector<std::complex<float>> pilot_conj;
+  for (size_t i = 0; i < seq_len; i++) {
+    pilot_conj.push_back(std::conj(pilot[seq_len - i - 1]));
+  }
+
+  auto iq_sign = CommsLib::Csign(std::move(iq));
+  auto pilot_corr = CommsLib::Convolve(iq_sign, pilot_conj);
+
+  auto best_peak = std::max_element(pilot_corr.begin(), pilot_corr.end()) -
+                   pilot_corr.begin();
+
+  // Fit a parabola through the correlation magnitudes at the peak and its
+  // two neighbors; its vertex gives the fractional sample offset
+  frac_offset = 0.0f;
+  if ((best_peak > 0) &&
+      (best_peak + 1 < static_cast<long>(pilot_corr.size()))) {
+    float y0 = pilot_corr.at(best_peak - 1);
+    float y1 = pilot_corr.at(best_peak);
+    float y2 = pilot_corr.at(best_peak + 1);
+    float denom = y0 - (2 * y1) + y2;
+    if (std::abs(denom) > 0) {
+      frac_offset = 0.5f * (y0 - y2) / denom;
+      // guard against flat correlation plateaus
+      frac_offset = std::max(-0.5f, std::min(0.5f, frac_offset));
+    }
+  }
+  return best_peak;
+}
+
 int CommsLib::FindLts(std::vector<std::complex<double>> iq, int seqLen) {
   /*
    * Find 802.11-based LTS (Long Training Sequence)
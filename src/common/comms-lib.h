@@ -60,6 +60,12 @@ class CommsLib {
   static size_t FindPilotSeq(std::vector<std::complex<float>> iq,
                              std::vector<std::complex<float>> pilot,
                              size_t seq_len);
+  // Same peak search, but also estimates the residual sub-sample offset in
+  // [-0.5, 0.5] by parabolic interpolation of the correlation magnitudes
+  // around the integer peak
+  static size_t FindPilotSeq(std::vector<std::complex<float>> iq,
+                             std::vector<std::complex<float>> pilot,
+                             size_t seq_len, float& frac_offset);
   static int FindLts(std::vector<std::complex<double>> iq, int seqLen);
   template <typename T>
   static std::vector<T> Convolve(std::vector<std::complex<T>> const& f,
@@ -105,6 +111,30 @@ class CommsLib {
   }
   static int FindBeaconAvx(const std::vector<std::complex<float>>& iq,
                            const std::vector<std::complex<float>>& seq);
+  static int FindBeaconAvx(const std::vector<std::complex<float>>& iq,
+                           const std::vector<std::complex<float>>& seq,
+                           size_t expected_index, size_t search_window);
+
+  /// Reusable working set for the scratch variant of the windowed
+  /// FindBeaconAvx(). The vectors grow to the required sizes on first use
+  /// and are reused afterwards, so a caller that keeps one of these per
+  /// sync loop pays no per-call heap traffic in steady state.
+  struct BeaconScratch {
+    std::vector<std::complex<float>> region;
+    std::vector<std::complex<float>> padded;
+    std::vector<std::complex<float>> corr;
+    std::vector<std::complex<float>> delayed;
+    std::vector<std::complex<float>> auto_corr;
+    std::vector<float> auto_corr_abs2;
+    std::vector<float> corr_abs2;
+    std::vector<float> thresh;
+    std::vector<float> ones;
+    std::vector<float> padded_s;
+  };
+  static int FindBeaconAvx(const std::vector<std::complex<float>>& iq,
+                           const std::vector<std::complex<float>>& seq,
+                           size_t expected_index, size_t search_window,
+                           BeaconScratch& scratch);
   static std::vector<float> CorrelateAvxS(std::vector<float> const& f,
                                           std::vector<float> const& g);
   static std::vector<float> Abs2Avx(std::vector<std::complex<float>> const& f);
@@ -129,7 +159,36 @@ class CommsLib {
       std::vector<std::complex<int16_t>> const& f,
       std::vector<std::complex<int16_t>> const& g);
 
+  // Allocation-free pointer cores behind the vector helpers above. The
+  // vector versions remain the convenient (and test-covered) interface;
+  // latency-sensitive sync paths call these with caller-provided scratch.
+  // Capacities: padded_scratch and out need 8 elements of slack past the
+  // documented lengths to absorb the SIMD store/load overshoot.
+  /// out and padded_scratch: capacity f_len + g_len - 1 (+ slack)
+  static void CorrelateAvx(const std::complex<float>* f, size_t f_len,
+                           const std::complex<float>* g, size_t g_len,
+                           std::complex<float>* padded_scratch,
+                           std::complex<float>* out);
+  /// out: capacity len
+  static void Abs2Avx(const std::complex<float>* f, size_t len, float* out);
+  /// out: capacity len
+  static void ComplexMultAvx(const std::complex<float>* f,
+                             const std::complex<float>* g, size_t len,
+                             bool conj, std::complex<float>* out);
+  /// delayed_scratch and out: capacity len
+  static void AutoCorrMultAvx(const std::complex<float>* f, size_t len,
+                              size_t dly, bool conj,
+                              std::complex<float>* delayed_scratch,
+                              std::complex<float>* out);
+  /// padded_scratch: capacity f_len + g_len; out: capacity f_len (+ slack)
+  static void CorrelateAvxS(const float* f, size_t f_len, const float* g,
+                            size_t g_len, float* padded_scratch, float* out);
+
   static __m256 M256ComplexCf32Mult(__m256 data1, __m256 data2, bool conj);
+  static void EqualizeAvx(const std::complex<float>* fft_in,
+                          const std::complex<float>* csi,
+                          std::complex<float>* equal_out, size_t num_sc,
+                          std::complex<float> phase_corr);
 #ifdef __AVX512F__
   static __m512 M512ComplexCf32Mult(__m512 data1, __m512 data2, bool conj);
 #endif
@@ -12,6 +12,7 @@
 #include <boost/range/algorithm/count.hpp>
 
 #include "logger.h"
+#include "mmap_reader.h"
 #include "nlohmann/json.hpp"
 #include "scrambler.h"
 #include "utils_ldpc.h"
@@ -160,6 +161,9 @@ Config::Config(const std::string& jsonfile)
   rx_gain_b_ = tdd_conf.value("rx_gain_b", 20);
   calib_tx_gain_a_ = tdd_conf.value("calib_tx_gain_a", tx_gain_a_);
   calib_tx_gain_b_ = tdd_conf.value("calib_tx_gain_b", tx_gain_b_);
+  agc_enabled_ = tdd_conf.value("agc_enabled", false);
+  agc_target_rssi_db_ = tdd_conf.value("agc_target_rssi_db", -20.0);
+  agc_hysteresis_db_ = tdd_conf.value("agc_hysteresis_db", 3.0);
 
   auto gain_tx_json_a = tdd_conf.value("ue_tx_gain_a", json::array());
   if (gain_tx_json_a.empty()) {
@@ -205,8 +209,18 @@ Config::Config(const std::string& jsonfile)
   init_calib_repeat_ = tdd_conf.value("init_calib_repeat", 0);
 
   modulation_ = tdd_conf.value("modulation", "16QAM");
+  hard_demod_ = tdd_conf.value("hard_demod", false);
 
   bs_server_addr_ = tdd_conf.value("bs_server_addr", "127.0.0.1");
+  auto bs_addr_list_json = tdd_conf.value("bs_server_addr_list", json::array());
+  if (bs_addr_list_json.empty()) {
+    bs_server_addr_list_.resize(num_cells_, bs_server_addr_);
+  } else {
+    RtAssert(bs_addr_list_json.size() == num_cells_,
+             "bs_server_addr_list size must be same as the number of cells!");
+    bs_server_addr_list_.assign(bs_addr_list_json.begin(),
+                                bs_addr_list_json.end());
+  }
   bs_rru_addr_ = tdd_conf.value("bs_rru_addr", "127.0.0.1");
   ue_server_addr_ = tdd_conf.value("ue_server_addr", "127.0.0.1");
   mac_remote_addr_ = tdd_conf.value("mac_remote_addr", "127.0.0.1");
@@ -217,6 +231,23 @@ Config::Config(const std::string& jsonfile)
 
   dpdk_num_ports_ = tdd_conf.value("dpdk_num_ports", 1);
   dpdk_port_offset_ = tdd_conf.value("dpdk_port_offset", 0);
+  dpdk_rss_ = tdd_conf.value("dpdk_rss", false);
+  tx_pacing_ = tdd_conf.value("tx_pacing", false);
+  xdp_transport_ = tdd_conf.value("xdp_transport", false);
+  xdp_if_ = tdd_conf.value("xdp_if", "");
+  if (xdp_transport_ == true) {
+    RtAssert(xdp_if_.empty() == false,
+             "xdp_transport requires xdp_if (interface name)");
+  }
+  rx_epoch_reclaim_ = tdd_conf.value("rx_epoch_reclaim", false);
+  capture_spool_ = tdd_conf.value("capture_spool", "");
+  capture_spool_bytes_ =
+      tdd_conf.value("capture_spool_bytes", 1024UL * 1024 * 1024);
+  replay_spool_ = tdd_conf.value("replay_spool", "");
+  replay_speedup_ = tdd_conf.value("replay_speedup", 1.0);
+  RtAssert(replay_speedup_ > 0.0, "replay_speedup must be positive");
+  RtAssert(capture_spool_.empty() || replay_spool_.empty(),
+           "capture_spool and replay_spool are mutually exclusive");
 
   ue_mac_tx_port_ = tdd_conf.value("ue_mac_tx_port", kMacUserRemotePort);
   ue_mac_rx_port_ = tdd_conf.value("ue_mac_rx_port", kMacUserLocalPort);
@@ -246,6 +277,80 @@ Config::Config(const std::string& jsonfile)
   ofdm_data_stop_ = ofdm_data_start_ + ofdm_data_num_;
 
   bigstation_mode_ = tdd_conf.value("bigstation_mode", false);
+  work_steal_sched_ = tdd_conf.value("work_steal_sched", false);
+  numa_bind_ = tdd_conf.value("numa_bind", false);
+  topology_pinning_ = tdd_conf.value("topology_pinning", false);
+  prefault_buffers_ = tdd_conf.value("prefault_buffers", false);
+  trace_file_ = tdd_conf.value("trace_file", std::string());
+  trace_span_frame_start_ = tdd_conf.value("trace_span_frame_start", 0);
+  trace_span_frame_count_ = tdd_conf.value("trace_span_frame_count", 0);
+  calib_snapshot_path_ = tdd_conf.value("calib_snapshot_path", std::string());
+  calib_snapshot_max_age_secs_ =
+      tdd_conf.value("calib_snapshot_max_age_secs", 600);
+  telemetry_addr_ = tdd_conf.value("telemetry_addr", std::string());
+  telemetry_port_ = tdd_conf.value("telemetry_port", 9500);
+  telemetry_frame_interval_ = tdd_conf.value("telemetry_frame_interval", 100);
+  RtAssert(telemetry_frame_interval_ > 0,
+           "telemetry_frame_interval must be positive");
+  decode_offload_ = tdd_conf.value("decode_offload", false);
+  decode_offload_remote_addr_ =
+      tdd_conf.value("decode_offload_remote_addr", "127.0.0.1");
+  decode_offload_remote_port_ =
+      tdd_conf.value("decode_offload_remote_port", 9600);
+  decode_offload_local_port_ =
+      tdd_conf.value("decode_offload_local_port", 9650);
+  decode_offload_thread_num_ =
+      tdd_conf.value("decode_offload_thread_num", 1);
+  RtAssert(decode_offload_thread_num_ > 0,
+           "decode_offload_thread_num must be positive");
+  sc_shard_num_ = tdd_conf.value("sc_shard_num", 1);
+  sc_shard_index_ = tdd_conf.value("sc_shard_index", 0);
+  sc_shard_merge_addr_ = tdd_conf.value("sc_shard_merge_addr", "127.0.0.1");
+  sc_shard_merge_port_ = tdd_conf.value("sc_shard_merge_port", 9700);
+  RtAssert(sc_shard_num_ > 0, "sc_shard_num must be positive");
+  RtAssert(sc_shard_index_ < sc_shard_num_,
+           "sc_shard_index must be less than sc_shard_num");
+  RtAssert(ofdm_data_num_ % sc_shard_num_ == 0,
+           "sc_shard_num must divide the number of OFDM data subcarriers");
+  sc_shard_count_ = ofdm_data_num_ / sc_shard_num_;
+  sc_shard_start_ = sc_shard_index_ * sc_shard_count_;
+  gpu_decode_ = tdd_conf.value("gpu_decode", false);
+  gpu_decode_min_cbs_ = tdd_conf.value("gpu_decode_min_cbs", 16);
+  gpu_decode_streams_ = tdd_conf.value("gpu_decode_streams", 4);
+  RtAssert(gpu_decode_streams_ > 0, "gpu_decode_streams must be positive");
+  split_master_ = tdd_conf.value("split_master", false);
+  // The shared worker queues' producer tokens stay single-threaded only
+  // when the scheduling thread is the sole producer of its event types;
+  // the round-robin steal queues break that partition
+  RtAssert((split_master_ == false) || (work_steal_sched_ == false),
+           "split_master and work_steal_sched cannot both be set");
+  frame_dump_decode_ = tdd_conf.value("frame_dump_decode", false);
+  frame_dump_tx_ = tdd_conf.value("frame_dump_tx", false);
+  frame_dump_path_ = tdd_conf.value("frame_dump_path", "");
+  equal_export_ = tdd_conf.value("equal_export", false);
+  equal_export_decimation_ = tdd_conf.value("equal_export_decimation", 1);
+  equal_export_shm_ = tdd_conf.value("equal_export_shm", "/agora_equal");
+  RtAssert(equal_export_decimation_ > 0,
+           "equal_export_decimation must be positive");
+  pmu_counters_ = tdd_conf.value("pmu_counters", false);
+  queue_stats_ = tdd_conf.value("queue_stats", false);
+  stats_sample_interval_ = tdd_conf.value("stats_sample_interval", 1);
+  RtAssert(stats_sample_interval_ > 0,
+           "stats_sample_interval must be positive");
+  evm_decimation_ = tdd_conf.value("evm_decimation", 1);
+  RtAssert(evm_decimation_ > 0, "evm_decimation must be positive");
+  shadow_bench_ = tdd_conf.value("shadow_bench", false);
+  shadow_bench_interval_ = tdd_conf.value("shadow_bench_interval", 64);
+  RtAssert(shadow_bench_interval_ > 0,
+           "shadow_bench_interval must be positive");
+  adaptive_sched_ = tdd_conf.value("adaptive_sched", false);
+  hybrid_polling_ = tdd_conf.value("hybrid_polling", false);
+  deadline_sched_ = tdd_conf.value("deadline_sched", false);
+  ant_shed_num_ = tdd_conf.value("ant_shed_num", 0);
+  RtAssert(ant_shed_num_ < bs_ant_num_,
+           "ant_shed_num must leave at least one antenna");
+  udp_busy_poll_us_ = tdd_conf.value("udp_busy_poll_us", 0);
+  udp_rx_buffer_bytes_ = tdd_conf.value("udp_rx_buffer_bytes", 0);
   freq_orthogonal_pilot_ = tdd_conf.value("freq_orthogonal_pilot", false);
   correct_phase_shift_ = tdd_conf.value("correct_phase_shift", false);
 
@@ -415,6 +520,17 @@ Config::Config(const std::string& jsonfile)
 
   frame_.SetClientPilotSyms(client_ul_pilot_syms, client_dl_pilot_syms);
 
+  // Remember the capacities the buffers will be sized for, and pre-reserve
+  // the symbol maps so a later hot-swap (UpdateFrameSchedule) never
+  // reallocates storage under concurrent readers
+  frame_alloc_ul_syms_ = frame_.NumULSyms();
+  frame_alloc_dl_syms_ = frame_.NumDLSyms();
+  // Downlink beamweights multiply through the full-width calibration
+  // matrix, which a reduced-row CSI cannot feed; shedding is uplink-only
+  RtAssert((ant_shed_num_ == 0) || (frame_.NumDLSyms() == 0),
+           "ant_shed_num requires an uplink-only frame schedule");
+  frame_.ReserveSymbolMaps(frame_.NumTotalSyms());
+
   ant_per_group_ = frame_.NumDLCalSyms();
   RtAssert(ant_per_group_ % num_channels_ == 0,
            "Number of Downlink calibration symbols per frame must be "
@@ -447,13 +563,40 @@ Config::Config(const std::string& jsonfile)
   }
 
   // Agora configurations
+  frame_wnd_ = tdd_conf.value("frame_wnd", kFrameWnd);
+  RtAssert((frame_wnd_ >= 2) && (frame_wnd_ <= kFrameWnd),
+           "frame_wnd must be in [2, kFrameWnd]");
   frames_to_test_ = tdd_conf.value("max_frame", 9600);
   core_offset_ = tdd_conf.value("core_offset", 0);
   worker_thread_num_ = tdd_conf.value("worker_thread_num", 25);
   socket_thread_num_ = tdd_conf.value("socket_thread_num", 4);
   ue_core_offset_ = tdd_conf.value("ue_core_offset", 0);
   ue_worker_thread_num_ = tdd_conf.value("ue_worker_thread_num", 25);
+  ue_decode_thread_num_ = tdd_conf.value("ue_decode_thread_num", 0);
   ue_socket_thread_num_ = tdd_conf.value("ue_socket_thread_num", 4);
+  ue_stale_csi_fallback_ = tdd_conf.value("ue_stale_csi_fallback", false);
+  ue_frame_shed_margin_ = tdd_conf.value("ue_frame_shed_margin", 0);
+  RtAssert((ue_frame_shed_margin_ == 0) ||
+               ((ue_frame_shed_margin_ >= 2) &&
+                (ue_frame_shed_margin_ < frame_wnd_)),
+           "ue_frame_shed_margin must be 0 (off) or in [2, frame_wnd)");
+  mac_thread_num_ = tdd_conf.value("mac_thread_num", 1);
+  RtAssert(mac_thread_num_ >= 1, "mac_thread_num must be at least 1");
+  RtAssert(mac_thread_num_ <= kMaxUEs,
+           "mac_thread_num cannot exceed the maximum number of UEs");
+  mac_busy_poll_budget_ = tdd_conf.value("mac_busy_poll_budget", 10);
+  RtAssert(mac_busy_poll_budget_ >= 1, "mac_busy_poll_budget must be at least 1");
+  mac_pdu_aggregation_ = tdd_conf.value("mac_pdu_aggregation", false);
+  mac_frame_load_advance_ = tdd_conf.value("mac_frame_load_advance", 10);
+  RtAssert(
+      (mac_frame_load_advance_ >= 1) && (mac_frame_load_advance_ < frame_wnd_),
+      "mac_frame_load_advance must be at least 1 and stay inside the frame "
+      "window");
+  mac_link_adapt_ = tdd_conf.value("mac_link_adapt", false);
+  mac_link_adapt_interval_ = tdd_conf.value("mac_link_adapt_interval", 100);
+  RtAssert(mac_link_adapt_interval_ >= 1,
+           "mac_link_adapt_interval must be at least 1");
+  mac_shmem_transport_ = tdd_conf.value("mac_shmem_transport", false);
   fft_thread_num_ = tdd_conf.value("fft_thread_num", 5);
   demul_thread_num_ = tdd_conf.value("demul_thread_num", 5);
   decode_thread_num_ = tdd_conf.value("decode_thread_num", 10);
@@ -467,14 +610,82 @@ Config::Config(const std::string& jsonfile)
   RtAssert(
       demul_block_size_ % kTransposeBlockSize == 0,
       "Demodulation block size must be a multiple of transpose block size");
-  demul_events_per_symbol_ = 1 + (ofdm_data_num_ - 1) / demul_block_size_;
+  RtAssert((sc_shard_num_ == 1) || (bigstation_mode_ == false),
+           "Subcarrier sharding is not supported in bigstation mode");
+  RtAssert((sc_shard_num_ == 1) ||
+               (sc_shard_count_ % demul_block_size_ == 0),
+           "Demodulation block size must divide the subcarrier shard size");
+  // Each instance only schedules ZF/demul tasks for its own shard of the
+  // band, so the per-symbol event counts shrink accordingly (with one
+  // shard this degenerates to the full ofdm_data_num)
+  demul_events_per_symbol_ = 1 + (sc_shard_count_ - 1) / demul_block_size_;
+  // Batches up to EventData::kMaxTags use tag-list events; larger batches
+  // are scheduled as range events (base tag + count)
+  demul_batch_size_ = tdd_conf.value("demul_batch_size", 1);
+  demul_batched_gemm_ = tdd_conf.value("demul_batched_gemm", false);
+  demul_planar_ = tdd_conf.value("demul_planar", false);
+  precode_batched_gemm_ = tdd_conf.value("precode_batched_gemm", false);
+  fused_precode_ifft_ = tdd_conf.value("fused_precode_ifft", false);
+  chained_fft_demul_ = tdd_conf.value("chained_fft_demul", false);
+  RtAssert((chained_fft_demul_ == false) || (bigstation_mode_ == false),
+           "chained_fft_demul requires the shared-worker pipeline");
+  RtAssert(demul_batch_size_ <= demul_events_per_symbol_,
+           "Demodulation batch size exceeds events per symbol");
+  small_linalg_kernels_ = tdd_conf.value("small_linalg_kernels", false);
 
   zf_batch_size_ = tdd_conf.value("zf_batch_size", 1);
+  zf_cache_threshold_ = tdd_conf.value("zf_cache_threshold", 0.0);
+  zf_batched_inversion_ = tdd_conf.value("zf_batched_inversion", false);
+  zf_diag_load_factor_ = tdd_conf.value("zf_diag_load_factor", 0.0);
+  zf_mrc_threshold_ = tdd_conf.value("zf_mrc_threshold", 0.0);
+  RtAssert(zf_mrc_threshold_ >= 0.0, "zf_mrc_threshold must be non-negative");
+  zf_predict_frames_ = tdd_conf.value("zf_predict_frames", 0);
+  RtAssert(zf_predict_frames_ < frame_wnd_,
+           "CSI prediction history exceeds the frame window");
+  zf_partial_csi_fraction_ = tdd_conf.value("zf_partial_csi_fraction", 1.0);
+  RtAssert(
+      (zf_partial_csi_fraction_ > 0.0) && (zf_partial_csi_fraction_ <= 1.0),
+      "zf_partial_csi_fraction must be in (0, 1]");
+  calib_smooth_alpha_ = tdd_conf.value("calib_smooth_alpha", 0.0);
+  RtAssert((calib_smooth_alpha_ >= 0.0) && (calib_smooth_alpha_ <= 1.0),
+           "calib_smooth_alpha must be in [0, 1]");
   zf_block_size_ =
       freq_orthogonal_pilot_ ? ue_ant_num_ : tdd_conf.value("zf_block_size", 1);
-  zf_events_per_symbol_ = 1 + (ofdm_data_num_ - 1) / zf_block_size_;
+  RtAssert((sc_shard_num_ == 1) || (sc_shard_count_ % zf_block_size_ == 0),
+           "ZF block size must divide the subcarrier shard size");
+  zf_events_per_symbol_ = 1 + (sc_shard_count_ - 1) / zf_block_size_;
+  zf_block_gated_demul_ = tdd_conf.value("zf_block_gated_demul", false);
+  RtAssert((zf_block_gated_demul_ == false) ||
+               ((bigstation_mode_ == false) && (split_master_ == false)),
+           "zf_block_gated_demul requires the shared-worker pipeline with "
+           "in-master scheduling");
+  RtAssert((zf_block_gated_demul_ == false) || (chained_fft_demul_ == false),
+           "zf_block_gated_demul and chained_fft_demul cannot both be set");
+  RtAssert((zf_block_gated_demul_ == false) || (zf_predict_frames_ == 0),
+           "zf_block_gated_demul is incompatible with CSI prediction");
 
   fft_block_size_ = tdd_conf.value("fft_block_size", 1);
+  fft_prune_thresh_ = tdd_conf.value("fft_prune_thresh", 0.0);
+  RtAssert((fft_prune_thresh_ >= 0.0) && (fft_prune_thresh_ <= 1.0),
+           "FFT prune threshold must be a fraction in [0, 1]");
+  csi_interp_spacing_ = tdd_conf.value("csi_interp_spacing", 1);
+  RtAssert((csi_interp_spacing_ >= 1) &&
+               (csi_interp_spacing_ < ofdm_data_num_),
+           "CSI interpolation spacing out of range");
+  csi_fp16_ = tdd_conf.value("csi_fp16", false);
+  if (csi_fp16_ == true) {
+    RtAssert(csi_interp_spacing_ == 1,
+             "csi_fp16 does not support decimated-pilot CSI interpolation");
+  }
+  cfo_correction_ = tdd_conf.value("cfo_correction", false);
+  RtAssert((cfo_correction_ == false) || (freq_orthogonal_pilot_ == false),
+           "cfo_correction requires time-orthogonal pilots (one UE per "
+           "pilot symbol)");
+  RtAssert((cfo_correction_ == false) || (csi_fp16_ == false),
+           "cfo_correction estimates from fp32 CSI; disable csi_fp16");
+  clip_iq_thresh_ = tdd_conf.value("clip_iq_thresh", 0.0);
+  RtAssert((clip_iq_thresh_ >= 0.0) && (clip_iq_thresh_ <= 1.0),
+           "IQ clip threshold must be a fraction of full scale in [0, 1]");
   fft_block_size_ = std::max(fft_block_size_, num_channels_);
   encode_block_size_ = tdd_conf.value("encode_block_size", 1);
 
@@ -496,6 +707,18 @@ Config::Config(const std::string& jsonfile)
   // Scrambler and descrambler configurations
   scramble_enabled_ = tdd_conf.value("wlan_scrambler", true);
 
+  // HARQ retransmission combining (see HarqStore); off by default
+  harq_combining_ = tdd_conf.value("harq_combining", false);
+
+  // 4-bit packed LLR mode; off by default
+  llr_4bit_ = tdd_conf.value("llr_4bit", false);
+
+  // SNR-driven per-UE decoder iteration budget; off by default
+  adaptive_decode_iter_ = tdd_conf.value("adaptive_decode_iter", false);
+  RtAssert((llr_4bit_ == false) || (harq_combining_ == false),
+           "HARQ combining operates on byte LLRs and cannot be combined "
+           "with the 4-bit packed LLR mode");
+
   // Modulation configurations
   mod_order_bits_ =
       modulation_ == "64QAM"
@@ -527,6 +750,7 @@ Config::Config(const std::string& jsonfile)
   packet_length_ =
       Packet::kOffsetOfData + ((kUse12BitIQ ? 3 : 4) * samps_per_symbol_);
   dl_packet_length_ = Packet::kOffsetOfData + (samps_per_symbol_ * 4);
+  dl_payload_length_ = dl_packet_length_ - Packet::kOffsetOfData;
 
   //Don't check for jumbo frames when using the hardware, this might be temp
   if (false) {
@@ -671,7 +895,10 @@ void Config::GenData() {
   auto zc_ue_pilot_double =
       CommsLib::GetSequence(this->ofdm_data_num_, CommsLib::kLteZadoffChu);
   auto zc_ue_pilot = Utils::DoubleToCfloat(zc_ue_pilot_double);
-  for (size_t i = 0; i < ue_ant_num_; i++) {
+  // Each UE's pilot shift and IFFT only touches that UE's rows, so the
+  // loop runs on startup threads (CommsLib::IFFT builds a local MKL
+  // descriptor per call and is safe to run concurrently)
+  Utils::ParallelFor(ue_ant_num_, [&](size_t i) {
     auto zc_ue_pilot_i = CommsLib::SeqCyclicShift(
         zc_ue_pilot,
         (i + this->ue_ant_offset_) * (float)M_PI / 6);  // LTE DMRS
@@ -682,7 +909,7 @@ void Config::GenData() {
           this->ue_specific_pilot_[i][j];
     }
     CommsLib::IFFT(ue_pilot_ifft[i], ofdm_ca_num_, false);
-  }
+  });
 
   // Get uplink and downlink raw bits either from file or random numbers
   size_t num_bytes_per_ue_pad = Roundup<64>(this->num_bytes_per_cb_) *
@@ -725,44 +952,32 @@ void Config::GenData() {
                                std::to_string(this->ofdm_ca_num_) + "_ant" +
                                std::to_string(this->ue_ant_total_) + ".bin";
     MLPD_SYMBOL("Config: Reading raw ul data from %s\n", ul_data_file.c_str());
-    FILE* fd = std::fopen(ul_data_file.c_str(), "rb");
-    if (fd == nullptr) {
-      MLPD_ERROR("Failed to open antenna file %s. Error %s.\n",
-                 ul_data_file.c_str(), strerror(errno));
-      throw std::runtime_error("Config: Failed to open antenna file");
-    }
-
+    // The file holds one section per uplink data symbol, each
+    // ue_ant_total_ consecutive per-UE blocks of data_bytes_num_persymbol_
+    // bytes. Map it and copy only this instance's UE slice of each
+    // section; untouched pages are never faulted in
+    MmapReader ul_data_map(ul_data_file);
+    const size_t ul_symbol_bytes =
+        data_bytes_num_persymbol_ * this->ue_ant_total_;
     for (size_t i = this->frame_.ClientUlPilotSymbols();
          i < this->frame_.NumULSyms(); i++) {
-      if (std::fseek(fd, (data_bytes_num_persymbol_ * this->ue_ant_offset_),
-                     SEEK_CUR) != 0) {
-        MLPD_ERROR(" *** Error: failed to seek propertly (pre) into %s file\n",
-                   ul_data_file.c_str());
-        RtAssert(false,
-                 "Failed to seek propertly into " + ul_data_file + "file\n");
-      }
+      const size_t section_offset =
+          ((i - this->frame_.ClientUlPilotSymbols()) * ul_symbol_bytes) +
+          (data_bytes_num_persymbol_ * this->ue_ant_offset_);
       for (size_t j = 0; j < this->ue_ant_num_; j++) {
-        size_t r = std::fread(this->ul_bits_[i] + (j * num_bytes_per_ue_pad),
-                              sizeof(int8_t), data_bytes_num_persymbol_, fd);
-        if (r < data_bytes_num_persymbol_) {
-          MLPD_ERROR(
-              " *** Error: Uplink bad read from file %s (batch %zu : %zu) "
-              "%zu : %zu\n",
-              ul_data_file.c_str(), i, j, r, data_bytes_num_persymbol_);
+        const uint8_t* src =
+            ul_data_map.TryAt(section_offset + (j * data_bytes_num_persymbol_),
+                              data_bytes_num_persymbol_);
+        if (src == nullptr) {
+          MLPD_ERROR(" *** Error: Uplink bad read from file %s (batch %zu : "
+                     "%zu)\n",
+                     ul_data_file.c_str(), i, j);
+          continue;
         }
-      }
-      if (std::fseek(fd,
-                     data_bytes_num_persymbol_ *
-                         (this->ue_ant_total_ - this->ue_ant_offset_ -
-                          this->ue_ant_num_),
-                     SEEK_CUR) != 0) {
-        MLPD_ERROR(" *** Error: failed to seek propertly (post) into %s file\n",
-                   ul_data_file.c_str());
-        RtAssert(false,
-                 "Failed to seek propertly into " + ul_data_file + "file\n");
+        std::memcpy(this->ul_bits_[i] + (j * num_bytes_per_ue_pad), src,
+                    data_bytes_num_persymbol_);
       }
     }
-    std::fclose(fd);
   }
 
   if (this->frame_.NumDlDataSyms() > 0) {
@@ -771,42 +986,38 @@ void Config::GenData() {
                                std::to_string(this->ue_ant_total_) + ".bin";
 
     MLPD_SYMBOL("Config: Reading raw dl data from %s\n", dl_data_file.c_str());
-    FILE* fd = std::fopen(dl_data_file.c_str(), "rb");
-    if (fd == nullptr) {
-      MLPD_ERROR("Failed to open antenna file %s. Error %s.\n",
-                 dl_data_file.c_str(), strerror(errno));
-      throw std::runtime_error("Config: Failed to open dl antenna file");
-    }
-
+    MmapReader dl_data_map(dl_data_file);
+    const size_t dl_symbol_bytes =
+        data_bytes_num_persymbol_ * this->ue_ant_num_;
     for (size_t i = this->frame_.ClientDlPilotSymbols();
          i < this->frame_.NumDLSyms(); i++) {
+      const size_t section_offset =
+          (i - this->frame_.ClientDlPilotSymbols()) * dl_symbol_bytes;
       for (size_t j = 0; j < this->ue_ant_num_; j++) {
-        size_t r = std::fread(this->dl_bits_[i] + j * num_bytes_per_ue_pad,
-                              sizeof(int8_t), data_bytes_num_persymbol_, fd);
-        if (r < data_bytes_num_persymbol_) {
-          MLPD_ERROR(
-              "***Error: Downlink bad read from file %s (batch %zu : %zu) "
-              "\n",
-              dl_data_file.c_str(), i, j);
+        const uint8_t* src =
+            dl_data_map.TryAt(section_offset + (j * data_bytes_num_persymbol_),
+                              data_bytes_num_persymbol_);
+        if (src == nullptr) {
+          MLPD_ERROR("***Error: Downlink bad read from file %s (batch %zu : "
+                     "%zu)\n",
+                     dl_data_file.c_str(), i, j);
+          continue;
         }
+        std::memcpy(this->dl_bits_[i] + (j * num_bytes_per_ue_pad), src,
+                    data_bytes_num_persymbol_);
       }
     }
-    std::fclose(fd);
   }
 #endif
 
-  auto scrambler = std::make_unique<AgoraScrambler::Scrambler>();
-
   const size_t encoded_bytes_per_block =
       BitsToBytes(this->ldpc_config_.NumCbCodewLen());
   const size_t num_blocks_per_symbol =
       this->ldpc_config_.NumBlocksInSymbol() * this->ue_ant_num_;
-
-  // Used as an input ptr to
-  auto* scramble_buffer =
-      new int8_t[num_bytes_per_cb_ +
-                 kLdpcHelperFunctionInputBufferSizePaddingBytes]();
-  int8_t* ldpc_input = nullptr;
+  const size_t scramble_buffer_bytes =
+      num_bytes_per_cb_ + kLdpcHelperFunctionInputBufferSizePaddingBytes;
+  const size_t parity_buffer_bytes = LdpcEncodingParityBufSize(
+      this->ldpc_config_.BaseGraph(), this->ldpc_config_.ExpansionFactor());
 
   // Encode uplink bits
   ul_encoded_bits_.Malloc(this->frame_.NumULSyms() * num_blocks_per_symbol,
@@ -815,55 +1026,65 @@ void Config::GenData() {
   ul_mod_input_.Calloc(this->frame_.NumULSyms(),
                        this->ofdm_data_num_ * this->ue_ant_num_,
                        Agora_memory::Alignment_t::kAlign32);
-  auto* temp_parity_buffer = new int8_t[LdpcEncodingParityBufSize(
-      this->ldpc_config_.BaseGraph(), this->ldpc_config_.ExpansionFactor())];
-
-  for (size_t i = 0; i < frame_.NumULSyms(); i++) {
-    for (size_t j = 0; j < ue_ant_num_; j++) {
-      for (size_t k = 0; k < ldpc_config_.NumBlocksInSymbol(); k++) {
-        int8_t* coded_bits_ptr =
-            ul_encoded_bits_[i * num_blocks_per_symbol +
-                             j * ldpc_config_.NumBlocksInSymbol() + k];
-
-        if (scramble_enabled_) {
-          std::memcpy(scramble_buffer, GetInfoBits(ul_bits_, i, j, k),
-                      num_bytes_per_cb_);
-          scrambler->Scramble(scramble_buffer, num_bytes_per_cb_);
-          ldpc_input = scramble_buffer;
-        } else {
-          ldpc_input = GetInfoBits(ul_bits_, i, j, k);
-        }
 
-        LdpcEncodeHelper(ldpc_config_.BaseGraph(),
-                         ldpc_config_.ExpansionFactor(), ldpc_config_.NumRows(),
-                         coded_bits_ptr, temp_parity_buffer, ldpc_input);
-        AdaptBitsForMod(reinterpret_cast<uint8_t*>(coded_bits_ptr),
-                        ul_mod_input_[i] + j * ofdm_data_num_ +
-                            k * encoded_bytes_per_block / mod_order_bits_,
-                        encoded_bytes_per_block, mod_order_bits_);
+  // One encode job per (symbol, UE); the LDPC blocks inside a job stay
+  // sequential. The scrambler and the encoder scratch buffers are per-job
+  // because Scrambler keeps internal bit buffers and LdpcEncodeHelper
+  // writes the parity buffer; sharing either across startup threads
+  // would race
+  Utils::ParallelFor(frame_.NumULSyms() * ue_ant_num_, [&](size_t idx) {
+    const size_t i = idx / ue_ant_num_;
+    const size_t j = idx % ue_ant_num_;
+    AgoraScrambler::Scrambler scrambler;
+    std::vector<int8_t> scramble_buffer(scramble_buffer_bytes, 0);
+    std::vector<int8_t> temp_parity_buffer(parity_buffer_bytes, 0);
+    int8_t* ldpc_input = nullptr;
+    for (size_t k = 0; k < ldpc_config_.NumBlocksInSymbol(); k++) {
+      int8_t* coded_bits_ptr =
+          ul_encoded_bits_[i * num_blocks_per_symbol +
+                           j * ldpc_config_.NumBlocksInSymbol() + k];
+
+      if (scramble_enabled_) {
+        std::memcpy(scramble_buffer.data(), GetInfoBits(ul_bits_, i, j, k),
+                    num_bytes_per_cb_);
+        scrambler.Scramble(scramble_buffer.data(), num_bytes_per_cb_);
+        ldpc_input = scramble_buffer.data();
+      } else {
+        ldpc_input = GetInfoBits(ul_bits_, i, j, k);
       }
+
+      LdpcEncodeHelper(ldpc_config_.BaseGraph(), ldpc_config_.ExpansionFactor(),
+                       ldpc_config_.NumRows(), coded_bits_ptr,
+                       temp_parity_buffer.data(), ldpc_input);
+      AdaptBitsForMod(reinterpret_cast<uint8_t*>(coded_bits_ptr),
+                      ul_mod_input_[i] + j * ofdm_data_num_ +
+                          k * encoded_bytes_per_block / mod_order_bits_,
+                      encoded_bytes_per_block, mod_order_bits_);
     }
-  }
+  });
 
   // Generate freq-domain uplink symbols
   Table<complex_float> ul_iq_ifft;
   ul_iq_ifft.Calloc(this->frame_.NumULSyms(),
                     this->ofdm_ca_num_ * this->ue_ant_num_,
                     Agora_memory::Alignment_t::kAlign64);
-  for (size_t i = 0; i < this->frame_.NumULSyms(); i++) {
-    for (size_t u = 0; u < this->ue_ant_num_; u++) {
-      size_t p = u * this->ofdm_data_num_;
-      size_t q = u * this->ofdm_ca_num_;
-
-      for (size_t j = this->ofdm_data_start_; j < this->ofdm_data_stop_; j++) {
-        size_t k = j - ofdm_data_start_;
-        size_t s = p + k;
-        ul_iq_f_[i][q + j] = ModSingleUint8(ul_mod_input_[i][s], mod_table_);
-        ul_iq_ifft[i][q + j] = ul_iq_f_[i][q + j];
-      }
-      CommsLib::IFFT(&ul_iq_ifft[i][q], ofdm_ca_num_, false);
-    }
-  }
+  Utils::ParallelFor(this->frame_.NumULSyms() * this->ue_ant_num_,
+                     [&](size_t idx) {
+                       const size_t i = idx / this->ue_ant_num_;
+                       const size_t u = idx % this->ue_ant_num_;
+                       size_t p = u * this->ofdm_data_num_;
+                       size_t q = u * this->ofdm_ca_num_;
+
+                       for (size_t j = this->ofdm_data_start_;
+                            j < this->ofdm_data_stop_; j++) {
+                         size_t k = j - ofdm_data_start_;
+                         size_t s = p + k;
+                         ul_iq_f_[i][q + j] =
+                             ModSingleUint8(ul_mod_input_[i][s], ModTable());
+                         ul_iq_ifft[i][q + j] = ul_iq_f_[i][q + j];
+                       }
+                       CommsLib::IFFT(&ul_iq_ifft[i][q], ofdm_ca_num_, false);
+                     });
 
   // Encode downlink bits
   Table<int8_t> dl_encoded_bits;
@@ -873,55 +1094,61 @@ void Config::GenData() {
   dl_mod_input_.Calloc(this->frame_.NumDLSyms(), ofdm_data_num_ * ue_ant_num_,
                        Agora_memory::Alignment_t::kAlign32);
 
-  for (size_t i = 0; i < this->frame_.NumDLSyms(); i++) {
-    for (size_t j = 0; j < this->ue_ant_num_; j++) {
-      for (size_t k = 0; k < ldpc_config_.NumBlocksInSymbol(); k++) {
-        int8_t* coded_bits_ptr =
-            dl_encoded_bits[i * num_blocks_per_symbol +
-                            j * ldpc_config_.NumBlocksInSymbol() + k];
-
-        if (scramble_enabled_) {
-          std::memcpy(scramble_buffer, GetInfoBits(dl_bits_, i, j, k),
-                      num_bytes_per_cb_);
-          scrambler->Scramble(scramble_buffer, num_bytes_per_cb_);
-          ldpc_input = scramble_buffer;
-        } else {
-          ldpc_input = GetInfoBits(dl_bits_, i, j, k);
-        }
-
-        LdpcEncodeHelper(ldpc_config_.BaseGraph(),
-                         ldpc_config_.ExpansionFactor(), ldpc_config_.NumRows(),
-                         coded_bits_ptr, temp_parity_buffer, ldpc_input);
-        AdaptBitsForMod(reinterpret_cast<uint8_t*>(coded_bits_ptr),
-                        dl_mod_input_[i] + j * ofdm_data_num_ +
-                            k * encoded_bytes_per_block / mod_order_bits_,
-                        encoded_bytes_per_block, mod_order_bits_);
+  Utils::ParallelFor(this->frame_.NumDLSyms() * ue_ant_num_, [&](size_t idx) {
+    const size_t i = idx / ue_ant_num_;
+    const size_t j = idx % ue_ant_num_;
+    AgoraScrambler::Scrambler scrambler;
+    std::vector<int8_t> scramble_buffer(scramble_buffer_bytes, 0);
+    std::vector<int8_t> temp_parity_buffer(parity_buffer_bytes, 0);
+    int8_t* ldpc_input = nullptr;
+    for (size_t k = 0; k < ldpc_config_.NumBlocksInSymbol(); k++) {
+      int8_t* coded_bits_ptr =
+          dl_encoded_bits[i * num_blocks_per_symbol +
+                          j * ldpc_config_.NumBlocksInSymbol() + k];
+
+      if (scramble_enabled_) {
+        std::memcpy(scramble_buffer.data(), GetInfoBits(dl_bits_, i, j, k),
+                    num_bytes_per_cb_);
+        scrambler.Scramble(scramble_buffer.data(), num_bytes_per_cb_);
+        ldpc_input = scramble_buffer.data();
+      } else {
+        ldpc_input = GetInfoBits(dl_bits_, i, j, k);
       }
+
+      LdpcEncodeHelper(ldpc_config_.BaseGraph(), ldpc_config_.ExpansionFactor(),
+                       ldpc_config_.NumRows(), coded_bits_ptr,
+                       temp_parity_buffer.data(), ldpc_input);
+      AdaptBitsForMod(reinterpret_cast<uint8_t*>(coded_bits_ptr),
+                      dl_mod_input_[i] + j * ofdm_data_num_ +
+                          k * encoded_bytes_per_block / mod_order_bits_,
+                      encoded_bytes_per_block, mod_order_bits_);
     }
-  }
+  });
 
   // Generate freq-domain downlink symbols
   Table<complex_float> dl_iq_ifft;
   dl_iq_ifft.Calloc(this->frame_.NumDLSyms(), ofdm_ca_num_ * ue_ant_num_,
                     Agora_memory::Alignment_t::kAlign64);
-  for (size_t i = 0; i < this->frame_.NumDLSyms(); i++) {
-    for (size_t u = 0; u < ue_ant_num_; u++) {
-      size_t p = u * ofdm_data_num_;
-      size_t q = u * ofdm_ca_num_;
-
-      for (size_t j = ofdm_data_start_; j < ofdm_data_stop_; j++) {
-        int k = j - ofdm_data_start_;
-        size_t s = p + k;
-        if (k % ofdm_pilot_spacing_ != 0) {
-          dl_iq_f_[i][q + j] = ModSingleUint8(dl_mod_input_[i][s], mod_table_);
-        } else {
-          dl_iq_f_[i][q + j] = ue_specific_pilot_[u][k];
+  Utils::ParallelFor(
+      this->frame_.NumDLSyms() * ue_ant_num_, [&](size_t idx) {
+        const size_t i = idx / ue_ant_num_;
+        const size_t u = idx % ue_ant_num_;
+        size_t p = u * ofdm_data_num_;
+        size_t q = u * ofdm_ca_num_;
+
+        for (size_t j = ofdm_data_start_; j < ofdm_data_stop_; j++) {
+          int k = j - ofdm_data_start_;
+          size_t s = p + k;
+          if (k % ofdm_pilot_spacing_ != 0) {
+            dl_iq_f_[i][q + j] =
+                ModSingleUint8(dl_mod_input_[i][s], ModTable());
+          } else {
+            dl_iq_f_[i][q + j] = ue_specific_pilot_[u][k];
+          }
+          dl_iq_ifft[i][q + j] = dl_iq_f_[i][q + j];
         }
-        dl_iq_ifft[i][q + j] = dl_iq_f_[i][q + j];
-      }
-      CommsLib::IFFT(&dl_iq_ifft[i][q], ofdm_ca_num_, false);
-    }
-  }
+        CommsLib::IFFT(&dl_iq_ifft[i][q], ofdm_ca_num_, false);
+      });
 
   // Find normalization factor through searching for max value in IFFT results
   float max_val = CommsLib::FindMaxAbs(ul_iq_ifft, this->frame_.NumULSyms(),
@@ -945,33 +1172,41 @@ void Config::GenData() {
   this->scale_ = 2 * max_val;  // additional 2^2 (6dB) power backoff
 
   // Generate time domain symbols for downlink
-  for (size_t i = 0; i < this->frame_.NumDLSyms(); i++) {
-    for (size_t u = 0; u < this->ue_ant_num_; u++) {
-      size_t q = u * this->ofdm_ca_num_;
-      size_t r = u * this->samps_per_symbol_;
-      CommsLib::Ifft2tx(&dl_iq_ifft[i][q], &this->dl_iq_t_[i][r],
-                        this->ofdm_ca_num_, this->ofdm_tx_zero_prefix_,
-                        this->cp_len_, this->scale_);
-    }
-  }
+  Utils::ParallelFor(this->frame_.NumDLSyms() * this->ue_ant_num_,
+                     [&](size_t idx) {
+                       const size_t i = idx / this->ue_ant_num_;
+                       const size_t u = idx % this->ue_ant_num_;
+                       size_t q = u * this->ofdm_ca_num_;
+                       size_t r = u * this->samps_per_symbol_;
+                       CommsLib::Ifft2tx(&dl_iq_ifft[i][q],
+                                         &this->dl_iq_t_[i][r],
+                                         this->ofdm_ca_num_,
+                                         this->ofdm_tx_zero_prefix_,
+                                         this->cp_len_, this->scale_);
+                     });
 
   // Generate time domain uplink symbols
-  for (size_t i = 0; i < this->frame_.NumULSyms(); i++) {
-    for (size_t u = 0; u < this->ue_ant_num_; u++) {
-      size_t q = u * this->ofdm_ca_num_;
-      size_t r = u * this->samps_per_symbol_;
-      CommsLib::Ifft2tx(&ul_iq_ifft[i][q], &ul_iq_t_[i][r], this->ofdm_ca_num_,
-                        this->ofdm_tx_zero_prefix_, this->cp_len_,
-                        this->scale_);
-    }
-  }
+  Utils::ParallelFor(this->frame_.NumULSyms() * this->ue_ant_num_,
+                     [&](size_t idx) {
+                       const size_t i = idx / this->ue_ant_num_;
+                       const size_t u = idx % this->ue_ant_num_;
+                       size_t q = u * this->ofdm_ca_num_;
+                       size_t r = u * this->samps_per_symbol_;
+                       CommsLib::Ifft2tx(&ul_iq_ifft[i][q], &ul_iq_t_[i][r],
+                                         this->ofdm_ca_num_,
+                                         this->ofdm_tx_zero_prefix_,
+                                         this->cp_len_, this->scale_);
+                     });
 
   // Generate time domain ue-specific pilot symbols
-  for (size_t i = 0; i < this->ue_ant_num_; i++) {
+  Utils::ParallelFor(this->ue_ant_num_, [&](size_t i) {
     CommsLib::Ifft2tx(ue_pilot_ifft[i], this->ue_specific_pilot_t_[i],
                       this->ofdm_ca_num_, this->ofdm_tx_zero_prefix_,
                       this->cp_len_, this->scale_);
-    if (kDebugPrintPilot == true) {
+  });
+  if (kDebugPrintPilot == true) {
+    // Kept out of the parallel loop so the printouts stay per-UE ordered
+    for (size_t i = 0; i < this->ue_ant_num_; i++) {
       std::printf("ue_specific_pilot_t%zu=[", i);
       for (size_t j = 0; j < this->ofdm_ca_num_; j++) {
         std::printf("%2.4f+%2.4fi ", ue_pilot_ifft[i][j].re,
@@ -1021,7 +1256,6 @@ void Config::GenData() {
     }
   }
 
-  delete[](temp_parity_buffer);
   dl_encoded_bits.Free();
   ul_iq_ifft.Free();
   dl_iq_ifft.Free();
@@ -1030,7 +1264,6 @@ void Config::GenData() {
   ul_encoded_bits_.Free();
   dl_mod_input_.Free();
   FreeBuffer1d(&pilot_ifft);
-  delete[] scramble_buffer;
 }
 
 Config::~Config() {
@@ -1042,7 +1275,9 @@ Config::~Config() {
     std::free(pilots_sgn_);
     pilots_sgn_ = nullptr;
   }
-  mod_table_.Free();
+  for (auto& mod_table : mod_tables_) {
+    mod_table.Free();
+  }
   dl_bits_.Free();
   ul_bits_.Free();
   dl_iq_f_.Free();
@@ -1074,70 +1309,59 @@ size_t Config::GetSymbolId(size_t input_id) const {
 
 /* Returns True if symbol is valid index and is of symbol type 'P'
    False otherwise */
-bool Config::IsPilot(size_t /*frame_id*/, size_t symbol_id) const {
-  bool is_pilot = false;
-  assert(symbol_id < this->frame_.NumTotalSyms());
-  char s = frame_.FrameIdentifier().at(symbol_id);
-#ifdef DEBUG3
-  std::printf("IsPilot(%zu, %zu) = %c\n", frame_id, symbol_id, s);
-#endif
-  /* TODO should use the symbol type here */
-  is_pilot = (s == 'P');
-  return is_pilot;
-}
-
-/* Returns True if user equiptment and is a client dl pilot_
- * False otherwise */
-bool Config::IsDlPilot(size_t /*frame_id*/, size_t symbol_id) const {
-  bool is_pilot = false;
-  assert(symbol_id < this->frame_.NumTotalSyms());
-  char s = frame_.FrameIdentifier().at(symbol_id);
-#ifdef DEBUG3
-  std::printf("IsDlPilot(%zu, %zu) = %c\n", frame_id, symbol_id, s);
-#endif
-  if ((s == 'D') && (this->frame_.ClientDlPilotSymbols() > 0)) {
-    size_t dl_index = this->frame_.GetDLSymbolIdx(symbol_id);
-    is_pilot = (this->frame_.ClientDlPilotSymbols() > dl_index);
+/* IsPilot/IsDlPilot/IsCalDlPilot/IsCalUlPilot/IsUplink/IsDownlink are
+ * inline table reads in config.h; the dense tables are rebuilt whenever
+ * the frame schedule changes (see FrameStats::BuildSymbolIdxMaps) */
+
+bool Config::UpdateFrameSchedule(const std::string& new_schedule) {
+  FrameStats new_frame(new_schedule);
+
+  const auto reject = [&new_schedule](const char* reason) {
+    MLPD_ERROR("Config: rejecting frame schedule %s: %s\n",
+               new_schedule.c_str(), reason);
+    return false;
+  };
+  if (new_frame.NumTotalSyms() != frame_.NumTotalSyms()) {
+    return reject("total symbol count changed");
   }
-  return is_pilot;
-}
-
-bool Config::IsCalDlPilot(size_t /*frame_id*/, size_t symbol_id) const {
-  bool is_cal_dl_pilot = false;
-  assert(symbol_id < this->frame_.NumTotalSyms());
-  is_cal_dl_pilot = (this->frame_.FrameIdentifier().at(symbol_id) == 'C');
-  return is_cal_dl_pilot;
-}
-
-bool Config::IsCalUlPilot(size_t /*frame_id*/, size_t symbol_id) const {
-  bool is_cal_ul_pilot = false;
-  assert(symbol_id < this->frame_.NumTotalSyms());
-  is_cal_ul_pilot = (this->frame_.FrameIdentifier().at(symbol_id) == 'L');
-  return is_cal_ul_pilot;
-}
-
-bool Config::IsUplink(size_t /*frame_id*/, size_t symbol_id) const {
-  assert(symbol_id < this->frame_.NumTotalSyms());
-  char s = frame_.FrameIdentifier().at(symbol_id);
-#ifdef DEBUG3
-  std::printf("IsUplink(%zu, %zu) = %c\n", frame_id, symbol_id, s);
-#endif
-  return (s == 'U');
-}
-
-bool Config::IsDownlink(size_t frame_id, size_t symbol_id) const {
-  assert(symbol_id < this->frame_.NumTotalSyms());
-  char s = frame_.FrameIdentifier().at(symbol_id);
-#ifdef DEBUG3
-  std::printf("IsDownlink(%zu, %zu) = %c\n", frame_id, symbol_id, s);
-#else
-  unused(frame_id);
-#endif
-  return (s == 'D');
-}
-
-SymbolType Config::GetSymbolType(size_t symbol_id) const {
-  return kSymbolMap.at(this->frame_.FrameIdentifier().at(symbol_id));
+  if (new_frame.NumPilotSyms() != frame_.NumPilotSyms()) {
+    return reject("pilot symbol count changed");
+  }
+  if ((new_frame.NumBeaconSyms() > 1) ||
+      ((new_frame.NumBeaconSyms() == 1) &&
+       (new_frame.GetBeaconSymbolLast() > 1))) {
+    return reject("invalid beacon symbol placement");
+  }
+  if ((new_frame.NumDLCalSyms() != frame_.NumDLCalSyms()) ||
+      (new_frame.NumULCalSyms() != frame_.NumULCalSyms())) {
+    return reject("calibration symbol count changed");
+  }
+  if (new_frame.NumULSyms() > frame_alloc_ul_syms_) {
+    return reject("more uplink symbols than the buffers were sized for");
+  }
+  if (new_frame.NumDLSyms() > frame_alloc_dl_syms_) {
+    return reject("more downlink symbols than the buffers were sized for");
+  }
+  if ((new_frame.NumULSyms() > 0) &&
+      (frame_.ClientUlPilotSymbols() >= new_frame.NumULSyms())) {
+    return reject("uplink symbols do not cover the client uplink pilots");
+  }
+  if ((new_frame.NumDLSyms() > 0) &&
+      (frame_.ClientDlPilotSymbols() >= new_frame.NumDLSyms())) {
+    return reject("downlink symbols do not cover the client downlink pilots");
+  }
+  // A direction scheduled away entirely takes its client pilots with it
+  new_frame.SetClientPilotSyms(
+      (new_frame.NumULSyms() == 0) ? 0 : frame_.ClientUlPilotSymbols(),
+      (new_frame.NumDLSyms() == 0) ? 0 : frame_.ClientDlPilotSymbols());
+
+  // In-place map swap into the reserved storage, so concurrent readers
+  // (e.g. RX threads classifying arriving packets) never chase freed memory
+  frame_.AdoptSchedule(new_frame);
+  MLPD_INFO("Config: frame schedule now %s (%zu uplink, %zu downlink)\n",
+            frame_.FrameIdentifier().c_str(), frame_.NumULSyms(),
+            frame_.NumDLSyms());
+  return true;
 }
 
 void Config::Print() const {
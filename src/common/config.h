@@ -14,6 +14,7 @@
 #include <immintrin.h>
 #include <unistd.h>
 
+#include <array>
 #include <boost/range/algorithm/count.hpp>
 #include <fstream>  // std::ifstream
 #include <iostream>
@@ -57,15 +58,22 @@ class Config {
   inline size_t OfdmPilotSpacing() const { return this->ofdm_pilot_spacing_; }
   inline double FreqGhz() const { return this->freq_ghz_; };
   inline size_t DlPacketLength() const { return this->dl_packet_length_; }
+  inline size_t DlPayloadLength() const { return this->dl_payload_length_; }
   inline std::string Modulation() const { return this->modulation_; }
 
   inline size_t ModOrderBits() const { return this->mod_order_bits_; }
+  inline bool HardDemod() const { return this->hard_demod_; }
   inline bool HwFramer() const { return this->hw_framer_; }
   inline bool UeHwFramer() const { return this->ue_hw_framer_; }
   inline double Freq() const { return this->freq_; }
   inline double Rate() const { return this->rate_; }
   inline double Nco() const { return this->nco_; }
   inline bool ScrambleEnabled() const { return this->scramble_enabled_; }
+  inline bool HarqCombining() const { return this->harq_combining_; }
+  inline bool Llr4Bit() const { return this->llr_4bit_; }
+  inline bool AdaptiveDecodeIter() const {
+    return this->adaptive_decode_iter_;
+  }
 
   inline double RadioRfFreq() const { return this->radio_rf_freq_; }
   inline double BwFilter() const { return this->bw_filter_; }
@@ -76,6 +84,9 @@ class Config {
   inline double RxGainB() const { return this->rx_gain_b_; }
   inline double CalibTxGainA() const { return this->calib_tx_gain_a_; }
   inline double CalibTxGainB() const { return this->calib_tx_gain_b_; }
+  inline bool AgcEnabled() const { return this->agc_enabled_; }
+  inline double AgcTargetRssiDb() const { return this->agc_target_rssi_db_; }
+  inline double AgcHysteresisDb() const { return this->agc_hysteresis_db_; }
   inline double ClientTxGainA(size_t id) const {
     return this->client_tx_gain_a_.at(id);
   }
@@ -123,9 +134,31 @@ class Config {
   inline size_t UeWorkerThreadNum() const {
     return this->ue_worker_thread_num_;
   }
+  inline size_t UeDecodeThreadNum() const {
+    return this->ue_decode_thread_num_;
+  }
+  inline bool UeStaleCsiFallback() const {
+    return this->ue_stale_csi_fallback_;
+  }
+  inline size_t UeFrameShedMargin() const {
+    return this->ue_frame_shed_margin_;
+  }
   inline size_t UeSocketThreadNum() const {
     return this->ue_socket_thread_num_;
   }
+  inline size_t MacThreadNum() const { return this->mac_thread_num_; }
+  inline size_t MacBusyPollBudget() const {
+    return this->mac_busy_poll_budget_;
+  }
+  inline bool MacPduAggregation() const { return this->mac_pdu_aggregation_; }
+  inline size_t MacFrameLoadAdvance() const {
+    return this->mac_frame_load_advance_;
+  }
+  inline bool MacLinkAdapt() const { return this->mac_link_adapt_; }
+  inline size_t MacLinkAdaptInterval() const {
+    return this->mac_link_adapt_interval_;
+  }
+  inline bool MacShmemTransport() const { return this->mac_shmem_transport_; }
 
   inline size_t FftThreadNum() const { return this->fft_thread_num_; }
   inline size_t DemulThreadNum() const { return this->demul_thread_num_; }
@@ -136,12 +169,40 @@ class Config {
   inline size_t DemulEventsPerSymbol() const {
     return this->demul_events_per_symbol_;
   }
+  inline size_t DemulBatchSize() const { return this->demul_batch_size_; }
+  inline bool DemulBatchedGemm() const { return this->demul_batched_gemm_; }
+  inline bool DemulPlanar() const { return this->demul_planar_; }
+  inline bool PrecodeBatchedGemm() const {
+    return this->precode_batched_gemm_;
+  }
+  inline bool FusedPrecodeIfft() const { return this->fused_precode_ifft_; }
+  inline bool ChainedFftDemul() const { return this->chained_fft_demul_; }
+  inline bool ZfBlockGatedDemul() const { return this->zf_block_gated_demul_; }
+  inline bool SmallLinalgKernels() const {
+    return this->small_linalg_kernels_;
+  }
   inline size_t ZfBlockSize() const { return this->zf_block_size_; }
   inline size_t ZfBatchSize() const { return this->zf_batch_size_; }
   inline size_t ZfEventsPerSymbol() const {
     return this->zf_events_per_symbol_;
   }
+  inline double ZfCacheThreshold() const { return this->zf_cache_threshold_; }
+  inline bool ZfBatchedInversion() const {
+    return this->zf_batched_inversion_;
+  }
+  inline double ZfDiagLoadFactor() const { return this->zf_diag_load_factor_; }
+  inline double ZfMrcThreshold() const { return this->zf_mrc_threshold_; }
+  inline double CalibSmoothAlpha() const { return this->calib_smooth_alpha_; }
+  inline size_t ZfPredictFrames() const { return this->zf_predict_frames_; }
+  inline double ZfPartialCsiFraction() const {
+    return this->zf_partial_csi_fraction_;
+  }
   inline size_t FftBlockSize() const { return this->fft_block_size_; }
+  inline double FftPruneThresh() const { return this->fft_prune_thresh_; }
+  inline size_t CsiInterpSpacing() const { return this->csi_interp_spacing_; }
+  inline bool CsiFp16() const { return this->csi_fp16_; }
+  inline bool CfoCorrection() const { return this->cfo_correction_; }
+  inline double ClipIqThresh() const { return this->clip_iq_thresh_; }
 
   inline size_t EncodeBlockSize() const { return this->encode_block_size_; }
   inline bool FreqOrthogonalPilot() const {
@@ -169,6 +230,107 @@ class Config {
 
   inline float Scale() const { return this->scale_; }
   inline bool BigstationMode() const { return this->bigstation_mode_; }
+  inline bool WorkStealSched() const { return this->work_steal_sched_; }
+  inline bool NumaBind() const { return this->numa_bind_; }
+  inline bool TopologyPinning() const { return this->topology_pinning_; }
+  inline bool PrefaultBuffers() const { return this->prefault_buffers_; }
+  inline const std::string& TraceFile() const { return this->trace_file_; }
+  inline const std::string& CalibSnapshotPath() const {
+    return this->calib_snapshot_path_;
+  }
+  inline size_t CalibSnapshotMaxAgeSecs() const {
+    return this->calib_snapshot_max_age_secs_;
+  }
+  inline size_t TraceSpanFrameStart() const {
+    return this->trace_span_frame_start_;
+  }
+  inline size_t TraceSpanFrameCount() const {
+    return this->trace_span_frame_count_;
+  }
+  inline const std::string& TelemetryAddr() const {
+    return this->telemetry_addr_;
+  }
+  inline size_t TelemetryPort() const { return this->telemetry_port_; }
+  inline size_t TelemetryFrameInterval() const {
+    return this->telemetry_frame_interval_;
+  }
+  inline bool DecodeOffload() const { return this->decode_offload_; }
+  inline const std::string& DecodeOffloadRemoteAddr() const {
+    return this->decode_offload_remote_addr_;
+  }
+  inline size_t DecodeOffloadRemotePort() const {
+    return this->decode_offload_remote_port_;
+  }
+  inline size_t DecodeOffloadLocalPort() const {
+    return this->decode_offload_local_port_;
+  }
+  inline size_t DecodeOffloadThreadNum() const {
+    return this->decode_offload_thread_num_;
+  }
+  inline size_t ScShardNum() const { return this->sc_shard_num_; }
+  inline size_t ScShardIndex() const { return this->sc_shard_index_; }
+  inline size_t ScShardStart() const { return this->sc_shard_start_; }
+  inline size_t ScShardCount() const { return this->sc_shard_count_; }
+  /// True on the instance that merges every shard's LLRs and runs decode
+  inline bool ScShardOwner() const { return this->sc_shard_index_ == 0; }
+  inline const std::string& ScShardMergeAddr() const {
+    return this->sc_shard_merge_addr_;
+  }
+  inline size_t ScShardMergePort() const { return this->sc_shard_merge_port_; }
+  inline bool GpuDecode() const { return this->gpu_decode_; }
+  inline size_t GpuDecodeMinCbs() const { return this->gpu_decode_min_cbs_; }
+  inline size_t GpuDecodeStreams() const { return this->gpu_decode_streams_; }
+  inline bool SplitMaster() const { return this->split_master_; }
+  inline bool FrameDumpDecode() const { return this->frame_dump_decode_; }
+  inline bool FrameDumpTx() const { return this->frame_dump_tx_; }
+  inline const std::string& FrameDumpPath() const {
+    return this->frame_dump_path_;
+  }
+  inline bool EqualExport() const { return this->equal_export_; }
+  inline size_t EqualExportDecimation() const {
+    return this->equal_export_decimation_;
+  }
+  inline const std::string& EqualExportShm() const {
+    return this->equal_export_shm_;
+  }
+  inline bool PmuCounters() const { return this->pmu_counters_; }
+  inline bool QueueStats() const { return this->queue_stats_; }
+  inline size_t StatsSampleInterval() const {
+    return this->stats_sample_interval_;
+  }
+  inline size_t EvmDecimation() const { return this->evm_decimation_; }
+  inline bool ShadowBench() const { return this->shadow_bench_; }
+  inline size_t ShadowBenchInterval() const {
+    return this->shadow_bench_interval_;
+  }
+  inline bool AdaptiveSched() const { return this->adaptive_sched_; }
+  inline bool HybridPolling() const { return this->hybrid_polling_; }
+  inline bool DeadlineSched() const { return this->deadline_sched_; }
+  inline size_t AntShedNum() const { return this->ant_shed_num_; }
+  /// Number of antennas shed from uplink data processing for this frame
+  /// (0 when load shedding is disengaged). The shed set is always the last
+  /// AntShed() antennas. Read by DoFFT/DoZF workers; written only by the
+  /// master at frame boundaries via SetAntShed()
+  inline size_t AntShed(size_t frame_id) const {
+    const uint64_t state =
+        this->ant_shed_state_.load(std::memory_order_acquire);
+    const size_t effective_frame = state >> 32;
+    return (frame_id >= effective_frame) ? (state & 0xFFFFu)
+                                         : ((state >> 16) & 0xFFFFu);
+  }
+  /// Shed num_ants antennas starting at effective_frame; frames already in
+  /// flight keep the previous shed count so a frame's FFT skipping and
+  /// beamweight zeroing always agree
+  inline void SetAntShed(size_t num_ants, size_t effective_frame) {
+    const uint64_t prev_count =
+        this->ant_shed_state_.load(std::memory_order_relaxed) & 0xFFFFu;
+    this->ant_shed_state_.store(
+        (static_cast<uint64_t>(effective_frame) << 32) | (prev_count << 16) |
+            num_ants,
+        std::memory_order_release);
+  }
+  inline size_t UdpBusyPollUs() const { return this->udp_busy_poll_us_; }
+  inline size_t UdpRxBufferBytes() const { return this->udp_rx_buffer_bytes_; }
   inline size_t UlMacDataBytesNumPerframe() const {
     return this->ul_mac_data_bytes_num_perframe_;
   }
@@ -194,6 +356,9 @@ class Config {
   }
   inline std::string UeServerAddr() const { return this->ue_server_addr_; }
   inline std::string BsServerAddr() const { return this->bs_server_addr_; }
+  inline const std::vector<std::string>& BsServerAddrList() const {
+    return this->bs_server_addr_list_;
+  }
 
   inline std::string BsRruAddr() const { return this->bs_rru_addr_; }
   inline int BsServerPort() const { return this->bs_server_port_; }
@@ -202,12 +367,27 @@ class Config {
   inline int UeRruPort() const { return this->ue_rru_port_; }
 
   inline size_t FramesToTest() const { return this->frames_to_test_; }
+  inline size_t FrameWnd() const { return this->frame_wnd_; }
+  /// Slot of [frame_id] in the runtime frame window. Every buffer whose
+  /// rows are sized by FrameWnd() must be indexed through this
+  inline size_t FrameSlot(size_t frame_id) const {
+    return (frame_id % this->frame_wnd_);
+  }
   inline float NoiseLevel() const { return this->noise_level_; }
   inline size_t NumBytesPerCb() const { return this->num_bytes_per_cb_; }
   inline bool FftInRru() const { return this->fft_in_rru_; }
 
   inline uint16_t DpdkNumPorts() const { return this->dpdk_num_ports_; }
   inline uint16_t DpdkPortOffset() const { return this->dpdk_port_offset_; }
+  inline bool DpdkRss() const { return this->dpdk_rss_; }
+  inline bool TxPacing() const { return this->tx_pacing_; }
+  inline bool XdpTransport() const { return this->xdp_transport_; }
+  inline std::string XdpIf() const { return this->xdp_if_; }
+  inline bool RxEpochReclaim() const { return this->rx_epoch_reclaim_; }
+  inline std::string CaptureSpool() const { return this->capture_spool_; }
+  inline size_t CaptureSpoolBytes() const { return this->capture_spool_bytes_; }
+  inline std::string ReplaySpool() const { return this->replay_spool_; }
+  inline double ReplaySpeedup() const { return this->replay_speedup_; }
 
   inline size_t BsMacRxPort() const { return this->bs_mac_rx_port_; }
   inline size_t BsMacTxPort() const { return this->bs_mac_tx_port_; }
@@ -267,7 +447,9 @@ class Config {
   inline Table<complex_float>& UlIqF() { return this->ul_iq_f_; }
   inline Table<complex_float>& DlIqF() { return this->dl_iq_f_; }
   inline Table<std::complex<int16_t>>& DlIqT() { return this->dl_iq_t_; }
-  inline Table<complex_float>& ModTable() { return this->mod_table_; };
+  inline Table<complex_float>& ModTable() {
+    return this->mod_tables_.at((this->mod_order_bits_ / 2) - 1);
+  };
 
   // Public functions
   void GenData();
@@ -275,44 +457,86 @@ class Config {
   /// TODO document and review
   size_t GetSymbolId(size_t input_id) const;
 
-  bool IsPilot(size_t /*unused*/, size_t /*symbol_id*/) const;
-  bool IsDlPilot(size_t /*unused*/, size_t /*symbol_id*/) const;
-  bool IsCalDlPilot(size_t /*unused*/, size_t /*symbol_id*/) const;
-  bool IsCalUlPilot(size_t /*unused*/, size_t /*symbol_id*/) const;
-  bool IsDownlink(size_t /*frame_id*/, size_t /*symbol_id*/) const;
-  bool IsUplink(size_t /*unused*/, size_t /*symbol_id*/) const;
+  /* Per-packet symbol-role queries: O(1) reads of the dense symbol-type
+   * table (see FrameStats::GetSymbolType), inline for the hot RX and
+   * scheduling paths */
+  inline bool IsPilot(size_t /*unused*/, size_t symbol_id) const {
+    return this->frame_.GetSymbolType(symbol_id) == SymbolType::kPilot;
+  }
+  inline bool IsDlPilot(size_t /*unused*/, size_t symbol_id) const {
+    if ((this->frame_.GetSymbolType(symbol_id) != SymbolType::kDL) ||
+        (this->frame_.ClientDlPilotSymbols() == 0)) {
+      return false;
+    }
+    return this->frame_.GetDLSymbolIdx(symbol_id) <
+           this->frame_.ClientDlPilotSymbols();
+  }
+  inline bool IsCalDlPilot(size_t /*unused*/, size_t symbol_id) const {
+    return this->frame_.GetSymbolType(symbol_id) == SymbolType::kCalDL;
+  }
+  inline bool IsCalUlPilot(size_t /*unused*/, size_t symbol_id) const {
+    return this->frame_.GetSymbolType(symbol_id) == SymbolType::kCalUL;
+  }
+  inline bool IsDownlink(size_t /*frame_id*/, size_t symbol_id) const {
+    return this->frame_.GetSymbolType(symbol_id) == SymbolType::kDL;
+  }
+  inline bool IsUplink(size_t /*unused*/, size_t symbol_id) const {
+    return this->frame_.GetSymbolType(symbol_id) == SymbolType::kUL;
+  }
 
   /* Public functions that do not meet coding standard format */
-  /// Return the symbol type of this symbol in this frame
-  SymbolType GetSymbolType(size_t symbol_id) const;
+  /// Return the symbol type of this symbol in this frame (O(1) table read)
+  inline SymbolType GetSymbolType(size_t symbol_id) const {
+    return this->frame_.GetSymbolType(symbol_id);
+  }
+
+  /// Hot-swap the frame schedule (e.g. "BPUUD...") without reallocating
+  /// buffers. The new schedule must keep the total, pilot, and calibration
+  /// symbol counts and fit the uplink/downlink symbol capacities allocated
+  /// for the schedule parsed at startup; returns false (leaving the current
+  /// schedule in place) otherwise. Like UpdateModCfgs(), this must only run
+  /// at a frame boundary (see Agora::UpdateRanConfig). MAC per-frame byte
+  /// budgets keep their startup sizing, which bounds any new schedule
+  bool UpdateFrameSchedule(const std::string& new_schedule);
 
   inline void UpdateModCfgs(size_t new_mod_order_bits) {
+    RtAssert((new_mod_order_bits >= 2) && (new_mod_order_bits <= kMaxModType) &&
+                 ((new_mod_order_bits % 2) == 0),
+             "Unsupported modulation order bits " +
+                 std::to_string(new_mod_order_bits));
+    // Build every supported table once, on first use. A later MCS switch
+    // then only re-points ModTable() at an already-initialized table, so
+    // workers never observe a table being regenerated underneath them.
+    for (size_t i = 0; i < this->mod_tables_.size(); i++) {
+      if (this->mod_tables_.at(i).IsAllocated() == false) {
+        InitModulationTable(this->mod_tables_.at(i), 1UL << (2 * (i + 1)));
+      }
+    }
     this->mod_order_bits_ = new_mod_order_bits;
     this->mod_order_ = static_cast<size_t>(pow(2, this->mod_order_bits_));
-    InitModulationTable(this->mod_table_, this->mod_order_);
     this->ldpc_config_.NumBlocksInSymbol(
         (this->ofdm_data_num_ * this->mod_order_bits_) /
         this->ldpc_config_.NumCbCodewLen());
   }
 
   /// Return total number of data symbols of all frames in a buffer
-  /// that holds data of kFrameWnd frames
+  /// that holds data of FrameWnd() frames
   inline size_t GetTotalDataSymbolIdx(size_t frame_id, size_t symbol_id) const {
-    return ((frame_id % kFrameWnd) * this->frame_.NumDataSyms() + symbol_id);
+    return ((frame_id % frame_wnd_) * this->frame_.NumDataSyms() + symbol_id);
   }
 
   /// Return total number of uplink data symbols of all frames in a buffer
-  /// that holds data of kFrameWnd frames
+  /// that holds data of FrameWnd() frames
   inline size_t GetTotalDataSymbolIdxUl(size_t frame_id,
                                         size_t symbol_idx_ul) const {
-    return ((frame_id % kFrameWnd) * this->frame_.NumULSyms() + symbol_idx_ul);
+    return ((frame_id % frame_wnd_) * this->frame_.NumULSyms() + symbol_idx_ul);
   }
 
   /// Return total number of downlink data symbols of all frames in a buffer
-  /// that holds data of kFrameWnd frames
+  /// that holds data of FrameWnd() frames
   inline size_t GetTotalDataSymbolIdxDl(size_t frame_id,
                                         size_t symbol_idx_dl) const {
-    return ((frame_id % kFrameWnd) * this->frame_.NumDLSyms() + symbol_idx_dl);
+    return ((frame_id % frame_wnd_) * this->frame_.NumDLSyms() + symbol_idx_dl);
   }
 
   /// Return the frame duration in seconds
@@ -325,7 +549,7 @@ class Config {
   /// be an uplink symbol.
   inline complex_float* GetDataBuf(Table<complex_float>& data_buffers,
                                    size_t frame_id, size_t symbol_id) const {
-    size_t frame_slot = frame_id % kFrameWnd;
+    size_t frame_slot = frame_id % frame_wnd_;
     size_t symbol_offset = (frame_slot * this->frame_.NumULSyms()) +
                            this->frame_.GetULSymbolIdx(symbol_id);
     return data_buffers[symbol_offset];
@@ -340,7 +564,7 @@ class Config {
   /// Get the calibration buffer for this frame and subcarrier ID
   inline complex_float* GetCalibBuffer(Table<complex_float>& calib_buffer,
                                        size_t frame_id, size_t sc_id) const {
-    size_t frame_slot = frame_id % kFrameWnd;
+    size_t frame_slot = frame_id % frame_wnd_;
     return &calib_buffer[frame_slot][sc_id * bs_ant_num_];
   }
 
@@ -354,7 +578,7 @@ class Config {
     } else {
       mac_bytes_perframe = ul_mac_bytes_num_perframe_;
     }
-    return &info_bits[ue_id][(frame_id % kFrameWnd) * mac_bytes_perframe +
+    return &info_bits[ue_id][(frame_id % frame_wnd_) * mac_bytes_perframe +
                              symbol_id * mac_packet_length_ +
                              cb_id * this->num_bytes_per_cb_];
   }
@@ -449,9 +673,18 @@ class Config {
   // 'U' for uplink data symbols)
   FrameStats frame_;
 
+  // Uplink/downlink symbol counts of the schedule parsed at startup. Buffers
+  // are sized from them, so they cap what UpdateFrameSchedule() may accept
+  size_t frame_alloc_ul_syms_;
+  size_t frame_alloc_dl_syms_;
+
   std::atomic<bool> running_;
 
   size_t dl_packet_length_;  // HAS_TIME & END_BURST, fixme
+  // DL sample bytes per packet, excluding the Packet header. The DL
+  // socket buffer stores payloads at this stride; TX attaches headers
+  // via scatter-gather at send time
+  size_t dl_payload_length_;
 
   Table<int8_t> dl_bits_;
   Table<int8_t> ul_bits_;
@@ -482,11 +715,18 @@ class Config {
   std::vector<double> client_gain_rx_b_;
 
   std::string modulation_;  // Modulation order as a string, e.g., "16QAM"
+  // If true, DoDemul makes hard decisions and packs the bits straight into
+  // the decoded buffer, bypassing the LLR buffers and the LDPC decoder.
+  // For uncoded (latency-testing) configurations only.
+  bool hard_demod_;
   size_t mod_order_;  // Modulation order (e.g., 4: QPSK, 16: 16QAM, 64: 64QAM)
   size_t mod_order_bits_;  // Number of binary bits used for a modulation order
 
-  // Modulation lookup table for mapping binary bits to constellation points
-  Table<complex_float> mod_table_;
+  // Modulation lookup tables for mapping binary bits to constellation
+  // points, one per supported modulation order (QPSK through 256QAM). All
+  // of them are initialized up front by UpdateModCfgs() so that a runtime
+  // MCS switch is a pointer change, not a table rebuild.
+  std::array<Table<complex_float>, kMaxModType / 2> mod_tables_;
 
   std::vector<std::string> radio_id_;
   std::vector<std::string> hub_id_;
@@ -505,6 +745,19 @@ class Config {
   double rate_;
   double nco_;
   bool scramble_enabled_;
+  // If true, soft LLRs of uplink symbols whose MAC packet CRC failed are
+  // held and combined (saturating add) with the next frame's LLRs for the
+  // same symbol before decoding. Requires the MAC (kEnableMac) for the
+  // per-packet CRC failure signal.
+  bool harq_combining_;
+  // If true, DoDemul quantizes soft LLRs to signed nibbles and packs two
+  // per byte, halving demod buffer footprint and memory traffic; DoDecode
+  // unpacks per code block before decoding. Costs ~0.1 dB.
+  bool llr_4bit_;
+  // If true, DoDecode caps the LDPC iteration count per UE from the
+  // previous frame's EVM SNR: strong UEs get a small budget, cell-edge
+  // UEs keep the configured maximum.
+  bool adaptive_decode_iter_;
   double radio_rf_freq_;
   double bw_filter_;
   bool single_gain_;
@@ -514,6 +767,12 @@ class Config {
   double rx_gain_b_;
   double calib_tx_gain_a_;
   double calib_tx_gain_b_;
+  // If true, a slow AGC loop trims the BS receive gains at runtime toward
+  // agc_target_rssi_db (in dBFS), with agc_hysteresis_db of deadband so
+  // noise does not cause gain hunting
+  bool agc_enabled_;
+  double agc_target_rssi_db_;
+  double agc_hysteresis_db_;
   std::vector<double> client_tx_gain_a_;
   std::vector<double> client_rx_gain_a_;
   std::vector<double> client_tx_gain_b_;
@@ -545,23 +804,149 @@ class Config {
 
   size_t ue_core_offset_;
   size_t ue_worker_thread_num_;
+  // Workers dedicated to LDPC decode at the UE, in addition to
+  // ue_worker_thread_num. 0 keeps decode in the shared worker pool
+  size_t ue_decode_thread_num_;
   size_t ue_socket_thread_num_;
+  // Let the UE equalize downlink data symbols that arrive before the
+  // frame's pilot ffts complete against the previous frame's CSI instead
+  // of deferring them. Trades channel-estimate freshness for latency
+  bool ue_stale_csi_fallback_;
+  // UE load shedding: when the oldest incomplete frame trails a newly
+  // received frame by this many frames, skip its remaining demul/decode
+  // work (pilot/CSI processing is kept). 0 disables shedding
+  size_t ue_frame_shed_margin_;
+
+  // Number of MAC threads; codeblock work is sharded across them by UE id
+  size_t mac_thread_num_;
+
+  // Number of app-socket receive attempts per expected MAC packet before
+  // the MAC thread gives up on the rest of the frame
+  size_t mac_busy_poll_budget_;
+
+  // With aggregation on, the MAC data source packs multiple length-prefixed
+  // app PDUs into each MAC packet payload instead of one PDU per packet,
+  // so small app messages no longer waste whole transport blocks
+  bool mac_pdu_aggregation_;
+
+  // How many frames ahead the MAC sender preloads data from its source,
+  // decoupling storage latency from the frame clock
+  size_t mac_frame_load_advance_;
+
+  // In-process link adaptation: the MAC watches per-UE decode failure
+  // rates and its own queue backlog and steers the modulation order
+  // through the RanConfig update path, deciding every
+  // [mac_link_adapt_interval] frames
+  bool mac_link_adapt_;
+  size_t mac_link_adapt_interval_;
+
+  // Carry MAC <-> app data over memory-mapped shared-memory rings instead
+  // of loopback UDP sockets. Only valid when the apps run on this host
+  bool mac_shmem_transport_;
 
   // Number of OFDM data subcarriers handled in one demodulation event
   size_t demul_block_size_;
   size_t demul_events_per_symbol_;  // Derived from demul_block_size
+  size_t demul_batch_size_;         // Demul blocks batched into one event
+  // If true, DoDemul equalizes a cacheline of subcarriers with one grouped
+  // MKL batch-gemm call instead of one small gemm per subcarrier
+  bool demul_batched_gemm_;
+  // If true, DoDemul stages equalized symbols in planar (split real/imag)
+  // per-UE rows and runs the planar soft demodulators, which need no I/Q
+  // unpack shuffles. Soft demodulation only; the hard-decision fast path
+  // keeps the interleaved layout
+  bool demul_planar_;
+  // If true, DoPrecode precodes a cacheline of subcarriers with one grouped
+  // MKL batch-gemm call instead of one small gemm per subcarrier
+  bool precode_batched_gemm_;
+  // If true, the worker that finishes a downlink symbol's last precode
+  // block runs the symbol's IFFTs inline while the rows are still cache
+  // resident, skipping the master scheduling hop between the two stages
+  bool fused_precode_ifft_;
+  // If true, the worker that finishes an uplink data symbol's last FFT
+  // enqueues the symbol's demodulation tasks itself when the beamformer
+  // is already ready, skipping the completion -> master -> schedule round
+  // trip on the uplink critical path
+  bool chained_fft_demul_;
+  // If true, demodulation is gated per subcarrier block instead of per
+  // frame: each demul block is dispatched as soon as the ZF blocks
+  // covering its subcarriers have delivered beamweights, overlapping ZF
+  // and demodulation within a symbol
+  bool zf_block_gated_demul_;
+  // If true, the ZF Gram product and the per-subcarrier equalization /
+  // precoding multiplies run on the internal fixed-shape AVX2 kernels
+  // (small_linalg.h) instead of Armadillo/MKL dispatch. The kernel for
+  // the configured antenna/UE shape is selected once at doer construction
+  bool small_linalg_kernels_;
 
   // Number of OFDM data subcarriers handled in one doZF function call
   size_t zf_block_size_;
 
   // Number of doZF function call handled in on event
   size_t zf_batch_size_;
+  // If positive, DoZF reuses the previous frame's precoder for a subcarrier
+  // whose CSI changed by less than this relative Frobenius norm
+  double zf_cache_threshold_;
+  // If true, DoZF inverts Gram matrices for a cacheline of subcarriers in
+  // one batched Cholesky pass (uplink-only configurations)
+  bool zf_batched_inversion_;
+  // If positive, DoZF diagonally loads the Gram matrix with this fraction
+  // of its mean diagonal energy before inverting, bounding worst-case
+  // latency on ill-conditioned subcarriers
+  double zf_diag_load_factor_;
+  // If positive, DoZF skips the Gram inversion on subcarriers whose Gram
+  // matrix is diagonally dominant (largest per-row off-diagonal energy
+  // ratio below this threshold) and uses energy-normalized conjugate
+  // (maximum-ratio-combining) beamweights instead
+  double zf_mrc_threshold_;
+  // If positive, DoZF predicts the next frame's CSI by linear extrapolation
+  // over this many frames of history and computes its beamweights a frame
+  // ahead of time (1 = reuse stale CSI without extrapolation)
+  size_t zf_predict_frames_;
+  // If below 1.0, ZF starts as soon as this fraction of a frame's pilot
+  // FFTs have completed, and re-runs once with the full CSI should the
+  // straggling antennas arrive while the frame is still being processed
+  double zf_partial_csi_fraction_;
+  // If positive, DoZF tracks the reciprocity calibration estimate with a
+  // per-subcarrier exponential moving average of this weight instead of the
+  // uniform moving-sum window, following slow thermal drift more closely
+  double calib_smooth_alpha_;
   size_t zf_events_per_symbol_;  // Derived from zf_block_size
 
   // Number of antennas handled in one FFT event
   size_t fft_block_size_;
 
-  // Number of code blocks handled in one encode event
+  // If positive, DoFFT computes uplink data symbols with a pruned
+  // (transform-decomposition) FFT when the occupied subcarriers cover at
+  // most this fraction of the band. 0 disables the pruned path
+  double fft_prune_thresh_;
+
+  // If greater than 1, pilots are only transmitted on every Nth data
+  // subcarrier and DoFFT linearly interpolates the CSI for the
+  // subcarriers in between (1 = dense pilots, no interpolation)
+  size_t csi_interp_spacing_;
+
+  // Store CSI as half precision (2 x fp16 per complex sample), halving
+  // csi_buffers_'s footprint. DoFFT compresses on write and DoZF expands
+  // to fp32 during its gather pass; CSI is consumed once per frame by ZF,
+  // so the conversions are amortized
+  bool csi_fp16_;
+  // Estimate per-UE residual carrier frequency offset from the
+  // frame-to-frame phase progression of each UE's CSI and de-rotate the
+  // UE's pilot symbols during FFT input conversion, keeping CFO out of
+  // the channel estimates (data symbols carry all UEs superimposed, so
+  // their per-UE residual is handled by the post-equalization phase
+  // tracking in DoDemul)
+  bool cfo_correction_;
+
+  // If positive, downlink IFFT output is magnitude-clipped at this
+  // fraction of short full scale before transmission, reducing PAPR so
+  // the power amplifiers can run with less backoff. 0 disables clipping
+  double clip_iq_thresh_;
+
+  // Number of code blocks handled in one encode or decode event. The
+  // default of 1 keeps scheduling at single-code-block granularity, so any
+  // worker can pick up individual blocks of an uneven symbol
   size_t encode_block_size_;
 
   bool freq_orthogonal_pilot_;
@@ -605,6 +990,102 @@ class Config {
   float scale_;  // Scaling factor for all transmit symbols
 
   bool bigstation_mode_;      // If true, use pipeline-parallel scheduling
+  bool work_steal_sched_;     // If true, workers own local task queues and
+                              // steal from peers when their queue is empty
+  bool numa_bind_;            // If true, bind hot worker buffers to the NUMA
+                              // node hosting the worker cores
+  bool topology_pinning_;     // If true, place threads from a topology-aware
+                              // core plan (PlanCoreAllocation) instead of the
+                              // core_offset arithmetic
+  bool prefault_buffers_;     // If true, fault in and mlock every long-lived
+                              // buffer at startup so frame 0 runs at
+                              // steady-state latency
+  std::string trace_file_;    // Binary trace output path; non-empty enables
+                              // the always-on event trace (see trace_ring.h)
+  // Non-empty enables warm-restart snapshots of the initial reciprocity
+  // calibration: RadioStart() restores a matching snapshot younger than
+  // calib_snapshot_max_age_secs instead of re-measuring
+  std::string calib_snapshot_path_;
+  size_t calib_snapshot_max_age_secs_;
+  size_t trace_span_frame_start_;  // First frame of the window that records
+                                   // per-task doer spans into the trace
+  size_t trace_span_frame_count_;  // Number of frames recording doer spans;
+                                   // 0 keeps span tracing off
+  std::string telemetry_addr_;     // Collector address for live UDP metrics;
+                                   // non-empty enables the telemetry thread
+  size_t telemetry_port_;          // Collector UDP port for live metrics
+  size_t telemetry_frame_interval_;  // Frames between telemetry snapshots
+  bool decode_offload_;       // If true, ship uplink LLR blocks to a remote
+                              // decode_worker process instead of scheduling
+                              // local kDecode events (see decode_offload.h)
+  std::string decode_offload_remote_addr_;  // Helper process address
+  size_t decode_offload_remote_port_;  // First helper decode port; helper
+                                       // thread i listens on port + i
+  size_t decode_offload_local_port_;   // Local port decoded bits return to
+  size_t decode_offload_thread_num_;   // Decode threads (and ports) on the
+                                       // helper process
+  size_t sc_shard_num_;    // Cooperating Agora instances splitting the OFDM
+                           // band by subcarrier; 1 means no sharding
+  size_t sc_shard_index_;  // This instance's shard; shard 0 owns decode and
+                           // merges the other shards' LLRs (see sc_shard.h)
+  size_t sc_shard_start_;  // First data subcarrier of this instance's shard
+  size_t sc_shard_count_;  // Data subcarriers in each shard
+  std::string sc_shard_merge_addr_;  // Shard owner's address for LLR merging
+  size_t sc_shard_merge_port_;       // Shard owner's UDP port for LLR merging
+  bool gpu_decode_;            // If true, route large-batch LDPC decode to a
+                               // CUDA device (requires a USE_GPU_DECODE
+                               // build; see gpu_decode.h)
+  size_t gpu_decode_min_cbs_;  // Symbols with at least this many code blocks
+                               // go to the GPU; smaller ones stay on the CPU
+                               // workers for latency
+  size_t gpu_decode_streams_;  // Concurrent CUDA streams (in-flight symbols)
+  bool split_master_;          // If true, a dedicated scheduling thread
+                               // performs the per-symbol task fan-out while
+                               // the master thread only drains completions
+  bool frame_dump_decode_;     // If true, spool every frame's decoded bits
+                               // to disk continuously (see frame_dumper.h)
+  bool frame_dump_tx_;         // If true, spool every frame's TX samples
+                               // to disk continuously
+  std::string frame_dump_path_;  // Directory for continuous frame dumps;
+                                 // empty selects PROJECT_DIRECTORY/data
+  bool equal_export_;          // If true, publish equalized symbols to a
+                               // shared-memory window for visualizers
+                               // (see equal_export.h)
+  size_t equal_export_decimation_;  // Export every Nth data subcarrier
+  std::string equal_export_shm_;    // POSIX shm name of the export window
+  bool pmu_counters_;         // If true, sample hardware PMU counters
+                              // around every doer launch (see pmu_sampler.h)
+  bool queue_stats_;          // If true, track per-queue depth high
+                              // watermarks and fallback enqueue counts
+  size_t stats_sample_interval_;  // Record task timing for 1 in N doer
+                                  // events (1 = every event); sampled
+                                  // events are weighted by N
+  size_t evm_decimation_;     // EVM measures every Nth data subcarrier;
+                              // 1 samples all of them
+  bool shadow_bench_;         // If true, a spare worker re-runs sampled
+                              // demul launches through both soft-demod
+                              // kernel variants (see shadow_bench.h)
+  size_t shadow_bench_interval_;  // Completed demul launches between
+                                  // shadowed ones
+  bool adaptive_sched_;       // If true, rebalance worker doer priorities
+                              // from per-frame duration stats
+  bool hybrid_polling_;       // If true, the master parks after repeated
+                              // empty polls instead of spinning
+  bool deadline_sched_;       // If true, workers prioritize downlink work
+                              // when a frame nears its TX deadline
+  // If positive, the master may shed this many antennas from uplink data
+  // processing (FFT skipped, beamweights zeroed) when frames overrun their
+  // deadline, trading a fraction of array gain for staying real time
+  size_t ant_shed_num_;
+  // Packed load-shedding state: effective frame (upper 32 bits), previous
+  // shed count (bits 16..31), current shed count (bits 0..15)
+  std::atomic<uint64_t> ant_shed_state_ = 0;
+  // If positive, kernel-mode UDP sockets busy-poll the device queue for up
+  // to this many microseconds on an empty recv (SO_BUSY_POLL)
+  size_t udp_busy_poll_us_;
+  // If positive, overrides the per-site default SO_RCVBUF request for
+  // kernel-mode UDP RX sockets
+  size_t udp_rx_buffer_bytes_;
   bool correct_phase_shift_;  // If true, do phase shift correction
 
   // The total number of uncoded data bytes in each OFDM symbol
@@ -640,6 +1121,10 @@ class Config {
   // IP address of the machine running the baseband processing for BS
   std::string bs_server_addr_;
 
+  // Per-cell baseband server addresses (bs_server_addr_list), one entry
+  // per cell. Defaults to num_cells copies of bs_server_addr
+  std::vector<std::string> bs_server_addr_list_;
+
   // IP address of the base station RRU, RRU emulator (sender),
   // or channel simulator
   std::string bs_rru_addr_;
@@ -663,6 +1148,49 @@ class Config {
   // Offset of the first NIC port used by Agora's DPDK mode
   uint16_t dpdk_port_offset_;
 
+  // Spread RX traffic across the DPDK queues with symmetric RSS instead of
+  // per-port exact-match flow rules. Helps when per-antenna traffic is
+  // skewed and a few flow rules would hotspot one queue
+  bool dpdk_rss_;
+
+  // Pace downlink TX so each symbol's packets are spread across the symbol
+  // duration instead of bursting as soon as precode/IFFT completes.
+  // Protects switch buffers and radio ingress FIFOs from microbursts
+  bool tx_pacing_;
+
+  // Receive uplink packets through AF_XDP sockets instead of the UDP
+  // stack. Runtime-selectable kernel bypass for shared NICs that cannot
+  // be dedicated to DPDK; requires a binary built with USE_AF_XDP
+  bool xdp_transport_;
+
+  // Network interface the AF_XDP sockets bind to (one RX queue per
+  // socket thread)
+  std::string xdp_if_;
+
+  // Reclaim RX packet slots by frame epoch instead of per-packet
+  // reference counting: the RX thread stamps each slot with its packet's
+  // frame id and reuses slots whose frame the master has completed,
+  // removing the Use()/Free() atomic RMW per packet. Plain socket
+  // datapath only
+  bool rx_epoch_reclaim_;
+
+  // Capture mode: mirror every packet received on the plain socket
+  // datapath, with its RX timestamp, into this spool file for offline
+  // replay. Empty disables capture
+  std::string capture_spool_;
+
+  // Spool file capacity in bytes; capture stops with a warning once the
+  // file is full
+  size_t capture_spool_bytes_;
+
+  // Replay mode: feed a previously captured spool file through the full
+  // pipeline instead of receiving from the network. Empty disables replay
+  std::string replay_spool_;
+
+  // Replay timing scale: 1 preserves the captured inter-packet spacing,
+  // larger values replay proportionally faster
+  double replay_speedup_;
+
   // Port ID at BaseStation MAC layer side
   size_t bs_mac_rx_port_;
   size_t bs_mac_tx_port_;
@@ -675,6 +1203,13 @@ class Config {
   // processed by Agora before exiting.
   size_t frames_to_test_;
 
+  // Runtime frame window: number of frames the windowed buffers keep in
+  // flight. Defaults to the compile-time capacity kFrameWnd, which stays
+  // the upper bound (pointer grids and counters are dimensioned with it);
+  // smaller values cut the big per-frame buffers for deployments that do
+  // not need the full jitter tolerance
+  size_t frame_wnd_;
+
   // Size of tranport block given by upper layer
   size_t transport_block_size_;
 
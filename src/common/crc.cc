@@ -85,21 +85,31 @@ void DoCRC::AddCrc24(MacPacketPacked* p) {
 }
 
 uint32_t DoCRC::CalculateCrc24(const unsigned char* data, int len) {
-  /*
-   *
-   */
-  int i;
-  uint32_t crc = 0;
+  return FinalizeCrc24(UpdateCrc24(InitCrc24(), data, len));
+}
 
-  for (i = 0; i < len; i++) {
+uint32_t DoCRC::UpdateCrc24(uint32_t crc, const unsigned char* data,
+                            int len) const {
+  /* The byte-wise table walk carries the full register between calls, so
+   * spans fold in exactly as if they were contiguous. There is no hardware
+   * path: the SSE4.2 crc32 instruction fixes the CRC-32C polynomial and
+   * cannot produce this CRC-24Q
+   */
+  for (int i = 0; i < len; i++) {
     crc = (crc << 8) ^ crc24_table_[data[i] ^ (unsigned char)(crc >> 16)];
   }
-
-  crc = (crc & 0x00ffffff);
-
   return crc;
 }
 
+uint32_t DoCRC::CalculateCrc24Spans(const unsigned char* const* spans,
+                                    const int* lens, size_t num_spans) const {
+  uint32_t crc = InitCrc24();
+  for (size_t span = 0; span < num_spans; span++) {
+    crc = UpdateCrc24(crc, spans[span], lens[span]);
+  }
+  return FinalizeCrc24(crc);
+}
+
 bool DoCRC::CheckCrc24(unsigned char* data, int len, uint32_t ref_crc) {
   /*
    * Compute CRC for incoming packet and verify it matches the CRC entry.
@@ -102,6 +102,21 @@ class DoCRC {
    */
   uint32_t CalculateCrc24(const unsigned char* data, int len);
 
+  /* Incremental interface: start a running CRC24, fold spans into it one
+   * at a time, then reduce to the 24-bit checksum. Lets the CRC cover
+   * discontiguous data (e.g. a packet header plus an in-place payload)
+   * without a contiguous staging copy
+   */
+  static uint32_t InitCrc24() { return CRCSEED; }
+  uint32_t UpdateCrc24(uint32_t crc, const unsigned char* data, int len) const;
+  static uint32_t FinalizeCrc24(uint32_t crc) { return (crc & 0x00ffffff); }
+
+  /*
+   * Compute CRC over a gather list of discontiguous spans
+   */
+  uint32_t CalculateCrc24Spans(const unsigned char* const* spans,
+                               const int* lens, size_t num_spans) const;
+
   /*
    * Compute and add CRC to packet
    */
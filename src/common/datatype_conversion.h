@@ -15,6 +15,26 @@
 
 //#define DATATYPE_MEMORY_CHECK
 
+#ifdef __AVX512F__
+// Runtime checks for the AVX-512 converter fast paths. The binary only
+// contains those paths when built with AVX-512 enabled, but deployment
+// images are sometimes built on one machine generation and run on another,
+// so the dispatch is resolved against the executing CPU (once, cached in a
+// function-local static), like the soft-demodulator table in modulation.cc.
+static inline bool CpuHasAvx512f() {
+  static const bool has_avx512f = (__builtin_cpu_supports("avx512f") != 0);
+  return has_avx512f;
+}
+
+// The float-to-short converters additionally need AVX512BW for VPACKSSDW
+static inline bool CpuHasAvx512bw() {
+  static const bool has_avx512bw =
+      (__builtin_cpu_supports("avx512f") != 0) &&
+      (__builtin_cpu_supports("avx512bw") != 0);
+  return has_avx512bw;
+}
+#endif  // __AVX512F__
+
 // Convert a short array [in_buf] to a float array [out_buf]. Each array must
 // have [n_elems] elements.
 // in_buf and out_buf must be 64-byte aligned
@@ -31,21 +51,26 @@ static inline void SimdConvertShortToFloat(const short* in_buf, float* out_buf,
 #endif
 
 #if defined(__AVX512F__)
-  const __m512 magic = _mm512_set1_ps(float((1 << 23) + (1 << 15)) / 32768.f);
-  const __m512i magic_i = _mm512_castps_si512(magic);
-  for (size_t i = 0; i < n_elems; i += 16) {
-    /* get input */
-    __m256i val = _mm256_load_si256((__m256i*)(in_buf + i));  // port 2,3
-    /* interleave with 0x0000 */
-    __m512i val_unpacked = _mm512_cvtepu16_epi32(val);  // port 5
-    /* convert by xor-ing and subtracting magic value:
-     * VPXOR avoids port5 bottlenecks on Intel CPUs before SKL */
-    __m512i val_f_int = _mm512_xor_si512(val_unpacked, magic_i);  // port 0,1,5
-    __m512 val_f = _mm512_castsi512_ps(val_f_int);   // no instruction
-    __m512 converted = _mm512_sub_ps(val_f, magic);  // port 1,5 ?
-    _mm512_store_ps(out_buf + i, converted);         // port 2,3,4,7
+  if (CpuHasAvx512f()) {
+    const __m512 magic =
+        _mm512_set1_ps(float((1 << 23) + (1 << 15)) / 32768.f);
+    const __m512i magic_i = _mm512_castps_si512(magic);
+    for (size_t i = 0; i < n_elems; i += 16) {
+      /* get input */
+      __m256i val = _mm256_load_si256((__m256i*)(in_buf + i));  // port 2,3
+      /* interleave with 0x0000 */
+      __m512i val_unpacked = _mm512_cvtepu16_epi32(val);  // port 5
+      /* convert by xor-ing and subtracting magic value:
+       * VPXOR avoids port5 bottlenecks on Intel CPUs before SKL */
+      __m512i val_f_int =
+          _mm512_xor_si512(val_unpacked, magic_i);     // port 0,1,5
+      __m512 val_f = _mm512_castsi512_ps(val_f_int);   // no instruction
+      __m512 converted = _mm512_sub_ps(val_f, magic);  // port 1,5 ?
+      _mm512_store_ps(out_buf + i, converted);         // port 2,3,4,7
+    }
+    return;
   }
-#else
+#endif
   const __m256 magic = _mm256_set1_ps(float((1 << 23) + (1 << 15)) / 32768.f);
   const __m256i magic_i = _mm256_castps_si256(magic);
   for (size_t i = 0; i < n_elems; i += 16) {
@@ -69,7 +94,44 @@ static inline void SimdConvertShortToFloat(const short* in_buf, float* out_buf,
     __m256 converted1 = _mm256_sub_ps(val_f1, magic);  // port 1,5 ?
     _mm256_store_ps(out_buf + i + 8, converted1);      // port 2,3,4,7
   }
+}
+
+// Convert a short array [in_buf] to a float array [out_buf] WITHOUT the
+// 1 / 32768 scaling applied by SimdConvertShortToFloat(). For use with FFT
+// descriptors that fold the scaling into DFTI_FORWARD_SCALE, where the plain
+// widening conversion saves the xor + subtract of the magic-number trick.
+// in_buf and out_buf must be 64-byte aligned, n_elems a multiple of 16
+static inline void SimdConvertShortToFloatUnscaled(const short* in_buf,
+                                                   float* out_buf,
+                                                   size_t n_elems) {
+#if defined(DATATYPE_MEMORY_CHECK)
+  RtAssert(((n_elems % 16) == 0) &&
+               ((reinterpret_cast<size_t>(in_buf) % 64) == 0) &&
+               ((reinterpret_cast<size_t>(out_buf) % 64) == 0),
+           "Data Alignment not correct before calling into AVX optimizations");
+#endif
+
+#if defined(__AVX512F__)
+  if (CpuHasAvx512f()) {
+    for (size_t i = 0; i < n_elems; i += 16) {
+      __m256i val = _mm256_load_si256((__m256i*)(in_buf + i));
+      __m512i val_unpacked = _mm512_cvtepi16_epi32(val);  // sign-extend
+      __m512 converted = _mm512_cvtepi32_ps(val_unpacked);
+      _mm512_store_ps(out_buf + i, converted);
+    }
+    return;
+  }
 #endif
+  for (size_t i = 0; i < n_elems; i += 16) {
+    __m128i val = _mm_load_si128((__m128i*)(in_buf + i));
+    __m128i val1 = _mm_load_si128((__m128i*)(in_buf + i + 8));
+    __m256i val_unpacked = _mm256_cvtepi16_epi32(val);  // sign-extend
+    __m256 converted = _mm256_cvtepi32_ps(val_unpacked);
+    _mm256_store_ps(out_buf + i, converted);
+    __m256i val_unpacked1 = _mm256_cvtepi16_epi32(val1);
+    __m256 converted1 = _mm256_cvtepi32_ps(val_unpacked1);
+    _mm256_store_ps(out_buf + i + 8, converted1);
+  }
 }
 
 // Convert a float array [in_buf] to a short array [out_buf]. Input array must
@@ -90,30 +152,124 @@ static inline void SimdConvertFloatToShort(const float* in_buf, short* out_buf,
   const float scale_factor_float = 32768.0 / scale_down_factor;
 
 #ifdef __AVX512F__
-  const __m512 scale_factor = _mm512_set1_ps(scale_factor_float);
-  const __m512i permute_index = _mm512_setr_epi64(0, 2, 4, 6, 1, 3, 5, 7);
-  for (size_t i = 0; i < n_elems; i += 16) {
-    __m512 in1 = _mm512_load_ps(in_buf + 2 * i);
-    __m512 in2 = _mm512_load_ps(in_buf + 2 * i + 16);
-    __m512 scaled_in1 = _mm512_mul_ps(in1, scale_factor);
-    __m512 scaled_in2 = _mm512_mul_ps(in2, scale_factor);
-    __m512i integer1 = _mm512_cvtps_epi32(scaled_in1);
-    __m512i integer2 = _mm512_cvtps_epi32(scaled_in2);
-    integer1 = _mm512_packs_epi32(integer1, integer2);
-    integer1 = _mm512_permutexvar_epi64(permute_index, integer1);
-    _mm512_stream_si512((__m512i*)&out_buf[2 * (i + cp_len)], integer1);
+  if (CpuHasAvx512bw()) {
+    const __m512 scale_factor = _mm512_set1_ps(scale_factor_float);
+    const __m512i permute_index = _mm512_setr_epi64(0, 2, 4, 6, 1, 3, 5, 7);
+    for (size_t i = 0; i < n_elems; i += 16) {
+      __m512 in1 = _mm512_load_ps(in_buf + 2 * i);
+      __m512 in2 = _mm512_load_ps(in_buf + 2 * i + 16);
+      __m512 scaled_in1 = _mm512_mul_ps(in1, scale_factor);
+      __m512 scaled_in2 = _mm512_mul_ps(in2, scale_factor);
+      __m512i integer1 = _mm512_cvtps_epi32(scaled_in1);
+      __m512i integer2 = _mm512_cvtps_epi32(scaled_in2);
+      integer1 = _mm512_packs_epi32(integer1, integer2);
+      integer1 = _mm512_permutexvar_epi64(permute_index, integer1);
+      _mm512_stream_si512((__m512i*)&out_buf[2 * (i + cp_len)], integer1);
+      // Set cyclic prefix
+      if (i >= n_elems - cp_len)
+        _mm512_stream_si512((__m512i*)&out_buf[2 * (i + cp_len - n_elems)],
+                            integer1);
+    }
+    return;
+  }
+#endif
+  const __m256 scale_factor = _mm256_set1_ps(scale_factor_float);
+  for (size_t i = 0; i < n_elems; i += 8) {
+    __m256 in1 = _mm256_load_ps(in_buf + 2 * i);
+    __m256 in2 = _mm256_load_ps(in_buf + 2 * i + 8);
+    __m256 scaled_in1 = _mm256_mul_ps(in1, scale_factor);
+    __m256 scaled_in2 = _mm256_mul_ps(in2, scale_factor);
+    __m256i integer1 = _mm256_cvtps_epi32(scaled_in1);
+    __m256i integer2 = _mm256_cvtps_epi32(scaled_in2);
+    integer1 = _mm256_packs_epi32(integer1, integer2);
+    integer1 = _mm256_permute4x64_epi64(integer1, 0xD8);
+    _mm256_stream_si256((__m256i*)&out_buf[2 * (i + cp_len)], integer1);
     // Set cyclic prefix
-    if (i >= n_elems - cp_len)
-      _mm512_stream_si512((__m512i*)&out_buf[2 * (i + cp_len - n_elems)],
+    if (i >= n_elems - cp_len) {
+      _mm256_stream_si256((__m256i*)&out_buf[2 * (i + cp_len - n_elems)],
                           integer1);
+    }
   }
-#else
+}
+
+// Variant of SimdConvertFloatToShort() that also clips each complex sample
+// to a maximum magnitude of [clip_level] (in short full-scale units) before
+// conversion, for downlink PAPR reduction. Samples above the threshold are
+// scaled back onto the circle (polar clipping), preserving their phase.
+// Same alignment and size requirements as SimdConvertFloatToShort().
+static inline void SimdConvertFloatToShortClipped(const float* in_buf,
+                                                  short* out_buf,
+                                                  size_t n_elems, size_t cp_len,
+                                                  size_t scale_down_factor,
+                                                  float clip_level) {
+#if defined(DATATYPE_MEMORY_CHECK)
+  RtAssert(((n_elems % 16) == 0) &&
+               ((reinterpret_cast<size_t>(in_buf) % 64) == 0) &&
+               ((reinterpret_cast<size_t>(out_buf) % 64) == 0),
+           "Data Alignment not correct before calling into AVX optimizations");
+#endif
+
+  const float scale_factor_float = 32768.0 / scale_down_factor;
+  const float clip_level_sq = clip_level * clip_level;
+
+#ifdef __AVX512F__
+  if (CpuHasAvx512bw()) {
+    const __m512 scale_factor = _mm512_set1_ps(scale_factor_float);
+    const __m512 clip = _mm512_set1_ps(clip_level);
+    const __m512 clip_sq = _mm512_set1_ps(clip_level_sq);
+    const __m512i permute_index = _mm512_setr_epi64(0, 2, 4, 6, 1, 3, 5, 7);
+    for (size_t i = 0; i < n_elems; i += 16) {
+      __m512 in1 = _mm512_load_ps(in_buf + 2 * i);
+      __m512 in2 = _mm512_load_ps(in_buf + 2 * i + 16);
+      __m512 scaled_in1 = _mm512_mul_ps(in1, scale_factor);
+      __m512 scaled_in2 = _mm512_mul_ps(in2, scale_factor);
+      /* |x|^2 in both lanes of each IQ pair: square, then add the
+       * pair-swapped squares */
+      __m512 sq1 = _mm512_mul_ps(scaled_in1, scaled_in1);
+      __m512 sq2 = _mm512_mul_ps(scaled_in2, scaled_in2);
+      __m512 mag_sq1 = _mm512_add_ps(sq1, _mm512_permute_ps(sq1, 0xB1));
+      __m512 mag_sq2 = _mm512_add_ps(sq2, _mm512_permute_ps(sq2, 0xB1));
+      __mmask16 over1 = _mm512_cmp_ps_mask(mag_sq1, clip_sq, _CMP_GT_OQ);
+      __mmask16 over2 = _mm512_cmp_ps_mask(mag_sq2, clip_sq, _CMP_GT_OQ);
+      __m512 shrink1 = _mm512_div_ps(clip, _mm512_sqrt_ps(mag_sq1));
+      __m512 shrink2 = _mm512_div_ps(clip, _mm512_sqrt_ps(mag_sq2));
+      scaled_in1 = _mm512_mask_mul_ps(scaled_in1, over1, scaled_in1, shrink1);
+      scaled_in2 = _mm512_mask_mul_ps(scaled_in2, over2, scaled_in2, shrink2);
+      __m512i integer1 = _mm512_cvtps_epi32(scaled_in1);
+      __m512i integer2 = _mm512_cvtps_epi32(scaled_in2);
+      integer1 = _mm512_packs_epi32(integer1, integer2);
+      integer1 = _mm512_permutexvar_epi64(permute_index, integer1);
+      _mm512_stream_si512((__m512i*)&out_buf[2 * (i + cp_len)], integer1);
+      // Set cyclic prefix
+      if (i >= n_elems - cp_len)
+        _mm512_stream_si512((__m512i*)&out_buf[2 * (i + cp_len - n_elems)],
+                            integer1);
+    }
+    return;
+  }
+#endif
   const __m256 scale_factor = _mm256_set1_ps(scale_factor_float);
+  const __m256 clip = _mm256_set1_ps(clip_level);
+  const __m256 clip_sq = _mm256_set1_ps(clip_level_sq);
   for (size_t i = 0; i < n_elems; i += 8) {
     __m256 in1 = _mm256_load_ps(in_buf + 2 * i);
     __m256 in2 = _mm256_load_ps(in_buf + 2 * i + 8);
     __m256 scaled_in1 = _mm256_mul_ps(in1, scale_factor);
     __m256 scaled_in2 = _mm256_mul_ps(in2, scale_factor);
+    /* |x|^2 in both lanes of each IQ pair: square, then add the
+     * pair-swapped squares */
+    __m256 sq1 = _mm256_mul_ps(scaled_in1, scaled_in1);
+    __m256 sq2 = _mm256_mul_ps(scaled_in2, scaled_in2);
+    __m256 mag_sq1 = _mm256_add_ps(sq1, _mm256_permute_ps(sq1, 0xB1));
+    __m256 mag_sq2 = _mm256_add_ps(sq2, _mm256_permute_ps(sq2, 0xB1));
+    __m256 over1 = _mm256_cmp_ps(mag_sq1, clip_sq, _CMP_GT_OQ);
+    __m256 over2 = _mm256_cmp_ps(mag_sq2, clip_sq, _CMP_GT_OQ);
+    __m256 shrink1 = _mm256_div_ps(clip, _mm256_sqrt_ps(mag_sq1));
+    __m256 shrink2 = _mm256_div_ps(clip, _mm256_sqrt_ps(mag_sq2));
+    scaled_in1 = _mm256_blendv_ps(
+        scaled_in1, _mm256_mul_ps(scaled_in1, shrink1), over1);
+    scaled_in2 = _mm256_blendv_ps(
+        scaled_in2, _mm256_mul_ps(scaled_in2, shrink2), over2);
     __m256i integer1 = _mm256_cvtps_epi32(scaled_in1);
     __m256i integer2 = _mm256_cvtps_epi32(scaled_in2);
     integer1 = _mm256_packs_epi32(integer1, integer2);
@@ -125,7 +281,6 @@ static inline void SimdConvertFloatToShort(const float* in_buf, short* out_buf,
                           integer1);
     }
   }
-#endif
 }
 
 // Convert a float IQ array [in_buf] to an uint8_t IQ array [out_buf].
@@ -436,4 +591,51 @@ static inline void SimdConvertFloat32ToFloat16(float* out_buf,
 #endif
 }
 
+// Gather the CSI of one full transpose block (8 consecutive subcarriers) for
+// one user from the partially-transposed layout produced by DoFFT. In that
+// layout each antenna holds its block's 8 complex floats contiguously, so
+// one 64-byte load per antenna replaces one strided SIMD gather per
+// subcarrier. [src] points at the block's first antenna; [dst_cols] holds 8
+// pointers, one per subcarrier, each at the base of that subcarrier's
+// column-major CSI column. Column s receives the antenna's complex sample
+// for subcarrier s at float offset 2 * ant.
+static inline void SimdGatherCsiTransposeBlock(const float* src,
+                                               float* const* dst_cols,
+                                               size_t bs_ant_num) {
+#ifdef __AVX512F__
+  for (size_t ant = 0; ant < bs_ant_num; ant++) {
+    const __m512 blk = _mm512_loadu_ps(src + (ant * 16));
+    const __m128 q0 = _mm512_extractf32x4_ps(blk, 0);
+    const __m128 q1 = _mm512_extractf32x4_ps(blk, 1);
+    const __m128 q2 = _mm512_extractf32x4_ps(blk, 2);
+    const __m128 q3 = _mm512_extractf32x4_ps(blk, 3);
+    _mm_storel_pi(reinterpret_cast<__m64*>(dst_cols[0] + (ant * 2)), q0);
+    _mm_storeh_pi(reinterpret_cast<__m64*>(dst_cols[1] + (ant * 2)), q0);
+    _mm_storel_pi(reinterpret_cast<__m64*>(dst_cols[2] + (ant * 2)), q1);
+    _mm_storeh_pi(reinterpret_cast<__m64*>(dst_cols[3] + (ant * 2)), q1);
+    _mm_storel_pi(reinterpret_cast<__m64*>(dst_cols[4] + (ant * 2)), q2);
+    _mm_storeh_pi(reinterpret_cast<__m64*>(dst_cols[5] + (ant * 2)), q2);
+    _mm_storel_pi(reinterpret_cast<__m64*>(dst_cols[6] + (ant * 2)), q3);
+    _mm_storeh_pi(reinterpret_cast<__m64*>(dst_cols[7] + (ant * 2)), q3);
+  }
+#else
+  for (size_t ant = 0; ant < bs_ant_num; ant++) {
+    const __m256 lo = _mm256_loadu_ps(src + (ant * 16));
+    const __m256 hi = _mm256_loadu_ps(src + (ant * 16) + 8);
+    const __m128 q0 = _mm256_extractf128_ps(lo, 0);
+    const __m128 q1 = _mm256_extractf128_ps(lo, 1);
+    const __m128 q2 = _mm256_extractf128_ps(hi, 0);
+    const __m128 q3 = _mm256_extractf128_ps(hi, 1);
+    _mm_storel_pi(reinterpret_cast<__m64*>(dst_cols[0] + (ant * 2)), q0);
+    _mm_storeh_pi(reinterpret_cast<__m64*>(dst_cols[1] + (ant * 2)), q0);
+    _mm_storel_pi(reinterpret_cast<__m64*>(dst_cols[2] + (ant * 2)), q1);
+    _mm_storeh_pi(reinterpret_cast<__m64*>(dst_cols[3] + (ant * 2)), q1);
+    _mm_storel_pi(reinterpret_cast<__m64*>(dst_cols[4] + (ant * 2)), q2);
+    _mm_storeh_pi(reinterpret_cast<__m64*>(dst_cols[5] + (ant * 2)), q2);
+    _mm_storel_pi(reinterpret_cast<__m64*>(dst_cols[6] + (ant * 2)), q3);
+    _mm_storeh_pi(reinterpret_cast<__m64*>(dst_cols[7] + (ant * 2)), q3);
+  }
+#endif
+}
+
 #endif  // DATATYPE_CONVERSION_INC_
\ No newline at end of file
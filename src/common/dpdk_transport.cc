@@ -45,8 +45,24 @@ std::vector<uint16_t> DpdkTransport::GetPortIDFromMacAddr(
   return port_ids;
 }
 
+// 40-byte RSS key built from a repeated 16-bit pattern, which makes the
+// Toeplitz hash symmetric: flows that differ only by swapped source and
+// destination fields land on the same queue
+static constexpr uint8_t kSymmetricRssKey[40] = {
+    0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a,
+    0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a,
+    0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a,
+    0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a};
+
 int DpdkTransport::NicInit(uint16_t port, struct rte_mempool* mbuf_pool,
                            int thread_num, size_t pkt_len) {
+  const std::vector<struct rte_mempool*> mbuf_pools(thread_num, mbuf_pool);
+  return NicInit(port, mbuf_pools, thread_num, false, pkt_len);
+}
+
+int DpdkTransport::NicInit(
+    uint16_t port, const std::vector<struct rte_mempool*>& mbuf_pools,
+    int thread_num, bool enable_rss, size_t pkt_len, bool enable_tx_timestamp) {
   struct rte_eth_conf port_conf = port_conf_default();
   const uint16_t rxRings = thread_num, txRings = thread_num;
   int retval;
@@ -78,6 +94,34 @@ int DpdkTransport::NicInit(uint16_t port, struct rte_mempool* mbuf_pool,
   if (dev_info.tx_offload_capa & DEV_TX_OFFLOAD_MBUF_FAST_FREE)
     port_conf.txmode.offloads |= DEV_TX_OFFLOAD_MBUF_FAST_FREE;
 
+  // The TX paths mark every mbuf with PKT_TX_IP_CKSUM | PKT_TX_UDP_CKSUM;
+  // let the NIC fill both checksums instead of leaving them zero
+  if ((dev_info.tx_offload_capa & DEV_TX_OFFLOAD_IPV4_CKSUM) &&
+      (dev_info.tx_offload_capa & DEV_TX_OFFLOAD_UDP_CKSUM)) {
+    port_conf.txmode.offloads |=
+        (DEV_TX_OFFLOAD_IPV4_CKSUM | DEV_TX_OFFLOAD_UDP_CKSUM);
+  }
+
+#if defined(DEV_TX_OFFLOAD_SEND_ON_TIMESTAMP)
+  if (enable_tx_timestamp &&
+      (dev_info.tx_offload_capa & DEV_TX_OFFLOAD_SEND_ON_TIMESTAMP)) {
+    port_conf.txmode.offloads |= DEV_TX_OFFLOAD_SEND_ON_TIMESTAMP;
+  }
+#else
+  unused(enable_tx_timestamp);
+#endif
+
+  if (enable_rss) {
+    port_conf.rxmode.mq_mode = ETH_MQ_RX_RSS;
+    port_conf.rx_adv_conf.rss_conf.rss_key =
+        const_cast<uint8_t*>(kSymmetricRssKey);
+    port_conf.rx_adv_conf.rss_conf.rss_key_len = sizeof(kSymmetricRssKey);
+    port_conf.rx_adv_conf.rss_conf.rss_hf =
+        ETH_RSS_NONFRAG_IPV4_UDP & dev_info.flow_type_rss_offloads;
+    RtAssert(port_conf.rx_adv_conf.rss_conf.rss_hf != 0,
+             "DPDK: NIC cannot hash UDP flows for RSS");
+  }
+
   port_conf.rxmode.max_rx_pkt_len =
       RTE_MIN(RTE_MIN(dev_info.max_rx_pktlen, port_conf.rxmode.max_rx_pkt_len),
               pkt_len);
@@ -92,8 +136,9 @@ int DpdkTransport::NicInit(uint16_t port, struct rte_mempool* mbuf_pool,
   rxconf.offloads = port_conf.rxmode.offloads;
 
   for (q = 0; q < rxRings; q++) {
-    retval = rte_eth_rx_queue_setup(
-        port, q, nb_rxd, rte_eth_dev_socket_id(port), &rxconf, mbuf_pool);
+    retval = rte_eth_rx_queue_setup(port, q, nb_rxd,
+                                    rte_eth_dev_socket_id(port), &rxconf,
+                                    mbuf_pools.at(q));
     if (retval < 0) return retval;
   }
 
@@ -263,16 +308,11 @@ void DpdkTransport::InstallFlowRule(uint16_t port_id, uint16_t rx_q,
   RtAssert(flow != nullptr, "DPDK: Failed to install flow rule");
 }
 
-rte_mbuf* DpdkTransport::AllocUdp(rte_mempool* mbuf_pool,
-                                  rte_ether_addr src_mac_addr,
-                                  rte_ether_addr dst_mac_addr,
-                                  uint32_t src_ip_addr, uint32_t dst_ip_addr,
-                                  uint16_t src_udp_port, uint16_t dst_udp_port,
-                                  size_t buffer_length) {
-  rte_mbuf* tx_buf __attribute__((aligned(64)));
-  tx_buf = rte_pktmbuf_alloc(mbuf_pool);
-
-  rte_ether_hdr* eth_hdr = rte_pktmbuf_mtod(tx_buf, rte_ether_hdr*);
+void DpdkTransport::FillUdpHeaderTemplate(
+    uint8_t* header_template, rte_ether_addr src_mac_addr,
+    rte_ether_addr dst_mac_addr, uint32_t src_ip_addr, uint32_t dst_ip_addr,
+    uint16_t src_udp_port, uint16_t dst_udp_port, size_t buffer_length) {
+  auto* eth_hdr = (rte_ether_hdr*)header_template;
   eth_hdr->ether_type = rte_be_to_cpu_16(RTE_ETHER_TYPE_IPV4);
   std::memcpy(eth_hdr->s_addr.addr_bytes, src_mac_addr.addr_bytes,
               RTE_ETHER_ADDR_LEN);
@@ -298,14 +338,42 @@ rte_mbuf* DpdkTransport::AllocUdp(rte_mempool* mbuf_pool,
   udp_h->dgram_len =
       rte_cpu_to_be_16(buffer_length + kPayloadOffset - sizeof(rte_ether_hdr) -
                        sizeof(rte_ipv4_hdr));
+  // The NIC's L4 offload expects the pseudo-header checksum here; it
+  // depends only on fields baked into the template
+  udp_h->dgram_cksum = rte_ipv4_phdr_cksum(
+      ip_h, PKT_TX_IPV4 | PKT_TX_IP_CKSUM | PKT_TX_UDP_CKSUM);
+}
 
+rte_mbuf* DpdkTransport::AllocUdpFromTemplate(rte_mempool* mbuf_pool,
+                                              const uint8_t* header_template,
+                                              size_t buffer_length) {
+  rte_mbuf* tx_buf __attribute__((aligned(64)));
+  tx_buf = rte_pktmbuf_alloc(mbuf_pool);
+
+  rte_memcpy(rte_pktmbuf_mtod(tx_buf, uint8_t*), header_template,
+             kInetHdrsTotSize);
   tx_buf->pkt_len = buffer_length + kPayloadOffset;
   tx_buf->data_len = buffer_length + kPayloadOffset;
-  tx_buf->ol_flags = (PKT_TX_IP_CKSUM | PKT_TX_UDP_CKSUM);
+  tx_buf->ol_flags = (PKT_TX_IPV4 | PKT_TX_IP_CKSUM | PKT_TX_UDP_CKSUM);
+  tx_buf->l2_len = sizeof(rte_ether_hdr);
+  tx_buf->l3_len = sizeof(rte_ipv4_hdr);
 
   return tx_buf;
 }
 
+rte_mbuf* DpdkTransport::AllocUdp(rte_mempool* mbuf_pool,
+                                  rte_ether_addr src_mac_addr,
+                                  rte_ether_addr dst_mac_addr,
+                                  uint32_t src_ip_addr, uint32_t dst_ip_addr,
+                                  uint16_t src_udp_port, uint16_t dst_udp_port,
+                                  size_t buffer_length) {
+  uint8_t header_template[kInetHdrsTotSize];
+  FillUdpHeaderTemplate(header_template, src_mac_addr, dst_mac_addr,
+                        src_ip_addr, dst_ip_addr, src_udp_port, dst_udp_port,
+                        buffer_length);
+  return AllocUdpFromTemplate(mbuf_pool, header_template, buffer_length);
+}
+
 void DpdkTransport::DpdkInit(uint16_t core_offset, size_t thread_num) {
   // DPDK setup
   std::string core_list = std::to_string(GetPhysicalCoreId(core_offset));
@@ -324,11 +392,15 @@ void DpdkTransport::DpdkInit(uint16_t core_offset, size_t thread_num) {
 }
 
 rte_mempool* DpdkTransport::CreateMempool(size_t num_ports,
-                                          size_t packet_length) {
+                                          size_t packet_length,
+                                          size_t num_mbufs, const char* name,
+                                          int socket_id) {
+  if (socket_id < 0) {
+    socket_id = rte_socket_id();
+  }
   size_t mbuf_size = packet_length + kMBufCacheSize;
-  rte_mempool* mbuf_pool =
-      rte_pktmbuf_pool_create("MBUF_POOL", kNumMBufs * num_ports,
-                              kMBufCacheSize, 0, mbuf_size, rte_socket_id());
+  rte_mempool* mbuf_pool = rte_pktmbuf_pool_create(
+      name, num_mbufs * num_ports, kMBufCacheSize, 0, mbuf_size, socket_id);
 
   RtAssert(mbuf_pool != NULL, "Cannot create mbuf pool");
 
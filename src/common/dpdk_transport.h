@@ -18,6 +18,7 @@
 #include <rte_flow.h>
 #include <rte_ip.h>
 #include <rte_malloc.h>
+#include <rte_mbuf_dyn.h>
 #include <rte_pause.h>
 #include <rte_prefetch.h>
 #include <rte_udp.h>
@@ -25,7 +26,7 @@
 
 #include <string>
 
-// #include "eth_common.h"
+#include "eth_common.h"
 #include "utils.h"
 
 static constexpr size_t kRxRingSize = 2048;
@@ -40,10 +41,14 @@ static constexpr size_t kJumboFrameMaxSize = 0x2600;
 static constexpr size_t kRxBatchSize = 16;
 static constexpr size_t kTxBatchSize = 1;
 
-/// Offset to the payload starting from the beginning of the UDP frame
-static constexpr size_t kPayloadOffset = sizeof(struct rte_ether_hdr) +
-                                         sizeof(struct rte_ipv4_hdr) +
-                                         sizeof(struct rte_udp_hdr) + 22;
+/// Offset to the payload starting from the beginning of the UDP frame;
+/// kInetHdrsTotSize (eth_common.h) covers the wire headers and matches
+/// the DPDK header structs
+static_assert(kInetHdrsTotSize == sizeof(struct rte_ether_hdr) +
+                                      sizeof(struct rte_ipv4_hdr) +
+                                      sizeof(struct rte_udp_hdr),
+              "");
+static constexpr size_t kPayloadOffset = kInetHdrsTotSize + 22;
 static_assert(kPayloadOffset == 64, "");
 
 class DpdkTransport {
@@ -57,6 +62,18 @@ class DpdkTransport {
   static int NicInit(uint16_t port, struct rte_mempool* mbuf_pool,
                      int thread_num, size_t pkt_len = kJumboFrameMaxSize);
 
+  // Initialize [port] with one RX/TX queue pair per entry of [mbuf_pools],
+  // giving each RX queue its own mempool. When [enable_rss] is set, the
+  // port hashes incoming UDP flows across the RX queues with a symmetric
+  // RSS key instead of relying on exact-match flow rules. When
+  // [enable_tx_timestamp] is set and the NIC supports send-on-timestamp,
+  // the TX queues honor per-mbuf wire times
+  static int NicInit(uint16_t port,
+                     const std::vector<struct rte_mempool*>& mbuf_pools,
+                     int thread_num, bool enable_rss,
+                     size_t pkt_len = kJumboFrameMaxSize,
+                     bool enable_tx_timestamp = false);
+
   // Steer the flow [src_ip, dest_ip, src_port, dst_port] arriving on
   // [port_id] to RX queue [rx_q]
   static void InstallFlowRule(uint16_t port_id, uint16_t rx_q, uint32_t src_ip,
@@ -70,6 +87,26 @@ class DpdkTransport {
   /// Return a string representation of this packet
   static std::string PktToString(const rte_mbuf* pkt);
 
+  /// Build the kInetHdrsTotSize-byte Ethernet+IPv4+UDP header image for a
+  /// stream of fixed-length packets into [header_template]. Every field is
+  /// baked in, including the length fields and the UDP pseudo-header
+  /// checksum the NIC's L4 offload folds into the final checksum, so the
+  /// TX path stamps each packet with a single copy
+  static void FillUdpHeaderTemplate(uint8_t* header_template,
+                                    rte_ether_addr src_mac_addr,
+                                    rte_ether_addr dst_mac_addr,
+                                    uint32_t src_ip_addr, uint32_t dst_ip_addr,
+                                    uint16_t src_udp_port,
+                                    uint16_t dst_udp_port,
+                                    size_t buffer_length);
+
+  /// Allocate a fresh rte_mbuf and stamp its headers from a template
+  /// built by FillUdpHeaderTemplate for the same [buffer_length], arming
+  /// IPv4 and UDP checksum offload
+  static rte_mbuf* AllocUdpFromTemplate(rte_mempool* mbuf_pool,
+                                        const uint8_t* header_template,
+                                        size_t buffer_length);
+
   /// Allocate and return a fresh rte_mbuf with Ethernet, IPv4, and UDP
   /// header filled
   static rte_mbuf* AllocUdp(rte_mempool* mbuf_pool, rte_ether_addr src_mac_addr,
@@ -79,8 +116,14 @@ class DpdkTransport {
 
   /// Init dpdk on core [core_offset:core_offset+thread_num]
   static void DpdkInit(uint16_t core_offset, size_t thread_num);
+  /// [socket_id] places the pool on a specific NUMA node (pass the port's
+  /// rte_eth_dev_socket_id for node-local mbufs); negative means the
+  /// caller's node
   static rte_mempool* CreateMempool(size_t num_ports,
-                                    size_t packet_length = kJumboFrameMaxSize);
+                                    size_t packet_length = kJumboFrameMaxSize,
+                                    size_t num_mbufs = kNumMBufs,
+                                    const char* name = "MBUF_POOL",
+                                    int socket_id = -1);
 };
 
 #endif  // DPDK_TRANSPORT_H_
\ No newline at end of file
@@ -0,0 +1,85 @@
+/**
+ * @file equal_export.cc
+ * @brief Implementation of the shared-memory constellation export window
+ * (see equal_export.h)
+ */
+#include "equal_export.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cstring>
+
+#include "logger.h"
+#include "utils.h"
+
+EqualExport::EqualExport(Config* cfg)
+    : cfg_(cfg),
+      decimation_(cfg->EqualExportDecimation()),
+      num_scs_(1 + ((cfg->OfdmDataNum() - 1) / decimation_)),
+      payload_bytes_(num_scs_ * cfg->UeAntNum() * sizeof(complex_float)),
+      shm_name_(cfg->EqualExportShm()) {
+  RtAssert(kExportConstellation == true,
+           "equal_export requires kExportConstellation (symbols.h), or the "
+           "equalizer output is never kept");
+
+  map_bytes_ = EqualExportHdr::kPayloadOffset + payload_bytes_;
+  shm_fd_ = shm_open(shm_name_.c_str(), O_CREAT | O_RDWR, 0644);
+  RtAssert(shm_fd_ >= 0, "EqualExport: shm_open(" + shm_name_ + ") failed");
+  RtAssert(ftruncate(shm_fd_, map_bytes_) == 0,
+           "EqualExport: ftruncate failed");
+  void* map = mmap(nullptr, map_bytes_, PROT_READ | PROT_WRITE, MAP_SHARED,
+                   shm_fd_, 0);
+  RtAssert(map != MAP_FAILED, "EqualExport: mmap failed");
+
+  hdr_ = static_cast<EqualExportHdr*>(map);
+  payload_ = static_cast<uint8_t*>(map) + EqualExportHdr::kPayloadOffset;
+  std::memset(map, 0, map_bytes_);
+
+  // Fill the geometry before the magic so a reader that sees the magic
+  // sees a complete header
+  hdr_->version_ = 1;
+  hdr_->ue_ant_num_ = static_cast<uint32_t>(cfg->UeAntNum());
+  hdr_->num_scs_ = static_cast<uint32_t>(num_scs_);
+  hdr_->decimation_ = static_cast<uint32_t>(decimation_);
+  hdr_->payload_bytes_ = static_cast<uint32_t>(payload_bytes_);
+  hdr_->seq_.store(0, std::memory_order_release);
+  hdr_->magic_ = EqualExportHdr::kMagic;
+
+  MLPD_INFO("EqualExport: publishing %zu of %zu subcarriers x %zu UEs to %s\n",
+            num_scs_, cfg->OfdmDataNum(), cfg->UeAntNum(), shm_name_.c_str());
+}
+
+EqualExport::~EqualExport() {
+  if (hdr_ != nullptr) {
+    munmap(hdr_, map_bytes_);
+    hdr_ = nullptr;
+  }
+  if (shm_fd_ >= 0) {
+    close(shm_fd_);
+    shm_unlink(shm_name_.c_str());
+    shm_fd_ = -1;
+  }
+}
+
+void EqualExport::Publish(size_t frame_id, const complex_float* row) {
+  const size_t ue_ant_num = cfg_->UeAntNum();
+  const size_t chunk_bytes = ue_ant_num * sizeof(complex_float);
+
+  // Seqlock write side: readers retrying on an odd or changed seq_ never
+  // observe a torn payload
+  const uint64_t seq = hdr_->seq_.load(std::memory_order_relaxed);
+  hdr_->seq_.store(seq + 1, std::memory_order_release);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  uint8_t* dst = payload_;
+  for (size_t sc = 0; sc < cfg_->OfdmDataNum(); sc += decimation_) {
+    std::memcpy(dst, &row[sc * ue_ant_num], chunk_bytes);
+    dst += chunk_bytes;
+  }
+  hdr_->frame_id_ = frame_id;
+
+  std::atomic_thread_fence(std::memory_order_release);
+  hdr_->seq_.store(seq + 2, std::memory_order_release);
+}
@@ -0,0 +1,74 @@
+/**
+ * @file equal_export.h
+ * @brief Declarations for the shared-memory constellation export window:
+ * a seqlock-protected mapping external visualizers read without touching
+ * the pipeline
+ */
+#ifndef EQUAL_EXPORT_H_
+#define EQUAL_EXPORT_H_
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include "config.h"
+
+/// Header at the start of the shared-memory window. Readers map the
+/// region read-only, snapshot seq_, copy the payload, and re-check seq_:
+/// an odd value or a changed value means the writer raced the copy and
+/// the snapshot must be retried. The payload follows the header at
+/// kPayloadOffset: num_scs_ decimated subcarriers, each holding
+/// ue_ant_num_ interleaved (I, Q) float pairs, matching the
+/// equal_buffer_ row layout.
+struct EqualExportHdr {
+  static constexpr uint32_t kMagic = 0x51455145u;  // "EQEQ"
+  static constexpr size_t kPayloadOffset = 64;
+
+  uint32_t magic_;
+  uint32_t version_;
+  uint32_t ue_ant_num_;
+  uint32_t num_scs_;      /// Subcarriers exported per snapshot
+  uint32_t decimation_;   /// Every Nth data subcarrier is exported
+  uint32_t payload_bytes_;
+  /// Seqlock generation counter: odd while the writer is mid-update
+  std::atomic<uint64_t> seq_;
+  /// Frame the current payload was equalized in
+  uint64_t frame_id_;
+};
+static_assert(sizeof(EqualExportHdr) <= EqualExportHdr::kPayloadOffset,
+              "EqualExportHdr must fit before the payload");
+
+/**
+ * @brief Publishes equalized symbols to a POSIX shared-memory window.
+ *
+ * GetEqualData hands the python plotting tools a pointer into
+ * equal_buffer_ through the wrapper library, so every poll crosses into
+ * the process and races the pipeline's reuse of the row. This exporter
+ * instead copies one (optionally subcarrier-decimated) equalized symbol
+ * per frame into a shm_open window under a seqlock; visualizers map it
+ * read-only at whatever poll rate they like and the pipeline never sees
+ * them. Publish runs on the master and costs one decimated memcpy.
+ */
+class EqualExport {
+ public:
+  explicit EqualExport(Config* cfg);
+  ~EqualExport();
+
+  /// Publish one equalized symbol row (equal_buffer_ layout: subcarrier
+  /// major, UE antennas inner). Called only from the master thread
+  void Publish(size_t frame_id, const complex_float* row);
+
+ private:
+  Config* const cfg_;
+  const size_t decimation_;
+  const size_t num_scs_;
+  const size_t payload_bytes_;
+  const std::string shm_name_;
+
+  int shm_fd_ = -1;
+  size_t map_bytes_ = 0;
+  EqualExportHdr* hdr_ = nullptr;
+  uint8_t* payload_ = nullptr;
+};
+
+#endif  // EQUAL_EXPORT_H_
@@ -0,0 +1,86 @@
+/**
+ * @file fft_plan_cache.cc
+ * @brief Implementation file for the FftPlanCache class
+ */
+#include "fft_plan_cache.h"
+
+#include <map>
+#include <tuple>
+
+#include "utils.h"
+
+namespace {
+
+// (transform size, forward domain is real, out-of-place placement,
+//  forward scale)
+using PlanKey = std::tuple<size_t, bool, bool, float>;
+
+// Per-thread table of committed descriptors. The wrapper frees the handles
+// when the thread exits, so doers never need to manage descriptor lifetime.
+struct PlanTable {
+  std::map<PlanKey, DFTI_DESCRIPTOR_HANDLE> plans_;
+  ~PlanTable() {
+    for (auto& plan : plans_) {
+      DftiFreeDescriptor(&plan.second);
+    }
+  }
+};
+
+DFTI_DESCRIPTOR_HANDLE GetPlan(size_t fft_size, bool real_domain,
+                               bool out_of_place, float forward_scale) {
+  thread_local PlanTable table;
+  const PlanKey key(fft_size, real_domain, out_of_place, forward_scale);
+  auto it = table.plans_.find(key);
+  if (it != table.plans_.end()) {
+    return it->second;
+  }
+
+  DFTI_DESCRIPTOR_HANDLE handle = nullptr;
+  MKL_LONG status = DftiCreateDescriptor(
+      &handle, DFTI_SINGLE, real_domain ? DFTI_REAL : DFTI_COMPLEX, 1,
+      fft_size);
+  if (status == DFTI_NO_ERROR && real_domain) {
+    // Store the conjugate-even output as regular complex values so callers
+    // can read the first fft_size / 2 + 1 bins like any other FFT output
+    status = DftiSetValue(handle, DFTI_CONJUGATE_EVEN_STORAGE,
+                          DFTI_COMPLEX_COMPLEX);
+  }
+  if (status == DFTI_NO_ERROR && out_of_place) {
+    status = DftiSetValue(handle, DFTI_PLACEMENT, DFTI_NOT_INPLACE);
+  }
+  if (status == DFTI_NO_ERROR && forward_scale != 1.0f) {
+    status = DftiSetValue(handle, DFTI_FORWARD_SCALE, forward_scale);
+  }
+  if (status == DFTI_NO_ERROR) {
+    status = DftiCommitDescriptor(handle);
+  }
+  RtAssert(status == DFTI_NO_ERROR,
+           std::string("FftPlanCache: failed to commit DFTI descriptor: ") +
+               DftiErrorMessage(status));
+
+  table.plans_[key] = handle;
+  return handle;
+}
+
+}  // namespace
+
+DFTI_DESCRIPTOR_HANDLE FftPlanCache::Complex(size_t fft_size) {
+  return GetPlan(fft_size, false /* real_domain */, false /* out_of_place */,
+                 1.0f);
+}
+
+DFTI_DESCRIPTOR_HANDLE FftPlanCache::ComplexOutOfPlace(size_t fft_size) {
+  return GetPlan(fft_size, false /* real_domain */, true /* out_of_place */,
+                 1.0f);
+}
+
+DFTI_DESCRIPTOR_HANDLE FftPlanCache::ComplexForwardScaled(size_t fft_size,
+                                                          float forward_scale) {
+  return GetPlan(fft_size, false /* real_domain */, false /* out_of_place */,
+                 forward_scale);
+}
+
+DFTI_DESCRIPTOR_HANDLE FftPlanCache::Real(size_t fft_size) {
+  return GetPlan(fft_size, true /* real_domain */, false /* out_of_place */,
+                 1.0f);
+}
@@ -0,0 +1,52 @@
+/**
+ * @file fft_plan_cache.h
+ * @brief Declaration file for a process-wide cache of MKL DFTI descriptors
+ */
+#ifndef FFT_PLAN_CACHE_H_
+#define FFT_PLAN_CACHE_H_
+
+#include <cstddef>
+
+#include "mkl_dfti.h"
+
+/**
+ * Process-wide cache of committed single-precision MKL DFTI descriptors.
+ *
+ * Descriptor creation and commit are expensive (MKL selects a split-radix
+ * plan and allocates twiddle tables), so doers that are torn down and
+ * rebuilt on a reconfiguration should not pay that cost again for a shape
+ * they have already planned. Handles are cached per thread, keyed by
+ * (transform size, forward domain, placement), so compute calls never
+ * contend on a shared descriptor. The cache owns the handles and frees
+ * them at thread exit; callers must not call DftiFreeDescriptor() on a
+ * handle obtained here.
+ *
+ * Direction is not part of the key: a committed complex descriptor serves
+ * both DftiComputeForward() and DftiComputeBackward().
+ */
+class FftPlanCache {
+ public:
+  /// Return a committed in-place complex-to-complex descriptor for an
+  /// fft_size-point transform, creating it on first use by this thread.
+  static DFTI_DESCRIPTOR_HANDLE Complex(size_t fft_size);
+
+  /// Same as Complex() but configured for out-of-place transforms
+  /// (DFTI_PLACEMENT = DFTI_NOT_INPLACE).
+  static DFTI_DESCRIPTOR_HANDLE ComplexOutOfPlace(size_t fft_size);
+
+  /// Same as Complex() but with DFTI_FORWARD_SCALE set to forward_scale, so
+  /// a fixed input scaling (e.g. the short-to-float 1 / 32768 factor) is
+  /// folded into the transform's own twiddle multiplies for free.
+  static DFTI_DESCRIPTOR_HANDLE ComplexForwardScaled(size_t fft_size,
+                                                     float forward_scale);
+
+  /// Return a committed real-to-complex descriptor for an fft_size-point
+  /// forward transform of real input, with the conjugate-even output stored
+  /// in CCE (complex) format. Roughly halves the work of a complex plan for
+  /// inputs whose imaginary part is known to be zero.
+  static DFTI_DESCRIPTOR_HANDLE Real(size_t fft_size);
+
+  FftPlanCache() = delete;
+};
+
+#endif  // FFT_PLAN_CACHE_H_
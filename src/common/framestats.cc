@@ -58,6 +58,7 @@ FrameStats::FrameStats(std::string new_frame_id)
       }
     }
   }
+  this->BuildSymbolIdxMaps();
 }
 
 FrameStats::FrameStats(std::string new_frame_id, size_t ul, size_t dl)
@@ -65,6 +66,64 @@ FrameStats::FrameStats(std::string new_frame_id, size_t ul, size_t dl)
   this->SetClientPilotSyms(ul, dl);
 }
 
+void FrameStats::ReserveSymbolMaps(size_t capacity) {
+  this->frame_identifier_.reserve(capacity);
+  this->beacon_symbols_.reserve(capacity);
+  this->pilot_symbols_.reserve(capacity);
+  this->ul_symbols_.reserve(capacity);
+  this->ul_cal_symbols_.reserve(capacity);
+  this->dl_symbols_.reserve(capacity);
+  this->dl_cal_symbols_.reserve(capacity);
+  this->symbol_types_.reserve(capacity);
+  this->pilot_idx_map_.reserve(capacity);
+  this->ul_idx_map_.reserve(capacity);
+  this->dl_idx_map_.reserve(capacity);
+}
+
+void FrameStats::AdoptSchedule(const FrameStats& other) {
+  /* assign() reuses the reserved storage instead of swapping in other's,
+   * so pointers handed out before the switch stay valid */
+  this->frame_identifier_.assign(other.frame_identifier_);
+  this->beacon_symbols_.assign(other.beacon_symbols_.begin(),
+                               other.beacon_symbols_.end());
+  this->pilot_symbols_.assign(other.pilot_symbols_.begin(),
+                              other.pilot_symbols_.end());
+  this->ul_symbols_.assign(other.ul_symbols_.begin(), other.ul_symbols_.end());
+  this->ul_cal_symbols_.assign(other.ul_cal_symbols_.begin(),
+                               other.ul_cal_symbols_.end());
+  this->dl_symbols_.assign(other.dl_symbols_.begin(), other.dl_symbols_.end());
+  this->dl_cal_symbols_.assign(other.dl_cal_symbols_.begin(),
+                               other.dl_cal_symbols_.end());
+  this->client_ul_pilot_symbols_ = other.client_ul_pilot_symbols_;
+  this->client_dl_pilot_symbols_ = other.client_dl_pilot_symbols_;
+  this->BuildSymbolIdxMaps();
+}
+
+void FrameStats::BuildSymbolIdxMaps() {
+  const size_t num_syms = this->frame_identifier_.length();
+  /* assign() reuses the reserved storage, like AdoptSchedule above */
+  this->symbol_types_.assign(num_syms, SymbolType::kUnknown);
+  this->pilot_idx_map_.assign(num_syms, SIZE_MAX);
+  this->ul_idx_map_.assign(num_syms, SIZE_MAX);
+  this->dl_idx_map_.assign(num_syms, SIZE_MAX);
+
+  for (size_t i = 0; i < num_syms; i++) {
+    const auto type = kSymbolMap.find(this->frame_identifier_.at(i));
+    if (type != kSymbolMap.end()) {
+      this->symbol_types_.at(i) = type->second;
+    }
+  }
+  for (size_t loc = 0; loc < this->pilot_symbols_.size(); loc++) {
+    this->pilot_idx_map_.at(this->pilot_symbols_.at(loc)) = loc;
+  }
+  for (size_t loc = 0; loc < this->ul_symbols_.size(); loc++) {
+    this->ul_idx_map_.at(this->ul_symbols_.at(loc)) = loc;
+  }
+  for (size_t loc = 0; loc < this->dl_symbols_.size(); loc++) {
+    this->dl_idx_map_.at(this->dl_symbols_.at(loc)) = loc;
+  }
+}
+
 void FrameStats::SetClientPilotSyms(size_t ul, size_t dl) {
   /* Client pilot symbols must be strictly less than the number of corresponding
    * data symbols */
@@ -125,32 +184,5 @@ size_t FrameStats::GetBeaconSymbol(size_t location) const {
   return this->beacon_symbols_.at(location);
 }
 
-size_t FrameStats::GetSymbolIdx(const std::vector<size_t>& search_vector,
-                                size_t symbol_number) {
-  /* TODO: Optimize this, probably with a precomputed table -- assumes sorted
-   * list
-   */
-  const auto [start, finish] = std::equal_range(
-      search_vector.begin(), search_vector.end(), symbol_number);
-
-  if (start == finish) {
-    return SIZE_MAX;
-  } else if ((start + 1) == finish) {
-    return (start - search_vector.begin());
-  } else { /* Invalid, multiple locations */
-    assert(false);
-    return SIZE_MAX;
-  }
-}
-
-size_t FrameStats::GetDLSymbolIdx(size_t symbol_number) const {
-  return FrameStats::GetSymbolIdx(this->dl_symbols_, symbol_number);
-}
-
-size_t FrameStats::GetULSymbolIdx(size_t symbol_number) const {
-  return FrameStats::GetSymbolIdx(this->ul_symbols_, symbol_number);
-}
-
-size_t FrameStats::GetPilotSymbolIdx(size_t symbol_number) const {
-  return FrameStats::GetSymbolIdx(this->pilot_symbols_, symbol_number);
-}
+/* GetDLSymbolIdx/GetULSymbolIdx/GetPilotSymbolIdx are O(1) reads of the
+ * dense tables built in BuildSymbolIdxMaps(); see framestats.h */
@@ -10,9 +10,12 @@
 #ifndef FRAMESTATS_H_
 #define FRAMESTATS_H_
 
+#include <cassert>
 #include <string>
 #include <vector>
 
+#include "symbols.h"
+
 class FrameStats {
  public:
   explicit FrameStats(std::string new_frame_id);
@@ -20,6 +23,16 @@ class FrameStats {
 
   void SetClientPilotSyms(size_t ul, size_t dl);
 
+  /* Reserve every symbol map (and the identifier string) for [capacity]
+   * entries, so a later AdoptSchedule never reallocates */
+  void ReserveSymbolMaps(size_t capacity);
+
+  /* Replace this frame's schedule with other's, reusing the existing
+   * symbol-map storage (see ReserveSymbolMaps) so concurrent readers never
+   * chase freed vector storage. Callers must have validated that other's
+   * maps fit the reserved capacity */
+  void AdoptSchedule(const FrameStats& other);
+
   size_t NumDLCalSyms() const;
   size_t NumULCalSyms() const;
   size_t NumDLSyms() const;
@@ -36,7 +49,10 @@ class FrameStats {
     return ((this->dl_symbols_.empty()) ? SIZE_MAX : this->dl_symbols_.back());
   }
   /* Returns SIZE_MAX if there are no DL symbols */
-  size_t GetDLSymbolIdx(size_t symbol_number) const;
+  inline size_t GetDLSymbolIdx(size_t symbol_number) const {
+    assert(symbol_number < this->dl_idx_map_.size());
+    return this->dl_idx_map_[symbol_number];
+  }
 
   size_t GetULSymbol(size_t location) const;
   inline size_t GetULDataSymbol(size_t location) const {
@@ -46,10 +62,25 @@ class FrameStats {
     return ((this->ul_symbols_.empty()) ? SIZE_MAX : this->ul_symbols_.back());
   }
   /* Returns SIZE_MAX if there are no UL symbols */
-  size_t GetULSymbolIdx(size_t symbol_number) const;
+  inline size_t GetULSymbolIdx(size_t symbol_number) const {
+    assert(symbol_number < this->ul_idx_map_.size());
+    return this->ul_idx_map_[symbol_number];
+  }
 
   size_t GetPilotSymbol(size_t location) const;
-  size_t GetPilotSymbolIdx(size_t symbol_number) const;
+  inline size_t GetPilotSymbolIdx(size_t symbol_number) const {
+    assert(symbol_number < this->pilot_idx_map_.size());
+    return this->pilot_idx_map_[symbol_number];
+  }
+
+  /* O(1) symbol-id to type lookup (dense table, rebuilt on schedule
+   * adoption); hot RX and scheduling paths index this instead of parsing
+   * the frame identifier. Unchecked in release builds: every doer launch
+   * performs several of these per task */
+  inline SymbolType GetSymbolType(size_t symbol_id) const {
+    assert(symbol_id < this->symbol_types_.size());
+    return this->symbol_types_[symbol_id];
+  }
 
   size_t GetDLCalSymbol(size_t location) const;
   size_t GetULCalSymbol(size_t location) const;
@@ -96,9 +127,16 @@ class FrameStats {
   size_t client_ul_data_symbols_;
   size_t client_dl_data_symbols_;
 
-  /* Helper function */
-  static size_t GetSymbolIdx(const std::vector<size_t>& search_vector,
-                             size_t symbol_number);
+  /* Dense per-symbol-id lookup tables, rebuilt whenever the schedule
+   * changes: the symbol's type, and its index among the pilot, UL and DL
+   * symbols (SIZE_MAX when the symbol is not of that kind) */
+  std::vector<SymbolType> symbol_types_;
+  std::vector<size_t> pilot_idx_map_;
+  std::vector<size_t> ul_idx_map_;
+  std::vector<size_t> dl_idx_map_;
+
+  /* Rebuild the per-symbol-id lookup tables from the parsed symbol lists */
+  void BuildSymbolIdxMaps();
 }; /* class FrameStats */
 
 #endif /* FRAMESTATS_H_ */
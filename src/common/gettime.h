@@ -6,6 +6,12 @@
 #ifndef GETTIME_INC_
 #define GETTIME_INC_
 
+#include <immintrin.h>
+
+#if defined(__x86_64__)
+#include <cpuid.h>
+#endif
+
 #include "symbols.h"
 
 namespace GetTime {
@@ -29,20 +35,78 @@ static inline size_t Rdtsc() {
   return static_cast<size_t>((rdx << 32) | rax);
 }
 
+/// Per-thread runtime gate for WorkerRdtsc. The doer base clears it
+/// around events whose timing is not sampled (see stats_sample_interval),
+/// so the doers' inline rdtsc bracketing costs one thread-local read
+/// instead of the serializing instruction
+static inline bool& WorkerTimingThisEvent() {
+  static thread_local bool enabled = true;
+  return enabled;
+}
+
 /// Return the TSC or zero, depending on whether timing of workers is
 /// enabled
 static inline size_t WorkerRdtsc() {
-  return kIsWorkerTimingEnabled ? Rdtsc() : 0;
+  return (kIsWorkerTimingEnabled && WorkerTimingThisEvent()) ? Rdtsc() : 0;
+}
+
+/// True when the CPU supports the WAITPKG user-level wait instructions
+/// (umonitor/umwait/tpause). Resolved once on first use; GCC's feature
+/// list predates waitpkg, so this reads CPUID leaf 7 directly
+static inline bool CpuHasWaitPkg() {
+#if defined(__x86_64__)
+  static const bool has_waitpkg = [] {
+    unsigned int eax;
+    unsigned int ebx;
+    unsigned int ecx;
+    unsigned int edx;
+    if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) == 0) {
+      return false;
+    }
+    return (ecx & (1u << 5)) != 0;
+  }();
+  return has_waitpkg;
+#else
+  return false;
+#endif
+}
+
+/// Busy-wait until the TSC reaches the absolute deadline. With WAITPKG,
+/// tpause parks the core in the light C0.1 sleep state until the deadline
+/// (or an interrupt), so spin cores stop stealing thermal headroom from
+/// the compute cores; without it this is a plain pause ladder. Absolute
+/// deadlines mean wakeup overshoot in one wait never drifts the next.
+static inline void WaitUntilTsc(size_t tsc_deadline) {
+#if defined(__WAITPKG__)
+  if (CpuHasWaitPkg()) {
+    while (Rdtsc() < tsc_deadline) {
+      _tpause(0x1, tsc_deadline);
+    }
+    return;
+  }
+#endif
+  while (Rdtsc() < tsc_deadline) {
+    _mm_pause();
+  }
+}
+
+/// One short low-power wait for retry loops that have no deadline (full
+/// ring, failed enqueue). Bounded so the loop's exit condition is
+/// rechecked promptly
+static inline void SpinPause() {
+#if defined(__WAITPKG__)
+  if (CpuHasWaitPkg()) {
+    static constexpr size_t kSpinPauseCycles = 256;
+    _tpause(0x1, Rdtsc() + kSpinPauseCycles);
+    return;
+  }
+#endif
+  _mm_pause();
 }
 
 /// Sleep for some nanoseconds
 static inline void NanoSleep(size_t ns, double freq_ghz) {
-  size_t start = Rdtsc();
-  size_t end = start;
-  auto upp = static_cast<size_t>(freq_ghz * ns);
-  while (end - start < upp) {
-    end = Rdtsc();
-  }
+  WaitUntilTsc(Rdtsc() + static_cast<size_t>(freq_ghz * ns));
 }
 
 /// Measure the frequency of RDTSC based by comparing against
@@ -0,0 +1,120 @@
+/**
+ * @file latency_histogram.h
+ * @brief Log-linear latency histogram for percentile reporting.
+ *
+ * Averages hide the multi-millisecond outliers that dominate a p99.9
+ * latency target. This histogram makes tail percentiles cheap to track:
+ * Record() is a few bit operations plus one counter increment, so it can
+ * sit next to the existing DurationStat updates on the task path.
+ *
+ * HDR-style bucketing: each power-of-two magnitude group is split into
+ * kSubBucketCount linear sub-buckets, keeping the relative resolution at
+ * roughly 1/kSubBucketCount (~6%) across the whole range. Values are TSC
+ * cycles; conversion to microseconds happens only at report time.
+ *
+ * Single writer per instance (one worker thread); the reporting thread
+ * merges per-worker instances into a scratch copy, so no atomics are
+ * needed on the hot path.
+ */
+#ifndef LATENCY_HISTOGRAM_H_
+#define LATENCY_HISTOGRAM_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "gettime.h"
+
+class LatencyHistogram {
+ public:
+  /// 2^4 = 16 linear sub-buckets per magnitude group (~6% resolution)
+  static constexpr size_t kSubBucketBits = 4;
+  static constexpr size_t kSubBucketCount = 1ull << kSubBucketBits;
+  /// Values of up to 2^48 cycles (over a day) resolve; larger ones clamp
+  /// into the last bucket
+  static constexpr size_t kMaxValueBits = 48;
+  static constexpr size_t kNumGroups = kMaxValueBits - kSubBucketBits;
+  static constexpr size_t kNumBuckets = (kNumGroups + 1) * kSubBucketCount;
+
+  LatencyHistogram() { Reset(); }
+
+  void Reset() {
+    std::memset(this->counts_.data(), 0, sizeof(size_t) * kNumBuckets);
+    this->total_count_ = 0;
+  }
+
+  inline void Record(size_t cycles) {
+    this->counts_[BucketIndex(cycles)] += this->record_weight_;
+    this->total_count_ += this->record_weight_;
+  }
+
+  /// Each Record() adds this many samples. Set to N when 1-in-N sampled
+  /// tasks stand in for their unrecorded peers (see stats_sample_interval),
+  /// keeping the percentiles unbiased
+  inline void SetRecordWeight(size_t weight) { this->record_weight_ = weight; }
+
+  inline size_t TotalCount() const { return this->total_count_; }
+
+  void Merge(const LatencyHistogram& other) {
+    for (size_t i = 0; i < kNumBuckets; i++) {
+      this->counts_[i] += other.counts_[i];
+    }
+    this->total_count_ += other.total_count_;
+  }
+
+  /// Cycle count at or below which fraction p (e.g. 0.999) of the
+  /// recorded samples fall, reported as the matching bucket's midpoint
+  size_t PercentileCycles(double p) const {
+    if (this->total_count_ == 0) {
+      return 0;
+    }
+    const auto target = static_cast<size_t>(p * this->total_count_);
+    size_t seen = 0;
+    for (size_t i = 0; i < kNumBuckets; i++) {
+      seen += this->counts_[i];
+      if (seen > target) {
+        return BucketMidpoint(i);
+      }
+    }
+    return BucketMidpoint(kNumBuckets - 1);
+  }
+
+  double PercentileUs(double p, double freq_ghz) const {
+    return GetTime::CyclesToUs(PercentileCycles(p), freq_ghz);
+  }
+
+ private:
+  static inline size_t BucketIndex(size_t cycles) {
+    if (cycles < kSubBucketCount) {
+      return cycles;  // Group 0 stores small values exactly
+    }
+    if (cycles >= (1ull << kMaxValueBits)) {
+      return kNumBuckets - 1;
+    }
+    const size_t msb = 63 - static_cast<size_t>(__builtin_clzll(cycles));
+    const size_t shift = msb - kSubBucketBits;
+    const size_t group = shift + 1;
+    const size_t sub = (cycles >> shift) - kSubBucketCount;
+    return (group * kSubBucketCount) + sub;
+  }
+
+  static inline size_t BucketMidpoint(size_t index) {
+    const size_t group = index / kSubBucketCount;
+    const size_t sub = index % kSubBucketCount;
+    if (group == 0) {
+      return sub;
+    }
+    const size_t shift = group - 1;
+    const size_t low = (kSubBucketCount + sub) << shift;
+    return low + ((1ull << shift) >> 1);
+  }
+
+  std::array<size_t, kNumBuckets> counts_;
+  size_t total_count_;
+  /// Samples added per Record(); survives Reset() since the sampling
+  /// interval does not change at runtime
+  size_t record_weight_ = 1;
+};
+
+#endif  // LATENCY_HISTOGRAM_H_
@@ -47,59 +47,62 @@
 #define MLPD_LOG_LEVEL MLPD_LOG_LEVEL_TRACE
 #endif
 
+// With MLPD_ASYNC_LOG (USE_ASYNC_LOG build flag) enabled messages go
+// through the lock-free per-thread rings in async_log.h: the calling
+// thread only formats into a fixed-size record and a background thread
+// does the stream I/O and flushing, so logging from the RX and worker
+// loops cannot cost a deadline
+#ifdef MLPD_ASYNC_LOG
+#include "async_log.h"
+#define MLPD_LOG_EMIT(level, stream, ...) AsyncLog::Emit(level, __VA_ARGS__)
+#else
+#define MLPD_LOG_EMIT(level, stream, ...)    \
+  MlpdOutputLogHeader(stream, level);        \
+  std::fprintf(stream, __VA_ARGS__);         \
+  std::fflush(stream)
+#endif
+
 #if MLPD_LOG_LEVEL >= MLPD_LOG_LEVEL_ERROR
-#define MLPD_ERROR(...)                                               \
-  MlpdOutputLogHeader(MLPD_LOG_DEFAULT_STREAM, MLPD_LOG_LEVEL_ERROR); \
-  std::fprintf(MLPD_LOG_DEFAULT_STREAM, __VA_ARGS__);                 \
-  std::fflush(MLPD_LOG_DEFAULT_STREAM)
+#define MLPD_ERROR(...) \
+  MLPD_LOG_EMIT(MLPD_LOG_LEVEL_ERROR, MLPD_LOG_DEFAULT_STREAM, __VA_ARGS__)
 #else
 #define MLPD_ERROR(...) ((void)0)
 #endif
 
 #if MLPD_LOG_LEVEL >= MLPD_LOG_LEVEL_WARN
-#define MLPD_WARN(...)                                               \
-  MlpdOutputLogHeader(MLPD_LOG_DEFAULT_STREAM, MLPD_LOG_LEVEL_WARN); \
-  std::fprintf(MLPD_LOG_DEFAULT_STREAM, __VA_ARGS__);                \
-  std::fflush(MLPD_LOG_DEFAULT_STREAM)
+#define MLPD_WARN(...) \
+  MLPD_LOG_EMIT(MLPD_LOG_LEVEL_WARN, MLPD_LOG_DEFAULT_STREAM, __VA_ARGS__)
 #else
 #define MLPD_WARN(...) ((void)0)
 #endif
 
 #if MLPD_LOG_LEVEL >= MLPD_LOG_LEVEL_INFO
-#define MLPD_INFO(...)                                               \
-  MlpdOutputLogHeader(MLPD_LOG_DEFAULT_STREAM, MLPD_LOG_LEVEL_INFO); \
-  std::fprintf(MLPD_LOG_DEFAULT_STREAM, __VA_ARGS__);                \
-  std::fflush(MLPD_LOG_DEFAULT_STREAM)
+#define MLPD_INFO(...) \
+  MLPD_LOG_EMIT(MLPD_LOG_LEVEL_INFO, MLPD_LOG_DEFAULT_STREAM, __VA_ARGS__)
 #else
 #define MLPD_INFO(...) ((void)0)
 #endif
 
 #if MLPD_LOG_LEVEL >= MLPD_LOG_LEVEL_FRAME
-#define MLPD_FRAME(...)                                         \
-  MlpdOutputLogHeader(mlpd_trace_file_or_default_stream,        \
-                      MLPD_LOG_LEVEL_FRAME);                    \
-  std::fprintf(mlpd_trace_file_or_default_stream, __VA_ARGS__); \
-  std::fflush(mlpd_trace_file_or_default_stream)
+#define MLPD_FRAME(...)                    \
+  MLPD_LOG_EMIT(MLPD_LOG_LEVEL_FRAME,      \
+                mlpd_trace_file_or_default_stream, __VA_ARGS__)
 #else
 #define MLPD_FRAME(...) ((void)0)
 #endif
 
 #if MLPD_LOG_LEVEL >= MLPD_LOG_LEVEL_SYMBOL
-#define MLPD_SYMBOL(...)                                        \
-  MlpdOutputLogHeader(mlpd_trace_file_or_default_stream,        \
-                      MLPD_LOG_LEVEL_SYMBOL);                   \
-  std::fprintf(mlpd_trace_file_or_default_stream, __VA_ARGS__); \
-  std::fflush(mlpd_trace_file_or_default_stream)
+#define MLPD_SYMBOL(...)                   \
+  MLPD_LOG_EMIT(MLPD_LOG_LEVEL_SYMBOL,     \
+                mlpd_trace_file_or_default_stream, __VA_ARGS__)
 #else
 #define MLPD_SYMBOL(...) ((void)0)
 #endif
 
 #if MLPD_LOG_LEVEL >= MLPD_LOG_LEVEL_TRACE
-#define MLPD_TRACE(...)                                         \
-  MlpdOutputLogHeader(mlpd_trace_file_or_default_stream,        \
-                      MLPD_LOG_LEVEL_TRACE);                    \
-  std::fprintf(mlpd_trace_file_or_default_stream, __VA_ARGS__); \
-  std::fflush(mlpd_trace_file_or_default_stream)
+#define MLPD_TRACE(...)                    \
+  MLPD_LOG_EMIT(MLPD_LOG_LEVEL_TRACE,      \
+                mlpd_trace_file_or_default_stream, __VA_ARGS__)
 #else
 #define MLPD_TRACE(...) ((void)0)
 #endif
@@ -1,6 +1,142 @@
 #include "memory_manage.h"
 
+#include <numa.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "concurrentqueue.h"
+
+#if defined(MAP_HUGETLB) && defined(MAP_HUGE_SHIFT)
+#ifndef MAP_HUGE_2MB
+#define MAP_HUGE_2MB (21 << MAP_HUGE_SHIFT)
+#endif
+#ifndef MAP_HUGE_1GB
+#define MAP_HUGE_1GB (30 << MAP_HUGE_SHIFT)
+#endif
+#endif
+
 namespace Agora_memory {
+
+namespace {
+constexpr size_t kHugePage2M = (1ull << 21);
+constexpr size_t kHugePage1G = (1ull << 30);
+
+// Where a labeled allocation landed. Allocations on explicit hugepages
+// are mmap'd; base-page fallbacks come from aligned_alloc with THP
+// advice and are what the report flags
+enum AllocTier : size_t { kTier1G = 0, kTier2M, kTierBase, kNumAllocTiers };
+const char* const kTierNames[kNumAllocTiers] = {"1G", "2M", "base"};
+
+struct ClassStats {
+  std::array<size_t, kNumAllocTiers> bytes = {};
+  std::array<size_t, kNumAllocTiers> count = {};
+};
+
+// Allocation and free happen at startup and teardown, never on the
+// frame critical path, so one mutex over the bookkeeping is fine
+std::mutex& AllocMutex() {
+  static std::mutex mutex;
+  return mutex;
+}
+std::map<std::string, ClassStats>& AllocClasses() {
+  static std::map<std::string, ClassStats> classes;
+  return classes;
+}
+// mmap'd regions by base pointer, so PaddedAlignedFree can tell them
+// apart from aligned_alloc memory and munmap the right length
+std::unordered_map<void*, size_t>& MappedRegions() {
+  static std::unordered_map<void*, size_t> regions;
+  return regions;
+}
+std::array<size_t, kNumAllocTiers>& TierBytes() {
+  static std::array<size_t, kNumAllocTiers> bytes = {};
+  return bytes;
+}
+
+// Event-queue arena (see QueueArenaInit). A monotonic bump allocator is
+// enough: queue blocks recycle internally, so frees only happen at queue
+// destruction and the memory is reclaimed with the process
+struct QueueArena {
+  uint8_t* base_ = nullptr;
+  size_t size_ = 0;
+  std::atomic<size_t> offset_ = 0;
+  std::atomic<bool> sealed_ = false;
+  std::atomic<bool> warned_growth_ = false;
+  std::atomic<bool> warned_full_ = false;
+};
+QueueArena& Arena() {
+  static QueueArena arena;
+  return arena;
+}
+
+// Post-seal allocations below this are implicit-producer registration on a
+// thread's first tokenless enqueue; at or above it is a new queue block,
+// i.e. a queue outgrew its preallocated capacity
+constexpr size_t kQueueGrowthBytes = 2048;
+
+void* QueueArenaAlloc(size_t size) {
+  QueueArena& arena = Arena();
+  if ((arena.sealed_.load(std::memory_order_relaxed) == true) &&
+      (size >= kQueueGrowthBytes)) {
+    if (arena.warned_growth_.exchange(true) == false) {
+      std::fprintf(stderr,
+                   "Agora_memory: WARNING: event queue grew by %zu bytes "
+                   "after startup; queue capacities are undersized\n",
+                   size);
+    }
+    assert(false && "event queue storage grew after startup");
+  }
+  if (arena.base_ != nullptr) {
+    const size_t need = (size + 63) & ~size_t{63};
+    // No rollback on exhaustion: the offset only moves forward, so a lost
+    // race near the end wastes a slot instead of handing it out twice
+    const size_t start =
+        arena.offset_.fetch_add(need, std::memory_order_relaxed);
+    if ((start + need) <= arena.size_) {
+      return arena.base_ + start;
+    }
+  }
+  if (arena.warned_full_.exchange(true) == false) {
+    std::fprintf(stderr,
+                 "Agora_memory: WARNING: event queue arena exhausted "
+                 "(%zu bytes); falling back to malloc\n",
+                 arena.size_);
+  }
+  return std::malloc(size);
+}
+
+void QueueArenaFree(void* mem) {
+  QueueArena& arena = Arena();
+  auto* ptr = static_cast<uint8_t*>(mem);
+  if ((arena.base_ != nullptr) && (ptr >= arena.base_) &&
+      (ptr < (arena.base_ + arena.size_))) {
+    return;  // Arena memory is reclaimed wholesale at process exit
+  }
+  std::free(mem);
+}
+
+void* TryMapHugePages(size_t length, int page_flag) {
+#if defined(MAP_HUGETLB) && defined(MAP_HUGE_SHIFT)
+  void* mem = mmap(nullptr, length, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | page_flag, -1,
+                   0);
+  return (mem == MAP_FAILED) ? nullptr : mem;
+#else
+  (void)length;
+  (void)page_flag;
+  return nullptr;
+#endif
+}
+}  // namespace
+
 inline size_t PaddedAllocSize(Alignment_t alignment, size_t size) {
   auto align = static_cast<size_t>(alignment);
   size_t padded_size = size;
@@ -13,7 +149,231 @@ inline size_t PaddedAllocSize(Alignment_t alignment, size_t size) {
 }
 
 void* PaddedAlignedAlloc(Alignment_t alignment, size_t size) {
-  return std::aligned_alloc(static_cast<size_t>(alignment),
-                            PaddedAllocSize(alignment, size));
+  return PaddedAlignedAlloc(alignment, size, -1, nullptr);
+}
+
+void* PaddedAlignedAlloc(Alignment_t alignment, size_t size, int numa_node) {
+  return PaddedAlignedAlloc(alignment, size, numa_node, nullptr);
+}
+
+void* PaddedAlignedAlloc(Alignment_t alignment, size_t size, int numa_node,
+                         const char* label) {
+  const size_t padded_size = PaddedAllocSize(alignment, size);
+  void* mem = nullptr;
+  size_t tier = kTierBase;
+  size_t mapped_length = 0;
+
+  if (label != nullptr) {
+    // Explicit hugepages for the labeled giant buffers. 1 GiB pages only
+    // when the round-up waste stays under a quarter of the request;
+    // otherwise (or when the 1 GiB reservation is exhausted) 2 MiB pages.
+    // mmap returns page-aligned memory, satisfying every Alignment_t
+    if (padded_size >= kHugePage1G) {
+      const size_t length =
+          (padded_size + kHugePage1G - 1) & ~(kHugePage1G - 1);
+      if ((length - padded_size) <= (padded_size / 4)) {
+        mem = TryMapHugePages(length, MAP_HUGE_1GB);
+        if (mem != nullptr) {
+          tier = kTier1G;
+          mapped_length = length;
+        }
+      }
+    }
+    if ((mem == nullptr) && (padded_size >= kHugePage2M)) {
+      const size_t length =
+          (padded_size + kHugePage2M - 1) & ~(kHugePage2M - 1);
+      mem = TryMapHugePages(length, MAP_HUGE_2MB);
+      if (mem != nullptr) {
+        tier = kTier2M;
+        mapped_length = length;
+      }
+    }
+  }
+
+  if (mem == nullptr) {
+    mem = std::aligned_alloc(static_cast<size_t>(alignment), padded_size);
+#ifdef MADV_HUGEPAGE
+    if ((mem != nullptr) && (padded_size >= kHugePage2M)) {
+      // Best effort: let THP back the fallback region with hugepages
+      madvise(mem, padded_size, MADV_HUGEPAGE);
+    }
+#endif
+  }
+
+  if ((mem != nullptr) && (numa_node >= 0) && (numa_available() >= 0)) {
+    // Bind the (not yet touched) pages to the requested node so first-touch
+    // placement cannot land them on a remote socket
+    numa_tonode_memory(mem, (mapped_length > 0) ? mapped_length : padded_size,
+                       numa_node);
+  }
+
+  if ((label != nullptr) && (mem != nullptr)) {
+    std::lock_guard<std::mutex> lock(AllocMutex());
+    if (mapped_length > 0) {
+      MappedRegions().emplace(mem, mapped_length);
+    }
+    ClassStats& stats = AllocClasses()[label];
+    stats.bytes.at(tier) += padded_size;
+    stats.count.at(tier)++;
+    TierBytes().at(tier) += padded_size;
+  }
+  return mem;
+}
+
+void PaddedAlignedFree(void* mem) {
+  if (mem == nullptr) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(AllocMutex());
+    auto region = MappedRegions().find(mem);
+    if (region != MappedRegions().end()) {
+      munmap(mem, region->second);
+      MappedRegions().erase(region);
+      return;
+    }
+  }
+  std::free(mem);
+}
+
+size_t HugePageAllocBytes() {
+  std::lock_guard<std::mutex> lock(AllocMutex());
+  return TierBytes().at(kTier1G) + TierBytes().at(kTier2M);
+}
+
+size_t HugePageFallbackBytes() {
+  std::lock_guard<std::mutex> lock(AllocMutex());
+  return TierBytes().at(kTierBase);
+}
+
+void PrintAllocReport() {
+  std::lock_guard<std::mutex> lock(AllocMutex());
+  std::printf("Agora_memory: allocation report\n");
+  for (const auto& alloc_class : AllocClasses()) {
+    const ClassStats& stats = alloc_class.second;
+    for (size_t tier = 0; tier < kNumAllocTiers; tier++) {
+      if (stats.count.at(tier) > 0) {
+        std::printf("  %-24s %4s pages: %zu allocation(s), %.1f MB\n",
+                    alloc_class.first.c_str(), kTierNames[tier],
+                    stats.count.at(tier),
+                    stats.bytes.at(tier) / (1024.0 * 1024.0));
+      }
+    }
+  }
+  if (TierBytes().at(kTierBase) > 0) {
+    // The silent failure mode this report exists for: a buffer that asked
+    // for explicit hugepages is eating TLB misses on base pages
+    std::printf(
+        "Agora_memory: WARNING: %.1f MB of hugepage-class buffers fell back "
+        "to base pages (check hugetlb reservations, e.g. vm.nr_hugepages)\n",
+        TierBytes().at(kTierBase) / (1024.0 * 1024.0));
+  }
+}
+
+void QueueArenaInit(size_t bytes) {
+  QueueArena& arena = Arena();
+  if (arena.base_ == nullptr) {
+    const size_t length = (bytes + kHugePage2M - 1) & ~(kHugePage2M - 1);
+    auto* mem = static_cast<uint8_t*>(PaddedAlignedAlloc(
+        Alignment_t::kAlign64, length, -1, "event_queue_blocks"));
+    if (mem == nullptr) {
+      std::fprintf(stderr,
+                   "Agora_memory: WARNING: could not reserve %zu byte event "
+                   "queue arena; queues will use malloc\n",
+                   length);
+      return;
+    }
+    // Fault the whole region in now so neither queue construction nor a
+    // (worst-case) late block pull stalls on a page fault
+    PrefaultPages(mem, length);
+    arena.size_ = length;
+    arena.base_ = mem;
+    moodycamel::queue_malloc_hook = &QueueArenaAlloc;
+    moodycamel::queue_free_hook = &QueueArenaFree;
+  }
+  // A repeat Init (e.g. a second Agora instance in one process) keeps
+  // bump-allocating from where the first left off; the malloc fallback
+  // covers exhaustion
+  arena.sealed_.store(false, std::memory_order_relaxed);
+}
+
+void QueueArenaSeal() {
+  Arena().sealed_.store(true, std::memory_order_relaxed);
+}
+
+void PrefaultPages(void* mem, size_t bytes) {
+  if ((mem == nullptr) || (bytes == 0)) {
+    return;
+  }
+  const auto page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  // Write faults, not reads: a read fault on untouched anonymous memory
+  // maps the shared zero page and leaves the write fault for the datapath.
+  // Reading the byte back first keeps already-initialized buffers intact
+  auto* touch = static_cast<volatile char*>(mem);
+  for (size_t offset = 0; offset < bytes; offset += page_size) {
+    touch[offset] = touch[offset];
+  }
+  touch[bytes - 1] = touch[bytes - 1];
+}
+
+bool LockPages(void* mem, size_t bytes) {
+  if ((mem == nullptr) || (bytes == 0)) {
+    return true;
+  }
+  return (mlock(mem, bytes) == 0);
+}
+
+// Below this a plain memset wins over spawning threads
+static constexpr size_t kZeroParallelThresholdBytes = 32 * 1024 * 1024;
+
+void ZeroBytes(void* mem, size_t bytes) {
+  if ((mem == nullptr) || (bytes == 0)) {
+    return;
+  }
+#ifdef THREADED_INIT
+  if (bytes >= kZeroParallelThresholdBytes) {
+    const size_t num_threads = std::min(
+        (bytes / kZeroParallelThresholdBytes) + 1,
+        static_cast<size_t>(std::thread::hardware_concurrency()));
+    const size_t chunk_bytes = (bytes + num_threads - 1) / num_threads;
+    std::vector<std::thread> zero_threads;
+    zero_threads.reserve(num_threads);
+    for (size_t t = 0; t < num_threads; t++) {
+      const size_t offset = t * chunk_bytes;
+      if (offset >= bytes) {
+        break;
+      }
+      const size_t len = std::min(chunk_bytes, bytes - offset);
+      zero_threads.emplace_back([mem, offset, len]() {
+        std::memset(static_cast<char*>(mem) + offset, 0, len);
+      });
+    }
+    for (auto& join_thread : zero_threads) {
+      join_thread.join();
+    }
+    return;
+  }
+#endif
+  std::memset(mem, 0, bytes);
+}
+
+void* GetFftScratch(size_t size) {
+  struct Scratch {
+    void* buf = nullptr;
+    size_t size = 0;
+    ~Scratch() { std::free(buf); }
+  };
+  thread_local Scratch scratch;
+  if (scratch.size < size) {
+    std::free(scratch.buf);
+    scratch.buf = PaddedAlignedAlloc(Alignment_t::kAlign4096, size);
+#ifdef MADV_HUGEPAGE
+    // Page-aligned, so THP can back the whole region with hugepages
+    madvise(scratch.buf, PaddedAllocSize(Alignment_t::kAlign4096, size),
+            MADV_HUGEPAGE);
+#endif
+    scratch.size = size;
+  }
+  return scratch.buf;
 }
-};  // namespace Agora_memory
\ No newline at end of file
+};  // namespace Agora_memory
@@ -6,8 +6,10 @@
 #ifndef MEMORY_MANAGE_H_
 #define MEMORY_MANAGE_H_
 #include <array>
+#include <atomic>
 #include <cassert>
 #include <complex>
+#include <cstdint>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
@@ -21,8 +23,122 @@ enum class Alignment_t : size_t {
 };
 
 void* PaddedAlignedAlloc(Alignment_t alignment, size_t size);
+
+// Variant that additionally binds the allocation's pages to the given NUMA
+// node (no binding if numa_node is negative). The returned pointer is still
+// released with std::free().
+void* PaddedAlignedAlloc(Alignment_t alignment, size_t size, int numa_node);
+
+// Variant for the giant long-lived buffers: a non-null label opts the
+// allocation into explicit hugepages (1 GiB pages for suitably large
+// requests, else 2 MiB pages, else base pages with THP advice) and into
+// the per-buffer-class accounting behind PrintAllocReport(). Labeled
+// allocations must be released with PaddedAlignedFree(), which also
+// accepts plain PaddedAlignedAlloc memory
+void* PaddedAlignedAlloc(Alignment_t alignment, size_t size, int numa_node,
+                         const char* label);
+void PaddedAlignedFree(void* mem);
+
+// Bytes of labeled buffers that landed on explicit hugepages, and bytes
+// that silently fell back to base pages (the condition the startup
+// report warns about; fallbacks otherwise only show up as degraded
+// demul throughput from TLB misses)
+size_t HugePageAllocBytes();
+size_t HugePageFallbackBytes();
+
+// Print which labeled buffers landed on which page size, with a warning
+// when any fell back to base pages. Called once after buffer init
+void PrintAllocReport();
+
+// Preallocated arena backing the event-queue storage: installs the
+// moodycamel allocation hooks (see src/third_party/concurrentqueue.h) so
+// every queue block, block index and producer structure bump-allocates
+// from one labeled hugepage region instead of hitting std::malloc -- no
+// queue ever page-faults or takes the allocator lock mid-frame. Size the
+// arena from the worst-case queue capacities before constructing the
+// queues; if it runs out, allocation falls back to std::malloc with a
+// one-time warning. Frees of arena memory are no-ops (queue blocks
+// recycle internally and die with the process), so the arena is never
+// reclaimed; a second Init in the same process reuses the existing arena
+void QueueArenaInit(size_t bytes);
+
+// Mark the end of queue construction. Small allocations afterwards are
+// expected (a thread's first tokenless enqueue registers an implicit
+// producer); a block-sized allocation means a queue outgrew its
+// preallocated capacity and trips an assert in debug builds (and a
+// one-time warning otherwise)
+void QueueArenaSeal();
+
+// Per-thread transform scratch, shared by the FFT and IFFT doers running on
+// the calling thread so a generalist worker touches one hot region instead
+// of one per doer instance. The workspace is page-aligned, marked for
+// transparent hugepages, allocated on first use, and freed at thread exit.
+// Growing the workspace reallocates it and invalidates pointers handed out
+// earlier on this thread, so every caller must request the full size it
+// will ever need; callers sized from the same config values are safe.
+void* GetFftScratch(size_t size);
+
+// Startup pass against first-frame page-fault jitter (see the
+// prefault_buffers config flag). PrefaultPages() write-touches every page
+// of the region so live traffic never takes its first faults; LockPages()
+// then mlock()s the region so the kernel cannot evict the pages later.
+// LockPages() returns false when mlock() fails (e.g. RLIMIT_MEMLOCK); the
+// pages stay prefaulted either way.
+void PrefaultPages(void* mem, size_t bytes);
+bool LockPages(void* mem, size_t bytes);
+
+// Zero [mem, mem + bytes). Regions large enough that a single-core memset
+// noticeably stretches cold start (the zeroforcing matrix backings run to
+// gigabytes) are split across short-lived threads when THREADED_INIT is
+// defined; small regions fall back to plain std::memset, so this is safe
+// to call from any allocation path
+void ZeroBytes(void* mem, size_t bytes);
 }  // namespace Agora_memory
 
+// A bump allocator for transient scratch tied to one in-flight frame.
+// BumpAlloc() is a single atomic fetch-add, so all worker threads can carve
+// from one arena without touching the global heap (and its lock) on the
+// frame critical path. Individual allocations are never freed; the master
+// resets the arena wholesale once its frame completes.
+class FrameArena {
+ public:
+  FrameArena() : buf_(nullptr), capacity_(0) {}
+  ~FrameArena() { std::free(buf_); }
+
+  // Delete copy constructor and copy assignment
+  FrameArena(FrameArena const&) = delete;
+  FrameArena& operator=(FrameArena const&) = delete;
+
+  void Alloc(size_t capacity) {
+    this->capacity_ = capacity;
+    this->buf_ = static_cast<uint8_t*>(Agora_memory::PaddedAlignedAlloc(
+        Agora_memory::Alignment_t::kAlign64, capacity));
+    this->offset_.store(0, std::memory_order_relaxed);
+  }
+
+  /// Carve size bytes (rounded up to a 64-byte multiple, so concurrent
+  /// callers never share a cache line) out of the arena. Returns nullptr
+  /// when the arena is exhausted; callers fall back to the heap.
+  void* BumpAlloc(size_t size) {
+    const size_t aligned_size = (size + 63u) & ~size_t{63u};
+    const size_t offset =
+        this->offset_.fetch_add(aligned_size, std::memory_order_relaxed);
+    if ((offset + aligned_size) > this->capacity_) {
+      return nullptr;
+    }
+    return this->buf_ + offset;
+  }
+
+  /// Make the whole arena available again. Only safe once no worker can
+  /// still be using scratch from the owning frame.
+  void Reset() { this->offset_.store(0, std::memory_order_relaxed); }
+
+ private:
+  uint8_t* buf_;
+  size_t capacity_;
+  std::atomic<size_t> offset_ = {0};
+};
+
 template <typename T>
 class Table {
  private:
@@ -33,19 +149,23 @@ class Table {
  public:
   Table() : data_(nullptr) {}
 
-  void Malloc(size_t dim1, size_t dim2, Agora_memory::Alignment_t alignment) {
+  // A non-null label opts the backing buffer into explicit hugepages and
+  // the per-buffer-class accounting (see PaddedAlignedAlloc)
+  void Malloc(size_t dim1, size_t dim2, Agora_memory::Alignment_t alignment,
+              int numa_node = -1, const char* label = nullptr) {
     this->dim2_ = dim2;
     this->dim1_ = dim1;
     // RtAssert(((dim1 > 0) && (dim2 == 0)), "Table: Malloc one dimension = 0");
     size_t alloc_size = (this->dim1_ * this->dim2_ * sizeof(T));
-    this->data_ = static_cast<T*>(
-        Agora_memory::PaddedAlignedAlloc(alignment, alloc_size));
+    this->data_ = static_cast<T*>(Agora_memory::PaddedAlignedAlloc(
+        alignment, alloc_size, numa_node, label));
   }
-  void Calloc(size_t dim1, size_t dim2, Agora_memory::Alignment_t alignment) {
+  void Calloc(size_t dim1, size_t dim2, Agora_memory::Alignment_t alignment,
+              int numa_node = -1, const char* label = nullptr) {
     // RtAssert(((dim1 > 0) && (dim2 == 0)), "Table: Calloc one dimension = 0");
-    this->Malloc(dim1, dim2, alignment);
-    std::memset(static_cast<void*>(this->data_), 0,
-                (this->dim1_ * this->dim2_ * sizeof(T)));
+    this->Malloc(dim1, dim2, alignment, numa_node, label);
+    Agora_memory::ZeroBytes(static_cast<void*>(this->data_),
+                            (this->dim1_ * this->dim2_ * sizeof(T)));
   }
 
   // Allocate the table and fill it with random floating point values between
@@ -80,9 +200,12 @@ class Table {
 
   bool IsAllocated() { return (this->data_ != nullptr); }
 
+  /// Bytes requested for the backing buffer (excluding alignment padding)
+  size_t AllocBytes() const { return this->dim1_ * this->dim2_ * sizeof(T); }
+
   void Free() {
     if (this->data_ != nullptr) {
-      std::free(this->data_);
+      Agora_memory::PaddedAlignedFree(this->data_);
     }
     this->dim2_ = 0;
     this->dim1_ = 0;
@@ -97,6 +220,53 @@ class Table {
   }
 };
 
+// Structure-of-arrays companion to Table<complex_float>: each row is a
+// real plane followed by an imaginary plane, jointly allocated in one
+// backing buffer. SIMD kernels consume either plane with plain vector
+// loads instead of deinterleaving interleaved I/Q with unpack shuffles.
+template <typename T>
+class PlanarTable {
+ public:
+  PlanarTable() : data_(nullptr) {}
+
+  void Malloc(size_t dim1, size_t dim2, Agora_memory::Alignment_t alignment) {
+    this->dim1_ = dim1;
+    // Pad the plane length so the imaginary plane keeps the row alignment
+    const size_t align_elems = static_cast<size_t>(alignment) / sizeof(T);
+    this->plane_stride_ =
+        ((dim2 + align_elems - 1) / align_elems) * align_elems;
+    this->data_ = static_cast<T*>(Agora_memory::PaddedAlignedAlloc(
+        alignment, this->dim1_ * 2 * this->plane_stride_ * sizeof(T)));
+  }
+  void Calloc(size_t dim1, size_t dim2, Agora_memory::Alignment_t alignment) {
+    this->Malloc(dim1, dim2, alignment);
+    Agora_memory::ZeroBytes(static_cast<void*>(this->data_),
+                            (this->dim1_ * 2 * this->plane_stride_ * sizeof(T)));
+  }
+
+  bool IsAllocated() { return (this->data_ != nullptr); }
+
+  void Free() {
+    if (this->data_ != nullptr) {
+      Agora_memory::PaddedAlignedFree(this->data_);
+    }
+    this->dim1_ = 0;
+    this->plane_stride_ = 0;
+    this->data_ = nullptr;
+  }
+
+  T* Re(size_t dim1) const {
+    assert(this->dim1_ > dim1);
+    return (this->data_ + (dim1 * 2 * this->plane_stride_));
+  }
+  T* Im(size_t dim1) const { return (this->Re(dim1) + this->plane_stride_); }
+
+ private:
+  size_t dim1_{0};
+  size_t plane_stride_{0};
+  T* data_;
+};
+
 template <typename T, typename U>
 static void AllocBuffer1d(T** buffer, U dim,
                           Agora_memory::Alignment_t alignment, int init_zero) {
@@ -143,9 +313,12 @@ class PtrGrid {
   /// Allocate [n_entries] entries per pointer cell
   void Alloc(size_t n_rows, size_t n_cols, size_t n_entries) {
     const size_t alloc_sz = n_rows * n_cols * n_entries * sizeof(T);
+    this->n_cols_ = n_cols;
+    this->n_entries_ = n_entries;
+    this->alloc_bytes_ = alloc_sz;
     this->backing_buf_ = static_cast<T*>(Agora_memory::PaddedAlignedAlloc(
         Agora_memory::Alignment_t::kAlign64, alloc_sz));
-    std::memset(static_cast<void*>(this->backing_buf_), 0, alloc_sz);
+    Agora_memory::ZeroBytes(static_cast<void*>(this->backing_buf_), alloc_sz);
 
     // Fill-in the grid with pointers into backing_buf
     size_t offset = 0;
@@ -180,6 +353,21 @@ class PtrGrid {
     return this->mat_[row_idx];
   }
 
+  /// Direct pointer to the cell's array, computed with flat offset
+  /// arithmetic on the backing buffer instead of reading the pointer grid.
+  /// Cell arrays are laid out densely with the column count passed to
+  /// Alloc(), so this avoids both the pointer load and the [COLS]-wide
+  /// grid rows that a partially-allocated grid leaves mostly unused.
+  /// Valid only for cells covered by Alloc().
+  T* At(size_t row_idx, size_t col_idx) const {
+    assert(col_idx < this->n_cols_);
+    return &this
+        ->backing_buf_[((row_idx * this->n_cols_) + col_idx) * n_entries_];
+  }
+
+  /// Bytes requested for the backing buffer (excluding alignment padding)
+  size_t AllocBytes() const { return this->alloc_bytes_; }
+
   // Delete copy constructor and copy assignment
   PtrGrid(PtrGrid const&) = delete;
   PtrGrid& operator=(PtrGrid const&) = delete;
@@ -187,6 +375,11 @@ class PtrGrid {
  private:
   std::array<std::array<T*, COLS>, ROWS> mat_;  /// The pointer cells
 
+  /// Allocated dimensions, kept for flat offset arithmetic in At()
+  size_t n_cols_{0};
+  size_t n_entries_{0};
+  size_t alloc_bytes_{0};
+
   /// The backing buffer for the per-cell arrays. Having a common buffer
   /// reduces the number of memory allocations.
   T* backing_buf_;
@@ -224,9 +417,10 @@ class PtrCube {
   /// Allocate [n_entries] entries per pointer cell
   void Alloc(size_t dim_1, size_t dim_2, size_t dim_3, size_t n_entries) {
     const size_t alloc_sz = dim_1 * dim_2 * dim_3 * n_entries * sizeof(T);
+    this->alloc_bytes_ = alloc_sz;
     this->backing_buf_ = static_cast<T*>(Agora_memory::PaddedAlignedAlloc(
         Agora_memory::Alignment_t::kAlign64, alloc_sz));
-    std::memset(static_cast<void*>(this->backing_buf_), 0, alloc_sz);
+    Agora_memory::ZeroBytes(static_cast<void*>(this->backing_buf_), alloc_sz);
 
     // Fill-in the grid with pointers into backing_buf
     for (auto& mat : this->cube_) {
@@ -252,6 +446,9 @@ class PtrCube {
     return this->cube_[row_idx];
   }
 
+  /// Bytes requested for the backing buffer (excluding alignment padding)
+  size_t AllocBytes() const { return this->alloc_bytes_; }
+
   // Delete copy constructor and copy assignment
   PtrCube(PtrCube const&) = delete;
   PtrCube& operator=(PtrCube const&) = delete;
@@ -260,6 +457,9 @@ class PtrCube {
   /// The pointer cells
   std::array<std::array<std::array<T*, DIM3>, DIM2>, DIM1> cube_;
 
+  /// Bytes of the backing buffer, kept for the startup prefault pass
+  size_t alloc_bytes_{0};
+
   /// The backing buffer for the per-cell arrays. Having a common buffer
   /// reduces the number of memory allocations.
   T* backing_buf_;
@@ -0,0 +1,86 @@
+/**
+ * @file mmap_reader.h
+ * @brief Read-only memory-mapped views of test-vector files
+ */
+#ifndef MMAP_READER_H_
+#define MMAP_READER_H_
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+/// Read-only memory-mapped view of a file. Sections are addressed by byte
+/// offset, so the flat test-vector files can be consumed lazily: pages are
+/// faulted in on first touch and shared through the page cache when many
+/// processes map the same file, instead of each process reading the whole
+/// file into a private heap buffer at startup.
+class MmapReader {
+ public:
+  explicit MmapReader(const std::string& filename) {
+    const int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+      throw std::runtime_error("MmapReader: failed to open " + filename +
+                               ": " + std::strerror(errno));
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+      ::close(fd);
+      throw std::runtime_error("MmapReader: failed to stat " + filename);
+    }
+    size_ = static_cast<size_t>(st.st_size);
+    if (size_ > 0) {
+      void* map = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+      if (map == MAP_FAILED) {
+        ::close(fd);
+        throw std::runtime_error("MmapReader: failed to mmap " + filename);
+      }
+      data_ = static_cast<const uint8_t*>(map);
+    }
+    // The mapping keeps its own reference to the file
+    ::close(fd);
+  }
+
+  ~MmapReader() {
+    if (data_ != nullptr) {
+      ::munmap(const_cast<uint8_t*>(data_), size_);
+    }
+  }
+
+  MmapReader(const MmapReader&) = delete;
+  MmapReader& operator=(const MmapReader&) = delete;
+
+  /// Pointer to num_bytes of file content starting at byte_offset; throws
+  /// if the requested section runs past the end of the file
+  const uint8_t* At(size_t byte_offset, size_t num_bytes) const {
+    const uint8_t* section = TryAt(byte_offset, num_bytes);
+    if (section == nullptr) {
+      throw std::runtime_error("MmapReader: section read past end of file");
+    }
+    return section;
+  }
+
+  /// Like At, but returns nullptr instead of throwing when the section is
+  /// out of range, for callers that tolerate short files
+  const uint8_t* TryAt(size_t byte_offset, size_t num_bytes) const {
+    if ((byte_offset + num_bytes) > size_) {
+      return nullptr;
+    }
+    return data_ + byte_offset;
+  }
+
+  size_t Size() const { return size_; }
+
+ private:
+  const uint8_t* data_ = nullptr;
+  size_t size_ = 0;
+};
+
+#endif  // MMAP_READER_H_
@@ -39,7 +39,216 @@ void Print128Epi8(__m128i var) {
  ***********************************************************************************
  */
 
+// Soft demodulator dispatch table. The pointers default to the AVX2
+// kernels and are upgraded to the AVX-512 kernels in InitModulationTable()
+// when both the build and the CPU support them.
+static void (*demod_16qam_soft_)(float*, int8_t*, int) = Demod16qamSoftAvx2;
+static void (*demod_64qam_soft_)(float*, int8_t*, int) = Demod64qamSoftAvx2;
+static void (*demod_256qam_soft_)(const float*, int8_t*,
+                                  int) = Demod256qamSoftAvx2;
+
+void Demod16qamSoft(float* vec_in, int8_t* llr, int num) {
+  demod_16qam_soft_(vec_in, llr, num);
+}
+
+void Demod64qamSoft(float* vec_in, int8_t* llr, int num) {
+  demod_64qam_soft_(vec_in, llr, num);
+}
+
+void Demod256qamSoft(const float* vec_in, int8_t* llr, int num) {
+  demod_256qam_soft_(vec_in, llr, num);
+}
+
+// Planar (structure-of-arrays) soft demodulators. The float part loads
+// each plane with plain vector loads; the per-plane int8 results are then
+// interleaved with unpacks, replacing the per-iteration byte-shuffle
+// tables the interleaved kernels need to separate I from Q. Output LLRs
+// are bit-exact with the interleaved SIMD kernels.
+
+void DemodQpskSoftPlanar(const float* re, const float* im, int8_t* llr,
+                         int num) {
+  const __m256 scale_v = _mm256_set1_ps(-SCALE_BYTE_CONV_QPSK * M_SQRT2);
+  auto* result_ptr = reinterpret_cast<__m128i*>(llr);
+  int i = 0;
+  for (; i < num - 16 + 1; i += 16) {
+    __m256i re_i1 =
+        _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_load_ps(&re[i]), scale_v));
+    __m256i re_i2 =
+        _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_load_ps(&re[i + 8]), scale_v));
+    __m256i im_i1 =
+        _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_load_ps(&im[i]), scale_v));
+    __m256i im_i2 =
+        _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_load_ps(&im[i + 8]), scale_v));
+    __m256i re_16 =
+        _mm256_permute4x64_epi64(_mm256_packs_epi32(re_i1, re_i2), 0xd8);
+    __m256i im_16 =
+        _mm256_permute4x64_epi64(_mm256_packs_epi32(im_i1, im_i2), 0xd8);
+    // One plane per 128-bit lane: [I0..I15 | Q0..Q15]
+    __m256i y =
+        _mm256_permute4x64_epi64(_mm256_packs_epi16(re_16, im_16), 0xd8);
+    __m128i y_i = _mm256_extracti128_si256(y, 0);
+    __m128i y_q = _mm256_extracti128_si256(y, 1);
+    _mm_store_si128(result_ptr++, _mm_unpacklo_epi8(y_i, y_q));
+    _mm_store_si128(result_ptr++, _mm_unpackhi_epi8(y_i, y_q));
+  }
+  for (; i < num; i++) {
+    llr[2 * i + 0] = (int8_t)(re[i] * -SCALE_BYTE_CONV_QPSK * M_SQRT2);
+    llr[2 * i + 1] = (int8_t)(im[i] * -SCALE_BYTE_CONV_QPSK * M_SQRT2);
+  }
+}
+
+void Demod16qamSoftPlanarAvx2(const float* re, const float* im, int8_t* llr,
+                              int num) {
+  const __m256 scale_v = _mm256_set1_ps(SCALE_BYTE_CONV_QAM16);
+  const __m256i offset = _mm256_set1_epi8(2 * SCALE_BYTE_CONV_QAM16 / sqrt(10));
+  auto* result_ptr = reinterpret_cast<__m128i*>(llr);
+  for (int i = 0; i < num / 16; i++) {
+    __m256i re_i1 =
+        _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_load_ps(&re[16 * i]), scale_v));
+    __m256i re_i2 = _mm256_cvtps_epi32(
+        _mm256_mul_ps(_mm256_load_ps(&re[16 * i + 8]), scale_v));
+    __m256i im_i1 =
+        _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_load_ps(&im[16 * i]), scale_v));
+    __m256i im_i2 = _mm256_cvtps_epi32(
+        _mm256_mul_ps(_mm256_load_ps(&im[16 * i + 8]), scale_v));
+    __m256i re_16 =
+        _mm256_permute4x64_epi64(_mm256_packs_epi32(re_i1, re_i2), 0xd8);
+    __m256i im_16 =
+        _mm256_permute4x64_epi64(_mm256_packs_epi32(im_i1, im_i2), 0xd8);
+    // One plane per 128-bit lane: [I0..I15 | Q0..Q15]
+    __m256i y =
+        _mm256_permute4x64_epi64(_mm256_packs_epi16(re_16, im_16), 0xd8);
+    __m256i a = _mm256_sub_epi8(offset, _mm256_abs_epi8(y));
+    __m128i y_i = _mm256_extracti128_si256(y, 0);
+    __m128i y_q = _mm256_extracti128_si256(y, 1);
+    __m128i a_i = _mm256_extracti128_si256(a, 0);
+    __m128i a_q = _mm256_extracti128_si256(a, 1);
+    // Interleave [I,Q] and [off-|I|,off-|Q|] byte pairs, then the pairs,
+    // producing the per-symbol [I, Q, off-|I|, off-|Q|] LLR layout
+    __m128i iq_lo = _mm_unpacklo_epi8(y_i, y_q);
+    __m128i iq_hi = _mm_unpackhi_epi8(y_i, y_q);
+    __m128i aa_lo = _mm_unpacklo_epi8(a_i, a_q);
+    __m128i aa_hi = _mm_unpackhi_epi8(a_i, a_q);
+    _mm_store_si128(result_ptr++, _mm_unpacklo_epi16(iq_lo, aa_lo));
+    _mm_store_si128(result_ptr++, _mm_unpackhi_epi16(iq_lo, aa_lo));
+    _mm_store_si128(result_ptr++, _mm_unpacklo_epi16(iq_hi, aa_hi));
+    _mm_store_si128(result_ptr++, _mm_unpackhi_epi16(iq_hi, aa_hi));
+  }
+  for (int i = 16 * (num / 16); i < num; i++) {
+    auto yre = static_cast<int8_t>(SCALE_BYTE_CONV_QAM16 * re[i]);
+    auto yim = static_cast<int8_t>(SCALE_BYTE_CONV_QAM16 * im[i]);
+    llr[4 * i + 0] = yre;
+    llr[4 * i + 1] = yim;
+    llr[4 * i + 2] = 2 * SCALE_BYTE_CONV_QAM16 / sqrt(10) - abs(yre);
+    llr[4 * i + 3] = 2 * SCALE_BYTE_CONV_QAM16 / sqrt(10) - abs(yim);
+  }
+}
+
+void Demod64qamSoftPlanarAvx2(const float* re, const float* im, int8_t* llr,
+                              int num) {
+  const __m256 scale_v = _mm256_set1_ps(SCALE_BYTE_CONV_QAM64);
+  const __m128i offset1 = _mm_set1_epi8(4 * SCALE_BYTE_CONV_QAM64 / sqrt(42));
+  const __m128i offset2 = _mm_set1_epi8(2 * SCALE_BYTE_CONV_QAM64 / sqrt(42));
+  auto* result_ptr = reinterpret_cast<__m128i*>(llr);
+
+  // The 6-byte-per-symbol output stride does not decompose into unpacks,
+  // so the spreading shuffles from Demod64qamSoftSse are reused once the
+  // planes are interleaved into its [I0,Q0,..,I7,Q7] byte layout
+  __m128i shuffle_negated_1 = _mm_set_epi8(0xff, 0xff, 5, 4, 0xff, 0xff, 0xff,
+                                           0xff, 3, 2, 0xff, 0xff, 0xff, 0xff,
+                                           1, 0);
+  __m128i shuffle_negated_2 = _mm_set_epi8(11, 10, 0xff, 0xff, 0xff, 0xff, 9, 8,
+                                           0xff, 0xff, 0xff, 0xff, 7, 6, 0xff,
+                                           0xff);
+  __m128i shuffle_negated_3 = _mm_set_epi8(0xff, 0xff, 0xff, 0xff, 15, 14, 0xff,
+                                           0xff, 0xff, 0xff, 13, 12, 0xff, 0xff,
+                                           0xff, 0xff);
+  __m128i shuffle_abs_1 = _mm_set_epi8(5, 4, 0xff, 0xff, 0xff, 0xff, 3, 2, 0xff,
+                                       0xff, 0xff, 0xff, 1, 0, 0xff, 0xff);
+  __m128i shuffle_abs_2 = _mm_set_epi8(0xff, 0xff, 0xff, 0xff, 9, 8, 0xff, 0xff,
+                                       0xff, 0xff, 7, 6, 0xff, 0xff, 0xff,
+                                       0xff);
+  __m128i shuffle_abs_3 = _mm_set_epi8(0xff, 0xff, 15, 14, 0xff, 0xff, 0xff,
+                                       0xff, 13, 12, 0xff, 0xff, 0xff, 0xff, 11,
+                                       10);
+  __m128i shuffle_abs2_1 = _mm_set_epi8(0xff, 0xff, 0xff, 0xff, 3, 2, 0xff,
+                                        0xff, 0xff, 0xff, 1, 0, 0xff, 0xff,
+                                        0xff, 0xff);
+  __m128i shuffle_abs2_2 = _mm_set_epi8(0xff, 0xff, 9, 8, 0xff, 0xff, 0xff,
+                                        0xff, 7, 6, 0xff, 0xff, 0xff, 0xff, 5,
+                                        4);
+  __m128i shuffle_abs2_3 = _mm_set_epi8(15, 14, 0xff, 0xff, 0xff, 0xff, 13, 12,
+                                        0xff, 0xff, 0xff, 0xff, 11, 10, 0xff,
+                                        0xff);
+
+  for (int i = 0; i < num / 16; i++) {
+    __m256i re_i1 =
+        _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_load_ps(&re[16 * i]), scale_v));
+    __m256i re_i2 = _mm256_cvtps_epi32(
+        _mm256_mul_ps(_mm256_load_ps(&re[16 * i + 8]), scale_v));
+    __m256i im_i1 =
+        _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_load_ps(&im[16 * i]), scale_v));
+    __m256i im_i2 = _mm256_cvtps_epi32(
+        _mm256_mul_ps(_mm256_load_ps(&im[16 * i + 8]), scale_v));
+    __m256i re_16 =
+        _mm256_permute4x64_epi64(_mm256_packs_epi32(re_i1, re_i2), 0xd8);
+    __m256i im_16 =
+        _mm256_permute4x64_epi64(_mm256_packs_epi32(im_i1, im_i2), 0xd8);
+    __m256i y =
+        _mm256_permute4x64_epi64(_mm256_packs_epi16(re_16, im_16), 0xd8);
+    __m128i y_i = _mm256_extracti128_si256(y, 0);
+    __m128i y_q = _mm256_extracti128_si256(y, 1);
+    __m128i halves[2];
+    halves[0] = _mm_unpacklo_epi8(y_i, y_q);
+    halves[1] = _mm_unpackhi_epi8(y_i, y_q);
+    for (__m128i symbol_i : halves) {
+      __m128i symbol_abs = _mm_sub_epi8(offset1, _mm_abs_epi8(symbol_i));
+      __m128i symbol_abs2 = _mm_sub_epi8(offset2, _mm_abs_epi8(symbol_abs));
+      _mm_store_si128(
+          result_ptr,
+          _mm_or_si128(
+              _mm_or_si128(_mm_shuffle_epi8(symbol_i, shuffle_negated_1),
+                           _mm_shuffle_epi8(symbol_abs, shuffle_abs_1)),
+              _mm_shuffle_epi8(symbol_abs2, shuffle_abs2_1)));
+      result_ptr++;
+      _mm_store_si128(
+          result_ptr,
+          _mm_or_si128(
+              _mm_or_si128(_mm_shuffle_epi8(symbol_i, shuffle_negated_2),
+                           _mm_shuffle_epi8(symbol_abs, shuffle_abs_2)),
+              _mm_shuffle_epi8(symbol_abs2, shuffle_abs2_2)));
+      result_ptr++;
+      _mm_store_si128(
+          result_ptr,
+          _mm_or_si128(
+              _mm_or_si128(_mm_shuffle_epi8(symbol_i, shuffle_negated_3),
+                           _mm_shuffle_epi8(symbol_abs, shuffle_abs_3)),
+              _mm_shuffle_epi8(symbol_abs2, shuffle_abs2_3)));
+      result_ptr++;
+    }
+  }
+  for (int i = 16 * (num / 16); i < num; i++) {
+    float yre = (int8_t)(SCALE_BYTE_CONV_QAM64 * re[i]);
+    float yim = (int8_t)(SCALE_BYTE_CONV_QAM64 * im[i]);
+    llr[6 * i + 0] = yre;
+    llr[6 * i + 1] = yim;
+    llr[6 * i + 2] = 4 * SCALE_BYTE_CONV_QAM64 / sqrt(42) - abs(yre);
+    llr[6 * i + 3] = 4 * SCALE_BYTE_CONV_QAM64 / sqrt(42) - abs(yim);
+    llr[6 * i + 4] = 2 * SCALE_BYTE_CONV_QAM64 / sqrt(42) - abs(llr[6 * i + 2]);
+    llr[6 * i + 5] = 2 * SCALE_BYTE_CONV_QAM64 / sqrt(42) - abs(llr[6 * i + 3]);
+  }
+}
+
 void InitModulationTable(Table<complex_float>& mod_table, size_t mod_order) {
+#ifdef __AVX512F__
+  // Resolve the soft demodulator dispatch table once, before any hot-path
+  // call. The byte-wide AVX-512 kernels additionally need AVX512BW.
+  if (__builtin_cpu_supports("avx512bw") != 0) {
+    demod_16qam_soft_ = Demod16qamSoftAvx512;
+    demod_64qam_soft_ = Demod64qamSoftAvx512;
+    demod_256qam_soft_ = Demod256qamSoftAvx512;
+  }
+#endif
   if (!mod_table.IsAllocated()) {
     mod_table.Malloc(1, pow(2, kMaxModType),
                      Agora_memory::Alignment_t::kAlign32);
@@ -214,7 +423,6 @@ complex_float ModSingleUint8(uint8_t x, Table<complex_float>& mod_table) {
   return mod_table[0][x];
 }
 
-// TODO: test correctness
 void ModSimd(uint8_t* in, complex_float*& out, size_t len,
              Table<complex_float>& mod_table) {
 #ifdef __AVX512F__
@@ -222,7 +430,7 @@ void ModSimd(uint8_t* in, complex_float*& out, size_t len,
     __m512i index = _mm512_setr_epi64(in[0], in[1], in[2], in[3], in[4], in[5],
                                       in[6], in[7]);
     __m512d t = _mm512_i64gather_pd(index, (double*)(mod_table[0]), 8);
-    _mm512_store_pd((double*)(out), t);
+    _mm512_storeu_pd((double*)(out), t);
     in += kSCsPerCacheline;
     out += kSCsPerCacheline;
   }
@@ -231,12 +439,12 @@ void ModSimd(uint8_t* in, complex_float*& out, size_t len,
   for (size_t i = 0; i < len / kSCsPerCacheline; i++) {
     __m256i index = _mm256_setr_epi64x(in[0], in[1], in[2], in[3]);
     __m256d t = _mm256_i64gather_pd((double*)(mod_table[0]), index, 8);
-    _mm256_store_pd((double*)(out), t);
+    _mm256_storeu_pd((double*)(out), t);
     in += half_size;
     out += half_size;
-    index = _mm256_setr_epi64x(in[4], in[5], in[6], in[7]);
+    index = _mm256_setr_epi64x(in[0], in[1], in[2], in[3]);
     t = _mm256_i64gather_pd((double*)(mod_table[0]), index, 8);
-    _mm256_store_pd((double*)(out), t);
+    _mm256_storeu_pd((double*)(out), t);
     in += half_size;
     out += half_size;
   }
@@ -248,6 +456,176 @@ void ModSimd(uint8_t* in, complex_float*& out, size_t len,
   }
 }
 
+// Scale eight integer (I, Q) level pairs and store them as interleaved
+// complex floats. Shared epilogue of the computed modulation kernels.
+static inline void ModScaleStore8(__m256i real_l, __m256i imag_l,
+                                  __m256 scale_v, complex_float* out) {
+  __m256 re_f = _mm256_mul_ps(_mm256_cvtepi32_ps(real_l), scale_v);
+  __m256 im_f = _mm256_mul_ps(_mm256_cvtepi32_ps(imag_l), scale_v);
+  __m256 lo = _mm256_unpacklo_ps(re_f, im_f);
+  __m256 hi = _mm256_unpackhi_ps(re_f, im_f);
+  _mm256_storeu_ps(reinterpret_cast<float*>(out),
+                   _mm256_permute2f128_ps(lo, hi, 0x20));
+  _mm256_storeu_ps(reinterpret_cast<float*>(out) + 8,
+                   _mm256_permute2f128_ps(lo, hi, 0x31));
+}
+
+// Computed 16-QAM mapping. Per axis the 2-bit gray sub-index v (real from
+// bits (3, 1), imag from bits (2, 0)) maps to level +/-(1 + 2 * v0),
+// negative when v1 is set -- see the InitQam16Table() constellation chart.
+void Mod16qamComputedAvx2(uint8_t* in, complex_float*& out, size_t len,
+                          Table<complex_float>& mod_table) {
+  const float scale = 1 / sqrt(10);
+  const __m256 scale_v = _mm256_set1_ps(scale);
+  const __m256i one = _mm256_set1_epi32(1);
+  const __m256i two = _mm256_set1_epi32(2);
+  for (size_t i = 0; i < len / kSCsPerCacheline; i++) {
+    __m256i x = _mm256_cvtepu8_epi32(
+        _mm_loadl_epi64(reinterpret_cast<const __m128i*>(in)));
+    __m256i real_v =
+        _mm256_or_si256(_mm256_and_si256(_mm256_srli_epi32(x, 2), two),
+                        _mm256_and_si256(_mm256_srli_epi32(x, 1), one));
+    __m256i imag_v =
+        _mm256_or_si256(_mm256_and_si256(_mm256_srli_epi32(x, 1), two),
+                        _mm256_and_si256(x, one));
+    __m256i real_l = _mm256_add_epi32(
+        one, _mm256_slli_epi32(_mm256_and_si256(real_v, one), 1));
+    __m256i imag_l = _mm256_add_epi32(
+        one, _mm256_slli_epi32(_mm256_and_si256(imag_v, one), 1));
+    real_l = _mm256_sign_epi32(
+        real_l, _mm256_sub_epi32(one, _mm256_and_si256(real_v, two)));
+    imag_l = _mm256_sign_epi32(
+        imag_l, _mm256_sub_epi32(one, _mm256_and_si256(imag_v, two)));
+    ModScaleStore8(real_l, imag_l, scale_v, out);
+    in += kSCsPerCacheline;
+    out += kSCsPerCacheline;
+  }
+  size_t remainder = len % kSCsPerCacheline;
+  for (size_t i = 0; i < remainder; i++) {
+    out[i] = ModSingleUint8(in[i], mod_table);
+  }
+}
+
+// Computed 64-QAM mapping. Per axis the 3-bit gray sub-index v (real from
+// bits (5, 3, 1), imag from bits (4, 2, 0)) gray-decodes to a magnitude
+// index k = (v & 2) + (~(v ^ (v >> 1)) & 1) with level +/-(2 * k + 1),
+// negative when v2 is set -- matching InitQam64Table()'s level array.
+void Mod64qamComputedAvx2(uint8_t* in, complex_float*& out, size_t len,
+                          Table<complex_float>& mod_table) {
+  const float scale = 1 / sqrt(42);
+  const __m256 scale_v = _mm256_set1_ps(scale);
+  const __m256i one = _mm256_set1_epi32(1);
+  const __m256i two = _mm256_set1_epi32(2);
+  const __m256i four = _mm256_set1_epi32(4);
+  for (size_t i = 0; i < len / kSCsPerCacheline; i++) {
+    __m256i x = _mm256_cvtepu8_epi32(
+        _mm_loadl_epi64(reinterpret_cast<const __m128i*>(in)));
+    __m256i real_v = _mm256_or_si256(
+        _mm256_or_si256(_mm256_and_si256(_mm256_srli_epi32(x, 3), four),
+                        _mm256_and_si256(_mm256_srli_epi32(x, 2), two)),
+        _mm256_and_si256(_mm256_srli_epi32(x, 1), one));
+    __m256i imag_v = _mm256_or_si256(
+        _mm256_or_si256(_mm256_and_si256(_mm256_srli_epi32(x, 2), four),
+                        _mm256_and_si256(_mm256_srli_epi32(x, 1), two)),
+        _mm256_and_si256(x, one));
+    __m256i real_k = _mm256_add_epi32(
+        _mm256_and_si256(real_v, two),
+        _mm256_xor_si256(
+            _mm256_and_si256(
+                _mm256_xor_si256(real_v, _mm256_srli_epi32(real_v, 1)), one),
+            one));
+    __m256i imag_k = _mm256_add_epi32(
+        _mm256_and_si256(imag_v, two),
+        _mm256_xor_si256(
+            _mm256_and_si256(
+                _mm256_xor_si256(imag_v, _mm256_srli_epi32(imag_v, 1)), one),
+            one));
+    __m256i real_l = _mm256_sign_epi32(
+        _mm256_add_epi32(_mm256_slli_epi32(real_k, 1), one),
+        _mm256_sub_epi32(one, _mm256_and_si256(real_v, four)));
+    __m256i imag_l = _mm256_sign_epi32(
+        _mm256_add_epi32(_mm256_slli_epi32(imag_k, 1), one),
+        _mm256_sub_epi32(one, _mm256_and_si256(imag_v, four)));
+    ModScaleStore8(real_l, imag_l, scale_v, out);
+    in += kSCsPerCacheline;
+    out += kSCsPerCacheline;
+  }
+  size_t remainder = len % kSCsPerCacheline;
+  for (size_t i = 0; i < remainder; i++) {
+    out[i] = ModSingleUint8(in[i], mod_table);
+  }
+}
+
+// Computed 256-QAM mapping. Per axis the 4-bit gray sub-index v (real from
+// bits (7, 5, 3, 1), imag from bits (6, 4, 2, 0)) gray-decodes its low
+// three bits t = v & 7 as b = t ^ (t >> 1) ^ (t >> 2), giving level
+// +/-(15 - 2 * b); v3 set selects the positive half-axis -- matching
+// InitQam256Table()'s gray-coded level array.
+void Mod256qamComputedAvx2(uint8_t* in, complex_float*& out, size_t len,
+                           Table<complex_float>& mod_table) {
+  const float scale = 1 / sqrt(170);
+  const __m256 scale_v = _mm256_set1_ps(scale);
+  const __m256i one = _mm256_set1_epi32(1);
+  const __m256i two = _mm256_set1_epi32(2);
+  const __m256i four = _mm256_set1_epi32(4);
+  const __m256i seven = _mm256_set1_epi32(7);
+  const __m256i eight = _mm256_set1_epi32(8);
+  const __m256i fifteen = _mm256_set1_epi32(15);
+  for (size_t i = 0; i < len / kSCsPerCacheline; i++) {
+    __m256i x = _mm256_cvtepu8_epi32(
+        _mm_loadl_epi64(reinterpret_cast<const __m128i*>(in)));
+    __m256i real_v = _mm256_or_si256(
+        _mm256_or_si256(_mm256_and_si256(_mm256_srli_epi32(x, 4), eight),
+                        _mm256_and_si256(_mm256_srli_epi32(x, 3), four)),
+        _mm256_or_si256(_mm256_and_si256(_mm256_srli_epi32(x, 2), two),
+                        _mm256_and_si256(_mm256_srli_epi32(x, 1), one)));
+    __m256i imag_v = _mm256_or_si256(
+        _mm256_or_si256(_mm256_and_si256(_mm256_srli_epi32(x, 3), eight),
+                        _mm256_and_si256(_mm256_srli_epi32(x, 2), four)),
+        _mm256_or_si256(_mm256_and_si256(_mm256_srli_epi32(x, 1), two),
+                        _mm256_and_si256(x, one)));
+    __m256i real_t = _mm256_and_si256(real_v, seven);
+    __m256i imag_t = _mm256_and_si256(imag_v, seven);
+    __m256i real_b =
+        _mm256_xor_si256(_mm256_xor_si256(real_t, _mm256_srli_epi32(real_t, 1)),
+                         _mm256_srli_epi32(real_t, 2));
+    __m256i imag_b =
+        _mm256_xor_si256(_mm256_xor_si256(imag_t, _mm256_srli_epi32(imag_t, 1)),
+                         _mm256_srli_epi32(imag_t, 2));
+    __m256i real_l = _mm256_sign_epi32(
+        _mm256_sub_epi32(fifteen, _mm256_slli_epi32(real_b, 1)),
+        _mm256_sub_epi32(_mm256_and_si256(real_v, eight), four));
+    __m256i imag_l = _mm256_sign_epi32(
+        _mm256_sub_epi32(fifteen, _mm256_slli_epi32(imag_b, 1)),
+        _mm256_sub_epi32(_mm256_and_si256(imag_v, eight), four));
+    ModScaleStore8(real_l, imag_l, scale_v, out);
+    in += kSCsPerCacheline;
+    out += kSCsPerCacheline;
+  }
+  size_t remainder = len % kSCsPerCacheline;
+  for (size_t i = 0; i < remainder; i++) {
+    out[i] = ModSingleUint8(in[i], mod_table);
+  }
+}
+
+void ModSimdComputed(uint8_t* in, complex_float*& out, size_t len,
+                     size_t mod_order_bits, Table<complex_float>& mod_table) {
+  switch (mod_order_bits) {
+    case 4:
+      Mod16qamComputedAvx2(in, out, len, mod_table);
+      break;
+    case 6:
+      Mod64qamComputedAvx2(in, out, len, mod_table);
+      break;
+    case 8:
+      Mod256qamComputedAvx2(in, out, len, mod_table);
+      break;
+    default:
+      ModSimd(in, out, len, mod_table);
+      break;
+  }
+}
+
 /**
  ***********************************************************************************
  * Demodulation functions
@@ -660,6 +1038,92 @@ void Demod16qamSoftAvx2(float* vec_in, int8_t* llr, int num) {
                     num - next_start);
 }
 
+#ifdef __AVX512F__
+void Demod16qamSoftAvx512(float* vec_in, int8_t* llr, int num) {
+  float* symbols_ptr = vec_in;
+  auto* result_ptr = reinterpret_cast<__m512i*>(llr);
+  __m512 symbol1;
+  __m512 symbol2;
+  __m512 symbol3;
+  __m512 symbol4;
+  __m512i symbol_i1;
+  __m512i symbol_i2;
+  __m512i symbol_i3;
+  __m512i symbol_i4;
+  __m512i symbol_i;
+  __m512i symbol_abs;
+  __m512i symbol_12;
+  __m512i symbol_34;
+  __m512i result_n;
+  __m512i result_a;
+  __m512i offset = _mm512_set1_epi8(2 * SCALE_BYTE_CONV_QAM16 / sqrt(10));
+  __m512 scale_v = _mm512_set1_ps(SCALE_BYTE_CONV_QAM16);
+  __m512i fix_pack = _mm512_set_epi64(7, 5, 3, 1, 6, 4, 2, 0);
+  __m512i zero_vec = _mm512_set_epi64(0, 0, 0, 0, 0, 0, 0, 0);
+
+  // Each symbol emits two 16-bit output words: the (real, imag) LLR pair
+  // followed by the (offset - |real|, offset - |imag|) pair. Even output
+  // words take the former, odd words the latter; output word w of either
+  // kind comes from symbol word w/2 (plus 16 for the second store).
+  __mmask32 negated_mask = 0x55555555;
+  __mmask32 abs_mask = 0xAAAAAAAA;
+  __m512i spread_idx_1 = _mm512_setr_epi64(
+      0x0001000100000000L, 0x0003000300020002L, 0x0005000500040004L,
+      0x0007000700060006L, 0x0009000900080008L, 0x000b000b000a000aL,
+      0x000d000d000c000cL, 0x000f000f000e000eL);
+  __m512i spread_idx_2 = _mm512_setr_epi64(
+      0x0011001100100010L, 0x0013001300120012L, 0x0015001500140014L,
+      0x0017001700160016L, 0x0019001900180018L, 0x001b001b001a001aL,
+      0x001d001d001c001cL, 0x001f001f001e001eL);
+
+  for (int i = 0; i < num / 32; i++) {
+    symbol1 = _mm512_load_ps(symbols_ptr);
+    symbols_ptr += 16;
+    symbol2 = _mm512_load_ps(symbols_ptr);
+    symbols_ptr += 16;
+    symbol3 = _mm512_load_ps(symbols_ptr);
+    symbols_ptr += 16;
+    symbol4 = _mm512_load_ps(symbols_ptr);
+    symbols_ptr += 16;
+    symbol_i1 = _mm512_cvtps_epi32(_mm512_mul_ps(symbol1, scale_v));
+    symbol_i2 = _mm512_cvtps_epi32(_mm512_mul_ps(symbol2, scale_v));
+    symbol_i3 = _mm512_cvtps_epi32(_mm512_mul_ps(symbol3, scale_v));
+    symbol_i4 = _mm512_cvtps_epi32(_mm512_mul_ps(symbol4, scale_v));
+    // Pack symbols into 16 bit integers
+    symbol_12 = _mm512_packs_epi32(symbol_i1, symbol_i2);
+    // _packs intrinsic interleaves the two vectors, _permute fixes that
+    symbol_12 = _mm512_permutexvar_epi64(fix_pack, symbol_12);
+    symbol_34 = _mm512_packs_epi32(symbol_i3, symbol_i4);
+    symbol_34 = _mm512_permutexvar_epi64(fix_pack, symbol_34);
+    // Pack symbols into 8 bit integers (one 512 bit vector)
+    symbol_i = _mm512_packs_epi16(symbol_12, symbol_34);
+    symbol_i = _mm512_permutexvar_epi64(fix_pack, symbol_i);
+
+    // First LLR is the symbol itself, second is the distance of its
+    // absolute value from the bit 1/0 flip point
+    symbol_abs = _mm512_sub_epi8(offset, _mm512_abs_epi8(symbol_i));
+
+    result_n = _mm512_mask_permutexvar_epi16(zero_vec, negated_mask,
+                                             spread_idx_1, symbol_i);
+    result_a = _mm512_mask_permutexvar_epi16(zero_vec, abs_mask, spread_idx_1,
+                                             symbol_abs);
+    _mm512_storeu_si512(result_ptr, _mm512_or_si512(result_n, result_a));
+    result_ptr++;
+
+    result_n = _mm512_mask_permutexvar_epi16(zero_vec, negated_mask,
+                                             spread_idx_2, symbol_i);
+    result_a = _mm512_mask_permutexvar_epi16(zero_vec, abs_mask, spread_idx_2,
+                                             symbol_abs);
+    _mm512_storeu_si512(result_ptr, _mm512_or_si512(result_n, result_a));
+    result_ptr++;
+  }
+  // Demodulate last symbols
+  int next_start = 32 * (num / 32);
+  Demod16qamSoftAvx2(vec_in + 2 * next_start, llr + next_start * 4,
+                     num - next_start);
+}
+#endif
+
 /**
  * 64-QAM modulation
  *              Q
@@ -1222,6 +1686,121 @@ void Demod64qamSoftAvx2(float* vec_in, int8_t* llr, int num) {
                     num - next_start);
 }
 
+#ifdef __AVX512F__
+void Demod64qamSoftAvx512(float* vec_in, int8_t* llr, int num) {
+  float* symbols_ptr = vec_in;
+  auto* result_ptr = reinterpret_cast<__m512i*>(llr);
+  __m512 symbol1;
+  __m512 symbol2;
+  __m512 symbol3;
+  __m512 symbol4;
+  __m512i symbol_i1;
+  __m512i symbol_i2;
+  __m512i symbol_i3;
+  __m512i symbol_i4;
+  __m512i symbol_i;
+  __m512i symbol_abs;
+  __m512i symbol_abs2;
+  __m512i symbol_12;
+  __m512i symbol_34;
+  __m512i result_n;
+  __m512i result_a;
+  __m512i result_a2;
+  __m512i offset1 = _mm512_set1_epi8(4 * SCALE_BYTE_CONV_QAM64 / sqrt(42));
+  __m512i offset2 = _mm512_set1_epi8(2 * SCALE_BYTE_CONV_QAM64 / sqrt(42));
+  __m512 scale_v = _mm512_set1_ps(SCALE_BYTE_CONV_QAM64);
+  __m512i fix_pack = _mm512_set_epi64(7, 5, 3, 1, 6, 4, 2, 0);
+  __m512i zero_vec = _mm512_set_epi64(0, 0, 0, 0, 0, 0, 0, 0);
+
+  // Each symbol emits three 16-bit output words: the (real, imag) LLR pair
+  // followed by the two (offset - |.|) pairs. Global output word j belongs
+  // to symbol word j/3 and layer j%3; since 32 is not a multiple of 3, the
+  // per-layer word masks rotate between the three stores.
+  __mmask32 layer_mask_a = 0x49249249;  // j % 3 == 0
+  __mmask32 layer_mask_b = 0x92492492;  // j % 3 == 1
+  __mmask32 layer_mask_c = 0x24924924;  // j % 3 == 2
+  __m512i spread_idx_1 = _mm512_setr_epi64(
+      0x0001000000000000L, 0x0002000200010001L, 0x0003000300030002L,
+      0x0005000400040004L, 0x0006000600050005L, 0x0007000700070006L,
+      0x0009000800080008L, 0x000a000a00090009L);
+  __m512i spread_idx_2 = _mm512_setr_epi64(
+      0x000b000b000b000aL, 0x000d000c000c000cL, 0x000e000e000d000dL,
+      0x000f000f000f000eL, 0x0011001000100010L, 0x0012001200110011L,
+      0x0013001300130012L, 0x0015001400140014L);
+  __m512i spread_idx_3 = _mm512_setr_epi64(
+      0x0016001600150015L, 0x0017001700170016L, 0x0019001800180018L,
+      0x001a001a00190019L, 0x001b001b001b001aL, 0x001d001c001c001cL,
+      0x001e001e001d001dL, 0x001f001f001f001eL);
+
+  for (int i = 0; i < num / 32; i++) {
+    // Load symbols, 8 real and 8 imaginary values at a time
+    symbol1 = _mm512_load_ps(symbols_ptr);
+    symbols_ptr += 16;
+    symbol2 = _mm512_load_ps(symbols_ptr);
+    symbols_ptr += 16;
+    symbol3 = _mm512_load_ps(symbols_ptr);
+    symbols_ptr += 16;
+    symbol4 = _mm512_load_ps(symbols_ptr);
+    symbols_ptr += 16;
+    // Cast symbols into integers
+    symbol_i1 = _mm512_cvtps_epi32(_mm512_mul_ps(symbol1, scale_v));
+    symbol_i2 = _mm512_cvtps_epi32(_mm512_mul_ps(symbol2, scale_v));
+    symbol_i3 = _mm512_cvtps_epi32(_mm512_mul_ps(symbol3, scale_v));
+    symbol_i4 = _mm512_cvtps_epi32(_mm512_mul_ps(symbol4, scale_v));
+    // Pack symbols into 16 bit integers
+    symbol_12 = _mm512_packs_epi32(symbol_i1, symbol_i2);
+    // _packs intrinsic interleaves the two vectors, _permute fixes that
+    symbol_12 = _mm512_permutexvar_epi64(fix_pack, symbol_12);
+    symbol_34 = _mm512_packs_epi32(symbol_i3, symbol_i4);
+    symbol_34 = _mm512_permutexvar_epi64(fix_pack, symbol_34);
+    // Pack symbols into 8 bit integers (one 512 bit vector)
+    symbol_i = _mm512_packs_epi16(symbol_12, symbol_34);
+    symbol_i = _mm512_permutexvar_epi64(fix_pack, symbol_i);
+    // LLR(b5,b4) = |x|, LLR(b3,b2) = 4d - |x|, LLR(b1,b0) = 2d - |4d - |x||
+    // (same layering as the AVX2 kernel)
+    symbol_abs = _mm512_sub_epi8(offset1, _mm512_abs_epi8(symbol_i));
+    symbol_abs2 = _mm512_sub_epi8(offset2, _mm512_abs_epi8(symbol_abs));
+
+    result_n = _mm512_mask_permutexvar_epi16(zero_vec, layer_mask_a,
+                                             spread_idx_1, symbol_i);
+    result_a = _mm512_mask_permutexvar_epi16(zero_vec, layer_mask_b,
+                                             spread_idx_1, symbol_abs);
+    result_a2 = _mm512_mask_permutexvar_epi16(zero_vec, layer_mask_c,
+                                              spread_idx_1, symbol_abs2);
+    _mm512_storeu_si512(
+        result_ptr, _mm512_or_si512(_mm512_or_si512(result_n, result_a),
+                                    result_a2));
+    result_ptr++;
+
+    result_n = _mm512_mask_permutexvar_epi16(zero_vec, layer_mask_b,
+                                             spread_idx_2, symbol_i);
+    result_a = _mm512_mask_permutexvar_epi16(zero_vec, layer_mask_c,
+                                             spread_idx_2, symbol_abs);
+    result_a2 = _mm512_mask_permutexvar_epi16(zero_vec, layer_mask_a,
+                                              spread_idx_2, symbol_abs2);
+    _mm512_storeu_si512(
+        result_ptr, _mm512_or_si512(_mm512_or_si512(result_n, result_a),
+                                    result_a2));
+    result_ptr++;
+
+    result_n = _mm512_mask_permutexvar_epi16(zero_vec, layer_mask_c,
+                                             spread_idx_3, symbol_i);
+    result_a = _mm512_mask_permutexvar_epi16(zero_vec, layer_mask_a,
+                                             spread_idx_3, symbol_abs);
+    result_a2 = _mm512_mask_permutexvar_epi16(zero_vec, layer_mask_b,
+                                              spread_idx_3, symbol_abs2);
+    _mm512_storeu_si512(
+        result_ptr, _mm512_or_si512(_mm512_or_si512(result_n, result_a),
+                                    result_a2));
+    result_ptr++;
+  }
+  // Demodulate last symbols
+  int next_start = 32 * (num / 32);
+  Demod64qamSoftAvx2(vec_in + 2 * next_start, llr + next_start * 6,
+                     num - next_start);
+}
+#endif
+
 /**
  * 256-QAM Modulation
  *  Q
@@ -2687,4 +3266,54 @@ void Demod256qamSoftAvx512(const float* vec_in, int8_t* llr, int num) {
   Demod256qamSoftAvx2(vec_in + 2 * next_start, llr + next_start * 8,
                       num - next_start);
 }
-#endif
\ No newline at end of file
+#endif
+void PackLlrsTo4Bit(const int8_t* llrs, int8_t* packed, size_t num) {
+  size_t i = 0;
+  const __m256i nibble_mask = _mm256_set1_epi8(0x0F);
+  // Bytes 0,2,..,14 of each 128-bit lane carry a packed pair after the
+  // shift-and-or below; gather them into the lane's low half
+  const __m256i gather_even = _mm256_setr_epi8(
+      0, 2, 4, 6, 8, 10, 12, 14, -1, -1, -1, -1, -1, -1, -1, -1,  //
+      0, 2, 4, 6, 8, 10, 12, 14, -1, -1, -1, -1, -1, -1, -1, -1);
+  for (; (i + 32) <= num; i += 32) {
+    const __m256i a =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(llrs + i));
+    // High nibble of each LLR, moved to the low position. The bits shifted
+    // in from the neighboring byte land in the masked-off high nibble.
+    const __m256i nib =
+        _mm256_and_si256(_mm256_srli_epi16(a, 4), nibble_mask);
+    // Within each 16-bit lane [even, odd]: low byte becomes even | odd << 4
+    const __m256i pair = _mm256_or_si256(nib, _mm256_srli_epi16(nib, 4));
+    const __m256i gathered = _mm256_shuffle_epi8(pair, gather_even);
+    const __m128i lo = _mm256_castsi256_si128(gathered);
+    const __m128i hi = _mm256_extracti128_si256(gathered, 1);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(packed + (i / 2)),
+                     _mm_unpacklo_epi64(lo, hi));
+  }
+  for (; i < num; i += 2) {
+    const uint8_t even = (static_cast<uint8_t>(llrs[i]) >> 4) & 0x0F;
+    const uint8_t odd = static_cast<uint8_t>(llrs[i + 1]) & 0xF0;
+    packed[i / 2] = static_cast<int8_t>(even | odd);
+  }
+}
+
+void UnpackLlrsFrom4Bit(const int8_t* packed, int8_t* llrs, size_t num) {
+  size_t i = 0;
+  const __m256i lo_mask = _mm256_set1_epi16(0x00F0);
+  for (; (i + 32) <= num; i += 32) {
+    const __m128i p =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(packed + (i / 2)));
+    const __m256i x = _mm256_cvtepu8_epi16(p);
+    // Even LLR: low nibble restored to the high position of the low byte;
+    // odd LLR: high nibble kept in place, moved to the high byte
+    const __m256i even = _mm256_and_si256(_mm256_slli_epi16(x, 4), lo_mask);
+    const __m256i odd = _mm256_slli_epi16(_mm256_and_si256(x, lo_mask), 8);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(llrs + i),
+                        _mm256_or_si256(even, odd));
+  }
+  for (; i < num; i += 2) {
+    const auto p = static_cast<uint8_t>(packed[i / 2]);
+    llrs[i] = static_cast<int8_t>(p << 4);
+    llrs[i + 1] = static_cast<int8_t>(p & 0xF0);
+  }
+}
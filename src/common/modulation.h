@@ -42,6 +42,22 @@ complex_float ModSingleUint8(uint8_t x, Table<complex_float>& mod_table);
 void ModSimd(uint8_t* in, complex_float*& out, size_t len,
              Table<complex_float>& mod_table);
 
+// Computed modulation kernels for the square QAM constellations. The I/Q
+// levels are derived in-register from the gray-coded bit fields (integer
+// unpack, gray decode, scale), so the hot loop issues no table gathers.
+// Output is bit-exact with the Table<complex_float> lookup; mod_table is
+// only used for the scalar remainder. ModSimdComputed() selects the
+// matching kernel by modulation order and falls back to the table-gather
+// ModSimd() for constellations without a computed form (e.g. QPSK).
+void Mod16qamComputedAvx2(uint8_t* in, complex_float*& out, size_t len,
+                          Table<complex_float>& mod_table);
+void Mod64qamComputedAvx2(uint8_t* in, complex_float*& out, size_t len,
+                          Table<complex_float>& mod_table);
+void Mod256qamComputedAvx2(uint8_t* in, complex_float*& out, size_t len,
+                           Table<complex_float>& mod_table);
+void ModSimdComputed(uint8_t* in, complex_float*& out, size_t len,
+                     size_t mod_order_bits, Table<complex_float>& mod_table);
+
 void DemodQpskSoftSse(float* x, int8_t* z, int len);
 
 void Demod16qamHardLoop(const float* vec_in, uint8_t* vec_out, int num);
@@ -51,6 +67,9 @@ void Demod16qamHardAvx2(float* vec_in, uint8_t* vec_out, int num);
 void Demod16qamSoftLoop(const float* vec_in, int8_t* llr, int num);
 void Demod16qamSoftSse(float* vec_in, int8_t* llr, int num);
 void Demod16qamSoftAvx2(float* vec_in, int8_t* llr, int num);
+#ifdef __AVX512F__
+void Demod16qamSoftAvx512(float* vec_in, int8_t* llr, int num);
+#endif
 
 void Demod64qamHardLoop(const float* vec_in, uint8_t* vec_out, int num);
 void Demod64qamHardSse(float* vec_in, uint8_t* vec_out, int num);
@@ -59,6 +78,9 @@ void Demod64qamHardAvx2(float* vec_in, uint8_t* vec_out, int num);
 void Demod64qamSoftLoop(const float* vec_in, int8_t* llr, int num);
 void Demod64qamSoftSse(float* vec_in, int8_t* llr, int num);
 void Demod64qamSoftAvx2(float* vec_in, int8_t* llr, int num);
+#ifdef __AVX512F__
+void Demod64qamSoftAvx512(float* vec_in, int8_t* llr, int num);
+#endif
 
 void Demod256qamHardLoop(const float* vec_in, uint8_t* vec_out, int num);
 void Demod256qamHardSse(float* vec_in, uint8_t* vec_out, int num);
@@ -73,6 +95,34 @@ void Demod256qamSoftAvx2(const float* vec_in, int8_t* llr, int num);
 #ifdef __AVX512F__
 void Demod256qamSoftAvx512(const float* vec_in, int8_t* llr, int num);
 #endif
+
+// Runtime-dispatched soft demodulator entry points. The widest kernels the
+// CPU supports are selected once in InitModulationTable(), so hot loops jump
+// through a resolved function pointer with no per-call ISA branching.
+void Demod16qamSoft(float* vec_in, int8_t* llr, int num);
+void Demod64qamSoft(float* vec_in, int8_t* llr, int num);
+void Demod256qamSoft(const float* vec_in, int8_t* llr, int num);
+
+// Planar (structure-of-arrays) soft demodulators: separate real and
+// imaginary planes (e.g. PlanarTable rows), so the float stage runs on
+// plain vector loads with no I/Q deinterleave shuffles. Output layout and
+// values are bit-exact with the interleaved SIMD kernels. AVX2 only; num
+// need not be a SIMD multiple (scalar tail).
+void DemodQpskSoftPlanar(const float* re, const float* im, int8_t* llr,
+                         int num);
+void Demod16qamSoftPlanarAvx2(const float* re, const float* im, int8_t* llr,
+                              int num);
+void Demod64qamSoftPlanarAvx2(const float* re, const float* im, int8_t* llr,
+                              int num);
+
+// 4-bit LLR quantization. PackLlrsTo4Bit() keeps the signed high nibble of
+// each int8 LLR and packs two per byte (even LLR in the low nibble), halving
+// LLR buffer footprint and traffic; UnpackLlrsFrom4Bit() expands nibbles
+// back to int8 (nibble << 4) for decoders that want byte LLRs. num is the
+// LLR count and must be even.
+void PackLlrsTo4Bit(const int8_t* llrs, int8_t* packed, size_t num);
+void UnpackLlrsFrom4Bit(const int8_t* packed, int8_t* llrs, size_t num);
+
 void Print256Epi8(__m256i var);
 
 #endif  // MODULATION_H_
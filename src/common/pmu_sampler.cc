@@ -0,0 +1,221 @@
+/**
+ * @file pmu_sampler.cc
+ * @brief Implementation file for the PmuSampler class.
+ */
+#include "pmu_sampler.h"
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+#include "logger.h"
+
+/// The perf_event config value and report label of each sampled counter
+static constexpr uint64_t kPmuEventConfigs[PmuSampler::kNumPmuEvents] = {
+    PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_STALLED_CYCLES_BACKEND,
+    PERF_COUNT_HW_INSTRUCTIONS};
+static const char* const kPmuEventNames[PmuSampler::kNumPmuEvents] = {
+    "llc-misses", "stalled-cycles-backend", "instructions"};
+
+/// Kernel read layout for a group read with
+/// PERF_FORMAT_GROUP | TOTAL_TIME_ENABLED | TOTAL_TIME_RUNNING
+struct GroupReadFormat {
+  uint64_t nr_;
+  uint64_t time_enabled_;
+  uint64_t time_running_;
+  uint64_t values_[PmuSampler::kNumPmuEvents];
+};
+
+/// All samplers ever opened, kept alive past thread exit so the report
+/// at shutdown sees every thread's totals
+static std::mutex pmu_registry_mutex;
+static std::vector<PmuSampler*> pmu_registry;
+
+static long PerfEventOpen(struct perf_event_attr* attr, pid_t pid, int cpu,
+                          int group_fd, unsigned long flags) {
+  return syscall(SYS_perf_event_open, attr, pid, cpu, group_fd, flags);
+}
+
+PmuSampler::PmuSampler() {
+  for (size_t i = 0; i < kNumPmuEvents; i++) {
+    event_fds_[i] = -1;
+  }
+  for (size_t i = 0; i < kNumPmuEvents; i++) {
+    struct perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = kPmuEventConfigs[i];
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    if (i == 0) {
+      // Group leader: starts disabled, carries the read format for the
+      // whole group
+      attr.disabled = 1;
+      attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+                         PERF_FORMAT_TOTAL_TIME_RUNNING;
+    }
+    const int group_fd = (i == 0) ? -1 : event_fds_[0];
+    const long fd = PerfEventOpen(&attr, 0 /* this thread */, -1 /* any cpu */,
+                                  group_fd, 0);
+    if (fd < 0) {
+      MLPD_WARN("PmuSampler: perf_event_open(%s) failed: %s\n",
+                kPmuEventNames[i], std::strerror(errno));
+      for (size_t j = 0; j < i; j++) {
+        close(event_fds_[j]);
+        event_fds_[j] = -1;
+      }
+      return;
+    }
+    event_fds_[i] = static_cast<int>(fd);
+  }
+  ioctl(event_fds_[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+  ioctl(event_fds_[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+PmuSampler::~PmuSampler() {
+  for (int& fd : event_fds_) {
+    if (fd != -1) {
+      close(fd);
+      fd = -1;
+    }
+  }
+}
+
+void PmuSampler::Enable() {
+  enabled_ = true;
+  MLPD_INFO("PmuSampler: sampling %s / %s / %s around doer launches\n",
+            kPmuEventNames[0], kPmuEventNames[1], kPmuEventNames[2]);
+}
+
+PmuSampler* PmuSampler::ThreadInstance() {
+  if (enabled_ == false) {
+    return nullptr;
+  }
+  // One open attempt per thread; a failed open stays nullptr instead of
+  // hammering perf_event_open() on every launch
+  thread_local PmuSampler* sampler = nullptr;
+  thread_local bool attempted = false;
+  if (attempted == false) {
+    attempted = true;
+    // Never freed: samplers must outlive their thread so PrintReport()
+    // at shutdown can still read the totals
+    auto* new_sampler = new PmuSampler();
+    if (new_sampler->event_fds_[0] == -1) {
+      delete new_sampler;
+    } else {
+      sampler = new_sampler;
+      std::scoped_lock lock(pmu_registry_mutex);
+      pmu_registry.push_back(sampler);
+    }
+  }
+  return sampler;
+}
+
+bool PmuSampler::DoerTypeOfEvent(EventType event_type, DoerType* doer_type) {
+  switch (event_type) {
+    case EventType::kFFT:
+      *doer_type = DoerType::kFFT;
+      return true;
+    case EventType::kFFTPilot:
+      *doer_type = DoerType::kCSI;
+      return true;
+    case EventType::kZF:
+      *doer_type = DoerType::kZF;
+      return true;
+    case EventType::kDemul:
+      *doer_type = DoerType::kDemul;
+      return true;
+    case EventType::kDecode:
+      *doer_type = DoerType::kDecode;
+      return true;
+    case EventType::kEncode:
+      *doer_type = DoerType::kEncode;
+      return true;
+    case EventType::kIFFT:
+      *doer_type = DoerType::kIFFT;
+      return true;
+    case EventType::kPrecode:
+      *doer_type = DoerType::kPrecode;
+      return true;
+    default:
+      return false;
+  }
+}
+
+bool PmuSampler::ReadSample(Sample* sample) const {
+  GroupReadFormat buf;
+  const ssize_t ret = read(event_fds_[0], &buf, sizeof(buf));
+  if ((ret != static_cast<ssize_t>(sizeof(buf))) ||
+      (buf.nr_ != kNumPmuEvents)) {
+    return false;
+  }
+  for (size_t i = 0; i < kNumPmuEvents; i++) {
+    sample->values_[i] = buf.values_[i];
+  }
+  sample->time_enabled_ = buf.time_enabled_;
+  sample->time_running_ = buf.time_running_;
+  return true;
+}
+
+void PmuSampler::AccumulateDelta(DoerType doer_type, const Sample& begin,
+                                 const Sample& end) {
+  Accum& accum = accum_[static_cast<size_t>(doer_type)];
+  for (size_t i = 0; i < kNumPmuEvents; i++) {
+    accum.raw_[i] += end.values_[i] - begin.values_[i];
+  }
+  accum.time_enabled_ += end.time_enabled_ - begin.time_enabled_;
+  accum.time_running_ += end.time_running_ - begin.time_running_;
+  accum.num_launches_++;
+}
+
+void PmuSampler::PrintReport() {
+  if (enabled_ == false) {
+    return;
+  }
+  std::scoped_lock lock(pmu_registry_mutex);
+  std::printf("PmuSampler: per-doer counter totals over %zu threads\n",
+              pmu_registry.size());
+  for (const DoerType doer_type : kAllDoerTypes) {
+    Accum total;
+    for (const PmuSampler* sampler : pmu_registry) {
+      const Accum& accum = sampler->accum_[static_cast<size_t>(doer_type)];
+      for (size_t i = 0; i < kNumPmuEvents; i++) {
+        total.raw_[i] += accum.raw_[i];
+      }
+      total.time_enabled_ += accum.time_enabled_;
+      total.time_running_ += accum.time_running_;
+      total.num_launches_ += accum.num_launches_;
+    }
+    if (total.num_launches_ == 0) {
+      continue;
+    }
+    // Scale up for counter multiplexing: raw counts only cover the
+    // fraction of the time the group was actually on the PMU
+    const double scale =
+        (total.time_running_ > 0)
+            ? static_cast<double>(total.time_enabled_) /
+                  static_cast<double>(total.time_running_)
+            : 1.0;
+    std::printf("  %s: %zu launches", kDoerNames.at(doer_type).c_str(),
+                static_cast<size_t>(total.num_launches_));
+    for (size_t i = 0; i < kNumPmuEvents; i++) {
+      const double scaled = static_cast<double>(total.raw_[i]) * scale;
+      std::printf(", %s %.3g (%.1f/launch)", kPmuEventNames[i], scaled,
+                  scaled / static_cast<double>(total.num_launches_));
+    }
+    if (total.time_running_ < total.time_enabled_) {
+      std::printf(" [multiplexed, %.0f%% on]",
+                  100.0 * static_cast<double>(total.time_running_) /
+                      static_cast<double>(total.time_enabled_));
+    }
+    std::printf("\n");
+  }
+}
@@ -0,0 +1,91 @@
+/**
+ * @file pmu_sampler.h
+ * @brief Declaration file for the PmuSampler class. Samples hardware PMU
+ * counters around doer launches through the perf_event interface.
+ */
+#ifndef PMU_SAMPLER_H_
+#define PMU_SAMPLER_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+
+#include "symbols.h"
+
+/**
+ * @brief Per-thread perf_event counter group sampled around each doer
+ * launch, so the per-doer cycle stats can be broken down into
+ * memory-bound vs compute-bound behavior without running external perf
+ * against a live cell.
+ *
+ * Each worker thread owns one thread-scoped event group (LLC misses,
+ * backend-stalled cycles, retired instructions) that is read with a
+ * single syscall before and after a launch; the deltas accumulate into
+ * per-DoerType totals. The kernel multiplexes the group when counters
+ * are oversubscribed, so totals are scaled by time_enabled/time_running
+ * at report time. Sampling is off unless the config sets pmu_counters,
+ * and degrades to a no-op with one warning if perf_event_open() is not
+ * permitted (e.g. restrictive perf_event_paranoid).
+ */
+class PmuSampler {
+ public:
+  /// Hardware events sampled per launch: LLC misses, backend-stalled
+  /// cycles, retired instructions
+  static constexpr size_t kNumPmuEvents = 3;
+
+  /// One group read of all counters plus the multiplexing timebase
+  struct Sample {
+    uint64_t values_[kNumPmuEvents];
+    uint64_t time_enabled_;
+    uint64_t time_running_;
+  };
+
+  /// Turn on PMU sampling process-wide. Called once at startup, before
+  /// the worker threads are created
+  static void Enable();
+  static bool IsEnabled() { return enabled_; }
+
+  /// The calling thread's sampler, opened on first use. Returns nullptr
+  /// when sampling is disabled or the perf events could not be opened
+  static PmuSampler* ThreadInstance();
+
+  /// Map a worker-bound event to the DoerType that accounts its samples.
+  /// Returns false for events with no doer accounting
+  static bool DoerTypeOfEvent(EventType event_type, DoerType* doer_type);
+
+  /// Read every counter of this thread's event group with one syscall.
+  /// Returns false if the read failed
+  bool ReadSample(Sample* sample) const;
+
+  /// Accumulate (end - begin) into the totals for doer_type
+  void AccumulateDelta(DoerType doer_type, const Sample& begin,
+                       const Sample& end);
+
+  /// Print per-doer-type counter totals and per-launch averages,
+  /// aggregated over all sampling threads and scaled for counter
+  /// multiplexing. No-op when nothing was sampled
+  static void PrintReport();
+
+ private:
+  PmuSampler();
+  ~PmuSampler();
+
+  /// Counter totals for one (thread, DoerType) pair, in raw (unscaled)
+  /// counts plus the group's enabled/running time for multiplex scaling
+  struct Accum {
+    uint64_t raw_[kNumPmuEvents] = {0, 0, 0};
+    uint64_t time_enabled_ = 0;
+    uint64_t time_running_ = 0;
+    uint64_t num_launches_ = 0;
+  };
+
+  /// event_fds_[0] is the group leader; -1 in every slot if open failed
+  int event_fds_[kNumPmuEvents];
+  Accum accum_[kNumDoerTypes];
+
+  static inline bool enabled_ = false;
+};
+
+#endif  // PMU_SAMPLER_H_
@@ -1,6 +1,10 @@
 #ifndef RAN_CONFIG_H_
 #define RAN_CONFIG_H_
 
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
 /**
  * @brief The struct that contains the RAN configuration that Agora must
  * apply for a particular frame.
@@ -14,6 +18,16 @@ class RanConfig {
   size_t n_antennas_;      /// Number of active antennas at the base station
   size_t mod_order_bits_;  /// modulation type (number of bits)
   size_t frame_id_;        /// frame ID
+  /// New frame schedule (e.g. "BPUUD..."); empty leaves the schedule
+  /// unchanged. Applied only at a frame boundary, and only when it fits
+  /// the buffer capacities (see Config::UpdateFrameSchedule)
+  std::string frame_schedule_;
+  /// Uplink resource allocation at demul-block granularity: bit b set
+  /// means subcarrier block b carries scheduled uplink data. All-ones
+  /// (the default) keeps the full band active; bits past the number of
+  /// demul blocks are ignored. Applied only at a frame boundary (see
+  /// Agora::ApplyUlBlockMask)
+  uint64_t ul_block_mask_ = UINT64_MAX;
 };
 
 /**
@@ -4,126 +4,102 @@
  */
 #include "scrambler.h"
 
+#include <immintrin.h>
+
 namespace AgoraScrambler {
 
 static const size_t kBitsInitArraySize = 7u;
-static const size_t kStartingVectorSize = (100 * 8);
 
-Scrambler::Scrambler()
-    : scram_buffer_(kScramblerlength), bit_buffer_(kStartingVectorSize) {}
+Scrambler::Scrambler() {
+  // Generate scrambler initial state array from the seed, Bit0 ~ Bit6
+  // mapped to x1 ~ x7 and then reversed
+  std::array<int8_t, kBitsInitArraySize> scrambler_init_bits;
+  std::array<int8_t, kBitsInitArraySize> b_scrambler_init_bits;
+  scrambler_init_bits.fill(0);
+
+  size_t j = 1;
+  int8_t tmp = kScramblerInitState;
+  while ((j <= 7) && (tmp > 0)) {
+    scrambler_init_bits.at(j - 1) = tmp % 2;
+    tmp /= 2;
+    j++;
+  }
+  for (size_t i = 0; i < 7; i++) {
+    b_scrambler_init_bits.at(i) = scrambler_init_bits.at(6 - i);
+  }
+  for (size_t i = 0; i < 7; i++) {
+    scrambler_init_bits.at(i) = b_scrambler_init_bits.at(i);
+  }
 
-void Scrambler::ConvertBytesToBits(const int8_t* in_byte_buffer,
-                                   size_t byte_buffer_size,
-                                   int8_t* out_bit_buffer) {
-  for (size_t i = 0; i < byte_buffer_size; i++) {
-    for (size_t j = 0; j < 8; j++) {
-      out_bit_buffer[i * 8 + j] =
-          (in_byte_buffer[i] & (1 << (7 - j))) >> (7 - j);
+  // Generate one full period of the scrambling sequence using the
+  // generator polynomial s(x) = x7 + x4 + 1
+  std::array<int8_t, kScramblerlength> sequence;
+  for (size_t bit = 0; bit < static_cast<size_t>(kScramblerlength); bit++) {
+    //  x7 xor x4
+    const auto res_xor = static_cast<int8_t>(
+        (scrambler_init_bits.at(0) != 0) != (scrambler_init_bits.at(3) != 0));
+    sequence.at(bit) = res_xor;
+    //  Left-shift
+    for (size_t i = 0; i < 6; i++) {
+      scrambler_init_bits.at(i) = scrambler_init_bits.at(i + 1);
     }
+    //  Update x1
+    scrambler_init_bits.at(6) = res_xor;
   }
-}
 
-void Scrambler::ConvertBitsToBytes(const int8_t* in_bit_buffer,
-                                   size_t byte_buffer_size,
-                                   int8_t* out_byte_buffer) {
-  for (size_t i = 0; i < byte_buffer_size; i++) {
-    out_byte_buffer[i] = 0;
-    for (size_t j = 0; j < 8; j++) {
-      out_byte_buffer[i] <<= 1;
-      out_byte_buffer[i] += in_bit_buffer[i * 8 + j];
+  // Pack the periodic bit sequence into the byte-level keystream, MSB
+  // first to match the over-the-air bit order
+  for (size_t byte = 0; byte < keystream_.size(); byte++) {
+    uint8_t packed = 0;
+    for (size_t bit = 0; bit < 8; bit++) {
+      packed = static_cast<uint8_t>(
+          (packed << 1) |
+          sequence.at(((byte * 8) + bit) % static_cast<size_t>(kScramblerlength)));
     }
+    keystream_.at(byte) = packed;
+  }
+  for (size_t byte = 0; byte < keystream_ext_.size(); byte++) {
+    keystream_ext_.at(byte) =
+        keystream_.at(byte % static_cast<size_t>(kScramblerlength));
   }
 }
 
-void Scrambler::WlanScrambler(void* byte_buffer, size_t byte_buffer_size,
-                              std::vector<int8_t>& scram_buffer,
-                              std::vector<int8_t>& bit_buffer) {
-  auto* byte_buffer_ptr = reinterpret_cast<int8_t*>(byte_buffer);
-  std::array<int8_t, kBitsInitArraySize> b_scrambler_init_bits;
-  std::array<int8_t, kBitsInitArraySize> scrambler_init_bits;
-  int8_t tmp;
-  size_t j;
-  size_t buff_size;
-  int8_t res_xor;
-
-  // Make sure there is enough room in each of the vectors
-  // reserve will save the size of the largest call to prevent
-  // memory reallocation (high water mark) 0 init vectors
-  scram_buffer.reserve(kScramblerlength);
-  scram_buffer.resize(kScramblerlength);
-  std::fill(scram_buffer.begin(), scram_buffer.end(), 0);
-
-  size_t bit_bufffer_size = byte_buffer_size * 8;
-  bit_buffer.reserve(bit_bufffer_size);
-  bit_buffer.resize(bit_bufffer_size);
-  std::fill(bit_buffer.begin(), bit_buffer.end(), 0);
-
-  ConvertBytesToBits(&byte_buffer_ptr[0], byte_buffer_size, bit_buffer.data());
-
-  // Do scrambling
-  if (byte_buffer_size != 0) {
-    // Generate scrambler initial state array
-    for (int8_t& scrambler_init_bit : scrambler_init_bits) {
-      scrambler_init_bit = 0;
-    }
-    j = 1;
-    tmp = kScramblerInitState;
-    while ((j <= 7) && (tmp > 0)) {
-      scrambler_init_bits[j - 1] = tmp % 2;
-      tmp /= 2;
-      j++;
-    }
-
-    // Inverse the initial state array
-    for (size_t i = 0; i < 7; i++) {
-      b_scrambler_init_bits.at(i) = scrambler_init_bits.at(6 - i);
-    }
-    for (size_t i = 0; i < 7; i++) {
-      scrambler_init_bits.at(i) = b_scrambler_init_bits.at(i);
-    }
-
-    // Generate the scrambling sequence using the generator polynomial
-    buff_size = byte_buffer_size * 8;
-    if (buff_size > 127) {
-      buff_size = 127;
-    }
-    for (j = 0; j < buff_size; j++) {
-      //  x7 xor x4
-      res_xor = static_cast<int8_t>((scrambler_init_bits.at(0) != 0) !=
-                                    (scrambler_init_bits.at(3) != 0));
-      scram_buffer.at(j) = res_xor;
-      //  Left-shift
-      for (size_t i = 0; i < 6; i++) {
-        scrambler_init_bits.at(i) = scrambler_init_bits.at(i + 1);
-      }
-      //  Update x1
-      scrambler_init_bits.at(6) = res_xor;
+void Scrambler::Scramble(void* byte_buffer, size_t byte_buffer_size) {
+  auto* bytes = reinterpret_cast<uint8_t*>(byte_buffer);
+  const auto period = static_cast<size_t>(kScramblerlength);
+  size_t offset = 0;
+  size_t key_pos = 0;
+
+#ifdef __AVX2__
+  // XOR 32 payload bytes per step. The odd 127-byte period never lines up
+  // with the vector width, so the keystream is loaded from the padded copy
+  // at the current phase instead of restarting per period.
+  while ((offset + 32) <= byte_buffer_size) {
+    const __m256i data = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i*>(&bytes[offset]));
+    const __m256i key = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i*>(&keystream_ext_[key_pos]));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(&bytes[offset]),
+                        _mm256_xor_si256(data, key));
+    offset += 32;
+    key_pos += 32;
+    if (key_pos >= period) {
+      key_pos -= period;
     }
-
-    // Generate scrambled sequence by xor-ing input to the scrambling sequence
-    j = 0;
-    for (size_t i = 0; i < byte_buffer_size * 8; i++) {
-      if (j == buff_size) {
-        j = 1;
-      } else {
-        j++;
-      }
-
-      bit_buffer.at(i) = static_cast<signed char>(
-          (bit_buffer.at(i) != 0) != (scram_buffer.at(j - 1) != 0));
+  }
+#endif
+  for (; offset < byte_buffer_size; offset++) {
+    bytes[offset] ^= keystream_[key_pos];
+    key_pos++;
+    if (key_pos == period) {
+      key_pos = 0;
     }
   }
-  ConvertBitsToBytes(bit_buffer.data(), byte_buffer_size, &byte_buffer_ptr[0]);
-}
-
-void Scrambler::Scramble(void* byte_buffer, size_t byte_buffer_size) {
-  WlanScrambler(byte_buffer, byte_buffer_size, this->scram_buffer_,
-                this->bit_buffer_);
 }
 
 void Scrambler::Descramble(void* byte_buffer, size_t byte_buffer_size) {
-  WlanScrambler(byte_buffer, byte_buffer_size, this->scram_buffer_,
-                this->bit_buffer_);
+  // Scrambling is a frame-synchronous XOR and thus its own inverse
+  Scramble(byte_buffer, byte_buffer_size);
 }
 
-};  // namespace AgoraScrambler
\ No newline at end of file
+};  // namespace AgoraScrambler
@@ -12,6 +12,14 @@
 
 // We use one RxStatus object to track packet reception status.
 // This object is shared between socket threads and subcarrier workers.
+//
+// The packet counters are sharded per socket thread: every RX thread
+// increments only its own cacheline-aligned shard, and the pollers
+// (received_all_pilots / is_demod_ready) aggregate the shards lazily at
+// symbol boundaries. With shared counters every increment bounced the
+// counter cacheline between all RX threads and every poller; with shards
+// each counter line has a single writer and the polls read without
+// invalidating anyone.
 class RxStatus {
  public:
   RxStatus(Config* cfg)
@@ -20,10 +28,28 @@ class RxStatus {
         num_pilot_symbols_per_frame_(cfg->Frame().NumPilotSyms()),
         num_data_symbol_per_frame_(cfg->Frame().NumDataSyms()),
         num_pkts_per_symbol_(cfg->BsAntNum()),
-        num_decode_tasks_per_frame_(cfg->get_num_ues_to_process()) {}
-
-  // When receive a new packet, record it here
-  bool add_new_packet(const Packet* pkt) {
+        num_decode_tasks_per_frame_(cfg->get_num_ues_to_process()),
+        shards_(cfg->SocketThreadNum()) {}
+
+  // Per-RX-thread counter shard. Only the owning socket thread writes it,
+  // so its cachelines are never invalidated by other writers; pollers sum
+  // across shards. Relaxed ordering suffices: the counters carry no
+  // payload dependency (the packet data is published separately), the
+  // counts only gate when pollers may proceed.
+  struct alignas(64) CounterShard {
+    // Packets received for frame (i % kFrameWnd)
+    std::array<std::atomic<size_t>, kFrameWnd> num_pkts_ = {};
+
+    // Pilot packets received for frame (i % kFrameWnd)
+    std::array<std::atomic<size_t>, kFrameWnd> num_pilot_pkts_ = {};
+
+    // Data packets received for frame (i % kFrameWnd), symbol j
+    std::array<std::array<std::atomic<size_t>, kMaxSymbols>, kFrameWnd>
+        num_data_pkts_ = {};
+  };
+
+  // When receive a new packet, record it in the calling RX thread's shard
+  bool add_new_packet(const Packet* pkt, size_t rx_tid) {
     if (pkt->frame_id >= cur_frame_ + kFrameWnd) {
       MLPD_ERROR(
           "SharedCounters RxStatus error: Received packet for future "
@@ -35,25 +61,14 @@ class RxStatus {
     }
 
     const size_t frame_slot = pkt->frame_id % kFrameWnd;
-    num_pkts_[frame_slot]++;
-    if (num_pkts_[frame_slot] ==
-        num_pkts_per_symbol_ *
-            (num_pilot_symbols_per_frame_ + num_data_symbol_per_frame_)) {
-      std::printf(
-          "SharedCounters: received all packets in frame: %u. "
-          "Pilot pkts = %zu of %zu\n",
-          pkt->frame_id, num_pilot_pkts_[frame_slot].load(),
-          num_pilot_pkts_per_frame_);
-    }
-
+    CounterShard& shard = shards_.at(rx_tid);
+    shard.num_pkts_[frame_slot].fetch_add(1, std::memory_order_relaxed);
     if (pkt->symbol_id < num_pilot_symbols_per_frame_) {
-      num_pilot_pkts_[frame_slot]++;
-      if (num_pilot_pkts_[frame_slot] == num_pilot_pkts_per_frame_) {
-        std::printf("SharedCounters: received all pilots in frame: %u\n",
-                    pkt->frame_id);
-      }
+      shard.num_pilot_pkts_[frame_slot].fetch_add(1,
+                                                  std::memory_order_relaxed);
     } else {
-      num_data_pkts_[frame_slot][pkt->symbol_id]++;
+      shard.num_data_pkts_[frame_slot][pkt->symbol_id].fetch_add(
+          1, std::memory_order_relaxed);
     }
     if (pkt->frame_id > latest_frame_) {
       // TODO: race condition could happen here but the impact is small
@@ -68,7 +83,12 @@ class RxStatus {
     if (frame_id < cur_frame_ || frame_id >= cur_frame_ + kFrameWnd) {
       return false;
     }
-    return num_pilot_pkts_[frame_id % kFrameWnd] == num_pilot_pkts_per_frame_;
+    const size_t frame_slot = frame_id % kFrameWnd;
+    size_t sum = 0;
+    for (const CounterShard& shard : shards_) {
+      sum += shard.num_pilot_pkts_[frame_slot].load(std::memory_order_relaxed);
+    }
+    return sum == num_pilot_pkts_per_frame_;
   }
 
   // Check whether demodulation can proceed for a symbol in a frame
@@ -76,8 +96,13 @@ class RxStatus {
     if (frame_id < cur_frame_ || frame_id >= cur_frame_ + kFrameWnd) {
       return false;
     }
-    return num_data_pkts_[frame_id % kFrameWnd][symbol_id] ==
-           num_pkts_per_symbol_;
+    const size_t frame_slot = frame_id % kFrameWnd;
+    size_t sum = 0;
+    for (const CounterShard& shard : shards_) {
+      sum += shard.num_data_pkts_[frame_slot][symbol_id].load(
+          std::memory_order_relaxed);
+    }
+    return sum == num_pkts_per_symbol_;
   }
 
   // When decoding is done for a frame from one decoder, call this function
@@ -92,32 +117,18 @@ class RxStatus {
       cur_frame_++;
       num_decode_tasks_completed_ = 0;
       size_t frame_slot = frame_id % kFrameWnd;
-      num_pkts_[frame_slot] = 0;
-      num_pilot_pkts_[frame_slot] = 0;
-      for (size_t j = 0; j < kMaxSymbols; j++) {
-        num_data_pkts_[frame_slot][j] = 0;
+      for (CounterShard& shard : shards_) {
+        shard.num_pkts_[frame_slot] = 0;
+        shard.num_pilot_pkts_[frame_slot] = 0;
+        for (size_t j = 0; j < kMaxSymbols; j++) {
+          shard.num_data_pkts_[frame_slot][j] = 0;
+        }
       }
       std::printf("Main thread: Decode done frame: %lu\n", cur_frame_ - 1);
     }
     decode_mutex_.unlock();
   }
 
-  // TODO: Instead of having all-atomic counter arrays, can we just make
-  // the entire class atomic?
-
-  // num_pkts[i % kFrameWnd] is the total number of packets
-  // received for frame i (may be removed if not used)
-  std::array<std::atomic<size_t>, kFrameWnd> num_pkts_ = {};
-
-  // num_pilot_pkts[i % kFrameWnd] is the total number of pilot
-  // packets received for frame i
-  std::array<std::atomic<size_t>, kFrameWnd> num_pilot_pkts_ = {};
-
-  // num_data_pkts[i % kFrameWnd][j] is the total number of data
-  // packets received for frame i and symbol j
-  std::array<std::array<std::atomic<size_t>, kMaxSymbols>, kFrameWnd>
-      num_data_pkts_ = {};
-
   // cur_frame is the first frame for which decoding is incomplete
   size_t cur_frame_ = 0;
 
@@ -135,6 +146,9 @@ class RxStatus {
   const size_t num_data_symbol_per_frame_;
   const size_t num_pkts_per_symbol_;
   const size_t num_decode_tasks_per_frame_;
+
+  // One counter shard per socket (RX) thread
+  std::vector<CounterShard> shards_;
 };
 
 // We use DemulStatus to track # completed demul tasks for each symbol
@@ -180,14 +194,16 @@ class DemulStatus {
 
   // num_demul_tasks_completed[i % kFrameWnd][j] is
   // the number of subcarriers completed for demul tasks in
-  // frame i and symbol j
-  std::array<std::array<std::atomic<size_t>, kMaxSymbols>, kFrameWnd>
-      num_demul_tasks_completed_;
+  // frame i and symbol j. Aligned so the frequently-written counters do
+  // not share a cacheline with the mutex and config copies below
+  alignas(64)
+      std::array<std::array<std::atomic<size_t>, kMaxSymbols>, kFrameWnd>
+          num_demul_tasks_completed_;
 
   // Number of subcarriers required to demodulate for each symbol
   const size_t num_demul_tasks_required_;
 
-  size_t max_frame_;
+  alignas(64) size_t max_frame_;
   std::mutex max_frame_mutex_;
 };
 
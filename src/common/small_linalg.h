@@ -0,0 +1,176 @@
+/**
+ * @file small_linalg.h
+ * @brief Header-only complex linear-algebra kernels for the small fixed
+ * shapes on the doer hot paths (equalization GEMV, precoding GEMV, the ZF
+ * Gram product). Armadillo routes these through object construction,
+ * aliasing checks and BLAS dispatch per call; at 8x64 / 16x16 sizes that
+ * overhead dominates, so these kernels work directly on the interleaved
+ * complex buffers with AVX2/FMA. Doers pick a kernel once at construction
+ * (see SelectCgemv), keeping the shape dispatch off the per-subcarrier
+ * path; matrix inversion stays on Armadillo/LAPACK, where the established
+ * inv_sympd / pinv fallback semantics live.
+ */
+#ifndef SMALL_LINALG_H_
+#define SMALL_LINALG_H_
+
+#include <immintrin.h>
+
+#include <cstddef>
+
+#include "common_typedef_sdk.h"
+
+namespace small_linalg {
+
+/// y = A * x for a column-major m x k interleaved-complex matrix. Columns
+/// are contiguous, so the inner loads stream; each 4-complex row chunk
+/// keeps its accumulator in a register across the whole k loop. Also the
+/// runtime-shape fallback for SelectCgemv()
+inline void CgemvColMajor(size_t m, size_t k, const complex_float* a,
+                          const complex_float* x, complex_float* y) {
+  const auto* af = reinterpret_cast<const float*>(a);
+  const auto* xf = reinterpret_cast<const float*>(x);
+  auto* yf = reinterpret_cast<float*>(y);
+  const size_t m_vec = m & ~size_t{3};
+
+  for (size_t i = 0; i < m_vec; i += 4) {
+    __m256 acc = _mm256_setzero_ps();
+    for (size_t j = 0; j < k; j++) {
+      const __m256 col = _mm256_loadu_ps(&af[2 * ((j * m) + i)]);
+      const __m256 xr = _mm256_broadcast_ss(&xf[2 * j]);
+      const __m256 xi = _mm256_broadcast_ss(&xf[(2 * j) + 1]);
+      // (ar, ai) * (xr, xi): fmaddsub gives ar*xr - ai*xi in the even
+      // lanes and ai*xr + ar*xi in the odd ones
+      const __m256 col_swap = _mm256_permute_ps(col, 0xB1);
+      acc = _mm256_add_ps(
+          acc, _mm256_fmaddsub_ps(col, xr, _mm256_mul_ps(col_swap, xi)));
+    }
+    _mm256_storeu_ps(&yf[2 * i], acc);
+  }
+
+  for (size_t i = m_vec; i < m; i++) {
+    float re = 0.0f;
+    float im = 0.0f;
+    for (size_t j = 0; j < k; j++) {
+      const float ar = af[2 * ((j * m) + i)];
+      const float ai = af[(2 * ((j * m) + i)) + 1];
+      const float xr = xf[2 * j];
+      const float xi = xf[(2 * j) + 1];
+      re += (ar * xr) - (ai * xi);
+      im += (ar * xi) + (ai * xr);
+    }
+    yf[2 * i] = re;
+    yf[(2 * i) + 1] = im;
+  }
+}
+
+/// C = A^H * A for a column-major m x n interleaved-complex matrix
+/// (the ZF Gram product). Only the upper triangle is computed; the lower
+/// is mirrored by conjugation and the diagonal imaginary parts are zeroed
+/// so the result is exactly Hermitian for the Cholesky-based inverse
+inline void GramHermitian(size_t m, size_t n, const complex_float* a,
+                          complex_float* c) {
+  const auto* af = reinterpret_cast<const float*>(a);
+  auto* cf = reinterpret_cast<float*>(c);
+  const size_t m_vec = m & ~size_t{3};
+
+  for (size_t j2 = 0; j2 < n; j2++) {
+    for (size_t j1 = 0; j1 <= j2; j1++) {
+      const float* p = &af[2 * j1 * m];
+      const float* q = &af[2 * j2 * m];
+      // conj(p) * q: lanewise p*q accumulates re = pr*qr + pi*qi across
+      // each lane pair; swap(p)*q accumulates (pi*qr, pr*qi), whose
+      // odd-minus-even differences give im = pr*qi - pi*qr
+      __m256 acc_a = _mm256_setzero_ps();
+      __m256 acc_b = _mm256_setzero_ps();
+      for (size_t i = 0; i < m_vec; i += 4) {
+        const __m256 pv = _mm256_loadu_ps(&p[2 * i]);
+        const __m256 qv = _mm256_loadu_ps(&q[2 * i]);
+        acc_a = _mm256_fmadd_ps(pv, qv, acc_a);
+        acc_b = _mm256_fmadd_ps(_mm256_permute_ps(pv, 0xB1), qv, acc_b);
+      }
+      alignas(32) float ta[8];
+      alignas(32) float tb[8];
+      _mm256_store_ps(ta, acc_a);
+      _mm256_store_ps(tb, acc_b);
+      float re = ta[0] + ta[1] + ta[2] + ta[3] + ta[4] + ta[5] + ta[6] + ta[7];
+      float im = (tb[1] - tb[0]) + (tb[3] - tb[2]) + (tb[5] - tb[4]) +
+                 (tb[7] - tb[6]);
+      for (size_t i = m_vec; i < m; i++) {
+        const float pr = p[2 * i];
+        const float pi = p[(2 * i) + 1];
+        const float qr = q[2 * i];
+        const float qi = q[(2 * i) + 1];
+        re += (pr * qr) + (pi * qi);
+        im += (pr * qi) - (pi * qr);
+      }
+      if (j1 == j2) {
+        im = 0.0f;
+      }
+      cf[2 * ((j2 * n) + j1)] = re;
+      cf[(2 * ((j2 * n) + j1)) + 1] = im;
+      if (j1 != j2) {
+        cf[2 * ((j1 * n) + j2)] = re;
+        cf[(2 * ((j1 * n) + j2)) + 1] = -im;
+      }
+    }
+  }
+}
+
+/// GEMV kernel signature shared by the fixed-shape instantiations and the
+/// runtime-shape fallback; fixed-shape kernels ignore the leading m, k
+using CgemvFn = void (*)(size_t m, size_t k, const complex_float* a,
+                         const complex_float* x, complex_float* y);
+
+namespace detail {
+/// Fixed-shape front end: with kM and kK compile-time the shape checks,
+/// trip counts and tail handling all fold away
+template <size_t kM, size_t kK>
+void CgemvFixedShape(size_t /*m*/, size_t /*k*/, const complex_float* a,
+                     const complex_float* x, complex_float* y) {
+  CgemvColMajor(kM, kK, a, x, y);
+}
+
+template <size_t kM>
+CgemvFn SelectCgemvK(size_t k) {
+  switch (k) {
+    case 8:
+      return &CgemvFixedShape<kM, 8>;
+    case 16:
+      return &CgemvFixedShape<kM, 16>;
+    case 32:
+      return &CgemvFixedShape<kM, 32>;
+    case 64:
+      return &CgemvFixedShape<kM, 64>;
+    default:
+      return &CgemvColMajor;
+  }
+}
+}  // namespace detail
+
+/// Pick the GEMV kernel for an m x k multiply once, at doer construction.
+/// The shapes Agora actually runs (antenna and UE counts are powers of two
+/// in every deployed config) get fully-unrolled instantiations; anything
+/// else falls back to the runtime-shape kernel, which is still branch-free
+/// per column
+inline CgemvFn SelectCgemv(size_t m, size_t k) {
+  switch (m) {
+    case 2:
+      return detail::SelectCgemvK<2>(k);
+    case 4:
+      return detail::SelectCgemvK<4>(k);
+    case 8:
+      return detail::SelectCgemvK<8>(k);
+    case 16:
+      return detail::SelectCgemvK<16>(k);
+    case 32:
+      return detail::SelectCgemvK<32>(k);
+    case 64:
+      return detail::SelectCgemvK<64>(k);
+    default:
+      return &CgemvColMajor;
+  }
+}
+
+}  // namespace small_linalg
+
+#endif  // SMALL_LINALG_H_
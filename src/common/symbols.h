@@ -13,8 +13,10 @@
 #define STRINGIFY(x) #x
 #define TOSTRING(x) STRINGIFY(x)
 
-// Number of frames received that we allocate space for in worker threads. This
-// is the frame window that we track in Agora.
+// Compile-time capacity of the frame window: fixed-size arrays and pointer
+// grids are dimensioned with it. The window actually used at runtime is
+// Config::FrameWnd() (the "frame_wnd" json value, <= kFrameWnd); the big
+// per-frame buffers are allocated and wrapped with that value.
 static constexpr size_t kFrameWnd = 40;
 
 #define TX_FRAME_DELTA 8
@@ -56,7 +58,8 @@ enum class EventType : int {
   kFFTPilot,
   kSNRReport,   // Signal new SNR measurement from PHY to MAC
   kRANUpdate,   // Signal new RAN config to Agora
-  kRBIndicator  // Signal RB schedule to UEs
+  kRBIndicator,  // Signal RB schedule to UEs
+  kLlrShard      // Signal remote shard LLRs merged for an uplink symbol
 };
 static constexpr size_t kNumEventTypes =
     static_cast<size_t>(EventType::kPacketToMac) + 1;
@@ -162,6 +165,10 @@ static constexpr bool kDebugPrintInTask = false;
 static constexpr bool kDebugMulticell = false;
 static constexpr bool kRecordCalibrationMats = false;
 
+/// Validate in every doer task that the frame still owns its frame-window
+/// slot, catching buffer reuse after a window overrun
+static constexpr bool kDebugFrameSlotOwnership = false;
+
 /// Print the I/Q samples in the pilots
 static constexpr bool kDebugPrintPilot = false;
 
@@ -294,6 +301,10 @@ static constexpr size_t kMacBaseLocalPort = 8180;
 // TODO: need to generalize for hostname, port pairs for each client
 static constexpr size_t kMacBaseClientPort = 7070;
 
+// Length prefix on each aggregated app PDU inside a MAC packet payload
+// (see the mac_pdu_aggregation config flag)
+static constexpr size_t kMacPduSubHeaderBytes = sizeof(uint16_t);
+
 // Number of subcarriers in a partial transpose block
 static constexpr size_t kTransposeBlockSize = 8;
 static_assert(IsPowerOfTwo(kTransposeBlockSize));  // For cheap modulo
@@ -308,6 +319,14 @@ static constexpr bool kUseAVX2Encoder = true;
 static constexpr bool kUseAVX2Encoder = false;
 #endif
 
+// If true, workers return completion events to the master over per-worker
+// SPSC rings instead of the shared MPMC completion queue
+#ifdef USE_SPSC_COMPLETION
+static constexpr bool kUseSpscCompletion = true;
+#else
+static constexpr bool kUseSpscCompletion = false;
+#endif
+
 // Enable debugging for sender and receiver applications
 static constexpr bool kDebugSenderReceiver = false;
 #endif  // SYMBOLS_H_
@@ -0,0 +1,300 @@
+/**
+ * @file trace_ring.cc
+ * @brief Implementation of the per-thread binary trace rings
+ */
+#include "trace_ring.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "logger.h"
+#include "symbols.h"
+
+/// How often the background thread sweeps the rings
+static constexpr size_t kTraceDrainIntervalMs = 10;
+
+TraceLog& TraceLog::Instance() {
+  static TraceLog instance;
+  return instance;
+}
+
+void TraceLog::Start(const std::string& trace_file, double freq_ghz) {
+  if (this->running_.load() == true) {
+    return;
+  }
+  this->out_file_ = std::fopen(trace_file.c_str(), "wb");
+  if (this->out_file_ == nullptr) {
+    MLPD_ERROR("TraceLog: failed to open trace file %s, tracing disabled\n",
+               trace_file.c_str());
+    return;
+  }
+  TraceFileHeader header;
+  header.magic_ = kTraceFileMagic;
+  header.record_size_ = sizeof(TraceRecord);
+  header.freq_ghz_ = freq_ghz;
+  std::fwrite(&header, sizeof(header), 1, this->out_file_);
+
+  this->running_.store(true);
+  this->drain_thread_ = std::thread(&TraceLog::DrainLoop, this);
+  MLPD_INFO("TraceLog: tracing to %s (%zu-byte records, %zu per ring)\n",
+            trace_file.c_str(), sizeof(TraceRecord),
+            TraceRing::kRecordsPerRing);
+}
+
+void TraceLog::Stop() {
+  if (this->running_.load() == false) {
+    return;
+  }
+  this->running_.store(false);
+  this->drain_thread_.join();
+
+  // Final sweep for records emitted before running_ went false
+  size_t total_dropped = 0;
+  const size_t num_rings = this->num_rings_.load(std::memory_order_acquire);
+  for (size_t ring_id = 0; ring_id < num_rings; ring_id++) {
+    this->DrainRing(ring_id);
+    total_dropped += this->rings_.at(ring_id)->dropped_;
+  }
+  std::fclose(this->out_file_);
+  this->out_file_ = nullptr;
+  if (total_dropped > 0) {
+    MLPD_WARN("TraceLog: drain thread fell behind, %zu records dropped\n",
+              total_dropped);
+  }
+  // The rings stay allocated: worker threads cache their ring pointer in
+  // a thread_local, which must not dangle if tracing restarts
+}
+
+TraceRing* TraceLog::RegisterThread() {
+  std::scoped_lock lock(this->reg_mutex_);
+  this->rings_.push_back(std::make_unique<TraceRing>());
+  TraceRing* ring = this->rings_.back().get();
+  // Publish the count last so the drain thread never sees a ring slot
+  // before its unique_ptr is in place
+  this->num_rings_.store(this->rings_.size(), std::memory_order_release);
+  return ring;
+}
+
+void TraceLog::DrainLoop() {
+  while (this->running_.load() == true) {
+    std::this_thread::sleep_for(
+        std::chrono::milliseconds(kTraceDrainIntervalMs));
+    const size_t num_rings = this->num_rings_.load(std::memory_order_acquire);
+    for (size_t ring_id = 0; ring_id < num_rings; ring_id++) {
+      this->DrainRing(ring_id);
+    }
+    std::fflush(this->out_file_);
+  }
+}
+
+void TraceLog::DrainRing(size_t ring_id) {
+  TraceRing* ring = this->rings_.at(ring_id).get();
+  const uint64_t write_idx =
+      ring->write_idx_.load(std::memory_order_acquire);
+  if (write_idx == ring->read_idx_) {
+    return;
+  }
+  if ((write_idx - ring->read_idx_) > TraceRing::kRecordsPerRing) {
+    // The producer lapped us; skip to the oldest record still present.
+    // A record overwritten mid-copy can come out torn, which a decoder
+    // tolerates better than a stalled producer would
+    ring->dropped_ +=
+        (write_idx - ring->read_idx_) - TraceRing::kRecordsPerRing;
+    ring->read_idx_ = write_idx - TraceRing::kRecordsPerRing;
+  }
+
+  TraceChunkHeader chunk;
+  chunk.ring_id_ = static_cast<uint32_t>(ring_id);
+  chunk.count_ = static_cast<uint32_t>(write_idx - ring->read_idx_);
+  std::fwrite(&chunk, sizeof(chunk), 1, this->out_file_);
+
+  // At most two contiguous segments of the circular buffer
+  while (ring->read_idx_ < write_idx) {
+    const size_t slot = ring->read_idx_ & (TraceRing::kRecordsPerRing - 1);
+    const size_t seg = std::min(write_idx - ring->read_idx_,
+                                TraceRing::kRecordsPerRing - slot);
+    std::fwrite(&ring->records_[slot], sizeof(TraceRecord), seg,
+                this->out_file_);
+    ring->read_idx_ += seg;
+  }
+}
+
+/// Span/instant names for the EventType carried in a task span record
+static const char* TraceEventTypeName(uint16_t low_byte) {
+  switch (static_cast<EventType>(low_byte)) {
+    case EventType::kPacketRX:
+      return "PacketRX";
+    case EventType::kFFT:
+      return "FFT";
+    case EventType::kZF:
+      return "ZF";
+    case EventType::kDemul:
+      return "Demul";
+    case EventType::kIFFT:
+      return "IFFT";
+    case EventType::kPrecode:
+      return "Precode";
+    case EventType::kPacketTX:
+      return "PacketTX";
+    case EventType::kPacketPilotTX:
+      return "PacketPilotTX";
+    case EventType::kDecode:
+      return "Decode";
+    case EventType::kEncode:
+      return "Encode";
+    case EventType::kModul:
+      return "Modul";
+    case EventType::kPacketFromMac:
+      return "PacketFromMac";
+    case EventType::kPacketToMac:
+      return "PacketToMac";
+    case EventType::kFFTPilot:
+      return "FFTPilot";
+    default:
+      return "Event";
+  }
+}
+
+/// Names for the PrintType carried in the master milestone records
+static const char* TracePrintTypeName(uint16_t low_byte) {
+  switch (static_cast<PrintType>(low_byte)) {
+    case PrintType::kPacketRXPilots:
+      return "PacketRXPilots";
+    case PrintType::kPacketRX:
+      return "PacketRX";
+    case PrintType::kFFTPilots:
+      return "FFTPilots";
+    case PrintType::kFFTData:
+      return "FFTData";
+    case PrintType::kFFTCal:
+      return "FFTCal";
+    case PrintType::kZF:
+      return "ZF";
+    case PrintType::kDemul:
+      return "Demul";
+    case PrintType::kIFFT:
+      return "IFFT";
+    case PrintType::kPrecode:
+      return "Precode";
+    case PrintType::kPacketTXFirst:
+      return "PacketTXFirst";
+    case PrintType::kPacketTX:
+      return "PacketTX";
+    case PrintType::kDecode:
+      return "Decode";
+    case PrintType::kEncode:
+      return "Encode";
+    case PrintType::kRC:
+      return "RC";
+    case PrintType::kPacketFromMac:
+      return "PacketFromMac";
+    case PrintType::kPacketToMac:
+      return "PacketToMac";
+    case PrintType::kModul:
+      return "Modul";
+    default:
+      return "Milestone";
+  }
+}
+
+bool TraceLog::ExportChromeTrace(const std::string& bin_file,
+                                 const std::string& json_file) {
+  std::FILE* in = std::fopen(bin_file.c_str(), "rb");
+  if (in == nullptr) {
+    MLPD_ERROR("TraceLog: cannot open %s for export\n", bin_file.c_str());
+    return false;
+  }
+  TraceFileHeader header;
+  if ((std::fread(&header, sizeof(header), 1, in) != 1) ||
+      (header.magic_ != kTraceFileMagic) ||
+      (header.record_size_ != sizeof(TraceRecord))) {
+    MLPD_ERROR("TraceLog: %s is not a trace file\n", bin_file.c_str());
+    std::fclose(in);
+    return false;
+  }
+
+  // Pass 1: earliest timestamp across all rings, so the JSON timeline
+  // starts at zero (chunks are interleaved in drain order, not tsc order)
+  uint64_t base_tsc = UINT64_MAX;
+  TraceChunkHeader chunk;
+  while (std::fread(&chunk, sizeof(chunk), 1, in) == 1) {
+    for (uint32_t i = 0; i < chunk.count_; i++) {
+      TraceRecord rec;
+      if (std::fread(&rec, sizeof(rec), 1, in) != 1) {
+        break;
+      }
+      if (rec.tsc_ < base_tsc) {
+        base_tsc = rec.tsc_;
+      }
+    }
+  }
+  std::rewind(in);
+  std::fread(&header, sizeof(header), 1, in);
+
+  std::FILE* out = std::fopen(json_file.c_str(), "w");
+  if (out == nullptr) {
+    MLPD_ERROR("TraceLog: cannot open %s for export\n", json_file.c_str());
+    std::fclose(in);
+    return false;
+  }
+  std::fprintf(out, "{\"traceEvents\":[\n");
+  size_t num_events = 0;
+  while (std::fread(&chunk, sizeof(chunk), 1, in) == 1) {
+    for (uint32_t i = 0; i < chunk.count_; i++) {
+      TraceRecord rec;
+      if (std::fread(&rec, sizeof(rec), 1, in) != 1) {
+        break;
+      }
+      const double ts_us =
+          GetTime::CyclesToUs(rec.tsc_ - base_tsc, header.freq_ghz_);
+      const uint16_t kind = rec.event_ & 0xFF00u;
+      const uint16_t low = rec.event_ & 0x00FFu;
+      if (num_events > 0) {
+        std::fprintf(out, ",\n");
+      }
+      num_events++;
+      if (kind == kTraceTaskBegin) {
+        std::fprintf(out,
+                     "{\"name\":\"%s\",\"ph\":\"B\",\"pid\":0,\"tid\":%u,"
+                     "\"ts\":%.3f,\"args\":{\"frame\":%u,\"symbol\":%u}}",
+                     TraceEventTypeName(low), chunk.ring_id_, ts_us, rec.tag_,
+                     rec.arg_);
+      } else if (kind == kTraceTaskEnd) {
+        std::fprintf(out,
+                     "{\"name\":\"%s\",\"ph\":\"E\",\"pid\":0,\"tid\":%u,"
+                     "\"ts\":%.3f}",
+                     TraceEventTypeName(low), chunk.ring_id_, ts_us);
+      } else {
+        const char* name;
+        const char* prefix;
+        if (rec.event_ == kTraceFrameStart) {
+          prefix = "Frame";
+          name = "Start";
+        } else if (rec.event_ == kTraceFrameDone) {
+          prefix = "Frame";
+          name = "Done";
+        } else if (kind == kTracePerFrameDone) {
+          prefix = "FrameDone ";
+          name = TracePrintTypeName(low);
+        } else if (kind == kTracePerSymbolDone) {
+          prefix = "SymbolDone ";
+          name = TracePrintTypeName(low);
+        } else {
+          prefix = "TaskDone ";
+          name = TracePrintTypeName(low);
+        }
+        std::fprintf(out,
+                     "{\"name\":\"%s%s\",\"ph\":\"i\",\"s\":\"t\",\"pid\":0,"
+                     "\"tid\":%u,\"ts\":%.3f,"
+                     "\"args\":{\"frame\":%u,\"arg\":%u}}",
+                     prefix, name, chunk.ring_id_, ts_us, rec.tag_, rec.arg_);
+      }
+    }
+  }
+  std::fprintf(out, "\n]}\n");
+  std::fclose(out);
+  std::fclose(in);
+  MLPD_INFO("TraceLog: exported %zu events to %s\n", num_events,
+            json_file.c_str());
+  return true;
+}
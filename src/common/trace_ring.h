@@ -0,0 +1,152 @@
+/**
+ * @file trace_ring.h
+ * @brief Lock-free per-thread binary trace rings drained to a file.
+ *
+ * The per-frame / per-task printf paths in agora.cc are too expensive to
+ * leave on in production, so deadline misses must be reproduced before
+ * they can be examined. These rings record the same milestones as
+ * fixed-size binary records (rdtsc, event, tag) at a cost of a few tens
+ * of cycles per event, cheap enough to stay enabled always. A background
+ * thread drains the rings to a file, so the timeline is available after
+ * the fact.
+ *
+ * File layout: one TraceFileHeader, then a stream of chunks, each a
+ * TraceChunkHeader followed by TraceRecords from a single thread's ring.
+ * Timestamps are raw rdtsc values; the header carries the measured TSC
+ * frequency for conversion (see GetTime::CyclesToUs).
+ */
+#ifndef TRACE_RING_H_
+#define TRACE_RING_H_
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gettime.h"
+
+/// One fixed-size trace record
+struct TraceRecord {
+  uint64_t tsc_;    /// GetTime::Rdtsc() at emit time
+  uint16_t event_;  /// Event identifier (see TraceEventKind)
+  uint16_t arg_;    /// Event-specific: symbol id, or subcarrier/antenna id
+  uint32_t tag_;    /// Usually the frame id
+};
+static_assert(sizeof(TraceRecord) == 16, "TraceRecord must stay 16 bytes");
+
+/// Event identifiers. The done-kind events carry the PrintType value in
+/// the low byte so a decoded trace follows the same taxonomy as the
+/// printf paths it replaces
+enum TraceEventKind : uint16_t {
+  kTraceFrameStart = 0x0001,     /// tag = frame id
+  kTraceFrameDone = 0x0002,      /// tag = frame id
+  kTracePerFrameDone = 0x0100,   /// | PrintType, tag = frame id
+  kTracePerSymbolDone = 0x0200,  /// | PrintType, arg = symbol, tag = frame
+  kTracePerTaskDone = 0x0300,    /// | PrintType, arg = sc/ant, tag = frame
+  kTraceTaskBegin = 0x0400,      /// | EventType, arg = symbol, tag = frame
+  kTraceTaskEnd = 0x0500,        /// | EventType, arg = symbol, tag = frame
+};
+
+struct TraceFileHeader {
+  uint32_t magic_;        /// kTraceFileMagic
+  uint32_t record_size_;  /// sizeof(TraceRecord)
+  double freq_ghz_;       /// TSC frequency for timestamp conversion
+};
+
+struct TraceChunkHeader {
+  uint32_t ring_id_;  /// Index of the emitting thread's ring
+  uint32_t count_;    /// Number of TraceRecords that follow
+};
+
+static constexpr uint32_t kTraceFileMagic = 0x41545243;  // "ATRC"
+
+/// Single-producer ring written by one thread and drained by the trace
+/// log's background thread. The producer never blocks: when the drain
+/// thread falls behind, the oldest records are overwritten and counted
+/// as dropped
+class TraceRing {
+ public:
+  /// 64Ki records = 1 MiB per thread; must be a power of two
+  static constexpr size_t kRecordsPerRing = 1 << 16;
+
+  inline void Emit(uint16_t event, uint16_t arg, uint32_t tag) {
+    const uint64_t idx = this->write_idx_.load(std::memory_order_relaxed);
+    TraceRecord& rec = this->records_[idx & (kRecordsPerRing - 1)];
+    rec.tsc_ = GetTime::Rdtsc();
+    rec.event_ = event;
+    rec.arg_ = arg;
+    rec.tag_ = tag;
+    // Publish after the record body; the drain thread acquires write_idx_
+    this->write_idx_.store(idx + 1, std::memory_order_release);
+  }
+
+ private:
+  friend class TraceLog;
+  std::array<TraceRecord, kRecordsPerRing> records_;
+  alignas(64) std::atomic<uint64_t> write_idx_{0};
+  /// Drain thread only
+  uint64_t read_idx_{0};
+  /// Drain thread only: records lost to ring laps
+  uint64_t dropped_{0};
+};
+
+/// Process-wide registry of per-thread rings plus the drain thread.
+/// Emit() is a cheap no-op until Start() runs; rings registered by
+/// worker threads persist for the process lifetime so thread-local
+/// pointers never dangle
+class TraceLog {
+ public:
+  static TraceLog& Instance();
+
+  /// Open trace_file and start the background drain thread. freq_ghz is
+  /// the measured TSC frequency recorded in the file header
+  void Start(const std::string& trace_file, double freq_ghz);
+
+  /// Final drain, join the drain thread and close the file
+  void Stop();
+
+  /// Convert a binary trace written by this log into a
+  /// chrome://tracing / Perfetto JSON timeline: kTraceTaskBegin/End pairs
+  /// become duration spans on their worker's track, everything else an
+  /// instant event. Offline path, call after Stop(). Spans whose end
+  /// record was lost to a ring lap show as unterminated, which the
+  /// viewers tolerate
+  static bool ExportChromeTrace(const std::string& bin_file,
+                                const std::string& json_file);
+
+  /// Record one event from the calling thread's ring
+  static inline void Emit(uint16_t event, uint16_t arg, uint32_t tag) {
+    TraceLog& log = Instance();
+    if (log.running_.load(std::memory_order_relaxed) == false) {
+      return;
+    }
+    thread_local TraceRing* ring = nullptr;
+    if (ring == nullptr) {
+      ring = log.RegisterThread();
+    }
+    ring->Emit(event, arg, tag);
+  }
+
+ private:
+  TraceLog() = default;
+  TraceRing* RegisterThread();
+  void DrainLoop();
+  /// Copy everything published in rings_[ring_id] since the last drain
+  void DrainRing(size_t ring_id);
+
+  /// Guards ring registration only; the hot Emit path takes no lock
+  std::mutex reg_mutex_;
+  std::vector<std::unique_ptr<TraceRing>> rings_;
+  std::atomic<size_t> num_rings_{0};
+  std::atomic<bool> running_{false};
+  std::thread drain_thread_;
+  std::FILE* out_file_{nullptr};
+};
+
+#endif  // TRACE_RING_H_
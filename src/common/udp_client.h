@@ -18,6 +18,7 @@
 #include <sys/socket.h>
 #include <unistd.h>
 
+#include <cassert>
 #include <cstring> /* std::strerror, std::memset, std::memcpy */
 #include <map>
 #include <mutex>
@@ -58,6 +59,52 @@ class UDPClient {
     }
   }
 
+  /**
+   * @brief Pin this socket to one remote endpoint with connect(). After
+   * this the connected Send() overload applies: a bare send() with no
+   * per-call hostname cache lookup and no kernel-side route and address
+   * validation per datagram. Use for sockets that talk to a single fixed
+   * destination for their whole lifetime.
+   *
+   * @param rem_hostname Hostname or IP address of the remote server
+   * @param rem_port UDP port that the remote server is listening on
+   */
+  void Connect(const std::string& rem_hostname, uint16_t rem_port) {
+    struct addrinfo* rem_addrinfo = ResolveRemote(rem_hostname, rem_port);
+    int ret =
+        connect(sock_fd_, rem_addrinfo->ai_addr, rem_addrinfo->ai_addrlen);
+    if (ret != 0) {
+      throw std::runtime_error(
+          "UDPClient: Failed to connect to " + rem_hostname + ":" +
+          std::to_string(rem_port) +
+          ". errno = " + std::string(std::strerror(errno)));
+    }
+    connected_ = true;
+  }
+
+  /// True after a successful Connect()
+  bool Connected() const { return connected_; }
+
+  /**
+   * @brief Send one UDP packet to the endpoint pinned by Connect()
+   *
+   * @param msg Pointer to the message to send
+   * @param len Length in bytes of the message to send
+   */
+  void Send(const uint8_t* msg, size_t len) {
+    assert(connected_ == true);
+    ssize_t ret = send(sock_fd_, msg, len, 0);
+    if (ret != static_cast<ssize_t>(len)) {
+      throw std::runtime_error("send() failed. errno = " +
+                               std::string(std::strerror(errno)));
+    }
+
+    if (enable_recording_flag_) {
+      std::scoped_lock map_access(map_insert_access_);
+      sent_vec_.emplace_back(msg, msg + len);
+    }
+  }
+
   /**
    * @brief Send one UDP packet to a remote server. The client caches the
    * the remote server's addrinfo after resolving it for the first time. After
@@ -71,66 +118,228 @@ class UDPClient {
    */
   void Send(const std::string& rem_hostname, uint16_t rem_port,
             const uint8_t* msg, size_t len) {
-    std::string remote_uri = rem_hostname + ":" + std::to_string(rem_port);
-    struct addrinfo* rem_addrinfo = nullptr;
+    if (kDebugPrintUdpClientSend) {
+      std::printf("UDPClient sending message to %s to port %d\n",
+                  rem_hostname.c_str(), rem_port);
+    }
+
+    struct addrinfo* rem_addrinfo = ResolveRemote(rem_hostname, rem_port);
 
+    ssize_t ret = sendto(sock_fd_, msg, len, 0, rem_addrinfo->ai_addr,
+                         rem_addrinfo->ai_addrlen);
+    if (ret != static_cast<ssize_t>(len)) {
+      throw std::runtime_error("sendto() failed. errno = " +
+                               std::string(std::strerror(errno)));
+    }
+
+    if (enable_recording_flag_) {
+      std::scoped_lock map_access(map_insert_access_);
+      sent_vec_.emplace_back(msg, msg + len);
+    }
+  }
+
+  /**
+   * @brief Scatter-gather variant of Send(): the wire packet is
+   * [hdr | payload], gathered by the kernel so the header and payload
+   * need not be contiguous in memory.
+   *
+   * @param rem_hostname Hostname or IP address of the remote server
+   * @param rem_port UDP port that the remote server is listening on
+   * @param hdr Pointer to the packet header
+   * @param hdr_len Length in bytes of the header
+   * @param payload Pointer to the packet payload
+   * @param payload_len Length in bytes of the payload
+   */
+  void Send(const std::string& rem_hostname, uint16_t rem_port,
+            const uint8_t* hdr, size_t hdr_len, const uint8_t* payload,
+            size_t payload_len) {
     if (kDebugPrintUdpClientSend) {
       std::printf("UDPClient sending message to %s to port %d\n",
                   rem_hostname.c_str(), rem_port);
     }
 
-    const auto remote_itr = addrinfo_map_.find(remote_uri);
-    if (remote_itr == addrinfo_map_.end()) {
-      char port_str[16u];
-      snprintf(port_str, sizeof(port_str), "%u", rem_port);
-
-      struct addrinfo hints;  // maybe important
-      std::memset(&hints, 0, sizeof(hints));
-      hints.ai_family = AF_INET6;  //possible change, added a 6
-      hints.ai_socktype = SOCK_DGRAM;
-      hints.ai_protocol = IPPROTO_UDP;
-
-      int r =
-          getaddrinfo(rem_hostname.c_str(), port_str, &hints, &rem_addrinfo);
-      if ((r != 0) || (rem_addrinfo == nullptr)) {
-        char issue_msg[1000u];
-        sprintf(issue_msg, "Failed to resolve %s. getaddrinfo error = %s.",
-                remote_uri.c_str(), gai_strerror(r));
-        throw std::runtime_error(issue_msg);
-      }
+    struct addrinfo* rem_addrinfo = ResolveRemote(rem_hostname, rem_port);
+
+    struct iovec iovs[2];
+    iovs[0].iov_base = const_cast<uint8_t*>(hdr);
+    iovs[0].iov_len = hdr_len;
+    iovs[1].iov_base = const_cast<uint8_t*>(payload);
+    iovs[1].iov_len = payload_len;
+    struct msghdr msg;
+    std::memset(&msg, 0, sizeof(msg));
+    msg.msg_name = rem_addrinfo->ai_addr;
+    msg.msg_namelen = rem_addrinfo->ai_addrlen;
+    msg.msg_iov = iovs;
+    msg.msg_iovlen = 2;
+
+    ssize_t ret = sendmsg(sock_fd_, &msg, 0);
+    if (ret != static_cast<ssize_t>(hdr_len + payload_len)) {
+      throw std::runtime_error("sendmsg() failed. errno = " +
+                               std::string(std::strerror(errno)));
+    }
+
+    if (enable_recording_flag_) {
+      std::scoped_lock map_access(map_insert_access_);
+      std::vector<uint8_t> packet(hdr, hdr + hdr_len);
+      packet.insert(packet.end(), payload, payload + payload_len);
+      sent_vec_.push_back(std::move(packet));
+    }
+  }
 
-      if (kDebugPrintUdpClientInit) {
-        std::printf("%d Resolving: %s map size %zu\n", sock_fd_,
-                    remote_uri.c_str(), addrinfo_map_.size());
+  /// Largest number of segments SendGather() accepts in one call
+  static constexpr size_t kMaxGatherSegs = 64;
+
+  /**
+   * @brief Gather variant of Send(): one wire packet assembled by the
+   * kernel from [num_segs] non-contiguous segments, so payloads can go
+   * out straight from the compute buffers without a staging copy.
+   *
+   * @param rem_hostname Hostname or IP address of the remote server
+   * @param rem_port UDP port that the remote server is listening on
+   * @param segs One pointer per segment, in wire order
+   * @param seg_lens Length in bytes of each segment
+   * @param num_segs Number of segments, at most kMaxGatherSegs
+   */
+  void SendGather(const std::string& rem_hostname, uint16_t rem_port,
+                  const uint8_t* const* segs, const size_t* seg_lens,
+                  size_t num_segs) {
+    assert(num_segs <= kMaxGatherSegs);
+    if (kDebugPrintUdpClientSend) {
+      std::printf("UDPClient sending message to %s to port %d\n",
+                  rem_hostname.c_str(), rem_port);
+    }
+
+    struct addrinfo* rem_addrinfo = ResolveRemote(rem_hostname, rem_port);
+
+    struct iovec iovs[kMaxGatherSegs];
+    size_t total_len = 0;
+    for (size_t i = 0; i < num_segs; i++) {
+      iovs[i].iov_base = const_cast<uint8_t*>(segs[i]);
+      iovs[i].iov_len = seg_lens[i];
+      total_len += seg_lens[i];
+    }
+    struct msghdr msg;
+    std::memset(&msg, 0, sizeof(msg));
+    msg.msg_name = rem_addrinfo->ai_addr;
+    msg.msg_namelen = rem_addrinfo->ai_addrlen;
+    msg.msg_iov = iovs;
+    msg.msg_iovlen = num_segs;
+
+    ssize_t ret = sendmsg(sock_fd_, &msg, 0);
+    if (ret != static_cast<ssize_t>(total_len)) {
+      throw std::runtime_error("sendmsg() failed. errno = " +
+                               std::string(std::strerror(errno)));
+    }
+
+    if (enable_recording_flag_) {
+      std::scoped_lock map_access(map_insert_access_);
+      std::vector<uint8_t> packet;
+      packet.reserve(total_len);
+      for (size_t i = 0; i < num_segs; i++) {
+        packet.insert(packet.end(), segs[i], segs[i] + seg_lens[i]);
       }
+      sent_vec_.push_back(std::move(packet));
+    }
+  }
 
-      std::pair<std::map<std::string, struct addrinfo*>::iterator, bool>
-          map_insert_result;
+  /// Largest burst SendBatch() accepts in one call
+  static constexpr size_t kMaxSendBurst = 32;
 
-      {  // Synchronize access to insert for thread safety
-        std::scoped_lock map_access(map_insert_access_);
-        map_insert_result = addrinfo_map_.insert(
-            std::pair<std::string, struct addrinfo*>(remote_uri, rem_addrinfo));
+  /**
+   * @brief Send up to kMaxSendBurst UDP packets with a single sendmmsg()
+   * syscall. All packets go to the same remote host, each to its own UDP
+   * port, which matches the per-antenna port layout of the RRU simulator.
+   *
+   * @param rem_hostname Hostname or IP address of the remote server
+   * @param rem_ports One destination UDP port per message
+   * @param msgs One message pointer per message
+   * @param len Length in bytes of every message
+   * @param num Number of messages, at most kMaxSendBurst
+   */
+  void SendBatch(const std::string& rem_hostname, const uint16_t* rem_ports,
+                 const uint8_t* const* msgs, size_t len, size_t num) {
+    assert(num <= kMaxSendBurst);
+    struct iovec iovs[kMaxSendBurst];
+    struct mmsghdr hdrs[kMaxSendBurst];
+    std::memset(hdrs, 0, num * sizeof(hdrs[0]));
+    for (size_t i = 0; i < num; i++) {
+      struct addrinfo* rem_addrinfo =
+          ResolveRemote(rem_hostname, rem_ports[i]);
+      iovs[i].iov_base = const_cast<uint8_t*>(msgs[i]);
+      iovs[i].iov_len = len;
+      hdrs[i].msg_hdr.msg_name = rem_addrinfo->ai_addr;
+      hdrs[i].msg_hdr.msg_namelen = rem_addrinfo->ai_addrlen;
+      hdrs[i].msg_hdr.msg_iov = &iovs[i];
+      hdrs[i].msg_hdr.msg_iovlen = 1;
+    }
+    size_t sent = 0;
+    while (sent < num) {
+      int ret = sendmmsg(sock_fd_, &hdrs[sent], num - sent, 0);
+      if (ret <= 0) {
+        throw std::runtime_error("sendmmsg() failed. errno = " +
+                                 std::string(std::strerror(errno)));
       }
+      sent += static_cast<size_t>(ret);
+    }
 
-      if (map_insert_result.second == false) {
-        freeaddrinfo(rem_addrinfo);
-        rem_addrinfo = map_insert_result.first->second;
+    if (enable_recording_flag_) {
+      std::scoped_lock map_access(map_insert_access_);
+      for (size_t i = 0; i < num; i++) {
+        sent_vec_.emplace_back(msgs[i], msgs[i] + len);
       }
-    } else {
-      rem_addrinfo = remote_itr->second;
     }
+  }
 
-    ssize_t ret = sendto(sock_fd_, msg, len, 0, rem_addrinfo->ai_addr,
-                         rem_addrinfo->ai_addrlen);
-    if (ret != static_cast<ssize_t>(len)) {
-      throw std::runtime_error("sendto() failed. errno = " +
-                               std::string(std::strerror(errno)));
+  /**
+   * @brief Scatter-gather variant of SendBatch(): every wire packet is
+   * [hdr | payload], so headers can come from a small pool while payloads
+   * stay in place in the compute buffers.
+   *
+   * @param rem_hostname Hostname or IP address of the remote server
+   * @param rem_ports One destination UDP port per message
+   * @param hdrs One header pointer per message
+   * @param hdr_len Length in bytes of every header
+   * @param payloads One payload pointer per message
+   * @param payload_len Length in bytes of every payload
+   * @param num Number of messages, at most kMaxSendBurst
+   */
+  void SendBatch(const std::string& rem_hostname, const uint16_t* rem_ports,
+                 const uint8_t* const* hdrs, size_t hdr_len,
+                 const uint8_t* const* payloads, size_t payload_len,
+                 size_t num) {
+    assert(num <= kMaxSendBurst);
+    struct iovec iovs[2 * kMaxSendBurst];
+    struct mmsghdr hdrs_mmsg[kMaxSendBurst];
+    std::memset(hdrs_mmsg, 0, num * sizeof(hdrs_mmsg[0]));
+    for (size_t i = 0; i < num; i++) {
+      struct addrinfo* rem_addrinfo =
+          ResolveRemote(rem_hostname, rem_ports[i]);
+      iovs[2 * i].iov_base = const_cast<uint8_t*>(hdrs[i]);
+      iovs[2 * i].iov_len = hdr_len;
+      iovs[(2 * i) + 1].iov_base = const_cast<uint8_t*>(payloads[i]);
+      iovs[(2 * i) + 1].iov_len = payload_len;
+      hdrs_mmsg[i].msg_hdr.msg_name = rem_addrinfo->ai_addr;
+      hdrs_mmsg[i].msg_hdr.msg_namelen = rem_addrinfo->ai_addrlen;
+      hdrs_mmsg[i].msg_hdr.msg_iov = &iovs[2 * i];
+      hdrs_mmsg[i].msg_hdr.msg_iovlen = 2;
+    }
+    size_t sent = 0;
+    while (sent < num) {
+      int ret = sendmmsg(sock_fd_, &hdrs_mmsg[sent], num - sent, 0);
+      if (ret <= 0) {
+        throw std::runtime_error("sendmmsg() failed. errno = " +
+                                 std::string(std::strerror(errno)));
+      }
+      sent += static_cast<size_t>(ret);
     }
 
     if (enable_recording_flag_) {
       std::scoped_lock map_access(map_insert_access_);
-      sent_vec_.emplace_back(msg, msg + len);
+      for (size_t i = 0; i < num; i++) {
+        std::vector<uint8_t> packet(hdrs[i], hdrs[i] + hdr_len);
+        packet.insert(packet.end(), payloads[i], payloads[i] + payload_len);
+        sent_vec_.push_back(std::move(packet));
+      }
     }
   }
 
@@ -138,11 +347,68 @@ class UDPClient {
   void EnableRecording() { enable_recording_flag_ = true; }
 
  private:
+  /**
+   * @brief Return the cached addrinfo for hostname:port, resolving and
+   * caching it on first use
+   */
+  struct addrinfo* ResolveRemote(const std::string& rem_hostname,
+                                 uint16_t rem_port) {
+    std::string remote_uri = rem_hostname + ":" + std::to_string(rem_port);
+
+    const auto remote_itr = addrinfo_map_.find(remote_uri);
+    if (remote_itr != addrinfo_map_.end()) {
+      return remote_itr->second;
+    }
+
+    char port_str[16u];
+    snprintf(port_str, sizeof(port_str), "%u", rem_port);
+
+    struct addrinfo hints;  // maybe important
+    std::memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET6;  //possible change, added a 6
+    hints.ai_socktype = SOCK_DGRAM;
+    hints.ai_protocol = IPPROTO_UDP;
+
+    struct addrinfo* rem_addrinfo = nullptr;
+    int r = getaddrinfo(rem_hostname.c_str(), port_str, &hints, &rem_addrinfo);
+    if ((r != 0) || (rem_addrinfo == nullptr)) {
+      char issue_msg[1000u];
+      sprintf(issue_msg, "Failed to resolve %s. getaddrinfo error = %s.",
+              remote_uri.c_str(), gai_strerror(r));
+      throw std::runtime_error(issue_msg);
+    }
+
+    if (kDebugPrintUdpClientInit) {
+      std::printf("%d Resolving: %s map size %zu\n", sock_fd_,
+                  remote_uri.c_str(), addrinfo_map_.size());
+    }
+
+    std::pair<std::map<std::string, struct addrinfo*>::iterator, bool>
+        map_insert_result;
+
+    {  // Synchronize access to insert for thread safety
+      std::scoped_lock map_access(map_insert_access_);
+      map_insert_result = addrinfo_map_.insert(
+          std::pair<std::string, struct addrinfo*>(remote_uri, rem_addrinfo));
+    }
+
+    if (map_insert_result.second == false) {
+      freeaddrinfo(rem_addrinfo);
+      rem_addrinfo = map_insert_result.first->second;
+    }
+    return rem_addrinfo;
+  }
+
   /**
    * @brief The raw socket file descriptor
    */
   int sock_fd_ = -1;
 
+  /**
+   * @brief True once Connect() pinned the socket to one remote endpoint
+   */
+  bool connected_ = false;
+
   /**
    * @brief A cache mapping hostname:udp_port to addrinfo
    */
@@ -20,7 +20,11 @@
 #include <netdb.h>
 #include <sys/socket.h>
 #include <unistd.h>
+#if defined(__linux__)
+#include <linux/sock_diag.h> /* SK_MEMINFO_DROPS */
+#endif
 
+#include <cassert>
 #include <cstring> /* std::strerror, std::memset, std::memcpy */
 #include <map>
 #include <mutex>
@@ -32,8 +36,12 @@ class UDPServer {
   static const bool kDebugPrintUdpServerInit = true;
 
   // Initialize a UDP server listening on this UDP port with socket buffer
-  // size = rx_buffer_size
-  explicit UDPServer(uint16_t port, size_t rx_buffer_size = 0) : port_(port) {
+  // size = rx_buffer_size. A nonzero busy_poll_us makes an empty recv()
+  // busy-poll the device queue for up to that long instead of returning
+  // immediately (SO_BUSY_POLL)
+  explicit UDPServer(uint16_t port, size_t rx_buffer_size = 0,
+                     size_t busy_poll_us = 0)
+      : port_(port) {
     if (kDebugPrintUdpServerInit) {
       std::printf("Creating UDP server listening at port %d\n", port);
     }
@@ -78,6 +86,27 @@ class UDPServer {
       }
     }
 
+    // Best effort: kernels without busy-poll support (or without the
+    // privilege to enable it) keep the default interrupt-driven path
+    if (busy_poll_us != 0) {
+#if defined(SO_BUSY_POLL)
+      const int poll_us = static_cast<int>(busy_poll_us);
+      ret = setsockopt(sock_fd_, SOL_SOCKET, SO_BUSY_POLL, &poll_us,
+                       sizeof(poll_us));
+      if (ret != 0) {
+        std::fprintf(stderr,
+                     "UDPServer: Failed to enable %d us busy poll on port %d: "
+                     "%s\n",
+                     poll_us, port, std::strerror(errno));
+      }
+#else
+      std::fprintf(stderr,
+                   "UDPServer: SO_BUSY_POLL not supported, port %d keeps the "
+                   "default polling behavior\n",
+                   port);
+#endif
+    }
+
     struct sockaddr_in6 serveraddr6;                    //added a 6
     serveraddr6.sin6_family = AF_INET6;                 //added a 6
     serveraddr6.sin6_addr.s_addr = htonl(in6addr_any);  //added a 6
@@ -117,6 +146,42 @@ class UDPServer {
     }
   }
 
+  /// Raw socket descriptor, for I/O backends (e.g. io_uring) that drive
+  /// the socket themselves instead of calling Recv()
+  int SockFd() const { return sock_fd_; }
+
+  /// Cumulative count of packets the kernel dropped on this socket because
+  /// the receive buffer was full, scraped from the SO_MEMINFO accounting.
+  /// Returns 0 on kernels without SO_MEMINFO support, where the drops stay
+  /// visible only in netstat
+  size_t KernelDrops() const {
+#if defined(SO_MEMINFO) && defined(SK_MEMINFO_VARS)
+    uint32_t meminfo[SK_MEMINFO_VARS];
+    socklen_t len = sizeof(meminfo);
+    if ((getsockopt(sock_fd_, SOL_SOCKET, SO_MEMINFO, meminfo, &len) == 0) &&
+        (len >= ((SK_MEMINFO_DROPS + 1) * sizeof(uint32_t)))) {
+      return meminfo[SK_MEMINFO_DROPS];
+    }
+#endif
+    return 0;
+  }
+
+  /// Scrape the kernel drop counter and warn when it advanced since the
+  /// last poll, naming the owning stream so the drop is attributable
+  /// without netstat. One getsockopt() per call, so cheap enough for the
+  /// owning thread to poll periodically. Returns the cumulative count
+  size_t PollKernelDrops(const char* stream_label) {
+    const size_t drops = KernelDrops();
+    if (drops > reported_drops_) {
+      std::fprintf(stderr,
+                   "UDPServer [%s, port %u]: receive buffer overflowed, "
+                   "kernel dropped %zu packets since last poll (%zu total)\n",
+                   stream_label, port_, drops - reported_drops_, drops);
+      reported_drops_ = drops;
+    }
+    return drops;
+  }
+
   /**
    * @brief Try to receive up to len bytes in buf by default this will not block
    *
@@ -142,6 +207,48 @@ class UDPServer {
     return ret;
   }
 
+  /// Largest burst RecvMulti() accepts in one call
+  static constexpr size_t kMaxRecvBurst = 32;
+
+  /**
+   * @brief Try to receive up to num packets, each up to len bytes, with a
+   * single recvmmsg() syscall. bufs holds one destination buffer per packet
+   * and num must not exceed kMaxRecvBurst.
+   *
+   * @return Return the number of packets received (each of exactly
+   * rx_lengths[i] bytes). If no packets are pending, return zero. If there
+   * was an error in receiving, return -1.
+   */
+  ssize_t RecvMulti(uint8_t* const* bufs, size_t len, size_t num,
+                    size_t* rx_lengths) const {
+    assert(num <= kMaxRecvBurst);
+    struct iovec iovs[kMaxRecvBurst];
+    struct mmsghdr hdrs[kMaxRecvBurst];
+    std::memset(hdrs, 0, num * sizeof(hdrs[0]));
+    for (size_t i = 0; i < num; i++) {
+      iovs[i].iov_base = bufs[i];
+      iovs[i].iov_len = len;
+      hdrs[i].msg_hdr.msg_iov = &iovs[i];
+      hdrs[i].msg_hdr.msg_iovlen = 1;
+    }
+    int ret = recvmmsg(sock_fd_, hdrs, num, 0, nullptr);
+    if (ret == -1) {
+      if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+        // These errors mean that there's no data to receive
+        ret = 0;
+      } else {
+        std::fprintf(stderr,
+                     "UDPServer: recvmmsg() failed with unexpected error %s\n",
+                     std::strerror(errno));
+      }
+    } else {
+      for (int i = 0; i < ret; i++) {
+        rx_lengths[i] = hdrs[i].msg_len;
+      }
+    }
+    return ret;
+  }
+
   /**
    * @brief Try once to receive up to len bytes in buf
    *
@@ -253,6 +360,11 @@ class UDPServer {
    */
   int sock_fd_ = -1;
 
+  /**
+   * @brief Kernel drop count already reported by PollKernelDrops()
+   */
+  size_t reported_drops_ = 0;
+
   /**
    * @brief A cache mapping hostname:udp_port to addrinfo
    */
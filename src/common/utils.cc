@@ -8,7 +8,9 @@
 
 #include "utils.h"
 
+#include <algorithm>
 #include <list>
+#include <map>
 #include <mutex>
 
 struct CoreInfo {
@@ -40,6 +42,42 @@ static std::mutex pin_core_mutex;
 /* Keep list of core-thread relationship*/
 static std::list<CoreInfo> core_list;
 
+/* Topology-aware pinning plan: role -> physical core per thread index.
+ * Installed by PlanCoreAllocation() and consulted by PinToCoreWithOffset() */
+static std::map<ThreadType, std::vector<size_t>> core_plan;
+static bool core_plan_initialized = false;
+
+/* Collapse the thread-type zoo into the roles the planner allocates for */
+static ThreadType PlanRole(ThreadType type) {
+  switch (type) {
+    case ThreadType::kMaster:
+    case ThreadType::kMasterRX:
+    case ThreadType::kMasterTX:
+      return ThreadType::kMaster;
+    case ThreadType::kWorkerRX:
+    case ThreadType::kWorkerTX:
+    case ThreadType::kWorkerTXRX:
+      return ThreadType::kWorkerTXRX;
+    case ThreadType::kWorkerMacTXRX:
+      return ThreadType::kWorkerMacTXRX;
+    default:
+      return ThreadType::kWorker;
+  }
+}
+
+/* Max frequency of a core in kHz from sysfs, 0 when unreadable. On hybrid
+ * (P/E-core) parts the E-cores report a lower cpuinfo_max_freq, so sorting
+ * by this keeps latency-critical roles off the E-cores */
+static size_t ReadCoreMaxFreqKhz(size_t core) {
+  std::ifstream freq_file("/sys/devices/system/cpu/cpu" +
+                          std::to_string(core) + "/cpufreq/cpuinfo_max_freq");
+  size_t khz = 0;
+  if (freq_file.good()) {
+    freq_file >> khz;
+  }
+  return khz;
+}
+
 static size_t GetCoreId(size_t core) {
   size_t result;
   if (cpu_layout_initialized) {
@@ -132,6 +170,104 @@ size_t GetPhysicalCoreId(size_t core_id) {
   return core;
 }
 
+int GetNumaNodeOfCore(size_t core_id) {
+  if (numa_available() < 0) {
+    return -1;
+  }
+  return numa_node_of_cpu(static_cast<int>(GetPhysicalCoreId(core_id)));
+}
+
+void PlanCoreAllocation(const std::vector<CoreRoleRequirement>& requirements,
+                        bool verbose) {
+  std::scoped_lock lock(pin_core_mutex);
+  RtAssert(cpu_layout_initialized == true,
+           "CPU layout must be initialized before calling PlanCoreAllocation");
+
+  // Describe every usable core: host NUMA node plus max frequency, with
+  // each node's pool sorted fastest-first so P-cores are handed out before
+  // E-cores
+  struct CoreDesc {
+    size_t core_;
+    size_t max_freq_khz_;
+  };
+  std::map<int, std::vector<CoreDesc>> free_cores;
+  for (const size_t core : cpu_layout) {
+    const int node = numa_node_of_cpu(static_cast<int>(core));
+    free_cores[node].push_back(CoreDesc{core, ReadCoreMaxFreqKhz(core)});
+  }
+  for (auto& node_pool : free_cores) {
+    std::stable_sort(node_pool.second.begin(), node_pool.second.end(),
+                     [](const CoreDesc& a, const CoreDesc& b) {
+                       return a.max_freq_khz_ > b.max_freq_khz_;
+                     });
+  }
+  // Roles are placed on the master's node while it has room, so the RX
+  // threads land next to the master (and, typically, the NIC)
+  const int home_node = free_cores.begin()->first;
+
+  core_plan.clear();
+  for (const auto& req : requirements) {
+    if (req.count_ == 0) {
+      continue;
+    }
+    std::vector<size_t>& cores = core_plan[PlanRole(req.type_)];
+    size_t needed = req.count_;
+    while (needed > 0) {
+      // Pick one node that can hold the whole remainder of the role --
+      // the home node first -- and only straddle nodes when none can
+      int pick = -1;
+      if ((free_cores.count(home_node) != 0u) &&
+          (free_cores.at(home_node).size() >= needed)) {
+        pick = home_node;
+      } else {
+        for (const auto& node_pool : free_cores) {
+          if (node_pool.second.size() >= needed) {
+            pick = node_pool.first;
+            break;
+          }
+        }
+      }
+      if (pick == -1) {
+        size_t largest = 0;
+        for (const auto& node_pool : free_cores) {
+          if (node_pool.second.size() > largest) {
+            largest = node_pool.second.size();
+            pick = node_pool.first;
+          }
+        }
+        RtAssert(largest > 0,
+                 "PlanCoreAllocation: roles request more threads than there "
+                 "are usable cores");
+      }
+      auto& pool = free_cores.at(pick);
+      const size_t take = std::min(needed, pool.size());
+      for (size_t i = 0; i < take; i++) {
+        cores.push_back(pool.at(i).core_);
+      }
+      pool.erase(pool.begin(), pool.begin() + take);
+      if (pool.empty()) {
+        free_cores.erase(pick);
+      }
+      needed -= take;
+    }
+  }
+  core_plan_initialized = true;
+
+  if (verbose == true) {
+    std::printf("=================================\n");
+    std::printf("       CORE ALLOCATION PLAN      \n");
+    std::printf("=================================\n");
+    for (const auto& role : core_plan) {
+      std::printf("|| Role: %-16s || Cores:", ThreadTypeStr(role.first).c_str());
+      for (const size_t core : role.second) {
+        std::printf(" %zu(n%d)", core, numa_node_of_cpu(static_cast<int>(core)));
+      }
+      std::printf("\n");
+    }
+    std::printf("=================================\n");
+  }
+}
+
 int PinToCore(int core_id) {
   int num_cores = sysconf(_SC_NPROCESSORS_ONLN);
   if ((core_id < 0) || (core_id >= num_cores)) {
@@ -151,13 +287,25 @@ void PinToCoreWithOffset(ThreadType thread_type, int core_offset, int thread_id,
   std::scoped_lock lock(pin_core_mutex);
 
   if (kEnableThreadPinning == true) {
-    const size_t requested_core = (core_offset + thread_id);
+    size_t requested_core = (core_offset + thread_id);
 
     RtAssert(
         cpu_layout_initialized == true,
         "CPU layout must be initialized before calling PinToCoreWithOffset\n");
 
-    size_t assigned_core = GetCoreId(requested_core);
+    size_t assigned_core;
+    const auto planned = core_plan_initialized
+                             ? core_plan.find(PlanRole(thread_type))
+                             : core_plan.end();
+    if ((planned != core_plan.end()) &&
+        (static_cast<size_t>(thread_id) < planned->second.size())) {
+      // The plan stores physical core ids, so no cpu_layout remap; threads
+      // beyond the planned counts keep the legacy offset arithmetic
+      requested_core = planned->second.at(thread_id);
+      assigned_core = requested_core;
+    } else {
+      assigned_core = GetCoreId(requested_core);
+    }
 
     if (kEnableCoreReuse == false) {
       // Check to see if core has already been assigned
@@ -464,3 +612,30 @@ void Utils::PrintVec(arma::cx_fvec c, const std::string& ss) {
   so << std::endl;
   std::cout << so.str();
 }
+
+void Utils::ParallelFor(size_t count, const std::function<void(size_t)>& fn) {
+#ifdef THREADED_INIT
+  const size_t num_threads = std::min(
+      count, static_cast<size_t>(std::thread::hardware_concurrency()));
+  if (num_threads > 1) {
+    std::atomic<size_t> next_idx(0);
+    std::vector<std::thread> init_threads;
+    init_threads.reserve(num_threads);
+    for (size_t t = 0; t < num_threads; t++) {
+      init_threads.emplace_back([&next_idx, count, &fn]() {
+        for (size_t i = next_idx.fetch_add(1); i < count;
+             i = next_idx.fetch_add(1)) {
+          fn(i);
+        }
+      });
+    }
+    for (auto& join_thread : init_threads) {
+      join_thread.join();
+    }
+    return;
+  }
+#endif
+  for (size_t i = 0; i < count; i++) {
+    fn(i);
+  }
+}
@@ -29,6 +29,7 @@
 #include <cstdint>
 #include <cstdlib>
 #include <fstream>  // std::ifstream
+#include <functional>
 #include <iomanip>
 #include <iostream>
 #include <mutex>
@@ -47,6 +48,10 @@ void SetCpuLayoutOnNumaNodes(
 
 size_t GetPhysicalCoreId(size_t core_id);
 
+/* Return the NUMA node hosting the core with global index = core_id, or -1
+ * if the node cannot be determined */
+int GetNumaNodeOfCore(size_t core_id);
+
 /* Pin this thread to core with global index = core_id */
 int PinToCore(int core_id);
 
@@ -54,6 +59,24 @@ int PinToCore(int core_id);
 void PinToCoreWithOffset(ThreadType thread, int base_core_offset, int thread_id,
                          bool verbose = false);
 
+/* Declarative input to PlanCoreAllocation(): a thread role and how many
+ * threads of that role will be pinned. Worker subtypes (FFT/ZF/...) share
+ * the kWorker role; the RX/TX/TXRX socket threads share kWorkerTXRX. */
+struct CoreRoleRequirement {
+  ThreadType type_;
+  size_t count_;
+};
+
+/* Build a topology-aware pinning plan from the declared roles (in priority
+ * order) and the NUMA/frequency layout of the usable cores: each role stays
+ * on one NUMA node where possible, starting from the node of the first
+ * usable core, and faster cores (P-cores on hybrid parts) are handed out
+ * first. Once installed, PinToCoreWithOffset() pins planned threads from
+ * the plan and ignores their offset arithmetic; threads outside the plan
+ * fall back to the offset behavior. Prints the plan when verbose. */
+void PlanCoreAllocation(const std::vector<CoreRoleRequirement>& requirements,
+                        bool verbose = true);
+
 void PrintCoreAssignmentSummary();
 
 template <class T>
@@ -115,6 +138,11 @@ class Utils {
   static void PrintMat(arma::cx_fmat /*c*/, const std::string& /*ss*/);
   static void SaveMat(arma::cx_fmat /*c*/, const std::string& /*filename*/,
                       const std::string& /*ss*/, const bool /*append*/);
+  /// Run fn(i) for every i in [0, count) across short-lived startup threads
+  /// when THREADED_INIT is defined (serially otherwise). Only for one-time
+  /// initialization work such as Config::GenData; fn must be safe to call
+  /// concurrently for distinct indices
+  static void ParallelFor(size_t count, const std::function<void(size_t)>& fn);
 };
 
 /// roundup<N>(x) returns x rounded up to the next multiple of N. N must be
@@ -2,6 +2,11 @@
 #define UTILS_LDPC_H_
 
 #include <cstdlib> /* for std::aligned_alloc */
+#include <cstring> /* for std::memcpy */
+
+#ifdef __BMI2__
+#include <immintrin.h> /* for _pdep_u64 / _pext_u64 */
+#endif
 
 #include "encoder.h"
 #include "iobuffer.h"
@@ -58,9 +63,9 @@ static inline uint8_t Bitreverse8(uint8_t x) {
  * \param mod_type The number of bits in one modulated symbol (e.g., mod_type =
  * 6 for 64-QAM modulation)
  */
-static inline void AdaptBitsForMod(const uint8_t* bit_seq_in,
-                                   uint8_t* bytes_out, size_t len,
-                                   size_t mod_type) {
+static inline void AdaptBitsForModScalar(const uint8_t* bit_seq_in,
+                                         uint8_t* bytes_out, size_t len,
+                                         size_t mod_type) {
   uint16_t bits = 0;      // Bits collected from the input
   size_t bits_avail = 0;  // Number of valid bits filled into [bits]
   for (size_t i = 0; i < len; i++) {
@@ -79,13 +84,57 @@ static inline void AdaptBitsForMod(const uint8_t* bit_seq_in,
   }
 }
 
+#ifdef __BMI2__
+/// Reverse the bit order inside each of the eight bytes of x (SWAR)
+static inline uint64_t BitreverseBytes64(uint64_t x) {
+  x = ((x & 0xF0F0F0F0F0F0F0F0ULL) >> 4) | ((x & 0x0F0F0F0F0F0F0F0FULL) << 4);
+  x = ((x & 0xCCCCCCCCCCCCCCCCULL) >> 2) | ((x & 0x3333333333333333ULL) << 2);
+  x = ((x & 0xAAAAAAAAAAAAAAAAULL) >> 1) | ((x & 0x5555555555555555ULL) << 1);
+  return x;
+}
+#endif
+
+static inline void AdaptBitsForMod(const uint8_t* bit_seq_in,
+                                   uint8_t* bytes_out, size_t len,
+                                   size_t mod_type) {
+#ifdef __BMI2__
+  // Vector path: mod_type input bytes hold exactly 8 * mod_type bits, i.e.
+  // eight output symbols, so each iteration deposits one 64-bit store.
+  // Loads stay fully inside [bit_seq_in, bit_seq_in + len); the scalar
+  // tail finishes the rest, so callers' padding guarantees
+  // (kLdpcHelperFunctionInputBufferSizePaddingBytes) are untouched
+  if ((mod_type >= 1) && (mod_type <= 8)) {
+    const uint64_t group_mask =
+        0x0101010101010101ULL * ((1u << mod_type) - 1u);
+    size_t i = 0;
+    while ((i + 8) <= len) {
+      uint64_t raw;
+      std::memcpy(&raw, &bit_seq_in[i], sizeof(raw));
+      // Big-endian concatenation of the first mod_type bit-reversed bytes
+      const uint64_t v =
+          __builtin_bswap64(BitreverseBytes64(raw)) >> (8 * (8 - mod_type));
+      // Deposit consecutive mod_type-bit groups into the low bits of each
+      // output byte; pdep fills bytes last-group-first, so swap back
+      const uint64_t w = __builtin_bswap64(_pdep_u64(v, group_mask));
+      std::memcpy(bytes_out, &w, sizeof(w));
+      bytes_out += 8;
+      i += mod_type;
+    }
+    AdaptBitsForModScalar(&bit_seq_in[i], bytes_out, len - i, mod_type);
+    return;
+  }
+#endif
+  AdaptBitsForModScalar(bit_seq_in, bytes_out, len, mod_type);
+}
+
 /*
  * Copy packed, bit-reversed 8-bit fields stored in
  * vec_in[0..len-1] into unpacked m-bit vec_out (m == mod_type).
  * Storage at vec_out must be at least (m*len+7)/8 bytes.
  */
-static inline void AdaptBitsFromMod(const uint8_t* vec_in, uint8_t* vec_out,
-                                    int len, int mod_type) {
+static inline void AdaptBitsFromModScalar(const uint8_t* vec_in,
+                                          uint8_t* vec_out, int len,
+                                          int mod_type) {
   int bits_avail = 0;
   uint16_t bits = 0;
   for (int i = 0; i < len; i++) {
@@ -99,6 +148,34 @@ static inline void AdaptBitsFromMod(const uint8_t* vec_in, uint8_t* vec_out,
   }
 }
 
+static inline void AdaptBitsFromMod(const uint8_t* vec_in, uint8_t* vec_out,
+                                    int len, int mod_type) {
+#ifdef __BMI2__
+  // Vector path: eight mod_type-bit fields pack into exactly mod_type
+  // whole output bytes, extracted with one pext per iteration. The scalar
+  // tail finishes the final partial group
+  if ((mod_type >= 1) && (mod_type <= 8)) {
+    const uint64_t field_mask =
+        0x0101010101010101ULL *
+        static_cast<uint8_t>(0xFFu << (8u - static_cast<unsigned>(mod_type)));
+    int i = 0;
+    while ((i + 8) <= len) {
+      uint64_t raw;
+      std::memcpy(&raw, &vec_in[i], sizeof(raw));
+      // The useful bits of each field sit in the top mod_type bits of the
+      // bit-reversed byte; pext packs them LSB-first across the stream
+      const uint64_t w = _pext_u64(BitreverseBytes64(raw), field_mask);
+      std::memcpy(vec_out, &w, static_cast<size_t>(mod_type));
+      vec_out += mod_type;
+      i += 8;
+    }
+    AdaptBitsFromModScalar(&vec_in[i], vec_out, len - i, mod_type);
+    return;
+  }
+#endif
+  AdaptBitsFromModScalar(vec_in, vec_out, len, mod_type);
+}
+
 static inline uint8_t SelectBaseMatrixEntry(uint16_t Zc) {
   uint8_t i_ls;
   if ((Zc % 15) == 0) {
@@ -37,18 +37,26 @@ static float RandFloatFromShort(float min, float max) {
   return rand_val;
 }
 
+// Counterpart of RandFloatFromShort for the parallel generation loops:
+// rand() keeps hidden shared state, so each job draws from its own FastRand
+static float RandFloatFromShort(float min, float max, FastRand& rand_gen) {
+  float rand_val = ((static_cast<float>(rand_gen.NextU32()) /
+                     static_cast<float>(UINT32_MAX)) *
+                    (max - min)) +
+                   min;
+  auto rand_val_ushort = static_cast<short>(rand_val * 32768);
+  rand_val = (float)rand_val_ushort / 32768;
+  return rand_val;
+}
+
 void DataGenerator::DoDataGeneration(const std::string& directory) {
   srand(time(nullptr));
-  auto scrambler = std::make_unique<AgoraScrambler::Scrambler>();
   std::unique_ptr<DoCRC> crc_obj = std::make_unique<DoCRC>();
   size_t input_size = cfg_->NumBytesPerCb();
   // size_t input_size =
   //    LdpcEncodingInputBufSize(this->cfg_->LdpcConfig().BaseGraph(),
   //                             this->cfg_->LdpcConfig().ExpansionFactor());
 
-  auto* scrambler_buffer =
-      new int8_t[input_size + kLdpcHelperFunctionInputBufferSizePaddingBytes];
-
   // Step 1: Generate the information buffers (MAC Packets) and LDPC-encoded
   // buffers for uplink
   std::vector<std::vector<complex_float>> pre_ifft_data_syms;
@@ -105,7 +113,11 @@ void DataGenerator::DoDataGeneration(const std::string& directory) {
     std::vector<std::vector<int8_t>> ul_information(num_ul_codeblocks);
     std::vector<std::vector<int8_t>> ul_encoded_codewords(num_ul_codeblocks);
 
-    for (size_t cb = 0; cb < num_ul_codeblocks; cb++) {
+    // One encode job per code block; each job writes only its own entries
+    // of ul_information / ul_encoded_codewords. The scrambler and its
+    // scratch buffer are per-job because Scrambler keeps internal bit
+    // buffers; sharing them across startup threads would race
+    Utils::ParallelFor(num_ul_codeblocks, [&](size_t cb) {
       // i : symbol -> ue -> cb (repeat)
       size_t sym_id = cb / (symbol_blocks);
       // ue antenna for code block
@@ -125,13 +137,17 @@ void DataGenerator::DoDataGeneration(const std::string& directory) {
       ul_information.at(cb) =
           std::vector<int8_t>(cb_start, cb_start + input_size);
 
-      std::memcpy(scrambler_buffer, ul_information.at(cb).data(), input_size);
+      AgoraScrambler::Scrambler scrambler;
+      std::vector<int8_t> scramble_buffer(
+          input_size + kLdpcHelperFunctionInputBufferSizePaddingBytes, 0);
+      std::memcpy(scramble_buffer.data(), ul_information.at(cb).data(),
+                  input_size);
 
       if (this->cfg_->ScrambleEnabled()) {
-        scrambler->Scramble(scrambler_buffer, input_size);
+        scrambler.Scramble(scramble_buffer.data(), input_size);
       }
-      this->GenCodeblock(scrambler_buffer, ul_encoded_codewords.at(cb));
-    }
+      this->GenCodeblock(scramble_buffer.data(), ul_encoded_codewords.at(cb));
+    });
 
     {
       const std::string filename_input =
@@ -164,19 +180,19 @@ void DataGenerator::DoDataGeneration(const std::string& directory) {
     // Modulate the encoded codewords
     std::vector<std::vector<complex_float>> ul_modulated_codewords(
         num_ul_codeblocks);
-    for (size_t i = 0; i < num_ul_codeblocks; i++) {
+    Utils::ParallelFor(num_ul_codeblocks, [&](size_t i) {
       ul_modulated_codewords.at(i) =
           this->GetModulation(ul_encoded_codewords.at(i));
-    }
+    });
 
     // Place modulated uplink data codewords into central IFFT bins
     RtAssert(this->cfg_->LdpcConfig().NumBlocksInSymbol() ==
              1);  // TODO: Assumption
     pre_ifft_data_syms.resize(this->cfg_->UeAntNum() *
                               this->cfg_->Frame().NumUlDataSyms());
-    for (size_t i = 0; i < pre_ifft_data_syms.size(); i++) {
+    Utils::ParallelFor(pre_ifft_data_syms.size(), [&](size_t i) {
       pre_ifft_data_syms.at(i) = this->BinForIfft(ul_modulated_codewords.at(i));
-    }
+    });
   }
 
   // Generate UE-specific pilots (phase tracking & downlink channel estimation)
@@ -270,7 +286,13 @@ void DataGenerator::DoDataGeneration(const std::string& directory) {
   rx_data_all_symbols.Calloc(this->cfg_->Frame().NumTotalSyms(),
                              this->cfg_->OfdmCaNum() * this->cfg_->BsAntNum(),
                              Agora_memory::Alignment_t::kAlign64);
-  for (size_t i = 0; i < this->cfg_->Frame().NumTotalSyms(); i++) {
+  // Each symbol touches only its own rx_data_all_symbols row and reads the
+  // shared tx / CSI tables, so the symbols run on startup threads
+  // (CommsLib::IFFT builds a local MKL descriptor per call and is safe to
+  // run concurrently). The noise for each symbol comes from a per-job
+  // FastRand seeded off the shared rand() stream
+  const uint64_t noise_seed = (static_cast<uint64_t>(rand()) << 32) ^ rand();
+  Utils::ParallelFor(this->cfg_->Frame().NumTotalSyms(), [&](size_t i) {
     arma::cx_fmat mat_input_data(
         reinterpret_cast<arma::cx_float*>(tx_data_all_symbols[i]),
         this->cfg_->OfdmCaNum(), this->cfg_->UeAntNum(), false);
@@ -278,13 +300,15 @@ void DataGenerator::DoDataGeneration(const std::string& directory) {
         reinterpret_cast<arma::cx_float*>(rx_data_all_symbols[i]),
         this->cfg_->OfdmCaNum(), this->cfg_->BsAntNum(), false);
 
+    FastRand noise_rand;
+    noise_rand.seed_ = noise_seed + i;
     for (size_t j = 0; j < this->cfg_->OfdmCaNum(); j++) {
       arma::cx_fmat mat_csi(reinterpret_cast<arma::cx_float*>(csi_matrices[j]),
                             this->cfg_->BsAntNum(), this->cfg_->UeAntNum());
       mat_output.row(j) = mat_input_data.row(j) * mat_csi.st();
       for (size_t k = 0; k < this->cfg_->BsAntNum(); k++) {
-        arma::cx_float noise(RandFloatFromShort(-1, 1),
-                             RandFloatFromShort(-1, 1));
+        arma::cx_float noise(RandFloatFromShort(-1, 1, noise_rand),
+                             RandFloatFromShort(-1, 1, noise_rand));
         noise *= this->cfg_->NoiseLevel() * sqrt2_norm;
         mat_output.at(j, k) += noise;
       }
@@ -293,7 +317,7 @@ void DataGenerator::DoDataGeneration(const std::string& directory) {
       CommsLib::IFFT(rx_data_all_symbols[i] + j * this->cfg_->OfdmCaNum(),
                      this->cfg_->OfdmCaNum(), false);
     }
-  }
+  });
 
   std::string filename_rx = directory + "/data/LDPC_rx_data_" +
                             std::to_string(this->cfg_->OfdmCaNum()) + "_ant" +
@@ -377,7 +401,9 @@ void DataGenerator::DoDataGeneration(const std::string& directory) {
 
     std::vector<std::vector<int8_t>> dl_information(num_dl_codeblocks);
     std::vector<std::vector<int8_t>> dl_encoded_codewords(num_dl_codeblocks);
-    for (size_t cb = 0; cb < num_dl_codeblocks; cb++) {
+    // One encode job per code block, with per-job scrambler state, like
+    // the uplink loop above
+    Utils::ParallelFor(num_dl_codeblocks, [&](size_t cb) {
       // i : symbol -> ue -> cb (repeat)
       size_t sym_id = cb / (symbol_blocks);
       // ue antenna for code block
@@ -391,21 +417,25 @@ void DataGenerator::DoDataGeneration(const std::string& directory) {
       dl_information.at(cb) =
           std::vector<int8_t>(cb_start, cb_start + input_size);
 
-      std::memcpy(scrambler_buffer, dl_information.at(cb).data(), input_size);
+      AgoraScrambler::Scrambler scrambler;
+      std::vector<int8_t> scramble_buffer(
+          input_size + kLdpcHelperFunctionInputBufferSizePaddingBytes, 0);
+      std::memcpy(scramble_buffer.data(), dl_information.at(cb).data(),
+                  input_size);
 
       if (this->cfg_->ScrambleEnabled()) {
-        scrambler->Scramble(scrambler_buffer, input_size);
+        scrambler.Scramble(scramble_buffer.data(), input_size);
       }
-      this->GenCodeblock(scrambler_buffer, dl_encoded_codewords.at(cb));
-    }
+      this->GenCodeblock(scramble_buffer.data(), dl_encoded_codewords.at(cb));
+    });
 
     // Modulate the encoded codewords
     std::vector<std::vector<complex_float>> dl_modulated_codewords(
         num_dl_codeblocks);
-    for (size_t i = 0; i < num_dl_codeblocks; i++) {
+    Utils::ParallelFor(num_dl_codeblocks, [&](size_t i) {
       dl_modulated_codewords.at(i) =
           this->GetModulation(dl_encoded_codewords.at(i));
-    }
+    });
 
     {
       // Save downlink information bytes to file
@@ -441,7 +471,11 @@ void DataGenerator::DoDataGeneration(const std::string& directory) {
     precoder.Calloc(this->cfg_->OfdmCaNum(),
                     this->cfg_->UeAntNum() * this->cfg_->BsAntNum(),
                     Agora_memory::Alignment_t::kAlign32);
-    for (size_t i = 0; i < this->cfg_->OfdmCaNum(); i++) {
+    // The pseudo-inverses are independent per subcarrier. Normalizing here
+    // (instead of inside the per-symbol precoding loop below) leaves the
+    // precoder table read-only once it is built, so the precoding jobs can
+    // share it without synchronization
+    Utils::ParallelFor(this->cfg_->OfdmCaNum(), [&](size_t i) {
       arma::cx_fmat mat_input(
           reinterpret_cast<arma::cx_float*>(csi_matrices[i]),
           this->cfg_->BsAntNum(), this->cfg_->UeAntNum(), false);
@@ -449,7 +483,8 @@ void DataGenerator::DoDataGeneration(const std::string& directory) {
                                this->cfg_->UeAntNum(), this->cfg_->BsAntNum(),
                                false);
       pinv(mat_output, mat_input, 1e-2, "dc");
-    }
+      mat_output /= abs(mat_output).max();
+    });
 
     if (kPrintDebugCSI) {
       std::printf("CSI \n");
@@ -475,7 +510,7 @@ void DataGenerator::DoDataGeneration(const std::string& directory) {
     dl_mod_data.Calloc(this->cfg_->Frame().NumDLSyms(),
                        this->cfg_->OfdmCaNum() * this->cfg_->UeAntNum(),
                        Agora_memory::Alignment_t::kAlign64);
-    for (size_t i = 0; i < this->cfg_->Frame().NumDLSyms(); i++) {
+    Utils::ParallelFor(this->cfg_->Frame().NumDLSyms(), [&](size_t i) {
       for (size_t j = 0; j < this->cfg_->UeAntNum(); j++) {
         for (size_t sc_id = 0; sc_id < this->cfg_->OfdmDataNum(); sc_id++) {
           complex_float sc_data;
@@ -494,7 +529,7 @@ void DataGenerator::DoDataGeneration(const std::string& directory) {
                          this->cfg_->OfdmDataStart()] = sc_data;
         }
       }
-    }
+    });
 
     if (kPrintDlModData) {
       std::printf("dl mod data \n");
@@ -525,7 +560,9 @@ void DataGenerator::DoDataGeneration(const std::string& directory) {
                       2 * this->cfg_->SampsPerSymbol() * this->cfg_->BsAntNum(),
                       Agora_memory::Alignment_t::kAlign64);
 
-    for (size_t i = 0; i < this->cfg_->Frame().NumDLSyms(); i++) {
+    // One precoding + IFFT + quantization job per downlink symbol; the
+    // precoder table is read-only here (it was normalized when built above)
+    Utils::ParallelFor(this->cfg_->Frame().NumDLSyms(), [&](size_t i) {
       arma::cx_fmat mat_input_data(
           reinterpret_cast<arma::cx_float*>(dl_mod_data[i]),
           this->cfg_->OfdmCaNum(), this->cfg_->UeAntNum(), false);
@@ -539,7 +576,6 @@ void DataGenerator::DoDataGeneration(const std::string& directory) {
         arma::cx_fmat mat_precoder(
             reinterpret_cast<arma::cx_float*>(precoder[j]),
             this->cfg_->UeAntNum(), this->cfg_->BsAntNum(), false);
-        mat_precoder /= abs(mat_precoder).max();
         mat_output.row(j) = mat_input_data.row(j) * mat_precoder;
 
         // std::printf("symbol %d, sc: %d\n", i, j -
@@ -578,7 +614,7 @@ void DataGenerator::DoDataGeneration(const std::string& directory) {
         std::memset(tx_symbol + tx_zero_postfix_offset, 0,
                     sizeof(short) * 2 * this->cfg_->OfdmTxZeroPostfix());
       }
-    }
+    });
 
     std::string filename_dl_tx =
         directory + "/data/LDPC_dl_tx_data_" +
@@ -620,5 +656,4 @@ void DataGenerator::DoDataGeneration(const std::string& directory) {
   tx_data_all_symbols.Free();
   rx_data_all_symbols.Free();
   ue_specific_pilot.Free();
-  delete[] scrambler_buffer;
 }
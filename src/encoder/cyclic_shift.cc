@@ -163,7 +163,73 @@ inline __m256i CycleBitShift144to256(__m256i data, int16_t cyc_shift,
   return x1;
 }
 
+#ifdef __AVX512F__
+/* Cyclic right shift over a zc-bit field held in the low bytes of a 256-bit
+ * register, for any zc <= 256. The whole register is treated as one 256-bit
+ * integer and shifted with a branch-free funnel shift (64-bit lane permutes
+ * plus variable shifts), replacing the three range-specialized shifters with
+ * their shuffle tables and scalar byte fix-up loops. */
+inline __m256i CycleBitShiftAvx512(__m256i data, int16_t cyc_shift,
+                                   int16_t zc) {
+  const int shift = cyc_shift % zc;
+
+  /* mask of the valid zc bits, 64 at a time */
+  int64_t e[4];
+  for (int j = 0; j < 4; j++) {
+    const int bits = zc - (64 * j);
+    if (bits >= 64) {
+      e[j] = 0xffffffffffffffff;
+    } else if (bits <= 0) {
+      e[j] = 0;
+    } else {
+      e[j] = (1UL << bits) - 1;
+    }
+  }
+  const __m256i bit_mask = _mm256_set_epi64x(e[3], e[2], e[1], e[0]);
+  data = _mm256_and_si256(data, bit_mask);
+  if (shift == 0) {
+    return data;
+  }
+
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i lane_id = _mm256_set_epi64x(3, 2, 1, 0);
+
+  /* data >> shift: lane i = (x[i+q] >> r) | (x[i+q+1] << (64-r)), with
+   * lanes beyond the top reading as zero. Shift counts >= 64 in the xmm
+   * count form produce zero, so r == 0 needs no special case. */
+  const int rq = shift >> 6;
+  const int rr = shift & 0x3f;
+  __m256i idx = _mm256_add_epi64(lane_id, _mm256_set1_epi64x(rq));
+  const __m256i y = _mm256_permutex2var_epi64(data, idx, zero);
+  idx = _mm256_add_epi64(idx, _mm256_set1_epi64x(1));
+  const __m256i z = _mm256_permutex2var_epi64(data, idx, zero);
+  const __m256i right =
+      _mm256_or_si256(_mm256_srl_epi64(y, _mm_cvtsi32_si128(rr)),
+                      _mm256_sll_epi64(z, _mm_cvtsi32_si128(64 - rr)));
+
+  /* data << (zc - shift): lane i = (x[i-q] << r) | (x[i-q-1] >> (64-r)) */
+  const int lshift = zc - shift;
+  const int lq = lshift >> 6;
+  const int lr = lshift & 0x3f;
+  idx = _mm256_sub_epi64(_mm256_add_epi64(lane_id, _mm256_set1_epi64x(4)),
+                         _mm256_set1_epi64x(lq));
+  const __m256i y2 = _mm256_permutex2var_epi64(zero, idx, data);
+  idx = _mm256_sub_epi64(idx, _mm256_set1_epi64x(1));
+  const __m256i z2 = _mm256_permutex2var_epi64(zero, idx, data);
+  const __m256i left =
+      _mm256_or_si256(_mm256_sll_epi64(y2, _mm_cvtsi32_si128(lr)),
+                      _mm256_srl_epi64(z2, _mm_cvtsi32_si128(64 - lr)));
+
+  return _mm256_and_si256(_mm256_or_si256(right, left), bit_mask);
+}
+#endif  // __AVX512F__
+
 CYCLIC_BIT_SHIFT LdpcSelectShiftFunc(int16_t zcSize) {
+#ifdef __AVX512F__
+  if (zcSize <= 256) {
+    return CycleBitShiftAvx512;
+  }
+#endif
   if (zcSize <= 64) {
     return CycleBitShift2to64;
   } else if (zcSize <= 128) {
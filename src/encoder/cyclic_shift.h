@@ -15,6 +15,9 @@ inline __m256i CycleBitShift72to128(__m256i data, int16_t cyc_shift,
                                     int16_t zc);
 inline __m256i CycleBitShift144to256(__m256i data, int16_t cyc_shift,
                                      int16_t zc);
+#ifdef __AVX512F__
+inline __m256i CycleBitShiftAvx512(__m256i data, int16_t cyc_shift, int16_t zc);
+#endif
 
 using CYCLIC_BIT_SHIFT = __m256i (*)(__m256i, int16_t, int16_t);
 CYCLIC_BIT_SHIFT LdpcSelectShiftFunc(int16_t zcSize);
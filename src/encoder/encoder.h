@@ -3,7 +3,9 @@
  * @brief Definitions for Agora's AVX2-based LDPC encoder.
  *
  * We need an AVX2-based LDPC encoder because FlexRAN's LDPC encoder requires
- * AVX-512.
+ * AVX-512. On AVX-512-capable machines where FlexRAN still cannot be used
+ * (e.g. AMD cores), the cyclic-shift and adapter kernels switch to AVX-512
+ * variants at compile time; the AVX2 paths remain for older cores.
  */
 #ifndef ENCODER_H_
 #define ENCODER_H_
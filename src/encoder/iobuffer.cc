@@ -194,6 +194,42 @@ void Adapter64to256(int8_t* ptr_buff_0, int8_t* ptr_buff_1, uint16_t zc_size,
   }
 }
 
+#ifdef __AVX512F__
+/**
+ * Same chunk layout as Adapter64to256, using AVX-512 byte-granular masked
+ * loads and stores: the packed side is accessed with exactly zc/8 bytes per
+ * chunk, so no bit-mask constant needs to be built and the gather direction
+ * never reads or rewrites bytes belonging to the neighbouring chunk.
+ */
+void Adapter64to256Avx512(int8_t* ptr_buff_0, int8_t* ptr_buff_1,
+                          uint16_t zc_size, uint32_t cb_len_bits,
+                          int8_t direct) {
+  /* after 64, zc is always a multiple of 8 so chunks are byte aligned */
+  assert((zc_size >= 64) && (zc_size <= 256));
+  const int16_t byte_num = zc_size >> 3;  // Bits to bytes (ie /8)
+  const __mmask32 byte_mask =
+      (byte_num >= 32) ? 0xffffffffU : ((1U << byte_num) - 1);
+
+  int8_t* p_buff_0 = ptr_buff_0;
+  int8_t* p_buff_1 = ptr_buff_1;
+
+  for (size_t i = 0; i < (cb_len_bits / zc_size); i++) {
+    if (1 == direct) {
+      /* scatter: packed chunk -> zero-padded kProcBytes chunk */
+      const __m256i x0 = _mm256_maskz_loadu_epi8(byte_mask, p_buff_0);
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(p_buff_1), x0);
+    } else {
+      /* gather: kProcBytes chunk -> packed chunk */
+      const __m256i x0 =
+          _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p_buff_1));
+      _mm256_mask_storeu_epi8(p_buff_0, byte_mask, x0);
+    }
+    p_buff_1 = (p_buff_1 + kProcBytes);
+    p_buff_0 = (p_buff_0 + byte_num);
+  }
+}
+#endif  // __AVX512F__
+
 void Adapter288to384(int8_t* ptr_buff_0, int8_t* ptr_buff_1, uint16_t zc_size,
                      uint32_t cb_len_bits, int8_t direct) {
   /* use two __m256i to store one segment of length zc */
@@ -229,7 +265,11 @@ LDPC_ADAPTER_P LdpcSelectAdapterFunc(uint16_t zc_size) {
   if (zc_size < 64) {
     return Adapter2to64;
   } else if (zc_size <= 256) {
+#ifdef __AVX512F__
+    return Adapter64to256Avx512;
+#else
     return Adapter64to256;
+#endif
   } else {
     return Adapter288to384;
   }
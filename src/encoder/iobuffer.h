@@ -16,6 +16,12 @@ void Adapter2to64(int8_t* ptr_buff_0, __int8_t* ptr_buff_1, uint16_t zc_size,
 void Adapter64to256(int8_t* ptr_buff_0, int8_t* ptr_buff_1, uint16_t zc_size,
                     uint32_t cb_len_bits, int8_t direct);
 
+#ifdef __AVX512F__
+void Adapter64to256Avx512(int8_t* ptr_buff_0, int8_t* ptr_buff_1,
+                          uint16_t zc_size, uint32_t cb_len_bits,
+                          int8_t direct);
+#endif
+
 void Adapter288to384(int8_t* ptr_buff_0, int8_t* ptr_buff_1, uint16_t zc_size,
                      uint32_t cb_len_bits, int8_t direct);
 
@@ -13,10 +13,10 @@
 class MacDataReceiver {
  public:
   virtual size_t Load(unsigned char *destination, size_t requested_bytes) = 0;
+  virtual ~MacDataReceiver() = default;
 
  protected:
   inline MacDataReceiver() = default;;
-  virtual ~MacDataReceiver() = default;
 };
 
 #endif  // MAC_DATA_RECEIVER_H_
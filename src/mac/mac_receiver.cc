@@ -4,6 +4,7 @@
  */
 #include "mac_receiver.h"
 
+#include <cstring>
 #include <utility>
 
 #include "logger.h"
@@ -84,6 +85,41 @@ void* MacReceiver::LoopRecv(size_t tid) {
       throw std::runtime_error("Receiver: recv failed");
     } else if ((recvlen > 0) &&
                static_cast<size_t>(recvlen) <= max_packet_length) {
+      if (cfg_->MacPduAggregation() == true) {
+        // Walk the length-prefixed sub-headers and hand each app PDU on
+        // individually
+        size_t pdu_offset = 0;
+        size_t num_pdus = 0;
+        while ((pdu_offset + kMacPduSubHeaderBytes) <=
+               static_cast<size_t>(recvlen)) {
+          uint16_t pdu_len;
+          std::memcpy(&pdu_len, &rx_buffer[pdu_offset], sizeof(pdu_len));
+          pdu_offset += kMacPduSubHeaderBytes;
+          if ((pdu_len == 0) ||
+              ((pdu_offset + pdu_len) > static_cast<size_t>(recvlen))) {
+            MLPD_ERROR(
+                "MacReceiver: Thread %zu bad aggregated pdu length %u at "
+                "offset %zu of %zu received bytes\n",
+                tid, pdu_len, pdu_offset - kMacPduSubHeaderBytes,
+                static_cast<size_t>(recvlen));
+            break;
+          }
+          if (enable_udp_output_) {
+            udp_streamer->Send(udp_dest_address_, udp_dest_port_ + ue_id,
+                               &rx_buffer[pdu_offset], pdu_len);
+          }
+          pdu_offset += pdu_len;
+          num_pdus++;
+        }
+        if (kDebugMacReceiver) {
+          std::printf(
+              "MacReceiver: Thread %zu, unpacked %zu aggregated pdus from "
+              "%zu:%zu bytes\n",
+              tid, num_pdus, static_cast<size_t>(recvlen), max_packet_length);
+        }
+        continue;
+      }
+
       if (enable_udp_output_) {
         udp_streamer->Send(udp_dest_address_, udp_dest_port_ + ue_id,
                            &rx_buffer[0u], recvlen);
@@ -4,25 +4,24 @@
  */
 #include "mac_sender.h"
 
+#include <cstring>
 #include <thread>
 #include <utility>
 
 #include "datatype_conversion.h"
 #include "file_receiver.h"
 #include "logger.h"
+#include "shmem_receiver.h"
 #include "udp_client.h"
 #include "video_receiver.h"
 
 #define USE_UDP_DATA_SOURCE
 static constexpr bool kDebugPrintSender = false;
-static constexpr size_t kFrameLoadAdvance = 10;
 static constexpr size_t kBufferInit = 10;
 static constexpr size_t kTxBufferElementAlignment = 64;
 
 static constexpr size_t kSlowStartMulStage1 = 32;
 static constexpr size_t kSlowStartMulStage2 = 8;
-
-static_assert(kFrameLoadAdvance >= kBufferInit);
 static std::atomic<bool> keep_running(true);
 // A spinning barrier to synchronize the start of worker threads
 static std::atomic<size_t> num_workers_ready_atomic(0);
@@ -33,13 +32,11 @@ void InterruptHandler(int /*unused*/) {
 }
 
 void DelayTicks(uint64_t start, uint64_t ticks) {
-  while ((GetTime::Rdtsc() - start) < ticks) {
-    _mm_pause();
-  }
+  GetTime::WaitUntilTsc(start + ticks);
 }
 
 inline size_t MacSender::TagToTxBuffersIndex(gen_tag_t tag) const {
-  const size_t frame_slot = (tag.frame_id_ % kFrameWnd);
+  const size_t frame_slot = (tag.frame_id_ % cfg_->FrameWnd());
 
   return (frame_slot * cfg_->UeAntNum()) + tag.ue_id_;
 }
@@ -58,6 +55,7 @@ MacSender::MacSender(Config* cfg, std::string& data_filename,
       worker_thread_num_(worker_thread_num),
       update_thread_num_(update_thread_num),
       enable_slow_start_(enable_slow_start),
+      frame_load_advance_(cfg->MacFrameLoadAdvance()),
       core_offset_(core_offset),
       inter_frame_delay_(inter_frame_delay),
       ticks_inter_frame_(inter_frame_delay_ * ticks_per_usec_),
@@ -89,16 +87,38 @@ MacSender::MacSender(Config* cfg, std::string& data_filename,
   tx_buffer_pkt_offset_ = (cfg_->MacPacketLength() + padding);
   assert((tx_buffer_pkt_offset_ % kTxBufferElementAlignment) == 0);
 
+  RtAssert(frame_load_advance_ >= kBufferInit,
+           "MacSender: mac_frame_load_advance must cover the buffer init "
+           "window");
+
   const size_t tx_packet_storage = (packets_per_frame_ * tx_buffer_pkt_offset_);
   // tx buffers will be an array of
-  tx_buffers_.Malloc(kFrameWnd * cfg_->UeAntNum(), tx_packet_storage,
+  tx_buffers_.Malloc(cfg_->FrameWnd() * cfg_->UeAntNum(), tx_packet_storage,
                      Agora_memory::Alignment_t::kAlign64);
+
+  // Keep the frame cache resident: write-touch every page now and mlock()
+  // it, so once data is preloaded only the file read itself can stall a
+  // frame, never a page fault against the cache
+  bool lock_failed = false;
+  for (size_t buffer = 0; buffer < (cfg_->FrameWnd() * cfg_->UeAntNum());
+       buffer++) {
+    Agora_memory::PrefaultPages(tx_buffers_[buffer], tx_packet_storage);
+    if (Agora_memory::LockPages(tx_buffers_[buffer], tx_packet_storage) ==
+        false) {
+      lock_failed = true;
+    }
+  }
+  if (lock_failed == true) {
+    MLPD_WARN(
+        "MacSender: failed to mlock() tx buffers, pages stay prefaulted but "
+        "may be evicted\n");
+  }
   MLPD_TRACE(
       "Tx buffer size: dim1 %zu, dim2 %zu, total %zu, start %zu, end: %zu\n",
-      (kFrameWnd * cfg_->UeAntNum()), tx_packet_storage,
-      (kFrameWnd * cfg_->UeAntNum()) * tx_packet_storage,
+      (cfg_->FrameWnd() * cfg_->UeAntNum()), tx_packet_storage,
+      (cfg_->FrameWnd() * cfg_->UeAntNum()) * tx_packet_storage,
       (size_t)tx_buffers_[0],
-      (size_t)tx_buffers_[(kFrameWnd * cfg_->UeAntNum()) - 1]);
+      (size_t)tx_buffers_[(cfg_->FrameWnd() * cfg_->UeAntNum()) - 1]);
 
   MLPD_INFO(
       "Initializing MacSender, sending to mac thread at %s:%zu, frame "
@@ -194,7 +214,7 @@ void* MacSender::MasterThread(size_t /*unused*/) {
   frame_data_count.fill(0);
 
   // Wait for all worker threads to be ready (+1 for Master)
-  for (size_t i = 0; i < kFrameLoadAdvance; i++) {
+  for (size_t i = 0; i < frame_load_advance_; i++) {
     LoadFrame(i);
   }
 
@@ -216,13 +236,13 @@ void* MacSender::MasterThread(size_t /*unused*/) {
       ((cfg_->Frame().NumTotalSyms() * GetTicksForFrame(0)) / ticks_per_usec_);
 
   ScheduleFrame(0);
-  LoadFrame(0 + kFrameLoadAdvance);
+  LoadFrame(0 + frame_load_advance_);
 
   while (keep_running.load() == true) {
     gen_tag_t ctag(0);  // The completion tag
     int ret = static_cast<int>(completion_queue_.try_dequeue(ctag.tag_));
     if (ret > 0) {
-      const size_t comp_frame_slot = (ctag.frame_id_ % kFrameWnd);
+      const size_t comp_frame_slot = (ctag.frame_id_ % cfg_->FrameWnd());
       frame_data_count.at(comp_frame_slot)++;
 
       if (kDebugPrintSender) {
@@ -263,7 +283,7 @@ void* MacSender::MasterThread(size_t /*unused*/) {
           // Save the scheduled time to apply for the end of the frame
           timestamp_us = GetTime::GetTimeUs();
           ScheduleFrame(next_frame_id);
-          LoadFrame(next_frame_id + kFrameLoadAdvance);
+          LoadFrame(next_frame_id + frame_load_advance_);
         }
       }
     }  // end (ret > 0)
@@ -389,9 +409,9 @@ void* MacSender::WorkerThread(size_t tid) {
 uint64_t MacSender::GetTicksForFrame(size_t frame_id) const {
   if (enable_slow_start_ == 0) {
     return ticks_all_;
-  } else if (frame_id < kFrameWnd) {
+  } else if (frame_id < cfg_->FrameWnd()) {
     return ticks_wnd1_;
-  } else if (frame_id < (kFrameWnd * 4)) {
+  } else if (frame_id < (cfg_->FrameWnd() * 4)) {
     return ticks_wnd2_;
   } else {
     return ticks_all_;
@@ -425,22 +445,26 @@ void* MacSender::DataUpdateThread(size_t tid, size_t num_data_sources) {
       "%zu:%zu data\n",
       tid, sched_getcpu(), ue_ant_low, ue_ant_high);
 
-#if defined(USE_UDP_DATA_SOURCE)
-  std::vector<std::unique_ptr<VideoReceiver>> sources;
-#else
-  ///\todo need a list of file names for this
-  std::vector<std::unique_ptr<FileReceiver>> sources;
-#endif
+  std::vector<std::unique_ptr<MacDataReceiver>> sources;
 
   for (size_t source = 0; source < num_data_sources; source++) {
+    if (cfg_->MacShmemTransport() == true) {
+      // Each source owns one shared-memory ring; the co-located app
+      // attaches to it as the producer
+      sources.emplace_back(std::make_unique<ShmemReceiver>(
+          std::string(ShmemRing::kAppSourceRingPrefix) +
+          std::to_string((tid * num_data_sources) + source)));
+    } else {
 #if defined(USE_UDP_DATA_SOURCE)
-    // Assumes that the num_data_sources are spread evenly between threads
-    sources.emplace_back(std::make_unique<VideoReceiver>(
-        VideoReceiver::kVideoStreamRxPort + (tid * num_data_sources) + source));
+      // Assumes that the num_data_sources are spread evenly between threads
+      sources.emplace_back(std::make_unique<VideoReceiver>(
+          VideoReceiver::kVideoStreamRxPort + (tid * num_data_sources) +
+          source));
 #else
-    ///\todo need a list of file names for this
-    sources.emplace_back(std::make_unique<FileReceiver>(data_filename_));
+      ///\todo need a list of file names for this
+      sources.emplace_back(std::make_unique<FileReceiver>(data_filename_));
 #endif
+    }
   }
 
   // Init the data buffers
@@ -481,9 +505,15 @@ void MacSender::UpdateTxBuffer(MacDataReceiver* data_source, gen_tag_t tag) {
 
   for (size_t i = 0; i < packets_per_frame_; i++) {
     auto* pkt = reinterpret_cast<MacPacketPacked*>(mac_packet_location);
-    // Read a MacPayload into the data section
-    size_t loaded_bytes =
-        data_source->Load(pkt->DataPtr(), cfg_->MacPayloadMaxLength());
+    // Read a MacPayload into the data section. With aggregation on, the
+    // payload carries multiple length-prefixed app PDUs instead of one
+    size_t loaded_bytes;
+    if (cfg_->MacPduAggregation() == true) {
+      loaded_bytes = LoadAggregated(data_source, pkt->DataPtr());
+    } else {
+      loaded_bytes =
+          data_source->Load(pkt->DataPtr(), cfg_->MacPayloadMaxLength());
+    }
 
     pkt->Set(tag.frame_id_, get_data_symbol_id_(i), tag.ue_id_, loaded_bytes);
 
@@ -507,6 +537,26 @@ void MacSender::UpdateTxBuffer(MacDataReceiver* data_source, gen_tag_t tag) {
             cfg_->MacPayloadMaxLength() * packets_per_frame_);
 }
 
+size_t MacSender::LoadAggregated(MacDataReceiver* data_source,
+                                 unsigned char* dest) {
+  const size_t payload_max = cfg_->MacPayloadMaxLength();
+
+  // Pack as many length-prefixed app PDUs as fit into this transport block
+  size_t filled = 0;
+  while ((filled + kMacPduSubHeaderBytes) < payload_max) {
+    const size_t space = payload_max - filled - kMacPduSubHeaderBytes;
+    const size_t pdu_bytes =
+        data_source->Load(&dest[filled + kMacPduSubHeaderBytes], space);
+    if (pdu_bytes == 0) {
+      break;  // Source has nothing more for this transport block
+    }
+    const auto pdu_len = static_cast<uint16_t>(pdu_bytes);
+    std::memcpy(&dest[filled], &pdu_len, sizeof(pdu_len));
+    filled += kMacPduSubHeaderBytes + pdu_bytes;
+  }
+  return filled;
+}
+
 void MacSender::WriteStatsToFile(size_t tx_frame_count) const {
   std::string cur_directory = TOSTRING(PROJECT_DIRECTORY);
   std::string filename = cur_directory + "/data/tx_result.txt";
@@ -70,6 +70,9 @@ class MacSender {
   void CreateWorkerThreads(size_t num_workers);
 
   void UpdateTxBuffer(MacDataReceiver* data_source, gen_tag_t tag);
+  // Pack length-prefixed app PDUs from [data_source] into one MAC packet
+  // payload until it is full; returns the number of payload bytes used
+  size_t LoadAggregated(MacDataReceiver* data_source, unsigned char* dest);
   void WriteStatsToFile(size_t tx_frame_count) const;
 
   void ScheduleFrame(size_t frame);
@@ -83,6 +86,10 @@ class MacSender {
   const size_t update_thread_num_;  // Number of Tx buffer update threads
   const size_t enable_slow_start_;  // If 1, send frames slowly at first
 
+  // Prefetch window: frames of source data preloaded ahead of the frame
+  // clock (mac_frame_load_advance config key)
+  const size_t frame_load_advance_;
+
   // The master thread runs on core core_offset. Worker threads use cores
   // {core_offset + 1, ..., core_offset + thread_num - 1}
   const size_t core_offset_;
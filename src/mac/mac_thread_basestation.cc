@@ -4,11 +4,21 @@
  */
 #include "mac_thread_basestation.h"
 
+#include <algorithm>
+#include <cstring>
+
 #include "logger.h"
 #include "utils_ldpc.h"
 
 static constexpr size_t kUdpRxBufferPadding = 2048u;
 
+// Link adaptation thresholds: the worst-UE decode failure rate that forces
+// a modulation step down / permits a step up, and the MAC rx queue backlog
+// treated as PHY backpressure
+static constexpr double kLinkAdaptFailRateLower = 0.05;
+static constexpr double kLinkAdaptFailRateRaise = 0.001;
+static constexpr size_t kLinkAdaptBacklogHighWater = 256u;
+
 MacThreadBaseStation::MacThreadBaseStation(
     Config* cfg, size_t core_offset,
     PtrCube<kFrameWnd, kMaxSymbols, kMaxUEs, int8_t>& decoded_buffer,
@@ -20,6 +30,7 @@ MacThreadBaseStation::MacThreadBaseStation(
       freq_ghz_(GetTime::MeasureRdtscFreq()),
       tsc_delta_((cfg_->GetFrameDurationSec() * 1e9) / freq_ghz_),
       core_offset_(core_offset),
+      num_shards_(cfg_->MacThreadNum()),
       decoded_buffer_(decoded_buffer),
       rx_queue_(rx_queue),
       tx_queue_(tx_queue) {
@@ -40,30 +51,66 @@ MacThreadBaseStation::MacThreadBaseStation(
   client_.dl_bits_buffer_ = dl_bits_buffer;
   client_.dl_bits_buffer_status_ = dl_bits_buffer_status;
 
+  ran_mod_order_bits_ = CommsLib::kQaM16;
+  for (size_t ue = 0; ue < kMaxUEs; ue++) {
+    window_ul_packets_.at(ue).store(0);
+    window_crc_failures_.at(ue).store(0);
+  }
+
   server_.n_filled_in_frame_.fill(0);
+  server_.seg_frame_id_.fill(SIZE_MAX);
   for (size_t ue_ant = 0; ue_ant < cfg_->UeAntTotal(); ue_ant++) {
     server_.data_size_.emplace_back(
         std::vector<size_t>(cfg->Frame().NumUlDataSyms()));
+    server_.frame_segs_.emplace_back(
+        std::vector<const uint8_t*>(cfg->Frame().NumUlDataSyms()));
   }
-
-  for (auto& v : server_.frame_data_) {
-    v.resize(cfg_->UlMacDataBytesNumPerframe());
-  }
+  RtAssert(cfg_->UlMacPacketsPerframe() <= UDPClient::kMaxGatherSegs,
+           "MAC frame has more packets than one gather send supports");
 
   const size_t udp_pkt_len = cfg_->DlMacDataBytesNumPerframe();
   udp_pkt_buf_.resize(udp_pkt_len + kUdpRxBufferPadding);
 
-  // TODO: See if it makes more sense to split up the UE's by port here for
-  // client mode.
-  size_t udp_server_port = cfg_->BsMacRxPort();
-  MLPD_INFO(
-      "MacThreadBaseStation: setting up udp server for mac data at port %zu\n",
-      udp_server_port);
-  udp_server_ = std::make_unique<UDPServer>(
-      udp_server_port, udp_pkt_len * kMaxUEs * kMaxPktsPerUE);
+  // Slots for one recvmmsg() burst; each app datagram carries at most one
+  // full MAC packet but the slots get the same padding as udp_pkt_buf_
+  udp_burst_slot_len_ = cfg_->MacPacketLength() + kUdpRxBufferPadding;
+  udp_burst_buf_.resize(udp_burst_slot_len_ * UDPServer::kMaxRecvBurst);
+  for (size_t slot = 0; slot < UDPServer::kMaxRecvBurst; slot++) {
+    udp_burst_slots_.at(slot) = &udp_burst_buf_.at(slot * udp_burst_slot_len_);
+  }
 
-  udp_client_ = std::make_unique<UDPClient>();
-  crc_obj_ = std::make_unique<DoCRC>();
+  if (cfg_->MacShmemTransport() == true) {
+    // Co-located apps: memory-mapped rings replace the loopback UDP data
+    // sockets (the control channel to the UEs stays on UDP)
+    shmem_rx_ring_ = std::make_unique<ShmemRing>(
+        ShmemRing::kBsRxRingName, ShmemRing::kDefaultRingBytes, true);
+    for (size_t ue = 0; ue < cfg_->UeAntTotal(); ue++) {
+      shmem_tx_rings_.emplace_back(std::make_unique<ShmemRing>(
+          std::string(ShmemRing::kBsTxRingPrefix) + std::to_string(ue),
+          ShmemRing::kDefaultRingBytes, true));
+    }
+  } else {
+    // TODO: See if it makes more sense to split up the UE's by port here for
+    // client mode.
+    size_t udp_server_port = cfg_->BsMacRxPort();
+    MLPD_INFO(
+        "MacThreadBaseStation: setting up udp server for mac data at port "
+        "%zu\n",
+        udp_server_port);
+    udp_server_ = std::make_unique<UDPServer>(
+        udp_server_port, udp_pkt_len * kMaxUEs * kMaxPktsPerUE,
+        cfg_->UdpBusyPollUs());
+  }
+
+  // One UDP client and CRC calculator per codeblock shard so the shard
+  // threads never share socket or CRC state
+  for (size_t shard = 0; shard < num_shards_; shard++) {
+    udp_clients_.emplace_back(std::make_unique<UDPClient>());
+    crc_objs_.emplace_back(std::make_unique<DoCRC>());
+  }
+  for (size_t shard = 1; shard < num_shards_; shard++) {
+    shard_queues_.emplace_back(kShardQueueSize);
+  }
 }
 
 MacThreadBaseStation::~MacThreadBaseStation() {
@@ -79,7 +126,15 @@ void MacThreadBaseStation::ProcessRxFromPhy() {
 
   if (event.event_type_ == EventType::kPacketToMac) {
     MLPD_TRACE("MacThreadBaseStation: MAC thread event kPacketToMac\n");
-    ProcessCodeblocksFromPhy(event);
+    // Route to the shard that owns this UE; shard 0 is handled inline.
+    // Routing by UE id keeps per-UE packet order
+    const size_t shard = gen_tag_t(event.tags_[0]).ue_id_ % num_shards_;
+    if (shard == 0) {
+      ProcessCodeblocksFromPhy(0, event);
+    } else {
+      RtAssert(shard_queues_.at(shard - 1).enqueue(event),
+               "MacThreadBaseStation: shard queue enqueue failed");
+    }
   } else if (event.event_type_ == EventType::kSNRReport) {
     MLPD_TRACE("MacThreadBaseStation: MAC thread event kSNRReport\n");
     ProcessSnrReportFromPhy(event);
@@ -100,24 +155,27 @@ void MacThreadBaseStation::ProcessSnrReportFromPhy(EventData event) {
 void MacThreadBaseStation::SendRanConfigUpdate(EventData /*event*/) {
   RanConfig rc;
   rc.n_antennas_ = 0;  // TODO [arjun]: What's the correct value here?
-  rc.mod_order_bits_ = CommsLib::kQaM16;
+  rc.mod_order_bits_ = ran_mod_order_bits_;
   rc.frame_id_ = scheduler_next_frame_id_;
   // TODO: change n_antennas to a desired value
   // cfg_->BsAntNum() is added to fix compiler warning
   rc.n_antennas_ = cfg_->BsAntNum();
+  rc.ul_block_mask_ = ran_ul_block_mask_;
 
   EventData msg(EventType::kRANUpdate);
-  msg.num_tags_ = 3;
+  msg.num_tags_ = 4;
   msg.tags_[0] = rc.n_antennas_;
   msg.tags_[1] = rc.mod_order_bits_;
   msg.tags_[2] = rc.frame_id_;
+  msg.tags_[3] = rc.ul_block_mask_;
   RtAssert(tx_queue_->enqueue(msg),
            "MAC thread: failed to send RAN update to Agora");
 
   scheduler_next_frame_id_++;
 }
 
-void MacThreadBaseStation::ProcessCodeblocksFromPhy(EventData event) {
+void MacThreadBaseStation::ProcessCodeblocksFromPhy(size_t shard,
+                                                    EventData event) {
   assert(event.event_type_ == EventType::kPacketToMac);
 
   const size_t frame_id = gen_tag_t(event.tags_[0]).frame_id_;
@@ -132,7 +190,7 @@ void MacThreadBaseStation::ProcessCodeblocksFromPhy(EventData event) {
   const size_t max_data_bytes_per_frame = cfg_->UlMacDataBytesNumPerframe();
   const size_t num_mac_packets_per_frame = cfg_->UlMacPacketsPerframe();
   const int8_t* src_data =
-      decoded_buffer_[(frame_id % kFrameWnd)][symbol_array_index][ue_id];
+      decoded_buffer_[cfg_->FrameSlot(frame_id)][symbol_array_index][ue_id];
 
   std::stringstream ss;  // Debug formatting
 
@@ -154,7 +212,7 @@ void MacThreadBaseStation::ProcessCodeblocksFromPhy(EventData event) {
        << frame_id << " symbol " << pkt->Symbol() << ":" << symbol_id
        << " user " << pkt->Ue() << ":" << ue_id << " length "
        << pkt->PayloadLength() << ":" << cfg_->MacPayloadMaxLength() << " crc "
-       << pkt->Crc() << " copied to offset " << frame_data_offset << std::endl;
+       << pkt->Crc() << " mapped at offset " << frame_data_offset << std::endl;
 
     if (kLogMacPackets) {
       ss << "Header Info:" << std::endl
@@ -176,17 +234,29 @@ void MacThreadBaseStation::ProcessCodeblocksFromPhy(EventData event) {
          (pkt->Symbol() <= data_symbol_index_end)) &&
         (pkt->Ue() <= cfg_->UeAntNum())) {
       auto crc = static_cast<uint16_t>(
-          crc_obj_->CalculateCrc24(pkt->Data(), pkt->PayloadLength()) & 0xFFFF);
+          crc_objs_.at(shard)->CalculateCrc24(pkt->Data(),
+                                              pkt->PayloadLength()) &
+          0xFFFF);
 
       data_valid = (crc == pkt->Crc());
     }
 
+    if (cfg_->MacLinkAdapt() == true) {
+      window_ul_packets_.at(ue_id).fetch_add(1, std::memory_order_relaxed);
+      if (data_valid == false) {
+        window_crc_failures_.at(ue_id).fetch_add(1, std::memory_order_relaxed);
+      }
+      latest_ul_frame_id_.store(frame_id, std::memory_order_relaxed);
+    }
+
+    server_.seg_frame_id_.at(ue_id) = frame_id;
     if (data_valid) {
       MLPD_FRAME("%s", ss.str().c_str());
-      /// Spot to be optimized #1
-      std::memcpy(&server_.frame_data_.at(ue_id).at(frame_data_offset),
-                  pkt->Data(), pkt->PayloadLength());
-
+      // Zero-copy: remember where the payload lives in decoded_buffer_
+      // instead of staging it; the gather send below reads it in place
+      server_.frame_segs_.at(ue_id).at(symbol_array_index -
+                                       num_pilot_symbols) =
+          reinterpret_cast<const uint8_t*>(pkt->Data());
       server_.data_size_.at(ue_id).at(symbol_array_index - num_pilot_symbols) =
           pkt->PayloadLength();
 
@@ -206,39 +276,72 @@ void MacThreadBaseStation::ProcessCodeblocksFromPhy(EventData event) {
   // When the frame is full, send it to the application
   if (server_.n_filled_in_frame_.at(ue_id) == max_data_bytes_per_frame) {
     server_.n_filled_in_frame_.at(ue_id) = 0;
-    /// Spot to be optimized #2 -- left shift data over to remove padding
-    bool shifted = false;
-    size_t src_offset = 0;
-    size_t dest_offset = 0;
+
+    // Gather the valid segments in symbol order. Packets that failed the
+    // integrity check were recorded with size 0 and drop out here, which
+    // also removes the padding shift the old staging copy needed
+    std::array<const uint8_t*, UDPClient::kMaxGatherSegs> segs;
+    std::array<size_t, UDPClient::kMaxGatherSegs> seg_lens;
+    size_t num_segs = 0;
+    size_t total_bytes = 0;
     for (size_t packet = 0; packet < num_mac_packets_per_frame; packet++) {
       const size_t rx_packet_size = server_.data_size_.at(ue_id).at(packet);
-      if (rx_packet_size < cfg_->MacPayloadMaxLength() || (shifted == true)) {
-        shifted = true;
-        if (rx_packet_size > 0) {
-          std::memmove(&server_.frame_data_.at(ue_id).at(dest_offset),
-                       &server_.frame_data_.at(ue_id).at(src_offset),
-                       rx_packet_size);
-        }
+      if (rx_packet_size > 0) {
+        segs.at(num_segs) = server_.frame_segs_.at(ue_id).at(packet);
+        seg_lens.at(num_segs) = rx_packet_size;
+        num_segs++;
+        total_bytes += rx_packet_size;
       }
-      dest_offset += rx_packet_size;
-      src_offset += cfg_->MacPayloadMaxLength();
     }
 
-    if (dest_offset > 0) {
-      udp_client_->Send(kMacRemoteHostname, cfg_->BsMacTxPort() + ue_id,
-                        &server_.frame_data_.at(ue_id).at(0), dest_offset);
+    // Frame-window generation check: the segments point into
+    // decoded_buffer_, which is only valid while this frame's window
+    // slot has not been reclaimed by a newer frame (SIZE_MAX means the
+    // completed frame released its slot normally). A reclaimed slot
+    // means the MAC fell a full window behind; drop rather than send
+    // another frame's bits
+    const size_t seg_frame_id = server_.seg_frame_id_.at(ue_id);
+    const size_t slot_owner = FrameSlotMonitor::Owner(seg_frame_id);
+    const bool slot_valid =
+        (slot_owner == seg_frame_id) || (slot_owner == SIZE_MAX);
+
+    if ((total_bytes > 0) && (slot_valid == true)) {
+      if (cfg_->MacShmemTransport() == true) {
+        const bool pushed = shmem_tx_rings_.at(ue_id)->PushGather(
+            segs.data(), seg_lens.data(), num_segs);
+        if (pushed == false) {
+          MLPD_WARN(
+              "MacThreadBasestation: dropped frame %zu for ue %zu, egress "
+              "ring full\n",
+              frame_id, ue_id);
+        }
+      } else {
+        udp_clients_.at(shard)->SendGather(kMacRemoteHostname,
+                                           cfg_->BsMacTxPort() + ue_id,
+                                           segs.data(), seg_lens.data(),
+                                           num_segs);
+      }
+    } else if (slot_valid == false) {
+      MLPD_WARN(
+          "MacThreadBasestation: dropped frame %zu for ue %zu, decode "
+          "buffer slot reclaimed by frame %zu\n",
+          seg_frame_id, ue_id, slot_owner);
     }
 
     ss << "MacThreadBasestation: Sent data for frame " << frame_id << ", ue "
-       << ue_id << ", size " << dest_offset << ":" << max_data_bytes_per_frame
+       << ue_id << ", size " << total_bytes << ":" << max_data_bytes_per_frame
        << std::endl;
 
     if (kLogMacPackets) {
       std::fprintf(stdout, "%s", ss.str().c_str());
     }
 
-    for (size_t i = 0u; i < dest_offset; i++) {
-      ss << std::to_string(server_.frame_data_.at(ue_id).at(i)) << " ";
+    if (slot_valid == true) {
+      for (size_t s = 0; s < num_segs; s++) {
+        for (size_t i = 0u; i < seg_lens.at(s); i++) {
+          ss << std::to_string(segs.at(s)[i]) << " ";
+        }
+      }
     }
     std::fprintf(log_file_, "%s", ss.str().c_str());
     ss.str("");
@@ -253,9 +356,9 @@ void MacThreadBaseStation::SendControlInformation() {
   // send RAN control information UE
   RBIndicator ri;
   ri.ue_id_ = next_radio_id_;
-  ri.mod_order_bits_ = CommsLib::kQaM16;
-  udp_client_->Send(cfg_->UeServerAddr(), kMacBaseClientPort + ri.ue_id_,
-                    (uint8_t*)&ri, sizeof(RBIndicator));
+  ri.mod_order_bits_ = ran_mod_order_bits_;
+  udp_clients_.at(0)->Send(cfg_->UeServerAddr(), kMacBaseClientPort + ri.ue_id_,
+                           (uint8_t*)&ri, sizeof(RBIndicator));
 
   // update RAN config within Agora
   SendRanConfigUpdate(EventData(EventType::kRANUpdate));
@@ -278,12 +381,43 @@ void MacThreadBaseStation::ProcessUdpPacketsFromApps() {
 
   size_t total_bytes_received = 0;
 
-  const size_t max_recv_attempts = (packets_required * 10u);
+  const size_t max_recv_attempts =
+      (packets_required * cfg_->MacBusyPollBudget());
   size_t rx_attempts;
   for (rx_attempts = 0u; rx_attempts < max_recv_attempts; rx_attempts++) {
-    ssize_t ret = udp_server_->Recv(&udp_pkt_buf_.at(total_bytes_received),
-                                    udp_pkt_buf_.size() - total_bytes_received);
-    if (ret == 0) {
+    // Pull up to a full burst of app datagrams: one recvmmsg() syscall, or
+    // a drain of the shared-memory ingress ring straight into the parse
+    // buffer (one ring record is one app datagram)
+    const size_t burst = std::min(UDPServer::kMaxRecvBurst,
+                                  packets_required - packets_received);
+    ssize_t num_rx = 0;
+    size_t ret = 0;
+    if (cfg_->MacShmemTransport() == true) {
+      for (size_t pkt_rx = 0; pkt_rx < burst; pkt_rx++) {
+        const size_t space =
+            udp_pkt_buf_.size() - (total_bytes_received + ret);
+        if (space < cfg_->MacPacketLength()) {
+          MLPD_ERROR(
+              "MacThreadBaseStation: Received burst overflows the %zu byte "
+              "rx buffer with %zu bytes pending\n",
+              udp_pkt_buf_.size(), total_bytes_received + ret);
+          cfg_->Running(false);
+          return;
+        }
+        const size_t rx_bytes = shmem_rx_ring_->Pop(
+            &udp_pkt_buf_.at(total_bytes_received + ret), space);
+        if (rx_bytes == 0) {
+          break;
+        }
+        ret += rx_bytes;
+        num_rx++;
+      }
+    } else {
+      num_rx =
+          udp_server_->RecvMulti(udp_burst_slots_.data(), udp_burst_slot_len_,
+                                 burst, udp_burst_lens_.data());
+    }
+    if (num_rx == 0) {
       MLPD_TRACE("MacThreadBaseStation: No data received with %zu pending\n",
                  total_bytes_received);
       if (total_bytes_received == 0) {
@@ -294,12 +428,30 @@ void MacThreadBaseStation::ProcessUdpPacketsFromApps() {
             "buffer pending %zu : try %zu out of %zu\n",
             total_bytes_received, rx_attempts, max_recv_attempts);
       }
-    } else if (ret < 0) {
+    } else if (num_rx < 0) {
       // There was an error in receiving
-      MLPD_ERROR("MacThreadBaseStation: Error in reception %zu\n", ret);
+      MLPD_ERROR("MacThreadBaseStation: Error in reception %zd\n", num_rx);
       cfg_->Running(false);
       return;
     } else { /* Got some data */
+      // Append the UDP burst to the contiguous parse buffer; ring records
+      // were written straight into it above
+      if (cfg_->MacShmemTransport() == false) {
+        for (ssize_t pkt_rx = 0; pkt_rx < num_rx; pkt_rx++) {
+          const size_t rx_bytes = udp_burst_lens_.at(pkt_rx);
+          if ((total_bytes_received + ret + rx_bytes) > udp_pkt_buf_.size()) {
+            MLPD_ERROR(
+                "MacThreadBaseStation: Received burst overflows the %zu byte "
+                "rx buffer with %zu bytes pending\n",
+                udp_pkt_buf_.size(), total_bytes_received + ret);
+            cfg_->Running(false);
+            return;
+          }
+          std::memcpy(&udp_pkt_buf_.at(total_bytes_received + ret),
+                      udp_burst_slots_.at(pkt_rx), rx_bytes);
+          ret += rx_bytes;
+        }
+      }
       total_bytes_received += ret;
       current_packet_bytes += ret;
 
@@ -466,8 +618,10 @@ void MacThreadBaseStation::ProcessUdpPacketsFromAppsBs(const char* payload) {
 
     pkt->LoadData(src_packet->Data());
     // Insert CRC
-    pkt->Crc((uint16_t)(
-        crc_obj_->CalculateCrc24(pkt->Data(), pkt->PayloadLength()) & 0xFFFF));
+    pkt->Crc(
+        (uint16_t)(crc_objs_.at(0)->CalculateCrc24(pkt->Data(),
+                                                   pkt->PayloadLength()) &
+                   0xFFFF));
 
     if (kLogMacPackets) {
       std::stringstream ss;
@@ -502,7 +656,7 @@ void MacThreadBaseStation::ProcessUdpPacketsFromAppsBs(const char* payload) {
   RtAssert(tx_queue_->enqueue(msg),
            "MacThreadBasestation: Failed to enqueue uplink packet");
 
-  radio_buf_id = (radio_buf_id + 1) % kFrameWnd;
+  radio_buf_id = (radio_buf_id + 1) % cfg_->FrameWnd();
   // Might be unnecessary now.
   next_radio_id_ = (next_radio_id_ + 1) % cfg_->UeAntNum();
   if (next_radio_id_ == 0) {
@@ -510,6 +664,65 @@ void MacThreadBaseStation::ProcessUdpPacketsFromAppsBs(const char* payload) {
   }
 }
 
+void MacThreadBaseStation::UpdateLinkAdaptation() {
+  const size_t latest_frame =
+      latest_ul_frame_id_.load(std::memory_order_relaxed);
+  if (latest_frame < (last_adapt_frame_id_ + cfg_->MacLinkAdaptInterval())) {
+    return;
+  }
+  last_adapt_frame_id_ = latest_frame;
+
+  // The worst per-UE decode failure rate over the window governs the
+  // decision; averaging would let one struggling UE hide behind the rest
+  double worst_fail_rate = 0.0;
+  for (size_t ue = 0; ue < cfg_->UeAntNum(); ue++) {
+    const size_t packets =
+        window_ul_packets_.at(ue).exchange(0, std::memory_order_relaxed);
+    const size_t failures =
+        window_crc_failures_.at(ue).exchange(0, std::memory_order_relaxed);
+    if (packets > 0) {
+      worst_fail_rate = std::max(
+          worst_fail_rate, static_cast<double>(failures) / packets);
+    }
+  }
+  const size_t backlog = rx_queue_->size_approx();
+
+  size_t new_mod_order_bits = ran_mod_order_bits_;
+  if ((worst_fail_rate > kLinkAdaptFailRateLower) ||
+      (backlog > kLinkAdaptBacklogHighWater)) {
+    // Decode errors or MAC backpressure: step the rate down
+    if (new_mod_order_bits > CommsLib::kQpsk) {
+      new_mod_order_bits -= 2;
+    }
+  } else if ((worst_fail_rate < kLinkAdaptFailRateRaise) &&
+             (backlog < (kLinkAdaptBacklogHighWater / 4))) {
+    // Clean window and an idle queue: step the rate back up
+    if (new_mod_order_bits < CommsLib::kQaM64) {
+      new_mod_order_bits += 2;
+    }
+  }
+
+  if (new_mod_order_bits != ran_mod_order_bits_) {
+    MLPD_INFO(
+        "MacThreadBasestation: link adaptation moving modulation %zu -> %zu "
+        "bits at frame %zu (worst fail rate %.4f, backlog %zu)\n",
+        ran_mod_order_bits_, new_mod_order_bits, latest_frame, worst_fail_rate,
+        backlog);
+    ran_mod_order_bits_ = new_mod_order_bits;
+  }
+}
+
+void MacThreadBaseStation::ShardLoop(size_t shard) {
+  PinToCoreWithOffset(ThreadType::kWorkerMacTXRX, core_offset_, shard);
+
+  EventData event;
+  while (cfg_->Running() == true) {
+    if (shard_queues_.at(shard - 1).try_dequeue(event) == true) {
+      ProcessCodeblocksFromPhy(shard, event);
+    }
+  }
+}
+
 void MacThreadBaseStation::RunEventLoop() {
   MLPD_INFO(
       "MacThreadBasestation: Running MAC thread event loop, logging to file "
@@ -518,19 +731,42 @@ void MacThreadBaseStation::RunEventLoop() {
   PinToCoreWithOffset(ThreadType::kWorkerMacTXRX, core_offset_,
                       0 /* thread ID */);
 
+  // Codeblock shards 1..num_shards_-1 run on the cores directly after this
+  // one; the loop below dispatches to them and handles shard 0 inline
+  for (size_t shard = 1; shard < num_shards_; shard++) {
+    shard_threads_.emplace_back(&MacThreadBaseStation::ShardLoop, this, shard);
+  }
+
   size_t last_frame_tx_tsc = 0;
+  // Scrape the kernel drop counter about once a second: an overflow of the
+  // MAC data socket is otherwise silent and only shows up in netstat
+  const size_t drop_poll_tsc_delta = static_cast<size_t>(freq_ghz_ * 1e9);
+  size_t last_drop_poll_tsc = GetTime::Rdtsc();
 
   while (cfg_->Running() == true) {
     ProcessRxFromPhy();
 
     if ((GetTime::Rdtsc() - last_frame_tx_tsc) > tsc_delta_) {
+      if (cfg_->MacLinkAdapt() == true) {
+        UpdateLinkAdaptation();
+      }
       SendControlInformation();
       last_frame_tx_tsc = GetTime::Rdtsc();
     }
 
+    if ((udp_server_ != nullptr) &&
+        ((GetTime::Rdtsc() - last_drop_poll_tsc) > drop_poll_tsc_delta)) {
+      udp_server_->PollKernelDrops("BS MAC data");
+      last_drop_poll_tsc = GetTime::Rdtsc();
+    }
+
     // No need to process incomming packets if we are finished
     if (next_tx_frame_id_ != cfg_->FramesToTest()) {
       ProcessUdpPacketsFromApps();
     }
   }
+
+  for (auto& shard_thread : shard_threads_) {
+    shard_thread.join();
+  }
 }
@@ -5,7 +5,10 @@
 #ifndef MAC_THREAD_H_
 #define MAC_THREAD_H_
 
+#include <atomic>
 #include <queue>
+#include <thread>
+#include <vector>
 
 #include "buffer.h"
 #include "concurrentqueue.h"
@@ -13,6 +16,7 @@
 #include "crc.h"
 #include "gettime.h"
 #include "ran_config.h"
+#include "shmem_ring.h"
 #include "symbols.h"
 #include "udp_client.h"
 #include "udp_server.h"
@@ -24,6 +28,11 @@
  * This thread receives UDP data packets from remote apps and forwards them to
  * Agora. It receives decoded symbols from Agora and forwards UDP data
  * packets to applications.
+ *
+ * With mac_thread_num > 1 the uplink codeblock work (CRC checks and app
+ * socket sends) is sharded by UE id across a small pool, each shard with
+ * its own UDP socket and CRC state. Per-UE packet order is preserved
+ * because every UE maps to exactly one shard.
  */
 class MacThreadBaseStation {
  public:
@@ -38,6 +47,9 @@ class MacThreadBaseStation {
   // TODO: map this to time?
   static constexpr size_t kSNRWindowSize = 100;
 
+  // Size of the event queue feeding each codeblock shard thread
+  static constexpr size_t kShardQueueSize = 512;
+
   MacThreadBaseStation(
       Config* const cfg, size_t core_offset,
       PtrCube<kFrameWnd, kMaxSymbols, kMaxUEs, int8_t>& decoded_buffer,
@@ -58,8 +70,14 @@ class MacThreadBaseStation {
   void ProcessRxFromPhy();
 
   // Receive decoded codeblocks from the PHY master thread. Send
-  // fully-received frames for UE #i to kRemoteHostname::(kBaseRemotePort + i)
-  void ProcessCodeblocksFromPhy(EventData event);
+  // fully-received frames for UE #i to kRemoteHostname::(kBaseRemotePort + i).
+  // Runs on the shard that owns the packet's UE, using that shard's UDP
+  // socket and CRC state
+  void ProcessCodeblocksFromPhy(size_t shard, EventData event);
+
+  // Event loop for codeblock shards 1..num_shards_-1; shard 0's codeblocks
+  // are handled inline by the main MAC thread
+  void ShardLoop(size_t shard);
 
   // Receive SNR report from PHY master thread. Use for RB scheduling.
   // TODO: process CQI report here as well.
@@ -72,6 +90,12 @@ class MacThreadBaseStation {
   // from server to client
   void SendControlInformation();
 
+  // Link adaptation control loop (mac_link_adapt): every
+  // mac_link_adapt_interval frames, turn the windowed per-UE decode
+  // failure rates and the MAC queue backlog into a modulation order step,
+  // which the periodic RanConfig updates then carry to the PHY
+  void UpdateLinkAdaptation();
+
   // Receive user data bits (downlink bits at the MAC thread running at the
   // server, uplink bits at the MAC thread running at the client) and forward
   // them to the PHY.
@@ -87,17 +111,40 @@ class MacThreadBaseStation {
 
   const size_t core_offset_;  // The CPU core on which this thread runs
 
+  // Number of codeblock shards; kPacketToMac events are routed by
+  // [ue_id % num_shards_]
+  const size_t num_shards_;
+
   FILE* log_file_;  // Log file used to store MAC layer outputs
   std::string log_filename_;
 
-  // UDP endpoint used for sending messages
-  std::unique_ptr<UDPClient> udp_client_;
+  // Per-shard UDP endpoints used for sending messages
+  std::vector<std::unique_ptr<UDPClient>> udp_clients_;
   // UDP endpoint used for receiving messages
   std::unique_ptr<UDPServer> udp_server_;
 
+  // Shared-memory app transport (mac_shmem_transport): an ingress ring
+  // fed by co-located apps and one egress ring per UE, replacing the UDP
+  // app data sockets. Per-UE egress rings stay single-producer because
+  // each UE belongs to exactly one codeblock shard
+  std::unique_ptr<ShmemRing> shmem_rx_ring_;
+  std::vector<std::unique_ptr<ShmemRing>> shmem_tx_rings_;
+
+  // Event queues feeding shard threads 1..num_shards_-1; single producer
+  // (the dispatching main MAC thread), single consumer (the shard)
+  std::vector<moodycamel::ConcurrentQueue<EventData>> shard_queues_;
+  std::vector<std::thread> shard_threads_;
+
   // A preallocated buffer to store UDP packets received via recv()
   std::vector<uint8_t> udp_pkt_buf_;
 
+  // Scratch buffers for batched app-socket receive: one slot per datagram
+  // of a recvmmsg() burst, appended to udp_pkt_buf_ once received
+  size_t udp_burst_slot_len_;
+  std::vector<uint8_t> udp_burst_buf_;
+  std::array<uint8_t*, UDPServer::kMaxRecvBurst> udp_burst_slots_;
+  std::array<size_t, UDPServer::kMaxRecvBurst> udp_burst_lens_;
+
   // The timestamp at which we last received a UDP packet from an application
   size_t last_mac_pkt_rx_tsc_ = 0;
 
@@ -110,12 +157,38 @@ class MacThreadBaseStation {
   // The frame ID of the next TTI that the scheduler plans for
   size_t scheduler_next_frame_id_ = 0;
 
+  // Modulation order the outgoing RanConfig updates and RB indicators
+  // currently advertise; steered by UpdateLinkAdaptation()
+  size_t ran_mod_order_bits_;
+
+  // Uplink RB allocation the outgoing RanConfig updates advertise, at
+  // demul-block granularity (all-ones = full band). A traffic-aware
+  // scheduler would steer this from buffer occupancy; until one exists
+  // it stays at full band
+  uint64_t ran_ul_block_mask_ = UINT64_MAX;
+
+  // Link adaptation window: decode outcomes per UE since the last
+  // decision (written by the codeblock shards), the newest uplink frame
+  // seen, and the frame the last decision was taken at
+  std::array<std::atomic<size_t>, kMaxUEs> window_ul_packets_;
+  std::array<std::atomic<size_t>, kMaxUEs> window_crc_failures_;
+  std::atomic<size_t> latest_ul_frame_id_ = {0};
+  size_t last_adapt_frame_id_ = 0;
+
   FastRand fast_rand_;
 
   // Server-only members
   struct {
-    // Staging buffers to accumulate decoded uplink code blocks for each UE
-    std::array<std::vector<uint8_t>, kMaxUEs> frame_data_;
+    // Zero-copy uplink handoff: per-UE segment pointers into
+    // decoded_buffer_, one per MAC packet of the frame being assembled.
+    // The decode buffer persists for kFrameWnd frames, so a completed
+    // frame is sent straight out of it with one gather write instead of
+    // being staged through a copy. Outer dim: UE, inner: data symbol
+    std::vector<std::vector<const uint8_t*>> frame_segs_;
+
+    // Frame whose packets frame_segs_[i] currently points at, for the
+    // frame-window generation check before sending
+    std::array<size_t, kMaxUEs> seg_frame_id_;
 
     // n_filled_in_frame_[i] is the number of bytes received in the current
     // frame for UE #i
@@ -145,8 +218,8 @@ class MacThreadBaseStation {
   // FIFO queue for sending messages to the master thread
   moodycamel::ConcurrentQueue<EventData>* tx_queue_;
 
-  // CRC
-  std::unique_ptr<DoCRC> crc_obj_;
+  // Per-shard CRC calculators
+  std::vector<std::unique_ptr<DoCRC>> crc_objs_;
 };
 
 #endif  // MAC_THREAD_H_
@@ -4,6 +4,9 @@
  */
 #include "mac_thread_client.h"
 
+#include <algorithm>
+#include <cstring>
+
 #include "logger.h"
 #include "utils_ldpc.h"
 
@@ -20,6 +23,7 @@ MacThreadClient::MacThreadClient(
       freq_ghz_(GetTime::MeasureRdtscFreq()),
       tsc_delta_((cfg_->GetFrameDurationSec() * 1e9) / freq_ghz_),
       core_offset_(core_offset),
+      num_shards_(cfg_->MacThreadNum()),
       decoded_buffer_(decoded_buffer),
       rx_queue_(rx_queue),
       tx_queue_(tx_queue) {
@@ -53,13 +57,35 @@ MacThreadClient::MacThreadClient(
   const size_t udp_pkt_len = cfg_->UlMacDataBytesNumPerframe();
   udp_pkt_buf_.resize(udp_pkt_len + kUdpRxBufferPadding);
 
-  // TODO: See if it makes more sense to split up the UE's by port here for
-  // client mode.
-  const size_t udp_server_port = cfg_->UeMacRxPort();
-  MLPD_INFO("MacThreadClient: setting up udp server for mac data at port %zu\n",
-            udp_server_port);
-  udp_server_ = std::make_unique<UDPServer>(
-      udp_server_port, udp_pkt_len * kMaxUEs * kMaxPktsPerUE);
+  // Slots for one recvmmsg() burst; each app datagram carries at most one
+  // full MAC packet but the slots get the same padding as udp_pkt_buf_
+  udp_burst_slot_len_ = cfg_->MacPacketLength() + kUdpRxBufferPadding;
+  udp_burst_buf_.resize(udp_burst_slot_len_ * UDPServer::kMaxRecvBurst);
+  for (size_t slot = 0; slot < UDPServer::kMaxRecvBurst; slot++) {
+    udp_burst_slots_.at(slot) = &udp_burst_buf_.at(slot * udp_burst_slot_len_);
+  }
+
+  if (cfg_->MacShmemTransport() == true) {
+    // Co-located apps: memory-mapped rings replace the loopback UDP data
+    // sockets (the control channel stays on UDP)
+    shmem_rx_ring_ = std::make_unique<ShmemRing>(
+        ShmemRing::kUeRxRingName, ShmemRing::kDefaultRingBytes, true);
+    for (size_t ue = 0; ue < cfg_->UeAntTotal(); ue++) {
+      shmem_tx_rings_.emplace_back(std::make_unique<ShmemRing>(
+          std::string(ShmemRing::kUeTxRingPrefix) + std::to_string(ue),
+          ShmemRing::kDefaultRingBytes, true));
+    }
+  } else {
+    // TODO: See if it makes more sense to split up the UE's by port here for
+    // client mode.
+    const size_t udp_server_port = cfg_->UeMacRxPort();
+    MLPD_INFO(
+        "MacThreadClient: setting up udp server for mac data at port %zu\n",
+        udp_server_port);
+    udp_server_ = std::make_unique<UDPServer>(
+        udp_server_port, udp_pkt_len * kMaxUEs * kMaxPktsPerUE,
+        cfg_->UdpBusyPollUs());
+  }
 
   const size_t udp_control_len = sizeof(RBIndicator);
   udp_control_buf_.resize(udp_control_len);
@@ -69,10 +95,18 @@ MacThreadClient::MacThreadClient(
       "%zu\n",
       kMacBaseClientPort);
   udp_control_channel_ = std::make_unique<UDPServer>(
-      kMacBaseClientPort, udp_control_len * kMaxUEs * kMaxPktsPerUE);
-
-  udp_client_ = std::make_unique<UDPClient>();
-  crc_obj_ = std::make_unique<DoCRC>();
+      kMacBaseClientPort, udp_control_len * kMaxUEs * kMaxPktsPerUE,
+      cfg_->UdpBusyPollUs());
+
+  // One UDP client and CRC calculator per codeblock shard so the shard
+  // threads never share socket or CRC state
+  for (size_t shard = 0; shard < num_shards_; shard++) {
+    udp_clients_.emplace_back(std::make_unique<UDPClient>());
+    crc_objs_.emplace_back(std::make_unique<DoCRC>());
+  }
+  for (size_t shard = 1; shard < num_shards_; shard++) {
+    shard_queues_.emplace_back(kShardQueueSize);
+  }
 }
 
 MacThreadClient::~MacThreadClient() {
@@ -88,7 +122,15 @@ void MacThreadClient::ProcessRxFromPhy() {
 
   if (event.event_type_ == EventType::kPacketToMac) {
     MLPD_TRACE("MacThreadClient: MAC thread event kPacketToMac\n");
-    ProcessCodeblocksFromPhy(event);
+    // Route to the shard that owns this UE; shard 0 is handled inline.
+    // Routing by UE id keeps per-UE packet order
+    const size_t shard = gen_tag_t(event.tags_[0]).ue_id_ % num_shards_;
+    if (shard == 0) {
+      ProcessCodeblocksFromPhy(0, event);
+    } else {
+      RtAssert(shard_queues_.at(shard - 1).enqueue(event),
+               "MacThreadClient: shard queue enqueue failed");
+    }
   } else if (event.event_type_ == EventType::kSNRReport) {
     MLPD_TRACE("MacThreadClient: MAC thread event kSNRReport\n");
     ProcessSnrReportFromPhy(event);
@@ -126,7 +168,7 @@ void MacThreadClient::SendRanConfigUpdate(EventData /*event*/) {
   scheduler_next_frame_id_++;
 }
 
-void MacThreadClient::ProcessCodeblocksFromPhy(EventData event) {
+void MacThreadClient::ProcessCodeblocksFromPhy(size_t shard, EventData event) {
   assert(event.event_type_ == EventType::kPacketToMac);
 
   const size_t frame_id = gen_tag_t(event.tags_[0]).frame_id_;
@@ -143,7 +185,7 @@ void MacThreadClient::ProcessCodeblocksFromPhy(EventData event) {
   const size_t num_mac_packets_per_frame = cfg_->DlMacPacketsPerframe();
 
   const int8_t* src_data =
-      decoded_buffer_[(frame_id % kFrameWnd)][symbol_array_index][ue_id];
+      decoded_buffer_[cfg_->FrameSlot(frame_id)][symbol_array_index][ue_id];
 
   std::stringstream ss;  // Debug-only
 
@@ -187,7 +229,9 @@ void MacThreadClient::ProcessCodeblocksFromPhy(EventData event) {
          (pkt->Symbol() <= data_symbol_index_end)) &&
         (pkt->Ue() <= cfg_->UeAntNum())) {
       auto crc = static_cast<uint16_t>(
-          crc_obj_->CalculateCrc24(pkt->Data(), pkt->PayloadLength()) & 0xFFFF);
+          crc_objs_.at(shard)->CalculateCrc24(pkt->Data(),
+                                              pkt->PayloadLength()) &
+          0xFFFF);
 
       data_valid = (crc == pkt->Crc());
     }
@@ -236,8 +280,21 @@ void MacThreadClient::ProcessCodeblocksFromPhy(EventData event) {
     }
 
     if (dest_offset > 0) {
-      udp_client_->Send(kMacRemoteHostname, cfg_->UeMacTxPort() + ue_id,
-                        &server_.frame_data_.at(ue_id).at(0), dest_offset);
+      if (cfg_->MacShmemTransport() == true) {
+        const bool pushed = shmem_tx_rings_.at(ue_id)->Push(
+            &server_.frame_data_.at(ue_id).at(0), dest_offset);
+        if (pushed == false) {
+          MLPD_WARN(
+              "MacThreadClient: dropped frame %zu for ue %zu, egress ring "
+              "full\n",
+              frame_id, ue_id);
+        }
+      } else {
+        udp_clients_.at(shard)->Send(kMacRemoteHostname,
+                                     cfg_->UeMacTxPort() + ue_id,
+                                     &server_.frame_data_.at(ue_id).at(0),
+                                     dest_offset);
+      }
     }
 
     ss << "MacThreadClient: Sent data for frame " << frame_id << ", ue "
@@ -295,12 +352,43 @@ void MacThreadClient::ProcessUdpPacketsFromApps(RBIndicator ri) {
 
   size_t total_bytes_received = 0;
 
-  const size_t max_recv_attempts = (packets_required * 10u);
+  const size_t max_recv_attempts =
+      (packets_required * cfg_->MacBusyPollBudget());
   size_t rx_attempts;
   for (rx_attempts = 0u; rx_attempts < max_recv_attempts; rx_attempts++) {
-    ssize_t ret = udp_server_->Recv(&udp_pkt_buf_.at(total_bytes_received),
-                                    udp_pkt_buf_.size() - total_bytes_received);
-    if (ret == 0) {
+    // Pull up to a full burst of app datagrams: one recvmmsg() syscall, or
+    // a drain of the shared-memory ingress ring straight into the parse
+    // buffer (one ring record is one app datagram)
+    const size_t burst = std::min(UDPServer::kMaxRecvBurst,
+                                  packets_required - packets_received);
+    ssize_t num_rx = 0;
+    size_t ret = 0;
+    if (cfg_->MacShmemTransport() == true) {
+      for (size_t pkt_rx = 0; pkt_rx < burst; pkt_rx++) {
+        const size_t space =
+            udp_pkt_buf_.size() - (total_bytes_received + ret);
+        if (space < cfg_->MacPacketLength()) {
+          MLPD_ERROR(
+              "MacThreadClient: Received burst overflows the %zu byte rx "
+              "buffer with %zu bytes pending\n",
+              udp_pkt_buf_.size(), total_bytes_received + ret);
+          cfg_->Running(false);
+          return;
+        }
+        const size_t rx_bytes = shmem_rx_ring_->Pop(
+            &udp_pkt_buf_.at(total_bytes_received + ret), space);
+        if (rx_bytes == 0) {
+          break;
+        }
+        ret += rx_bytes;
+        num_rx++;
+      }
+    } else {
+      num_rx =
+          udp_server_->RecvMulti(udp_burst_slots_.data(), udp_burst_slot_len_,
+                                 burst, udp_burst_lens_.data());
+    }
+    if (num_rx == 0) {
       MLPD_TRACE("MacThreadClient: No data received with %zu pending\n",
                  total_bytes_received);
       if (total_bytes_received == 0) {
@@ -311,12 +399,30 @@ void MacThreadClient::ProcessUdpPacketsFromApps(RBIndicator ri) {
             "buffer pending %zu : try %zu out of %zu\n",
             total_bytes_received, rx_attempts, max_recv_attempts);
       }
-    } else if (ret < 0) {
+    } else if (num_rx < 0) {
       // There was an error in receiving
-      MLPD_ERROR("MacThreadClient: Error in reception %zu\n", ret);
+      MLPD_ERROR("MacThreadClient: Error in reception %zd\n", num_rx);
       cfg_->Running(false);
       return;
     } else { /* Got some data */
+      // Append the UDP burst to the contiguous parse buffer; ring records
+      // were written straight into it above
+      if (cfg_->MacShmemTransport() == false) {
+        for (ssize_t pkt_rx = 0; pkt_rx < num_rx; pkt_rx++) {
+          const size_t rx_bytes = udp_burst_lens_.at(pkt_rx);
+          if ((total_bytes_received + ret + rx_bytes) > udp_pkt_buf_.size()) {
+            MLPD_ERROR(
+                "MacThreadClient: Received burst overflows the %zu byte rx "
+                "buffer with %zu bytes pending\n",
+                udp_pkt_buf_.size(), total_bytes_received + ret);
+            cfg_->Running(false);
+            return;
+          }
+          std::memcpy(&udp_pkt_buf_.at(total_bytes_received + ret),
+                      udp_burst_slots_.at(pkt_rx), rx_bytes);
+          ret += rx_bytes;
+        }
+      }
       total_bytes_received += ret;
       current_packet_bytes += ret;
 
@@ -475,8 +581,10 @@ void MacThreadClient::ProcessUdpPacketsFromAppsClient(const char* payload,
 
     pkt->LoadData(src_packet->Data());
     // Insert CRC
-    pkt->Crc((uint16_t)(
-        crc_obj_->CalculateCrc24(pkt->Data(), pkt->PayloadLength()) & 0xFFFF));
+    pkt->Crc(
+        (uint16_t)(crc_objs_.at(0)->CalculateCrc24(pkt->Data(),
+                                                   pkt->PayloadLength()) &
+                   0xFFFF));
 
     if (kLogMacPackets) {
       std::stringstream ss;
@@ -512,7 +620,7 @@ void MacThreadClient::ProcessUdpPacketsFromAppsClient(const char* payload,
   RtAssert(tx_queue_->enqueue(msg),
            "MacThreadClient: Failed to enqueue uplink packet");
 
-  radio_buf_id = (radio_buf_id + 1) % kFrameWnd;
+  radio_buf_id = (radio_buf_id + 1) % cfg_->FrameWnd();
   // Might be unnecessary now.
   next_radio_id_ = (next_radio_id_ + 1) % cfg_->UeAntNum();
   if (next_radio_id_ == 0) {
@@ -520,6 +628,17 @@ void MacThreadClient::ProcessUdpPacketsFromAppsClient(const char* payload,
   }
 }
 
+void MacThreadClient::ShardLoop(size_t shard) {
+  PinToCoreWithOffset(ThreadType::kWorkerMacTXRX, core_offset_, shard);
+
+  EventData event;
+  while (cfg_->Running() == true) {
+    if (shard_queues_.at(shard - 1).try_dequeue(event) == true) {
+      ProcessCodeblocksFromPhy(shard, event);
+    }
+  }
+}
+
 void MacThreadClient::RunEventLoop() {
   MLPD_INFO(
       "MacThreadClient: Running MAC thread event loop, logging to file %s\n",
@@ -527,6 +646,17 @@ void MacThreadClient::RunEventLoop() {
   PinToCoreWithOffset(ThreadType::kWorkerMacTXRX, core_offset_,
                       0 /* thread ID */);
 
+  // Codeblock shards 1..num_shards_-1 run on the cores directly after this
+  // one; the loop below dispatches to them and handles shard 0 inline
+  for (size_t shard = 1; shard < num_shards_; shard++) {
+    shard_threads_.emplace_back(&MacThreadClient::ShardLoop, this, shard);
+  }
+
+  // Scrape the kernel drop counters about once a second: an overflow of
+  // the MAC sockets is otherwise silent and only shows up in netstat
+  const size_t drop_poll_tsc_delta = static_cast<size_t>(freq_ghz_ * 1e9);
+  size_t last_drop_poll_tsc = GetTime::Rdtsc();
+
   while (cfg_->Running() == true) {
     ProcessRxFromPhy();
 
@@ -534,5 +664,17 @@ void MacThreadClient::RunEventLoop() {
     if (next_tx_frame_id_ != cfg_->FramesToTest()) {
       ProcessControlInformation();
     }
+
+    if ((GetTime::Rdtsc() - last_drop_poll_tsc) > drop_poll_tsc_delta) {
+      if (udp_server_ != nullptr) {
+        udp_server_->PollKernelDrops("UE MAC data");
+      }
+      udp_control_channel_->PollKernelDrops("UE MAC control");
+      last_drop_poll_tsc = GetTime::Rdtsc();
+    }
+  }
+
+  for (auto& shard_thread : shard_threads_) {
+    shard_thread.join();
   }
 }
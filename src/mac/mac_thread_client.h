@@ -6,6 +6,8 @@
 #define MAC_THREAD_H_
 
 #include <queue>
+#include <thread>
+#include <vector>
 
 #include "buffer.h"
 #include "concurrentqueue.h"
@@ -13,6 +15,7 @@
 #include "crc.h"
 #include "gettime.h"
 #include "ran_config.h"
+#include "shmem_ring.h"
 #include "symbols.h"
 #include "udp_client.h"
 #include "udp_server.h"
@@ -24,6 +27,11 @@
  * This thread receives UDP data packets from remote apps and forwards them to
  * Agora. It receives decoded symbols from Agora and forwards UDP data
  * packets to applications.
+ *
+ * With mac_thread_num > 1 the downlink codeblock work (CRC checks and app
+ * socket sends) is sharded by UE id across a small pool, each shard with
+ * its own UDP socket and CRC state. Per-UE packet order is preserved
+ * because every UE maps to exactly one shard.
  */
 class MacThreadClient {
  public:
@@ -38,6 +46,9 @@ class MacThreadClient {
   // TODO: map this to time?
   static constexpr size_t kSNRWindowSize = 100;
 
+  // Size of the event queue feeding each codeblock shard thread
+  static constexpr size_t kShardQueueSize = 512;
+
   MacThreadClient(
       Config* const cfg, size_t core_offset,
       PtrCube<kFrameWnd, kMaxSymbols, kMaxUEs, int8_t>& decoded_buffer,
@@ -58,8 +69,14 @@ class MacThreadClient {
   void ProcessRxFromPhy();
 
   // Receive decoded codeblocks from the PHY master thread. Send
-  // fully-received frames for UE #i to kRemoteHostname::(kBaseRemotePort + i)
-  void ProcessCodeblocksFromPhy(EventData event);
+  // fully-received frames for UE #i to kRemoteHostname::(kBaseRemotePort + i).
+  // Runs on the shard that owns the packet's UE, using that shard's UDP
+  // socket and CRC state
+  void ProcessCodeblocksFromPhy(size_t shard, EventData event);
+
+  // Event loop for codeblock shards 1..num_shards_-1; shard 0's codeblocks
+  // are handled inline by the main MAC thread
+  void ShardLoop(size_t shard);
 
   // Receive SNR report from PHY master thread. Use for RB scheduling.
   // TODO: process CQI report here as well.
@@ -91,20 +108,43 @@ class MacThreadClient {
 
   const size_t core_offset_;  // The CPU core on which this thread runs
 
+  // Number of codeblock shards; kPacketToMac events are routed by
+  // [ue_id % num_shards_]
+  const size_t num_shards_;
+
   FILE* log_file_;  // Log file used to store MAC layer outputs
   std::string log_filename_;
 
-  // UDP endpoint used for sending messages
-  std::unique_ptr<UDPClient> udp_client_;
+  // Per-shard UDP endpoints used for sending messages
+  std::vector<std::unique_ptr<UDPClient>> udp_clients_;
   // UDP endpoint used for receiving messages
   std::unique_ptr<UDPServer> udp_server_;
 
+  // Shared-memory app transport (mac_shmem_transport): an ingress ring
+  // fed by co-located apps and one egress ring per UE, replacing the UDP
+  // app data sockets. Per-UE egress rings stay single-producer because
+  // each UE belongs to exactly one codeblock shard
+  std::unique_ptr<ShmemRing> shmem_rx_ring_;
+  std::vector<std::unique_ptr<ShmemRing>> shmem_tx_rings_;
+
+  // Event queues feeding shard threads 1..num_shards_-1; single producer
+  // (the dispatching main MAC thread), single consumer (the shard)
+  std::vector<moodycamel::ConcurrentQueue<EventData>> shard_queues_;
+  std::vector<std::thread> shard_threads_;
+
   // UDP endpoint for receiving control channel messages
   std::unique_ptr<UDPServer> udp_control_channel_;
 
   // A preallocated buffer to store UDP packets received via recv()
   std::vector<uint8_t> udp_pkt_buf_;
 
+  // Scratch buffers for batched app-socket receive: one slot per datagram
+  // of a recvmmsg() burst, appended to udp_pkt_buf_ once received
+  size_t udp_burst_slot_len_;
+  std::vector<uint8_t> udp_burst_buf_;
+  std::array<uint8_t*, UDPServer::kMaxRecvBurst> udp_burst_slots_;
+  std::array<size_t, UDPServer::kMaxRecvBurst> udp_burst_lens_;
+
   // A preallocated buffer to store UDP control information
   // received via recv()
   std::vector<uint8_t> udp_control_buf_;
@@ -158,8 +198,8 @@ class MacThreadClient {
   // FIFO queue for sending messages to the master thread
   moodycamel::ConcurrentQueue<EventData>* tx_queue_;
 
-  // CRC
-  std::unique_ptr<DoCRC> crc_obj_;
+  // Per-shard CRC calculators
+  std::vector<std::unique_ptr<DoCRC>> crc_objs_;
 };
 
 #endif  // MAC_THREAD_H_
@@ -0,0 +1,56 @@
+/**
+ * @file shmem_receiver.cc
+ * @brief Implementation file for the ShmemReceiver class
+ */
+
+#include "shmem_receiver.h"
+
+#include <cassert>
+#include <cstring>
+
+#include "logger.h"
+
+ShmemReceiver::ShmemReceiver(const std::string &ring_name)
+    : ring_(ring_name, ShmemRing::kDefaultRingBytes, true),
+      data_available_(0),
+      data_start_offset_(0) {}
+
+size_t ShmemReceiver::Load(unsigned char *destination, size_t requested_bytes) {
+  assert(requested_bytes <= local_rx_buffer_.size());
+
+  if (requested_bytes > data_available_) {
+    // Check for potential local buffer wrap-around
+    if ((data_start_offset_ + data_available_ + kShmemMaxRecordSize) >
+        local_rx_buffer_.size()) {
+      std::memcpy(&local_rx_buffer_.at(0),
+                  &local_rx_buffer_.at(data_start_offset_), data_available_);
+      data_start_offset_ = 0;
+    }
+
+    // Drain ring records until we have enough bytes or the ring runs dry
+    size_t data_read = SIZE_MAX;
+    while ((data_available_ < requested_bytes) && (data_read > 0)) {
+      const size_t write_at = data_start_offset_ + data_available_;
+      data_read = ring_.Pop(&local_rx_buffer_.at(write_at),
+                            local_rx_buffer_.size() - write_at);
+      data_available_ += data_read;
+      MLPD_FRAME("[ShmemReceiver] data received: %zu:%zu \n", data_available_,
+                 requested_bytes);
+    }
+  }
+
+  // A live ring legitimately runs dry between app bursts; return what we
+  // have and let the caller pad, unlike the file source which rewinds
+  const size_t loaded_bytes = std::min(requested_bytes, data_available_);
+  if (loaded_bytes > 0) {
+    std::memcpy(destination, &local_rx_buffer_.at(data_start_offset_),
+                loaded_bytes);
+    MLPD_FRAME("[ShmemReceiver] data loaded: %zu\n", loaded_bytes);
+    data_start_offset_ += loaded_bytes;
+    data_available_ -= loaded_bytes;
+    if (data_available_ == 0) {
+      data_start_offset_ = 0;
+    }
+  }
+  return loaded_bytes;
+}
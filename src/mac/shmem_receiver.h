@@ -0,0 +1,37 @@
+/**
+ * @file shmem_receiver.h
+ * @brief Declaration file for the ShmemReceiver class
+ */
+#ifndef SHMEM_RECEIVER_H_
+#define SHMEM_RECEIVER_H_
+
+#include <array>
+#include <string>
+
+#include "mac_data_receiver.h"
+#include "shmem_ring.h"
+
+/**
+ * @brief The ShmemReceiver class creates a shared-memory ring data source
+ * for Agora, fed by a co-located application
+ */
+class ShmemReceiver : public MacDataReceiver {
+ public:
+  static constexpr size_t kShmemMaxRecordSize = (2048u);
+  static constexpr size_t kShmemLocalRxBufSize = (kShmemMaxRecordSize * 10u);
+
+  explicit ShmemReceiver(const std::string &ring_name);
+  ~ShmemReceiver() override = default;
+
+  size_t Load(unsigned char *destination, size_t requested_bytes) final;
+
+ private:
+  // The receiver owns (creates) the ring; the producing app attaches
+  ShmemRing ring_;
+  std::array<uint8_t, ShmemReceiver::kShmemLocalRxBufSize> local_rx_buffer_;
+
+  size_t data_available_;
+  size_t data_start_offset_;
+};
+
+#endif  // SHMEM_RECEIVER_H_
@@ -0,0 +1,158 @@
+/**
+ * @file shmem_ring.cc
+ * @brief Implementation file for the ShmemRing class
+ */
+#include "shmem_ring.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include "logger.h"
+#include "utils.h"
+
+// How long an attaching process waits for the creator to set up the ring
+static constexpr size_t kAttachAttempts = 100u;
+static constexpr size_t kAttachDelayUs = 10000u;
+
+ShmemRing::ShmemRing(const std::string& name, size_t capacity, bool create)
+    : name_(name),
+      owner_(create),
+      fd_(-1),
+      ctrl_(nullptr),
+      data_(nullptr),
+      capacity_(capacity) {
+  RtAssert((capacity_ > 0) && ((capacity_ & (capacity_ - 1)) == 0),
+           "ShmemRing: capacity must be a power of two");
+  const size_t map_bytes = sizeof(ControlBlock) + capacity_;
+
+  if (create == true) {
+    // Recreate from scratch so a stale object left by a crashed run
+    // cannot leak old cursors into this one
+    shm_unlink(name_.c_str());
+    fd_ = shm_open(name_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    RtAssert(fd_ >= 0, "ShmemRing: shm_open(create) failed for " + name_);
+    RtAssert(ftruncate(fd_, map_bytes) == 0,
+             "ShmemRing: ftruncate failed for " + name_);
+  } else {
+    // The creating process may still be starting up; retry briefly
+    for (size_t attempt = 0; (attempt < kAttachAttempts) && (fd_ < 0);
+         attempt++) {
+      fd_ = shm_open(name_.c_str(), O_RDWR, 0);
+      if (fd_ < 0) {
+        usleep(kAttachDelayUs);
+      }
+    }
+    RtAssert(fd_ >= 0, "ShmemRing: shm_open(attach) failed for " + name_);
+  }
+
+  void* map =
+      mmap(nullptr, map_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+  RtAssert(map != MAP_FAILED, "ShmemRing: mmap failed for " + name_);
+  ctrl_ = reinterpret_cast<ControlBlock*>(map);
+  data_ = reinterpret_cast<uint8_t*>(map) + sizeof(ControlBlock);
+
+  if (create == true) {
+    ctrl_->capacity_ = capacity_;
+    ctrl_->head_.store(0);
+    ctrl_->tail_.store(0);
+    ctrl_->magic_.store(kRingMagic, std::memory_order_release);
+  } else {
+    size_t attempt = 0;
+    while ((ctrl_->magic_.load(std::memory_order_acquire) != kRingMagic) &&
+           (attempt < kAttachAttempts)) {
+      usleep(kAttachDelayUs);
+      attempt++;
+    }
+    RtAssert(ctrl_->magic_.load(std::memory_order_acquire) == kRingMagic,
+             "ShmemRing: ring " + name_ + " was never initialized");
+    RtAssert(ctrl_->capacity_ == capacity_,
+             "ShmemRing: capacity mismatch for " + name_);
+  }
+  MLPD_INFO("ShmemRing: %s %s, %zu byte capacity\n",
+            (create == true) ? "created" : "attached to", name_.c_str(),
+            capacity_);
+}
+
+ShmemRing::~ShmemRing() {
+  if (ctrl_ != nullptr) {
+    munmap(ctrl_, sizeof(ControlBlock) + capacity_);
+  }
+  if (fd_ >= 0) {
+    close(fd_);
+  }
+  if (owner_ == true) {
+    shm_unlink(name_.c_str());
+  }
+}
+
+bool ShmemRing::Push(const uint8_t* data, size_t length) {
+  return PushGather(&data, &length, 1);
+}
+
+bool ShmemRing::PushGather(const uint8_t* const* segs,
+                           const size_t* seg_lengths, size_t num_segs) {
+  uint32_t record_bytes = 0;
+  for (size_t seg = 0; seg < num_segs; seg++) {
+    record_bytes += seg_lengths[seg];
+  }
+
+  const uint64_t head = ctrl_->head_.load(std::memory_order_relaxed);
+  const uint64_t tail = ctrl_->tail_.load(std::memory_order_acquire);
+  if ((capacity_ - (head - tail)) < (sizeof(record_bytes) + record_bytes)) {
+    return false;
+  }
+
+  CopyIn(head, reinterpret_cast<const uint8_t*>(&record_bytes),
+         sizeof(record_bytes));
+  uint64_t offset = head + sizeof(record_bytes);
+  for (size_t seg = 0; seg < num_segs; seg++) {
+    CopyIn(offset, segs[seg], seg_lengths[seg]);
+    offset += seg_lengths[seg];
+  }
+  ctrl_->head_.store(offset, std::memory_order_release);
+  return true;
+}
+
+size_t ShmemRing::Pop(uint8_t* dest, size_t max_length) {
+  const uint64_t tail = ctrl_->tail_.load(std::memory_order_relaxed);
+  const uint64_t head = ctrl_->head_.load(std::memory_order_acquire);
+  if (head == tail) {
+    return 0;
+  }
+
+  uint32_t record_bytes;
+  CopyOut(tail, reinterpret_cast<uint8_t*>(&record_bytes),
+          sizeof(record_bytes));
+  if (record_bytes > max_length) {
+    MLPD_ERROR(
+        "ShmemRing: %u byte record exceeds the %zu byte destination, "
+        "dropping\n",
+        record_bytes, max_length);
+    ctrl_->tail_.store(tail + sizeof(record_bytes) + record_bytes,
+                       std::memory_order_release);
+    return 0;
+  }
+  CopyOut(tail + sizeof(record_bytes), dest, record_bytes);
+  ctrl_->tail_.store(tail + sizeof(record_bytes) + record_bytes,
+                     std::memory_order_release);
+  return record_bytes;
+}
+
+void ShmemRing::CopyIn(uint64_t offset, const uint8_t* src, size_t length) {
+  const size_t start = offset & (capacity_ - 1);
+  const size_t first = std::min(length, capacity_ - start);
+  std::memcpy(&data_[start], src, first);
+  std::memcpy(&data_[0], &src[first], length - first);
+}
+
+void ShmemRing::CopyOut(uint64_t offset, uint8_t* dest, size_t length) const {
+  const size_t start = offset & (capacity_ - 1);
+  const size_t first = std::min(length, capacity_ - start);
+  std::memcpy(dest, &data_[start], first);
+  std::memcpy(&dest[first], &data_[0], length - first);
+}
@@ -0,0 +1,80 @@
+/**
+ * @file shmem_ring.h
+ * @brief Declaration file for the ShmemRing class
+ */
+#ifndef SHMEM_RING_H_
+#define SHMEM_RING_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief A memory-mapped single-producer single-consumer ring for MAC
+ * traffic between co-located processes (mac_shmem_transport).
+ *
+ * Records keep datagram framing: each Push() / PushGather() writes one
+ * length-prefixed record and each Pop() returns exactly one, so the rings
+ * are a drop-in for the loopback UDP sockets carrying MacPacketPacked
+ * traffic without the kernel socket path.
+ *
+ * The creating side owns the POSIX shared-memory object and unlinks it on
+ * destruction; the attaching side waits briefly for the creator to finish
+ * initialization.
+ */
+class ShmemRing {
+ public:
+  // Ring payload capacity in bytes (must be a power of two)
+  static constexpr size_t kDefaultRingBytes = (4u * 1024u * 1024u);
+
+  // Shared-memory object names used by the MAC threads and co-located
+  // apps. Egress rings (one per UE) append the UE id to the prefix
+  static constexpr char kBsRxRingName[] = "/agora_mac_bs_dl";
+  static constexpr char kBsTxRingPrefix[] = "/agora_mac_bs_ul_ue";
+  static constexpr char kUeRxRingName[] = "/agora_mac_ue_ul";
+  static constexpr char kUeTxRingPrefix[] = "/agora_mac_ue_dl_ue";
+  // App data source rings read by the MacSender through ShmemReceiver
+  static constexpr char kAppSourceRingPrefix[] = "/agora_mac_src";
+
+  ShmemRing(const std::string& name, size_t capacity, bool create);
+  ~ShmemRing();
+
+  // Append one length-prefixed record; returns false if the ring lacks
+  // space for the whole record
+  bool Push(const uint8_t* data, size_t length);
+
+  // Append one record gathered from [num_segs] segments
+  bool PushGather(const uint8_t* const* segs, const size_t* seg_lengths,
+                  size_t num_segs);
+
+  // Remove the oldest record into [dest]. Returns the record size, or 0
+  // if the ring is empty
+  size_t Pop(uint8_t* dest, size_t max_length);
+
+ private:
+  struct ControlBlock {
+    // Written last by the creator so attachers never see a half-built ring
+    std::atomic<uint32_t> magic_;
+    uint32_t pad_;
+    uint64_t capacity_;
+    // Free-running byte cursors; the producer owns head_ and the consumer
+    // owns tail_, each on its own cache line
+    alignas(64) std::atomic<uint64_t> head_;
+    alignas(64) std::atomic<uint64_t> tail_;
+  };
+  static constexpr uint32_t kRingMagic = 0x4d414352;  // "MACR"
+
+  // Copy into / out of the ring data area with wrap-around handling
+  void CopyIn(uint64_t offset, const uint8_t* src, size_t length);
+  void CopyOut(uint64_t offset, uint8_t* dest, size_t length) const;
+
+  const std::string name_;
+  const bool owner_;
+  int fd_;
+  ControlBlock* ctrl_;
+  uint8_t* data_;
+  const size_t capacity_;
+};
+
+#endif  // SHMEM_RING_H_
@@ -311,6 +311,17 @@ namespace details {
 	} max_align_t;
 }
 
+// Process-wide allocation hooks (local patch, not upstream). When set, all
+// queue memory -- blocks, block indices, producer structures -- is routed
+// through them instead of std::malloc/free, without changing the traits
+// type (which is a template parameter and would ripple through every
+// ConcurrentQueue<T> declaration in the embedding code). Install the hooks
+// before constructing any queue and never change them afterwards; the free
+// hook must also accept pointers obtained from std::malloc before it was
+// installed. Left null, behaviour is identical to upstream.
+inline void* (*queue_malloc_hook)(std::size_t) = nullptr;
+inline void (*queue_free_hook)(void*) = nullptr;
+
 // Default traits for the ConcurrentQueue. To change some of the
 // traits without re-implementing all of them, inherit from this
 // struct and shadow the declarations you wish to be different;
@@ -386,13 +397,13 @@ struct ConcurrentQueueDefaultTraits
 #if defined(malloc) || defined(free)
 	// Gah, this is 2015, stop defining macros that break standard code already!
 	// Work around malloc/free being special macros:
-	static inline void* WORKAROUND_malloc(size_t size) { return malloc(size); }
-	static inline void WORKAROUND_free(void* ptr) { return free(ptr); }
+	static inline void* WORKAROUND_malloc(size_t size) { return queue_malloc_hook != nullptr ? queue_malloc_hook(size) : malloc(size); }
+	static inline void WORKAROUND_free(void* ptr) { if (queue_free_hook != nullptr) queue_free_hook(ptr); else free(ptr); }
 	static inline void* (malloc)(size_t size) { return WORKAROUND_malloc(size); }
 	static inline void (free)(void* ptr) { return WORKAROUND_free(ptr); }
 #else
-	static inline void* malloc(size_t size) { return std::malloc(size); }
-	static inline void free(void* ptr) { return std::free(ptr); }
+	static inline void* malloc(size_t size) { return queue_malloc_hook != nullptr ? queue_malloc_hook(size) : std::malloc(size); }
+	static inline void free(void* ptr) { if (queue_free_hook != nullptr) queue_free_hook(ptr); else std::free(ptr); }
 #endif
 #else
 	// Debug versions when running under the Relacy race detector (ignore
@@ -0,0 +1,155 @@
+/**
+ * @file fft_bench.cc
+ * @brief Benchmark for the deployed DoFFT composite: short-to-float
+ * conversion, forward transform, and the partial-transpose / CSI write.
+ * Per-stage cycle counts come from the same Stats DurationStat machinery
+ * the runtime uses, so numbers are comparable with production timing.
+ *
+ * Usage: fft_bench [config_file] [recorded_iq_file]
+ *   config_file      JSON config (default data/tddconfig-sim-ul.json).
+ *                    Antenna / subcarrier sweeps are driven by running the
+ *                    benchmark across a set of config files.
+ *   recorded_iq_file Optional raw 16-bit IQ capture to replay; symbols are
+ *                    drawn from it sequentially, wrapping around. Without
+ *                    it, random IQ is used.
+ */
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "config.h"
+#include "dofft.h"
+#include "gettime.h"
+#include "utils.h"
+
+static constexpr size_t kNumFrames = 500;
+
+static double CyclesPerTask(size_t cycles, size_t num_tasks) {
+  return (num_tasks == 0) ? 0.0
+                          : static_cast<double>(cycles) /
+                                static_cast<double>(num_tasks);
+}
+
+static void PrintStageBreakdown(const char* label, const DurationStat* ds) {
+  std::printf(
+      "%s: %zu symbols, cycles/symbol: total %.0f "
+      "(convert %.0f, transform %.0f, reorg %.0f)\n",
+      label, ds->task_count_,
+      CyclesPerTask(ds->task_duration_[0], ds->task_count_),
+      CyclesPerTask(ds->task_duration_[1], ds->task_count_),
+      CyclesPerTask(ds->task_duration_[2], ds->task_count_),
+      CyclesPerTask(ds->task_duration_[3], ds->task_count_));
+}
+
+int main(int argc, char** argv) {
+  std::string conf_file = "data/tddconfig-sim-ul.json";
+  if (argc >= 2) {
+    conf_file = argv[1];
+  }
+  auto cfg = std::make_unique<Config>(conf_file.c_str());
+  cfg->GenData();
+
+  const int tid = 0;
+
+  Table<complex_float> data_buffer;
+  data_buffer.Malloc(cfg->Frame().NumULSyms() * kFrameWnd,
+                     cfg->OfdmDataNum() * cfg->BsAntNum(),
+                     Agora_memory::Alignment_t::kAlign64);
+  PtrGrid<kFrameWnd, kMaxUEs, complex_float> csi_buffers(
+      kFrameWnd, cfg->UeAntNum(), cfg->BsAntNum() * cfg->OfdmDataNum());
+  Table<complex_float> calib_dl_buffer;
+  calib_dl_buffer.Calloc(kFrameWnd, cfg->OfdmDataNum() * cfg->BsAntNum(),
+                         Agora_memory::Alignment_t::kAlign64);
+  Table<complex_float> calib_ul_buffer;
+  calib_ul_buffer.Calloc(kFrameWnd, cfg->OfdmDataNum() * cfg->BsAntNum(),
+                         Agora_memory::Alignment_t::kAlign64);
+
+  auto phy_stats = std::make_unique<PhyStats>(cfg.get(), Direction::kUplink);
+  auto stats = std::make_unique<Stats>(cfg.get());
+  auto compute_fft = std::make_unique<DoFFT>(
+      cfg.get(), tid, data_buffer, csi_buffers, calib_dl_buffer,
+      calib_ul_buffer, phy_stats.get(), stats.get());
+
+  // One reusable received symbol, refilled per launch from the capture (or
+  // once with random IQ)
+  const size_t samps_per_pkt = 2 * cfg->SampsPerSymbol();
+  auto* pkt = static_cast<Packet*>(Agora_memory::PaddedAlignedAlloc(
+      Agora_memory::Alignment_t::kAlign64,
+      Packet::kOffsetOfData + (samps_per_pkt * sizeof(short))));
+
+  std::vector<short> recorded;
+  if (argc >= 3) {
+    FILE* fp = std::fopen(argv[2], "rb");
+    RtAssert(fp != nullptr, "fft_bench: failed to open recorded IQ file");
+    std::fseek(fp, 0, SEEK_END);
+    const size_t n_shorts = std::ftell(fp) / sizeof(short);
+    std::fseek(fp, 0, SEEK_SET);
+    RtAssert(n_shorts >= samps_per_pkt,
+             "fft_bench: recorded IQ file shorter than one symbol");
+    recorded.resize(n_shorts);
+    const size_t n_read = std::fread(recorded.data(), sizeof(short), n_shorts,
+                                     fp);
+    RtAssert(n_read == n_shorts, "fft_bench: short read from IQ file");
+    std::fclose(fp);
+  } else {
+    FastRand fast_rand;
+    for (size_t i = 0; i < samps_per_pkt; i++) {
+      pkt->data_[i] = static_cast<short>(fast_rand.NextU32());
+    }
+  }
+
+  RxPacket rx_packet(pkt);
+  size_t replay_pos = 0;
+  const auto launch_symbol = [&](size_t frame_id, size_t symbol_id,
+                                 size_t ant_id) {
+    if (!recorded.empty()) {
+      if ((replay_pos + samps_per_pkt) > recorded.size()) {
+        replay_pos = 0;
+      }
+      std::memcpy(pkt->data_, &recorded[replay_pos],
+                  samps_per_pkt * sizeof(short));
+      replay_pos += samps_per_pkt;
+    }
+    pkt->frame_id_ = frame_id;
+    pkt->symbol_id_ = symbol_id;
+    pkt->cell_id_ = 0;
+    pkt->ant_id_ = ant_id;
+    rx_packet.Use();  // Launch() drops the reference
+    compute_fft->Launch(fft_req_tag_t(rx_packet).tag_);
+  };
+
+  const size_t start_tsc = GetTime::Rdtsc();
+  for (size_t frame_id = 0; frame_id < kNumFrames; frame_id++) {
+    for (size_t p = 0; p < cfg->Frame().NumPilotSyms(); p++) {
+      const size_t symbol_id = cfg->Frame().GetPilotSymbol(p);
+      for (size_t ant_id = 0; ant_id < cfg->BsAntNum(); ant_id++) {
+        launch_symbol(frame_id, symbol_id, ant_id);
+      }
+    }
+    for (size_t u = 0; u < cfg->Frame().NumULSyms(); u++) {
+      const size_t symbol_id = cfg->Frame().GetULSymbol(u);
+      for (size_t ant_id = 0; ant_id < cfg->BsAntNum(); ant_id++) {
+        launch_symbol(frame_id, symbol_id, ant_id);
+      }
+    }
+  }
+  const double total_ms =
+      GetTime::CyclesToMs(GetTime::Rdtsc() - start_tsc, cfg->FreqGhz());
+
+  std::printf("fft_bench: %zu antennas, %zu of %zu subcarriers, %zu frames\n",
+              cfg->BsAntNum(), cfg->OfdmDataNum(), cfg->OfdmCaNum(),
+              kNumFrames);
+  PrintStageBreakdown("  uplink data (kFFT)",
+                      stats->GetDurationStat(DoerType::kFFT, tid));
+  PrintStageBreakdown("  pilot / CSI (kCSI)",
+                      stats->GetDurationStat(DoerType::kCSI, tid));
+  std::printf("  wall time: %.2f ms\n", total_ms);
+
+  compute_fft.reset();
+  std::free(pkt);
+  data_buffer.Free();
+  calib_dl_buffer.Free();
+  calib_ul_buffer.Free();
+  return 0;
+}
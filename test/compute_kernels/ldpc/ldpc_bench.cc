@@ -0,0 +1,193 @@
+/**
+ * @file ldpc_bench.cc
+ *
+ * @brief LDPC throughput benchmark matrix. Sweeps base graph {1, 2}, every
+ * supported expansion factor Zc, and a set of code rates (via nRows), and
+ * prints a machine-readable CSV of cycles per information bit for the
+ * build-selected encoder path (avx2enc or FlexRAN, both when available) and
+ * FlexRAN's decoder. Not a correctness test: run manually and feed the
+ * output to capacity planning.
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+#include "encoder.h"
+#include "gettime.h"
+#include "memory_manage.h"
+#include "phy_ldpc_decoder_5gnr.h"
+#include "symbols.h"
+#include "utils_ldpc.h"
+
+static constexpr size_t kNumCodeBlocks = 8;
+static constexpr size_t kNumIters = 16;
+static constexpr bool kEnableEarlyTermination = false;
+static constexpr size_t kNumFillerBits = 0;
+static constexpr size_t kMaxDecoderIters = 8;
+
+// All valid 5G NR lifting sizes (38.212 Table 5.3.2-1); entries outside the
+// encoder's supported range are skipped at runtime
+static const std::vector<size_t> kZcVec = {
+    2,   4,   8,   16, 32, 64,  128, 256, 3,   6,   12,  24, 48,
+    96,  192, 384, 5,  10, 20,  40,  80,  160, 320, 7,   14, 28,
+    56,  112, 224, 9,  18, 36,  72,  144, 288, 11,  22,  44, 88,
+    176, 352, 13,  26, 52, 104, 208, 15,  30,  60,  120, 240};
+
+// Representative nRows values per base graph, from the lowest rate (all
+// rows) up; values above the base graph's row count are clamped out
+static const std::vector<size_t> kNumRowsVec = {4, 8, 16, 32, 46};
+
+// Time one encoder invocation per code block over kNumIters passes and
+// return cycles per information bit
+static double TimeEncoder(bool use_avx2enc, size_t base_graph, size_t zc,
+                          size_t n_rows, int8_t* const* input,
+                          int8_t* const* parity, int8_t* const* encoded) {
+  const size_t num_input_bits = LdpcNumInputBits(base_graph, zc);
+
+  const size_t start_tsc = GetTime::Rdtsc();
+  for (size_t iter = 0; iter < kNumIters; iter++) {
+    for (size_t n = 0; n < kNumCodeBlocks; n++) {
+      if (use_avx2enc) {
+        bblib_ldpc_encoder_5gnr_request req;
+        bblib_ldpc_encoder_5gnr_response resp;
+        req.baseGraph = base_graph;
+        req.Zc = zc;
+        req.nRows = n_rows;
+        req.numberCodeblocks = 1;
+        req.input[0] = input[n];
+        resp.output[0] = parity[n];
+        avx2enc::BblibLdpcEncoder5gnr(&req, &resp);
+      } else {
+        LdpcEncodeHelper(base_graph, zc, n_rows, encoded[n], parity[n],
+                         input[n]);
+      }
+    }
+  }
+  const size_t cycles = GetTime::Rdtsc() - start_tsc;
+  return static_cast<double>(cycles) /
+         (kNumIters * kNumCodeBlocks * num_input_bits);
+}
+
+int main() {
+  const double freq_ghz = GetTime::MeasureRdtscFreq();
+  std::printf("# RDTSC frequency = %.2f GHz\n", freq_ghz);
+  std::printf("Spinning for one second for Turbo Boost\n");
+  GetTime::NanoSleep(1000 * 1000 * 1000, freq_ghz);
+
+  std::vector<size_t> zc_vec = kZcVec;
+  std::sort(zc_vec.begin(), zc_vec.end());
+
+  std::printf(
+      "kernel,base_graph,zc,n_rows,rate,input_bits,encoded_bits,"
+      "cycles_per_bit\n");
+
+  for (size_t base_graph = 1; base_graph <= 2; base_graph++) {
+    const size_t max_rows = LdpcMaxNumRows(base_graph);
+    for (const size_t& zc : zc_vec) {
+      if (zc < LdpcGetMinZc() || zc > LdpcGetMaxZc()) {
+        continue;
+      }
+      // The byte-unaligned copy in LdpcEncodeHelper only supports small Zc
+      if ((zc % 4 != 0) && (zc >= avx2enc::kProcBytes * 8)) {
+        continue;
+      }
+      for (size_t n_rows : kNumRowsVec) {
+        if (n_rows > max_rows) {
+          continue;
+        }
+        const size_t num_input_bits = LdpcNumInputBits(base_graph, zc);
+        const size_t num_encoded_bits =
+            LdpcNumEncodedBits(base_graph, zc, n_rows);
+        const double rate =
+            static_cast<double>(num_input_bits) / num_encoded_bits;
+
+        int8_t* input[kNumCodeBlocks];
+        int8_t* parity[kNumCodeBlocks];
+        int8_t* encoded[kNumCodeBlocks];
+        uint8_t* decoded[kNumCodeBlocks];
+        for (size_t i = 0; i < kNumCodeBlocks; i++) {
+          input[i] = new int8_t[LdpcEncodingInputBufSize(base_graph, zc)]();
+          parity[i] = new int8_t[LdpcEncodingParityBufSize(base_graph, zc)]();
+          encoded[i] = new int8_t[LdpcEncodingEncodedBufSize(base_graph, zc)]();
+          decoded[i] =
+              new uint8_t[LdpcEncodingEncodedBufSize(base_graph, zc)]();
+          for (size_t j = 0; j < BitsToBytes(num_input_bits); j++) {
+            input[i][j] = static_cast<int8_t>(rand());
+          }
+        }
+
+        // The production encode path (avx2enc or FlexRAN, whichever the
+        // build selected), including the codeword assembly in
+        // LdpcEncodeHelper
+        const double encode_cpb = TimeEncoder(
+            false, base_graph, zc, n_rows, input, parity, encoded);
+        std::printf("%s,%zu,%zu,%zu,%.4f,%zu,%zu,%.3f\n",
+                    kUseAVX2Encoder ? "encode_avx2enc" : "encode_flexran",
+                    base_graph, zc, n_rows, rate, num_input_bits,
+                    num_encoded_bits, encode_cpb);
+
+        if (kUseAVX2Encoder == false && zc <= avx2enc::kZcMax) {
+          // FlexRAN builds also carry avx2enc; time its raw kernel too so a
+          // single run compares both encoders
+          const double avx2enc_cpb = TimeEncoder(
+              true, base_graph, zc, n_rows, input, parity, encoded);
+          std::printf("encode_avx2enc_raw,%zu,%zu,%zu,%.4f,%zu,%zu,%.3f\n",
+                      base_graph, zc, n_rows, rate, num_input_bits,
+                      num_encoded_bits, avx2enc_cpb);
+        }
+
+        // Noiseless LLRs from the last encoder pass drive the decoder sweep
+        int8_t* llrs[kNumCodeBlocks];
+        for (size_t n = 0; n < kNumCodeBlocks; n++) {
+          llrs[n] = static_cast<int8_t*>(Agora_memory::PaddedAlignedAlloc(
+              Agora_memory::Alignment_t::kAlign32, num_encoded_bits));
+          for (size_t i = 0; i < num_encoded_bits; i++) {
+            uint8_t bit_i = (encoded[n][i / 8] >> (i % 8)) & 1;
+            llrs[n][i] = (bit_i == 1 ? -127 : 127);
+          }
+        }
+
+        struct bblib_ldpc_decoder_5gnr_request decoder_request = {};
+        struct bblib_ldpc_decoder_5gnr_response decoder_response = {};
+        decoder_request.numChannelLlrs = num_encoded_bits;
+        decoder_request.numFillerBits = kNumFillerBits;
+        decoder_request.maxIterations = kMaxDecoderIters;
+        decoder_request.enableEarlyTermination = kEnableEarlyTermination;
+        decoder_request.Zc = zc;
+        decoder_request.baseGraph = base_graph;
+        decoder_request.nRows = n_rows;
+        decoder_response.numMsgBits = num_input_bits - kNumFillerBits;
+        decoder_response.varNodes =
+            static_cast<int16_t*>(Agora_memory::PaddedAlignedAlloc(
+                Agora_memory::Alignment_t::kAlign32,
+                1024 * 1024 * sizeof(int16_t)));
+
+        const size_t decoding_start_tsc = GetTime::Rdtsc();
+        for (size_t iter = 0; iter < kNumIters; iter++) {
+          for (size_t n = 0; n < kNumCodeBlocks; n++) {
+            decoder_request.varNodes = llrs[n];
+            decoder_response.compactedMessageBytes = decoded[n];
+            bblib_ldpc_decoder_5gnr(&decoder_request, &decoder_response);
+          }
+        }
+        const size_t decoding_cycles = GetTime::Rdtsc() - decoding_start_tsc;
+        std::printf("decode_flexran,%zu,%zu,%zu,%.4f,%zu,%zu,%.3f\n",
+                    base_graph, zc, n_rows, rate, num_input_bits,
+                    num_encoded_bits,
+                    static_cast<double>(decoding_cycles) /
+                        (kNumIters * kNumCodeBlocks * num_input_bits));
+
+        for (size_t i = 0; i < kNumCodeBlocks; i++) {
+          delete[] input[i];
+          delete[] parity[i];
+          delete[] encoded[i];
+          delete[] decoded[i];
+          std::free(llrs[i]);
+        }
+        std::free(decoder_response.varNodes);
+      }
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,164 @@
+#!/bin/bash
+#
+# Usage:
+#  * This script must be run from Agora's top-level directory.
+#  * perf_suite.sh: run the performance matrix below and compare frame
+#    latency against the stored baselines in test/sim_tests/perf_baselines.
+#    The script exits non-zero when any case regresses, so it can gate CI.
+#  * perf_suite.sh update: run the matrix and (re)record the baselines.
+#    Baselines are machine-specific; record them on the machine that will
+#    run the comparisons, with the machine otherwise quiet.
+#  * PERF_THRESH sets the allowed relative regression in mean and p99 frame
+#    latency before a case fails (default 0.10 = 10%).
+#  * PERF_SENDER_CORE sets the first core for the sender threads (default
+#    10, chosen to stay clear of the cores the sim configs pin Agora to).
+#
+# Each case runs data_generator -> agora -> sender with the cores pinned by
+# the config, discards warmup frames, and writes machine-readable results
+# (mean/p99/max frame latency plus the raw per-frame, per-doer log from
+# Stats::SaveToFile) to test/sim_tests/perf_results/.
+###############################################################################
+
+# Check that all required executables are present
+exe_list="build/agora build/data_generator build/sender"
+for exe in ${exe_list}; do
+  if [ ! -f ${exe} ]; then
+      echo "${exe} not found. Exiting."
+      exit 1
+  fi
+done
+
+# Performance matrix: <case name>;<base config>;<bs radios>;<ue radios>;
+# <modulation>;<Zc>. Cases reuse the simulation configs and override the
+# swept keys, so core pinning and frame schedule stay in one place.
+perf_cases=(
+  "ul-8x8-64qam;data/tddconfig-sim-ul.json;8;8;64QAM;104"
+  "ul-16x8-64qam;data/tddconfig-sim-ul.json;16;8;64QAM;104"
+  "ul-8x8-16qam;data/tddconfig-sim-ul.json;8;8;16QAM;104"
+  "both-8x8-64qam;data/tddconfig-sim-both.json;8;8;64QAM;104"
+)
+
+num_frames=2000
+warmup_frames=200
+thresh=${PERF_THRESH:-0.10}
+sender_core=${PERF_SENDER_CORE:-10}
+result_dir=test/sim_tests/perf_results
+baseline_dir=test/sim_tests/perf_baselines
+mkdir -p ${result_dir}
+mkdir -p ${baseline_dir}
+
+update_baselines=0
+if [ "$1" == "update" ]; then
+  update_baselines=1
+fi
+
+suite_failed=0
+for perf_case in "${perf_cases[@]}"; do
+  IFS=';' read -r name conf bs_radios ue_radios modulation zc <<< "${perf_case}"
+
+  echo "==========================================="
+  echo "Performance case ${name}: ${bs_radios}x${ue_radios}, ${modulation}," \
+       "Zc ${zc}"
+  echo -e "===========================================\n"
+
+  # Setup the config for this matrix point
+  cp ${conf} data/perf-tmp.json
+  sed -i '2i\ \ "max_frame": '${num_frames}',' data/perf-tmp.json
+  sed -i 's/"bs_radio_num": [0-9]*/"bs_radio_num": '${bs_radios}'/' \
+      data/perf-tmp.json
+  sed -i 's/"ue_radio_num": [0-9]*/"ue_radio_num": '${ue_radios}'/' \
+      data/perf-tmp.json
+  sed -i 's/"modulation": "[0-9A-Za-z]*"/"modulation": "'${modulation}'"/' \
+      data/perf-tmp.json
+  sed -i 's/"Zc": [0-9]*/"Zc": '${zc}'/' data/perf-tmp.json
+
+  ./build/data_generator --conf_file data/perf-tmp.json > /dev/null
+
+  # We sleep before starting the sender to allow the Agora server to start
+  ./build/agora --conf_file data/perf-tmp.json > /dev/null &
+  sleep 1; ./build/sender --num_threads 2 --core_offset ${sender_core} \
+      --conf_file data/perf-tmp.json > /dev/null
+  wait
+
+  if [ ! -f data/timeresult.txt ]; then
+    echo "Case ${name}: data/timeresult.txt missing; Agora did not finish"
+    suite_failed=1
+    continue
+  fi
+
+  # Frame processing latency column in data/timeresult.txt depends on the
+  # frame type: the combined log ends at kDecodeDone (field 11), the
+  # uplink-only log at kDecodeDone (field 8), the downlink-only log at
+  # kIFFTDone (field 8)
+  header=$(head -1 data/timeresult.txt)
+  if [[ "${header}" == *"kPrecodeDone"* && "${header}" == *"kDemulDone"* ]]
+  then
+    lat_col=11
+  else
+    lat_col=8
+  fi
+
+  lat_file=$(mktemp)
+  tail -n +2 data/timeresult.txt | \
+      awk -v warmup=${warmup_frames} -v col=${lat_col} \
+          'NR > warmup { print $col }' | sort -g > ${lat_file}
+  frames=$(wc -l < ${lat_file})
+  if [ "${frames}" -eq 0 ]; then
+    echo "Case ${name}: no frames left after warmup; check the run"
+    suite_failed=1
+    rm ${lat_file}
+    continue
+  fi
+  mean_us=$(awk '{ sum += $1 } END { printf "%.3f", sum / NR }' ${lat_file})
+  let p99_line=(${frames}*99+99)/100
+  p99_us=$(sed -n "${p99_line}p" ${lat_file})
+  max_us=$(tail -1 ${lat_file})
+  rm ${lat_file}
+
+  # Machine-readable results: the summary CSV plus the raw per-frame,
+  # per-doer log for offline analysis
+  result_file=${result_dir}/${name}.csv
+  echo "case,frames,frame_latency_mean_us,frame_latency_p99_us,frame_latency_max_us" > ${result_file}
+  echo "${name},${frames},${mean_us},${p99_us},${max_us}" >> ${result_file}
+  cp data/timeresult.txt ${result_dir}/${name}-timeresult.txt
+  echo "Case ${name}: ${frames} frames, mean ${mean_us} us," \
+       "p99 ${p99_us} us, max ${max_us} us"
+
+  baseline_file=${baseline_dir}/${name}.csv
+  if [ "${update_baselines}" -eq 1 ]; then
+    cp ${result_file} ${baseline_file}
+    echo "Case ${name}: baseline recorded"
+    continue
+  fi
+  if [ ! -f ${baseline_file} ]; then
+    echo "Case ${name}: no baseline stored; run 'perf_suite.sh update'"
+    continue
+  fi
+
+  IFS=',' read -r b_name b_frames b_mean b_p99 b_max < \
+      <(tail -1 ${baseline_file})
+  mean_limit=$(echo "${b_mean} * (1 + ${thresh})" | bc -l)
+  p99_limit=$(echo "${b_p99} * (1 + ${thresh})" | bc -l)
+  if [ "$(echo "${mean_us} > ${mean_limit}" | bc -l)" -eq 1 ]; then
+    echo "Case ${name}: mean frame latency ${mean_us} us exceeds baseline" \
+         "${b_mean} us by more than ${thresh}"
+    suite_failed=1
+  fi
+  if [ "$(echo "${p99_us} > ${p99_limit}" | bc -l)" -eq 1 ]; then
+    echo "Case ${name}: p99 frame latency ${p99_us} us exceeds baseline" \
+         "${b_p99} us by more than ${thresh}"
+    suite_failed=1
+  fi
+done
+
+rm -f data/perf-tmp.json
+
+echo "=================================================="
+if [ "${suite_failed}" -eq 1 ]; then
+  echo "Performance suite FAILED"
+  echo "=================================================="
+  exit 1
+fi
+echo "Performance suite passed"
+echo "=================================================="
+exit 0
@@ -1,42 +1,116 @@
+#include <immintrin.h>
+
+#include <atomic>
+#include <cmath>
+#include <functional>
+#include <thread>
+
 #include "agora.h"
 #include "gflags/gflags.h"
+#include "mmap_reader.h"
 
 static const bool kDebugPrintUlCorr = false;
 static const bool kDebugPrintDlCorr = false;
 
-template <class TableType>
-static void ReadFromFile(const std::string& filename, Table<TableType>& data,
-                         size_t num_reads, size_t read_elements,
-                         size_t element_size) {
-  FILE* fp = std::fopen(filename.c_str(), "rb");
-  if (fp == nullptr) {
-    MLPD_ERROR("Open file failed: %s, error %s\n", filename.c_str(),
-               strerror(errno));
-  } else {
-    MLPD_INFO("Opening file %s\n", filename.c_str());
+// Number of differing bytes between two equal-length buffers, compared 32
+// bytes at a time. The mmap'd reference rows are contiguous, so the whole
+// row goes through the vector loop with a scalar tail.
+static size_t CountByteMismatches(const uint8_t* a, const uint8_t* b,
+                                  size_t bytes) {
+  size_t mismatches = 0;
+  size_t i = 0;
+  for (; (i + 32) <= bytes; i += 32) {
+    const __m256i va =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+    const __m256i vb =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+    const int eq_mask =
+        _mm256_movemask_epi8(_mm256_cmpeq_epi8(va, vb));
+    mismatches += 32 - static_cast<size_t>(__builtin_popcount(
+                           static_cast<unsigned int>(eq_mask)));
+  }
+  for (; i < bytes; i++) {
+    mismatches += (a[i] != b[i]) ? 1 : 0;
   }
+  return mismatches;
+}
 
-  for (size_t i = 0; i < num_reads; i++) {
-    size_t elements = std::fread(data[i], element_size, read_elements, fp);
-    if (read_elements != elements) {
-      MLPD_ERROR(
-          "Read file failed: %s, symbol %zu, expect: %zu, actual: %zu "
-          "bytes, error %s\n",
-          filename.c_str(), i, read_elements, elements, strerror(errno));
-    }
+// Sum of |a[i] - b[i]| over n int16 samples, widened to 32 bits before the
+// subtraction so full-range differences cannot overflow
+static uint64_t SumAbsDiff(const short* a, const short* b, size_t n) {
+  uint64_t sum = 0;
+  size_t i = 0;
+  __m256i acc = _mm256_setzero_si256();
+  for (; (i + 8) <= n; i += 8) {
+    const __m256i va = _mm256_cvtepi16_epi32(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)));
+    const __m256i vb = _mm256_cvtepi16_epi32(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i)));
+    acc = _mm256_add_epi32(acc, _mm256_abs_epi32(_mm256_sub_epi32(va, vb)));
+  }
+  alignas(32) int32_t lanes[8];
+  _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+  for (const int32_t lane : lanes) {
+    sum += static_cast<uint64_t>(lane);
+  }
+  for (; i < n; i++) {
+    sum += static_cast<uint64_t>(std::abs(a[i] - b[i]));
   }
+  return sum;
 }
 
-static void ReadFromFileUl(const std::string& filename, Table<uint8_t>& data,
-                           int num_bytes_per_ue, Config const* const cfg) {
-  ReadFromFile(filename, data, cfg->Frame().NumULSyms(),
-               (num_bytes_per_ue * cfg->UeAntNum()), sizeof(uint8_t));
+// Run fn(row) for every row in [0, num_rows) across a small thread pool.
+// Verification of different symbols/antennas is independent, so the rows
+// are handed out with an atomic cursor.
+static void ParallelForRows(size_t num_rows,
+                            const std::function<void(size_t)>& fn) {
+  const size_t num_threads =
+      std::min<size_t>(std::max(1U, std::thread::hardware_concurrency()),
+                       num_rows);
+  if (num_threads <= 1) {
+    for (size_t row = 0; row < num_rows; row++) {
+      fn(row);
+    }
+    return;
+  }
+  std::atomic<size_t> next_row(0);
+  std::vector<std::thread> threads;
+  threads.reserve(num_threads);
+  for (size_t t = 0; t < num_threads; t++) {
+    threads.emplace_back([&]() {
+      for (size_t row = next_row.fetch_add(1); row < num_rows;
+           row = next_row.fetch_add(1)) {
+        fn(row);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
 }
 
-static void ReadFromFileDl(const std::string& filename, Table<short>& data,
-                           int ofdm_size, Config const* const cfg) {
-  ReadFromFile(filename, data, cfg->Frame().NumDLSyms() * cfg->BsAntNum(),
-               (ofdm_size * 2), sizeof(short));
+// The test vectors are compared read-only, so instead of freading whole
+// files into heap tables the checks map them and index rows in place.
+// Pages are faulted on demand and shared through the page cache when
+// several test processes run against the same data directory.
+template <class RowType>
+static const RowType* MmapRow(const MmapReader& file,
+                              const std::string& filename, size_t row,
+                              size_t row_elements) {
+  const size_t row_bytes = row_elements * sizeof(RowType);
+  const uint8_t* section = file.TryAt(row * row_bytes, row_bytes);
+  if (section == nullptr) {
+    // Mirror the old fread behavior on short files: complain and compare
+    // against zeros
+    MLPD_ERROR("Read file failed: %s, symbol %zu past end of file\n",
+               filename.c_str(), row);
+    static std::vector<RowType> zeros;
+    if (zeros.size() < row_elements) {
+      zeros.resize(row_elements, RowType{});
+    }
+    return zeros.data();
+  }
+  return reinterpret_cast<const RowType*>(section);
 }
 
 static unsigned int CheckCorrectnessUl(Config const* const cfg) {
@@ -51,48 +125,47 @@ static unsigned int CheckCorrectnessUl(Config const* const cfg) {
                                   std::to_string(cfg->UeAntNum()) + ".bin";
   std::string output_data_filename = cur_directory + "/data/decode_data.bin";
 
-  Table<uint8_t> raw_data;
-  Table<uint8_t> output_data;
-  raw_data.Calloc(num_uplink_syms, (ofdm_data_num * ue_num),
-                  Agora_memory::Alignment_t::kAlign64);
-  output_data.Calloc(num_uplink_syms, (ofdm_data_num * ue_num),
-                     Agora_memory::Alignment_t::kAlign64);
-
   int num_bytes_per_ue = (cfg->LdpcConfig().NumCbLen() + 7) >>
                          3 * cfg->LdpcConfig().NumBlocksInSymbol();
-  ReadFromFileUl(raw_data_filename, raw_data, num_bytes_per_ue, cfg);
-  ReadFromFileUl(output_data_filename, output_data, num_bytes_per_ue, cfg);
+  const size_t row_elements = static_cast<size_t>(num_bytes_per_ue) * ue_num;
+  MmapReader raw_file(raw_data_filename);
+  MmapReader output_file(output_data_filename);
 
   std::printf(
       "check_correctness_ul: ue %d, ul syms %d, ofdm %d, ul pilots %d, bytes "
       "per UE %d.\n",
       ue_num, num_uplink_syms, ofdm_data_num, ul_pilot_syms, num_bytes_per_ue);
 
-  unsigned int error_cnt = 0;
-  unsigned int total_count = 0;
-  for (int i = 0; i < num_uplink_syms; i++) {
-    if (i >= ul_pilot_syms) {
-      for (int ue = 0; ue < ue_num; ue++) {
-        for (int j = 0; j < num_bytes_per_ue; j++) {
-          total_count++;
-          int offset_in_raw = num_bytes_per_ue * ue + j;
-          int offset_in_output = num_bytes_per_ue * ue + j;
-          if (raw_data[i][offset_in_raw] != output_data[i][offset_in_output]) {
-            error_cnt++;
-            if (kDebugPrintUlCorr) {
-              std::printf("(%d, %d, %u, %u)\n", i, j,
-                          raw_data[i][offset_in_raw],
-                          output_data[i][offset_in_output]);
-            }
-          }
+  // One row per uplink data symbol; rows are independent, so they are
+  // checked in parallel and the per-row mismatch counts summed afterwards
+  const size_t num_data_rows =
+      (num_uplink_syms > ul_pilot_syms)
+          ? static_cast<size_t>(num_uplink_syms - ul_pilot_syms)
+          : 0;
+  std::vector<size_t> row_errors(num_data_rows, 0);
+  ParallelForRows(num_data_rows, [&](size_t row) {
+    const size_t i = row + ul_pilot_syms;
+    const uint8_t* raw_row =
+        MmapRow<uint8_t>(raw_file, raw_data_filename, i, row_elements);
+    const uint8_t* output_row =
+        MmapRow<uint8_t>(output_file, output_data_filename, i, row_elements);
+    row_errors.at(row) = CountByteMismatches(raw_row, output_row, row_elements);
+    if (kDebugPrintUlCorr && (row_errors.at(row) > 0)) {
+      // Rescan the row element-wise only when the block compare found
+      // mismatches and the debug print is on
+      for (size_t j = 0; j < row_elements; j++) {
+        if (raw_row[j] != output_row[j]) {
+          std::printf("(%zu, %zu, %u, %u)\n", i, j % num_bytes_per_ue,
+                      raw_row[j], output_row[j]);
         }
-      }  //  for (int ue = 0; ue < ue_num; ue++)
-    }    // if (i >= ul_pilot_syms)
-  }      // for (int i = 0; i < num_uplink_syms; i++)
-
-  raw_data.Free();
-  output_data.Free();
+      }
+    }
+  });
 
+  unsigned int error_cnt = 0;
+  for (const size_t errors : row_errors) {
+    error_cnt += errors;
+  }
   return error_cnt;
 }
 
@@ -108,39 +181,43 @@ unsigned int CheckCorrectnessDl(Config const* const cfg) {
                                   std::to_string(bs_ant_num) + ".bin";
   std::string tx_data_filename = cur_directory + "/data/tx_data.bin";
 
-  Table<short> raw_data;
-  Table<short> tx_data;
-  raw_data.Calloc(num_data_syms * bs_ant_num, samps_per_symbol * 2,
-                  Agora_memory::Alignment_t::kAlign64);
-  tx_data.Calloc(num_data_syms * bs_ant_num, samps_per_symbol * 2,
-                 Agora_memory::Alignment_t::kAlign64);
-
-  ReadFromFileDl(raw_data_filename, raw_data, samps_per_symbol, cfg);
-  ReadFromFileDl(tx_data_filename, tx_data, samps_per_symbol, cfg);
+  const size_t row_elements = samps_per_symbol * 2;
+  MmapReader raw_file(raw_data_filename);
+  MmapReader tx_file(tx_data_filename);
   std::printf(
       "check_correctness_dl: bs ant %zu, dl syms %zu, ofdm %zu, samps per %zu. "
       "\n",
       bs_ant_num, num_data_syms, ofdm_ca_num, samps_per_symbol);
 
+  // One row per (symbol, antenna); the mean diffs are computed in
+  // parallel and printed sequentially after the join so the per-antenna
+  // report stays in order
+  const size_t num_rows = num_data_syms * bs_ant_num;
+  std::vector<float> avg_diffs(num_rows, 0.0f);
+  ParallelForRows(num_rows, [&](size_t offset) {
+    const size_t i = offset / bs_ant_num;
+    const size_t ant = offset % bs_ant_num;
+    const short* raw_row =
+        MmapRow<short>(raw_file, raw_data_filename, offset, row_elements);
+    const short* tx_row =
+        MmapRow<short>(tx_file, tx_data_filename, offset, row_elements);
+    const uint64_t sum_abs_diff =
+        SumAbsDiff(raw_row, tx_row, samps_per_symbol * 2);
+    avg_diffs.at(offset) =
+        (static_cast<float>(sum_abs_diff) / 32768.0f) / samps_per_symbol;
+    if (kDebugPrintDlCorr && (i == 0)) {
+      for (size_t sc = 0; sc < (samps_per_symbol * 2); sc++) {
+        std::printf("dl symbol %zu ant %zu sc %zu, (%d, %d) diff: %.3f\n", i,
+                    ant, sc / 2, raw_row[sc], tx_row[sc],
+                    std::fabs((raw_row[sc] - tx_row[sc]) / 32768.0));
+      }
+    }
+  });
+
   unsigned int error_cnt = 0;
-  float sum_diff = 0;
   for (size_t i = 0; i < num_data_syms; i++) {
     for (size_t ant = 0; ant < bs_ant_num; ant++) {
-      sum_diff = 0;
-      for (size_t sc = 0; sc < (samps_per_symbol * 2); sc++) {
-        size_t offset = (bs_ant_num * i) + ant;
-        float diff =
-            fabs((raw_data[offset][sc] - tx_data[offset][sc]) / 32768.0);
-        sum_diff += diff;
-        if (kDebugPrintDlCorr) {
-          if (i == 0) {
-            std::printf("dl symbol %zu ant %zu sc %zu, (%d, %d) diff: %.3f\n",
-                        i, ant, sc / 2, raw_data[offset][sc],
-                        tx_data[offset][sc], diff);
-          }
-        }
-      }
-      float avg_diff = sum_diff / samps_per_symbol;
+      const float avg_diff = avg_diffs.at((bs_ant_num * i) + ant);
       std::printf("dl symbol %zu, ant %zu, mean per-sample diff %.3f\n", i, ant,
                   avg_diff);
       if (avg_diff > 0.03) {
@@ -148,8 +225,6 @@ unsigned int CheckCorrectnessDl(Config const* const cfg) {
       }
     }
   }
-  raw_data.Free();
-  tx_data.Free();
 
   return error_cnt;
 }
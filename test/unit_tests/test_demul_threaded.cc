@@ -8,6 +8,7 @@
 #include "gettime.h"
 #include "phy_stats.h"
 #include "utils.h"
+#include "utils_ldpc.h"
 
 static constexpr size_t kNumWorkers = 14;
 static constexpr size_t kMaxTestNum = 100;
@@ -137,7 +138,8 @@ TEST(TestDemul, VaryingConfig) {
                               Agora_memory::Alignment_t::kAlign64);
   PtrCube<kFrameWnd, kMaxSymbols, kMaxUEs, int8_t> demod_buffers(
       kFrameWnd, cfg->Frame().NumTotalSyms(), cfg->UeAntNum(),
-      kMaxModType * cfg->OfdmDataNum());
+      (kMaxModType * cfg->OfdmDataNum()) +
+          kLdpcHelperFunctionInputBufferSizePaddingBytes);
   std::printf(
       "Size of [data_buffer, ul_zf_matrices, equal_buffer, "
       "ue_spec_pilot_buffer, demod_soft_buffer]: [%.1f %.1f %.1f %.1f %.1f] "
@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <complex>
+#include <vector>
+
+#include "gaussian_noise.h"
+
+// Large enough that the moment estimates settle to ~1/sqrt(n) = 5e-4,
+// so the tolerances below sit well clear of estimation noise while
+// still catching sub-percent distribution defects
+static constexpr size_t kNumSamples = 1 << 22;
+
+/// First four standardized moments plus the sign balance of [n] floats
+/// with stride 2 (one component of an interleaved complex buffer)
+struct Moments {
+  double mean;
+  double variance;
+  double kurtosis;
+  double frac_negative;
+};
+
+static Moments ComputeMoments(const float* x, size_t n) {
+  double sum = 0.0;
+  size_t num_negative = 0;
+  for (size_t i = 0; i < n; i++) {
+    sum += x[2 * i];
+    num_negative += (x[2 * i] < 0.0f) ? 1 : 0;
+  }
+  const double mean = sum / n;
+
+  double m2 = 0.0;
+  double m4 = 0.0;
+  for (size_t i = 0; i < n; i++) {
+    const double d = x[2 * i] - mean;
+    m2 += d * d;
+    m4 += d * d * d * d;
+  }
+  m2 /= n;
+  m4 /= n;
+  return Moments{mean, m2, m4 / (m2 * m2),
+                 static_cast<double>(num_negative) / n};
+}
+
+/// Both components must be N(0, 1): zero mean, unit variance, Gaussian
+/// kurtosis, and sign-symmetric. A quadrant-sign defect in the sincos
+/// kernel shows up here as a large DC offset and sign imbalance in the
+/// imaginary component
+TEST(TestGaussianNoise, ComponentMoments) {
+  GaussianNoiseGenerator gen(0x5AD0BEEF);
+  std::vector<std::complex<float>> samples(kNumSamples);
+  gen.Fill(samples.data(), samples.size());
+
+  const auto* floats = reinterpret_cast<const float*>(samples.data());
+  for (size_t component = 0; component < 2; component++) {
+    const Moments m = ComputeMoments(floats + component, kNumSamples);
+    ASSERT_NEAR(m.mean, 0.0, 5e-3) << "component " << component;
+    ASSERT_NEAR(m.variance, 1.0, 5e-3) << "component " << component;
+    ASSERT_NEAR(m.kurtosis, 3.0, 5e-2) << "component " << component;
+    ASSERT_NEAR(m.frac_negative, 0.5, 5e-3) << "component " << component;
+  }
+}
+
+/// Real and imaginary components of each sample come from independent
+/// Box-Muller draws, so they must be uncorrelated
+TEST(TestGaussianNoise, ComponentsUncorrelated) {
+  GaussianNoiseGenerator gen(0x5AD0BEEF);
+  std::vector<std::complex<float>> samples(kNumSamples);
+  gen.Fill(samples.data(), samples.size());
+
+  double cross = 0.0;
+  for (const auto& s : samples) {
+    cross += static_cast<double>(s.real()) * s.imag();
+  }
+  ASSERT_NEAR(cross / kNumSamples, 0.0, 5e-3);
+}
+
+/// Same seed must reproduce the same stream (the channel simulator
+/// relies on this for reproducible runs), and the batch tail path must
+/// match the full-batch path
+TEST(TestGaussianNoise, Reproducible) {
+  GaussianNoiseGenerator gen_a(0x1234);
+  GaussianNoiseGenerator gen_b(0x1234);
+  std::vector<std::complex<float>> a(1003);  // Odd n exercises the tail
+  std::vector<std::complex<float>> b(1003);
+  gen_a.Fill(a.data(), a.size());
+  gen_b.Fill(b.data(), b.size());
+  for (size_t i = 0; i < a.size(); i++) {
+    ASSERT_EQ(a[i], b[i]) << "sample " << i;
+  }
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
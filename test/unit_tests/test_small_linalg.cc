@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+
+#include <armadillo>
+#include <cstdlib>
+#include <utility>
+#include <vector>
+
+#include "small_linalg.h"
+
+static constexpr float kAllowedError = 1e-3f;
+
+/// Fill an interleaved-complex buffer with random values in [-1, 1]
+static void RandomFill(complex_float* buf, size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    buf[i].re = (2.0f * static_cast<float>(rand()) / RAND_MAX) - 1.0f;
+    buf[i].im = (2.0f * static_cast<float>(rand()) / RAND_MAX) - 1.0f;
+  }
+}
+
+/// Compare y = A * x from [kernel] against Armadillo for an m x k matrix
+static void CheckCgemv(small_linalg::CgemvFn kernel, size_t m, size_t k) {
+  std::vector<complex_float> a(m * k);
+  std::vector<complex_float> x(k);
+  std::vector<complex_float> y(m);
+  RandomFill(a.data(), a.size());
+  RandomFill(x.data(), x.size());
+
+  kernel(m, k, a.data(), x.data(), y.data());
+
+  const arma::cx_fmat mat_a(reinterpret_cast<arma::cx_float*>(a.data()), m, k,
+                            false);
+  const arma::cx_fvec vec_x(reinterpret_cast<arma::cx_float*>(x.data()), k,
+                            false);
+  const arma::cx_fvec ref = mat_a * vec_x;
+  for (size_t i = 0; i < m; i++) {
+    ASSERT_NEAR(y[i].re, ref(i).real(), kAllowedError)
+        << "m=" << m << " k=" << k << " row " << i;
+    ASSERT_NEAR(y[i].im, ref(i).imag(), kAllowedError)
+        << "m=" << m << " k=" << k << " row " << i;
+  }
+}
+
+TEST(TestSmallLinalg, CgemvRuntimeShape) {
+  // Odd shapes exercise the scalar row tail of the fallback kernel
+  for (auto [m, k] : {std::pair<size_t, size_t>{5, 7},
+                      {3, 9},
+                      {1, 1},
+                      {6, 13},
+                      {17, 11}}) {
+    CheckCgemv(&small_linalg::CgemvColMajor, m, k);
+  }
+}
+
+TEST(TestSmallLinalg, CgemvFixedShape) {
+  // The shapes the dispatch table covers (UE x BS antenna counts)
+  for (size_t m : {2, 4, 8, 16, 32, 64}) {
+    for (size_t k : {8, 16, 32, 64}) {
+      small_linalg::CgemvFn kernel = small_linalg::SelectCgemv(m, k);
+      ASSERT_NE(kernel, &small_linalg::CgemvColMajor);
+      CheckCgemv(kernel, m, k);
+    }
+  }
+  // Uncovered shapes must still resolve to the working fallback
+  ASSERT_EQ(small_linalg::SelectCgemv(3, 64), &small_linalg::CgemvColMajor);
+  ASSERT_EQ(small_linalg::SelectCgemv(8, 24), &small_linalg::CgemvColMajor);
+}
+
+TEST(TestSmallLinalg, GramHermitian) {
+  // Tall Gram shapes from ZF (antennas x UEs), plus ragged vector tails
+  for (auto [m, n] : {std::pair<size_t, size_t>{64, 8},
+                      {64, 16},
+                      {16, 16},
+                      {7, 5},
+                      {9, 3}}) {
+    std::vector<complex_float> a(m * n);
+    std::vector<complex_float> c(n * n);
+    RandomFill(a.data(), a.size());
+
+    small_linalg::GramHermitian(m, n, a.data(), c.data());
+
+    const arma::cx_fmat mat_a(reinterpret_cast<arma::cx_float*>(a.data()), m,
+                              n, false);
+    const arma::cx_fmat ref = mat_a.t() * mat_a;
+    for (size_t j = 0; j < n; j++) {
+      for (size_t i = 0; i < n; i++) {
+        ASSERT_NEAR(c[(j * n) + i].re, ref(i, j).real(), kAllowedError)
+            << "m=" << m << " n=" << n << " (" << i << ", " << j << ")";
+        ASSERT_NEAR(c[(j * n) + i].im, ref(i, j).imag(), kAllowedError)
+            << "m=" << m << " n=" << n << " (" << i << ", " << j << ")";
+      }
+    }
+    // The inversion path Cholesky-factorizes the result, so it must be
+    // exactly Hermitian, not just within tolerance
+    for (size_t j = 0; j < n; j++) {
+      ASSERT_EQ(c[(j * n) + j].im, 0.0f);
+      for (size_t i = 0; i < j; i++) {
+        ASSERT_EQ(c[(j * n) + i].re, c[(i * n) + j].re);
+        ASSERT_EQ(c[(j * n) + i].im, -c[(i * n) + j].im);
+      }
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}